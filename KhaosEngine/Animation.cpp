@@ -0,0 +1,363 @@
+// Animation.cpp
+// Clip stream building, cursor playback and batched pose sampling/blending.
+
+#include "Animation.h"
+
+#include <algorithm>
+#include <emmintrin.h>
+
+namespace
+{
+    using namespace KhaosEngine;
+
+    // Keys closer than this cosine of half the angle between them, about 32 degrees, are
+    // nlerped, which stays within 0.04 degrees of slerp. Wider spans are slerped, since the
+    // nlerp error grows with the cube of the angle.
+    const float NLERP_MIN_COS = 0.96f;
+
+    // Values used for tracks that have no authored keys.
+    const float DEFAULT_VALUES[CHANNEL_COUNT][4] = {
+        { 0.0f, 0.0f, 0.0f, 0.0f },
+        { 0.0f, 0.0f, 0.0f, 1.0f },
+        { 1.0f, 1.0f, 1.0f, 0.0f }
+    };
+
+    bool byTrackThenTime(const AnimationStreamKey& aKey, const AnimationStreamKey& bKey) {
+        return aKey.track != bKey.track ? aKey.track < bKey.track : aKey.time < bKey.time;
+    }
+
+    bool byNeededTime(const AnimationStreamKey& aKey, const AnimationStreamKey& bKey) {
+        return aKey.neededTime < bKey.neededTime;
+    }
+
+    // Returns a * b + c.
+    inline __m128 multiplyAdd(__m128 a, __m128 b, __m128 c) {
+        return _mm_add_ps(_mm_mul_ps(a, b), c);
+    }
+
+    // Returns the interpolation factor of four tracks at aTime, clamped to [0, 1].
+    inline __m128 interpolationFactor(__m128 aTime, __m128 aPreviousTime, __m128 aNextTime) {
+        const __m128 span = _mm_max_ps(_mm_sub_ps(aNextTime, aPreviousTime), _mm_set1_ps(1e-12f));
+        const __m128 alpha = _mm_div_ps(_mm_sub_ps(aTime, aPreviousTime), span);
+        return _mm_min_ps(_mm_max_ps(alpha, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    }
+
+    // Writes four lanes of x, y, z into consecutive Vector3f, stopping at aCount.
+    inline void storeVectors(Vector3f* someVectors, __m128 x, __m128 y, __m128 z, K_UINT aCount) {
+        __declspec(align(16)) float lanes[3][4];
+        _mm_store_ps(lanes[0], x);
+        _mm_store_ps(lanes[1], y);
+        _mm_store_ps(lanes[2], z);
+        for (K_UINT i = 0; i < aCount; ++i) {
+            someVectors[i].x = lanes[0][i];
+            someVectors[i].y = lanes[1][i];
+            someVectors[i].z = lanes[2][i];
+        }
+    }
+
+    // Loads four consecutive quaternions into component registers.
+    inline void loadQuaternions(const Quaternion* someQuats, __m128& x, __m128& y, __m128& z, __m128& w) {
+        x = _mm_loadu_ps(&someQuats[0].x);
+        y = _mm_loadu_ps(&someQuats[1].x);
+        z = _mm_loadu_ps(&someQuats[2].x);
+        w = _mm_loadu_ps(&someQuats[3].x);
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+    }
+
+    // Stores four quaternions held as component registers, stopping at aCount.
+    inline void storeQuaternions(Quaternion* someQuats, __m128 x, __m128 y, __m128 z, __m128 w, K_UINT aCount) {
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        const __m128 rows[4] = { x, y, z, w };
+        for (K_UINT i = 0; i < aCount; ++i)
+            _mm_storeu_ps(&someQuats[i].x, rows[i]);
+    }
+
+    // Normalizes four quaternions held as component registers.
+    inline void normalizeQuaternions(__m128& x, __m128& y, __m128& z, __m128& w) {
+        const __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)),
+                                                _mm_add_ps(_mm_mul_ps(z, z), _mm_mul_ps(w, w)));
+        const __m128 inverseLength = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(lengthSquared));
+        x = _mm_mul_ps(x, inverseLength);
+        y = _mm_mul_ps(y, inverseLength);
+        z = _mm_mul_ps(z, inverseLength);
+        w = _mm_mul_ps(w, inverseLength);
+    }
+}
+
+namespace KhaosEngine
+{
+    //
+    // LocalPose function definitions.
+    //
+
+    LocalPose LocalPose::Allocate(LinearAllocator& anArena, K_UINT aBoneCount) {
+        LocalPose pose;
+        pose.boneCount = aBoneCount;
+        pose.translations = anArena.allocateArray<Vector3f>(aBoneCount);
+        pose.rotations = anArena.allocateArray<Quaternion>(aBoneCount);
+        pose.scales = anArena.allocateArray<Vector3f>(aBoneCount);
+        return pose;
+    }
+
+    //
+    // AnimationClip function definitions.
+    //
+
+    AnimationClip::AnimationClip(K_UINT aBoneCount, float aDuration)
+        : mBoneCount(aBoneCount), mPaddedBoneCount((aBoneCount + 3) & ~3u), mDuration(aDuration) { }
+
+    void AnimationClip::addTranslationKey(K_UINT aBone, float aTime, const Vector3f& aTranslation) {
+        addKey(aBone, CHANNEL_TRANSLATION, aTime, aTranslation.x, aTranslation.y, aTranslation.z, 0.0f);
+    }
+
+    void AnimationClip::addRotationKey(K_UINT aBone, float aTime, const Quaternion& aRotation) {
+        addKey(aBone, CHANNEL_ROTATION, aTime, aRotation.x, aRotation.y, aRotation.z, aRotation.w);
+    }
+
+    void AnimationClip::addScaleKey(K_UINT aBone, float aTime, const Vector3f& aScale) {
+        addKey(aBone, CHANNEL_SCALE, aTime, aScale.x, aScale.y, aScale.z, 0.0f);
+    }
+
+    void AnimationClip::addKey(K_UINT aBone, AnimationChannel aChannel, float aTime,
+                               float x, float y, float z, float w) {
+        ASSERT(aBone < mBoneCount);
+        AnimationStreamKey key;
+        key.neededTime = 0.0f;
+        key.time = aTime;
+        key.track = aChannel * mPaddedBoneCount + aBone;
+        key.padding = 0;
+        key.value[0] = x;
+        key.value[1] = y;
+        key.value[2] = z;
+        key.value[3] = w;
+        mAuthoredKeys.push_back(key);
+    }
+
+    void AnimationClip::finalize() {
+        const K_UINT trackCount = getTrackCount();
+
+        mInitialKeys.resize(trackCount);
+        for (K_UINT track = 0; track < trackCount; ++track) {
+            AnimationStreamKey& key = mInitialKeys[track];
+            key.neededTime = 0.0f;
+            key.time = 0.0f;
+            key.track = track;
+            key.padding = 0;
+            for (K_INT i = 0; i < 4; ++i)
+                key.value[i] = DEFAULT_VALUES[track / mPaddedBoneCount][i];
+        }
+
+        // Each track's first key seeds the cursor. Every later key is needed once playback
+        // passes the key before it, which is when it becomes the upper bracket.
+        std::sort(mAuthoredKeys.begin(), mAuthoredKeys.end(), byTrackThenTime);
+        mStream.clear();
+        mStream.reserve(mAuthoredKeys.size());
+        for (size_t i = 0; i < mAuthoredKeys.size(); ++i) {
+            const AnimationStreamKey& key = mAuthoredKeys[i];
+            if (i == 0 || mAuthoredKeys[i - 1].track != key.track) {
+                mInitialKeys[key.track] = key;
+                continue;
+            }
+            mStream.push_back(key);
+            mStream.back().neededTime = mAuthoredKeys[i - 1].time;
+        }
+
+        // Stable so keys needed at the same moment stay grouped by track.
+        std::stable_sort(mStream.begin(), mStream.end(), byNeededTime);
+
+        std::vector<AnimationStreamKey>().swap(mAuthoredKeys);
+    }
+
+    //
+    // AnimationCursor function definitions.
+    //
+
+    AnimationCursor::AnimationCursor(const AnimationClip& aClip)
+        : mClip(&aClip), mStreamPosition(0), mTime(0.0f) {
+        const size_t trackCount = aClip.getTrackCount();
+        mWindow = static_cast<float*>(AlignedAlloc(sizeof(float) * trackCount * 10, SIMD_ALIGNMENT));
+        mPreviousTime = mWindow;
+        mNextTime = mWindow + trackCount;
+        for (K_INT i = 0; i < 4; ++i) {
+            mPrevious[i] = mWindow + trackCount * (2 + i);
+            mNext[i] = mWindow + trackCount * (6 + i);
+        }
+        rewind();
+    }
+
+    AnimationCursor::~AnimationCursor() {
+        AlignedFree(mWindow);
+    }
+
+    void AnimationCursor::rewind() {
+        const std::vector<AnimationStreamKey>& initialKeys = mClip->getInitialKeys();
+        for (size_t track = 0; track < initialKeys.size(); ++track) {
+            const AnimationStreamKey& key = initialKeys[track];
+            mPreviousTime[track] = key.time;
+            mNextTime[track] = key.time;
+            for (K_INT i = 0; i < 4; ++i) {
+                mPrevious[i][track] = key.value[i];
+                mNext[i][track] = key.value[i];
+            }
+        }
+        mStreamPosition = 0;
+        mTime = 0.0f;
+    }
+
+    void AnimationCursor::advanceTo(float aTime) {
+        if (aTime < mTime)
+            rewind();
+
+        const std::vector<AnimationStreamKey>& stream = mClip->getStream();
+        const size_t streamSize = stream.size();
+        while (mStreamPosition < streamSize && stream[mStreamPosition].neededTime <= aTime) {
+            const AnimationStreamKey& key = stream[mStreamPosition++];
+            const K_UINT track = key.track;
+            mPreviousTime[track] = mNextTime[track];
+            mNextTime[track] = key.time;
+            for (K_INT i = 0; i < 4; ++i) {
+                mPrevious[i][track] = mNext[i][track];
+                mNext[i][track] = key.value[i];
+            }
+        }
+        mTime = aTime;
+    }
+
+    void AnimationCursor::sample(float aTime, LocalPose& aPose) {
+        ASSERT(aPose.boneCount == mClip->getBoneCount());
+        advanceTo(aTime);
+
+        const K_UINT boneCount = mClip->getBoneCount();
+        const K_UINT paddedBoneCount = mClip->getPaddedBoneCount();
+        const __m128 time = _mm_set1_ps(aTime);
+        const __m128 signBit = _mm_set1_ps(-0.0f);
+
+        for (K_UINT bone = 0; bone < boneCount; bone += 4) {
+            const K_UINT laneCount = boneCount - bone < 4 ? boneCount - bone : 4;
+
+            // Translation and scale tracks lerp each component.
+            const K_UINT vectorChannels[2] = { CHANNEL_TRANSLATION, CHANNEL_SCALE };
+            Vector3f* vectorOutputs[2] = { aPose.translations, aPose.scales };
+            for (K_INT c = 0; c < 2; ++c) {
+                const K_UINT track = vectorChannels[c] * paddedBoneCount + bone;
+                const __m128 alpha = interpolationFactor(time, _mm_load_ps(mPreviousTime + track),
+                                                         _mm_load_ps(mNextTime + track));
+                __m128 components[3];
+                for (K_INT i = 0; i < 3; ++i) {
+                    const __m128 previous = _mm_load_ps(mPrevious[i] + track);
+                    const __m128 next = _mm_load_ps(mNext[i] + track);
+                    components[i] = multiplyAdd(_mm_sub_ps(next, previous), alpha, previous);
+                }
+                storeVectors(vectorOutputs[c] + bone, components[0], components[1], components[2], laneCount);
+            }
+
+            // Rotation tracks nlerp along the shortest arc, which for closely spaced keys stays
+            // within a fraction of a degree of slerp at a fraction of the cost. Lanes whose keys
+            // are further apart are slerped one at a time below.
+            const K_UINT track = CHANNEL_ROTATION * paddedBoneCount + bone;
+            const __m128 alpha = interpolationFactor(time, _mm_load_ps(mPreviousTime + track),
+                                                     _mm_load_ps(mNextTime + track));
+            __m128 previous[4];
+            __m128 next[4];
+            __m128 dot = _mm_setzero_ps();
+            for (K_INT i = 0; i < 4; ++i) {
+                previous[i] = _mm_load_ps(mPrevious[i] + track);
+                next[i] = _mm_load_ps(mNext[i] + track);
+                dot = multiplyAdd(previous[i], next[i], dot);
+            }
+            const __m128 flip = _mm_and_ps(dot, signBit);
+            __m128 rotation[4];
+            for (K_INT i = 0; i < 4; ++i)
+                rotation[i] = multiplyAdd(_mm_sub_ps(_mm_xor_ps(next[i], flip), previous[i]), alpha, previous[i]);
+            normalizeQuaternions(rotation[0], rotation[1], rotation[2], rotation[3]);
+            storeQuaternions(aPose.rotations + bone, rotation[0], rotation[1], rotation[2], rotation[3], laneCount);
+
+            const __m128 cosHalfAngle = _mm_andnot_ps(signBit, dot);
+            const K_INT wideLanes = _mm_movemask_ps(_mm_cmplt_ps(cosHalfAngle, _mm_set1_ps(NLERP_MIN_COS))) &
+                                    ((1 << laneCount) - 1);
+            if (wideLanes != 0) {
+                __declspec(align(16)) float alphas[4];
+                _mm_store_ps(alphas, alpha);
+                for (K_UINT lane = 0; lane < laneCount; ++lane) {
+                    if ((wideLanes & (1 << lane)) == 0)
+                        continue;
+                    const K_UINT laneTrack = track + lane;
+                    const Quaternion from(mPrevious[0][laneTrack], mPrevious[1][laneTrack], mPrevious[2][laneTrack],
+                                          mPrevious[3][laneTrack]);
+                    const Quaternion to(mNext[0][laneTrack], mNext[1][laneTrack], mNext[2][laneTrack], mNext[3][laneTrack]);
+                    aPose.rotations[bone + lane] = Quaternion::Slerp(from, to, alphas[lane]);
+                }
+            }
+        }
+    }
+
+    //
+    // Pose blending.
+    //
+
+    void BlendPoses(const LocalPose* somePoses, const float* someWeights, K_UINT aCount, LocalPose& aResult) {
+        ASSERT(aCount > 0);
+        const K_UINT boneCount = aResult.boneCount;
+        for (K_UINT p = 0; p < aCount; ++p)
+            ASSERT(somePoses[p].boneCount == boneCount);
+
+        // Translations and scales are flat float arrays, blended four floats at a time.
+        const size_t floatCount = static_cast<size_t>(boneCount) * 3;
+        for (K_INT channel = 0; channel < 2; ++channel) {
+            float* result = channel == 0 ? &aResult.translations[0].x : &aResult.scales[0].x;
+            size_t i = 0;
+            for (; i + 4 <= floatCount; i += 4) {
+                __m128 sum = _mm_setzero_ps();
+                for (K_UINT p = 0; p < aCount; ++p) {
+                    const float* source = channel == 0 ? &somePoses[p].translations[0].x : &somePoses[p].scales[0].x;
+                    sum = multiplyAdd(_mm_loadu_ps(source + i), _mm_set1_ps(someWeights[p]), sum);
+                }
+                _mm_storeu_ps(result + i, sum);
+            }
+            for (; i < floatCount; ++i) {
+                float sum = 0.0f;
+                for (K_UINT p = 0; p < aCount; ++p) {
+                    const float* source = channel == 0 ? &somePoses[p].translations[0].x : &somePoses[p].scales[0].x;
+                    sum += source[i] * someWeights[p];
+                }
+                result[i] = sum;
+            }
+        }
+
+        // Rotations are sign aligned to the first pose, summed and renormalized, four bones at a time.
+        const __m128 signBit = _mm_set1_ps(-0.0f);
+        K_UINT bone = 0;
+        for (; bone + 4 <= boneCount; bone += 4) {
+            __m128 reference[4];
+            loadQuaternions(somePoses[0].rotations + bone, reference[0], reference[1], reference[2], reference[3]);
+            const __m128 firstWeight = _mm_set1_ps(someWeights[0]);
+            __m128 sum[4];
+            for (K_INT i = 0; i < 4; ++i)
+                sum[i] = _mm_mul_ps(reference[i], firstWeight);
+
+            for (K_UINT p = 1; p < aCount; ++p) {
+                __m128 rotation[4];
+                loadQuaternions(somePoses[p].rotations + bone, rotation[0], rotation[1], rotation[2], rotation[3]);
+                __m128 dot = _mm_setzero_ps();
+                for (K_INT i = 0; i < 4; ++i)
+                    dot = multiplyAdd(reference[i], rotation[i], dot);
+                const __m128 weight = _mm_xor_ps(_mm_set1_ps(someWeights[p]), _mm_and_ps(dot, signBit));
+                for (K_INT i = 0; i < 4; ++i)
+                    sum[i] = multiplyAdd(rotation[i], weight, sum[i]);
+            }
+
+            normalizeQuaternions(sum[0], sum[1], sum[2], sum[3]);
+            storeQuaternions(aResult.rotations + bone, sum[0], sum[1], sum[2], sum[3], 4);
+        }
+
+        for (; bone < boneCount; ++bone) {
+            const Quaternion reference = somePoses[0].rotations[bone];
+            Quaternion sum = reference * someWeights[0];
+            for (K_UINT p = 1; p < aCount; ++p) {
+                const Quaternion& rotation = somePoses[p].rotations[bone];
+                sum += rotation * (reference.dot(rotation) < 0.0f ? -someWeights[p] : someWeights[p]);
+            }
+            aResult.rotations[bone] = sum / sum.getMagnitude();
+        }
+    }
+}
\ No newline at end of file
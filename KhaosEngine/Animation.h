@@ -0,0 +1,134 @@
+#pragma once
+
+// Animation.h
+// Skeletal animation clips stored as a single forward-playback key stream, per-instance
+// cursors that walk that stream, and batched sampling and blending of whole poses.
+//
+// Every bone has a translation, rotation and scale track. Rather than binary searching each
+// track, a clip interleaves all keys into one array sorted by the time each key is first
+// needed. A cursor keeps the two keys bracketing the current time for every track and only
+// ever reads forward, so the next key it needs is always the next one in memory.
+
+#include "Common.h"
+#include "KhaosMath.h"
+#include "LinearAllocator.h"
+
+#include <vector>
+
+namespace KhaosEngine
+{
+    using KhaosMath::Vector3f;
+    using KhaosMath::Quaternion;
+
+    enum AnimationChannel
+    {
+        CHANNEL_TRANSLATION = 0,
+        CHANNEL_ROTATION = 1,
+        CHANNEL_SCALE = 2,
+        CHANNEL_COUNT = 3
+    };
+
+    // Local space transforms for every bone of a skeleton, stored as parallel arrays.
+    // The pose does not own its arrays; allocate them from a frame or linear allocator.
+    struct LocalPose
+    {
+        K_UINT boneCount;
+        Vector3f* translations;
+        Quaternion* rotations;
+        Vector3f* scales;
+
+        // Allocates uninitialized arrays for aBoneCount bones from anArena.
+        static LocalPose Allocate(LinearAllocator& anArena, K_UINT aBoneCount);
+    };
+
+    // One key in a clip's playback stream. Two keys per cache line.
+    struct AnimationStreamKey
+    {
+        float neededTime;   // Playback time at which the cursor must load this key.
+        float time;         // Time of the key itself.
+        K_UINT track;       // channel * paddedBoneCount + bone.
+        K_UINT padding;
+        float value[4];
+    };
+
+    class AnimationClip
+    {
+    public:
+        AnimationClip(K_UINT aBoneCount, float aDuration);
+
+        // Keys may be added in any order, but each track's key times must be unique.
+        void addTranslationKey(K_UINT aBone, float aTime, const Vector3f& aTranslation);
+        void addRotationKey(K_UINT aBone, float aTime, const Quaternion& aRotation);
+        void addScaleKey(K_UINT aBone, float aTime, const Vector3f& aScale);
+
+        // Sorts the authored keys into the playback stream. Tracks without keys hold the
+        // identity transform. Must be called once after all keys are added and before sampling.
+        void finalize();
+
+        K_UINT getBoneCount() const { return mBoneCount; }
+        K_UINT getPaddedBoneCount() const { return mPaddedBoneCount; }
+        K_UINT getTrackCount() const { return mPaddedBoneCount * CHANNEL_COUNT; }
+        float getDuration() const { return mDuration; }
+
+        const std::vector<AnimationStreamKey>& getStream() const { return mStream; }
+        const std::vector<AnimationStreamKey>& getInitialKeys() const { return mInitialKeys; }
+
+    private:
+        void addKey(K_UINT aBone, AnimationChannel aChannel, float aTime,
+                    float x, float y, float z, float w);
+
+        K_UINT mBoneCount;
+        K_UINT mPaddedBoneCount;
+        float mDuration;
+
+        // First key of every track, used to reset cursors. Indexed by track.
+        std::vector<AnimationStreamKey> mInitialKeys;
+
+        // Every remaining key, sorted by neededTime.
+        std::vector<AnimationStreamKey> mStream;
+
+        // Authored keys, released by finalize.
+        std::vector<AnimationStreamKey> mAuthoredKeys;
+    };
+
+    // Playback state of one clip on one instance. Holds the bracketing keys of every track
+    // in structure-of-arrays form so sampling can interpolate four tracks per SSE operation.
+    // Creating a cursor is the only allocation; sampling never allocates.
+    class AnimationCursor
+    {
+    public:
+        explicit AnimationCursor(const AnimationClip& aClip);
+        ~AnimationCursor();
+
+        // Samples every bone of the clip at aTime into aPose.
+        // Advancing forward only reads new keys; moving backwards rewinds to the clip start.
+        void sample(float aTime, LocalPose& aPose);
+
+        // Returns the cursor to the start of the clip.
+        void rewind();
+
+        const AnimationClip& getClip() const { return *mClip; }
+
+    private:
+        AnimationCursor(const AnimationCursor&) = delete;
+        AnimationCursor& operator=(const AnimationCursor&) = delete;
+
+        void advanceTo(float aTime);
+
+        const AnimationClip* mClip;
+        size_t mStreamPosition;
+        float mTime;
+
+        // Each array holds one entry per track.
+        float* mWindow;
+        float* mPreviousTime;
+        float* mNextTime;
+        float* mPrevious[4];
+        float* mNext[4];
+    };
+
+    // Blends aCount poses into aResult using aWeights, which should sum to one.
+    // Translations and scales are weighted sums; rotations are sign-aligned to the first pose,
+    // summed and renormalized. All poses must have the same bone count. aResult may alias aPoses[0].
+    void BlendPoses(const LocalPose* somePoses, const float* someWeights, K_UINT aCount, LocalPose& aResult);
+}
\ No newline at end of file
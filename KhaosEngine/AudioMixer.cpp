@@ -0,0 +1,483 @@
+// AudioMixer.cpp
+// Command ring, batched spatialization, resampling and SSE mixing, and the SDL and memory outputs.
+
+#include "AudioMixer.h"
+#include "Memory.h"
+
+#include <SDL.h>
+
+#include <algorithm>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace KhaosEngine
+{
+    namespace
+    {
+        const KUI_64 FIXED_ONE = static_cast<KUI_64>(1) << 32;
+
+        // Gains below this are inaudible in float output, so a voice this quiet is not mixed.
+        const float SILENT_GAIN = 1.0e-5f;
+
+        // Slots in a handle's low half, generations in the high half.
+        VoiceHandle makeHandle(K_UINT aSlot, KUI_16 aGeneration) {
+            return static_cast<VoiceHandle>(aSlot) | (static_cast<VoiceHandle>(aGeneration) << 16);
+        }
+
+        // Fraction of a 32.32 position as a float, from its top 24 bits so the conversion is exact.
+        float fraction(KUI_64 aPosition) {
+            return static_cast<float>(static_cast<KUI_32>(aPosition) >> 8) * (1.0f / 16777216.0f);
+        }
+
+        K_UINT roundUpToFour(K_UINT aValue) {
+            return (aValue + 3) & ~3u;
+        }
+
+        // Linearly interpolates aCount frames from someSamples, every index + 1 of which must
+        // lie inside the clip.
+        void interpolateRun(const float* someSamples, KUI_64 aPosition, KUI_64 aStep, float* someOutput, K_UINT aCount) {
+            if (aStep == FIXED_ONE && static_cast<KUI_32>(aPosition) == 0) {
+                memcpy(someOutput, someSamples + (aPosition >> 32), aCount * sizeof(float));
+                return;
+            }
+
+            K_UINT frame = 0;
+            for (; frame + 4 <= aCount; frame += 4) {
+                const KUI_64 p0 = aPosition;
+                const KUI_64 p1 = p0 + aStep;
+                const KUI_64 p2 = p1 + aStep;
+                const KUI_64 p3 = p2 + aStep;
+                const float* s0 = someSamples + (p0 >> 32);
+                const float* s1 = someSamples + (p1 >> 32);
+                const float* s2 = someSamples + (p2 >> 32);
+                const float* s3 = someSamples + (p3 >> 32);
+                const __m128 current = _mm_setr_ps(s0[0], s1[0], s2[0], s3[0]);
+                const __m128 next = _mm_setr_ps(s0[1], s1[1], s2[1], s3[1]);
+                const __m128 weight = _mm_setr_ps(fraction(p0), fraction(p1), fraction(p2), fraction(p3));
+                _mm_storeu_ps(someOutput + frame, _mm_add_ps(current, _mm_mul_ps(_mm_sub_ps(next, current), weight)));
+                aPosition = p3 + aStep;
+            }
+            for (; frame < aCount; ++frame) {
+                const float* sample = someSamples + (aPosition >> 32);
+                someOutput[frame] = sample[0] + (sample[1] - sample[0]) * fraction(aPosition);
+                aPosition += aStep;
+            }
+        }
+
+        // Adds someSource into both channels with gains ramping linearly from the start gains
+        // to the end gains, reached on the last frame. aCount is a multiple of four and every
+        // buffer is aligned.
+        void accumulate(const float* someSource, float* aLeft, float* aRight, K_UINT aCount, float aStartLeft,
+                        float aStartRight, float anEndLeft, float anEndRight) {
+            const float scale = 1.0f / static_cast<float>(aCount);
+            const float deltaLeft = (anEndLeft - aStartLeft) * scale;
+            const float deltaRight = (anEndRight - aStartRight) * scale;
+            const __m128 ramp = _mm_setr_ps(1.0f, 2.0f, 3.0f, 4.0f);
+            __m128 gainLeft = _mm_add_ps(_mm_set1_ps(aStartLeft), _mm_mul_ps(_mm_set1_ps(deltaLeft), ramp));
+            __m128 gainRight = _mm_add_ps(_mm_set1_ps(aStartRight), _mm_mul_ps(_mm_set1_ps(deltaRight), ramp));
+            const __m128 stepLeft = _mm_set1_ps(4.0f * deltaLeft);
+            const __m128 stepRight = _mm_set1_ps(4.0f * deltaRight);
+            for (K_UINT frame = 0; frame < aCount; frame += 4) {
+                const __m128 sample = _mm_load_ps(someSource + frame);
+                _mm_store_ps(aLeft + frame, _mm_add_ps(_mm_load_ps(aLeft + frame), _mm_mul_ps(sample, gainLeft)));
+                _mm_store_ps(aRight + frame, _mm_add_ps(_mm_load_ps(aRight + frame), _mm_mul_ps(sample, gainRight)));
+                gainLeft = _mm_add_ps(gainLeft, stepLeft);
+                gainRight = _mm_add_ps(gainRight, stepRight);
+            }
+        }
+
+        void SDLCALL sdlAudioCallback(void* aUserData, Uint8* aStream, int aLength) {
+            AudioMixer* mixer = static_cast<AudioMixer*>(aUserData);
+            mixer->mix(reinterpret_cast<float*>(aStream), static_cast<K_UINT>(aLength) / (2 * sizeof(float)));
+        }
+    }
+
+    //
+    // AudioMixer function definitions.
+    //
+
+    AudioMixer::AudioMixer(const AudioMixerSettings& someSettings)
+        : mSettings(someSettings), mNextSlot(0), mDroppedCommandCount(0), mCommands(AUDIO_COMMAND_CAPACITY),
+          mCommandHead(0), mCommandTail(0), mActiveVoiceCount(0), mMixedVoiceCount(0), mVoices(MAX_AUDIO_VOICES),
+          mListenerRotation(0.0f, 0.0f, 0.0f, 1.0f) {
+        ASSERT(mSettings.sampleRate > 0 && mSettings.referenceDistance > 0.0f);
+        for (K_UINT slot = 0; slot < MAX_AUDIO_VOICES; ++slot) {
+            mGenerations[slot] = 0;
+            mFinishedGenerations[slot].store(0, std::memory_order_relaxed);
+            Voice& voice = mVoices[slot];
+            voice.clip = nullptr;
+            voice.position = 0;
+            voice.step = 0;
+            voice.gainLeft = 0.0f;
+            voice.gainRight = 0.0f;
+            voice.generation = 0;
+            voice.active = false;
+            voice.starting = false;
+            voice.stopping = false;
+            voice.looping = false;
+        }
+
+        const size_t floatCount = 7 * MAX_AUDIO_VOICES + 3 * MAX_AUDIO_BLOCK_FRAMES;
+        float* storage = static_cast<float*>(AlignedAlloc(floatCount * sizeof(float), SIMD_ALIGNMENT));
+        memset(storage, 0, floatCount * sizeof(float));
+        float** arrays[] = { &mEmitterX, &mEmitterY, &mEmitterZ, &mSpatial, &mVolume, &mTargetLeft, &mTargetRight };
+        for (float** array : arrays) {
+            *array = storage;
+            storage += MAX_AUDIO_VOICES;
+        }
+        mLeft = storage;
+        mRight = mLeft + MAX_AUDIO_BLOCK_FRAMES;
+        mScratch = mRight + MAX_AUDIO_BLOCK_FRAMES;
+    }
+
+    AudioMixer::~AudioMixer() {
+        AlignedFree(mEmitterX);
+    }
+
+    VoiceHandle AudioMixer::play(const AudioClip& aClip, const Vector3f& aPosition, const AudioVoiceSettings& someSettings) {
+        ASSERT(aClip.sampleRate > 0 && someSettings.pitch > 0.0f);
+        if (aClip.samples.empty())
+            return INVALID_VOICE;
+
+        K_UINT slot = mNextSlot;
+        K_UINT searched = 0;
+        for (; searched < MAX_AUDIO_VOICES; ++searched, slot = (slot + 1) % MAX_AUDIO_VOICES) {
+            if (mFinishedGenerations[slot].load(std::memory_order_acquire) == mGenerations[slot])
+                break;
+        }
+        if (searched == MAX_AUDIO_VOICES)
+            return INVALID_VOICE;
+
+        const double ratio = static_cast<double>(someSettings.pitch) * aClip.sampleRate / mSettings.sampleRate;
+        Command command = {};
+        command.type = CommandType::Play;
+        command.slot = static_cast<KUI_16>(slot);
+        command.generation = static_cast<KUI_16>(mGenerations[slot] + 1);
+        command.clip = &aClip;
+        command.position = aPosition;
+        command.step = std::max(static_cast<KUI_64>(ratio * static_cast<double>(FIXED_ONE) + 0.5), static_cast<KUI_64>(1));
+        command.volume = someSettings.volume;
+        command.looping = someSettings.looping;
+        command.spatial = someSettings.spatial;
+        if (!pushCommand(command))
+            return INVALID_VOICE;
+
+        mGenerations[slot] = command.generation;
+        mNextSlot = (slot + 1) % MAX_AUDIO_VOICES;
+        return makeHandle(slot, command.generation);
+    }
+
+    void AudioMixer::stop(VoiceHandle aVoice) {
+        Command command = {};
+        if (!findVoice(aVoice, command.slot, command.generation))
+            return;
+        command.type = CommandType::Stop;
+        pushCommand(command);
+    }
+
+    void AudioMixer::setVoicePosition(VoiceHandle aVoice, const Vector3f& aPosition) {
+        Command command = {};
+        if (!findVoice(aVoice, command.slot, command.generation))
+            return;
+        command.type = CommandType::SetPosition;
+        command.position = aPosition;
+        pushCommand(command);
+    }
+
+    void AudioMixer::setVoiceVolume(VoiceHandle aVoice, float aVolume) {
+        Command command = {};
+        if (!findVoice(aVoice, command.slot, command.generation))
+            return;
+        command.type = CommandType::SetVolume;
+        command.volume = aVolume;
+        pushCommand(command);
+    }
+
+    void AudioMixer::setListener(const Vector3f& aPosition, const Quaternion& aRotation) {
+        Command command = {};
+        command.type = CommandType::SetListener;
+        command.position = aPosition;
+        command.rotation = aRotation;
+        pushCommand(command);
+    }
+
+    bool AudioMixer::isPlaying(VoiceHandle aVoice) const {
+        KUI_16 slot, generation;
+        return findVoice(aVoice, slot, generation) &&
+               mFinishedGenerations[slot].load(std::memory_order_acquire) != generation;
+    }
+
+    bool AudioMixer::findVoice(VoiceHandle aVoice, KUI_16& aSlot, KUI_16& aGeneration) const {
+        aSlot = static_cast<KUI_16>(aVoice & 0xFFFF);
+        aGeneration = static_cast<KUI_16>(aVoice >> 16);
+        return aSlot < MAX_AUDIO_VOICES && mGenerations[aSlot] == aGeneration;
+    }
+
+    bool AudioMixer::pushCommand(const Command& aCommand) {
+        const KUI_64 head = mCommandHead.load(std::memory_order_relaxed);
+        if (head - mCommandTail.load(std::memory_order_acquire) == AUDIO_COMMAND_CAPACITY) {
+            ++mDroppedCommandCount;
+            return false;
+        }
+        mCommands[head & (AUDIO_COMMAND_CAPACITY - 1)] = aCommand;
+        mCommandHead.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    void AudioMixer::mix(float* someSamples, K_UINT aFrameCount) {
+        while (aFrameCount > 0) {
+            const K_UINT frameCount = std::min(aFrameCount, MAX_AUDIO_BLOCK_FRAMES);
+            mixBlock(someSamples, frameCount);
+            someSamples += 2 * frameCount;
+            aFrameCount -= frameCount;
+        }
+    }
+
+    void AudioMixer::applyCommands() {
+        const KUI_64 head = mCommandHead.load(std::memory_order_acquire);
+        KUI_64 tail = mCommandTail.load(std::memory_order_relaxed);
+        for (; tail != head; ++tail) {
+            const Command& command = mCommands[tail & (AUDIO_COMMAND_CAPACITY - 1)];
+            Voice& voice = mVoices[command.slot];
+            if (command.type == CommandType::SetListener) {
+                mListenerPosition = command.position;
+                mListenerRotation = command.rotation;
+            }
+            else if (command.type == CommandType::Play) {
+                voice.clip = command.clip;
+                voice.position = 0;
+                voice.step = command.step;
+                voice.gainLeft = 0.0f;
+                voice.gainRight = 0.0f;
+                voice.generation = command.generation;
+                voice.active = true;
+                voice.starting = true;
+                voice.stopping = false;
+                voice.looping = command.looping;
+                mEmitterX[command.slot] = command.position.x;
+                mEmitterY[command.slot] = command.position.y;
+                mEmitterZ[command.slot] = command.position.z;
+                mSpatial[command.slot] = command.spatial ? 1.0f : 0.0f;
+                mVolume[command.slot] = command.volume;
+            }
+            else if (voice.active && voice.generation == command.generation && !voice.stopping) {
+                if (command.type == CommandType::Stop) {
+                    voice.stopping = true;
+                    mVolume[command.slot] = 0.0f;
+                }
+                else if (command.type == CommandType::SetPosition) {
+                    mEmitterX[command.slot] = command.position.x;
+                    mEmitterY[command.slot] = command.position.y;
+                    mEmitterZ[command.slot] = command.position.z;
+                }
+                else {
+                    mVolume[command.slot] = command.volume;
+                }
+            }
+        }
+        mCommandTail.store(tail, std::memory_order_release);
+    }
+
+    void AudioMixer::spatialize() {
+        // The listener's right ear, its rotated +X axis.
+        const Quaternion& q = mListenerRotation;
+        const __m128 rightX = _mm_set1_ps(1.0f - 2.0f * (q.y * q.y + q.z * q.z));
+        const __m128 rightY = _mm_set1_ps(2.0f * (q.x * q.y + q.w * q.z));
+        const __m128 rightZ = _mm_set1_ps(2.0f * (q.x * q.z - q.w * q.y));
+        const __m128 listenerX = _mm_set1_ps(mListenerPosition.x);
+        const __m128 listenerY = _mm_set1_ps(mListenerPosition.y);
+        const __m128 listenerZ = _mm_set1_ps(mListenerPosition.z);
+        const __m128 reference = _mm_set1_ps(mSettings.referenceDistance);
+        const __m128 rolloff = _mm_set1_ps(mSettings.rolloffFactor);
+        const __m128 maxDistance = _mm_set1_ps(mSettings.maxDistance);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 closest = _mm_set1_ps(1.0e-6f);
+
+        for (K_UINT slot = 0; slot < MAX_AUDIO_VOICES; slot += 4) {
+            const __m128 dx = _mm_sub_ps(_mm_load_ps(mEmitterX + slot), listenerX);
+            const __m128 dy = _mm_sub_ps(_mm_load_ps(mEmitterY + slot), listenerY);
+            const __m128 dz = _mm_sub_ps(_mm_load_ps(mEmitterZ + slot), listenerZ);
+            const __m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+            const __m128 distance = _mm_sqrt_ps(_mm_max_ps(distanceSquared, closest));
+
+            // Inverse distance rolloff past the reference distance, cut off at the maximum.
+            const __m128 excess = _mm_max_ps(_mm_sub_ps(distance, reference), zero);
+            __m128 attenuation = _mm_div_ps(reference, _mm_add_ps(reference, _mm_mul_ps(rolloff, excess)));
+            attenuation = _mm_and_ps(attenuation, _mm_cmple_ps(distance, maxDistance));
+
+            // Sideways component of the direction to the emitter, -1 fully left to 1 fully right.
+            const __m128 side = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, rightX), _mm_mul_ps(dy, rightY)), _mm_mul_ps(dz, rightZ));
+            __m128 pan = _mm_min_ps(_mm_max_ps(_mm_div_ps(side, distance), _mm_set1_ps(-1.0f)), one);
+
+            // Centred voices blend to no attenuation and no pan.
+            const __m128 spatial = _mm_load_ps(mSpatial + slot);
+            attenuation = _mm_add_ps(one, _mm_mul_ps(spatial, _mm_sub_ps(attenuation, one)));
+            pan = _mm_mul_ps(pan, spatial);
+
+            const __m128 gain = _mm_mul_ps(attenuation, _mm_load_ps(mVolume + slot));
+            const __m128 left = _mm_sqrt_ps(_mm_mul_ps(half, _mm_sub_ps(one, pan)));
+            const __m128 right = _mm_sqrt_ps(_mm_mul_ps(half, _mm_add_ps(one, pan)));
+            _mm_store_ps(mTargetLeft + slot, _mm_mul_ps(gain, left));
+            _mm_store_ps(mTargetRight + slot, _mm_mul_ps(gain, right));
+        }
+    }
+
+    bool AudioMixer::resample(Voice& aVoice, float* someOutput, K_UINT aFrameCount) const {
+        const float* samples = aVoice.clip->samples.data();
+        const KUI_64 length = aVoice.clip->samples.size();
+        const KUI_64 end = length << 32;
+        const KUI_64 lastSample = (length - 1) << 32;
+        KUI_64 position = aVoice.position;
+        K_UINT frame = 0;
+        while (frame < aFrameCount) {
+            if (position >= end) {
+                if (!aVoice.looping) {
+                    memset(someOutput + frame, 0, (aFrameCount - frame) * sizeof(float));
+                    aVoice.position = position;
+                    return false;
+                }
+                position %= end;
+            }
+            else if (position < lastSample) {
+                // Every frame before the last sample interpolates inside the clip.
+                const KUI_64 inside = (lastSample - position - 1) / aVoice.step + 1;
+                const K_UINT count = static_cast<K_UINT>(std::min<KUI_64>(inside, aFrameCount - frame));
+                interpolateRun(samples, position, aVoice.step, someOutput + frame, count);
+                position += aVoice.step * count;
+                frame += count;
+            }
+            else {
+                // Past the last sample, blend towards the start of a loop or into silence.
+                const float current = samples[length - 1];
+                const float next = aVoice.looping ? samples[0] : 0.0f;
+                someOutput[frame++] = current + (next - current) * fraction(position);
+                position += aVoice.step;
+            }
+        }
+        aVoice.position = position;
+        return true;
+    }
+
+    bool AudioMixer::advance(Voice& aVoice, K_UINT aFrameCount) const {
+        const KUI_64 end = static_cast<KUI_64>(aVoice.clip->samples.size()) << 32;
+        aVoice.position += aVoice.step * aFrameCount;
+        if (aVoice.position < end)
+            return true;
+        if (!aVoice.looping)
+            return false;
+        aVoice.position %= end;
+        return true;
+    }
+
+    void AudioMixer::release(K_UINT aSlot) {
+        Voice& voice = mVoices[aSlot];
+        voice.active = false;
+        voice.clip = nullptr;
+        mVolume[aSlot] = 0.0f;
+        mFinishedGenerations[aSlot].store(voice.generation, std::memory_order_release);
+    }
+
+    void AudioMixer::mixBlock(float* someSamples, K_UINT aFrameCount) {
+        applyCommands();
+        spatialize();
+
+        const K_UINT paddedCount = roundUpToFour(aFrameCount);
+        memset(mLeft, 0, paddedCount * sizeof(float));
+        memset(mRight, 0, paddedCount * sizeof(float));
+
+        K_UINT activeCount = 0;
+        K_UINT mixedCount = 0;
+        for (K_UINT slot = 0; slot < MAX_AUDIO_VOICES; ++slot) {
+            Voice& voice = mVoices[slot];
+            if (!voice.active)
+                continue;
+            ++activeCount;
+
+            const float targetLeft = mTargetLeft[slot];
+            const float targetRight = mTargetRight[slot];
+            if (voice.starting) {
+                voice.gainLeft = targetLeft;
+                voice.gainRight = targetRight;
+                voice.starting = false;
+            }
+
+            bool playing;
+            if (std::max(std::max(voice.gainLeft, voice.gainRight), std::max(targetLeft, targetRight)) < SILENT_GAIN) {
+                playing = advance(voice, aFrameCount);
+            }
+            else {
+                playing = resample(voice, mScratch, aFrameCount);
+                for (K_UINT frame = aFrameCount; frame < paddedCount; ++frame)
+                    mScratch[frame] = 0.0f;
+                accumulate(mScratch, mLeft, mRight, paddedCount, voice.gainLeft, voice.gainRight, targetLeft, targetRight);
+                ++mixedCount;
+            }
+            voice.gainLeft = targetLeft;
+            voice.gainRight = targetRight;
+
+            if (!playing || voice.stopping)
+                release(slot);
+        }
+        mActiveVoiceCount.store(activeCount, std::memory_order_relaxed);
+        mMixedVoiceCount.store(mixedCount, std::memory_order_relaxed);
+
+        // Interleave into the output, clipping to the valid range.
+        const __m128 master = _mm_set1_ps(mSettings.masterVolume);
+        const __m128 lowest = _mm_set1_ps(-1.0f);
+        const __m128 highest = _mm_set1_ps(1.0f);
+        K_UINT frame = 0;
+        for (; frame + 4 <= aFrameCount; frame += 4) {
+            const __m128 left = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_load_ps(mLeft + frame), master), lowest), highest);
+            const __m128 right = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_load_ps(mRight + frame), master), lowest), highest);
+            _mm_storeu_ps(someSamples + 2 * frame, _mm_unpacklo_ps(left, right));
+            _mm_storeu_ps(someSamples + 2 * frame + 4, _mm_unpackhi_ps(left, right));
+        }
+        for (; frame < aFrameCount; ++frame) {
+            someSamples[2 * frame] = std::min(std::max(mLeft[frame] * mSettings.masterVolume, -1.0f), 1.0f);
+            someSamples[2 * frame + 1] = std::min(std::max(mRight[frame] * mSettings.masterVolume, -1.0f), 1.0f);
+        }
+    }
+
+    //
+    // SdlAudioOutput function definitions.
+    //
+
+    bool SdlAudioOutput::open(K_UINT aBlockFrames) {
+        close();
+        SDL_AudioSpec desired;
+        SDL_zero(desired);
+        desired.freq = static_cast<int>(mMixer.getSampleRate());
+        desired.format = AUDIO_F32SYS;
+        desired.channels = 2;
+        desired.samples = static_cast<Uint16>(aBlockFrames);
+        desired.callback = sdlAudioCallback;
+        desired.userdata = &mMixer;
+
+        // Without an obtained spec SDL converts from exactly this format if the device differs.
+        mDevice = SDL_OpenAudioDevice(nullptr, 0, &desired, nullptr, 0);
+        if (mDevice == 0)
+            return false;
+        SDL_PauseAudioDevice(mDevice, 0);
+        return true;
+    }
+
+    void SdlAudioOutput::close() {
+        if (mDevice == 0)
+            return;
+        SDL_CloseAudioDevice(mDevice);
+        mDevice = 0;
+    }
+
+    //
+    // MemoryAudioOutput function definitions.
+    //
+
+    void MemoryAudioOutput::render(K_UINT aFrameCount) {
+        const size_t start = mSamples.size();
+        mSamples.resize(start + 2 * static_cast<size_t>(aFrameCount));
+        for (K_UINT frame = 0; frame < aFrameCount; frame += mBlockFrames)
+            mMixer.mix(mSamples.data() + start + 2 * frame, std::min(mBlockFrames, aFrameCount - frame));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,256 @@
+#pragma once
+
+// AudioMixer.h
+// Software mixer that plays hundreds of positional sound effects through one stereo stream.
+//
+// The game thread starts, moves and stops voices and sets the listener; the audio thread,
+// usually a device callback, pulls mixed blocks with mix. The two only talk through a fixed
+// size command ring and one atomic per voice slot, so the audio thread never locks or
+// allocates and a slow game frame can never make the device run dry.
+//
+// Each block the mixer:
+//     1. Applies the commands queued since the last block.
+//     2. Computes the target left and right gains of every voice slot from the listener and
+//        emitter positions, four voices at a time with SSE.
+//     3. Resamples each audible voice to the output rate with linear interpolation and adds
+//        it into the block, ramping from last block's gains to the new ones so that moving,
+//        starting and stopping voices never click. Voices out of earshot only advance.
+//
+// Panning is constant power: a centred voice plays at 0.707 in both channels.
+
+#include "Common.h"
+#include "KhaosMath.h"
+
+#include <atomic>
+#include <vector>
+
+namespace KhaosEngine
+{
+    using KhaosMath::Vector3f;
+    using KhaosMath::Quaternion;
+
+    // Voices that can play at once. A multiple of four.
+    const K_UINT MAX_AUDIO_VOICES = 256;
+
+    // Longest block mixed in one pass. Longer mix calls are split.
+    const K_UINT MAX_AUDIO_BLOCK_FRAMES = 1024;
+
+    // Commands the game thread can queue between two blocks. A power of two.
+    const K_UINT AUDIO_COMMAND_CAPACITY = 4096;
+
+    // Identifies one play of a sound. Stale handles are ignored.
+    typedef KUI_32 VoiceHandle;
+    const VoiceHandle INVALID_VOICE = 0xFFFFFFFF;
+
+    // Mono sound data. Must outlive every voice playing it.
+    struct AudioClip
+    {
+        std::vector<float> samples;
+        K_UINT sampleRate;
+    };
+
+    struct AudioMixerSettings
+    {
+        K_UINT sampleRate; // Output frames per second.
+        float referenceDistance; // Spatial voices closer than this play at full volume.
+        float rolloffFactor; // Gain is referenceDistance / (referenceDistance + rolloffFactor * (distance - referenceDistance)).
+        float maxDistance; // Spatial voices further away are silent and not mixed.
+        float masterVolume;
+
+        AudioMixerSettings()
+            : sampleRate(48000), referenceDistance(1.0f), rolloffFactor(1.0f), maxDistance(100.0f), masterVolume(1.0f) { }
+    };
+
+    struct AudioVoiceSettings
+    {
+        float volume;
+        float pitch; // Playback speed, so 2 plays an octave up in half the time.
+        bool looping;
+        bool spatial; // Otherwise the voice plays centred at full volume wherever it is.
+
+        AudioVoiceSettings()
+            : volume(1.0f), pitch(1.0f), looping(false), spatial(true) { }
+    };
+
+    class AudioMixer
+    {
+    public:
+        explicit AudioMixer(const AudioMixerSettings& someSettings);
+        ~AudioMixer();
+
+        // Starts aClip at aPosition. Returns INVALID_VOICE if every voice is busy or the
+        // command ring is full. Game thread only, like every call up to mix.
+        VoiceHandle play(const AudioClip& aClip, const Vector3f& aPosition, const AudioVoiceSettings& someSettings);
+
+        // Fades the voice out over the next block.
+        void stop(VoiceHandle aVoice);
+
+        void setVoicePosition(VoiceHandle aVoice, const Vector3f& aPosition);
+        void setVoiceVolume(VoiceHandle aVoice, float aVolume);
+
+        // The listener's local +X axis points out of its right ear.
+        void setListener(const Vector3f& aPosition, const Quaternion& aRotation);
+
+        // Returns true until the voice has finished or been stopped and faded out.
+        bool isPlaying(VoiceHandle aVoice) const;
+
+        // Writes aFrameCount frames of interleaved stereo to someSamples. Audio thread only.
+        void mix(float* someSamples, K_UINT aFrameCount);
+
+        K_UINT getSampleRate() const { return mSettings.sampleRate; }
+
+        // Voices playing and voices close enough to be mixed in the last block.
+        K_UINT getActiveVoiceCount() const { return mActiveVoiceCount.load(std::memory_order_relaxed); }
+        K_UINT getMixedVoiceCount() const { return mMixedVoiceCount.load(std::memory_order_relaxed); }
+
+        // Commands lost because the ring was full.
+        KUI_64 getDroppedCommandCount() const { return mDroppedCommandCount; }
+
+    private:
+        AudioMixer(const AudioMixer&) = delete;
+        AudioMixer& operator=(const AudioMixer&) = delete;
+
+        enum class CommandType : KUI_8
+        {
+            Play,
+            Stop,
+            SetPosition,
+            SetVolume,
+            SetListener
+        };
+
+        struct Command
+        {
+            Quaternion rotation; // SetListener.
+            Vector3f position; // Play, SetPosition and SetListener.
+            const AudioClip* clip; // Play.
+            KUI_64 step; // Play.
+            float volume; // Play and SetVolume.
+            CommandType type;
+            bool looping; // Play.
+            bool spatial; // Play.
+            KUI_16 slot;
+            KUI_16 generation;
+        };
+
+        // Audio thread state of a voice slot. Positions and gains live in the arrays below.
+        struct Voice
+        {
+            const AudioClip* clip;
+            KUI_64 position; // Sample index in 32.32 fixed point.
+            KUI_64 step; // Source samples per output frame, also 32.32.
+            float gainLeft; // Gains reached at the end of the last block.
+            float gainRight;
+            KUI_16 generation;
+            bool active;
+            bool starting; // Takes its first gains without a ramp.
+            bool stopping;
+            bool looping;
+        };
+
+        bool pushCommand(const Command& aCommand);
+
+        // Decodes aVoice into its slot, or returns false if it is not the current play.
+        bool findVoice(VoiceHandle aVoice, KUI_16& aSlot, KUI_16& aGeneration) const;
+
+        void applyCommands();
+        void mixBlock(float* someSamples, K_UINT aFrameCount);
+
+        // Fills mTargetLeft and mTargetRight for every slot.
+        void spatialize();
+
+        // Resamples aFrameCount frames of aVoice into someOutput. Returns false once a one
+        // shot voice has run out, having filled the remainder with silence.
+        bool resample(Voice& aVoice, float* someOutput, K_UINT aFrameCount) const;
+
+        // Moves aVoice on without producing samples. Returns false once a one shot voice ends.
+        bool advance(Voice& aVoice, K_UINT aFrameCount) const;
+
+        void release(K_UINT aSlot);
+
+        AudioMixerSettings mSettings;
+
+        // Game thread.
+        KUI_16 mGenerations[MAX_AUDIO_VOICES]; // Generation of the latest play of each slot.
+        K_UINT mNextSlot;
+        KUI_64 mDroppedCommandCount;
+
+        // Shared. A slot is free once its finished generation catches up with its generation.
+        std::atomic<KUI_16> mFinishedGenerations[MAX_AUDIO_VOICES];
+        std::vector<Command> mCommands;
+        std::atomic<KUI_64> mCommandHead; // Written by the game thread.
+        std::atomic<KUI_64> mCommandTail; // Written by the audio thread.
+        std::atomic<K_UINT> mActiveVoiceCount;
+        std::atomic<K_UINT> mMixedVoiceCount;
+
+        // Audio thread. The float arrays share one aligned allocation.
+        std::vector<Voice> mVoices;
+        Vector3f mListenerPosition;
+        Quaternion mListenerRotation;
+        float* mEmitterX; // MAX_AUDIO_VOICES each.
+        float* mEmitterY;
+        float* mEmitterZ;
+        float* mSpatial; // 1 for spatial voices, 0 for centred ones.
+        float* mVolume; // 0 for free and stopping slots.
+        float* mTargetLeft;
+        float* mTargetRight;
+        float* mLeft; // MAX_AUDIO_BLOCK_FRAMES each.
+        float* mRight;
+        float* mScratch;
+    };
+
+    // Plays an AudioMixer on the default SDL audio device. SDL must be initialized with
+    // SDL_INIT_AUDIO, and the mixer is called from SDL's audio thread.
+    class SdlAudioOutput
+    {
+    public:
+        explicit SdlAudioOutput(AudioMixer& aMixer)
+            : mMixer(aMixer), mDevice(0) { }
+
+        ~SdlAudioOutput() {
+            close();
+        }
+
+        // Opens the device and starts playback with blocks of aBlockFrames. Returns false on
+        // failure, with the reason in SDL_GetError.
+        bool open(K_UINT aBlockFrames);
+
+        void close();
+
+    private:
+        SdlAudioOutput(const SdlAudioOutput&) = delete;
+        SdlAudioOutput& operator=(const SdlAudioOutput&) = delete;
+
+        AudioMixer& mMixer;
+        KUI_32 mDevice; // SDL_AudioDeviceID.
+    };
+
+    // Stands in for a device in tests and offline renders: pulls blocks on the calling thread
+    // and keeps them in memory.
+    class MemoryAudioOutput
+    {
+    public:
+        MemoryAudioOutput(AudioMixer& aMixer, K_UINT aBlockFrames)
+            : mMixer(aMixer), mBlockFrames(aBlockFrames) {
+            ASSERT(aBlockFrames > 0);
+        }
+
+        // Mixes aFrameCount more frames in device sized blocks and appends them.
+        void render(K_UINT aFrameCount);
+
+        // Interleaved stereo frames rendered since the last clear.
+        const std::vector<float>& getSamples() const { return mSamples; }
+
+        void clear() {
+            mSamples.clear();
+        }
+
+    private:
+        MemoryAudioOutput(const MemoryAudioOutput&) = delete;
+        MemoryAudioOutput& operator=(const MemoryAudioOutput&) = delete;
+
+        AudioMixer& mMixer;
+        K_UINT mBlockFrames;
+        std::vector<float> mSamples;
+    };
+}
\ No newline at end of file
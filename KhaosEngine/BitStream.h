@@ -0,0 +1,257 @@
+#pragma once
+
+// BitStream.h
+// Bit packed binary writer and reader over caller owned memory, for snapshots, replays and
+// network packets. Bits are gathered in a 64-bit register and moved to memory a 32-bit word
+// at a time, little endian. Neither class allocates, and the reader decodes straight from
+// the source buffer without copying it.
+//
+// Running past the end of the buffer never writes or reads out of bounds. The stream is
+// marked as overflowed instead, reads return zero from then on, and callers check
+// hasOverflowed once at the end rather than after every field.
+
+#include "Common.h"
+#include "KhaosMath.h"
+
+#include <cstring>
+
+namespace KhaosEngine
+{
+    using KhaosMath::Vector3f;
+    using KhaosMath::Quaternion;
+    using KhaosMath::Matrix4x4f;
+
+    class BitWriter
+    {
+    public:
+        // Writes into aByteCapacity bytes at aBuffer.
+        BitWriter(void* aBuffer, size_t aByteCapacity)
+            : mBuffer(static_cast<KUI_8*>(aBuffer)), mCapacity(aByteCapacity), mByteOffset(0),
+              mScratch(0), mScratchBits(0), mOverflowed(false) { }
+
+        // Writes the low aBitCount bits of aValue. aBitCount must be between 0 and 32.
+        void writeBits(KUI_32 aValue, K_UINT aBitCount) {
+            ASSERT(aBitCount <= 32);
+            const KUI_64 mask = (static_cast<KUI_64>(1) << aBitCount) - 1;
+            mScratch |= (static_cast<KUI_64>(aValue) & mask) << mScratchBits;
+            mScratchBits += aBitCount;
+            if (mScratchBits >= 32) {
+                writeWord(static_cast<KUI_32>(mScratch));
+                mScratch >>= 32;
+                mScratchBits -= 32;
+            }
+        }
+
+        void writeBool(bool aValue) {
+            writeBits(aValue ? 1u : 0u, 1);
+        }
+
+        // Writes the exact bit pattern of a float.
+        void writeFloat(float aValue) {
+            KUI_32 bits;
+            memcpy(&bits, &aValue, sizeof(bits));
+            writeBits(bits, 32);
+        }
+
+        // Writes aValue clamped to [aMinimum, aMaximum] and rounded to aBitCount bits, at most 24.
+        void writeQuantized(float aValue, float aMinimum, float aMaximum, K_UINT aBitCount) {
+            ASSERT(aBitCount <= 24);
+            const float steps = static_cast<float>((static_cast<KUI_64>(1) << aBitCount) - 1);
+            const float normalized = KhaosMath::ClampInclusive((aValue - aMinimum) / (aMaximum - aMinimum), 0.0f, 1.0f);
+            writeBits(static_cast<KUI_32>(normalized * steps + 0.5f), aBitCount);
+        }
+
+        // Lossless writers for the math types.
+        void writeVector3f(const Vector3f& aVector) {
+            writeFloat(aVector.x);
+            writeFloat(aVector.y);
+            writeFloat(aVector.z);
+        }
+
+        void writeQuaternion(const Quaternion& aQuat) {
+            writeFloat(aQuat.x);
+            writeFloat(aQuat.y);
+            writeFloat(aQuat.z);
+            writeFloat(aQuat.w);
+        }
+
+        void writeMatrix4x4f(const Matrix4x4f& aMatrix) {
+            for (K_INT row = 0; row < 4; ++row)
+                for (K_INT col = 0; col < 4; ++col)
+                    writeFloat(aMatrix(row, col));
+        }
+
+        // Pads to the next byte boundary and copies aByteCount raw bytes, so a reader can
+        // later hand out a pointer to them in place.
+        void writeAlignedBytes(const void* someBytes, size_t aByteCount) {
+            flush();
+            if (mOverflowed || aByteCount > mCapacity - mByteOffset) {
+                mOverflowed = true;
+                return;
+            }
+            memcpy(mBuffer + mByteOffset, someBytes, aByteCount);
+            mByteOffset += aByteCount;
+        }
+
+        // Moves any buffered bits to memory, padding the last byte with zeros.
+        // Call once after the last write; getByteCount is exact afterwards.
+        void flush() {
+            while (mScratchBits > 0) {
+                writeByte(static_cast<KUI_8>(mScratch));
+                mScratch >>= 8;
+                mScratchBits = mScratchBits > 8 ? mScratchBits - 8 : 0;
+            }
+            mScratch = 0;
+        }
+
+        // Bits written so far, including any not yet flushed.
+        size_t getBitCount() const { return mByteOffset * 8 + mScratchBits; }
+
+        // Bytes of the buffer in use. Includes a partial last byte only after flush.
+        size_t getByteCount() const { return mByteOffset; }
+
+        bool hasOverflowed() const { return mOverflowed; }
+
+    private:
+        void writeWord(KUI_32 aWord) {
+            if (mCapacity - mByteOffset < sizeof(aWord)) {
+                mOverflowed = true;
+                return;
+            }
+            memcpy(mBuffer + mByteOffset, &aWord, sizeof(aWord));
+            mByteOffset += sizeof(aWord);
+        }
+
+        void writeByte(KUI_8 aByte) {
+            if (mByteOffset == mCapacity) {
+                mOverflowed = true;
+                return;
+            }
+            mBuffer[mByteOffset++] = aByte;
+        }
+
+        KUI_8* mBuffer;
+        size_t mCapacity;
+        size_t mByteOffset;
+        KUI_64 mScratch;
+        K_UINT mScratchBits;
+        bool mOverflowed;
+    };
+
+    class BitReader
+    {
+    public:
+        // Reads from aByteCount bytes at aData, which must stay valid while reading.
+        BitReader(const void* aData, size_t aByteCount)
+            : mData(static_cast<const KUI_8*>(aData)), mSize(aByteCount), mByteOffset(0),
+              mScratch(0), mScratchBits(0), mOverflowed(false) { }
+
+        // Reads aBitCount bits, between 0 and 32. Returns zero once the stream has overflowed.
+        KUI_32 readBits(K_UINT aBitCount) {
+            ASSERT(aBitCount <= 32);
+            if (mScratchBits < aBitCount) {
+                refill();
+                if (mScratchBits < aBitCount) {
+                    overflow();
+                    return 0;
+                }
+            }
+            const KUI_64 mask = (static_cast<KUI_64>(1) << aBitCount) - 1;
+            const KUI_32 value = static_cast<KUI_32>(mScratch & mask);
+            mScratch >>= aBitCount;
+            mScratchBits -= aBitCount;
+            return value;
+        }
+
+        bool readBool() {
+            return readBits(1) != 0;
+        }
+
+        float readFloat() {
+            const KUI_32 bits = readBits(32);
+            float value;
+            memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        // Reads a value written by BitWriter::writeQuantized with the same range and bit count.
+        float readQuantized(float aMinimum, float aMaximum, K_UINT aBitCount) {
+            const float steps = static_cast<float>((static_cast<KUI_64>(1) << aBitCount) - 1);
+            return aMinimum + (aMaximum - aMinimum) * (static_cast<float>(readBits(aBitCount)) / steps);
+        }
+
+        Vector3f readVector3f() {
+            const float x = readFloat();
+            const float y = readFloat();
+            return Vector3f(x, y, readFloat());
+        }
+
+        Quaternion readQuaternion() {
+            const float x = readFloat();
+            const float y = readFloat();
+            const float z = readFloat();
+            return Quaternion(x, y, z, readFloat());
+        }
+
+        Matrix4x4f readMatrix4x4f() {
+            Matrix4x4f matrix;
+            for (K_INT row = 0; row < 4; ++row)
+                for (K_INT col = 0; col < 4; ++col)
+                    matrix(row, col) = readFloat();
+            return matrix;
+        }
+
+        // Skips to the next byte boundary and returns a pointer to aByteCount bytes inside the
+        // source buffer, or nullptr if there are not enough left.
+        const KUI_8* readAlignedBytes(size_t aByteCount) {
+            // Whole bytes still in the register belong to the source, so step back over them.
+            mByteOffset -= mScratchBits / 8;
+            mScratch = 0;
+            mScratchBits = 0;
+            if (mOverflowed || aByteCount > mSize - mByteOffset) {
+                overflow();
+                return nullptr;
+            }
+            const KUI_8* bytes = mData + mByteOffset;
+            mByteOffset += aByteCount;
+            return bytes;
+        }
+
+        // Bits left to read, counting the padding in the final byte.
+        size_t getRemainingBits() const { return (mSize - mByteOffset) * 8 + mScratchBits; }
+
+        bool hasOverflowed() const { return mOverflowed; }
+
+    private:
+        // Marks the stream as overflowed and drops everything left, so later reads return zero.
+        void overflow() {
+            mOverflowed = true;
+            mByteOffset = mSize;
+            mScratch = 0;
+            mScratchBits = 0;
+        }
+
+        // Tops the register up with as many whole bytes as fit.
+        void refill() {
+            if (mSize - mByteOffset >= sizeof(KUI_32) && mScratchBits <= 32) {
+                KUI_32 word;
+                memcpy(&word, mData + mByteOffset, sizeof(word));
+                mScratch |= static_cast<KUI_64>(word) << mScratchBits;
+                mScratchBits += 32;
+                mByteOffset += sizeof(word);
+                return;
+            }
+            while (mByteOffset < mSize && mScratchBits <= 56) {
+                mScratch |= static_cast<KUI_64>(mData[mByteOffset++]) << mScratchBits;
+                mScratchBits += 8;
+            }
+        }
+
+        const KUI_8* mData;
+        size_t mSize;
+        size_t mByteOffset;
+        KUI_64 mScratch;
+        K_UINT mScratchBits;
+        bool mOverflowed;
+    };
+}
\ No newline at end of file
@@ -4,6 +4,20 @@
 
 #define ASSERTIONS_ENABLED 1
 
+// Counts every trip to the global heap so steady-state frames can be verified allocation free.
+// On in debug builds by default. Define it in the project settings to choose per build, as the
+// benchmark does to count allocations in its optimized build.
+#ifndef MEMORY_TRACKING_ENABLED
+#if defined(_DEBUG)
+#define MEMORY_TRACKING_ENABLED 1
+#else
+#define MEMORY_TRACKING_ENABLED 0
+#endif
+#endif
+
+// Records PROFILE_SCOPE zones into per-thread ring buffers. Set to 0 to compile every zone out.
+#define PROFILER_ENABLED 1
+
 typedef __int32 K_INT;
 typedef __int8	KI_8;
 typedef __int16 KI_16;
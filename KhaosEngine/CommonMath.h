@@ -30,8 +30,40 @@
 
 namespace KhaosMath
 {
+    constexpr float PI = 3.14159265358979323846f;
+    constexpr float TWO_PI = 6.28318530717958647692f;
+    constexpr float HALF_PI = 1.57079632679489661923f;
+
+    // Sine evaluated in double precision with a Taylor series, so it can run at compile time.
+    // Used to build constant tables; at runtime prefer sinf.
+    constexpr double CompileTimeSin(double aRadians) {
+        const double pi = 3.14159265358979323846;
+        const double twoPi = 6.28318530717958647692;
+
+        // Reduce to [-pi, pi] where the series converges quickly.
+        double x = aRadians - twoPi * static_cast<double>(static_cast<KI_64>(aRadians / twoPi));
+        if (x > pi)
+            x -= twoPi;
+        else if (x < -pi)
+            x += twoPi;
+
+        const double xSquared = x * x;
+        double term = x;
+        double sum = x;
+        for (K_INT n = 1; n < 12; ++n) {
+            term *= -xSquared / static_cast<double>((2 * n) * (2 * n + 1));
+            sum += term;
+        }
+        return sum;
+    }
+
+    // Cosine evaluated at compile time. See CompileTimeSin.
+    constexpr double CompileTimeCos(double aRadians) {
+        return CompileTimeSin(aRadians + 1.57079632679489661923);
+    }
+
     // Clamp a value between minValue and maxValue, inclusive.
-    static float ClampInclusive(float aValue, float minValue, float maxValue) {
+    constexpr float ClampInclusive(float aValue, float minValue, float maxValue) {
         if (aValue < minValue)
             return minValue;
         if (aValue > maxValue)
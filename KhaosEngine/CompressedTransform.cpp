@@ -0,0 +1,332 @@
+// CompressedTransform.cpp
+// SIMD batch encoders and decoders for the formats in CompressedTransform.h.
+
+#include "CompressedTransform.h"
+#include "CpuFeatures.h"
+
+#include <emmintrin.h>
+#include <immintrin.h>
+
+namespace
+{
+    using namespace KhaosMath;
+
+    static_assert(sizeof(Vector3f) == 3 * sizeof(float), "Vector3f must be tightly packed.");
+    static_assert(sizeof(HalfVector3) == 3 * sizeof(KUI_16), "HalfVector3 must be tightly packed.");
+    static_assert(sizeof(Vector4f) == 4 * sizeof(float), "Vector4f must be tightly packed.");
+    static_assert(sizeof(HalfVector4) == 4 * sizeof(KUI_16), "HalfVector4 must be tightly packed.");
+    static_assert(sizeof(PackedQuaternion48) == 6, "PackedQuaternion48 must be 48 bits.");
+
+    // Picks a where aMask is set and b elsewhere.
+    inline __m128i select(__m128i aMask, __m128i a, __m128i b) {
+        return _mm_or_si128(_mm_and_si128(aMask, a), _mm_andnot_si128(aMask, b));
+    }
+
+    inline __m128 select(__m128 aMask, __m128 a, __m128 b) {
+        return _mm_or_ps(_mm_and_ps(aMask, a), _mm_andnot_ps(aMask, b));
+    }
+
+    // SSE2 version of FloatToHalf. Each 32-bit lane of the result holds one half.
+    inline __m128i floatToHalfSse2(__m128 someValues) {
+        __m128i bits = _mm_castps_si128(someValues);
+        const __m128i sign = _mm_and_si128(bits, _mm_set1_epi32(static_cast<int>(0x80000000u)));
+        bits = _mm_xor_si128(bits, sign);
+
+        const __m128i isNan = _mm_cmpgt_epi32(bits, _mm_set1_epi32(0x7f800000));
+        const __m128i infinityOrNan = _mm_or_si128(_mm_set1_epi32(0x7c00), _mm_and_si128(isNan, _mm_set1_epi32(0x0200)));
+        const __m128i isTooLarge = _mm_cmpgt_epi32(bits, _mm_set1_epi32(0x477fffff));
+
+        const __m128i isDenormal = _mm_cmplt_epi32(bits, _mm_set1_epi32(0x38800000));
+        const __m128i magic = _mm_set1_epi32(0x3f000000);
+        const __m128i denormal = _mm_sub_epi32(
+            _mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(bits), _mm_castsi128_ps(magic))), magic);
+
+        const __m128i mantissaOdd = _mm_and_si128(_mm_srli_epi32(bits, 13), _mm_set1_epi32(1));
+        const __m128i normal = _mm_srli_epi32(
+            _mm_add_epi32(_mm_add_epi32(bits, _mm_set1_epi32(static_cast<int>(0xc8000fffu))), mantissaOdd), 13);
+
+        const __m128i half = select(isTooLarge, infinityOrNan, select(isDenormal, denormal, normal));
+        return _mm_or_si128(half, _mm_srli_epi32(sign, 16));
+    }
+
+    // SSE2 version of HalfToFloat. Each 32-bit lane of someHalfs holds one half.
+    inline __m128 halfToFloatSse2(__m128i someHalfs) {
+        const __m128i shiftedExponent = _mm_set1_epi32(0x7c00 << 13);
+        __m128i bits = _mm_slli_epi32(_mm_and_si128(someHalfs, _mm_set1_epi32(0x7fff)), 13);
+        const __m128i exponent = _mm_and_si128(bits, shiftedExponent);
+        bits = _mm_add_epi32(bits, _mm_set1_epi32((127 - 15) << 23));
+
+        const __m128i isInfinityOrNan = _mm_cmpeq_epi32(exponent, shiftedExponent);
+        bits = _mm_add_epi32(bits, _mm_and_si128(isInfinityOrNan, _mm_set1_epi32((128 - 16) << 23)));
+
+        const __m128i isDenormal = _mm_cmpeq_epi32(exponent, _mm_setzero_si128());
+        const __m128i denormal = _mm_castps_si128(_mm_sub_ps(
+            _mm_castsi128_ps(_mm_add_epi32(bits, _mm_set1_epi32(1 << 23))),
+            _mm_castsi128_ps(_mm_set1_epi32(113 << 23))));
+        bits = select(isDenormal, denormal, bits);
+
+        bits = _mm_or_si128(bits, _mm_slli_epi32(_mm_and_si128(someHalfs, _mm_set1_epi32(0x8000)), 16));
+        return _mm_castsi128_ps(bits);
+    }
+
+    // Narrows four 32-bit lanes holding 16-bit values and stores them as 8 bytes.
+    inline void storeHalfs(KUI_16* aDestination, __m128i someHalfs) {
+        const __m128i signExtended = _mm_srai_epi32(_mm_slli_epi32(someHalfs, 16), 16);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(aDestination), _mm_packs_epi32(signExtended, signExtended));
+    }
+
+    // Loads 8 bytes of halfs and widens them into four 32-bit lanes.
+    inline __m128i loadHalfs(const KUI_16* aSource) {
+        return _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(aSource)), _mm_setzero_si128());
+    }
+
+    // Quantizes four quaternions into smallest-three form. Each output lane holds one quaternion.
+    inline void quantizeSmallestThree(const Quaternion* someQuats, K_UINT aBits, __m128i& aLargest,
+                                      __m128i& a, __m128i& b, __m128i& c) {
+        __m128 x = _mm_loadu_ps(&someQuats[0].x);
+        __m128 y = _mm_loadu_ps(&someQuats[1].x);
+        __m128 z = _mm_loadu_ps(&someQuats[2].x);
+        __m128 w = _mm_loadu_ps(&someQuats[3].x);
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+
+        // Find the largest magnitude. Strict compares keep the lowest index on ties, like the scalar path.
+        const __m128 signBit = _mm_set1_ps(-0.0f);
+        __m128 maxMagnitude = _mm_andnot_ps(signBit, x);
+        __m128 largestValue = x;
+        __m128i largest = _mm_setzero_si128();
+        const __m128 components[3] = { y, z, w };
+        for (K_INT i = 0; i < 3; ++i) {
+            const __m128 magnitude = _mm_andnot_ps(signBit, components[i]);
+            const __m128 isLarger = _mm_cmpgt_ps(magnitude, maxMagnitude);
+            maxMagnitude = _mm_max_ps(magnitude, maxMagnitude);
+            largestValue = select(isLarger, components[i], largestValue);
+            largest = select(_mm_castps_si128(isLarger), _mm_set1_epi32(i + 1), largest);
+        }
+
+        // Drop the largest component and flip signs so it would have been positive.
+        const __m128 flip = _mm_and_ps(largestValue, signBit);
+        const __m128 isFirst = _mm_castsi128_ps(_mm_cmpeq_epi32(largest, _mm_setzero_si128()));
+        const __m128 isFirstOrSecond = _mm_castsi128_ps(_mm_cmplt_epi32(largest, _mm_set1_epi32(2)));
+        const __m128 isNotLast = _mm_castsi128_ps(_mm_cmplt_epi32(largest, _mm_set1_epi32(3)));
+        const __m128 smallest[3] = { _mm_xor_ps(select(isFirst, y, x), flip),
+                                     _mm_xor_ps(select(isFirstOrSecond, z, y), flip),
+                                     _mm_xor_ps(select(isNotLast, w, z), flip) };
+
+        const __m128 maxValue = _mm_set1_ps(static_cast<float>((1u << aBits) - 1u));
+        const __m128 range = _mm_set1_ps(SmallestThree::RANGE);
+        const __m128 scale = _mm_set1_ps(0.5f / SmallestThree::RANGE);
+        __m128i quantized[3];
+        for (K_INT i = 0; i < 3; ++i) {
+            __m128 normalized = _mm_mul_ps(_mm_add_ps(smallest[i], range), scale);
+            normalized = _mm_min_ps(_mm_max_ps(normalized, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+            quantized[i] = _mm_cvttps_epi32(_mm_madd_ps(normalized, maxValue, _mm_set1_ps(0.5f)));
+        }
+
+        aLargest = largest;
+        a = quantized[0];
+        b = quantized[1];
+        c = quantized[2];
+    }
+
+    // Rebuilds four quaternions from smallest-three form and stores them.
+    inline void rebuildSmallestThree(__m128i aLargest, __m128i a, __m128i b, __m128i c, K_UINT aBits,
+                                     Quaternion* someQuats) {
+        const __m128 scale = _mm_set1_ps(2.0f * SmallestThree::RANGE / static_cast<float>((1u << aBits) - 1u));
+        const __m128 range = _mm_set1_ps(SmallestThree::RANGE);
+        const __m128 fa = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(a), scale), range);
+        const __m128 fb = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(b), scale), range);
+        const __m128 fc = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(c), scale), range);
+
+        const __m128 sumSquares = _mm_add_ps(_mm_add_ps(_mm_mul_ps(fa, fa), _mm_mul_ps(fb, fb)), _mm_mul_ps(fc, fc));
+        const __m128 largestValue = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(1.0f), sumSquares), _mm_setzero_ps()));
+
+        const __m128 isFirst = _mm_castsi128_ps(_mm_cmpeq_epi32(aLargest, _mm_setzero_si128()));
+        const __m128 isSecond = _mm_castsi128_ps(_mm_cmpeq_epi32(aLargest, _mm_set1_epi32(1)));
+        const __m128 isThird = _mm_castsi128_ps(_mm_cmpeq_epi32(aLargest, _mm_set1_epi32(2)));
+        const __m128 isLast = _mm_castsi128_ps(_mm_cmpeq_epi32(aLargest, _mm_set1_epi32(3)));
+        const __m128 isFirstOrSecond = _mm_or_ps(isFirst, isSecond);
+
+        __m128 x = select(isFirst, largestValue, fa);
+        __m128 y = select(isFirst, fa, select(isSecond, largestValue, fb));
+        __m128 z = select(isFirstOrSecond, fb, select(isThird, largestValue, fc));
+        __m128 w = select(isLast, largestValue, fc);
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+
+        _mm_storeu_ps(&someQuats[0].x, x);
+        _mm_storeu_ps(&someQuats[1].x, y);
+        _mm_storeu_ps(&someQuats[2].x, z);
+        _mm_storeu_ps(&someQuats[3].x, w);
+    }
+}
+
+namespace KhaosMath
+{
+    //
+    // Half precision.
+    //
+
+    void EncodeHalfs(const float* someValues, KUI_16* someHalfs, size_t aCount) {
+        size_t i = 0;
+        if (CpuFeatures::Get().f16c) {
+            for (; i + 4 <= aCount; i += 4) {
+                const __m128i halfs = _mm_cvtps_ph(_mm_loadu_ps(someValues + i), _MM_FROUND_TO_NEAREST_INT);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(someHalfs + i), halfs);
+            }
+        } else {
+            for (; i + 4 <= aCount; i += 4)
+                storeHalfs(someHalfs + i, floatToHalfSse2(_mm_loadu_ps(someValues + i)));
+        }
+
+        for (; i < aCount; ++i)
+            someHalfs[i] = FloatToHalf(someValues[i]);
+    }
+
+    void DecodeHalfs(const KUI_16* someHalfs, float* someValues, size_t aCount) {
+        size_t i = 0;
+        if (CpuFeatures::Get().f16c) {
+            for (; i + 4 <= aCount; i += 4) {
+                const __m128i halfs = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(someHalfs + i));
+                _mm_storeu_ps(someValues + i, _mm_cvtph_ps(halfs));
+            }
+        } else {
+            for (; i + 4 <= aCount; i += 4)
+                _mm_storeu_ps(someValues + i, halfToFloatSse2(loadHalfs(someHalfs + i)));
+        }
+
+        for (; i < aCount; ++i)
+            someValues[i] = HalfToFloat(someHalfs[i]);
+    }
+
+    // Both vector layouts are plain runs of components, so they convert as flat arrays.
+
+    void EncodeHalfVectors(const Vector3f* someVectors, HalfVector3* someHalfs, size_t aCount) {
+        EncodeHalfs(&someVectors[0].x, &someHalfs[0].x, aCount * 3);
+    }
+
+    void DecodeHalfVectors(const HalfVector3* someHalfs, Vector3f* someVectors, size_t aCount) {
+        DecodeHalfs(&someHalfs[0].x, &someVectors[0].x, aCount * 3);
+    }
+
+    void EncodeHalfVectors(const Vector4f* someVectors, HalfVector4* someHalfs, size_t aCount) {
+        EncodeHalfs(&someVectors[0].x, &someHalfs[0].x, aCount * 4);
+    }
+
+    void DecodeHalfVectors(const HalfVector4* someHalfs, Vector4f* someVectors, size_t aCount) {
+        DecodeHalfs(&someHalfs[0].x, &someVectors[0].x, aCount * 4);
+    }
+
+    //
+    // Smallest-three quaternions.
+    //
+
+    void EncodeQuaternions(const Quaternion* someQuats, PackedQuaternion32* somePacked, size_t aCount) {
+        const K_UINT bits = PackedQuaternion32::COMPONENT_BITS;
+        size_t i = 0;
+        for (; i + 4 <= aCount; i += 4) {
+            __m128i largest, a, b, c;
+            quantizeSmallestThree(someQuats + i, bits, largest, a, b, c);
+            __m128i packed = _mm_or_si128(_mm_slli_epi32(largest, 30), _mm_slli_epi32(a, 2 * bits));
+            packed = _mm_or_si128(packed, _mm_or_si128(_mm_slli_epi32(b, bits), c));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&somePacked[i].bits), packed);
+        }
+
+        for (; i < aCount; ++i)
+            somePacked[i] = PackedQuaternion32(someQuats[i]);
+    }
+
+    void DecodeQuaternions(const PackedQuaternion32* somePacked, Quaternion* someQuats, size_t aCount) {
+        const K_UINT bits = PackedQuaternion32::COMPONENT_BITS;
+        const __m128i mask = _mm_set1_epi32((1 << bits) - 1);
+        size_t i = 0;
+        for (; i + 4 <= aCount; i += 4) {
+            const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&somePacked[i].bits));
+            rebuildSmallestThree(_mm_srli_epi32(packed, 30),
+                                 _mm_and_si128(_mm_srli_epi32(packed, 2 * bits), mask),
+                                 _mm_and_si128(_mm_srli_epi32(packed, bits), mask),
+                                 _mm_and_si128(packed, mask), bits, someQuats + i);
+        }
+
+        for (; i < aCount; ++i)
+            someQuats[i] = somePacked[i].toQuaternion();
+    }
+
+    void EncodeQuaternions(const Quaternion* someQuats, PackedQuaternion48* somePacked, size_t aCount) {
+        const K_UINT bits = PackedQuaternion48::COMPONENT_BITS;
+        __declspec(align(16)) KI_32 lanes[4][4];
+        size_t i = 0;
+        for (; i + 4 <= aCount; i += 4) {
+            __m128i largest, a, b, c;
+            quantizeSmallestThree(someQuats + i, bits, largest, a, b, c);
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes[0]), largest);
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes[1]), a);
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes[2]), b);
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes[3]), c);
+
+            // 47-bit fields do not fit SSE2's 32-bit lanes, so only the packing is scalar.
+            for (K_INT lane = 0; lane < 4; ++lane) {
+                somePacked[i + lane].setBits((static_cast<KUI_64>(lanes[0][lane]) << 45) |
+                                             (static_cast<KUI_64>(lanes[1][lane]) << (2 * bits)) |
+                                             (static_cast<KUI_64>(lanes[2][lane]) << bits) |
+                                             static_cast<KUI_64>(lanes[3][lane]));
+            }
+        }
+
+        for (; i < aCount; ++i)
+            somePacked[i] = PackedQuaternion48(someQuats[i]);
+    }
+
+    void DecodeQuaternions(const PackedQuaternion48* somePacked, Quaternion* someQuats, size_t aCount) {
+        const K_UINT bits = PackedQuaternion48::COMPONENT_BITS;
+        const KUI_64 mask = (1u << bits) - 1u;
+        __declspec(align(16)) KI_32 lanes[4][4];
+        size_t i = 0;
+        for (; i + 4 <= aCount; i += 4) {
+            for (K_INT lane = 0; lane < 4; ++lane) {
+                const KUI_64 packed = somePacked[i + lane].getBits();
+                lanes[0][lane] = static_cast<KI_32>(packed >> 45);
+                lanes[1][lane] = static_cast<KI_32>((packed >> (2 * bits)) & mask);
+                lanes[2][lane] = static_cast<KI_32>((packed >> bits) & mask);
+                lanes[3][lane] = static_cast<KI_32>(packed & mask);
+            }
+            rebuildSmallestThree(_mm_load_si128(reinterpret_cast<const __m128i*>(lanes[0])),
+                                 _mm_load_si128(reinterpret_cast<const __m128i*>(lanes[1])),
+                                 _mm_load_si128(reinterpret_cast<const __m128i*>(lanes[2])),
+                                 _mm_load_si128(reinterpret_cast<const __m128i*>(lanes[3])),
+                                 bits, someQuats + i);
+        }
+
+        for (; i < aCount; ++i)
+            someQuats[i] = somePacked[i].toQuaternion();
+    }
+
+    //
+    // Affine matrices.
+    //
+
+    void EncodeAffine(const Matrix4x4f* someMatrices, AffineMatrix3x4f* someAffine, size_t aCount) {
+        for (size_t i = 0; i < aCount; ++i) {
+            __m128 row0 = _mm_loadu_ps(someMatrices[i].elem[0]);
+            __m128 row1 = _mm_loadu_ps(someMatrices[i].elem[1]);
+            __m128 row2 = _mm_loadu_ps(someMatrices[i].elem[2]);
+            __m128 row3 = _mm_loadu_ps(someMatrices[i].elem[3]);
+            _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+            _mm_storeu_ps(someAffine[i].elem[0], row0);
+            _mm_storeu_ps(someAffine[i].elem[1], row1);
+            _mm_storeu_ps(someAffine[i].elem[2], row2);
+        }
+    }
+
+    void DecodeAffine(const AffineMatrix3x4f* someAffine, Matrix4x4f* someMatrices, size_t aCount) {
+        for (size_t i = 0; i < aCount; ++i) {
+            __m128 col0 = _mm_loadu_ps(someAffine[i].elem[0]);
+            __m128 col1 = _mm_loadu_ps(someAffine[i].elem[1]);
+            __m128 col2 = _mm_loadu_ps(someAffine[i].elem[2]);
+            __m128 col3 = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+            _MM_TRANSPOSE4_PS(col0, col1, col2, col3);
+            _mm_storeu_ps(someMatrices[i].elem[0], col0);
+            _mm_storeu_ps(someMatrices[i].elem[1], col1);
+            _mm_storeu_ps(someMatrices[i].elem[2], col2);
+            _mm_storeu_ps(someMatrices[i].elem[3], col3);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,310 @@
+#pragma once
+
+// CompressedTransform.h
+// Compact storage formats for animation clips and network snapshots:
+// IEEE half-precision vectors, smallest-three packed quaternions and 3x4 affine matrices.
+// Batch encoders and decoders for large arrays are declared at the bottom of this file.
+
+#include "Common.h"
+#include "CommonMath.h"
+
+#include "Vector3f.h"
+#include "Vector4f.h"
+#include "Quaternion.h"
+#include "Matrix4x4f.h"
+
+#include <cstring>
+
+namespace KhaosMath
+{
+    // Converts a float to IEEE 754 half precision, rounding to nearest even.
+    // Values beyond the half range become infinity; NaN stays NaN.
+    inline KUI_16 FloatToHalf(float aValue) {
+        KUI_32 bits;
+        memcpy(&bits, &aValue, sizeof(bits));
+        const KUI_32 sign = bits & 0x80000000u;
+        bits ^= sign;
+
+        KUI_32 half;
+        if (bits >= 0x47800000u) {
+            // Too large for a half, or already infinity / NaN.
+            half = bits > 0x7f800000u ? 0x7e00u : 0x7c00u;
+        } else if (bits < 0x38800000u) {
+            // Half denormal or zero. Adding 0.5f lets the FPU do the rounding shift for us.
+            float magic;
+            memcpy(&magic, &bits, sizeof(magic));
+            magic += 0.5f;
+            memcpy(&half, &magic, sizeof(half));
+            half -= 0x3f000000u;
+        } else {
+            // Normal half. Rebias the exponent and round the dropped mantissa bits to even.
+            const KUI_32 mantissaOdd = (bits >> 13) & 1u;
+            bits += 0xc8000fffu + mantissaOdd;
+            half = bits >> 13;
+        }
+        return static_cast<KUI_16>(half | (sign >> 16));
+    }
+
+    // Converts an IEEE 754 half to float. Exact for every input.
+    inline float HalfToFloat(KUI_16 aHalf) {
+        const KUI_32 shiftedExponent = 0x7c00u << 13;
+        KUI_32 bits = (aHalf & 0x7fffu) << 13;
+        const KUI_32 exponent = bits & shiftedExponent;
+        bits += (127u - 15u) << 23;
+
+        if (exponent == shiftedExponent) {
+            // Infinity or NaN.
+            bits += (128u - 16u) << 23;
+        } else if (exponent == 0) {
+            // Denormal. Renormalize by subtracting the implicit leading one.
+            bits += 1u << 23;
+            float value;
+            memcpy(&value, &bits, sizeof(value));
+            value -= 6.10351562e-05f;
+            memcpy(&bits, &value, sizeof(bits));
+        }
+
+        bits |= static_cast<KUI_32>(aHalf & 0x8000u) << 16;
+        float result;
+        memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    // Vector3f stored as three IEEE halves (6 bytes instead of 12).
+    // Relative error is at most 2^-11 for magnitudes between 6.1e-5 and 65504.
+    class HalfVector3
+    {
+    public:
+        KUI_16 x, y, z;
+
+        // Default constructor will zero all elements.
+        constexpr HalfVector3()
+            : x(0), y(0), z(0) { }
+
+        // Constructor that converts a full precision vector.
+        explicit HalfVector3(const Vector3f& aVector)
+            : x(FloatToHalf(aVector.x)), y(FloatToHalf(aVector.y)), z(FloatToHalf(aVector.z)) { }
+
+        // Returns the full precision vector.
+        Vector3f toVector3f() const {
+            return Vector3f(HalfToFloat(x), HalfToFloat(y), HalfToFloat(z));
+        }
+    };
+
+    // Vector4f stored as four IEEE halves (8 bytes instead of 16).
+    class HalfVector4
+    {
+    public:
+        KUI_16 x, y, z, w;
+
+        // Default constructor will zero all elements.
+        constexpr HalfVector4()
+            : x(0), y(0), z(0), w(0) { }
+
+        // Constructor that converts a full precision vector.
+        explicit HalfVector4(const Vector4f& aVector)
+            : x(FloatToHalf(aVector.x)), y(FloatToHalf(aVector.y)),
+              z(FloatToHalf(aVector.z)), w(FloatToHalf(aVector.w)) { }
+
+        // Returns the full precision vector.
+        Vector4f toVector4f() const {
+            return Vector4f(HalfToFloat(x), HalfToFloat(y), HalfToFloat(z), HalfToFloat(w));
+        }
+    };
+
+    // Shared helpers for the smallest-three quaternion encodings.
+    // A unit quaternion's largest component is dropped and rebuilt from the other three,
+    // which always lie within [-1/sqrt(2), 1/sqrt(2)]. q and -q are the same rotation,
+    // so the sign is flipped to make the dropped component positive.
+    struct SmallestThree
+    {
+        static constexpr float RANGE = 0.707106781f;
+
+        // Returns the index of the component with the largest magnitude.
+        static K_UINT LargestComponent(const Quaternion& aQuat) {
+            const float magnitudes[4] = { fabsf(aQuat.x), fabsf(aQuat.y), fabsf(aQuat.z), fabsf(aQuat.w) };
+            K_UINT largest = 0;
+            for (K_UINT i = 1; i < 4; ++i) {
+                if (magnitudes[i] > magnitudes[largest])
+                    largest = i;
+            }
+            return largest;
+        }
+
+        // Maps a component in [-RANGE, RANGE] to an unsigned integer of aBits bits.
+        static KUI_32 Quantize(float aValue, K_UINT aBits) {
+            const float maxValue = static_cast<float>((1u << aBits) - 1u);
+            const float normalized = ClampInclusive((aValue + RANGE) * (0.5f / RANGE), 0.0f, 1.0f);
+            return static_cast<KUI_32>(normalized * maxValue + 0.5f);
+        }
+
+        // Inverse of Quantize.
+        static float Dequantize(KUI_32 aValue, K_UINT aBits) {
+            const float maxValue = static_cast<float>((1u << aBits) - 1u);
+            return static_cast<float>(aValue) * (2.0f * RANGE / maxValue) - RANGE;
+        }
+
+        // Rebuilds a unit quaternion from the largest component's index and the other three.
+        static Quaternion Rebuild(K_UINT aLargest, float a, float b, float c) {
+            const float squared = 1.0f - a * a - b * b - c * c;
+            const float largest = squared > 0.0f ? sqrtf(squared) : 0.0f;
+            switch (aLargest) {
+            case 0: return Quaternion(largest, a, b, c);
+            case 1: return Quaternion(a, largest, b, c);
+            case 2: return Quaternion(a, b, largest, c);
+            default: return Quaternion(a, b, c, largest);
+            }
+        }
+
+        // Writes the three smallest components, sign corrected, into someSmallest.
+        static void Extract(const Quaternion& aQuat, K_UINT aLargest, float someSmallest[3]) {
+            const float components[4] = { aQuat.x, aQuat.y, aQuat.z, aQuat.w };
+            const float sign = components[aLargest] < 0.0f ? -1.0f : 1.0f;
+            K_UINT out = 0;
+            for (K_UINT i = 0; i < 4; ++i) {
+                if (i != aLargest)
+                    someSmallest[out++] = components[i] * sign;
+            }
+        }
+    };
+
+    // Unit quaternion packed into 32 bits: 2 bits of index and three 10-bit components.
+    // Each component is within 0.0007 of the original.
+    class PackedQuaternion32
+    {
+    public:
+        static const K_UINT COMPONENT_BITS = 10;
+
+        KUI_32 bits;
+
+        // Default constructor encodes the identity rotation.
+        constexpr PackedQuaternion32()
+            : bits((3u << 30) | (512u << 20) | (512u << 10) | 512u) { }
+
+        // Constructor that packs a unit quaternion.
+        explicit PackedQuaternion32(const Quaternion& aQuat) {
+            const K_UINT largest = SmallestThree::LargestComponent(aQuat);
+            float smallest[3];
+            SmallestThree::Extract(aQuat, largest, smallest);
+            bits = (largest << 30) |
+                   (SmallestThree::Quantize(smallest[0], COMPONENT_BITS) << 20) |
+                   (SmallestThree::Quantize(smallest[1], COMPONENT_BITS) << 10) |
+                   SmallestThree::Quantize(smallest[2], COMPONENT_BITS);
+        }
+
+        // Returns the unpacked unit quaternion.
+        Quaternion toQuaternion() const {
+            const KUI_32 mask = (1u << COMPONENT_BITS) - 1u;
+            return SmallestThree::Rebuild(bits >> 30,
+                                          SmallestThree::Dequantize((bits >> 20) & mask, COMPONENT_BITS),
+                                          SmallestThree::Dequantize((bits >> 10) & mask, COMPONENT_BITS),
+                                          SmallestThree::Dequantize(bits & mask, COMPONENT_BITS));
+        }
+    };
+
+    // Unit quaternion packed into 48 bits: 2 bits of index and three 15-bit components.
+    // Each component is within 0.000022 of the original.
+    class PackedQuaternion48
+    {
+    public:
+        static const K_UINT COMPONENT_BITS = 15;
+
+        KUI_16 bits[3];
+
+        // Default constructor encodes the identity rotation.
+        PackedQuaternion48() {
+            setBits((3ull << 45) | (16384ull << 30) | (16384ull << 15) | 16384ull);
+        }
+
+        // Constructor that packs a unit quaternion.
+        explicit PackedQuaternion48(const Quaternion& aQuat) {
+            const K_UINT largest = SmallestThree::LargestComponent(aQuat);
+            float smallest[3];
+            SmallestThree::Extract(aQuat, largest, smallest);
+            setBits((static_cast<KUI_64>(largest) << 45) |
+                    (static_cast<KUI_64>(SmallestThree::Quantize(smallest[0], COMPONENT_BITS)) << 30) |
+                    (static_cast<KUI_64>(SmallestThree::Quantize(smallest[1], COMPONENT_BITS)) << 15) |
+                    static_cast<KUI_64>(SmallestThree::Quantize(smallest[2], COMPONENT_BITS)));
+        }
+
+        // Returns the unpacked unit quaternion.
+        Quaternion toQuaternion() const {
+            const KUI_64 packed = getBits();
+            const KUI_32 mask = (1u << COMPONENT_BITS) - 1u;
+            return SmallestThree::Rebuild(static_cast<K_UINT>(packed >> 45),
+                SmallestThree::Dequantize(static_cast<KUI_32>(packed >> 30) & mask, COMPONENT_BITS),
+                SmallestThree::Dequantize(static_cast<KUI_32>(packed >> 15) & mask, COMPONENT_BITS),
+                SmallestThree::Dequantize(static_cast<KUI_32>(packed) & mask, COMPONENT_BITS));
+        }
+
+        // Returns the 47 payload bits in the low bits of a 64-bit integer.
+        KUI_64 getBits() const {
+            return (static_cast<KUI_64>(bits[0]) << 32) | (static_cast<KUI_64>(bits[1]) << 16) | bits[2];
+        }
+
+        // Stores the low 48 bits of aPacked.
+        void setBits(KUI_64 aPacked) {
+            bits[0] = static_cast<KUI_16>(aPacked >> 32);
+            bits[1] = static_cast<KUI_16>(aPacked >> 16);
+            bits[2] = static_cast<KUI_16>(aPacked);
+        }
+    };
+
+    // Affine transform stored as 12 floats (48 bytes instead of 64).
+    // Matrix4x4f keeps row vectors, so the dropped column is always (0, 0, 0, 1).
+    // Each row of elem holds one of the three remaining columns so it loads as one SSE register.
+    __declspec(align(16)) class AffineMatrix3x4f
+    {
+    public:
+        float elem[3][4];
+
+        // Default constructor will produce the identity transform.
+        constexpr AffineMatrix3x4f()
+            : elem{ { 1.0f, 0.0f, 0.0f, 0.0f },
+                    { 0.0f, 1.0f, 0.0f, 0.0f },
+                    { 0.0f, 0.0f, 1.0f, 0.0f } } { }
+
+        // Constructor that drops the constant last column of an affine Matrix4x4f.
+        explicit constexpr AffineMatrix3x4f(const Matrix4x4f& aMatrix)
+            : elem{ { aMatrix(0, 0), aMatrix(1, 0), aMatrix(2, 0), aMatrix(3, 0) },
+                    { aMatrix(0, 1), aMatrix(1, 1), aMatrix(2, 1), aMatrix(3, 1) },
+                    { aMatrix(0, 2), aMatrix(1, 2), aMatrix(2, 2), aMatrix(3, 2) } } { }
+
+        // Returns the full 4x4 matrix.
+        constexpr Matrix4x4f toMatrix4x4f() const {
+            return Matrix4x4f(elem[0][0], elem[1][0], elem[2][0], 0.0f,
+                              elem[0][1], elem[1][1], elem[2][1], 0.0f,
+                              elem[0][2], elem[1][2], elem[2][2], 0.0f,
+                              elem[0][3], elem[1][3], elem[2][3], 1.0f);
+        }
+
+        // Transforms a point, including translation.
+        constexpr Vector3f transformPoint(const Vector3f& aPoint) const {
+            return Vector3f(aPoint.x * elem[0][0] + aPoint.y * elem[0][1] + aPoint.z * elem[0][2] + elem[0][3],
+                            aPoint.x * elem[1][0] + aPoint.y * elem[1][1] + aPoint.z * elem[1][2] + elem[1][3],
+                            aPoint.x * elem[2][0] + aPoint.y * elem[2][1] + aPoint.z * elem[2][2] + elem[2][3]);
+        }
+    };
+
+    //
+    // Batch encoders and decoders. These use F16C for half conversion when the CPU has it
+    // and SSE2 everywhere else. Arrays may be unaligned: std::vector only guarantees 8 bytes
+    // on Win32. Inputs and outputs must not overlap.
+    //
+
+    void EncodeHalfs(const float* someValues, KUI_16* someHalfs, size_t aCount);
+    void DecodeHalfs(const KUI_16* someHalfs, float* someValues, size_t aCount);
+
+    void EncodeHalfVectors(const Vector3f* someVectors, HalfVector3* someHalfs, size_t aCount);
+    void DecodeHalfVectors(const HalfVector3* someHalfs, Vector3f* someVectors, size_t aCount);
+    void EncodeHalfVectors(const Vector4f* someVectors, HalfVector4* someHalfs, size_t aCount);
+    void DecodeHalfVectors(const HalfVector4* someHalfs, Vector4f* someVectors, size_t aCount);
+
+    void EncodeQuaternions(const Quaternion* someQuats, PackedQuaternion32* somePacked, size_t aCount);
+    void DecodeQuaternions(const PackedQuaternion32* somePacked, Quaternion* someQuats, size_t aCount);
+    void EncodeQuaternions(const Quaternion* someQuats, PackedQuaternion48* somePacked, size_t aCount);
+    void DecodeQuaternions(const PackedQuaternion48* somePacked, Quaternion* someQuats, size_t aCount);
+
+    void EncodeAffine(const Matrix4x4f* someMatrices, AffineMatrix3x4f* someAffine, size_t aCount);
+    void DecodeAffine(const AffineMatrix3x4f* someAffine, Matrix4x4f* someMatrices, size_t aCount);
+}
\ No newline at end of file
@@ -0,0 +1,734 @@
+// ConvexCollision.cpp
+// GJK distance, EPA penetration and SSE hull support points.
+
+#include "ConvexCollision.h"
+#include "Memory.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <emmintrin.h>
+
+namespace
+{
+    using namespace KhaosEngine;
+
+    const K_UINT MAX_GJK_ITERATIONS = 64;
+    const K_UINT MAX_EPA_ITERATIONS = 64;
+    const K_UINT MAX_EPA_VERTICES = 64;
+    const K_UINT MAX_EPA_FACES = 128;
+    const K_UINT MAX_HORIZON_EDGES = 64;
+
+    // GJK stops once a new support point gets less than this fraction of the squared
+    // distance closer to the origin.
+    const float GJK_RELATIVE_TOLERANCE = 1.0e-6f;
+
+    // Squared distances below this fraction of the simplex size count as touching.
+    const float GJK_TOUCHING_TOLERANCE = 1.0e-12f;
+
+    // EPA stops once the polytope is within this distance of the Minkowski difference.
+    const float EPA_TOLERANCE = 1.0e-4f;
+
+    // A shape placed in the world. Directions go to local space through the rotation rows
+    // and support points come back through them.
+    struct PosedShape
+    {
+        const ConvexShape* shape;
+        Vector3f axes[3];
+        Vector3f position;
+        float radius;
+
+        Vector3f toLocalDirection(const Vector3f& aDirection) const {
+            return Vector3f(axes[0].dot(aDirection), axes[1].dot(aDirection), axes[2].dot(aDirection));
+        }
+
+        Vector3f toWorld(const Vector3f& aPoint) const {
+            return axes[0] * aPoint.x + axes[1] * aPoint.y + axes[2] * aPoint.z + position;
+        }
+
+        // Support point of the shape without its radius, in local space.
+        Vector3f getSupport(const Vector3f& aLocalDirection) const {
+            switch (shape->type) {
+            case ConvexShapeType::Box:
+                return Vector3f(aLocalDirection.x >= 0.0f ? shape->halfExtents.x : -shape->halfExtents.x,
+                                aLocalDirection.y >= 0.0f ? shape->halfExtents.y : -shape->halfExtents.y,
+                                aLocalDirection.z >= 0.0f ? shape->halfExtents.z : -shape->halfExtents.z);
+            case ConvexShapeType::Capsule:
+                return Vector3f(0.0f, aLocalDirection.y >= 0.0f ? shape->halfHeight : -shape->halfHeight, 0.0f);
+            case ConvexShapeType::Hull:
+                return shape->hull->getVertex(shape->hull->getSupportIndex(aLocalDirection));
+            default:
+                return Vector3f();
+            }
+        }
+    };
+
+    PosedShape poseShape(const ConvexShape& aShape, const Matrix4x4f& aTransform) {
+        PosedShape posed;
+        posed.shape = &aShape;
+        for (K_INT row = 0; row < 3; ++row)
+            posed.axes[row] = Vector3f(aTransform(row, 0), aTransform(row, 1), aTransform(row, 2));
+        posed.position = Vector3f(aTransform(3, 0), aTransform(3, 1), aTransform(3, 2));
+        posed.radius = aShape.type == ConvexShapeType::Sphere || aShape.type == ConvexShapeType::Capsule ? aShape.radius : 0.0f;
+        return posed;
+    }
+
+    // Vertex of the Minkowski difference A - B, with the points on each shape that made it.
+    struct SimplexPoint
+    {
+        Vector3f w;
+        Vector3f a;
+        Vector3f b;
+        Vector3f localA;
+        Vector3f localB;
+    };
+
+    SimplexPoint makePoint(const PosedShape& aShape, const PosedShape& bShape,
+                           const Vector3f& aLocalA, const Vector3f& aLocalB) {
+        SimplexPoint point;
+        point.localA = aLocalA;
+        point.localB = aLocalB;
+        point.a = aShape.toWorld(aLocalA);
+        point.b = bShape.toWorld(aLocalB);
+        point.w = point.a - point.b;
+        return point;
+    }
+
+    // Returns the point of the core difference A - B farthest along aDirection.
+    SimplexPoint getSupport(const PosedShape& aShape, const PosedShape& bShape, const Vector3f& aDirection) {
+        return makePoint(aShape, bShape, aShape.getSupport(aShape.toLocalDirection(aDirection)),
+                         bShape.getSupport(bShape.toLocalDirection(aDirection * -1.0f)));
+    }
+
+    struct Simplex
+    {
+        SimplexPoint points[4];
+        float weights[4];
+        K_UINT count;
+    };
+
+    // Subset of simplex vertices and barycentric weights giving the point closest to the origin.
+    struct SimplexSolution
+    {
+        K_UINT indices[4];
+        float weights[4];
+        K_UINT count;
+    };
+
+    SimplexSolution makeSolution(K_UINT i0) {
+        SimplexSolution solution;
+        solution.indices[0] = i0;
+        solution.weights[0] = 1.0f;
+        solution.count = 1;
+        return solution;
+    }
+
+    SimplexSolution makeSolution(K_UINT i0, K_UINT i1, float t) {
+        SimplexSolution solution;
+        solution.indices[0] = i0;
+        solution.indices[1] = i1;
+        solution.weights[0] = 1.0f - t;
+        solution.weights[1] = t;
+        solution.count = 2;
+        return solution;
+    }
+
+    Vector3f getSolutionPoint(const SimplexSolution& aSolution, const Vector3f* someVertices) {
+        Vector3f point;
+        for (K_UINT i = 0; i < aSolution.count; ++i)
+            point.addScaled(someVertices[aSolution.indices[i]], aSolution.weights[i]);
+        return point;
+    }
+
+    SimplexSolution closestOnSegment(const Vector3f* someVertices, K_UINT i0, K_UINT i1) {
+        const Vector3f& a = someVertices[i0];
+        const Vector3f edge = someVertices[i1] - a;
+        const float lengthSquared = edge.getMagnitudeSquared();
+        const float t = lengthSquared > 0.0f ? -a.dot(edge) / lengthSquared : 0.0f;
+        if (t <= 0.0f)
+            return makeSolution(i0);
+        if (t >= 1.0f)
+            return makeSolution(i1);
+        return makeSolution(i0, i1, t);
+    }
+
+    // Closest point on a triangle by Voronoi region, after Ericson's Real-Time Collision Detection.
+    SimplexSolution closestOnTriangle(const Vector3f* someVertices, K_UINT i0, K_UINT i1, K_UINT i2) {
+        const Vector3f& a = someVertices[i0];
+        const Vector3f& b = someVertices[i1];
+        const Vector3f& c = someVertices[i2];
+        const Vector3f ab = b - a;
+        const Vector3f ac = c - a;
+
+        const float d1 = -ab.dot(a);
+        const float d2 = -ac.dot(a);
+        if (d1 <= 0.0f && d2 <= 0.0f)
+            return makeSolution(i0);
+
+        const float d3 = -ab.dot(b);
+        const float d4 = -ac.dot(b);
+        if (d3 >= 0.0f && d4 <= d3)
+            return makeSolution(i1);
+
+        const float vc = d1 * d4 - d3 * d2;
+        if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+            return makeSolution(i0, i1, d1 / (d1 - d3));
+
+        const float d5 = -ab.dot(c);
+        const float d6 = -ac.dot(c);
+        if (d6 >= 0.0f && d5 <= d6)
+            return makeSolution(i2);
+
+        const float vb = d5 * d2 - d1 * d6;
+        if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+            return makeSolution(i0, i2, d2 / (d2 - d6));
+
+        const float va = d3 * d6 - d5 * d4;
+        if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f)
+            return makeSolution(i1, i2, (d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+        const float sum = va + vb + vc;
+        if (!(sum > 0.0f)) {
+            // Collinear vertices: take the best edge.
+            const SimplexSolution edges[3] = { closestOnSegment(someVertices, i0, i1),
+                                               closestOnSegment(someVertices, i1, i2),
+                                               closestOnSegment(someVertices, i2, i0) };
+            K_UINT best = 0;
+            float bestDistance = FLT_MAX;
+            for (K_UINT i = 0; i < 3; ++i) {
+                const float distance = getSolutionPoint(edges[i], someVertices).getMagnitudeSquared();
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = i;
+                }
+            }
+            return edges[best];
+        }
+
+        SimplexSolution solution;
+        solution.indices[0] = i0;
+        solution.indices[1] = i1;
+        solution.indices[2] = i2;
+        solution.weights[1] = vb / sum;
+        solution.weights[2] = vc / sum;
+        solution.weights[0] = 1.0f - solution.weights[1] - solution.weights[2];
+        solution.count = 3;
+        return solution;
+    }
+
+    // Closest point on a tetrahedron. Returns all four vertices if the origin is inside.
+    SimplexSolution closestOnTetrahedron(const Vector3f* someVertices) {
+        // Each face, followed by the vertex opposite it.
+        static const K_UINT faces[4][4] = { { 0, 1, 2, 3 }, { 0, 3, 1, 2 }, { 0, 2, 3, 1 }, { 1, 3, 2, 0 } };
+        SimplexSolution best;
+        best.count = 0;
+        float bestDistance = FLT_MAX;
+        for (K_UINT face = 0; face < 4; ++face) {
+            const Vector3f& a = someVertices[faces[face][0]];
+            const Vector3f normal = (someVertices[faces[face][1]] - a).crossProduct(someVertices[faces[face][2]] - a);
+            const Vector3f toOpposite = someVertices[faces[face][3]] - a;
+            const float originSide = -a.dot(normal);
+            const float oppositeSide = toOpposite.dot(normal);
+
+            // Flat tetrahedra have no inside, so every face is a candidate.
+            const bool degenerate = oppositeSide * oppositeSide <=
+                                    GJK_TOUCHING_TOLERANCE * normal.getMagnitudeSquared() * toOpposite.getMagnitudeSquared();
+            if (!degenerate && originSide * oppositeSide >= 0.0f)
+                continue;
+
+            const SimplexSolution solution = closestOnTriangle(someVertices, faces[face][0], faces[face][1], faces[face][2]);
+            const float distance = getSolutionPoint(solution, someVertices).getMagnitudeSquared();
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                best = solution;
+            }
+        }
+        if (best.count == 0) {
+            for (K_UINT i = 0; i < 4; ++i) {
+                best.indices[i] = i;
+                best.weights[i] = 0.25f;
+            }
+            best.count = 4;
+        }
+        return best;
+    }
+
+    // Reduces aSimplex to the vertices supporting its point closest to the origin and returns
+    // that point. A simplex left with four vertices contains the origin.
+    Vector3f solveSimplex(Simplex& aSimplex) {
+        Vector3f vertices[4];
+        for (K_UINT i = 0; i < aSimplex.count; ++i)
+            vertices[i] = aSimplex.points[i].w;
+
+        SimplexSolution solution;
+        switch (aSimplex.count) {
+        case 1: solution = makeSolution(0); break;
+        case 2: solution = closestOnSegment(vertices, 0, 1); break;
+        case 3: solution = closestOnTriangle(vertices, 0, 1, 2); break;
+        default: solution = closestOnTetrahedron(vertices); break;
+        }
+
+        SimplexPoint points[4];
+        for (K_UINT i = 0; i < solution.count; ++i) {
+            points[i] = aSimplex.points[solution.indices[i]];
+            aSimplex.weights[i] = solution.weights[i];
+        }
+        for (K_UINT i = 0; i < solution.count; ++i)
+            aSimplex.points[i] = points[i];
+        aSimplex.count = solution.count;
+        return solution.count == 4 ? Vector3f() : getSolutionPoint(solution, vertices);
+    }
+
+    struct GjkOutput
+    {
+        Simplex simplex;
+        Vector3f closest; // Point of A - B nearest the origin.
+        bool overlapping;
+        K_UINT iterations;
+    };
+
+    // Runs GJK on the cores of two shapes, starting from the cached simplex if there is one.
+    GjkOutput runGjk(const PosedShape& aShape, const PosedShape& bShape, GjkCache* aCache) {
+        GjkOutput output;
+        Simplex& simplex = output.simplex;
+        if (aCache && aCache->count > 0) {
+            for (K_UINT i = 0; i < aCache->count; ++i)
+                simplex.points[i] = makePoint(aShape, bShape, aCache->localA[i], aCache->localB[i]);
+            simplex.count = aCache->count;
+        } else {
+            const Vector3f offset = aShape.position - bShape.position;
+            const Vector3f direction = offset.getMagnitudeSquared() > 0.0f ? offset * -1.0f : Vector3f(1.0f, 0.0f, 0.0f);
+            simplex.points[0] = getSupport(aShape, bShape, direction);
+            simplex.count = 1;
+        }
+
+        Vector3f closest = solveSimplex(simplex);
+        output.overlapping = false;
+        output.iterations = 0;
+        while (output.iterations < MAX_GJK_ITERATIONS) {
+            if (simplex.count == 4) {
+                output.overlapping = true;
+                break;
+            }
+            float size = 0.0f;
+            for (K_UINT i = 0; i < simplex.count; ++i)
+                size = std::max(size, simplex.points[i].w.getMagnitudeSquared());
+            const float distanceSquared = closest.getMagnitudeSquared();
+            if (distanceSquared <= GJK_TOUCHING_TOLERANCE * std::max(size, 1.0f)) {
+                output.overlapping = true;
+                break;
+            }
+
+            ++output.iterations;
+            const SimplexPoint support = getSupport(aShape, bShape, closest * -1.0f);
+            if (distanceSquared - closest.dot(support.w) <= GJK_RELATIVE_TOLERANCE * distanceSquared)
+                break;
+            bool duplicate = false;
+            for (K_UINT i = 0; i < simplex.count; ++i)
+                duplicate = duplicate || simplex.points[i].w == support.w;
+            if (duplicate)
+                break;
+
+            simplex.points[simplex.count++] = support;
+            const Vector3f next = solveSimplex(simplex);
+            const bool progressed = next.getMagnitudeSquared() < distanceSquared;
+            closest = next;
+            if (!progressed && simplex.count < 4)
+                break;
+        }
+
+        if (aCache) {
+            for (K_UINT i = 0; i < simplex.count; ++i) {
+                aCache->localA[i] = simplex.points[i].localA;
+                aCache->localB[i] = simplex.points[i].localB;
+            }
+            aCache->count = simplex.count;
+        }
+        output.closest = closest;
+        return output;
+    }
+
+    // Fills aResult from the closest points of separated or shallowly overlapping cores.
+    void resolveFromCores(const GjkOutput& aGjk, const PosedShape& aShape, const PosedShape& bShape,
+                          CollisionResult& aResult) {
+        Vector3f pointA, pointB;
+        for (K_UINT i = 0; i < aGjk.simplex.count; ++i) {
+            pointA.addScaled(aGjk.simplex.points[i].a, aGjk.simplex.weights[i]);
+            pointB.addScaled(aGjk.simplex.points[i].b, aGjk.simplex.weights[i]);
+        }
+        const float coreDistance = aGjk.closest.getMagnitude();
+        aResult.normal = aGjk.closest * (-1.0f / coreDistance);
+        aResult.pointA = Vector3f::MultiplyAdd(aResult.normal, aShape.radius, pointA);
+        aResult.pointB = Vector3f::MultiplyAdd(aResult.normal, -bShape.radius, pointB);
+        aResult.distance = coreDistance - aShape.radius - bShape.radius;
+        aResult.intersecting = aResult.distance < 0.0f;
+    }
+
+    struct EpaFace
+    {
+        K_UINT vertices[3];
+        Vector3f normal;
+        float distance;
+        bool removed;
+    };
+
+    class Polytope
+    {
+    public:
+        Polytope()
+            : mVertexCount(0), mFaceCount(0) { }
+
+        K_UINT addVertex(const SimplexPoint& aPoint) {
+            mVertices[mVertexCount] = aPoint;
+            return mVertexCount++;
+        }
+
+        // Adds a face whose outward normal follows its winding by the right hand rule.
+        void addFace(K_UINT i0, K_UINT i1, K_UINT i2) {
+            EpaFace& face = mFaces[mFaceCount++];
+            face.vertices[0] = i0;
+            face.vertices[1] = i1;
+            face.vertices[2] = i2;
+            face.removed = false;
+            const Vector3f& a = mVertices[i0].w;
+            const Vector3f normal = (mVertices[i1].w - a).crossProduct(mVertices[i2].w - a);
+            const float length = normal.getMagnitude();
+            if (length > 0.0f) {
+                face.normal = normal * (1.0f / length);
+                face.distance = face.normal.dot(a);
+            } else {
+                // Never chosen and never visible, so it cannot steer the expansion.
+                face.normal = Vector3f();
+                face.distance = FLT_MAX;
+            }
+        }
+
+        // Orients the four faces of a tetrahedron outwards.
+        void addTetrahedron() {
+            const Vector3f& a = mVertices[0].w;
+            const float orientation = (mVertices[1].w - a).crossProduct(mVertices[2].w - a).dot(mVertices[3].w - a);
+            if (orientation > 0.0f) {
+                addFace(0, 2, 1);
+                addFace(0, 1, 3);
+                addFace(0, 3, 2);
+                addFace(1, 2, 3);
+            } else {
+                addFace(0, 1, 2);
+                addFace(0, 3, 1);
+                addFace(0, 2, 3);
+                addFace(1, 3, 2);
+            }
+        }
+
+        // Returns the live face nearest the origin.
+        const EpaFace& getNearestFace() const {
+            K_UINT nearest = 0;
+            float nearestDistance = FLT_MAX;
+            for (K_UINT i = 0; i < mFaceCount; ++i) {
+                if (!mFaces[i].removed && mFaces[i].distance < nearestDistance) {
+                    nearestDistance = mFaces[i].distance;
+                    nearest = i;
+                }
+            }
+            return mFaces[nearest];
+        }
+
+        // Adds aPoint and replaces every face it can see with a fan to the horizon.
+        // Returns false if the polytope is out of room.
+        bool expand(const SimplexPoint& aPoint) {
+            if (mVertexCount == MAX_EPA_VERTICES)
+                return false;
+            const K_UINT newVertex = addVertex(aPoint);
+
+            K_UINT horizon[MAX_HORIZON_EDGES][2];
+            K_UINT horizonCount = 0;
+            for (K_UINT i = 0; i < mFaceCount; ++i) {
+                EpaFace& face = mFaces[i];
+                if (face.removed || face.normal.dot(aPoint.w - mVertices[face.vertices[0]].w) <= 0.0f)
+                    continue;
+                face.removed = true;
+                for (K_UINT edge = 0; edge < 3; ++edge) {
+                    const K_UINT from = face.vertices[edge];
+                    const K_UINT to = face.vertices[(edge + 1) % 3];
+                    // An edge shared with another removed face is interior; drop both copies.
+                    K_UINT shared = horizonCount;
+                    for (K_UINT j = 0; j < horizonCount; ++j)
+                        if (horizon[j][0] == to && horizon[j][1] == from)
+                            shared = j;
+                    if (shared < horizonCount) {
+                        horizon[shared][0] = horizon[horizonCount - 1][0];
+                        horizon[shared][1] = horizon[horizonCount - 1][1];
+                        --horizonCount;
+                    } else {
+                        if (horizonCount == MAX_HORIZON_EDGES)
+                            return false;
+                        horizon[horizonCount][0] = from;
+                        horizon[horizonCount][1] = to;
+                        ++horizonCount;
+                    }
+                }
+            }
+
+            if (mFaceCount + horizonCount > MAX_EPA_FACES)
+                return false;
+            for (K_UINT i = 0; i < horizonCount; ++i)
+                addFace(horizon[i][0], horizon[i][1], newVertex);
+            return true;
+        }
+
+        const SimplexPoint& getVertex(K_UINT anIndex) const { return mVertices[anIndex]; }
+        K_UINT getVertexCount() const { return mVertexCount; }
+
+    private:
+        SimplexPoint mVertices[MAX_EPA_VERTICES];
+        EpaFace mFaces[MAX_EPA_FACES];
+        K_UINT mVertexCount;
+        K_UINT mFaceCount;
+    };
+
+    // Grows a GJK simplex of fewer than four points into a tetrahedron around the origin,
+    // writing the direction tried last to aFlatNormal. Returns false if the Minkowski
+    // difference of the cores is flat, as it is for two spheres or a sphere and a capsule.
+    bool growToTetrahedron(const PosedShape& aShape, const PosedShape& bShape, Simplex& aSimplex, Vector3f& aFlatNormal) {
+        static const Vector3f axes[6] = { Vector3f(1.0f, 0.0f, 0.0f), Vector3f(-1.0f, 0.0f, 0.0f),
+                                          Vector3f(0.0f, 1.0f, 0.0f), Vector3f(0.0f, -1.0f, 0.0f),
+                                          Vector3f(0.0f, 0.0f, 1.0f), Vector3f(0.0f, 0.0f, -1.0f) };
+        const float tolerance = EPA_TOLERANCE * EPA_TOLERANCE;
+        aFlatNormal = axes[0];
+
+        if (aSimplex.count == 1) {
+            for (K_UINT i = 0; i < 6 && aSimplex.count == 1; ++i) {
+                const SimplexPoint support = getSupport(aShape, bShape, axes[i]);
+                if ((support.w - aSimplex.points[0].w).getMagnitudeSquared() > tolerance)
+                    aSimplex.points[aSimplex.count++] = support;
+            }
+        }
+
+        if (aSimplex.count == 2) {
+            const Vector3f edge = aSimplex.points[1].w - aSimplex.points[0].w;
+            const K_UINT leastAligned = fabsf(edge.x) < fabsf(edge.y) ? (fabsf(edge.x) < fabsf(edge.z) ? 0 : 4)
+                                                                      : (fabsf(edge.y) < fabsf(edge.z) ? 2 : 4);
+            const Vector3f first = edge.crossProduct(axes[leastAligned]).getNormalized();
+            const Vector3f second = edge.crossProduct(first).getNormalized();
+            const Vector3f directions[4] = { first, first * -1.0f, second, second * -1.0f };
+            const float edgeLengthSquared = edge.getMagnitudeSquared();
+            aFlatNormal = first;
+            for (K_UINT i = 0; i < 4 && aSimplex.count == 2; ++i) {
+                const SimplexPoint support = getSupport(aShape, bShape, directions[i]);
+                const Vector3f offset = support.w - aSimplex.points[0].w;
+                if (offset.crossProduct(edge).getMagnitudeSquared() > tolerance * edgeLengthSquared)
+                    aSimplex.points[aSimplex.count++] = support;
+            }
+        }
+
+        if (aSimplex.count == 3) {
+            const Vector3f& a = aSimplex.points[0].w;
+            const Vector3f normal = (aSimplex.points[1].w - a).crossProduct(aSimplex.points[2].w - a).getNormalized();
+            const Vector3f directions[2] = { normal, normal * -1.0f };
+            aFlatNormal = normal;
+            for (K_UINT i = 0; i < 2 && aSimplex.count == 3; ++i) {
+                const SimplexPoint support = getSupport(aShape, bShape, directions[i]);
+                const float height = (support.w - a).dot(normal);
+                if (height * height > tolerance)
+                    aSimplex.points[aSimplex.count++] = support;
+            }
+        }
+        return aSimplex.count == 4;
+    }
+
+    // Finds the penetration of two shapes whose cores overlap. EPA runs on the cores, which
+    // are polytopes, and the radii are added afterwards: inflating both shapes by a ball
+    // deepens the penetration by the ball's radius along every direction alike.
+    void runEpa(const PosedShape& aShape, const PosedShape& bShape, const Simplex& aSimplex, CollisionResult& aResult) {
+        Vector3f pointA, pointB;
+        for (K_UINT i = 0; i < aSimplex.count; ++i) {
+            pointA.addScaled(aSimplex.points[i].a, aSimplex.weights[i]);
+            pointB.addScaled(aSimplex.points[i].b, aSimplex.weights[i]);
+        }
+
+        // A flat difference, such as two spheres' centres, has zero depth across its plane.
+        Simplex simplex = aSimplex;
+        Vector3f normal;
+        float coreDepth = 0.0f;
+        if (growToTetrahedron(aShape, bShape, simplex, normal)) {
+            Polytope polytope;
+            for (K_UINT i = 0; i < 4; ++i)
+                polytope.addVertex(simplex.points[i]);
+            polytope.addTetrahedron();
+
+            const EpaFace* nearest = &polytope.getNearestFace();
+            for (K_UINT iteration = 0; iteration < MAX_EPA_ITERATIONS && nearest->distance < FLT_MAX; ++iteration) {
+                ++aResult.iterations;
+                const SimplexPoint support = getSupport(aShape, bShape, nearest->normal);
+                if (support.w.dot(nearest->normal) - nearest->distance <= EPA_TOLERANCE)
+                    break;
+                if (!polytope.expand(support))
+                    break;
+                nearest = &polytope.getNearestFace();
+            }
+
+            // Barycentric coordinates of the origin's projection onto the nearest face.
+            const SimplexPoint& a = polytope.getVertex(nearest->vertices[0]);
+            const SimplexPoint& b = polytope.getVertex(nearest->vertices[1]);
+            const SimplexPoint& c = polytope.getVertex(nearest->vertices[2]);
+            const Vector3f projection = nearest->normal * nearest->distance;
+            const Vector3f v0 = b.w - a.w;
+            const Vector3f v1 = c.w - a.w;
+            const Vector3f v2 = projection - a.w;
+            const float d00 = v0.dot(v0), d01 = v0.dot(v1), d11 = v1.dot(v1);
+            const float d20 = v2.dot(v0), d21 = v2.dot(v1);
+            const float denominator = d00 * d11 - d01 * d01;
+            const float weightB = denominator != 0.0f ? (d11 * d20 - d01 * d21) / denominator : 0.0f;
+            const float weightC = denominator != 0.0f ? (d00 * d21 - d01 * d20) / denominator : 0.0f;
+            const float weightA = 1.0f - weightB - weightC;
+
+            normal = nearest->normal;
+            coreDepth = nearest->distance;
+            pointA = a.a * weightA + b.a * weightB + c.a * weightC;
+            pointB = a.b * weightA + b.b * weightB + c.b * weightC;
+        }
+
+        aResult.intersecting = true;
+        aResult.normal = normal;
+        aResult.distance = -(coreDepth + aShape.radius + bShape.radius);
+        aResult.pointA = Vector3f::MultiplyAdd(normal, aShape.radius, pointA);
+        aResult.pointB = Vector3f::MultiplyAdd(normal, -bShape.radius, pointB);
+    }
+
+    Matrix4x4f rigidTransform(const Quaternion& aRotation, const Vector3f& aPosition) {
+        return Matrix4x4f::TRS(aPosition, aRotation, Vector3f(1.0f, 1.0f, 1.0f));
+    }
+}
+
+namespace KhaosEngine
+{
+    //
+    // ConvexHull function definitions.
+    //
+
+    ConvexHull::ConvexHull(const Vector3f* someVertices, K_UINT aVertexCount)
+        : mVertexCount(aVertexCount), mPaddedCount(static_cast<K_UINT>(AlignUp(aVertexCount, 4))) {
+        ASSERT(aVertexCount > 0);
+        mX = static_cast<float*>(AlignedAlloc(mPaddedCount * 3 * sizeof(float), SIMD_ALIGNMENT));
+        mY = mX + mPaddedCount;
+        mZ = mY + mPaddedCount;
+        // Pad with copies of the first vertex so the extra lanes never win.
+        for (K_UINT i = 0; i < mPaddedCount; ++i) {
+            const Vector3f& vertex = someVertices[i < aVertexCount ? i : 0];
+            mX[i] = vertex.x;
+            mY[i] = vertex.y;
+            mZ[i] = vertex.z;
+        }
+    }
+
+    ConvexHull::~ConvexHull() {
+        AlignedFree(mX);
+    }
+
+    K_UINT ConvexHull::getSupportIndex(const Vector3f& aDirection) const {
+        const __m128 directionX = _mm_set1_ps(aDirection.x);
+        const __m128 directionY = _mm_set1_ps(aDirection.y);
+        const __m128 directionZ = _mm_set1_ps(aDirection.z);
+        __m128 best = _mm_set1_ps(-FLT_MAX);
+        __m128i bestIndex = _mm_setzero_si128();
+        __m128i index = _mm_setr_epi32(0, 1, 2, 3);
+        const __m128i four = _mm_set1_epi32(4);
+
+        for (K_UINT i = 0; i < mPaddedCount; i += 4) {
+            const __m128 projection = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_load_ps(mX + i), directionX),
+                                                            _mm_mul_ps(_mm_load_ps(mY + i), directionY)),
+                                                 _mm_mul_ps(_mm_load_ps(mZ + i), directionZ));
+            const __m128 greater = _mm_cmpgt_ps(projection, best);
+            best = _mm_max_ps(projection, best);
+            const __m128i mask = _mm_castps_si128(greater);
+            bestIndex = _mm_or_si128(_mm_and_si128(mask, index), _mm_andnot_si128(mask, bestIndex));
+            index = _mm_add_epi32(index, four);
+        }
+
+        // Reduce the four lanes, preferring the lowest index on ties.
+        __declspec(align(16)) float projections[4];
+        __declspec(align(16)) K_INT indices[4];
+        _mm_store_ps(projections, best);
+        _mm_store_si128(reinterpret_cast<__m128i*>(indices), bestIndex);
+        K_UINT lane = 0;
+        for (K_UINT i = 1; i < 4; ++i)
+            if (projections[i] > projections[lane] || (projections[i] == projections[lane] && indices[i] < indices[lane]))
+                lane = i;
+        return static_cast<K_UINT>(indices[lane]);
+    }
+
+    //
+    // ConvexShape function definitions.
+    //
+
+    ConvexShape ConvexShape::Sphere(float aRadius) {
+        ConvexShape shape = { ConvexShapeType::Sphere, Vector3f(), aRadius, 0.0f, nullptr };
+        return shape;
+    }
+
+    ConvexShape ConvexShape::Box(const Vector3f& someHalfExtents) {
+        ConvexShape shape = { ConvexShapeType::Box, someHalfExtents, 0.0f, 0.0f, nullptr };
+        return shape;
+    }
+
+    ConvexShape ConvexShape::Capsule(float aRadius, float aHalfHeight) {
+        ConvexShape shape = { ConvexShapeType::Capsule, Vector3f(), aRadius, aHalfHeight, nullptr };
+        return shape;
+    }
+
+    ConvexShape ConvexShape::Hull(const ConvexHull& aHull) {
+        ConvexShape shape = { ConvexShapeType::Hull, Vector3f(), 0.0f, 0.0f, &aHull };
+        return shape;
+    }
+
+    //
+    // Query function definitions.
+    //
+
+    CollisionResult ComputeDistance(const ConvexShape& aShape, const Matrix4x4f& aTransform,
+                                    const ConvexShape& bShape, const Matrix4x4f& bTransform, GjkCache* aCache) {
+        const PosedShape posedA = poseShape(aShape, aTransform);
+        const PosedShape posedB = poseShape(bShape, bTransform);
+        const GjkOutput gjk = runGjk(posedA, posedB, aCache);
+
+        CollisionResult result;
+        result.iterations = gjk.iterations;
+        if (gjk.overlapping) {
+            result.intersecting = true;
+            result.distance = 0.0f;
+            result.normal = Vector3f();
+            result.pointA = result.pointB = posedA.position;
+        } else {
+            resolveFromCores(gjk, posedA, posedB, result);
+        }
+        return result;
+    }
+
+    CollisionResult ComputeContact(const ConvexShape& aShape, const Matrix4x4f& aTransform,
+                                   const ConvexShape& bShape, const Matrix4x4f& bTransform, GjkCache* aCache) {
+        const PosedShape posedA = poseShape(aShape, aTransform);
+        const PosedShape posedB = poseShape(bShape, bTransform);
+        const GjkOutput gjk = runGjk(posedA, posedB, aCache);
+
+        CollisionResult result;
+        result.iterations = gjk.iterations;
+        if (gjk.overlapping)
+            runEpa(posedA, posedB, gjk.simplex, result);
+        else
+            resolveFromCores(gjk, posedA, posedB, result);
+        return result;
+    }
+
+    CollisionResult ComputeDistance(const ConvexShape& aShape, const Quaternion& aRotation, const Vector3f& aPosition,
+                                    const ConvexShape& bShape, const Quaternion& bRotation, const Vector3f& bPosition,
+                                    GjkCache* aCache) {
+        return ComputeDistance(aShape, rigidTransform(aRotation, aPosition), bShape, rigidTransform(bRotation, bPosition), aCache);
+    }
+
+    CollisionResult ComputeContact(const ConvexShape& aShape, const Quaternion& aRotation, const Vector3f& aPosition,
+                                   const ConvexShape& bShape, const Quaternion& bRotation, const Vector3f& bPosition,
+                                   GjkCache* aCache) {
+        return ComputeContact(aShape, rigidTransform(aRotation, aPosition), bShape, rigidTransform(bRotation, bPosition), aCache);
+    }
+}
\ No newline at end of file
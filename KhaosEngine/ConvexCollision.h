@@ -0,0 +1,117 @@
+#pragma once
+
+// ConvexCollision.h
+// Narrowphase queries between convex shapes: GJK for distance and closest points, and EPA
+// for the depth and normal of penetrating pairs.
+//
+// Spheres and capsules are handled as a point or segment core inflated by a radius. GJK and
+// EPA run on the cores, which are polytopes, so both terminate exactly instead of chasing a
+// curved surface, and the radii are applied to the result. Pairs whose cores are within the
+// summed radii get their contact straight from the GJK closest points without running EPA.
+//
+// Poses must be rigid; bake scale into the shape dimensions instead. Keep a GjkCache per
+// pair across frames and GJK restarts from last frame's simplex, which for slowly moving
+// pairs usually converges in one or two iterations.
+
+#include "Common.h"
+#include "KhaosMath.h"
+
+namespace KhaosEngine
+{
+    using KhaosMath::Vector3f;
+    using KhaosMath::Quaternion;
+    using KhaosMath::Matrix4x4f;
+
+    // Point cloud whose convex hull is the collision shape. Vertices are stored as structure
+    // of arrays, padded to a multiple of four, so support points are found four at a time.
+    class ConvexHull
+    {
+    public:
+        ConvexHull(const Vector3f* someVertices, K_UINT aVertexCount);
+        ~ConvexHull();
+
+        // Returns the index of the vertex farthest along aDirection.
+        K_UINT getSupportIndex(const Vector3f& aDirection) const;
+
+        Vector3f getVertex(K_UINT anIndex) const {
+            ASSERT(anIndex < mVertexCount);
+            return Vector3f(mX[anIndex], mY[anIndex], mZ[anIndex]);
+        }
+
+        K_UINT getVertexCount() const { return mVertexCount; }
+
+    private:
+        ConvexHull(const ConvexHull&) = delete;
+        ConvexHull& operator=(const ConvexHull&) = delete;
+
+        float* mX;
+        float* mY;
+        float* mZ;
+        K_UINT mVertexCount;
+        K_UINT mPaddedCount;
+    };
+
+    enum class ConvexShapeType : KUI_8
+    {
+        Sphere,
+        Box,
+        Capsule, // Segment along the local y axis.
+        Hull
+    };
+
+    // Convex shape in its local space, centred on the origin for the primitive types.
+    struct ConvexShape
+    {
+        ConvexShapeType type;
+        Vector3f halfExtents; // Box.
+        float radius;         // Sphere and capsule.
+        float halfHeight;     // Capsule, excluding the end caps.
+        const ConvexHull* hull;
+
+        static ConvexShape Sphere(float aRadius);
+        static ConvexShape Box(const Vector3f& someHalfExtents);
+        static ConvexShape Capsule(float aRadius, float aHalfHeight);
+        static ConvexShape Hull(const ConvexHull& aHull);
+    };
+
+    // Last simplex found for a pair, in the local space of each shape.
+    struct GjkCache
+    {
+        Vector3f localA[4];
+        Vector3f localB[4];
+        K_UINT count;
+
+        GjkCache()
+            : count(0) { }
+    };
+
+    struct CollisionResult
+    {
+        bool intersecting;
+        float distance;   // Gap between the shapes, or minus the penetration depth.
+        Vector3f normal;  // Unit direction from A towards B; moving B along it separates them.
+        Vector3f pointA;  // Closest or deepest point on A, in world space.
+        Vector3f pointB;  // Closest or deepest point on B, in world space.
+        K_UINT iterations; // GJK plus EPA iterations, for profiling.
+    };
+
+    // Returns the distance and closest points between two shapes posed by rigid transforms.
+    // Spheres and capsules overlapping by less than their radii also get a depth and normal;
+    // other penetrating pairs report intersecting with a distance of zero and a zero normal.
+    CollisionResult ComputeDistance(const ConvexShape& aShape, const Matrix4x4f& aTransform,
+                                    const ConvexShape& bShape, const Matrix4x4f& bTransform,
+                                    GjkCache* aCache = nullptr);
+
+    // Like ComputeDistance, but penetrating pairs also get their depth, normal and deepest points.
+    CollisionResult ComputeContact(const ConvexShape& aShape, const Matrix4x4f& aTransform,
+                                   const ConvexShape& bShape, const Matrix4x4f& bTransform,
+                                   GjkCache* aCache = nullptr);
+
+    // Overloads for shapes posed by a rotation and a position.
+    CollisionResult ComputeDistance(const ConvexShape& aShape, const Quaternion& aRotation, const Vector3f& aPosition,
+                                    const ConvexShape& bShape, const Quaternion& bRotation, const Vector3f& bPosition,
+                                    GjkCache* aCache = nullptr);
+    CollisionResult ComputeContact(const ConvexShape& aShape, const Quaternion& aRotation, const Vector3f& aPosition,
+                                   const ConvexShape& bShape, const Quaternion& bRotation, const Vector3f& bPosition,
+                                   GjkCache* aCache = nullptr);
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+
+// CpuFeatures.h
+// Runtime detection of the x86 instruction set extensions KhaosMath kernels can dispatch to.
+
+#include "Common.h"
+
+#include <intrin.h>
+#include <immintrin.h>
+
+namespace KhaosMath
+{
+    // Instruction set extensions supported by the CPU and enabled by the operating system.
+    struct CpuFeatures
+    {
+        bool sse2;
+        bool sse41;
+        bool avx;
+        bool avx2;
+        bool fma;
+        bool f16c;
+
+        // Returns the features kernels should dispatch on: those of the running CPU, less any
+        // turned off with Restrict.
+        static const CpuFeatures& Get() {
+            return Active();
+        }
+
+        // Returns the features of the running CPU, queried once on first use.
+        static const CpuFeatures& Detected() {
+            static const CpuFeatures features = Query();
+            return features;
+        }
+
+        // Turns off every feature that is off in aMask, so tests and benchmarks can run the
+        // fallback paths on a newer CPU. Not thread safe: call while no kernel is running.
+        static void Restrict(const CpuFeatures& aMask) {
+            const CpuFeatures& detected = Detected();
+            CpuFeatures& active = Active();
+            active.sse2 = detected.sse2 && aMask.sse2;
+            active.sse41 = detected.sse41 && aMask.sse41;
+            active.avx = detected.avx && aMask.avx;
+            active.avx2 = detected.avx2 && aMask.avx2;
+            active.fma = detected.fma && aMask.fma;
+            active.f16c = detected.f16c && aMask.f16c;
+        }
+
+        // Undoes Restrict.
+        static void Unrestrict() {
+            Active() = Detected();
+        }
+
+    private:
+        static CpuFeatures& Active() {
+            static CpuFeatures features = Detected();
+            return features;
+        }
+
+        static CpuFeatures Query() {
+            CpuFeatures features = { false, false, false, false, false, false };
+
+            int registers[4] = { 0, 0, 0, 0 };
+            __cpuid(registers, 0);
+            const int highestLeaf = registers[0];
+            if (highestLeaf < 1)
+                return features;
+
+            __cpuid(registers, 1);
+            const int ecx = registers[2];
+            const int edx = registers[3];
+            features.sse2 = (edx & (1 << 26)) != 0;
+            features.sse41 = (ecx & (1 << 19)) != 0;
+
+            // AVX state must also be enabled by the OS through XSAVE before any VEX encoded use.
+            const bool osSavesAvx = (ecx & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+            features.avx = osSavesAvx && (ecx & (1 << 28)) != 0;
+            features.fma = features.avx && (ecx & (1 << 12)) != 0;
+            features.f16c = features.avx && (ecx & (1 << 29)) != 0;
+
+            if (highestLeaf >= 7) {
+                __cpuidex(registers, 7, 0);
+                features.avx2 = features.avx && (registers[1] & (1 << 5)) != 0;
+            }
+            return features;
+        }
+    };
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+#pragma once
+
+// DualQuaternion.h
+// Unit dual quaternions representing rigid transforms (rotation followed by translation).
+// Blending dual quaternions preserves volume where blending matrices collapses joints.
+
+#include "Common.h"
+#include "CommonMath.h"
+
+#include "Vector3f.h"
+#include "Quaternion.h"
+#include "Matrix4x4f.h"
+
+namespace KhaosMath
+{
+    // Class representing a rigid transform as a real (rotation) and dual (translation) quaternion.
+    __declspec(align(16)) class DualQuaternion
+    {
+    public:
+        Quaternion real;
+        Quaternion dual;
+
+        // Default constructor will produce the identity transform.
+        constexpr DualQuaternion()
+            : real(0.0f, 0.0f, 0.0f, 1.0f), dual(0.0f, 0.0f, 0.0f, 0.0f) { }
+
+        // Constructor to explicitly initialize both parts.
+        constexpr DualQuaternion(const Quaternion& aReal, const Quaternion& aDual)
+            : real(aReal), dual(aDual) { }
+
+        // Constructor from a unit rotation and a translation applied after it.
+        constexpr DualQuaternion(const Quaternion& aRotation, const Vector3f& aTranslation)
+            : real(aRotation), dual(Quaternion(aTranslation, 0.0f) * aRotation * 0.5f) { }
+
+        // Add each part together to create a new dual quaternion.
+        constexpr DualQuaternion operator+(const DualQuaternion& other) const {
+            return DualQuaternion(real + other.real, dual + other.dual);
+        }
+
+        // Multiply both parts by a scalar.
+        constexpr DualQuaternion operator*(const float aScalar) const {
+            return DualQuaternion(real * aScalar, dual * aScalar);
+        }
+
+        // Returns the transform that applies other first and then this.
+        constexpr DualQuaternion operator*(const DualQuaternion& other) const {
+            return DualQuaternion(real * other.real, real * other.dual + dual * other.real);
+        }
+
+        // Returns the translation part.
+        constexpr Vector3f getTranslation() const {
+            return (dual * real.getConjugate() * 2.0f).getVectorPart();
+        }
+
+        // Returns this dual quaternion scaled so the real part has unit length.
+        DualQuaternion getNormalized() const {
+            const float inverseLength = 1.0f / real.getMagnitude();
+            return DualQuaternion(real * inverseLength, dual * inverseLength);
+        }
+
+        // Transforms a point by the rotation and then the translation.
+        constexpr Vector3f transformPoint(const Vector3f& aPoint) const {
+            return transformVector(aPoint) + getTranslation();
+        }
+
+        // Rotates a direction, ignoring translation.
+        constexpr Vector3f transformVector(const Vector3f& aVector) const {
+            const Vector3f axis = real.getVectorPart();
+            return aVector + axis.crossProduct(axis.crossProduct(aVector) + aVector * real.w) * 2.0f;
+        }
+
+        // Builds a dual quaternion from a rigid row-vector matrix. Any scale in the
+        // matrix is removed from the rotation; shear is not supported.
+        static DualQuaternion FromMatrix(const Matrix4x4f& aMatrix) {
+            float m[3][3];
+            for (K_INT row = 0; row < 3; ++row) {
+                const float length = sqrtf(aMatrix(row, 0) * aMatrix(row, 0) + aMatrix(row, 1) * aMatrix(row, 1) +
+                                           aMatrix(row, 2) * aMatrix(row, 2));
+                const float inverseLength = length > 0.0f ? 1.0f / length : 0.0f;
+                for (K_INT col = 0; col < 3; ++col)
+                    m[row][col] = aMatrix(row, col) * inverseLength;
+            }
+
+            // Pick the largest of w, x, y, z to divide by for precision.
+            Quaternion rotation;
+            const float trace = m[0][0] + m[1][1] + m[2][2];
+            if (trace > 0.0f) {
+                const float s = 2.0f * sqrtf(1.0f + trace);
+                rotation = Quaternion((m[1][2] - m[2][1]) / s, (m[2][0] - m[0][2]) / s,
+                                      (m[0][1] - m[1][0]) / s, 0.25f * s);
+            }
+            else if (m[0][0] > m[1][1] && m[0][0] > m[2][2]) {
+                const float s = 2.0f * sqrtf(1.0f + m[0][0] - m[1][1] - m[2][2]);
+                rotation = Quaternion(0.25f * s, (m[0][1] + m[1][0]) / s,
+                                      (m[0][2] + m[2][0]) / s, (m[1][2] - m[2][1]) / s);
+            }
+            else if (m[1][1] > m[2][2]) {
+                const float s = 2.0f * sqrtf(1.0f - m[0][0] + m[1][1] - m[2][2]);
+                rotation = Quaternion((m[0][1] + m[1][0]) / s, 0.25f * s,
+                                      (m[1][2] + m[2][1]) / s, (m[2][0] - m[0][2]) / s);
+            }
+            else {
+                const float s = 2.0f * sqrtf(1.0f - m[0][0] - m[1][1] + m[2][2]);
+                rotation = Quaternion((m[0][2] + m[2][0]) / s, (m[1][2] + m[2][1]) / s,
+                                      0.25f * s, (m[0][1] - m[1][0]) / s);
+            }
+
+            rotation = rotation / rotation.getMagnitude();
+            return DualQuaternion(rotation, Vector3f(aMatrix(3, 0), aMatrix(3, 1), aMatrix(3, 2)));
+        }
+    };
+}
\ No newline at end of file
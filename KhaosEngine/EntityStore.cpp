@@ -0,0 +1,232 @@
+// EntityStore.cpp
+// Component type registry, archetype layout and chunk management.
+
+#include "EntityStore.h"
+
+#include <cstring>
+
+namespace
+{
+    using namespace KhaosEngine;
+
+    ComponentTypeInfo sComponentTypes[MAX_COMPONENT_TYPES];
+    std::atomic<ComponentTypeId> sComponentTypeCount(0);
+
+    // Columns start past the chunk header, on its own cache line.
+    const size_t CHUNK_HEADER_SIZE = AlignUp(sizeof(EntityChunk), 64);
+
+    // Returns the number of bytes a chunk of anArchetype needs to hold aCapacity entities,
+    // filling in the column offsets when aWriteOffsets is set.
+    size_t layoutChunk(Archetype& anArchetype, K_UINT aCapacity, bool aWriteOffsets) {
+        size_t offset = CHUNK_HEADER_SIZE;
+        if (aWriteOffsets)
+            anArchetype.entityOffset = static_cast<KUI_16>(offset);
+        offset += sizeof(Entity) * aCapacity;
+
+        for (size_t i = 0; i < anArchetype.types.size(); ++i) {
+            const ComponentTypeInfo& info = GetComponentTypeInfo(anArchetype.types[i]);
+            offset = AlignUp(offset, info.alignment > SIMD_ALIGNMENT ? info.alignment : SIMD_ALIGNMENT);
+            if (aWriteOffsets)
+                anArchetype.columnOffsets[anArchetype.types[i]] = static_cast<KUI_16>(offset);
+            offset += info.size * aCapacity;
+        }
+        return offset;
+    }
+}
+
+namespace KhaosEngine
+{
+    //
+    // Component registry function definitions.
+    //
+
+    ComponentTypeId RegisterComponentType(size_t aSize, size_t anAlignment) {
+        const ComponentTypeId id = sComponentTypeCount++;
+        ASSERT(id < MAX_COMPONENT_TYPES);
+        sComponentTypes[id].size = aSize;
+        sComponentTypes[id].alignment = anAlignment;
+        return id;
+    }
+
+    const ComponentTypeInfo& GetComponentTypeInfo(ComponentTypeId aType) {
+        ASSERT(aType < sComponentTypeCount);
+        return sComponentTypes[aType];
+    }
+
+    //
+    // EntityStore function definitions.
+    //
+
+    EntityStore::EntityStore()
+        : mEntityCount(0) { }
+
+    EntityStore::~EntityStore() {
+        for (size_t a = 0; a < mArchetypes.size(); ++a) {
+            for (size_t c = 0; c < mArchetypes[a]->chunks.size(); ++c)
+                AlignedFree(mArchetypes[a]->chunks[c]);
+            delete mArchetypes[a];
+        }
+        for (size_t c = 0; c < mFreeChunks.size(); ++c)
+            AlignedFree(mFreeChunks[c]);
+    }
+
+    Entity EntityStore::createWithMask(ComponentMask aMask) {
+        Entity entity;
+        if (mFreeIndices.empty()) {
+            entity.index = static_cast<KUI_32>(mRecords.size());
+            entity.generation = 0;
+            EntityRecord record = { nullptr, 0, 0 };
+            mRecords.push_back(record);
+        }
+        else {
+            entity.index = mFreeIndices.back();
+            entity.generation = mRecords[entity.index].generation;
+            mFreeIndices.pop_back();
+        }
+
+        EntityRecord& record = mRecords[entity.index];
+        record.chunk = allocateRow(*getOrCreateArchetype(aMask), entity, record.row);
+        ++mEntityCount;
+        return entity;
+    }
+
+    void EntityStore::destroy(Entity anEntity) {
+        ASSERT(isAlive(anEntity));
+        EntityRecord& record = mRecords[anEntity.index];
+        removeRow(record.chunk, record.row);
+        record.chunk = nullptr;
+        ++record.generation;
+        mFreeIndices.push_back(anEntity.index);
+        --mEntityCount;
+    }
+
+    bool EntityStore::isAlive(Entity anEntity) const {
+        return anEntity.index < mRecords.size() && mRecords[anEntity.index].chunk != nullptr &&
+               mRecords[anEntity.index].generation == anEntity.generation;
+    }
+
+    ComponentMask EntityStore::getMask(Entity anEntity) const {
+        ASSERT(isAlive(anEntity));
+        return mRecords[anEntity.index].chunk->getMask();
+    }
+
+    void* EntityStore::getComponentData(Entity anEntity, ComponentTypeId aType) const {
+        ASSERT(isAlive(anEntity));
+        const EntityRecord& record = mRecords[anEntity.index];
+        const KUI_16 offset = record.chunk->mArchetype->columnOffsets[aType];
+        if (offset == 0)
+            return nullptr;
+        return reinterpret_cast<KUI_8*>(record.chunk) + offset + GetComponentTypeInfo(aType).size * record.row;
+    }
+
+    void EntityStore::changeArchetype(Entity anEntity, ComponentMask aMask) {
+        ASSERT(isAlive(anEntity));
+        EntityRecord& record = mRecords[anEntity.index];
+        EntityChunk* oldChunk = record.chunk;
+        const K_UINT oldRow = record.row;
+        const Archetype& oldArchetype = *oldChunk->mArchetype;
+        if (oldArchetype.mask == aMask)
+            return;
+
+        Archetype& newArchetype = *getOrCreateArchetype(aMask);
+        K_UINT newRow;
+        EntityChunk* newChunk = allocateRow(newArchetype, anEntity, newRow);
+
+        // Carry over the components both archetypes share.
+        for (size_t i = 0; i < oldArchetype.types.size(); ++i) {
+            const ComponentTypeId type = oldArchetype.types[i];
+            if (newArchetype.columnOffsets[type] == 0)
+                continue;
+            const size_t size = GetComponentTypeInfo(type).size;
+            memcpy(reinterpret_cast<KUI_8*>(newChunk) + newArchetype.columnOffsets[type] + size * newRow,
+                   reinterpret_cast<KUI_8*>(oldChunk) + oldArchetype.columnOffsets[type] + size * oldRow, size);
+        }
+
+        removeRow(oldChunk, oldRow);
+        record.chunk = newChunk;
+        record.row = newRow;
+    }
+
+    void EntityStore::getChunks(ComponentMask anInclude, ComponentMask anExclude,
+                                std::vector<EntityChunk*>& someChunks) const {
+        for (size_t a = 0; a < mArchetypes.size(); ++a) {
+            const Archetype& archetype = *mArchetypes[a];
+            if ((archetype.mask & anInclude) == anInclude && (archetype.mask & anExclude) == 0)
+                someChunks.insert(someChunks.end(), archetype.chunks.begin(), archetype.chunks.end());
+        }
+    }
+
+    Archetype* EntityStore::getOrCreateArchetype(ComponentMask aMask) {
+        std::unordered_map<ComponentMask, Archetype*>::const_iterator found = mArchetypesByMask.find(aMask);
+        if (found != mArchetypesByMask.end())
+            return found->second;
+
+        Archetype* archetype = new Archetype();
+        archetype->mask = aMask;
+        for (ComponentTypeId type = 0; type < MAX_COMPONENT_TYPES; ++type) {
+            archetype->columnOffsets[type] = 0;
+            if (aMask & (ComponentMask(1) << type))
+                archetype->types.push_back(type);
+        }
+
+        // Start from an estimate that ignores padding, then shrink until the columns fit.
+        size_t bytesPerEntity = sizeof(Entity);
+        for (size_t i = 0; i < archetype->types.size(); ++i)
+            bytesPerEntity += GetComponentTypeInfo(archetype->types[i]).size;
+        K_UINT capacity = static_cast<K_UINT>((EntityChunk::SIZE - CHUNK_HEADER_SIZE) / bytesPerEntity);
+        while (capacity > 0 && layoutChunk(*archetype, capacity, false) > EntityChunk::SIZE)
+            --capacity;
+        ASSERT(capacity > 0);
+        archetype->capacity = capacity;
+        layoutChunk(*archetype, capacity, true);
+
+        mArchetypes.push_back(archetype);
+        mArchetypesByMask[aMask] = archetype;
+        return archetype;
+    }
+
+    EntityChunk* EntityStore::allocateRow(Archetype& anArchetype, Entity anEntity, K_UINT& aRow) {
+        if (anArchetype.chunks.empty() || anArchetype.chunks.back()->mCount == anArchetype.capacity) {
+            void* memory;
+            if (mFreeChunks.empty()) {
+                memory = AlignedAlloc(EntityChunk::SIZE, 64);
+            }
+            else {
+                memory = mFreeChunks.back();
+                mFreeChunks.pop_back();
+            }
+            anArchetype.chunks.push_back(new (memory) EntityChunk(&anArchetype));
+        }
+
+        EntityChunk* chunk = anArchetype.chunks.back();
+        aRow = chunk->mCount++;
+        const_cast<Entity*>(chunk->getEntities())[aRow] = anEntity;
+        return chunk;
+    }
+
+    void EntityStore::removeRow(EntityChunk* aChunk, K_UINT aRow) {
+        Archetype& archetype = *aChunk->mArchetype;
+        EntityChunk* lastChunk = archetype.chunks.back();
+        const K_UINT lastRow = lastChunk->mCount - 1;
+
+        // Fill the hole with the archetype's last entity so every chunk but the last stays full.
+        if (aChunk != lastChunk || aRow != lastRow) {
+            Entity* entities = const_cast<Entity*>(aChunk->getEntities());
+            const Entity moved = lastChunk->getEntities()[lastRow];
+            entities[aRow] = moved;
+            for (size_t i = 0; i < archetype.types.size(); ++i) {
+                const ComponentTypeId type = archetype.types[i];
+                const size_t size = GetComponentTypeInfo(type).size;
+                memcpy(reinterpret_cast<KUI_8*>(aChunk) + archetype.columnOffsets[type] + size * aRow,
+                       reinterpret_cast<KUI_8*>(lastChunk) + archetype.columnOffsets[type] + size * lastRow, size);
+            }
+            mRecords[moved.index].chunk = aChunk;
+            mRecords[moved.index].row = aRow;
+        }
+
+        if (--lastChunk->mCount == 0) {
+            archetype.chunks.pop_back();
+            mFreeChunks.push_back(lastChunk);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,246 @@
+#pragma once
+
+// EntityStore.h
+// Archetype based entity-component storage.
+//
+// Entities with the same set of component types share an archetype, whose data lives in
+// fixed size 16 KiB chunks. A chunk stores each component type as its own 16-byte aligned
+// column, so iterating one component over a chunk is a linear walk over SIMD-ready memory.
+// Queries visit only the chunks of matching archetypes, and the chunks can be split
+// across the worker pool because no two chunks share data.
+//
+// Components must be trivially destructible and safe to relocate with memcpy, which holds
+// for all KhaosMath types and plain structs of them. Creating, destroying, adding or
+// removing components invalidates component pointers and must not happen during a query.
+
+#include "Common.h"
+#include "Memory.h"
+#include "WorkerPool.h"
+
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace KhaosEngine
+{
+    typedef KUI_32 ComponentTypeId;
+    typedef KUI_64 ComponentMask;
+
+    // Component types are limited by the width of ComponentMask.
+    const ComponentTypeId MAX_COMPONENT_TYPES = 64;
+
+    // Handle to an entity. The generation detects handles to destroyed entities.
+    struct Entity
+    {
+        KUI_32 index;
+        KUI_32 generation;
+
+        bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+        bool operator!=(const Entity& other) const { return !(*this == other); }
+    };
+
+    struct ComponentTypeInfo
+    {
+        size_t size;
+        size_t alignment;
+    };
+
+    // Assigns the next component type id. Use ComponentType<T>::Id() instead of calling this directly.
+    ComponentTypeId RegisterComponentType(size_t aSize, size_t anAlignment);
+
+    // Returns the size and alignment registered for aType.
+    const ComponentTypeInfo& GetComponentTypeInfo(ComponentTypeId aType);
+
+    // Lazily registers T and returns its id. Ids are assigned in first use order.
+    template <typename T>
+    struct ComponentType
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "Components must be trivially destructible.");
+
+        static ComponentTypeId Id() {
+            static const ComponentTypeId id = RegisterComponentType(sizeof(T), __alignof(T));
+            return id;
+        }
+
+        static ComponentMask Mask() {
+            return ComponentMask(1) << Id();
+        }
+    };
+
+    // Returns the mask with a bit set for each of the given component types.
+    template <typename... Ts>
+    ComponentMask ComponentMaskOf() {
+        const ComponentMask bits[] = { 0, ComponentType<Ts>::Mask()... };
+        ComponentMask mask = 0;
+        for (size_t i = 0; i < sizeof(bits) / sizeof(bits[0]); ++i) {
+            ASSERT((mask & bits[i]) == 0);
+            mask |= bits[i];
+        }
+        return mask;
+    }
+
+    class EntityChunk;
+
+    // Layout shared by every chunk of one combination of component types.
+    struct Archetype
+    {
+        ComponentMask mask;
+        K_UINT capacity;
+        KUI_16 entityOffset;
+
+        // Byte offset of each component column from the start of a chunk, or 0 if absent.
+        KUI_16 columnOffsets[MAX_COMPONENT_TYPES];
+        std::vector<ComponentTypeId> types;
+
+        // Every chunk but the last is full.
+        std::vector<EntityChunk*> chunks;
+    };
+
+    // A 16 KiB block holding this header followed by one column per component type.
+    class EntityChunk
+    {
+    public:
+        static const size_t SIZE = 16 * 1024;
+
+        K_UINT getCount() const { return mCount; }
+        K_UINT getCapacity() const { return mArchetype->capacity; }
+        ComponentMask getMask() const { return mArchetype->mask; }
+
+        const Entity* getEntities() const {
+            return reinterpret_cast<const Entity*>(reinterpret_cast<const KUI_8*>(this) + mArchetype->entityOffset);
+        }
+
+        // Returns the column of T, or nullptr if this chunk's archetype does not have T.
+        template <typename T>
+        T* getColumn() const {
+            const KUI_16 offset = mArchetype->columnOffsets[ComponentType<T>::Id()];
+            return offset == 0 ? nullptr
+                               : reinterpret_cast<T*>(const_cast<KUI_8*>(reinterpret_cast<const KUI_8*>(this)) + offset);
+        }
+
+    private:
+        friend class EntityStore;
+
+        EntityChunk(Archetype* anArchetype) : mArchetype(anArchetype), mCount(0) { }
+
+        Archetype* mArchetype;
+        K_UINT mCount;
+    };
+
+    class EntityStore
+    {
+    public:
+        EntityStore();
+        ~EntityStore();
+
+        // Creates an entity holding copies of the given components.
+        template <typename... Ts>
+        Entity create(const Ts&... someComponents) {
+            const Entity entity = createWithMask(ComponentMaskOf<Ts...>());
+            const K_INT constructed[] = { 0, (new (getComponentData(entity, ComponentType<Ts>::Id())) Ts(someComponents), 0)... };
+            (void)constructed;
+            return entity;
+        }
+
+        // Destroys an entity and its components.
+        void destroy(Entity anEntity);
+
+        // Returns whether anEntity refers to an entity that has not been destroyed.
+        bool isAlive(Entity anEntity) const;
+
+        K_UINT getEntityCount() const { return mEntityCount; }
+        size_t getArchetypeCount() const { return mArchetypes.size(); }
+
+        // Returns the entity's T component, or nullptr if it has none.
+        template <typename T>
+        T* get(Entity anEntity) const {
+            return static_cast<T*>(getComponentData(anEntity, ComponentType<T>::Id()));
+        }
+
+        // Adds or overwrites the entity's T component, moving it to a new archetype if needed.
+        template <typename T>
+        T& add(Entity anEntity, const T& aComponent) {
+            if (T* existing = get<T>(anEntity)) {
+                *existing = aComponent;
+                return *existing;
+            }
+            changeArchetype(anEntity, getMask(anEntity) | ComponentType<T>::Mask());
+            return *new (getComponentData(anEntity, ComponentType<T>::Id())) T(aComponent);
+        }
+
+        // Removes the entity's T component if it has one.
+        template <typename T>
+        void remove(Entity anEntity) {
+            const ComponentMask mask = getMask(anEntity);
+            if (mask & ComponentType<T>::Mask())
+                changeArchetype(anEntity, mask & ~ComponentType<T>::Mask());
+        }
+
+        // Returns the component types of an entity.
+        ComponentMask getMask(Entity anEntity) const;
+
+        // Appends every chunk whose archetype has all of anInclude and none of anExclude.
+        void getChunks(ComponentMask anInclude, ComponentMask anExclude, std::vector<EntityChunk*>& someChunks) const;
+
+        // Calls aFunction(Ts&...) for every entity that has all of Ts, chunk by chunk.
+        template <typename... Ts, typename Function>
+        void forEach(Function aFunction) const {
+            const ComponentMask include = ComponentMaskOf<Ts...>();
+            for (size_t a = 0; a < mArchetypes.size(); ++a) {
+                const Archetype& archetype = *mArchetypes[a];
+                if ((archetype.mask & include) != include)
+                    continue;
+                for (size_t c = 0; c < archetype.chunks.size(); ++c)
+                    ForEachInChunk<Ts...>(*archetype.chunks[c], aFunction, std::index_sequence_for<Ts...>());
+            }
+        }
+
+        // Calls aFunction(Ts&...) for every entity in aChunk. Useful inside chunk workers.
+        template <typename... Ts, typename Function, size_t... Indices>
+        static void ForEachInChunk(const EntityChunk& aChunk, Function& aFunction, std::index_sequence<Indices...>) {
+            const std::tuple<Ts*...> columns(aChunk.getColumn<Ts>()...);
+            const K_UINT count = aChunk.getCount();
+            for (K_UINT i = 0; i < count; ++i)
+                aFunction(std::get<Indices>(columns)[i]...);
+        }
+
+    private:
+        EntityStore(const EntityStore&) = delete;
+        EntityStore& operator=(const EntityStore&) = delete;
+
+        struct EntityRecord
+        {
+            EntityChunk* chunk;
+            K_UINT row;
+            KUI_32 generation;
+        };
+
+        Entity createWithMask(ComponentMask aMask);
+        void* getComponentData(Entity anEntity, ComponentTypeId aType) const;
+        void changeArchetype(Entity anEntity, ComponentMask aMask);
+
+        Archetype* getOrCreateArchetype(ComponentMask aMask);
+        EntityChunk* allocateRow(Archetype& anArchetype, Entity anEntity, K_UINT& aRow);
+        void removeRow(EntityChunk* aChunk, K_UINT aRow);
+
+        std::vector<Archetype*> mArchetypes;
+        std::unordered_map<ComponentMask, Archetype*> mArchetypesByMask;
+        std::vector<EntityChunk*> mFreeChunks;
+
+        std::vector<EntityRecord> mRecords;
+        std::vector<KUI_32> mFreeIndices;
+        K_UINT mEntityCount;
+    };
+
+    // Calls aFunction(EntityChunk&) for every chunk, spread over the shared worker pool and the
+    // calling thread. Threads take chunks one at a time, so uneven chunks balance themselves.
+    template <typename Function>
+    void ForEachChunkParallel(const std::vector<EntityChunk*>& someChunks, Function aFunction) {
+        WorkerPool::Shared().forEach(static_cast<K_UINT>(someChunks.size()), [&](K_UINT aChunk) {
+            aFunction(*someChunks[aChunk]);
+        });
+    }
+}
\ No newline at end of file
@@ -0,0 +1,179 @@
+#pragma once
+
+// FixedMatrix4x4.h
+// 4x4 matrix over a fixed-point scalar, mirroring Matrix4x4f. Vectors are rows, so
+// transforms compose left to right and translation lives in the last row.
+
+#include "Common.h"
+#include "FixedPoint.h"
+#include "FixedVector3.h"
+#include "FixedQuaternion.h"
+#include "Matrix4x4f.h"
+
+namespace KhaosMath
+{
+    // Class representing a 4x4 matrix comprised of 16 fixed-point numbers.
+    template <typename T>
+    class FixedMatrix4x4
+    {
+    public:
+        T elem[4][4];
+
+        // Default constructor that zeros all elem.
+        constexpr FixedMatrix4x4()
+            : elem{ { T(), T(), T(), T() },
+                    { T(), T(), T(), T() },
+                    { T(), T(), T(), T() },
+                    { T(), T(), T(), T() } } { }
+
+        // Constructor to explicitly initialize all elem.
+        constexpr FixedMatrix4x4(T a, T b, T c, T d,
+                                 T e, T f, T g, T h,
+                                 T i, T j, T k, T l,
+                                 T m, T n, T o, T p)
+            : elem{ { a, b, c, d },
+                    { e, f, g, h },
+                    { i, j, k, l },
+                    { m, n, o, p } } { }
+
+        constexpr T& operator() (K_INT aRow, K_INT aCol) {
+            return elem[aRow][aCol];
+        }
+
+        constexpr T operator() (K_INT aRow, K_INT aCol) const {
+            return elem[aRow][aCol];
+        }
+
+        // Add two matrices together to create a new one.
+        constexpr FixedMatrix4x4 operator+(const FixedMatrix4x4& other) const {
+            FixedMatrix4x4 result;
+            for (K_INT row = 0; row < 4; ++row)
+                for (K_INT col = 0; col < 4; ++col)
+                    result.elem[row][col] = elem[row][col] + other.elem[row][col];
+            return result;
+        }
+
+        // Subtract a matrix from another to create a new one.
+        constexpr FixedMatrix4x4 operator-(const FixedMatrix4x4& other) const {
+            FixedMatrix4x4 result;
+            for (K_INT row = 0; row < 4; ++row)
+                for (K_INT col = 0; col < 4; ++col)
+                    result.elem[row][col] = elem[row][col] - other.elem[row][col];
+            return result;
+        }
+
+        // Multiply each element by a scalar.
+        constexpr FixedMatrix4x4 operator*(const T aScalar) const {
+            FixedMatrix4x4 result;
+            for (K_INT row = 0; row < 4; ++row)
+                for (K_INT col = 0; col < 4; ++col)
+                    result.elem[row][col] = elem[row][col] * aScalar;
+            return result;
+        }
+
+        // Returns the transform that applies this matrix and then other.
+        constexpr FixedMatrix4x4 operator*(const FixedMatrix4x4& other) const {
+            FixedMatrix4x4 result;
+            for (K_INT row = 0; row < 4; ++row)
+                for (K_INT col = 0; col < 4; ++col)
+                    result.elem[row][col] = elem[row][0] * other.elem[0][col] + elem[row][1] * other.elem[1][col] +
+                                            elem[row][2] * other.elem[2][col] + elem[row][3] * other.elem[3][col];
+            return result;
+        }
+
+        // Matrices are equal only when every element is bit identical.
+        constexpr bool operator==(const FixedMatrix4x4& other) const {
+            for (K_INT row = 0; row < 4; ++row)
+                for (K_INT col = 0; col < 4; ++col)
+                    if (elem[row][col] != other.elem[row][col])
+                        return false;
+            return true;
+        }
+
+        constexpr bool operator!=(const FixedMatrix4x4& other) const {
+            return !(*this == other);
+        }
+
+        // Returns the transpose of this matrix.
+        constexpr FixedMatrix4x4 getTranspose() const {
+            FixedMatrix4x4 result;
+            for (K_INT row = 0; row < 4; ++row)
+                for (K_INT col = 0; col < 4; ++col)
+                    result.elem[row][col] = elem[col][row];
+            return result;
+        }
+
+        // Transforms a point, including translation.
+        constexpr FixedVector3<T> transformPoint(const FixedVector3<T>& aPoint) const {
+            return FixedVector3<T>(aPoint.x * elem[0][0] + aPoint.y * elem[1][0] + aPoint.z * elem[2][0] + elem[3][0],
+                                   aPoint.x * elem[0][1] + aPoint.y * elem[1][1] + aPoint.z * elem[2][1] + elem[3][1],
+                                   aPoint.x * elem[0][2] + aPoint.y * elem[1][2] + aPoint.z * elem[2][2] + elem[3][2]);
+        }
+
+        // Transforms a direction, ignoring translation.
+        constexpr FixedVector3<T> transformVector(const FixedVector3<T>& aVector) const {
+            return FixedVector3<T>(aVector.x * elem[0][0] + aVector.y * elem[1][0] + aVector.z * elem[2][0],
+                                   aVector.x * elem[0][1] + aVector.y * elem[1][1] + aVector.z * elem[2][1],
+                                   aVector.x * elem[0][2] + aVector.y * elem[1][2] + aVector.z * elem[2][2]);
+        }
+
+        // Converts to a float matrix for rendering.
+        constexpr Matrix4x4f toMatrix4x4f() const {
+            Matrix4x4f result;
+            for (K_INT row = 0; row < 4; ++row)
+                for (K_INT col = 0; col < 4; ++col)
+                    result(row, col) = elem[row][col].toFloat();
+            return result;
+        }
+
+        // Returns the identity matrix.
+        static constexpr FixedMatrix4x4 Identity() {
+            const T one = T::One();
+            return FixedMatrix4x4(one, T(), T(), T(),
+                                  T(), one, T(), T(),
+                                  T(), T(), one, T(),
+                                  T(), T(), T(), one);
+        }
+
+        // Returns a matrix that translates points by aTranslation.
+        static constexpr FixedMatrix4x4 Translation(const FixedVector3<T>& aTranslation) {
+            FixedMatrix4x4 result = Identity();
+            result.elem[3][0] = aTranslation.x;
+            result.elem[3][1] = aTranslation.y;
+            result.elem[3][2] = aTranslation.z;
+            return result;
+        }
+
+        // Returns a matrix that scales each axis.
+        static constexpr FixedMatrix4x4 Scale(const FixedVector3<T>& aScale) {
+            FixedMatrix4x4 result = Identity();
+            result.elem[0][0] = aScale.x;
+            result.elem[1][1] = aScale.y;
+            result.elem[2][2] = aScale.z;
+            return result;
+        }
+
+        // Returns a matrix that rotates by a unit quaternion.
+        static constexpr FixedMatrix4x4 Rotation(const FixedQuaternion<T>& aRotation) {
+            return TRS(FixedVector3<T>(), aRotation, FixedVector3<T>(T::One(), T::One(), T::One()));
+        }
+
+        // Returns Scale(aScale) * Rotation(aRotation) * Translation(aTranslation).
+        static constexpr FixedMatrix4x4 TRS(const FixedVector3<T>& aTranslation, const FixedQuaternion<T>& aRotation,
+                                            const FixedVector3<T>& aScale) {
+            const T x2 = aRotation.x + aRotation.x;
+            const T y2 = aRotation.y + aRotation.y;
+            const T z2 = aRotation.z + aRotation.z;
+            const T xx = aRotation.x * x2, xy = aRotation.x * y2, xz = aRotation.x * z2;
+            const T yy = aRotation.y * y2, yz = aRotation.y * z2, zz = aRotation.z * z2;
+            const T wx = aRotation.w * x2, wy = aRotation.w * y2, wz = aRotation.w * z2;
+            const T one = T::One();
+
+            return FixedMatrix4x4(
+                (one - (yy + zz)) * aScale.x, (xy + wz) * aScale.x, (xz - wy) * aScale.x, T(),
+                (xy - wz) * aScale.y, (one - (xx + zz)) * aScale.y, (yz + wx) * aScale.y, T(),
+                (xz + wy) * aScale.z, (yz - wx) * aScale.z, (one - (xx + yy)) * aScale.z, T(),
+                aTranslation.x, aTranslation.y, aTranslation.z, one);
+        }
+    };
+}
\ No newline at end of file
@@ -0,0 +1,390 @@
+#pragma once
+
+// FixedPoint.h
+// Fixed-point scalars for deterministic simulation. All arithmetic, including sqrt and trig,
+// is done with integer operations, so results are bit identical on every compiler and CPU.
+//
+// Fixed16 is Q16.16: range +-32768, resolution 1.5e-5.
+// Fixed32 is Q32.32: range +-2.1e9, resolution 2.3e-10.
+// Multiplication and division round to nearest. Overflow wraps silently, as with integers.
+
+#include "Common.h"
+
+namespace KhaosMath
+{
+    namespace FixedPointDetail
+    {
+        // Returns aValue * bValue in Q16.16.
+        constexpr KI_32 Multiply(KI_32 aValue, KI_32 bValue) {
+            return static_cast<KI_32>((static_cast<KI_64>(aValue) * bValue + (KI_64(1) << 15)) >> 16);
+        }
+
+        // Returns aValue * bValue in Q32.32, using a 128-bit intermediate built from 32-bit halves.
+        constexpr KI_64 Multiply(KI_64 aValue, KI_64 bValue) {
+            const bool negative = (aValue < 0) != (bValue < 0);
+            const KUI_64 a = aValue < 0 ? 0 - static_cast<KUI_64>(aValue) : static_cast<KUI_64>(aValue);
+            const KUI_64 b = bValue < 0 ? 0 - static_cast<KUI_64>(bValue) : static_cast<KUI_64>(bValue);
+            const KUI_64 mask = 0xffffffffull;
+
+            const KUI_64 lowLow = (a & mask) * (b & mask);
+            const KUI_64 lowHigh = (a & mask) * (b >> 32);
+            const KUI_64 highLow = (a >> 32) * (b & mask);
+            const KUI_64 highHigh = (a >> 32) * (b >> 32);
+
+            // Bits 32 to 95 of the product plus one half for rounding.
+            const KUI_64 rounding = ((lowLow & mask) + 0x80000000ull) >> 32;
+            const KUI_64 middle = (lowLow >> 32) + (lowHigh & mask) + (highLow & mask) + rounding;
+            const KUI_64 high = highHigh + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+            const KUI_64 result = (high << 32) | (middle & mask);
+            return negative ? static_cast<KI_64>(0 - result) : static_cast<KI_64>(result);
+        }
+
+        // Returns aValue / bValue in Q16.16.
+        constexpr KI_32 Divide(KI_32 aValue, KI_32 bValue) {
+            const bool negative = (aValue < 0) != (bValue < 0);
+            const KI_64 a = aValue < 0 ? -static_cast<KI_64>(aValue) : aValue;
+            const KI_64 b = bValue < 0 ? -static_cast<KI_64>(bValue) : bValue;
+            const KI_64 result = (a * 65536 + b / 2) / b;
+            return static_cast<KI_32>(negative ? -result : result);
+        }
+
+        // Returns the number of leading zero bits in aValue.
+        constexpr K_INT CountLeadingZeros(KUI_64 aValue) {
+            if (aValue == 0)
+                return 64;
+            K_INT count = 0;
+            for (K_INT shift = 32; shift > 0; shift >>= 1) {
+                if ((aValue >> (64 - shift)) == 0) {
+                    count += shift;
+                    aValue <<= shift;
+                }
+            }
+            return count;
+        }
+
+        // Returns aValue / bValue in Q32.32 by long division over the fraction bits. Each step
+        // brings down as many bits as fit above the remainder, so divisors below 2^48 need
+        // only two hardware divides, and dividends below one need just one.
+        constexpr KI_64 Divide(KI_64 aValue, KI_64 bValue) {
+            const bool negative = (aValue < 0) != (bValue < 0);
+            const KUI_64 a = aValue < 0 ? 0 - static_cast<KUI_64>(aValue) : static_cast<KUI_64>(aValue);
+            const KUI_64 b = bValue < 0 ? 0 - static_cast<KUI_64>(bValue) : static_cast<KUI_64>(bValue);
+            const K_INT step = CountLeadingZeros(b) > 0 ? CountLeadingZeros(b) : 1;
+
+            // A dividend below one takes all 32 fraction bits in the first divide.
+            const K_INT firstBits = (a >> 32) == 0 ? 32 : 0;
+            const KUI_64 dividend = a << firstBits;
+            KUI_64 quotient = dividend / b;
+            KUI_64 remainder = dividend % b;
+            for (K_INT bits = 32 - firstBits; bits > 0; bits -= step) {
+                const K_INT shift = bits < step ? bits : step;
+                if (shift == 1 && (remainder >> 63) != 0) {
+                    // Only reachable when b needs all 64 bits: the shifted remainder would overflow.
+                    quotient = (quotient << 1) | 1;
+                    remainder = (remainder << 1) - b;
+                    continue;
+                }
+                remainder <<= shift;
+                quotient = (quotient << shift) | (remainder / b);
+                remainder %= b;
+            }
+            if (remainder >= b - remainder)
+                ++quotient;
+            return negative ? static_cast<KI_64>(0 - quotient) : static_cast<KI_64>(quotient);
+        }
+
+        // Returns floor(sqrt(aValue)) with Newton's method. The seed x / 2^k + 2^(k - 2), where
+        // x < 2^(2k), is never below the root and at most 25% above it, so four steps always
+        // land on the root or one past it.
+        constexpr KUI_64 IntegerSquareRoot(KUI_64 aValue) {
+            if (aValue < 4)
+                return aValue == 0 ? 0 : 1;
+            const K_INT halfBits = (65 - CountLeadingZeros(aValue)) / 2;
+            KUI_64 root = (aValue >> halfBits) + (KUI_64(1) << (halfBits - 2));
+            for (K_INT step = 0; step < 4; ++step)
+                root = (root + aValue / root) >> 1;
+            if (root > 0xffffffffull || root * root > aValue)
+                --root;
+            return root;
+        }
+
+        // Returns floor(sqrt(aRaw << aFractionBits)), which is the square root of a non-negative
+        // fixed-point value in the same format. aRaw is shifted up by an even amount, at most
+        // aFractionBits, for the integer square root, and any bits that did not fit are brought
+        // down one pair at a time. Only large Q32.32 values need those extra steps.
+        constexpr KUI_64 SquareRoot(KUI_64 aRaw, K_INT aFractionBits) {
+            const K_INT room = CountLeadingZeros(aRaw) & ~1;
+            const K_INT shift = room < aFractionBits ? room : aFractionBits;
+            const KUI_64 value = aRaw << shift;
+            KUI_64 root = IntegerSquareRoot(value);
+            KUI_64 remainder = value - root * root;
+            for (K_INT pair = (aFractionBits - shift) / 2; pair > 0; --pair) {
+                remainder <<= 2;
+                root <<= 1;
+                const KUI_64 trial = (root << 1) | 1;
+                if (remainder >= trial) {
+                    remainder -= trial;
+                    root |= 1;
+                }
+            }
+            return root;
+        }
+    }
+
+    // Class representing a signed fixed-point number with half of Storage's bits as fraction.
+    template <typename Storage>
+    class FixedPoint
+    {
+    public:
+        static const K_INT FRACTION_BITS = sizeof(Storage) * 4;
+
+        Storage raw;
+
+        // Default constructor will zero the value.
+        constexpr FixedPoint()
+            : raw(0) { }
+
+        // Constructor from an integer.
+        constexpr FixedPoint(K_INT aValue)
+            : raw(static_cast<Storage>(aValue) * (Storage(1) << FRACTION_BITS)) { }
+
+        // Returns a value holding exactly aRaw.
+        static constexpr FixedPoint FromRaw(Storage aRaw) {
+            FixedPoint value;
+            value.raw = aRaw;
+            return value;
+        }
+
+        // Converts from double, rounding to nearest. Intended for compile-time constants.
+        static constexpr FixedPoint FromDouble(double aValue) {
+            return FromRaw(static_cast<Storage>(aValue * static_cast<double>(Storage(1) << FRACTION_BITS) +
+                                                (aValue < 0.0 ? -0.5 : 0.5)));
+        }
+
+        // Converts from float, rounding to nearest. The same float always gives the same value,
+        // so this is safe for loading data, but floats computed at runtime are not deterministic.
+        static constexpr FixedPoint FromFloat(float aValue) {
+            return FromDouble(static_cast<double>(aValue));
+        }
+
+        static constexpr FixedPoint One() { return FromRaw(Storage(1) << FRACTION_BITS); }
+        static constexpr FixedPoint Pi() { return FromDouble(3.14159265358979323846); }
+        static constexpr FixedPoint TwoPi() { return FromDouble(6.28318530717958647692); }
+        static constexpr FixedPoint HalfPi() { return FromDouble(1.57079632679489661923); }
+        static constexpr FixedPoint QuarterPi() { return FromDouble(0.78539816339744830962); }
+
+        // Converts to float for rendering and debugging.
+        constexpr float toFloat() const {
+            return static_cast<float>(static_cast<double>(raw) / static_cast<double>(Storage(1) << FRACTION_BITS));
+        }
+
+        // Converts to double.
+        constexpr double toDouble() const {
+            return static_cast<double>(raw) / static_cast<double>(Storage(1) << FRACTION_BITS);
+        }
+
+        // Returns the largest integer not above this value.
+        constexpr K_INT toInt() const {
+            return static_cast<K_INT>(raw >> FRACTION_BITS);
+        }
+
+        constexpr FixedPoint operator-() const {
+            return FromRaw(-raw);
+        }
+
+        constexpr FixedPoint operator+(const FixedPoint& other) const {
+            return FromRaw(raw + other.raw);
+        }
+
+        constexpr FixedPoint operator-(const FixedPoint& other) const {
+            return FromRaw(raw - other.raw);
+        }
+
+        constexpr FixedPoint operator*(const FixedPoint& other) const {
+            return FromRaw(FixedPointDetail::Multiply(raw, other.raw));
+        }
+
+        constexpr FixedPoint operator/(const FixedPoint& other) const {
+            return FromRaw(FixedPointDetail::Divide(raw, other.raw));
+        }
+
+        // Multiplying by an integer is exact and needs no wide intermediate.
+        constexpr FixedPoint operator*(K_INT aValue) const {
+            return FromRaw(raw * aValue);
+        }
+
+        // Dividing by an integer truncates towards zero.
+        constexpr FixedPoint operator/(K_INT aValue) const {
+            return FromRaw(raw / aValue);
+        }
+
+        constexpr FixedPoint& operator+=(const FixedPoint& other) {
+            raw += other.raw;
+            return *this;
+        }
+
+        constexpr FixedPoint& operator-=(const FixedPoint& other) {
+            raw -= other.raw;
+            return *this;
+        }
+
+        constexpr FixedPoint& operator*=(const FixedPoint& other) {
+            raw = FixedPointDetail::Multiply(raw, other.raw);
+            return *this;
+        }
+
+        constexpr FixedPoint& operator/=(const FixedPoint& other) {
+            raw = FixedPointDetail::Divide(raw, other.raw);
+            return *this;
+        }
+
+        constexpr bool operator==(const FixedPoint& other) const { return raw == other.raw; }
+        constexpr bool operator!=(const FixedPoint& other) const { return raw != other.raw; }
+        constexpr bool operator<(const FixedPoint& other) const { return raw < other.raw; }
+        constexpr bool operator<=(const FixedPoint& other) const { return raw <= other.raw; }
+        constexpr bool operator>(const FixedPoint& other) const { return raw > other.raw; }
+        constexpr bool operator>=(const FixedPoint& other) const { return raw >= other.raw; }
+    };
+
+    typedef FixedPoint<KI_32> Fixed16;
+    typedef FixedPoint<KI_64> Fixed32;
+
+    //
+    // Fixed-point function definitions.
+    //
+
+    // Returns the absolute value.
+    template <typename Storage>
+    constexpr FixedPoint<Storage> Abs(FixedPoint<Storage> aValue) {
+        return aValue.raw < 0 ? -aValue : aValue;
+    }
+
+    // Clamp a value between minValue and maxValue, inclusive.
+    template <typename Storage>
+    constexpr FixedPoint<Storage> ClampInclusive(FixedPoint<Storage> aValue, FixedPoint<Storage> minValue,
+                                                 FixedPoint<Storage> maxValue) {
+        if (aValue < minValue)
+            return minValue;
+        if (aValue > maxValue)
+            return maxValue;
+        return aValue;
+    }
+
+    // Returns the square root, rounded down. Negative inputs return zero.
+    template <typename Storage>
+    constexpr FixedPoint<Storage> Sqrt(FixedPoint<Storage> aValue) {
+        if (aValue.raw <= 0)
+            return FixedPoint<Storage>();
+        return FixedPoint<Storage>::FromRaw(static_cast<Storage>(FixedPointDetail::SquareRoot(
+            static_cast<KUI_64>(aValue.raw), FixedPoint<Storage>::FRACTION_BITS)));
+    }
+
+    namespace FixedPointDetail
+    {
+        // Sine on [0, pi/4] from its Taylor series through x^11, evaluated in Horner form.
+        template <typename Storage>
+        constexpr FixedPoint<Storage> SinPolynomial(FixedPoint<Storage> x) {
+            const FixedPoint<Storage> one = FixedPoint<Storage>::One();
+            const FixedPoint<Storage> xSquared = x * x;
+            FixedPoint<Storage> sum = one - xSquared / 110;
+            sum = one - xSquared * sum / 72;
+            sum = one - xSquared * sum / 42;
+            sum = one - xSquared * sum / 20;
+            sum = one - xSquared * sum / 6;
+            return x * sum;
+        }
+
+        // Cosine on [0, pi/4] from its Taylor series through x^12.
+        template <typename Storage>
+        constexpr FixedPoint<Storage> CosPolynomial(FixedPoint<Storage> x) {
+            const FixedPoint<Storage> one = FixedPoint<Storage>::One();
+            const FixedPoint<Storage> xSquared = x * x;
+            FixedPoint<Storage> sum = one - xSquared / 132;
+            sum = one - xSquared * sum / 90;
+            sum = one - xSquared * sum / 56;
+            sum = one - xSquared * sum / 30;
+            sum = one - xSquared * sum / 12;
+            return one - xSquared * sum / 2;
+        }
+
+        // Arctangent for |x| <= tan(pi/8) from its Taylor series through x^21.
+        template <typename Storage>
+        constexpr FixedPoint<Storage> AtanPolynomial(FixedPoint<Storage> x) {
+            const FixedPoint<Storage> one = FixedPoint<Storage>::One();
+            const FixedPoint<Storage> xSquared = x * x;
+            FixedPoint<Storage> sum = one / 21;
+            for (K_INT denominator = 19; denominator >= 1; denominator -= 2)
+                sum = one / denominator - xSquared * sum;
+            return x * sum;
+        }
+
+        // Arctangent for |x| <= 1.
+        template <typename Storage>
+        constexpr FixedPoint<Storage> AtanUnit(FixedPoint<Storage> x) {
+            typedef FixedPoint<Storage> Fixed;
+            const bool negative = x.raw < 0;
+            x = Abs(x);
+
+            // Past tan(pi/8), use atan(x) = pi/4 + atan((x - 1) / (x + 1)) to stay in the fast region.
+            Fixed result = x > Fixed::FromDouble(0.41421356237309504880)
+                ? Fixed::QuarterPi() + AtanPolynomial((x - Fixed::One()) / (x + Fixed::One()))
+                : AtanPolynomial(x);
+            return negative ? -result : result;
+        }
+    }
+
+    // Returns the sine of an angle in radians.
+    template <typename Storage>
+    constexpr FixedPoint<Storage> Sin(FixedPoint<Storage> anAngle) {
+        typedef FixedPoint<Storage> Fixed;
+
+        // Reduce to [-pi, pi], then fold onto [0, pi/2] using symmetry.
+        Storage x = anAngle.raw % Fixed::TwoPi().raw;
+        if (x > Fixed::Pi().raw)
+            x -= Fixed::TwoPi().raw;
+        else if (x < -Fixed::Pi().raw)
+            x += Fixed::TwoPi().raw;
+        const bool negative = x < 0;
+        if (negative)
+            x = -x;
+        if (x > Fixed::HalfPi().raw)
+            x = Fixed::Pi().raw - x;
+
+        const Fixed result = x > Fixed::QuarterPi().raw
+            ? FixedPointDetail::CosPolynomial(Fixed::HalfPi() - Fixed::FromRaw(x))
+            : FixedPointDetail::SinPolynomial(Fixed::FromRaw(x));
+        return negative ? -result : result;
+    }
+
+    // Returns the cosine of an angle in radians.
+    template <typename Storage>
+    constexpr FixedPoint<Storage> Cos(FixedPoint<Storage> anAngle) {
+        typedef FixedPoint<Storage> Fixed;
+        return Sin(Fixed::FromRaw(anAngle.raw % Fixed::TwoPi().raw) + Fixed::HalfPi());
+    }
+
+    // Returns the angle of the vector (aX, aY) in [-pi, pi].
+    template <typename Storage>
+    constexpr FixedPoint<Storage> Atan2(FixedPoint<Storage> aY, FixedPoint<Storage> aX) {
+        typedef FixedPoint<Storage> Fixed;
+        if (aX.raw == 0 && aY.raw == 0)
+            return Fixed();
+
+        // Divide the smaller component by the larger so the quotient stays within [-1, 1].
+        if (Abs(aX) >= Abs(aY)) {
+            const Fixed angle = FixedPointDetail::AtanUnit(aY / aX);
+            if (aX.raw > 0)
+                return angle;
+            return aY.raw >= 0 ? angle + Fixed::Pi() : angle - Fixed::Pi();
+        }
+        return (aY.raw > 0 ? Fixed::HalfPi() : -Fixed::HalfPi()) - FixedPointDetail::AtanUnit(aX / aY);
+    }
+
+    // Returns the arccosine in [0, pi]. Inputs are clamped to [-1, 1].
+    template <typename Storage>
+    constexpr FixedPoint<Storage> Acos(FixedPoint<Storage> aValue) {
+        typedef FixedPoint<Storage> Fixed;
+        aValue = ClampInclusive(aValue, -Fixed::One(), Fixed::One());
+        return Atan2(Sqrt((Fixed::One() - aValue) * (Fixed::One() + aValue)), aValue);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,184 @@
+#pragma once
+
+// FixedQuaternion.h
+// Quaternion over a fixed-point scalar, mirroring Quaternion.
+
+#include "Common.h"
+#include "FixedPoint.h"
+#include "FixedVector3.h"
+#include "Quaternion.h"
+
+namespace KhaosMath
+{
+    // Class representing a Quaternion defined as 4 fixed-point numbers.
+    template <typename T>
+    class FixedQuaternion
+    {
+    public:
+        T x, y, z, w;
+
+        // Default constructor will zero all elements.
+        constexpr FixedQuaternion()
+            : x(), y(), z(), w() { }
+
+        // Constructor to explicitly initialize all elements.
+        constexpr FixedQuaternion(T aX, T aY, T aZ, T aW)
+            : x(aX), y(aY), z(aZ), w(aW) { }
+
+        // Constructor from a vector part and a scalar part.
+        constexpr FixedQuaternion(const FixedVector3<T>& aVector, T aW)
+            : x(aVector.x), y(aVector.y), z(aVector.z), w(aW) { }
+
+        // Returns the identity rotation.
+        static constexpr FixedQuaternion Identity() {
+            return FixedQuaternion(T(), T(), T(), T::One());
+        }
+
+        // Returns the rotation of anAngle radians about a unit axis.
+        static constexpr FixedQuaternion AxisAngle(const FixedVector3<T>& anAxis, T anAngle) {
+            return FixedQuaternion(anAxis * Sin(anAngle / 2), Cos(anAngle / 2));
+        }
+
+        // Converts from a float quaternion, rounding each component to nearest.
+        static constexpr FixedQuaternion FromQuaternion(const Quaternion& aQuat) {
+            return FixedQuaternion(T::FromFloat(aQuat.x), T::FromFloat(aQuat.y),
+                                   T::FromFloat(aQuat.z), T::FromFloat(aQuat.w));
+        }
+
+        // Converts to a float quaternion for rendering.
+        constexpr Quaternion toQuaternion() const {
+            return Quaternion(x.toFloat(), y.toFloat(), z.toFloat(), w.toFloat());
+        }
+
+        // Add each element together to create a new quaternion.
+        constexpr FixedQuaternion operator+(const FixedQuaternion& other) const {
+            return FixedQuaternion(x + other.x, y + other.y, z + other.z, w + other.w);
+        }
+
+        // Subtract each element to create a new quaternion.
+        constexpr FixedQuaternion operator-(const FixedQuaternion& other) const {
+            return FixedQuaternion(x - other.x, y - other.y, z - other.z, w - other.w);
+        }
+
+        // Multiply each element by a scalar.
+        constexpr FixedQuaternion operator*(const T aScalar) const {
+            return FixedQuaternion(x * aScalar, y * aScalar, z * aScalar, w * aScalar);
+        }
+
+        // Divide each element by a scalar.
+        constexpr FixedQuaternion operator/(const T aScalar) const {
+            return FixedQuaternion(x / aScalar, y / aScalar, z / aScalar, w / aScalar);
+        }
+
+        // Returns the Grassman product between this quaternion and another.
+        constexpr FixedQuaternion operator*(const FixedQuaternion& other) const {
+            const FixedVector3<T> vectorA = getVectorPart();
+            const FixedVector3<T> vectorB = other.getVectorPart();
+            return FixedQuaternion(vectorB * w + vectorA * other.w + vectorA.crossProduct(vectorB),
+                                   w * other.w - vectorA.dot(vectorB));
+        }
+
+        // Quaternions are equal only when every element is bit identical.
+        constexpr bool operator==(const FixedQuaternion& other) const {
+            return x == other.x && y == other.y && z == other.z && w == other.w;
+        }
+
+        constexpr bool operator!=(const FixedQuaternion& other) const {
+            return !(*this == other);
+        }
+
+        // Returns the dot product of this quaternion and another.
+        constexpr T dot(const FixedQuaternion& other) const {
+            return x * other.x + y * other.y + z * other.z + w * other.w;
+        }
+
+        // Returns the dot product between two quaternions.
+        static constexpr T DotProduct(const FixedQuaternion& aQuat, const FixedQuaternion& bQuat) {
+            return aQuat.dot(bQuat);
+        }
+
+        // Get the magnitude of this quaternion.
+        constexpr T getMagnitude() const {
+            return Sqrt(getMagnitudeSquared());
+        }
+
+        // Get the magnitude squared of this quaternion, which does not use a sqrt operation.
+        constexpr T getMagnitudeSquared() const {
+            return dot(*this);
+        }
+
+        // Returns a unit length version of this quaternion.
+        constexpr FixedQuaternion getNormalized() const {
+            return (*this) * (T::One() / getMagnitude());
+        }
+
+        // Returns this nearly unit quaternion pulled back to unit length by one Newton step on
+        // 1 / sqrt(m), which needs neither Sqrt nor a divide. The length error squares on every
+        // call, so use this instead of getNormalized after each incremental rotation.
+        constexpr FixedQuaternion getRenormalized() const {
+            return (*this) * ((T(3) - getMagnitudeSquared()) / 2);
+        }
+
+        // Returns the x, y, z components as a vector.
+        constexpr FixedVector3<T> getVectorPart() const {
+            return FixedVector3<T>(x, y, z);
+        }
+
+        // Returns the conjugate of this quaternion.
+        constexpr FixedQuaternion getConjugate() const {
+            return FixedQuaternion(-x, -y, -z, w);
+        }
+
+        // Returns the inverse of this unit quaternion.
+        constexpr FixedQuaternion getUnitInverse() const {
+            return getConjugate();
+        }
+
+        // Rotates a vector by this unit quaternion.
+        constexpr FixedVector3<T> rotate(const FixedVector3<T>& aVector) const {
+            const FixedVector3<T> axis = getVectorPart();
+            const FixedVector3<T> twice = axis.crossProduct(aVector) * 2;
+            return aVector + twice * w + axis.crossProduct(twice);
+        }
+
+        // Spherical Linear Interpolation between two quaternions.
+        // Beta will be clamped between [0,1] inclusive.
+        constexpr FixedQuaternion slerpWith(const FixedQuaternion& other, T beta) const {
+            return SlerpNoClamp(*this, other, ClampInclusive(beta, T(), T::One()));
+        }
+
+        // Spherical Linear Interpolation between two quaternions.
+        // Beta will be clamped between [0,1] inclusive.
+        static constexpr FixedQuaternion Slerp(const FixedQuaternion& aQuat, const FixedQuaternion& bQuat, T beta) {
+            return SlerpNoClamp(aQuat, bQuat, ClampInclusive(beta, T(), T::One()));
+        }
+
+        // Spherical Linear Interpolation between two quaternions.
+        // Beta must be clamped between [0,1], inclusive, before calling to ensure correct result.
+        constexpr FixedQuaternion slerpNoClampWith(const FixedQuaternion& other, T beta) const {
+            return SlerpNoClamp(*this, other, beta);
+        }
+
+        // Spherical Linear Interpolation between two quaternions along the shorter arc.
+        // Beta must be clamped between [0,1], inclusive, before calling to ensure correct result.
+        // Nearly parallel rotations fall back to a normalized lerp, where sin(theta) is too
+        // small to divide by at fixed precision.
+        static constexpr FixedQuaternion SlerpNoClamp(const FixedQuaternion& aQuat,
+                                                      const FixedQuaternion& bQuat, T beta) {
+            // q and -q are the same rotation, so b is flipped onto a's side of the sphere.
+            const T dot = aQuat.dot(bQuat);
+            const T cosTheta = dot < T() ? -dot : dot;
+            const FixedQuaternion target = dot < T() ? bQuat * -T::One() : bQuat;
+            if (cosTheta <= T::FromDouble(0.9995)) {
+                const T theta = Acos(cosTheta);
+                const T sinTheta = Sin(theta);
+                if (sinTheta != T()) {
+                    const T omegaFirst = Sin((T::One() - beta) * theta) / sinTheta;
+                    const T omegaSecond = Sin(beta * theta) / sinTheta;
+                    return (aQuat * omegaFirst) + (target * omegaSecond);
+                }
+            }
+            return (aQuat + (target - aQuat) * beta).getNormalized();
+        }
+    };
+}
\ No newline at end of file
@@ -0,0 +1,180 @@
+#pragma once
+
+// FixedVector3.h
+// Three component vector over a fixed-point scalar, mirroring Vector3f.
+// Squared magnitudes and dot products must fit the scalar's range: keep Fixed16
+// components below 181 in magnitude for those, or use Fixed32.
+
+#include "Common.h"
+#include "FixedPoint.h"
+#include "Vector3f.h"
+
+namespace KhaosMath
+{
+    // Class representing a vector of 3 fixed-point numbers.
+    template <typename T>
+    class FixedVector3
+    {
+    public:
+        T x, y, z;
+
+        // Default constructor will zero all elements.
+        constexpr FixedVector3()
+            : x(), y(), z() { }
+
+        // Constructor to explicitly initialize all elements.
+        constexpr FixedVector3(T aX, T aY, T aZ)
+            : x(aX), y(aY), z(aZ) { }
+
+        // Converts from a float vector, rounding each component to nearest.
+        static constexpr FixedVector3 FromVector3f(const Vector3f& aVector) {
+            return FixedVector3(T::FromFloat(aVector.x), T::FromFloat(aVector.y), T::FromFloat(aVector.z));
+        }
+
+        // Converts to a float vector for rendering.
+        constexpr Vector3f toVector3f() const {
+            return Vector3f(x.toFloat(), y.toFloat(), z.toFloat());
+        }
+
+        constexpr FixedVector3 operator-() const {
+            return FixedVector3(-x, -y, -z);
+        }
+
+        // Add two vectors together to create a new one.
+        constexpr FixedVector3 operator+(const FixedVector3& other) const {
+            return FixedVector3(x + other.x, y + other.y, z + other.z);
+        }
+
+        // Subtract a vector from another to create a new one.
+        constexpr FixedVector3 operator-(const FixedVector3& other) const {
+            return FixedVector3(x - other.x, y - other.y, z - other.z);
+        }
+
+        // Multiply each element by a scalar.
+        constexpr FixedVector3 operator*(const T aScalar) const {
+            return FixedVector3(x * aScalar, y * aScalar, z * aScalar);
+        }
+
+        // Divide each element by a scalar.
+        constexpr FixedVector3 operator/(const T aScalar) const {
+            return FixedVector3(x / aScalar, y / aScalar, z / aScalar);
+        }
+
+        // Modify this vector by adding each element.
+        constexpr FixedVector3& operator+=(const FixedVector3& other) {
+            x += other.x;
+            y += other.y;
+            z += other.z;
+            return *this;
+        }
+
+        // Modify this vector by subtracting each element.
+        constexpr FixedVector3& operator-=(const FixedVector3& other) {
+            x -= other.x;
+            y -= other.y;
+            z -= other.z;
+            return *this;
+        }
+
+        // Modify this vector by multiplying each element by a scalar.
+        constexpr FixedVector3& operator*=(const T aScalar) {
+            x *= aScalar;
+            y *= aScalar;
+            z *= aScalar;
+            return *this;
+        }
+
+        // Modify this vector by dividing each element by a scalar.
+        constexpr FixedVector3& operator/=(const T aScalar) {
+            x /= aScalar;
+            y /= aScalar;
+            z /= aScalar;
+            return *this;
+        }
+
+        // Vectors are equal only when every element is bit identical.
+        constexpr bool operator==(const FixedVector3& other) const {
+            return x == other.x && y == other.y && z == other.z;
+        }
+
+        constexpr bool operator!=(const FixedVector3& other) const {
+            return !(*this == other);
+        }
+
+        // Get the magnitude of this vector.
+        constexpr T getMagnitude() const {
+            return Sqrt(getMagnitudeSquared());
+        }
+
+        // Get the magnitude squared of this vector, which does not use a sqrt operation.
+        constexpr T getMagnitudeSquared() const {
+            return x * x + y * y + z * z;
+        }
+
+        // Returns the dot product of this vector and another vector.
+        constexpr T dot(const FixedVector3& other) const {
+            return x * other.x + y * other.y + z * other.z;
+        }
+
+        constexpr T operator|(const FixedVector3& other) const {
+            return dot(other);
+        }
+
+        // Returns the dot product between two vectors.
+        static constexpr T DotProduct(const FixedVector3& aVector, const FixedVector3& bVector) {
+            return aVector.dot(bVector);
+        }
+
+        // Returns the cross product between this and another vector.
+        constexpr FixedVector3 crossProduct(const FixedVector3& other) const {
+            return FixedVector3(y * other.z - z * other.y,
+                                z * other.x - x * other.z,
+                                x * other.y - y * other.x);
+        }
+
+        // Returns the cross product between two vectors.
+        static constexpr FixedVector3 CrossProduct(const FixedVector3& aVector, const FixedVector3& bVector) {
+            return aVector.crossProduct(bVector);
+        }
+
+        // Linear Interpolation between this vector and another.
+        // Beta will be clamped between [0,1] inclusive.
+        constexpr FixedVector3 lerpWith(const FixedVector3& other, T beta) const {
+            return lerpNoClampWith(other, ClampInclusive(beta, T(), T::One()));
+        }
+
+        // Linear Interpolation between this vector and another.
+        // Beta must be clamped between [0,1], inclusive, before calling to ensure correct result.
+        constexpr FixedVector3 lerpNoClampWith(const FixedVector3& other, T beta) const {
+            return (*this) + (other - (*this)) * beta;
+        }
+
+        // Linear Interpolation between two vectors.
+        // Beta will be clamped between [0,1] inclusive.
+        static constexpr FixedVector3 Lerp(const FixedVector3& aVector, const FixedVector3& bVector, T beta) {
+            return aVector.lerpWith(bVector, beta);
+        }
+
+        // Linear Interpolation between two vectors.
+        // Beta must be clamped between [0,1], inclusive, before calling to ensure correct result.
+        static constexpr FixedVector3 LerpNoClamp(const FixedVector3& aVector, const FixedVector3& bVector, T beta) {
+            return aVector.lerpNoClampWith(bVector, beta);
+        }
+
+        // Changes this vector into the normalized version of itself.
+        constexpr void setToNormalized() {
+            (*this) = getNormalized();
+        }
+
+        // Returns a normalized version of this vector. Does not change the original vector.
+        // Divides once and multiplies each element by the reciprocal.
+        constexpr FixedVector3 getNormalized() const {
+            return (*this) * (T::One() / getMagnitude());
+        }
+
+        // Returns a normalized vector. Does not change the original vector.
+        static constexpr FixedVector3 Normalized(const FixedVector3& aVector) {
+            return aVector.getNormalized();
+        }
+    };
+}
\ No newline at end of file
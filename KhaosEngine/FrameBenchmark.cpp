@@ -0,0 +1,585 @@
+// FrameBenchmark.cpp
+// Headless whole frame benchmark. Drives a synthetic scene through GameLoop::run, the same
+// loop a game uses, rendering with SDL's software renderer into a memory surface, or into a
+// window of a headless video driver such as "dummy" or "offscreen", so it runs on machines
+// without a display or GPU. Frame, step and stage times are reported as percentiles along
+// with heap allocations, on the console and as JSON for tracking results over time:
+//
+//     KhaosBenchmark --objects 20000 --sprites 4000 --particles 100000 --json frame.json
+
+#include <SDL.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "EntityStore.h"
+#include "GameLoop.h"
+#include "Memory.h"
+#include "Profiler.h"
+#include "RenderCommands.h"
+
+using namespace KhaosEngine;
+using KhaosMath::Matrix4x4f;
+using KhaosMath::Vector4f;
+using KhaosMath::PI;
+
+namespace
+{
+    const float TIME_STEP = 1.0f / 60.0f;
+    const K_UINT MAX_STEPS_PER_FRAME = 4;
+    const K_INT SPRITE_SIZE = 24;
+    const K_INT PARTICLE_SIZE = 2;
+
+    // Stages before STAGE_RECORD run once per simulation step on the simulation thread, the
+    // rest once per frame on the thread that called GameLoop::run. Interpolation happens
+    // inside GameLoop::run and only shows in the frame time.
+    enum Stage
+    {
+        STAGE_SIMULATE,
+        STAGE_PARTICLES,
+        STAGE_TRANSFORMS,
+        STAGE_RECORD,
+        STAGE_SORT,
+        STAGE_REPLAY,
+        STAGE_COUNT
+    };
+
+    const char* const STAGE_NAMES[STAGE_COUNT] = { "simulate", "particles", "transforms", "record", "sort", "replay" };
+
+    bool isStepStage(K_UINT aStage) {
+        return aStage < STAGE_RECORD;
+    }
+
+    struct BenchmarkSettings
+    {
+        K_UINT objectCount; // Simulated entities, each with a world transform.
+        K_UINT spriteCount; // How many of the objects are drawn.
+        K_UINT particleCount;
+        K_UINT width;
+        K_UINT height;
+        K_UINT frameCount;
+        K_UINT warmupFrameCount; // Run first and left out of the results.
+        std::string videoDriver; // Empty to render into a memory surface.
+        std::string jsonPath;
+        std::string tracePath;
+    };
+
+    // Object components.
+    struct Motion
+    {
+        Vector3f velocity;
+        float spin; // Radians per second about the view axis.
+    };
+
+    struct WorldTransform
+    {
+        Matrix4x4f matrix;
+    };
+
+    struct Particles
+    {
+        std::vector<Vector3f> positions;
+        std::vector<Vector3f> velocities;
+        std::vector<float> ages;
+    };
+
+    struct Percentiles
+    {
+        double mean, p50, p90, p99, max;
+    };
+
+    Percentiles computePercentiles(std::vector<double> someTimes) {
+        Percentiles result = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+        if (someTimes.empty())
+            return result;
+        std::sort(someTimes.begin(), someTimes.end());
+        for (double time : someTimes)
+            result.mean += time;
+        result.mean /= someTimes.size();
+        const size_t last = someTimes.size() - 1;
+        result.p50 = someTimes[last * 50 / 100];
+        result.p90 = someTimes[last * 90 / 100];
+        result.p99 = someTimes[last * 99 / 100];
+        result.max = someTimes[last];
+        return result;
+    }
+
+    void writePercentiles(std::ostream& aStream, const Percentiles& somePercentiles) {
+        aStream << "\"meanMs\":" << somePercentiles.mean << ",\"p50Ms\":" << somePercentiles.p50
+                << ",\"p90Ms\":" << somePercentiles.p90 << ",\"p99Ms\":" << somePercentiles.p99
+                << ",\"maxMs\":" << somePercentiles.max;
+    }
+
+    // Row vector rotation and translation, matching Vector4f * Matrix4x4f.
+    Matrix4x4f makeTransform(const Quaternion& aRotation, const Vector3f& aPosition) {
+        const float x = aRotation.x, y = aRotation.y, z = aRotation.z, w = aRotation.w;
+        return Matrix4x4f(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + w * z), 2.0f * (x * z - w * y), 0.0f,
+                          2.0f * (x * y - w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + w * x), 0.0f,
+                          2.0f * (x * z + w * y), 2.0f * (y * z - w * x), 1.0f - 2.0f * (x * x + y * y), 0.0f,
+                          aPosition.x, aPosition.y, aPosition.z, 1.0f);
+    }
+
+    // The camera pans across a world twice the screen width, so it depends only on the step
+    // and both threads can build it.
+    Matrix4x4f makeView(KUI_64 aStep, K_UINT aWidth) {
+        const float pan = (0.5f - 0.5f * cosf(aStep * TIME_STEP * 0.25f)) * aWidth;
+        return Matrix4x4f(1.0f, 0.0f, 0.0f, 0.0f,
+                          0.0f, 1.0f, 0.0f, 0.0f,
+                          0.0f, 0.0f, 1.0f, 0.0f,
+                          -pan, 0.0f, 0.0f, 1.0f);
+    }
+
+    // Appends to a sample buffer reserved up front, so measured frames stay allocation free.
+    void addSample(std::vector<double>& someSamples, double aSample) {
+        if (someSamples.size() < someSamples.capacity())
+            someSamples.push_back(aSample);
+    }
+
+    bool parseArguments(int argc, char** argv, BenchmarkSettings& someSettings) {
+        for (int i = 1; i < argc; i += 2) {
+            if (i + 1 >= argc)
+                return false;
+            const std::string name = argv[i];
+            const char* value = argv[i + 1];
+            const K_UINT number = static_cast<K_UINT>(strtoul(value, nullptr, 10));
+            if (name == "--objects")
+                someSettings.objectCount = number;
+            else if (name == "--sprites")
+                someSettings.spriteCount = number;
+            else if (name == "--particles")
+                someSettings.particleCount = number;
+            else if (name == "--width")
+                someSettings.width = number;
+            else if (name == "--height")
+                someSettings.height = number;
+            else if (name == "--frames")
+                someSettings.frameCount = number;
+            else if (name == "--warmup")
+                someSettings.warmupFrameCount = number;
+            else if (name == "--video-driver")
+                someSettings.videoDriver = value;
+            else if (name == "--json")
+                someSettings.jsonPath = value;
+            else if (name == "--trace")
+                someSettings.tracePath = value;
+            else
+                return false;
+        }
+        someSettings.spriteCount = std::min(someSettings.spriteCount, someSettings.objectCount);
+        return someSettings.width > 0 && someSettings.height > 0 && someSettings.frameCount > 0;
+    }
+
+    void printUsage() {
+        std::cout << "Usage: KhaosBenchmark [--objects N] [--sprites N] [--particles N] [--width N] [--height N]\n"
+                     "                      [--frames N] [--warmup N] [--video-driver NAME] [--json FILE] [--trace FILE]\n"
+                     "Renders into a memory surface unless a video driver such as dummy or offscreen is named."
+                  << std::endl;
+    }
+
+    // Opaque texture with a lighter border, so sprites cost what real ones do to draw.
+    SDL_Texture* createSpriteTexture(SDL_Renderer* aRenderer) {
+        const K_INT size = 32;
+        SDL_Texture* texture = SDL_CreateTexture(aRenderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STATIC, size, size);
+        if (!texture)
+            return nullptr;
+        std::vector<KUI_32> pixels(size * size);
+        for (K_INT y = 0; y < size; ++y) {
+            for (K_INT x = 0; x < size; ++x) {
+                const bool border = x < 2 || y < 2 || x >= size - 2 || y >= size - 2;
+                pixels[y * size + x] = border ? 0xF0E0C0FFu : 0x4080C0FFu;
+            }
+        }
+        SDL_UpdateTexture(texture, nullptr, pixels.data(), size * sizeof(KUI_32));
+        return texture;
+    }
+
+    // The synthetic scene as a game loop client. The loop simulates on its own thread while
+    // this one renders, and the client stops it once the warmup and measured frames are drawn.
+    class FrameBenchmark : public GameLoopClient
+    {
+    public:
+        FrameBenchmark(const BenchmarkSettings& someSettings, GameLoop& aLoop, SDL_Renderer* aRenderer,
+                       SDL_Texture* aTexture)
+            : mSettings(someSettings), mLoop(aLoop), mRenderer(aRenderer), mTexture(aTexture),
+              mCommands(3, std::max(someSettings.spriteCount, someSettings.particleCount) + 1), mGenerator(2024),
+              mStep(0), mMeasuring(false), mRenderedFrames(0), mLastAllocations(0), mAllocationCount(0), mMaxFrameAllocations(0),
+              mCommandCount(0) {
+            std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+            const float width = static_cast<float>(mSettings.width);
+            const float height = static_cast<float>(mSettings.height);
+            for (K_UINT i = 0; i < mSettings.objectCount; ++i) {
+                // Spread over a world twice the screen width, so the panning camera culls some.
+                const Vector3f position(unit(mGenerator) * 2.0f * width, unit(mGenerator) * height, unit(mGenerator));
+                const float angle = unit(mGenerator) * 2.0f * PI;
+                const float speed = 40.0f + 160.0f * unit(mGenerator);
+                const Motion motion = { Vector3f(cosf(angle) * speed, sinf(angle) * speed, 0.0f), unit(mGenerator) * 4.0f - 2.0f };
+                mObjects.create(position, Quaternion(0.0f, 0.0f, 0.0f, 1.0f), motion, WorldTransform());
+            }
+
+            mParticles.positions.resize(mSettings.particleCount);
+            mParticles.velocities.resize(mSettings.particleCount);
+            mParticles.ages.resize(mSettings.particleCount);
+            for (K_UINT i = 0; i < mSettings.particleCount; ++i) {
+                respawnParticle(i);
+                mParticles.ages[i] = unit(mGenerator) * 2.0f;
+            }
+
+            // A slow frame runs up to MAX_STEPS_PER_FRAME steps, plus the frame in flight when
+            // the loop stops.
+            mFrameTimes.reserve(mSettings.frameCount);
+            for (K_UINT stage = 0; stage < STAGE_COUNT; ++stage) {
+                const K_UINT samples = isStepStage(stage) ? (mSettings.frameCount + 2) * MAX_STEPS_PER_FRAME : mSettings.frameCount;
+                mStageTimes[stage].reserve(samples);
+            }
+        }
+
+        // Simulation thread.
+        void simulate(float aTimeStep) override {
+            const bool measuring = mMeasuring.load(std::memory_order_acquire);
+            Clock::time_point start = Clock::now();
+            const auto finishStage = [this, measuring, &start](Stage aStage) {
+                const Clock::time_point end = Clock::now();
+                if (measuring)
+                    addSample(mStageTimes[aStage], std::chrono::duration<double, std::milli>(end - start).count());
+                start = end;
+            };
+
+            moveObjects(aTimeStep);
+            finishStage(STAGE_SIMULATE);
+            updateParticles(aTimeStep);
+            finishStage(STAGE_PARTICLES);
+            ++mStep;
+            updateTransforms();
+            finishStage(STAGE_TRANSFORMS);
+        }
+
+        // Simulation thread. Sprites come first, then particles with their age in z, since
+        // only the frame state crosses over to the rendering thread. A respawned particle
+        // blends across the screen for one frame, as a game would have to handle.
+        void capture(FrameState& aState) override {
+            const K_UINT spriteCount = mSettings.spriteCount;
+            aState.positions.resize(spriteCount + mSettings.particleCount);
+            aState.rotations.resize(spriteCount);
+            K_UINT index = 0;
+            mObjects.forEach<Vector3f, Quaternion>([&aState, &index, spriteCount](Vector3f& aPosition, Quaternion& aRotation) {
+                if (index < spriteCount) {
+                    aState.positions[index] = aPosition;
+                    aState.rotations[index] = aRotation;
+                }
+                ++index;
+            });
+            for (K_UINT i = 0; i < mSettings.particleCount; ++i) {
+                const Vector3f& position = mParticles.positions[i];
+                aState.positions[spriteCount + i] = Vector3f(position.x, position.y, mParticles.ages[i]);
+            }
+        }
+
+        // Rendering thread. Frame times and allocations are taken from one render call to the
+        // next, so they cover everything the loop did in between on both threads.
+        void render(const FrameState& aState) override {
+            const K_UINT frame = mRenderedFrames++;
+            const K_UINT lastFrame = mSettings.warmupFrameCount + mSettings.frameCount;
+            if (frame > lastFrame)
+                return; // Published before stop took effect.
+
+            Clock::time_point start = Clock::now();
+            const KUI_64 allocations = GetHeapAllocationCount();
+            const bool measuring = frame > mSettings.warmupFrameCount;
+            if (measuring) {
+                const KUI_64 frameAllocations = allocations - mLastAllocations;
+                mAllocationCount += frameAllocations;
+                mMaxFrameAllocations = std::max(mMaxFrameAllocations, frameAllocations);
+                addSample(mFrameTimes, std::chrono::duration<double, std::milli>(start - mLastFrameStart).count());
+            }
+            else if (frame == mSettings.warmupFrameCount) {
+                mMeasuring.store(true, std::memory_order_release);
+            }
+            mLastFrameStart = start;
+            mLastAllocations = allocations;
+
+            const auto finishStage = [this, measuring, &start](Stage aStage) {
+                const Clock::time_point end = Clock::now();
+                if (measuring)
+                    addSample(mStageTimes[aStage], std::chrono::duration<double, std::milli>(end - start).count());
+                start = end;
+            };
+
+            record(aState);
+            finishStage(STAGE_RECORD);
+            {
+                PROFILE_SCOPE_CATEGORY("Sort", PROFILE_CATEGORY_RENDER);
+                mCommands.sort();
+                mCommandCount = mCommands.getSortedCount();
+            }
+            finishStage(STAGE_SORT);
+            {
+                PROFILE_SCOPE_CATEGORY("Replay", PROFILE_CATEGORY_RENDER);
+                ReplayOnSdl(mCommands, mRenderer);
+                SDL_RenderPresent(mRenderer);
+                mCommands.reset();
+            }
+            finishStage(STAGE_REPLAY);
+
+            if (frame == lastFrame)
+                mLoop.stop();
+        }
+
+        // The results below are read once GameLoop::run has returned.
+        const std::vector<double>& getFrameTimes() const { return mFrameTimes; }
+        const std::vector<double>& getStageTimes(K_UINT aStage) const { return mStageTimes[aStage]; }
+        KUI_64 getAllocationCount() const { return mAllocationCount; }
+        KUI_64 getMaxFrameAllocations() const { return mMaxFrameAllocations; }
+        K_UINT getCommandCount() const { return mCommandCount; }
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        void respawnParticle(K_UINT anIndex) {
+            std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+            // Fountains spaced along the bottom of the screen.
+            const float x = (static_cast<float>(anIndex % 16) + 0.5f) / 16.0f * mSettings.width;
+            mParticles.positions[anIndex] = Vector3f(x, static_cast<float>(mSettings.height), 0.0f);
+            mParticles.velocities[anIndex] = Vector3f((unit(mGenerator) - 0.5f) * 120.0f, -250.0f - 250.0f * unit(mGenerator), 0.0f);
+            mParticles.ages[anIndex] = 0.0f;
+        }
+
+        void moveObjects(float aTimeStep) {
+            PROFILE_SCOPE_CATEGORY("Simulate", PROFILE_CATEGORY_FRAME);
+            const float maxX = 2.0f * mSettings.width;
+            const float maxY = static_cast<float>(mSettings.height);
+            mObjects.forEach<Vector3f, Quaternion, Motion>([maxX, maxY, aTimeStep](Vector3f& aPosition, Quaternion& aRotation,
+                                                                                   Motion& aMotion) {
+                aPosition.addScaled(aMotion.velocity, aTimeStep);
+                if (aPosition.x < 0.0f || aPosition.x > maxX) {
+                    aPosition.x = KhaosMath::ClampInclusive(aPosition.x, 0.0f, maxX);
+                    aMotion.velocity.x = -aMotion.velocity.x;
+                }
+                if (aPosition.y < 0.0f || aPosition.y > maxY) {
+                    aPosition.y = KhaosMath::ClampInclusive(aPosition.y, 0.0f, maxY);
+                    aMotion.velocity.y = -aMotion.velocity.y;
+                }
+                const float halfAngle = 0.5f * aMotion.spin * aTimeStep;
+                const Quaternion spun = aRotation * Quaternion(0.0f, 0.0f, sinf(halfAngle), cosf(halfAngle));
+                aRotation = spun * (1.0f / spun.getMagnitude());
+            });
+        }
+
+        void updateParticles(float aTimeStep) {
+            PROFILE_SCOPE_CATEGORY("Particles", PROFILE_CATEGORY_FRAME);
+            const Vector3f gravity(0.0f, 300.0f, 0.0f);
+            for (K_UINT i = 0; i < mSettings.particleCount; ++i) {
+                mParticles.ages[i] += aTimeStep;
+                if (mParticles.ages[i] > 2.0f) {
+                    respawnParticle(i);
+                    continue;
+                }
+                mParticles.velocities[i].addScaled(gravity, aTimeStep);
+                mParticles.positions[i].addScaled(mParticles.velocities[i], aTimeStep);
+            }
+        }
+
+        // Gives every object its world to screen matrix.
+        void updateTransforms() {
+            PROFILE_SCOPE_CATEGORY("Transforms", PROFILE_CATEGORY_MATH);
+            const Matrix4x4f view = makeView(mStep, mSettings.width);
+            mObjects.forEach<Vector3f, Quaternion, WorldTransform>([&view](Vector3f& aPosition, Quaternion& aRotation,
+                                                                           WorldTransform& aTransform) {
+                aTransform.matrix = makeTransform(aRotation, aPosition) * view;
+            });
+        }
+
+        void record(const FrameState& aState) {
+            PROFILE_SCOPE_CATEGORY("Record", PROFILE_CATEGORY_RENDER);
+            const K_INT width = static_cast<K_INT>(mSettings.width);
+            const K_INT height = static_cast<K_INT>(mSettings.height);
+            const Matrix4x4f view = makeView(aState.step, mSettings.width);
+            RenderCommandList* background = mCommands.acquireList();
+            const RenderColor clearColor = { 16, 16, 24, 255 };
+            background->clear(MakeRenderKey(0, 0, 0), clearColor);
+
+            RenderCommandList* sprites = mCommands.acquireList();
+            for (K_UINT i = 0; i < mSettings.spriteCount; ++i) {
+                const Vector3f& position = aState.positions[i];
+                const Vector4f screen = Vector4f(position.x, position.y, position.z, 1.0f) * view;
+                const RenderRect destination = { static_cast<K_INT>(screen.x) - SPRITE_SIZE / 2,
+                                                 static_cast<K_INT>(screen.y) - SPRITE_SIZE / 2, SPRITE_SIZE, SPRITE_SIZE };
+                if (destination.x + SPRITE_SIZE < 0 || destination.x >= width || destination.y + SPRITE_SIZE < 0 ||
+                    destination.y >= height)
+                    continue;
+                const Quaternion& rotation = aState.rotations[i];
+                const float degrees = 2.0f * atan2f(rotation.z, rotation.w) * 180.0f / PI;
+                const KUI_32 depth = static_cast<KUI_32>(KhaosMath::ClampInclusive(screen.z, 0.0f, 1.0f) * 0xFFFFFF);
+                sprites->drawTexture(MakeRenderKey(1, depth, 0), mTexture, nullptr, destination, degrees);
+            }
+
+            RenderCommandList* particles = mCommands.acquireList();
+            for (K_UINT i = 0; i < mSettings.particleCount; ++i) {
+                const Vector3f& position = aState.positions[mSettings.spriteCount + i];
+                const RenderRect destination = { static_cast<K_INT>(position.x), static_cast<K_INT>(position.y),
+                                                 PARTICLE_SIZE, PARTICLE_SIZE };
+                if (destination.x < 0 || destination.x >= width || destination.y < 0 || destination.y >= height)
+                    continue;
+                // Fade from yellow to red over the particle's life.
+                const KUI_8 green = static_cast<KUI_8>(255.0f - 120.0f * KhaosMath::ClampInclusive(position.z, 0.0f, 2.0f));
+                const RenderColor color = { 255, green, 64, 255 };
+                particles->fillRect(MakeRenderKey(2, 0, green), destination, color);
+            }
+        }
+
+        BenchmarkSettings mSettings;
+        GameLoop& mLoop;
+        SDL_Renderer* mRenderer;
+        SDL_Texture* mTexture;
+        RenderCommandBuffer mCommands;
+
+        // Simulation thread state.
+        EntityStore mObjects;
+        Particles mParticles;
+        std::mt19937 mGenerator;
+        KUI_64 mStep;
+
+        // Set by the rendering thread once warmup is over, after which both threads record.
+        std::atomic<bool> mMeasuring;
+        std::vector<double> mStageTimes[STAGE_COUNT];
+
+        // Rendering thread state.
+        K_UINT mRenderedFrames;
+        Clock::time_point mLastFrameStart;
+        KUI_64 mLastAllocations;
+        std::vector<double> mFrameTimes;
+        KUI_64 mAllocationCount;
+        KUI_64 mMaxFrameAllocations;
+        K_UINT mCommandCount;
+    };
+
+    bool writeJson(const BenchmarkSettings& someSettings, const Percentiles& aFrame, const Percentiles* someStages,
+                   size_t aStepCount, KUI_64 anAllocationCount, KUI_64 aMaxFrameAllocations, K_UINT aCommandCount) {
+        std::ofstream stream(someSettings.jsonPath.c_str());
+        if (!stream)
+            return false;
+        stream.setf(std::ios::fixed);
+        stream.precision(4);
+        stream << "{\n  \"benchmark\":\"frame\",\n  \"scene\":{\"objects\":" << someSettings.objectCount
+               << ",\"sprites\":" << someSettings.spriteCount << ",\"particles\":" << someSettings.particleCount
+               << ",\"width\":" << someSettings.width << ",\"height\":" << someSettings.height
+               << ",\"frames\":" << someSettings.frameCount << ",\"warmupFrames\":" << someSettings.warmupFrameCount
+               << ",\"target\":\"" << (someSettings.videoDriver.empty() ? "surface" : someSettings.videoDriver.c_str())
+               << "\"},\n  \"frame\":{";
+        writePercentiles(stream, aFrame);
+        stream << "},\n  \"steps\":" << aStepCount << ",\n  \"stages\":[";
+        for (K_UINT stage = 0; stage < STAGE_COUNT; ++stage) {
+            stream << (stage ? ",\n" : "\n") << "    {\"name\":\"" << STAGE_NAMES[stage] << "\",\"per\":\""
+                   << (isStepStage(stage) ? "step" : "frame") << "\",";
+            writePercentiles(stream, someStages[stage]);
+            stream << "}";
+        }
+        stream << "\n  ],\n  \"allocations\":{\"tracked\":" << (MEMORY_TRACKING_ENABLED ? "true" : "false")
+               << ",\"total\":" << anAllocationCount << ",\"maxPerFrame\":" << aMaxFrameAllocations
+               << "},\n  \"commandsPerFrame\":" << aCommandCount << "\n}\n";
+        return static_cast<bool>(stream);
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    BenchmarkSettings settings;
+    settings.objectCount = 10000;
+    settings.spriteCount = 2000;
+    settings.particleCount = 50000;
+    settings.width = 1280;
+    settings.height = 720;
+    settings.frameCount = 600;
+    settings.warmupFrameCount = 60;
+    if (!parseArguments(argc, argv, settings)) {
+        printUsage();
+        return 1;
+    }
+
+    // Either a memory surface with no video subsystem at all, or a hidden window of the
+    // named driver. Both use the software renderer so results do not depend on a GPU.
+    SDL_Surface* aSurface = nullptr;
+    SDL_Window* aWindow = nullptr;
+    SDL_Renderer* aRenderer = nullptr;
+    if (settings.videoDriver.empty()) {
+        aSurface = SDL_CreateRGBSurface(0, settings.width, settings.height, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+        if (aSurface)
+            aRenderer = SDL_CreateSoftwareRenderer(aSurface);
+    }
+    else if (SDL_VideoInit(settings.videoDriver.c_str()) == 0) {
+        aWindow = SDL_CreateWindow("KhaosBenchmark", 0, 0, settings.width, settings.height, SDL_WINDOW_HIDDEN);
+        if (aWindow)
+            aRenderer = SDL_CreateRenderer(aWindow, -1, SDL_RENDERER_SOFTWARE);
+    }
+    SDL_Texture* aTexture = aRenderer ? createSpriteTexture(aRenderer) : nullptr;
+    if (!aTexture) {
+        std::cout << "SDL error: " << SDL_GetError() << std::endl;
+        if (aRenderer)
+            SDL_DestroyRenderer(aRenderer);
+        if (aWindow)
+            SDL_DestroyWindow(aWindow);
+        if (aSurface)
+            SDL_FreeSurface(aSurface);
+        SDL_Quit();
+        return 1;
+    }
+
+    // Enough steps to keep up with real time, without letting a slow frame snowball.
+    GameLoopSettings loopSettings;
+    loopSettings.timeStep = TIME_STEP;
+    loopSettings.maxStepsPerFrame = MAX_STEPS_PER_FRAME;
+    GameLoop loop(loopSettings);
+    FrameBenchmark benchmark(settings, loop, aRenderer, aTexture);
+    loop.run(benchmark);
+
+    const std::vector<double>& frameTimes = benchmark.getFrameTimes();
+    const size_t stepCount = benchmark.getStageTimes(STAGE_SIMULATE).size();
+    const KUI_64 allocationCount = benchmark.getAllocationCount();
+    const KUI_64 maxFrameAllocations = benchmark.getMaxFrameAllocations();
+    const K_UINT commandCount = benchmark.getCommandCount();
+
+    const Percentiles frame = computePercentiles(frameTimes);
+    Percentiles stages[STAGE_COUNT];
+    std::cout.setf(std::ios::fixed);
+    std::cout.precision(3);
+    std::cout << settings.frameCount << " frames, " << settings.objectCount << " objects, " << settings.spriteCount
+              << " sprites, " << settings.particleCount << " particles, " << stepCount << " steps, " << commandCount
+              << " commands per frame\n"
+              << "frame          mean " << frame.mean << " ms, p50 " << frame.p50 << ", p99 " << frame.p99 << ", max "
+              << frame.max << "\n";
+    for (K_UINT stage = 0; stage < STAGE_COUNT; ++stage) {
+        stages[stage] = computePercentiles(benchmark.getStageTimes(stage));
+        std::cout << "  " << STAGE_NAMES[stage] << std::string(13 - strlen(STAGE_NAMES[stage]), ' ') << "mean "
+                  << stages[stage].mean << " ms, p50 " << stages[stage].p50 << ", p99 " << stages[stage].p99
+                  << (isStepStage(stage) ? " per step\n" : " per frame\n");
+    }
+    std::cout << "heap allocations " << allocationCount << " (max " << maxFrameAllocations << " in a frame)"
+              << (MEMORY_TRACKING_ENABLED ? "" : ", tracking disabled in this build") << std::endl;
+
+    K_INT result = 0;
+    if (!settings.jsonPath.empty() &&
+        !writeJson(settings, frame, stages, stepCount, allocationCount, maxFrameAllocations, commandCount)) {
+        std::cout << "Could not write " << settings.jsonPath << std::endl;
+        result = 1;
+    }
+    if (!settings.tracePath.empty() && !Profiler::WriteChromeTrace(settings.tracePath.c_str())) {
+        std::cout << "Could not write " << settings.tracePath << std::endl;
+        result = 1;
+    }
+
+    SDL_DestroyTexture(aTexture);
+    SDL_DestroyRenderer(aRenderer);
+    if (aWindow)
+        SDL_DestroyWindow(aWindow);
+    if (aSurface)
+        SDL_FreeSurface(aSurface);
+    SDL_Quit();
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,140 @@
+// GameLoop.cpp
+// Simulation thread, frame handoff and state interpolation.
+
+#include "GameLoop.h"
+#include "Profiler.h"
+
+#include <chrono>
+#include <thread>
+#include <utility>
+
+using namespace std::chrono;
+
+namespace KhaosEngine
+{
+    //
+    // FrameState function definitions.
+    //
+
+    void InterpolateFrameStates(const FrameState& aPrevious, const FrameState& aCurrent, float anAlpha,
+                                FrameState& aResult) {
+        ASSERT(aPrevious.positions.size() == aCurrent.positions.size());
+        ASSERT(aPrevious.rotations.size() == aCurrent.rotations.size());
+
+        aResult.positions.resize(aCurrent.positions.size());
+        for (size_t i = 0; i < aCurrent.positions.size(); ++i)
+            aResult.positions[i] = Vector3f::Lerp(aPrevious.positions[i], aCurrent.positions[i], anAlpha);
+
+        aResult.rotations.resize(aCurrent.rotations.size());
+        for (size_t i = 0; i < aCurrent.rotations.size(); ++i)
+            aResult.rotations[i] = Quaternion::Slerp(aPrevious.rotations[i], aCurrent.rotations[i], anAlpha);
+
+        aResult.step = aCurrent.step;
+    }
+
+    //
+    // GameLoop function definitions.
+    //
+
+    GameLoop::GameLoop(const GameLoopSettings& someSettings)
+        : mSettings(someSettings), mPublishedFrames(0), mConsumedFrames(0), mRunning(false) {
+        ASSERT(mSettings.timeStep > 0.0f);
+        ASSERT(mSettings.maxStepsPerFrame > 0);
+    }
+
+    void GameLoop::run(GameLoopClient& aClient) {
+        mPublishedFrames = 0;
+        mConsumedFrames = 0;
+        mRunning.store(true, std::memory_order_release);
+        std::thread simulation(&GameLoop::simulationThread, this, std::ref(aClient));
+
+        FrameState blended;
+        for (KUI_64 frame = 0; ; ++frame) {
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mCondition.wait(lock, [&] { return frame < mPublishedFrames || !isRunning(); });
+                if (frame >= mPublishedFrames)
+                    break;
+            }
+
+            {
+                PROFILE_SCOPE_CATEGORY("GameLoop::render", PROFILE_CATEGORY_RENDER);
+                const FramePacket& packet = mPackets[frame & 1];
+                InterpolateFrameStates(packet.previous, packet.current, packet.alpha, blended);
+                aClient.render(blended);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mConsumedFrames = frame + 1;
+            }
+            mCondition.notify_all();
+        }
+
+        stop();
+        simulation.join();
+    }
+
+    void GameLoop::stop() {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mRunning.store(false, std::memory_order_release);
+        }
+        mCondition.notify_all();
+    }
+
+    void GameLoop::simulationThread(GameLoopClient& aClient) {
+        PROFILE_THREAD_NAME("Simulation");
+
+        const double timeStep = mSettings.timeStep;
+        FrameState previous;
+        FrameState current;
+        aClient.capture(current);
+        current.step = 0;
+        previous = current;
+
+        KUI_64 step = 0;
+        double accumulator = 0.0;
+        steady_clock::time_point lastTime = steady_clock::now();
+        for (KUI_64 frame = 0; ; ++frame) {
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mCondition.wait(lock, [&] { return frame < mConsumedFrames + 2 || !isRunning(); });
+                if (!isRunning())
+                    break;
+            }
+
+            {
+                PROFILE_SCOPE_CATEGORY("GameLoop::simulate", PROFILE_CATEGORY_FRAME);
+                const steady_clock::time_point now = steady_clock::now();
+                accumulator += duration_cast<duration<double>>(now - lastTime).count();
+                lastTime = now;
+
+                K_UINT steps = 0;
+                while (accumulator >= timeStep && steps < mSettings.maxStepsPerFrame) {
+                    std::swap(previous, current);
+                    aClient.simulate(mSettings.timeStep);
+                    aClient.capture(current);
+                    current.step = ++step;
+                    accumulator -= timeStep;
+                    ++steps;
+                }
+
+                // Running behind. Drop the backlog rather than spiral into ever longer frames.
+                if (accumulator >= timeStep)
+                    accumulator = 0.0;
+
+                FramePacket& packet = mPackets[frame & 1];
+                packet.previous = previous;
+                packet.current = current;
+                packet.alpha = static_cast<float>(accumulator / timeStep);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mPublishedFrames = frame + 1;
+            }
+            mCondition.notify_all();
+        }
+    }
+}
\ No newline at end of file
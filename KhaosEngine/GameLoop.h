@@ -0,0 +1,103 @@
+#pragma once
+
+// GameLoop.h
+// Fixed timestep main loop with interpolated rendering.
+//
+// The simulation advances in fixed steps on its own thread while the calling thread renders.
+// Frame N + 1 is simulated while frame N is drawn, and the two threads hand frames over
+// through a pair of buffers, so the simulation is never more than one frame ahead and
+// input to display latency stays bounded. Each frame carries the last two simulated states
+// and the fraction of a step left over, and the renderer draws the blend of the two.
+
+#include "Common.h"
+#include "KhaosMath.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace KhaosEngine
+{
+    using KhaosMath::Vector3f;
+    using KhaosMath::Quaternion;
+
+    // Render facing state of every object after a simulation step.
+    struct FrameState
+    {
+        std::vector<Vector3f> positions;
+        std::vector<Quaternion> rotations;
+        KUI_64 step; // Fixed steps simulated before this state was captured.
+    };
+
+    // Blends two states captured from the same objects. Positions are lerped and rotations
+    // slerped along the shorter arc; anAlpha of zero gives aPrevious.
+    void InterpolateFrameStates(const FrameState& aPrevious, const FrameState& aCurrent, float anAlpha,
+                                FrameState& aResult);
+
+    // The game specific half of the loop.
+    class GameLoopClient
+    {
+    public:
+        virtual ~GameLoopClient() { }
+
+        // Advances the simulation by aTimeStep seconds. Called on the simulation thread.
+        virtual void simulate(float aTimeStep) = 0;
+
+        // Copies the render facing state into aState. Called on the simulation thread after
+        // every step, and once before the first.
+        virtual void capture(FrameState& aState) = 0;
+
+        // Draws an interpolated state. Called on the thread that called GameLoop::run.
+        virtual void render(const FrameState& aState) = 0;
+    };
+
+    struct GameLoopSettings
+    {
+        float timeStep;          // Seconds per simulation step.
+        K_UINT maxStepsPerFrame; // Past this many steps in one frame, remaining time is dropped.
+    };
+
+    class GameLoop
+    {
+    public:
+        explicit GameLoop(const GameLoopSettings& someSettings);
+
+        // Runs until stop is called. Rendering happens on the calling thread, which should be
+        // the thread that owns the window and renderer.
+        void run(GameLoopClient& aClient);
+
+        // Asks the loop to exit after the frame in flight. Safe to call from any thread.
+        void stop();
+
+        // Returns true between the start of run and a call to stop.
+        bool isRunning() const {
+            return mRunning.load(std::memory_order_acquire);
+        }
+
+    private:
+        GameLoop(const GameLoop&) = delete;
+        GameLoop& operator=(const GameLoop&) = delete;
+
+        // Everything the renderer needs for one frame.
+        struct FramePacket
+        {
+            FrameState previous;
+            FrameState current;
+            float alpha;
+        };
+
+        void simulationThread(GameLoopClient& aClient);
+
+        GameLoopSettings mSettings;
+        FramePacket mPackets[2];
+
+        // Frame counts guarded by mMutex. The simulation may fill packet f % 2 once
+        // f < mConsumedFrames + 2, and the renderer may read it once f < mPublishedFrames.
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        KUI_64 mPublishedFrames;
+        KUI_64 mConsumedFrames;
+        std::atomic<bool> mRunning;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,188 @@
+// LargeWorld.cpp
+// SSE2 and AVX batch kernels for the double precision types in LargeWorld.h.
+
+#include "LargeWorld.h"
+#include "CpuFeatures.h"
+
+#include <emmintrin.h>
+#include <immintrin.h>
+
+namespace
+{
+    using namespace KhaosMath;
+
+    static_assert(sizeof(Vector3d) == 3 * sizeof(double), "Vector3d must be tightly packed.");
+    static_assert(sizeof(Vector3f) == 3 * sizeof(float), "Vector3f must be tightly packed.");
+    static_assert(sizeof(Matrix4x4d) == 16 * sizeof(double), "Matrix4x4d must be tightly packed.");
+    static_assert(sizeof(Matrix4x4f) == 16 * sizeof(float), "Matrix4x4f must be tightly packed.");
+
+    // Returns the row vector someRow multiplied by the matrix held in someRows, using AVX.
+    inline __m256d transformRowAvx(const double* someRow, const __m256d* someRows) {
+        __m256d result = _mm256_mul_pd(_mm256_broadcast_sd(someRow + 0), someRows[0]);
+        result = _mm256_add_pd(result, _mm256_mul_pd(_mm256_broadcast_sd(someRow + 1), someRows[1]));
+        result = _mm256_add_pd(result, _mm256_mul_pd(_mm256_broadcast_sd(someRow + 2), someRows[2]));
+        return _mm256_add_pd(result, _mm256_mul_pd(_mm256_broadcast_sd(someRow + 3), someRows[3]));
+    }
+
+    // SSE2 version of transformRowAvx. Each matrix row is split into low and high halves.
+    inline void transformRowSse2(const double* someRow, const __m128d* someLow, const __m128d* someHigh,
+                                 __m128d& aLow, __m128d& aHigh) {
+        aLow = _mm_setzero_pd();
+        aHigh = _mm_setzero_pd();
+        for (K_INT k = 0; k < 4; ++k) {
+            const __m128d scalar = _mm_set1_pd(someRow[k]);
+            aLow = _mm_add_pd(aLow, _mm_mul_pd(scalar, someLow[k]));
+            aHigh = _mm_add_pd(aHigh, _mm_mul_pd(scalar, someHigh[k]));
+        }
+    }
+}
+
+namespace KhaosMath
+{
+    //
+    // Matrix and point batches.
+    //
+
+    void MultiplyMatrices(const Matrix4x4d* someFirst, const Matrix4x4d* someSecond,
+                          Matrix4x4d* someResults, size_t aCount) {
+        if (CpuFeatures::Get().avx) {
+            for (size_t i = 0; i < aCount; ++i) {
+                const __m256d rows[4] = { _mm256_loadu_pd(someSecond[i].elem[0]), _mm256_loadu_pd(someSecond[i].elem[1]),
+                                          _mm256_loadu_pd(someSecond[i].elem[2]), _mm256_loadu_pd(someSecond[i].elem[3]) };
+                for (K_INT row = 0; row < 4; ++row)
+                    _mm256_storeu_pd(someResults[i].elem[row], transformRowAvx(someFirst[i].elem[row], rows));
+            }
+        } else {
+            for (size_t i = 0; i < aCount; ++i) {
+                __m128d low[4];
+                __m128d high[4];
+                for (K_INT k = 0; k < 4; ++k) {
+                    low[k] = _mm_loadu_pd(someSecond[i].elem[k]);
+                    high[k] = _mm_loadu_pd(someSecond[i].elem[k] + 2);
+                }
+                for (K_INT row = 0; row < 4; ++row) {
+                    __m128d resultLow, resultHigh;
+                    transformRowSse2(someFirst[i].elem[row], low, high, resultLow, resultHigh);
+                    _mm_storeu_pd(someResults[i].elem[row], resultLow);
+                    _mm_storeu_pd(someResults[i].elem[row] + 2, resultHigh);
+                }
+            }
+        }
+    }
+
+    void TransformPoints(const Matrix4x4d& aMatrix, const Vector3d* somePoints,
+                         Vector3d* someResults, size_t aCount) {
+        // The w of every point is one, so row 3 is added instead of multiplied.
+        if (CpuFeatures::Get().avx) {
+            const __m256d row0 = _mm256_loadu_pd(aMatrix.elem[0]);
+            const __m256d row1 = _mm256_loadu_pd(aMatrix.elem[1]);
+            const __m256d row2 = _mm256_loadu_pd(aMatrix.elem[2]);
+            const __m256d row3 = _mm256_loadu_pd(aMatrix.elem[3]);
+            for (size_t i = 0; i < aCount; ++i) {
+                __m256d result = _mm256_add_pd(row3, _mm256_mul_pd(_mm256_broadcast_sd(&somePoints[i].x), row0));
+                result = _mm256_add_pd(result, _mm256_mul_pd(_mm256_broadcast_sd(&somePoints[i].y), row1));
+                result = _mm256_add_pd(result, _mm256_mul_pd(_mm256_broadcast_sd(&somePoints[i].z), row2));
+
+                // A full 256-bit store would clobber the next point's x.
+                _mm_storeu_pd(&someResults[i].x, _mm256_castpd256_pd128(result));
+                _mm_store_sd(&someResults[i].z, _mm256_extractf128_pd(result, 1));
+            }
+        } else {
+            __m128d low[4];
+            __m128d high[4];
+            for (K_INT k = 0; k < 4; ++k) {
+                low[k] = _mm_loadu_pd(aMatrix.elem[k]);
+                high[k] = _mm_loadu_pd(aMatrix.elem[k] + 2);
+            }
+            for (size_t i = 0; i < aCount; ++i) {
+                const __m128d x = _mm_set1_pd(somePoints[i].x);
+                const __m128d y = _mm_set1_pd(somePoints[i].y);
+                const __m128d z = _mm_set1_pd(somePoints[i].z);
+                __m128d resultLow = _mm_add_pd(low[3], _mm_mul_pd(x, low[0]));
+                __m128d resultHigh = _mm_add_pd(high[3], _mm_mul_pd(x, high[0]));
+                resultLow = _mm_add_pd(resultLow, _mm_mul_pd(y, low[1]));
+                resultHigh = _mm_add_pd(resultHigh, _mm_mul_pd(y, high[1]));
+                resultLow = _mm_add_pd(resultLow, _mm_mul_pd(z, low[2]));
+                resultHigh = _mm_add_pd(resultHigh, _mm_mul_pd(z, high[2]));
+
+                _mm_storeu_pd(&someResults[i].x, resultLow);
+                _mm_store_sd(&someResults[i].z, resultHigh);
+            }
+        }
+    }
+
+    //
+    // Camera relative rebasing.
+    //
+
+    void RebasePositions(const Vector3d* somePositions, const Vector3d& anOrigin,
+                         Vector3f* someResults, size_t aCount) {
+        // Both arrays are treated as flat runs of x, y, z. The origin repeats with a period
+        // of three components, so a few rotated copies of it line up with any register.
+        const double* positions = &somePositions[0].x;
+        float* results = &someResults[0].x;
+        const double ox = anOrigin.x;
+        const double oy = anOrigin.y;
+        const double oz = anOrigin.z;
+
+        size_t i = 0;
+        if (CpuFeatures::Get().avx) {
+            // Four positions are twelve components: three AVX loads and three float4 stores.
+            const __m256d originA = _mm256_setr_pd(ox, oy, oz, ox);
+            const __m256d originB = _mm256_setr_pd(oy, oz, ox, oy);
+            const __m256d originC = _mm256_setr_pd(oz, ox, oy, oz);
+            for (; i + 4 <= aCount; i += 4) {
+                const double* source = positions + i * 3;
+                float* destination = results + i * 3;
+                _mm_storeu_ps(destination + 0, _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(source + 0), originA)));
+                _mm_storeu_ps(destination + 4, _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(source + 4), originB)));
+                _mm_storeu_ps(destination + 8, _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(source + 8), originC)));
+            }
+        } else {
+            // Two positions are six components: three SSE2 loads, one float4 and one float2 store.
+            const __m128d originA = _mm_setr_pd(ox, oy);
+            const __m128d originB = _mm_setr_pd(oz, ox);
+            const __m128d originC = _mm_setr_pd(oy, oz);
+            for (; i + 2 <= aCount; i += 2) {
+                const double* source = positions + i * 3;
+                float* destination = results + i * 3;
+                const __m128 a = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(source + 0), originA));
+                const __m128 b = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(source + 2), originB));
+                const __m128 c = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(source + 4), originC));
+                _mm_storeu_ps(destination, _mm_movelh_ps(a, b));
+                _mm_storel_pi(reinterpret_cast<__m64*>(destination + 4), c);
+            }
+        }
+
+        for (; i < aCount; ++i)
+            someResults[i] = RebasePosition(somePositions[i], anOrigin);
+    }
+
+    void RebaseTransforms(const Matrix4x4d* someTransforms, const Vector3d& anOrigin,
+                          Matrix4x4f* someResults, size_t aCount) {
+        // Each row becomes (x, y, z, w) - w * (ox, oy, oz, 0).
+        if (CpuFeatures::Get().avx) {
+            const __m256d origin = _mm256_setr_pd(anOrigin.x, anOrigin.y, anOrigin.z, 0.0);
+            for (size_t i = 0; i < aCount; ++i) {
+                for (K_INT row = 0; row < 4; ++row) {
+                    const double* source = someTransforms[i].elem[row];
+                    const __m256d offset = _mm256_mul_pd(_mm256_broadcast_sd(source + 3), origin);
+                    const __m256d rebased = _mm256_sub_pd(_mm256_loadu_pd(source), offset);
+                    _mm_storeu_ps(&someResults[i].elem[row][0], _mm256_cvtpd_ps(rebased));
+                }
+            }
+        } else {
+            const __m128d originLow = _mm_setr_pd(anOrigin.x, anOrigin.y);
+            const __m128d originHigh = _mm_setr_pd(anOrigin.z, 0.0);
+            for (size_t i = 0; i < aCount; ++i) {
+                for (K_INT row = 0; row < 4; ++row) {
+                    const double* source = someTransforms[i].elem[row];
+                    const __m128d w = _mm_set1_pd(source[3]);
+                    const __m128d low = _mm_sub_pd(_mm_loadu_pd(source), _mm_mul_pd(w, originLow));
+                    const __m128d high = _mm_sub_pd(_mm_loadu_pd(source + 2), _mm_mul_pd(w, originHigh));
+                    _mm_storeu_ps(&someResults[i].elem[row][0], _mm_movelh_ps(_mm_cvtpd_ps(low), _mm_cvtpd_ps(high)));
+                }
+            }
+        }
+    }
+}
\ No newline at end of file
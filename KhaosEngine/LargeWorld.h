@@ -0,0 +1,66 @@
+#pragma once
+
+// LargeWorld.h
+// Camera relative rendering for worlds larger than float precision allows.
+// Simulation keeps positions and transforms in Vector3d / Matrix4x4d. Once per frame the
+// batches below subtract a render origin (usually the camera position) in double precision
+// and round the small results to Vector3f / Matrix4x4f, which rendering and culling consume.
+
+#include "Common.h"
+#include "CommonMath.h"
+
+#include "Vector3f.h"
+#include "Vector3d.h"
+#include "Matrix4x4f.h"
+#include "Matrix4x4d.h"
+
+namespace KhaosMath
+{
+    // Returns a float view matrix that takes positions relative to anOrigin, i.e. the
+    // product Translation(anOrigin) * aView. The large terms cancel in double before rounding.
+    inline Matrix4x4f RebaseViewMatrix(const Matrix4x4d& aView, const Vector3d& anOrigin) {
+        Matrix4x4d rebased = aView;
+        for (K_INT col = 0; col < 4; ++col)
+            rebased.elem[3][col] += anOrigin.x * aView.elem[0][col] + anOrigin.y * aView.elem[1][col] +
+                                    anOrigin.z * aView.elem[2][col];
+        return rebased.toMatrix4x4f();
+    }
+
+    // Returns aPosition relative to anOrigin, rounded to float.
+    constexpr Vector3f RebasePosition(const Vector3d& aPosition, const Vector3d& anOrigin) {
+        return (aPosition - anOrigin).toVector3f();
+    }
+
+    // Returns the float transform of aTransform * Translation(-anOrigin).
+    // Only the translation row changes; rotation and scale are rounded as they are.
+    constexpr Matrix4x4f RebaseTransform(const Matrix4x4d& aTransform, const Vector3d& anOrigin) {
+        Matrix4x4d rebased = aTransform;
+        for (K_INT row = 0; row < 4; ++row) {
+            rebased.elem[row][0] -= aTransform.elem[row][3] * anOrigin.x;
+            rebased.elem[row][1] -= aTransform.elem[row][3] * anOrigin.y;
+            rebased.elem[row][2] -= aTransform.elem[row][3] * anOrigin.z;
+        }
+        return rebased.toMatrix4x4f();
+    }
+
+    //
+    // Batch kernels. These use AVX when the CPU has it and SSE2 everywhere else.
+    // Arrays may be unaligned. Inputs and outputs must not overlap.
+    //
+
+    // someResults[i] = someFirst[i] * someSecond[i].
+    void MultiplyMatrices(const Matrix4x4d* someFirst, const Matrix4x4d* someSecond,
+                          Matrix4x4d* someResults, size_t aCount);
+
+    // someResults[i] = aMatrix.transformPoint(somePoints[i]).
+    void TransformPoints(const Matrix4x4d& aMatrix, const Vector3d* somePoints,
+                         Vector3d* someResults, size_t aCount);
+
+    // someResults[i] = RebasePosition(somePositions[i], anOrigin).
+    void RebasePositions(const Vector3d* somePositions, const Vector3d& anOrigin,
+                         Vector3f* someResults, size_t aCount);
+
+    // someResults[i] = RebaseTransform(someTransforms[i], anOrigin).
+    void RebaseTransforms(const Matrix4x4d* someTransforms, const Vector3d& anOrigin,
+                          Matrix4x4f* someResults, size_t aCount);
+}
\ No newline at end of file
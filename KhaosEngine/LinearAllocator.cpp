@@ -0,0 +1,58 @@
+// LinearAllocator.cpp
+// Implementation of the linear and per-frame allocators.
+
+#include "LinearAllocator.h"
+
+namespace KhaosEngine
+{
+    //
+    // LinearAllocator function definitions.
+    //
+
+    LinearAllocator::LinearAllocator(size_t aCapacity)
+        : mBuffer(static_cast<KUI_8*>(AlignedAlloc(aCapacity, AVX_ALIGNMENT))),
+          mCapacity(aCapacity), mOffset(0), mPeakUsed(0) {
+        ASSERT(mBuffer != nullptr);
+    }
+
+    LinearAllocator::~LinearAllocator() {
+        AlignedFree(mBuffer);
+    }
+
+    void* LinearAllocator::allocate(size_t aSize, size_t aAlignment) {
+        // Align the absolute address so requests above the buffer's own alignment still work.
+        const size_t base = reinterpret_cast<size_t>(mBuffer);
+        const size_t alignedOffset = AlignUp(base + mOffset, aAlignment) - base;
+
+        if (alignedOffset + aSize > mCapacity) {
+            ASSERT(!"LinearAllocator exhausted");
+            return nullptr;
+        }
+
+        mOffset = alignedOffset + aSize;
+        if (mOffset > mPeakUsed)
+            mPeakUsed = mOffset;
+        return mBuffer + alignedOffset;
+    }
+
+    //
+    // FrameAllocator function definitions.
+    //
+
+    FrameAllocator::FrameAllocator(size_t aCapacityPerFrame)
+        : mFirst(aCapacityPerFrame), mSecond(aCapacityPerFrame),
+          mCurrent(&mFirst), mPrevious(&mSecond), mFrameIndex(0),
+          mHeapAllocationMark(GetHeapAllocationCount()), mHeapAllocationsLastFrame(0) { }
+
+    void FrameAllocator::beginFrame() {
+        const KUI_64 heapAllocations = GetHeapAllocationCount();
+        mHeapAllocationsLastFrame = heapAllocations - mHeapAllocationMark;
+        mHeapAllocationMark = heapAllocations;
+
+        LinearAllocator* swap = mPrevious;
+        mPrevious = mCurrent;
+        mCurrent = swap;
+        mCurrent->reset();
+        ++mFrameIndex;
+    }
+}
\ No newline at end of file
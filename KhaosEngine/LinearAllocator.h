@@ -0,0 +1,137 @@
+#pragma once
+
+// LinearAllocator.h
+// Bump-pointer allocators for short-lived data such as per-frame math temporaries,
+// transform lists and render batches. Memory is reserved once up front and recycled
+// by resetting, so steady-state frames never reach the global heap.
+
+#include "Common.h"
+#include "Memory.h"
+
+#include <utility>
+
+namespace KhaosEngine
+{
+    // Allocates by bumping an offset through a single fixed-size buffer.
+    // Individual allocations cannot be freed; roll back with freeToMarker or reset.
+    // Destructors are never run, so only trivially destructible types should live here.
+    // Not thread safe; give each thread its own allocator.
+    class LinearAllocator
+    {
+    public:
+        typedef size_t Marker;
+
+        // Reserves aCapacity bytes from the heap. This is the only heap allocation made.
+        explicit LinearAllocator(size_t aCapacity);
+        ~LinearAllocator();
+
+        // Allocates aSize bytes aligned to aAlignment. Returns nullptr when the buffer is exhausted.
+        void* allocate(size_t aSize, size_t aAlignment = SIMD_ALIGNMENT);
+
+        // Allocates uninitialized storage for aCount objects of type T, honouring T's alignment.
+        template <typename T>
+        T* allocateArray(size_t aCount) {
+            return static_cast<T*>(allocate(sizeof(T) * aCount, AlignmentOf<T>()));
+        }
+
+        // Allocates and constructs a single object of type T.
+        template <typename T, typename... Args>
+        T* create(Args&&... someArgs) {
+            void* memory = allocate(sizeof(T), AlignmentOf<T>());
+            return memory ? new (memory) T(std::forward<Args>(someArgs)...) : nullptr;
+        }
+
+        // Returns a marker representing the current top of the buffer.
+        Marker getMarker() const {
+            return mOffset;
+        }
+
+        // Rolls the buffer back to a marker, releasing everything allocated after it.
+        void freeToMarker(Marker aMarker) {
+            ASSERT(aMarker <= mOffset);
+            mOffset = aMarker;
+        }
+
+        // Releases every allocation at once.
+        void reset() {
+            mOffset = 0;
+        }
+
+        // Determine if a pointer was handed out by this allocator.
+        bool owns(const void* aPointer) const {
+            const KUI_8* address = static_cast<const KUI_8*>(aPointer);
+            return address >= mBuffer && address < mBuffer + mCapacity;
+        }
+
+        size_t getCapacity() const { return mCapacity; }
+        size_t getUsed() const { return mOffset; }
+        size_t getPeakUsed() const { return mPeakUsed; }
+
+        // Returns the alignment used for objects of type T, never less than pointer alignment.
+        template <typename T>
+        static size_t AlignmentOf() {
+            return __alignof(T) > sizeof(void*) ? __alignof(T) : sizeof(void*);
+        }
+
+    private:
+        LinearAllocator(const LinearAllocator&) = delete;
+        LinearAllocator& operator=(const LinearAllocator&) = delete;
+
+        KUI_8* mBuffer;
+        size_t mCapacity;
+        size_t mOffset;
+        size_t mPeakUsed;
+    };
+
+    // Double-buffered linear allocator that is reset at the start of every frame.
+    // Data allocated during frame N stays valid until the start of frame N + 2, so the
+    // previous frame's output can still be read while the current frame is being built.
+    class FrameAllocator
+    {
+    public:
+        // Reserves aCapacityPerFrame bytes for each of the two frame buffers.
+        explicit FrameAllocator(size_t aCapacityPerFrame);
+
+        // Swaps buffers and resets the new current one. Call once at the top of every frame.
+        // Also records how many heap allocations the previous frame made.
+        void beginFrame();
+
+        // Allocates aSize bytes from the current frame's buffer.
+        void* allocate(size_t aSize, size_t aAlignment = SIMD_ALIGNMENT) {
+            return mCurrent->allocate(aSize, aAlignment);
+        }
+
+        // Allocates uninitialized storage for aCount objects of type T from the current frame.
+        template <typename T>
+        T* allocateArray(size_t aCount) {
+            return mCurrent->allocateArray<T>(aCount);
+        }
+
+        // Allocates and constructs a single object of type T in the current frame.
+        template <typename T, typename... Args>
+        T* create(Args&&... someArgs) {
+            return mCurrent->create<T>(std::forward<Args>(someArgs)...);
+        }
+
+        LinearAllocator& getCurrent() { return *mCurrent; }
+        LinearAllocator& getPrevious() { return *mPrevious; }
+
+        KUI_64 getFrameIndex() const { return mFrameIndex; }
+
+        // Number of global heap allocations made between the last two calls to beginFrame.
+        // Always zero when MEMORY_TRACKING_ENABLED is off.
+        KUI_64 getHeapAllocationsLastFrame() const { return mHeapAllocationsLastFrame; }
+
+    private:
+        FrameAllocator(const FrameAllocator&) = delete;
+        FrameAllocator& operator=(const FrameAllocator&) = delete;
+
+        LinearAllocator mFirst;
+        LinearAllocator mSecond;
+        LinearAllocator* mCurrent;
+        LinearAllocator* mPrevious;
+        KUI_64 mFrameIndex;
+        KUI_64 mHeapAllocationMark;
+        KUI_64 mHeapAllocationsLastFrame;
+    };
+}
\ No newline at end of file
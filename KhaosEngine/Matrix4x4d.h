@@ -0,0 +1,147 @@
+#pragma once
+
+// Matrix4x4d.h
+// Double precision 4x4 matrix for world transforms far from the origin. Follows the
+// Matrix4x4f conventions: row vectors, translation in row 3, left-handed cameras.
+
+#include "Common.h"
+#include "CommonMath.h"
+
+#include "Vector3d.h"
+#include "Quaternion.h"
+#include "Matrix4x4f.h"
+
+namespace KhaosMath
+{
+    // Class representing a 4x4 matrix comprised of 16 doubles.
+    // Aligned like Matrix4x4f so arrays from the default allocators stay valid.
+    __declspec(align(16)) class Matrix4x4d
+    {
+    public:
+        double elem[4][4];
+
+        // Default constructor that zeros all elem.
+        constexpr Matrix4x4d()
+            : elem{ { 0.0, 0.0, 0.0, 0.0 },
+                    { 0.0, 0.0, 0.0, 0.0 },
+                    { 0.0, 0.0, 0.0, 0.0 },
+                    { 0.0, 0.0, 0.0, 0.0 } } { }
+
+        // Constructor to explicitly initialize all elem.
+        constexpr Matrix4x4d(double a, double b, double c, double d,
+                             double e, double f, double g, double h,
+                             double i, double j, double k, double l,
+                             double m, double n, double o, double p)
+            : elem{ { a, b, c, d },
+                    { e, f, g, h },
+                    { i, j, k, l },
+                    { m, n, o, p } } { }
+
+        // Widening constructor from a float matrix.
+        explicit constexpr Matrix4x4d(const Matrix4x4f& aMatrix)
+            : elem{ { aMatrix(0, 0), aMatrix(0, 1), aMatrix(0, 2), aMatrix(0, 3) },
+                    { aMatrix(1, 0), aMatrix(1, 1), aMatrix(1, 2), aMatrix(1, 3) },
+                    { aMatrix(2, 0), aMatrix(2, 1), aMatrix(2, 2), aMatrix(2, 3) },
+                    { aMatrix(3, 0), aMatrix(3, 1), aMatrix(3, 2), aMatrix(3, 3) } } { }
+
+        constexpr double& operator() (K_INT aRow, K_INT aCol) {
+            return elem[aRow][aCol];
+        }
+
+        constexpr double operator() (K_INT aRow, K_INT aCol) const {
+            return elem[aRow][aCol];
+        }
+
+        // Returns the transform that applies this matrix and then other.
+        constexpr Matrix4x4d operator*(const Matrix4x4d& other) const {
+            Matrix4x4d result;
+            for (K_INT row = 0; row < 4; ++row)
+                for (K_INT col = 0; col < 4; ++col)
+                    result.elem[row][col] = elem[row][0] * other.elem[0][col] + elem[row][1] * other.elem[1][col] +
+                                            elem[row][2] * other.elem[2][col] + elem[row][3] * other.elem[3][col];
+            return result;
+        }
+
+        constexpr bool operator==(const Matrix4x4d& other) const {
+            for (K_INT row = 0; row < 4; ++row)
+                for (K_INT col = 0; col < 4; ++col)
+                    if (elem[row][col] != other.elem[row][col])
+                        return false;
+            return true;
+        }
+
+        constexpr bool operator!=(const Matrix4x4d& other) const {
+            return !(*this == other);
+        }
+
+        // Returns the transpose of this matrix. Does not modify the original matrix.
+        constexpr Matrix4x4d getTranspose() const {
+            return Matrix4x4d(elem[0][0], elem[1][0], elem[2][0], elem[3][0],
+                              elem[0][1], elem[1][1], elem[2][1], elem[3][1],
+                              elem[0][2], elem[1][2], elem[2][2], elem[3][2],
+                              elem[0][3], elem[1][3], elem[2][3], elem[3][3]);
+        }
+
+        // Returns the translation held in row 3.
+        constexpr Vector3d getTranslation() const {
+            return Vector3d(elem[3][0], elem[3][1], elem[3][2]);
+        }
+
+        // Transforms a point, including translation. Assumes an affine matrix.
+        constexpr Vector3d transformPoint(const Vector3d& aPoint) const {
+            return Vector3d(aPoint.x * elem[0][0] + aPoint.y * elem[1][0] + aPoint.z * elem[2][0] + elem[3][0],
+                            aPoint.x * elem[0][1] + aPoint.y * elem[1][1] + aPoint.z * elem[2][1] + elem[3][1],
+                            aPoint.x * elem[0][2] + aPoint.y * elem[1][2] + aPoint.z * elem[2][2] + elem[3][2]);
+        }
+
+        // Returns the matrix rounded to float precision. Only useful near the origin;
+        // far away use RebaseTransforms instead.
+        constexpr Matrix4x4f toMatrix4x4f() const {
+            return Matrix4x4f(
+                static_cast<float>(elem[0][0]), static_cast<float>(elem[0][1]), static_cast<float>(elem[0][2]), static_cast<float>(elem[0][3]),
+                static_cast<float>(elem[1][0]), static_cast<float>(elem[1][1]), static_cast<float>(elem[1][2]), static_cast<float>(elem[1][3]),
+                static_cast<float>(elem[2][0]), static_cast<float>(elem[2][1]), static_cast<float>(elem[2][2]), static_cast<float>(elem[2][3]),
+                static_cast<float>(elem[3][0]), static_cast<float>(elem[3][1]), static_cast<float>(elem[3][2]), static_cast<float>(elem[3][3]));
+        }
+
+        // Returns the identity matrix.
+        static constexpr Matrix4x4d Identity() {
+            return Matrix4x4d(1.0, 0.0, 0.0, 0.0,
+                              0.0, 1.0, 0.0, 0.0,
+                              0.0, 0.0, 1.0, 0.0,
+                              0.0, 0.0, 0.0, 1.0);
+        }
+
+        // Returns a matrix that translates by aTranslation.
+        static constexpr Matrix4x4d Translation(const Vector3d& aTranslation) {
+            return Matrix4x4d(1.0, 0.0, 0.0, 0.0,
+                              0.0, 1.0, 0.0, 0.0,
+                              0.0, 0.0, 1.0, 0.0,
+                              aTranslation.x, aTranslation.y, aTranslation.z, 1.0);
+        }
+
+        // Returns Scale(aScale) * Rotation(aRotation) * Translation(aTranslation). Rotation
+        // and scale stay float precision; only the translation needs the extra range.
+        static constexpr Matrix4x4d TRS(const Vector3d& aTranslation, const Quaternion& aRotation,
+                                        const Vector3f& aScale) {
+            const Matrix4x4f rotationScale = Matrix4x4f::TRS(Vector3f(), aRotation, aScale);
+            Matrix4x4d result(rotationScale);
+            result.elem[3][0] = aTranslation.x;
+            result.elem[3][1] = aTranslation.y;
+            result.elem[3][2] = aTranslation.z;
+            return result;
+        }
+
+        // Returns a view matrix for a camera at anEye looking towards aTarget.
+        static Matrix4x4d LookAt(const Vector3d& anEye, const Vector3d& aTarget, const Vector3d& anUp) {
+            const Vector3d zAxis = (aTarget - anEye).getNormalized();
+            const Vector3d xAxis = anUp.crossProduct(zAxis).getNormalized();
+            const Vector3d yAxis = zAxis.crossProduct(xAxis);
+
+            return Matrix4x4d(xAxis.x, yAxis.x, zAxis.x, 0.0,
+                              xAxis.y, yAxis.y, zAxis.y, 0.0,
+                              xAxis.z, yAxis.z, zAxis.z, 0.0,
+                              -xAxis.dot(anEye), -yAxis.dot(anEye), -zAxis.dot(anEye), 1.0);
+        }
+    };
+}
\ No newline at end of file
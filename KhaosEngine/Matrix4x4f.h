@@ -3,7 +3,9 @@
 #include "Common.h"     
 #include "CommonMath.h"
 
+#include "Vector3f.h"
 #include "Vector4f.h"
+#include "Quaternion.h"
  
 namespace KhaosMath
 {
@@ -17,31 +19,32 @@ namespace KhaosMath
         float elem[4][4];
 
         // Default constructor that zeros all elem.
-        Matrix4x4f() {
-            memset(elem, 0, sizeof(elem[0][0]) * 16);
-        }
+        constexpr Matrix4x4f()
+            : elem{ { 0.0f, 0.0f, 0.0f, 0.0f },
+                    { 0.0f, 0.0f, 0.0f, 0.0f },
+                    { 0.0f, 0.0f, 0.0f, 0.0f },
+                    { 0.0f, 0.0f, 0.0f, 0.0f } } { }
 
         // Constructor to explicitly initialize all elem.
-        Matrix4x4f(float a, float b, float c, float d,
+        constexpr Matrix4x4f(float a, float b, float c, float d,
             float e, float f, float g, float h,
             float i, float j, float k, float l,
-            float m, float n, float o, float p) {
-            elem[0][0] = a; elem[0][1] = b; elem[0][2] = c; elem[0][3] = d;
-            elem[1][0] = e; elem[1][1] = f; elem[1][2] = g; elem[1][3] = h;
-            elem[2][0] = i; elem[2][1] = j; elem[2][2] = k; elem[2][3] = l;
-            elem[3][0] = m; elem[3][1] = n; elem[3][2] = o; elem[3][3] = p;
-        }
+            float m, float n, float o, float p)
+            : elem{ { a, b, c, d },
+                    { e, f, g, h },
+                    { i, j, k, l },
+                    { m, n, o, p } } { }
 
-        float& operator() (K_INT aRow, K_INT aCol) {
+        constexpr float& operator() (K_INT aRow, K_INT aCol) {
             return elem[aRow][aCol];
         }
 
-        float operator() (K_INT aRow, K_INT aCol) const {
+        constexpr float operator() (K_INT aRow, K_INT aCol) const {
             return elem[aRow][aCol];
         }
 
         // Add two matrices together to create a new one.
-        Matrix4x4f operator+(const Matrix4x4f& other) const {
+        constexpr Matrix4x4f operator+(const Matrix4x4f& other) const {
             return Matrix4x4f(
                 elem[0][0] + other.elem[0][0], elem[0][1] + other.elem[0][1],
                 elem[0][2] + other.elem[0][2], elem[0][3] + other.elem[0][3],
@@ -54,7 +57,7 @@ namespace KhaosMath
         }
 
         // Add two matrices together to create a new one.
-        Matrix4x4f operator-(const Matrix4x4f& other) const {
+        constexpr Matrix4x4f operator-(const Matrix4x4f& other) const {
             return Matrix4x4f(
                 elem[0][0] - other.elem[0][0], elem[0][1] - other.elem[0][1],
                 elem[0][2] - other.elem[0][2], elem[0][3] - other.elem[0][3],
@@ -66,12 +69,12 @@ namespace KhaosMath
                 elem[3][2] - other.elem[3][2], elem[3][3] - other.elem[3][3]);
         }
 
-        Matrix4x4f operator*(const Matrix4x4f& other) const;
+        constexpr Matrix4x4f operator*(const Matrix4x4f& other) const;
 
         Matrix4x4f multiplyOne(const Matrix4x4f& other) const;
         Matrix4x4f multiplyTwo(const Matrix4x4f& other) const;
 
-        Matrix4x4f operator*(const float aScalar) const {
+        constexpr Matrix4x4f operator*(const float aScalar) const {
             return Matrix4x4f(
                 elem[0][0] * aScalar, elem[0][1] * aScalar,
                 elem[0][2] * aScalar, elem[0][3] * aScalar,
@@ -95,7 +98,7 @@ namespace KhaosMath
                 elem[3][2] / aScalar, elem[3][3] / aScalar);
         }
 
-        Matrix4x4f operator+=(const Matrix4x4f& other) {
+        Matrix4x4f& operator+=(const Matrix4x4f& other) {
             elem[0][0] += other.elem[0][0]; elem[0][1] += other.elem[0][1],
                 elem[0][2] += other.elem[0][2]; elem[0][3] += other.elem[0][3];
             elem[1][0] += other.elem[1][0]; elem[1][1] += other.elem[1][1];
@@ -107,7 +110,7 @@ namespace KhaosMath
             return *this;
         }
 
-        Matrix4x4f operator-=(const Matrix4x4f& other) {
+        Matrix4x4f& operator-=(const Matrix4x4f& other) {
             elem[0][0] -= other.elem[0][0]; elem[0][1] -= other.elem[0][1];
             elem[0][2] -= other.elem[0][2]; elem[0][3] -= other.elem[0][3];
             elem[1][0] -= other.elem[1][0]; elem[1][1] -= other.elem[1][1];
@@ -119,7 +122,7 @@ namespace KhaosMath
             return *this;
         }
 
-        Matrix4x4f operator*=(const float& aScalar) {
+        Matrix4x4f& operator*=(const float& aScalar) {
             elem[0][0] *= aScalar; elem[0][1] *= aScalar;
             elem[0][2] *= aScalar; elem[0][3] *= aScalar,
                 elem[1][0] *= aScalar; elem[1][1] *= aScalar,
@@ -131,7 +134,7 @@ namespace KhaosMath
             return *this;
         }
 
-        Matrix4x4f operator/=(const float& aScalar) {
+        Matrix4x4f& operator/=(const float& aScalar) {
             elem[0][0] /= aScalar; elem[0][1] /= aScalar;
             elem[0][2] /= aScalar; elem[0][3] /= aScalar,
                 elem[1][0] /= aScalar; elem[1][1] /= aScalar,
@@ -143,7 +146,7 @@ namespace KhaosMath
             return *this;
         }
 
-        bool operator==(const Matrix4x4f& other) {
+        constexpr bool operator==(const Matrix4x4f& other) const {
             return elem[0][0] == other.elem[0][0] && elem[0][1] == other.elem[0][1] &&
                 elem[0][2] == other.elem[0][2] && elem[0][3] == other.elem[0][3] &&
                 elem[1][0] == other.elem[1][0] && elem[1][1] == other.elem[1][1] &&
@@ -154,7 +157,7 @@ namespace KhaosMath
                 elem[3][2] == other.elem[3][2] && elem[3][3] == other.elem[3][3];
         }
 
-        bool operator!=(const Matrix4x4f& other) {
+        constexpr bool operator!=(const Matrix4x4f& other) const {
             return !(elem[0][0] == other.elem[0][0] && elem[0][1] == other.elem[0][1] &&
                 elem[0][2] == other.elem[0][2] && elem[0][3] == other.elem[0][3] &&
                 elem[1][0] == other.elem[1][0] && elem[1][1] == other.elem[1][1] &&
@@ -166,7 +169,7 @@ namespace KhaosMath
         }
 
         // Returns the transpose of this matrix. Does not modify the original matrix.
-        Matrix4x4f getTranspose() const {
+        constexpr Matrix4x4f getTranspose() const {
             return Matrix4x4f(elem[0][0], elem[1][0], elem[2][0], elem[3][0],
                 elem[0][1], elem[1][1], elem[2][1], elem[3][1],
                 elem[0][2], elem[1][2], elem[2][2], elem[3][2],
@@ -182,17 +185,136 @@ namespace KhaosMath
         }
 
         // Returns a row of this matrix as a vector.
-        Vector4f getRowVector(K_INT aRow) const;
+        constexpr Vector4f getRowVector(K_INT aRow) const;
 
         // Returns a column of this matrix as a vector.
-        Vector4f getColVector(K_INT aCol) const;
+        constexpr Vector4f getColVector(K_INT aCol) const;
 
         // Returns the identity matrix.
-        static Matrix4x4f Identity() { 
+        static constexpr Matrix4x4f Identity() {
             return Matrix4x4f(1.0f, 0.0f, 0.0f, 0.0f,
                              0.0f, 1.0f, 0.0f, 0.0f,
                              0.0f, 0.0f, 1.0f, 0.0f,
                              0.0f, 0.0f, 0.0f, 1.0f); 
         }
+
+        //
+        // Transform and camera builders.
+        // Vectors are rows multiplied on the left (v * M), so translation lives in row 3 and
+        // transforms compose left to right. Cameras are left-handed, looking down +z, and
+        // projections map depth into the [0, 1] range.
+        //
+
+        // Returns a matrix that translates by aTranslation.
+        static constexpr Matrix4x4f Translation(const Vector3f& aTranslation) {
+            return Matrix4x4f(1.0f, 0.0f, 0.0f, 0.0f,
+                              0.0f, 1.0f, 0.0f, 0.0f,
+                              0.0f, 0.0f, 1.0f, 0.0f,
+                              aTranslation.x, aTranslation.y, aTranslation.z, 1.0f);
+        }
+
+        // Returns a matrix that scales each axis by the matching component of aScale.
+        static constexpr Matrix4x4f Scale(const Vector3f& aScale) {
+            return Matrix4x4f(aScale.x, 0.0f, 0.0f, 0.0f,
+                              0.0f, aScale.y, 0.0f, 0.0f,
+                              0.0f, 0.0f, aScale.z, 0.0f,
+                              0.0f, 0.0f, 0.0f, 1.0f);
+        }
+
+        // Returns the rotation performed by a unit quaternion, matching q * v * q^-1.
+        static constexpr Matrix4x4f Rotation(const Quaternion& aRotation) {
+            return TRS(Vector3f(), aRotation, Vector3f(1.0f, 1.0f, 1.0f));
+        }
+
+        // Returns Scale(aScale) * Rotation(aRotation) * Translation(aTranslation), written
+        // directly from the quaternion without building or multiplying the three factors.
+        static constexpr Matrix4x4f TRS(const Vector3f& aTranslation, const Quaternion& aRotation,
+                                        const Vector3f& aScale) {
+            const float x2 = aRotation.x + aRotation.x;
+            const float y2 = aRotation.y + aRotation.y;
+            const float z2 = aRotation.z + aRotation.z;
+            const float xx = aRotation.x * x2, xy = aRotation.x * y2, xz = aRotation.x * z2;
+            const float yy = aRotation.y * y2, yz = aRotation.y * z2, zz = aRotation.z * z2;
+            const float wx = aRotation.w * x2, wy = aRotation.w * y2, wz = aRotation.w * z2;
+
+            return Matrix4x4f(
+                (1.0f - (yy + zz)) * aScale.x, (xy + wz) * aScale.x, (xz - wy) * aScale.x, 0.0f,
+                (xy - wz) * aScale.y, (1.0f - (xx + zz)) * aScale.y, (yz + wx) * aScale.y, 0.0f,
+                (xz + wy) * aScale.z, (yz - wx) * aScale.z, (1.0f - (xx + yy)) * aScale.z, 0.0f,
+                aTranslation.x, aTranslation.y, aTranslation.z, 1.0f);
+        }
+
+        // Overwrites this matrix with TRS(aTranslation, aRotation, aScale).
+        void setToTRS(const Vector3f& aTranslation, const Quaternion& aRotation, const Vector3f& aScale) {
+            (*this) = TRS(aTranslation, aRotation, aScale);
+        }
+
+        // Returns a view matrix for a camera at anEye looking towards aTarget.
+        static Matrix4x4f LookAt(const Vector3f& anEye, const Vector3f& aTarget, const Vector3f& anUp) {
+            const Vector3f zAxis = (aTarget - anEye).getNormalized();
+            const Vector3f xAxis = anUp.crossProduct(zAxis).getNormalized();
+            const Vector3f yAxis = zAxis.crossProduct(xAxis);
+
+            return Matrix4x4f(xAxis.x, yAxis.x, zAxis.x, 0.0f,
+                              xAxis.y, yAxis.y, zAxis.y, 0.0f,
+                              xAxis.z, yAxis.z, zAxis.z, 0.0f,
+                              -xAxis.dot(anEye), -yAxis.dot(anEye), -zAxis.dot(anEye), 1.0f);
+        }
+
+        // Returns a perspective projection mapping aNear to depth 0 and aFar to depth 1.
+        // aFovY is the full vertical field of view in radians.
+        static Matrix4x4f Perspective(float aFovY, float anAspect, float aNear, float aFar) {
+            ASSERT(aNear > 0.0f && aFar > aNear);
+            const float yScale = 1.0f / tanf(aFovY * 0.5f);
+            const float depthScale = aFar / (aFar - aNear);
+            return Matrix4x4f(yScale / anAspect, 0.0f, 0.0f, 0.0f,
+                              0.0f, yScale, 0.0f, 0.0f,
+                              0.0f, 0.0f, depthScale, 1.0f,
+                              0.0f, 0.0f, -aNear * depthScale, 0.0f);
+        }
+
+        // Returns a perspective projection mapping aNear to depth 1 and aFar to depth 0.
+        // Reversing depth spreads float precision evenly across the view distance;
+        // pair it with a greater-than depth test and a depth clear to 0.
+        static Matrix4x4f PerspectiveReversedZ(float aFovY, float anAspect, float aNear, float aFar) {
+            ASSERT(aNear > 0.0f && aFar > aNear);
+            const float yScale = 1.0f / tanf(aFovY * 0.5f);
+            const float depthScale = aNear / (aNear - aFar);
+            return Matrix4x4f(yScale / anAspect, 0.0f, 0.0f, 0.0f,
+                              0.0f, yScale, 0.0f, 0.0f,
+                              0.0f, 0.0f, depthScale, 1.0f,
+                              0.0f, 0.0f, -aFar * depthScale, 0.0f);
+        }
+
+        // Returns a perspective projection with the far plane at infinity, aNear mapping to depth 0.
+        static Matrix4x4f PerspectiveInfinite(float aFovY, float anAspect, float aNear) {
+            ASSERT(aNear > 0.0f);
+            const float yScale = 1.0f / tanf(aFovY * 0.5f);
+            return Matrix4x4f(yScale / anAspect, 0.0f, 0.0f, 0.0f,
+                              0.0f, yScale, 0.0f, 0.0f,
+                              0.0f, 0.0f, 1.0f, 1.0f,
+                              0.0f, 0.0f, -aNear, 0.0f);
+        }
+
+        // Returns a reversed-Z perspective projection with the far plane at infinity.
+        // Depth is simply aNear / z, the best precision distribution available for floats.
+        static Matrix4x4f PerspectiveInfiniteReversedZ(float aFovY, float anAspect, float aNear) {
+            ASSERT(aNear > 0.0f);
+            const float yScale = 1.0f / tanf(aFovY * 0.5f);
+            return Matrix4x4f(yScale / anAspect, 0.0f, 0.0f, 0.0f,
+                              0.0f, yScale, 0.0f, 0.0f,
+                              0.0f, 0.0f, 0.0f, 1.0f,
+                              0.0f, 0.0f, aNear, 0.0f);
+        }
+
+        // Returns an orthographic projection of the given view volume, aNear mapping to depth 0.
+        static constexpr Matrix4x4f Orthographic(float aLeft, float aRight, float aBottom, float aTop,
+                                                 float aNear, float aFar) {
+            return Matrix4x4f(2.0f / (aRight - aLeft), 0.0f, 0.0f, 0.0f,
+                              0.0f, 2.0f / (aTop - aBottom), 0.0f, 0.0f,
+                              0.0f, 0.0f, 1.0f / (aFar - aNear), 0.0f,
+                              (aLeft + aRight) / (aLeft - aRight), (aTop + aBottom) / (aBottom - aTop),
+                              aNear / (aNear - aFar), 1.0f);
+        }
     };
 }
\ No newline at end of file
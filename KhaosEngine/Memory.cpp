@@ -0,0 +1,116 @@
+// Memory.cpp
+// Aligned heap entry point and, when MEMORY_TRACKING_ENABLED is set, replacements for the
+// global operator new/delete that count every heap allocation made by the process.
+
+#include "Memory.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <malloc.h>
+
+namespace
+{
+    // Zero initialized before any dynamic initializer runs, so early allocations are counted safely.
+    std::atomic<KUI_64> sAllocationCount;
+    std::atomic<KUI_64> sFreeCount;
+    std::atomic<KUI_64> sBytesAllocated;
+
+    inline void recordAllocation(size_t aSize) {
+#if MEMORY_TRACKING_ENABLED
+        sAllocationCount.fetch_add(1, std::memory_order_relaxed);
+        sBytesAllocated.fetch_add(aSize, std::memory_order_relaxed);
+#else
+        (void)aSize;
+#endif
+    }
+
+    inline void recordFree() {
+#if MEMORY_TRACKING_ENABLED
+        sFreeCount.fetch_add(1, std::memory_order_relaxed);
+#endif
+    }
+}
+
+namespace KhaosEngine
+{
+    void* AlignedAlloc(size_t aSize, size_t aAlignment) {
+        ASSERT((aAlignment & (aAlignment - 1)) == 0);
+        recordAllocation(aSize);
+        return _aligned_malloc(aSize, aAlignment);
+    }
+
+    void AlignedFree(void* aPointer) {
+        if (!aPointer)
+            return;
+        recordFree();
+        _aligned_free(aPointer);
+    }
+
+    HeapStats GetHeapStats() {
+        HeapStats stats;
+        stats.allocationCount = sAllocationCount.load(std::memory_order_relaxed);
+        stats.freeCount = sFreeCount.load(std::memory_order_relaxed);
+        stats.bytesAllocated = sBytesAllocated.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    KUI_64 GetHeapAllocationCount() {
+        return sAllocationCount.load(std::memory_order_relaxed);
+    }
+}
+
+#if MEMORY_TRACKING_ENABLED
+
+//
+// Global operator new/delete replacements. These only add counting on top of malloc/free.
+//
+
+void* operator new(size_t aSize) {
+    recordAllocation(aSize);
+    void* memory = malloc(aSize ? aSize : 1);
+    if (!memory)
+        throw std::bad_alloc();
+    return memory;
+}
+
+void* operator new[](size_t aSize) {
+    return operator new(aSize);
+}
+
+void* operator new(size_t aSize, const std::nothrow_t&) throw() {
+    recordAllocation(aSize);
+    return malloc(aSize ? aSize : 1);
+}
+
+void* operator new[](size_t aSize, const std::nothrow_t& aNoThrow) throw() {
+    return operator new(aSize, aNoThrow);
+}
+
+void operator delete(void* aPointer) throw() {
+    if (!aPointer)
+        return;
+    recordFree();
+    free(aPointer);
+}
+
+void operator delete[](void* aPointer) throw() {
+    operator delete(aPointer);
+}
+
+void operator delete(void* aPointer, size_t) throw() {
+    operator delete(aPointer);
+}
+
+void operator delete[](void* aPointer, size_t) throw() {
+    operator delete(aPointer);
+}
+
+void operator delete(void* aPointer, const std::nothrow_t&) throw() {
+    operator delete(aPointer);
+}
+
+void operator delete[](void* aPointer, const std::nothrow_t&) throw() {
+    operator delete(aPointer);
+}
+
+#endif
\ No newline at end of file
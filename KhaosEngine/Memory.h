@@ -0,0 +1,52 @@
+#pragma once
+
+// Memory.h
+// Alignment helpers, the engine's aligned heap entry point and heap allocation tracking.
+// Every KhaosEngine allocator gets its backing storage through AlignedAlloc once at startup,
+// after which frames are expected to run without touching the global heap.
+
+#include "Common.h"
+
+#include <cstddef>
+#include <new>
+
+namespace KhaosEngine
+{
+    // Alignment required by __declspec(align(16)) types such as Vector4f, Quaternion and Matrix4x4f.
+    const size_t SIMD_ALIGNMENT = 16;
+
+    // Alignment required for 256-bit AVX loads and stores.
+    const size_t AVX_ALIGNMENT = 32;
+
+    // Rounds a size or address up to the next multiple of aAlignment, which must be a power of two.
+    inline size_t AlignUp(size_t aValue, size_t aAlignment) {
+        ASSERT((aAlignment & (aAlignment - 1)) == 0);
+        return (aValue + aAlignment - 1) & ~(aAlignment - 1);
+    }
+
+    // Determine if a pointer is aligned to aAlignment, which must be a power of two.
+    inline bool IsAligned(const void* aPointer, size_t aAlignment) {
+        return (reinterpret_cast<size_t>(aPointer) & (aAlignment - 1)) == 0;
+    }
+
+    // Allocates aSize bytes from the heap aligned to aAlignment. Counted by the heap tracker.
+    void* AlignedAlloc(size_t aSize, size_t aAlignment);
+
+    // Frees memory returned by AlignedAlloc.
+    void AlignedFree(void* aPointer);
+
+    // Snapshot of heap activity since startup.
+    // Counters only advance while MEMORY_TRACKING_ENABLED is set, otherwise they stay at zero.
+    struct HeapStats
+    {
+        KUI_64 allocationCount;
+        KUI_64 freeCount;
+        KUI_64 bytesAllocated;
+    };
+
+    // Returns the current heap counters.
+    HeapStats GetHeapStats();
+
+    // Returns the number of heap allocations made since startup.
+    KUI_64 GetHeapAllocationCount();
+}
\ No newline at end of file
@@ -0,0 +1,491 @@
+// MeshOptimizer.cpp
+// Tipsify triangle ordering, vertex fetch remapping and quadric error simplification.
+
+#include "MeshOptimizer.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    using namespace KhaosEngine;
+
+    // Weight of the planes that hold open borders in place, relative to the surface.
+    const float BORDER_WEIGHT = 10.0f;
+
+    // Squared cosine of the largest turn a collapse may give a triangle.
+    const float FLIP_COSINE_SQUARED = 0.25f;
+
+    // Returns the largest side of the bounding box of somePositions and sets aMinimum to its corner.
+    float meshExtent(const Vector3f* somePositions, K_UINT aVertexCount, Vector3f& aMinimum) {
+        Vector3f minimum = aVertexCount ? somePositions[0] : Vector3f();
+        Vector3f maximum = minimum;
+        for (K_UINT vertex = 1; vertex < aVertexCount; ++vertex) {
+            minimum = Vector3f(std::min(minimum.x, somePositions[vertex].x), std::min(minimum.y, somePositions[vertex].y),
+                               std::min(minimum.z, somePositions[vertex].z));
+            maximum = Vector3f(std::max(maximum.x, somePositions[vertex].x), std::max(maximum.y, somePositions[vertex].y),
+                               std::max(maximum.z, somePositions[vertex].z));
+        }
+        aMinimum = minimum;
+        return std::max(maximum.x - minimum.x, std::max(maximum.y - minimum.y, maximum.z - minimum.z));
+    }
+
+    // Triangles touching each vertex, as offsets into a shared list.
+    struct VertexAdjacency
+    {
+        std::vector<K_UINT> offsets; // aVertexCount + 1 entries.
+        std::vector<K_UINT> triangles;
+    };
+
+    void buildAdjacency(const KUI_32* someIndices, K_UINT anIndexCount, K_UINT aVertexCount, VertexAdjacency& anAdjacency) {
+        anAdjacency.offsets.assign(aVertexCount + 1, 0);
+        for (K_UINT i = 0; i < anIndexCount; ++i)
+            ++anAdjacency.offsets[someIndices[i] + 1];
+        for (K_UINT vertex = 0; vertex < aVertexCount; ++vertex)
+            anAdjacency.offsets[vertex + 1] += anAdjacency.offsets[vertex];
+
+        anAdjacency.triangles.resize(anIndexCount);
+        std::vector<K_UINT> cursor(anAdjacency.offsets.begin(), anAdjacency.offsets.end() - 1);
+        for (K_UINT i = 0; i < anIndexCount; ++i)
+            anAdjacency.triangles[cursor[someIndices[i]]++] = i / 3;
+    }
+
+    // Sum of squared distances to weighted planes: p^T A p + 2 b.p + c, with A symmetric.
+    struct Quadric
+    {
+        float a00, a11, a22, a10, a20, a21;
+        float b0, b1, b2;
+        float c;
+        float weight;
+
+        Quadric()
+            : a00(0), a11(0), a22(0), a10(0), a20(0), a21(0), b0(0), b1(0), b2(0), c(0), weight(0) { }
+
+        // Adds the plane through aPoint with unit aNormal.
+        void addPlane(const Vector3f& aNormal, const Vector3f& aPoint, float aWeight) {
+            const float d = -aNormal.dot(aPoint);
+            a00 += aWeight * aNormal.x * aNormal.x;
+            a11 += aWeight * aNormal.y * aNormal.y;
+            a22 += aWeight * aNormal.z * aNormal.z;
+            a10 += aWeight * aNormal.y * aNormal.x;
+            a20 += aWeight * aNormal.z * aNormal.x;
+            a21 += aWeight * aNormal.z * aNormal.y;
+            b0 += aWeight * aNormal.x * d;
+            b1 += aWeight * aNormal.y * d;
+            b2 += aWeight * aNormal.z * d;
+            c += aWeight * d * d;
+            weight += aWeight;
+        }
+
+        Quadric& operator+=(const Quadric& other) {
+            a00 += other.a00; a11 += other.a11; a22 += other.a22;
+            a10 += other.a10; a20 += other.a20; a21 += other.a21;
+            b0 += other.b0; b1 += other.b1; b2 += other.b2;
+            c += other.c;
+            weight += other.weight;
+            return *this;
+        }
+
+        // Returns the weighted mean squared distance from aPoint to the planes.
+        float evaluate(const Vector3f& aPoint) const {
+            const float x = aPoint.x, y = aPoint.y, z = aPoint.z;
+            const float sum = a00 * x * x + a11 * y * y + a22 * z * z +
+                              2.0f * (a10 * x * y + a20 * x * z + a21 * y * z) +
+                              2.0f * (b0 * x + b1 * y + b2 * z) + c;
+            return weight > 0.0f ? fabsf(sum) / weight : 0.0f;
+        }
+    };
+
+    struct Collapse
+    {
+        KUI_32 from;
+        KUI_32 to;
+        float cost;
+        bool border;
+
+        bool operator<(const Collapse& other) const {
+            return cost < other.cost;
+        }
+    };
+
+    // Returns true if a triangle has the directed edge aFrom to aTo. Edges with no twin running
+    // the other way are open borders.
+    bool hasEdge(const KUI_32* someIndices, const VertexAdjacency& anAdjacency, KUI_32 aFrom, KUI_32 aTo) {
+        for (K_UINT i = anAdjacency.offsets[aFrom]; i < anAdjacency.offsets[aFrom + 1]; ++i) {
+            const KUI_32* triangle = someIndices + anAdjacency.triangles[i] * 3;
+            if ((triangle[0] == aFrom && triangle[1] == aTo) || (triangle[1] == aFrom && triangle[2] == aTo) ||
+                (triangle[2] == aFrom && triangle[0] == aTo))
+                return true;
+        }
+        return false;
+    }
+
+    // Returns true if moving aFrom onto aTo would turn any surviving triangle around aFrom by
+    // more than 60 degrees. Small turns add up over many collapses, so a plain sign check
+    // still lets folds through.
+    bool collapseFlips(const KUI_32* someIndices, const Vector3f* somePositions, const VertexAdjacency& anAdjacency,
+                       KUI_32 aFrom, KUI_32 aTo) {
+        for (K_UINT i = anAdjacency.offsets[aFrom]; i < anAdjacency.offsets[aFrom + 1]; ++i) {
+            const KUI_32* triangle = someIndices + anAdjacency.triangles[i] * 3;
+            if (triangle[0] == aTo || triangle[1] == aTo || triangle[2] == aTo)
+                continue;
+            Vector3f corners[3] = { somePositions[triangle[0]], somePositions[triangle[1]], somePositions[triangle[2]] };
+            const Vector3f before = (corners[1] - corners[0]).crossProduct(corners[2] - corners[0]);
+            for (K_UINT corner = 0; corner < 3; ++corner)
+                if (triangle[corner] == aFrom)
+                    corners[corner] = somePositions[aTo];
+            const Vector3f after = (corners[1] - corners[0]).crossProduct(corners[2] - corners[0]);
+            const float alignment = before.dot(after);
+            if (alignment * fabsf(alignment) <= FLIP_COSINE_SQUARED * before.getMagnitudeSquared() * after.getMagnitudeSquared() &&
+                before.getMagnitudeSquared() > 0.0f)
+                return true;
+        }
+        return false;
+    }
+
+    // Tipsify's choice of the next fanning vertex: the candidate still in cache the longest
+    // that will not be evicted by its own remaining triangles, else a recent dead end, else
+    // the next vertex in order with triangles left. Returns -1 when every triangle is out.
+    K_INT nextFanningVertex(const std::vector<KUI_32>& someCandidates, const std::vector<K_UINT>& someLiveCounts,
+                            const std::vector<K_UINT>& someCacheTimes, K_UINT aTime, K_UINT aCacheSize,
+                            std::vector<KUI_32>& aDeadEndStack, K_UINT& anInputCursor) {
+        K_INT best = -1;
+        K_INT bestPriority = -1;
+        for (KUI_32 vertex : someCandidates) {
+            if (someLiveCounts[vertex] == 0)
+                continue;
+            K_INT priority = 0;
+            if (aTime - someCacheTimes[vertex] + 2 * someLiveCounts[vertex] <= aCacheSize)
+                priority = static_cast<K_INT>(aTime - someCacheTimes[vertex]);
+            if (priority > bestPriority) {
+                best = static_cast<K_INT>(vertex);
+                bestPriority = priority;
+            }
+        }
+        if (best >= 0)
+            return best;
+
+        while (!aDeadEndStack.empty()) {
+            const KUI_32 vertex = aDeadEndStack.back();
+            aDeadEndStack.pop_back();
+            if (someLiveCounts[vertex] > 0)
+                return static_cast<K_INT>(vertex);
+        }
+        for (; anInputCursor < someLiveCounts.size(); ++anInputCursor)
+            if (someLiveCounts[anInputCursor] > 0)
+                return static_cast<K_INT>(anInputCursor);
+        return -1;
+    }
+}
+
+namespace KhaosEngine
+{
+    //
+    // Vertex cache function definitions.
+    //
+
+    VertexCacheMetrics AnalyzeVertexCache(const KUI_32* someIndices, K_UINT anIndexCount, K_UINT aVertexCount,
+                                          K_UINT aCacheSize) {
+        // A vertex is cached while fewer than aCacheSize misses have happened since it was loaded.
+        std::vector<K_UINT> loadTimes(aVertexCount, 0);
+        std::vector<bool> used(aVertexCount, false);
+        K_UINT misses = 0;
+        K_UINT uniqueCount = 0;
+        for (K_UINT i = 0; i < anIndexCount; ++i) {
+            const KUI_32 vertex = someIndices[i];
+            if (!used[vertex]) {
+                used[vertex] = true;
+                ++uniqueCount;
+            }
+            else if (misses - loadTimes[vertex] < aCacheSize) {
+                continue;
+            }
+            loadTimes[vertex] = misses++;
+        }
+
+        VertexCacheMetrics metrics;
+        metrics.triangleCount = anIndexCount / 3;
+        metrics.transformCount = misses;
+        metrics.acmr = metrics.triangleCount ? static_cast<float>(misses) / metrics.triangleCount : 0.0f;
+        metrics.atvr = uniqueCount ? static_cast<float>(misses) / uniqueCount : 0.0f;
+        return metrics;
+    }
+
+    void OptimizeVertexCache(const KUI_32* someIndices, K_UINT anIndexCount, K_UINT aVertexCount, K_UINT aCacheSize,
+                             KUI_32* someResult) {
+        ASSERT(anIndexCount % 3 == 0 && someResult != someIndices);
+        VertexAdjacency adjacency;
+        buildAdjacency(someIndices, anIndexCount, aVertexCount, adjacency);
+
+        std::vector<K_UINT> liveCounts(aVertexCount);
+        for (K_UINT vertex = 0; vertex < aVertexCount; ++vertex)
+            liveCounts[vertex] = adjacency.offsets[vertex + 1] - adjacency.offsets[vertex];
+        std::vector<K_UINT> cacheTimes(aVertexCount, 0);
+        std::vector<bool> emitted(anIndexCount / 3, false);
+        std::vector<KUI_32> deadEndStack;
+        std::vector<KUI_32> candidates;
+        deadEndStack.reserve(anIndexCount);
+
+        K_UINT time = aCacheSize + 1;
+        K_UINT inputCursor = 0;
+        K_UINT written = 0;
+        K_INT fan = nextFanningVertex(candidates, liveCounts, cacheTimes, time, aCacheSize, deadEndStack, inputCursor);
+        while (fan >= 0) {
+            // Emit every remaining triangle around the fanning vertex.
+            candidates.clear();
+            for (K_UINT i = adjacency.offsets[fan]; i < adjacency.offsets[fan + 1]; ++i) {
+                const K_UINT triangle = adjacency.triangles[i];
+                if (emitted[triangle])
+                    continue;
+                emitted[triangle] = true;
+                for (K_UINT corner = 0; corner < 3; ++corner) {
+                    const KUI_32 vertex = someIndices[triangle * 3 + corner];
+                    someResult[written++] = vertex;
+                    deadEndStack.push_back(vertex);
+                    candidates.push_back(vertex);
+                    --liveCounts[vertex];
+                    if (time - cacheTimes[vertex] > aCacheSize)
+                        cacheTimes[vertex] = time++;
+                }
+            }
+            fan = nextFanningVertex(candidates, liveCounts, cacheTimes, time, aCacheSize, deadEndStack, inputCursor);
+        }
+        ASSERT(written == anIndexCount);
+    }
+
+    //
+    // Vertex fetch function definitions.
+    //
+
+    K_UINT BuildVertexFetchRemap(KUI_32* someIndices, K_UINT anIndexCount, K_UINT aVertexCount, KUI_32* aRemap) {
+        std::fill(aRemap, aRemap + aVertexCount, UNUSED_VERTEX);
+        KUI_32 nextVertex = 0;
+        for (K_UINT i = 0; i < anIndexCount; ++i) {
+            KUI_32& index = someIndices[i];
+            if (aRemap[index] == UNUSED_VERTEX)
+                aRemap[index] = nextVertex++;
+            index = aRemap[index];
+        }
+        return nextVertex;
+    }
+
+    void RemapVertices(const Vector3f* somePositions, K_UINT aVertexCount, const KUI_32* aRemap, Vector3f* someResult) {
+        for (K_UINT vertex = 0; vertex < aVertexCount; ++vertex)
+            if (aRemap[vertex] != UNUSED_VERTEX)
+                someResult[aRemap[vertex]] = somePositions[vertex];
+    }
+
+    //
+    // Simplification function definitions.
+    //
+
+    K_UINT SimplifyMesh(const KUI_32* someIndices, K_UINT anIndexCount, const Vector3f* somePositions,
+                        K_UINT aVertexCount, K_UINT aTargetIndexCount, float aMaxError, KUI_32* someResult,
+                        float* anError) {
+        ASSERT(anIndexCount % 3 == 0);
+        std::vector<KUI_32> indices(someIndices, someIndices + anIndexCount);
+        K_UINT indexCount = anIndexCount;
+
+        // Work in the unit cube so errors and weights stay in a comfortable float range.
+        Vector3f minimum;
+        const float extent = meshExtent(somePositions, aVertexCount, minimum);
+        const float scale = extent > 0.0f ? 1.0f / extent : 1.0f;
+        std::vector<Vector3f> positions(aVertexCount);
+        for (K_UINT vertex = 0; vertex < aVertexCount; ++vertex)
+            positions[vertex] = (somePositions[vertex] - minimum) * scale;
+
+        VertexAdjacency adjacency;
+        buildAdjacency(indices.data(), indexCount, aVertexCount, adjacency);
+
+        // Every vertex starts with the planes of its triangles, weighted by area. Border edges
+        // add a plane perpendicular to the surface so the outline cannot shrink.
+        std::vector<Quadric> quadrics(aVertexCount);
+        std::vector<bool> borderVertices(aVertexCount, false);
+        for (K_UINT triangle = 0; triangle < indexCount / 3; ++triangle) {
+            const KUI_32* corners = &indices[triangle * 3];
+            const Vector3f normal = (positions[corners[1]] - positions[corners[0]]).crossProduct(
+                positions[corners[2]] - positions[corners[0]]);
+            const float length = normal.getMagnitude();
+            if (length == 0.0f)
+                continue;
+            const Vector3f unitNormal = normal / length;
+            for (K_UINT corner = 0; corner < 3; ++corner)
+                quadrics[corners[corner]].addPlane(unitNormal, positions[corners[0]], length * 0.5f);
+
+            for (K_UINT corner = 0; corner < 3; ++corner) {
+                const KUI_32 from = corners[corner];
+                const KUI_32 to = corners[(corner + 1) % 3];
+                if (hasEdge(indices.data(), adjacency, to, from))
+                    continue;
+                const Vector3f edge = positions[to] - positions[from];
+                const Vector3f borderNormal = edge.crossProduct(unitNormal).getNormalized();
+                const float weight = edge.getMagnitudeSquared() * BORDER_WEIGHT;
+                quadrics[from].addPlane(borderNormal, positions[from], weight);
+                quadrics[to].addPlane(borderNormal, positions[from], weight);
+                borderVertices[from] = true;
+                borderVertices[to] = true;
+            }
+        }
+
+        const float costLimit = aMaxError * scale * aMaxError * scale;
+        float largestCost = 0.0f;
+        std::vector<Collapse> collapses;
+        std::vector<KUI_32> remap(aVertexCount);
+        std::vector<bool> locked(aVertexCount);
+
+        while (indexCount > aTargetIndexCount) {
+            if (indexCount != anIndexCount)
+                buildAdjacency(indices.data(), indexCount, aVertexCount, adjacency);
+
+            // Cheapest direction of every edge. Border vertices only slide along the border.
+            collapses.clear();
+            for (K_UINT i = 0; i < indexCount; ++i) {
+                const KUI_32 a = indices[i];
+                const KUI_32 b = indices[i - i % 3 + (i + 1) % 3];
+                const bool border = !hasEdge(indices.data(), adjacency, b, a);
+                if (!border && a > b)
+                    continue;
+                Quadric combined = quadrics[a];
+                combined += quadrics[b];
+                Collapse collapse;
+                collapse.border = border;
+                collapse.cost = -1.0f;
+                if (!borderVertices[a] || border) {
+                    collapse.from = a;
+                    collapse.to = b;
+                    collapse.cost = combined.evaluate(positions[b]);
+                }
+                if (!borderVertices[b] || border) {
+                    const float cost = combined.evaluate(positions[a]);
+                    if (collapse.cost < 0.0f || cost < collapse.cost) {
+                        collapse.from = b;
+                        collapse.to = a;
+                        collapse.cost = cost;
+                    }
+                }
+                if (collapse.cost >= 0.0f)
+                    collapses.push_back(collapse);
+            }
+            std::sort(collapses.begin(), collapses.end());
+
+            // Apply the cheapest collapses whose neighbourhoods do not overlap, so each can be
+            // checked against the mesh as it was at the start of the pass.
+            for (K_UINT vertex = 0; vertex < aVertexCount; ++vertex)
+                remap[vertex] = vertex;
+            std::fill(locked.begin(), locked.end(), false);
+            const K_UINT trianglesToRemove = (indexCount - aTargetIndexCount + 2) / 3;
+            K_UINT trianglesRemoved = 0;
+            K_UINT applied = 0;
+            for (const Collapse& collapse : collapses) {
+                if (trianglesRemoved >= trianglesToRemove || collapse.cost > costLimit)
+                    break;
+                if (locked[collapse.from] || locked[collapse.to] ||
+                    collapseFlips(indices.data(), positions.data(), adjacency, collapse.from, collapse.to))
+                    continue;
+
+                remap[collapse.from] = collapse.to;
+                quadrics[collapse.to] += quadrics[collapse.from];
+                for (K_UINT i = adjacency.offsets[collapse.from]; i < adjacency.offsets[collapse.from + 1]; ++i)
+                    for (K_UINT corner = 0; corner < 3; ++corner)
+                        locked[indices[adjacency.triangles[i] * 3 + corner]] = true;
+                largestCost = std::max(largestCost, collapse.cost);
+                trianglesRemoved += collapse.border ? 1 : 2;
+                ++applied;
+            }
+            if (applied == 0)
+                break;
+
+            K_UINT kept = 0;
+            for (K_UINT i = 0; i < indexCount; i += 3) {
+                const KUI_32 a = remap[indices[i]];
+                const KUI_32 b = remap[indices[i + 1]];
+                const KUI_32 c = remap[indices[i + 2]];
+                if (a == b || b == c || a == c)
+                    continue;
+                indices[kept++] = a;
+                indices[kept++] = b;
+                indices[kept++] = c;
+            }
+            indexCount = kept;
+        }
+
+        std::copy(indices.begin(), indices.begin() + indexCount, someResult);
+        if (anError)
+            *anError = sqrtf(largestCost) / scale;
+        return indexCount;
+    }
+
+    //
+    // Pipeline function definitions.
+    //
+
+    void ProcessMesh(const Vector3f* somePositions, K_UINT aVertexCount, const KUI_32* someIndices, K_UINT anIndexCount,
+                     const MeshProcessingSettings& someSettings, ProcessedMesh& aResult) {
+        ASSERT(someSettings.levelCount > 0);
+        aResult.sourceMetrics = AnalyzeVertexCache(someIndices, anIndexCount, aVertexCount, someSettings.cacheSize);
+
+        Vector3f minimum;
+        const float extent = meshExtent(somePositions, aVertexCount, minimum);
+        const float maxError = someSettings.maxError * extent;
+
+        // Each level simplifies the one before it, so errors add up along the chain. A level
+        // that cannot get close to its target within maxError ends the chain.
+        aResult.levels.clear();
+        aResult.levels.resize(1);
+        aResult.levels[0].indices.assign(someIndices, someIndices + anIndexCount);
+        aResult.levels[0].error = 0.0f;
+        std::vector<KUI_32> simplified(anIndexCount);
+        while (aResult.levels.size() < someSettings.levelCount) {
+            const MeshLevel& previous = aResult.levels.back();
+            const K_UINT previousCount = static_cast<K_UINT>(previous.indices.size());
+            const K_UINT target = static_cast<K_UINT>(previousCount / 3 * someSettings.levelReduction) * 3;
+            float error = 0.0f;
+            const K_UINT count = SimplifyMesh(previous.indices.data(), previousCount, somePositions, aVertexCount, target,
+                                              std::max(maxError - previous.error, 0.0f), simplified.data(), &error);
+            if (count == 0 || count > target + (previousCount - target) / 2)
+                break;
+            MeshLevel level;
+            level.indices.assign(simplified.begin(), simplified.begin() + count);
+            level.error = previous.error + error;
+            aResult.levels.push_back(level);
+        }
+
+        for (MeshLevel& level : aResult.levels) {
+            OptimizeVertexCache(level.indices.data(), static_cast<K_UINT>(level.indices.size()), aVertexCount,
+                                someSettings.cacheSize, simplified.data());
+            std::copy(simplified.begin(), simplified.begin() + level.indices.size(), level.indices.begin());
+        }
+
+        // Collapses only move onto existing vertices, so the finest level uses every vertex
+        // any level does and its first use order serves them all.
+        aResult.remap.resize(aVertexCount);
+        std::vector<KUI_32>& finest = aResult.levels[0].indices;
+        const K_UINT usedCount = BuildVertexFetchRemap(finest.data(), static_cast<K_UINT>(finest.size()), aVertexCount,
+                                                       aResult.remap.data());
+        for (size_t level = 1; level < aResult.levels.size(); ++level)
+            for (KUI_32& index : aResult.levels[level].indices)
+                index = aResult.remap[index];
+        aResult.positions.resize(usedCount);
+        RemapVertices(somePositions, aVertexCount, aResult.remap.data(), aResult.positions.data());
+
+        for (MeshLevel& level : aResult.levels)
+            level.metrics = AnalyzeVertexCache(level.indices.data(), static_cast<K_UINT>(level.indices.size()), usedCount,
+                                               someSettings.cacheSize);
+    }
+
+    void ProcessMeshesParallel(const MeshProcessingJob* someJobs, K_UINT aJobCount,
+                               const MeshProcessingSettings& someSettings, K_UINT aThreadCount) {
+        const auto processJob = [&](K_UINT aJob) {
+            const MeshProcessingJob& job = someJobs[aJob];
+            ProcessMesh(job.positions, job.vertexCount, job.indices, job.indexCount, someSettings, *job.result);
+        };
+        if (aThreadCount > 1) {
+            WorkerPool::Shared().forEach(aJobCount, processJob);
+        }
+        else {
+            for (K_UINT job = 0; job < aJobCount; ++job)
+                processJob(job);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,114 @@
+#pragma once
+
+// MeshOptimizer.h
+// Load time processing of indexed triangle meshes before they reach the renderers. Author
+// order meshes transform most vertices several times and have no cheaper versions for far
+// away objects, so each mesh is run through:
+//
+//     1. SimplifyMesh, repeatedly, for a chain of levels of detail. Quadric error edge
+//        collapses move vertices onto their neighbours, so every level indexes the original
+//        vertex buffer and levels differ only in their index buffers.
+//     2. OptimizeVertexCache on every level, which reorders triangles with Tipsify so that
+//        vertices are reused while still in the post transform cache.
+//     3. BuildVertexFetchRemap, which renumbers vertices in the order the finest level first
+//        uses them, so vertex reads walk memory forwards and unused vertices are dropped.
+//
+// ProcessMesh runs the whole pipeline and ProcessMeshesParallel spreads many meshes across
+// the worker pool. Only positions are processed; other vertex streams follow the returned remap.
+
+#include "Common.h"
+#include "KhaosMath.h"
+
+#include <vector>
+
+namespace KhaosEngine
+{
+    using KhaosMath::Vector3f;
+
+    // Post transform cache size assumed when ordering triangles and measuring meshes.
+    const K_UINT DEFAULT_VERTEX_CACHE_SIZE = 16;
+
+    // Remap entry of a vertex no triangle uses.
+    const KUI_32 UNUSED_VERTEX = 0xFFFFFFFF;
+
+    // Vertex cache efficiency of an index buffer under a FIFO cache.
+    struct VertexCacheMetrics
+    {
+        K_UINT triangleCount;
+        K_UINT transformCount; // Cache misses, each a vertex shader run.
+        float acmr; // Average cache miss ratio, transforms per triangle. 0.5 is ideal for large grids.
+        float atvr; // Average transform to vertex ratio, transforms per unique vertex. 1 is ideal.
+    };
+
+    // One level of detail. All levels of a mesh share its vertex buffer.
+    struct MeshLevel
+    {
+        std::vector<KUI_32> indices;
+        float error; // Quadric error of the worst collapse so far, as a distance in mesh units.
+        VertexCacheMetrics metrics;
+    };
+
+    struct MeshProcessingSettings
+    {
+        K_UINT cacheSize;
+        K_UINT levelCount; // Including the full detail level.
+        float levelReduction; // Triangle count of each level as a fraction of the previous one.
+        float maxError; // Largest collapse error allowed, as a fraction of the mesh extent.
+
+        MeshProcessingSettings()
+            : cacheSize(DEFAULT_VERTEX_CACHE_SIZE), levelCount(4), levelReduction(0.5f), maxError(0.05f) { }
+    };
+
+    struct ProcessedMesh
+    {
+        std::vector<Vector3f> positions;
+        std::vector<KUI_32> remap; // New index of each source vertex, or UNUSED_VERTEX.
+        std::vector<MeshLevel> levels; // Finest first. Coarser levels stop once maxError is hit.
+        VertexCacheMetrics sourceMetrics; // The source index buffer, for comparison.
+    };
+
+    // Source mesh and destination for ProcessMeshesParallel.
+    struct MeshProcessingJob
+    {
+        const Vector3f* positions;
+        K_UINT vertexCount;
+        const KUI_32* indices; // Three per triangle.
+        K_UINT indexCount;
+        ProcessedMesh* result;
+    };
+
+    // Simulates a FIFO post transform cache of aCacheSize vertices over an index buffer.
+    VertexCacheMetrics AnalyzeVertexCache(const KUI_32* someIndices, K_UINT anIndexCount, K_UINT aVertexCount,
+                                          K_UINT aCacheSize);
+
+    // Writes the triangles of someIndices to someResult, reordered for vertex reuse in a cache
+    // of aCacheSize vertices. someResult must not overlap someIndices.
+    void OptimizeVertexCache(const KUI_32* someIndices, K_UINT anIndexCount, K_UINT aVertexCount, K_UINT aCacheSize,
+                             KUI_32* someResult);
+
+    // Numbers vertices in order of first use by someIndices, which is rewritten in place, and
+    // fills aRemap with aVertexCount entries. Returns the number of vertices used.
+    K_UINT BuildVertexFetchRemap(KUI_32* someIndices, K_UINT anIndexCount, K_UINT aVertexCount, KUI_32* aRemap);
+
+    // Moves the positions of used vertices to their remapped slots in someResult.
+    void RemapVertices(const Vector3f* somePositions, K_UINT aVertexCount, const KUI_32* aRemap, Vector3f* someResult);
+
+    // Collapses edges until at most aTargetIndexCount indices remain or the next collapse would
+    // cost more than aMaxError, measured as the root mean square distance to the planes of the
+    // triangles merged into a vertex. Writes the simplified triangles to someResult, which
+    // may be someIndices, and returns their index count. If anError is given it receives the
+    // largest error of the collapses made. Open borders are kept in place.
+    K_UINT SimplifyMesh(const KUI_32* someIndices, K_UINT anIndexCount, const Vector3f* somePositions,
+                        K_UINT aVertexCount, K_UINT aTargetIndexCount, float aMaxError, KUI_32* someResult,
+                        float* anError = nullptr);
+
+    // Runs the full pipeline over one mesh.
+    void ProcessMesh(const Vector3f* somePositions, K_UINT aVertexCount, const KUI_32* someIndices, K_UINT anIndexCount,
+                     const MeshProcessingSettings& someSettings, ProcessedMesh& aResult);
+
+    // Runs ProcessMesh over every job, on the shared worker pool when aThreadCount is above one.
+    // Threads take meshes one at a time, so many small meshes and a few large ones balance
+    // equally well.
+    void ProcessMeshesParallel(const MeshProcessingJob* someJobs, K_UINT aJobCount,
+                               const MeshProcessingSettings& someSettings, K_UINT aThreadCount);
+}
\ No newline at end of file
@@ -0,0 +1,447 @@
+// OcclusionCulling.cpp
+// Tiled occluder rasterization, hierarchical-Z construction and SSE bounding box tests.
+
+#include "OcclusionCulling.h"
+#include "Memory.h"
+#include "Profiler.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <emmintrin.h>
+
+namespace
+{
+    using namespace KhaosEngine;
+
+    // Rows in each rasterization tile. Tiles span the full buffer width.
+    const K_UINT TILE_ROWS = 8;
+    const K_UINT TILE_COUNT = OCCLUSION_BUFFER_HEIGHT / TILE_ROWS;
+
+    // Batches of boxes start on a multiple of this so threads never share an output cache line.
+    const K_UINT BOUNDS_PER_CACHE_LINE = 64;
+
+    // Triangles with less screen area than this, in square pixels, are dropped during setup.
+    const float MIN_TRIANGLE_AREA = 1.0e-6f;
+
+    const float HALF_WIDTH = OCCLUSION_BUFFER_WIDTH * 0.5f;
+    const float HALF_HEIGHT = OCCLUSION_BUFFER_HEIGHT * 0.5f;
+
+    struct ClipVertex
+    {
+        float x, y, z, w;
+    };
+
+    // Transforms a point by the rows of a matrix, treating it as a row vector with w = 1.
+    inline ClipVertex transformPoint(const __m128* someRows, const Vector3f& aPoint) {
+        __m128 sum = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(aPoint.x), someRows[0]), someRows[3]);
+        sum = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(aPoint.y), someRows[1]), sum);
+        sum = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(aPoint.z), someRows[2]), sum);
+        ClipVertex vertex;
+        _mm_storeu_ps(&vertex.x, sum);
+        return vertex;
+    }
+
+    // Returns the point where the edge from aFrom to aTo crosses the near plane, z = 0.
+    inline ClipVertex intersectNearPlane(const ClipVertex& aFrom, const ClipVertex& aTo) {
+        const float t = aFrom.z / (aFrom.z - aTo.z);
+        ClipVertex vertex;
+        vertex.x = aFrom.x + (aTo.x - aFrom.x) * t;
+        vertex.y = aFrom.y + (aTo.y - aFrom.y) * t;
+        vertex.z = 0.0f;
+        vertex.w = aFrom.w + (aTo.w - aFrom.w) * t;
+        return vertex;
+    }
+
+    // Clips a triangle to the near plane. Writes and returns up to four polygon vertices.
+    K_UINT clipToNearPlane(const ClipVertex* someVertices, ClipVertex* aPolygon) {
+        K_UINT count = 0;
+        for (K_UINT i = 0; i < 3; ++i) {
+            const ClipVertex& current = someVertices[i];
+            const ClipVertex& next = someVertices[(i + 1) % 3];
+            if (current.z >= 0.0f)
+                aPolygon[count++] = current;
+            if ((current.z >= 0.0f) != (next.z >= 0.0f))
+                aPolygon[count++] = intersectNearPlane(current, next);
+        }
+        return count;
+    }
+
+    // Projects a clipped triangle to pixels, orders it counter clockwise on screen and
+    // appends it. Returns false if it was too small to keep.
+    bool emitTriangle(const ClipVertex& a, const ClipVertex& b, const ClipVertex& c, OccluderTriangle& aTriangle) {
+        const ClipVertex* vertices[3] = { &a, &b, &c };
+        for (K_UINT i = 0; i < 3; ++i) {
+            const float inverseW = 1.0f / vertices[i]->w;
+            aTriangle.x[i] = vertices[i]->x * inverseW * HALF_WIDTH + HALF_WIDTH;
+            aTriangle.y[i] = HALF_HEIGHT - vertices[i]->y * inverseW * HALF_HEIGHT;
+            aTriangle.z[i] = vertices[i]->z * inverseW;
+        }
+        const float area = (aTriangle.x[1] - aTriangle.x[0]) * (aTriangle.y[2] - aTriangle.y[0]) -
+                           (aTriangle.x[2] - aTriangle.x[0]) * (aTriangle.y[1] - aTriangle.y[0]);
+        if (!(fabsf(area) > MIN_TRIANGLE_AREA))
+            return false;
+        if (area < 0.0f) {
+            std::swap(aTriangle.x[1], aTriangle.x[2]);
+            std::swap(aTriangle.y[1], aTriangle.y[2]);
+            std::swap(aTriangle.z[1], aTriangle.z[2]);
+        }
+        return true;
+    }
+
+    inline float maximum3(float a, float b, float c) {
+        return std::max(a, std::max(b, c));
+    }
+
+    inline float minimum3(float a, float b, float c) {
+        return std::min(a, std::min(b, c));
+    }
+}
+
+namespace KhaosEngine
+{
+    OcclusionBuffer::OcclusionBuffer(K_UINT aMaxTriangles)
+        : mViewProjection(Matrix4x4f::Identity()), mDepth(nullptr), mTriangles(nullptr),
+          mMaxTriangles(aMaxTriangles), mBatches(0) {
+        // Every level starts on a 16 byte boundary so the SSE loops can use aligned access.
+        size_t floatCount = 0;
+        for (K_UINT level = 0; level < OCCLUSION_LEVEL_COUNT; ++level) {
+            mLevelOffsets[level] = static_cast<K_UINT>(floatCount);
+            floatCount += AlignUp(GetLevelWidth(level) * GetLevelHeight(level), 4);
+        }
+        mDepth = static_cast<float*>(AlignedAlloc(floatCount * sizeof(float), SIMD_ALIGNMENT));
+        std::fill(mDepth, mDepth + floatCount, 1.0f);
+        mTriangles = static_cast<OccluderTriangle*>(AlignedAlloc(std::max(1u, aMaxTriangles) * sizeof(OccluderTriangle),
+                                                                 SIMD_ALIGNMENT));
+    }
+
+    OcclusionBuffer::~OcclusionBuffer() {
+        AlignedFree(mTriangles);
+        AlignedFree(mDepth);
+    }
+
+    void OcclusionBuffer::beginFrame(const Matrix4x4f& aViewProjection) {
+        mViewProjection = aViewProjection;
+        mBatches = 0;
+        const __m128 far = _mm_set1_ps(1.0f);
+        for (K_UINT i = 0; i < OCCLUSION_BUFFER_WIDTH * OCCLUSION_BUFFER_HEIGHT; i += 4)
+            _mm_store_ps(mDepth + i, far);
+    }
+
+    float OcclusionBuffer::getDepth(K_UINT aLevel, K_UINT aX, K_UINT aY) const {
+        ASSERT(aLevel < OCCLUSION_LEVEL_COUNT && aX < GetLevelWidth(aLevel) && aY < GetLevelHeight(aLevel));
+        return mDepth[mLevelOffsets[aLevel] + aY * GetLevelWidth(aLevel) + aX];
+    }
+
+    //
+    // Rasterization function definitions.
+    //
+
+    void OcclusionBuffer::rasterizeOccluders(const OccluderMesh* someOccluders, K_UINT anOccluderCount,
+                                             K_UINT aThreadCount) {
+        PROFILE_SCOPE_CATEGORY("RasterizeOccluders", PROFILE_CATEGORY_CULLING);
+        const K_UINT threadCount = std::max(1u, std::min(aThreadCount, MAX_OCCLUSION_BATCHES));
+
+        // Give each batch of occluders room for two triangles per source triangle, in order,
+        // until the budget runs out.
+        const K_UINT occludersPerBatch = (anOccluderCount + threadCount - 1) / std::max(1u, threadCount);
+        K_UINT nextTriangle = 0;
+        mBatches = 0;
+        for (K_UINT first = 0; first < anOccluderCount; first += occludersPerBatch) {
+            mBatchFirst[mBatches] = nextTriangle;
+            mBatchCount[mBatches] = 0;
+            const K_UINT end = std::min(anOccluderCount, first + occludersPerBatch);
+            for (K_UINT i = first; i < end; ++i)
+                nextTriangle = std::min(mMaxTriangles, nextTriangle + someOccluders[i].triangleCount * 2);
+            ++mBatches;
+        }
+
+        WorkerPool& pool = WorkerPool::Shared();
+        pool.forEach(mBatches, [&](K_UINT aBatch) {
+            const K_UINT first = aBatch * occludersPerBatch;
+            setupOccluders(someOccluders, first, std::min(occludersPerBatch, anOccluderCount - first), aBatch);
+        });
+
+        // Tiles are claimed one at a time, so tiles crossed by many triangles balance themselves.
+        if (threadCount > 1) {
+            pool.forEach(TILE_COUNT, [this](K_UINT aTile) {
+                rasterizeTile(aTile * TILE_ROWS, (aTile + 1) * TILE_ROWS);
+            });
+        }
+        else {
+            for (K_UINT tile = 0; tile < TILE_COUNT; ++tile)
+                rasterizeTile(tile * TILE_ROWS, (tile + 1) * TILE_ROWS);
+        }
+
+        buildHierarchy();
+    }
+
+    void OcclusionBuffer::setupOccluders(const OccluderMesh* someOccluders, K_UINT aFirst, K_UINT aCount,
+                                         K_UINT aBatch) {
+        const K_UINT first = mBatchFirst[aBatch];
+        const K_UINT limit = aBatch + 1 < mBatches ? mBatchFirst[aBatch + 1] : mMaxTriangles;
+        K_UINT count = 0;
+
+        for (K_UINT occluder = aFirst; occluder < aFirst + aCount; ++occluder) {
+            const OccluderMesh& mesh = someOccluders[occluder];
+            const Matrix4x4f transform = mesh.worldTransform * mViewProjection;
+            const __m128 rows[4] = { _mm_load_ps(transform.elem[0]), _mm_load_ps(transform.elem[1]),
+                                     _mm_load_ps(transform.elem[2]), _mm_load_ps(transform.elem[3]) };
+
+            for (K_UINT triangle = 0; triangle < mesh.triangleCount; ++triangle) {
+                // Leave room for the second half of a clipped triangle.
+                if (limit - first - count < 2)
+                    break;
+                const KUI_16* indices = mesh.indices + triangle * 3;
+                const ClipVertex vertices[3] = { transformPoint(rows, mesh.vertices[indices[0]]),
+                                                 transformPoint(rows, mesh.vertices[indices[1]]),
+                                                 transformPoint(rows, mesh.vertices[indices[2]]) };
+
+                // Skip triangles wholly outside one side of the view volume.
+                if ((vertices[0].x > vertices[0].w && vertices[1].x > vertices[1].w && vertices[2].x > vertices[2].w) ||
+                    (vertices[0].x < -vertices[0].w && vertices[1].x < -vertices[1].w && vertices[2].x < -vertices[2].w) ||
+                    (vertices[0].y > vertices[0].w && vertices[1].y > vertices[1].w && vertices[2].y > vertices[2].w) ||
+                    (vertices[0].y < -vertices[0].w && vertices[1].y < -vertices[1].w && vertices[2].y < -vertices[2].w))
+                    continue;
+
+                ClipVertex polygon[4];
+                const K_UINT polygonCount = clipToNearPlane(vertices, polygon);
+                for (K_UINT corner = 2; corner < polygonCount; ++corner)
+                    if (emitTriangle(polygon[0], polygon[corner - 1], polygon[corner], mTriangles[first + count]))
+                        ++count;
+            }
+        }
+        mBatchCount[aBatch] = count;
+    }
+
+    void OcclusionBuffer::rasterizeTile(K_UINT aFirstRow, K_UINT anEndRow) {
+        const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        const __m128 zero = _mm_setzero_ps();
+
+        for (K_UINT batch = 0; batch < mBatches; ++batch) {
+            const OccluderTriangle* triangles = mTriangles + mBatchFirst[batch];
+            for (K_UINT i = 0; i < mBatchCount[batch]; ++i) {
+                const OccluderTriangle& tri = triangles[i];
+
+                // Pixels whose centres fall inside the triangle's bounds, clamped to the tile.
+                const float firstRow = ceilf(minimum3(tri.y[0], tri.y[1], tri.y[2]) - 0.5f);
+                const float endRow = floorf(maximum3(tri.y[0], tri.y[1], tri.y[2]) - 0.5f) + 1.0f;
+                const float firstColumn = ceilf(minimum3(tri.x[0], tri.x[1], tri.x[2]) - 0.5f);
+                const float endColumn = floorf(maximum3(tri.x[0], tri.x[1], tri.x[2]) - 0.5f) + 1.0f;
+                if (endRow <= static_cast<float>(aFirstRow) || firstRow >= static_cast<float>(anEndRow) ||
+                    endColumn <= 0.0f || firstColumn >= static_cast<float>(OCCLUSION_BUFFER_WIDTH))
+                    continue;
+                const K_UINT rowBegin = std::max(aFirstRow, static_cast<K_UINT>(std::max(firstRow, 0.0f)));
+                const K_UINT rowEnd = static_cast<K_UINT>(std::min(endRow, static_cast<float>(anEndRow)));
+                const K_UINT columnBegin = static_cast<K_UINT>(std::max(firstColumn, 0.0f)) & ~3u;
+                const K_UINT columnEnd = static_cast<K_UINT>(std::min(endColumn, static_cast<float>(OCCLUSION_BUFFER_WIDTH)));
+
+                // Edge functions are non-negative inside the triangle, and depth is a plane in
+                // screen space. Each is a * x + b * y + c.
+                const float area = (tri.x[1] - tri.x[0]) * (tri.y[2] - tri.y[0]) -
+                                   (tri.x[2] - tri.x[0]) * (tri.y[1] - tri.y[0]);
+                float edgeA[3], edgeB[3], edgeC[3];
+                for (K_UINT edge = 0; edge < 3; ++edge) {
+                    const K_UINT from = edge;
+                    const K_UINT to = (edge + 1) % 3;
+                    edgeA[edge] = tri.y[from] - tri.y[to];
+                    edgeB[edge] = tri.x[to] - tri.x[from];
+                    edgeC[edge] = -edgeA[edge] * tri.x[from] - edgeB[edge] * tri.y[from];
+                }
+                // The barycentric weight of a vertex is the edge opposite it over the area.
+                const float inverseArea = 1.0f / area;
+                const float depthA = (edgeA[1] * tri.z[0] + edgeA[2] * tri.z[1] + edgeA[0] * tri.z[2]) * inverseArea;
+                const float depthB = (edgeB[1] * tri.z[0] + edgeB[2] * tri.z[1] + edgeB[0] * tri.z[2]) * inverseArea;
+                const float depthC = (edgeC[1] * tri.z[0] + edgeC[2] * tri.z[1] + edgeC[0] * tri.z[2]) * inverseArea;
+
+                const __m128 a0 = _mm_set1_ps(edgeA[0]), a1 = _mm_set1_ps(edgeA[1]), a2 = _mm_set1_ps(edgeA[2]);
+                const __m128 aDepth = _mm_set1_ps(depthA);
+
+                for (K_UINT row = rowBegin; row < rowEnd; ++row) {
+                    const float y = static_cast<float>(row) + 0.5f;
+                    const __m128 rowEdge0 = _mm_set1_ps(edgeB[0] * y + edgeC[0]);
+                    const __m128 rowEdge1 = _mm_set1_ps(edgeB[1] * y + edgeC[1]);
+                    const __m128 rowEdge2 = _mm_set1_ps(edgeB[2] * y + edgeC[2]);
+                    const __m128 rowDepth = _mm_set1_ps(depthB * y + depthC);
+                    float* depthRow = mDepth + row * OCCLUSION_BUFFER_WIDTH;
+
+                    for (K_UINT column = columnBegin; column < columnEnd; column += 4) {
+                        const __m128 x = _mm_add_ps(_mm_set1_ps(static_cast<float>(column)), laneOffsets);
+                        const __m128 inside = _mm_and_ps(
+                            _mm_and_ps(_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a0, x), rowEdge0), zero),
+                                       _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a1, x), rowEdge1), zero)),
+                            _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a2, x), rowEdge2), zero));
+                        if (_mm_movemask_ps(inside) == 0)
+                            continue;
+                        const __m128 depth = _mm_add_ps(_mm_mul_ps(aDepth, x), rowDepth);
+                        const __m128 stored = _mm_load_ps(depthRow + column);
+                        const __m128 nearest = _mm_min_ps(stored, depth);
+                        _mm_store_ps(depthRow + column, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, stored)));
+                    }
+                }
+            }
+        }
+    }
+
+    // Each texel takes the farthest of the 2x2 texels below it. Rows of four or more output
+    // texels reduce eight inputs per step.
+    void OcclusionBuffer::buildHierarchy() {
+        PROFILE_SCOPE_CATEGORY("BuildHierarchicalZ", PROFILE_CATEGORY_CULLING);
+        for (K_UINT level = 1; level < OCCLUSION_LEVEL_COUNT; ++level) {
+            const K_UINT width = GetLevelWidth(level);
+            const K_UINT height = GetLevelHeight(level);
+            const K_UINT sourceWidth = GetLevelWidth(level - 1);
+            const K_UINT sourceHeight = GetLevelHeight(level - 1);
+            const float* source = mDepth + mLevelOffsets[level - 1];
+            float* destination = mDepth + mLevelOffsets[level];
+
+            for (K_UINT y = 0; y < height; ++y) {
+                const float* top = source + std::min(y * 2, sourceHeight - 1) * sourceWidth;
+                const float* bottom = source + std::min(y * 2 + 1, sourceHeight - 1) * sourceWidth;
+                float* output = destination + y * width;
+
+                K_UINT x = 0;
+                if (width % 4 == 0) {
+                    for (; x < width; x += 4) {
+                        const __m128 left = _mm_max_ps(_mm_load_ps(top + x * 2), _mm_load_ps(bottom + x * 2));
+                        const __m128 right = _mm_max_ps(_mm_load_ps(top + x * 2 + 4), _mm_load_ps(bottom + x * 2 + 4));
+                        _mm_storeu_ps(output + x, _mm_max_ps(_mm_shuffle_ps(left, right, _MM_SHUFFLE(2, 0, 2, 0)),
+                                                             _mm_shuffle_ps(left, right, _MM_SHUFFLE(3, 1, 3, 1))));
+                    }
+                }
+                for (; x < width; ++x) {
+                    const K_UINT left = std::min(x * 2, sourceWidth - 1);
+                    const K_UINT right = std::min(x * 2 + 1, sourceWidth - 1);
+                    output[x] = std::max(std::max(top[left], top[right]), std::max(bottom[left], bottom[right]));
+                }
+            }
+        }
+    }
+
+    //
+    // Bounds testing function definitions.
+    //
+
+    void OcclusionBuffer::testBounds(const OcclusionBounds* someBounds, K_UINT aFirst, K_UINT aCount,
+                                     bool* someVisible) const {
+        for (K_UINT i = aFirst; i < aFirst + aCount; i += 4)
+            testFourBounds(someBounds + i, std::min(4u, aFirst + aCount - i), someVisible + i);
+    }
+
+    void OcclusionBuffer::testBoundsParallel(const OcclusionBounds* someBounds, K_UINT aCount, bool* someVisible,
+                                             K_UINT aThreadCount) const {
+        PROFILE_SCOPE_CATEGORY("TestOcclusionBounds", PROFILE_CATEGORY_CULLING);
+        const K_UINT threadCount = std::max(1u, std::min(aThreadCount, MAX_OCCLUSION_BATCHES));
+        const K_UINT chunkSize = static_cast<K_UINT>(
+            AlignUp((aCount + threadCount - 1) / threadCount, BOUNDS_PER_CACHE_LINE));
+
+        if (chunkSize == 0)
+            return;
+
+        WorkerPool::Shared().forEach((aCount + chunkSize - 1) / chunkSize, [&](K_UINT aChunk) {
+            const K_UINT first = aChunk * chunkSize;
+            testBounds(someBounds, first, std::min(chunkSize, aCount - first), someVisible);
+        });
+    }
+
+    void OcclusionBuffer::testFourBounds(const OcclusionBounds* someBounds, K_UINT aCount, bool* someVisible) const {
+        // Gather the boxes into structure-of-arrays form, repeating the last box in unused lanes.
+        __declspec(align(16)) float extents[6][4];
+        for (K_UINT lane = 0; lane < 4; ++lane) {
+            const OcclusionBounds& bounds = someBounds[std::min(lane, aCount - 1)];
+            extents[0][lane] = bounds.minimum.x;
+            extents[1][lane] = bounds.minimum.y;
+            extents[2][lane] = bounds.minimum.z;
+            extents[3][lane] = bounds.maximum.x;
+            extents[4][lane] = bounds.maximum.y;
+            extents[5][lane] = bounds.maximum.z;
+        }
+        const __m128 corners[2][3] = { { _mm_load_ps(extents[0]), _mm_load_ps(extents[1]), _mm_load_ps(extents[2]) },
+                                       { _mm_load_ps(extents[3]), _mm_load_ps(extents[4]), _mm_load_ps(extents[5]) } };
+
+        // Project the eight corners of each box, tracking its screen bounds and nearest depth.
+        const Matrix4x4f& m = mViewProjection;
+        __m128 minX = _mm_set1_ps(INFINITY), maxX = _mm_set1_ps(-INFINITY);
+        __m128 minY = _mm_set1_ps(INFINITY), maxY = _mm_set1_ps(-INFINITY);
+        __m128 minZ = _mm_set1_ps(INFINITY);
+        __m128 crossesNear = _mm_setzero_ps();
+        __m128 behindNear = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (K_UINT corner = 0; corner < 8; ++corner) {
+            const __m128 x = corners[corner & 1][0];
+            const __m128 y = corners[(corner >> 1) & 1][1];
+            const __m128 z = corners[corner >> 2][2];
+            const __m128 clipX = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(m(0, 0))), _mm_mul_ps(y, _mm_set1_ps(m(1, 0)))),
+                                            _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(m(2, 0))), _mm_set1_ps(m(3, 0))));
+            const __m128 clipY = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(m(0, 1))), _mm_mul_ps(y, _mm_set1_ps(m(1, 1)))),
+                                            _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(m(2, 1))), _mm_set1_ps(m(3, 1))));
+            const __m128 clipZ = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(m(0, 2))), _mm_mul_ps(y, _mm_set1_ps(m(1, 2)))),
+                                            _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(m(2, 2))), _mm_set1_ps(m(3, 2))));
+            const __m128 clipW = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(m(0, 3))), _mm_mul_ps(y, _mm_set1_ps(m(1, 3)))),
+                                            _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(m(2, 3))), _mm_set1_ps(m(3, 3))));
+            const __m128 cornerBehind = _mm_cmplt_ps(clipZ, _mm_setzero_ps());
+            crossesNear = _mm_or_ps(crossesNear, cornerBehind);
+            behindNear = _mm_and_ps(behindNear, cornerBehind);
+            const __m128 inverseW = _mm_div_ps(_mm_set1_ps(1.0f), clipW);
+            const __m128 screenX = _mm_mul_ps(clipX, inverseW);
+            const __m128 screenY = _mm_mul_ps(clipY, inverseW);
+            minX = _mm_min_ps(minX, screenX);
+            maxX = _mm_max_ps(maxX, screenX);
+            minY = _mm_min_ps(minY, screenY);
+            maxY = _mm_max_ps(maxY, screenY);
+            minZ = _mm_min_ps(minZ, _mm_mul_ps(clipZ, inverseW));
+        }
+
+        // Convert to a pixel rectangle. Screen y points down.
+        const __m128 halfWidth = _mm_set1_ps(HALF_WIDTH);
+        const __m128 halfHeight = _mm_set1_ps(HALF_HEIGHT);
+        const __m128 left = _mm_add_ps(_mm_mul_ps(minX, halfWidth), halfWidth);
+        const __m128 right = _mm_add_ps(_mm_mul_ps(maxX, halfWidth), halfWidth);
+        const __m128 top = _mm_sub_ps(halfHeight, _mm_mul_ps(maxY, halfHeight));
+        const __m128 bottom = _mm_sub_ps(halfHeight, _mm_mul_ps(minY, halfHeight));
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 width = _mm_set1_ps(static_cast<float>(OCCLUSION_BUFFER_WIDTH));
+        const __m128 height = _mm_set1_ps(static_cast<float>(OCCLUSION_BUFFER_HEIGHT));
+        // The rectangle is meaningless for boxes crossing the near plane.
+        const __m128 outsideRectangle = _mm_or_ps(_mm_or_ps(_mm_cmplt_ps(right, zero), _mm_cmpge_ps(left, width)),
+                                                  _mm_or_ps(_mm_cmplt_ps(bottom, zero), _mm_cmpge_ps(top, height)));
+        const __m128 offScreen = _mm_or_ps(behindNear, _mm_andnot_ps(crossesNear, outsideRectangle));
+        const __m128 lastColumn = _mm_set1_ps(static_cast<float>(OCCLUSION_BUFFER_WIDTH - 1));
+        const __m128 lastRow = _mm_set1_ps(static_cast<float>(OCCLUSION_BUFFER_HEIGHT - 1));
+
+        __declspec(align(16)) K_INT pixels[4][4];
+        __declspec(align(16)) float nearest[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(pixels[0]), _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(left, zero), lastColumn)));
+        _mm_store_si128(reinterpret_cast<__m128i*>(pixels[1]), _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(right, zero), lastColumn)));
+        _mm_store_si128(reinterpret_cast<__m128i*>(pixels[2]), _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(top, zero), lastRow)));
+        _mm_store_si128(reinterpret_cast<__m128i*>(pixels[3]), _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(bottom, zero), lastRow)));
+        _mm_store_ps(nearest, minZ);
+        const K_INT nearMask = _mm_movemask_ps(crossesNear);
+        const K_INT offScreenMask = _mm_movemask_ps(offScreen);
+
+        for (K_UINT lane = 0; lane < aCount; ++lane) {
+            if (offScreenMask & (1 << lane)) {
+                someVisible[lane] = false;
+                continue;
+            }
+            if (nearMask & (1 << lane)) {
+                someVisible[lane] = true;
+                continue;
+            }
+
+            // Pick the finest level where the rectangle covers at most 2x2 texels.
+            const K_UINT x0 = pixels[0][lane], x1 = pixels[1][lane];
+            const K_UINT y0 = pixels[2][lane], y1 = pixels[3][lane];
+            K_UINT level = 0;
+            while (level + 1 < OCCLUSION_LEVEL_COUNT && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+                ++level;
+
+            const float* depth = mDepth + mLevelOffsets[level];
+            const K_UINT levelWidth = GetLevelWidth(level);
+            const float* topRow = depth + (y0 >> level) * levelWidth;
+            const float* bottomRow = depth + (y1 >> level) * levelWidth;
+            const float farthest = std::max(std::max(topRow[x0 >> level], topRow[x1 >> level]),
+                                            std::max(bottomRow[x0 >> level], bottomRow[x1 >> level]));
+            someVisible[lane] = nearest[lane] <= farthest;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,126 @@
+#pragma once
+
+// OcclusionCulling.h
+// Software occlusion culling against a low resolution depth buffer, run after frustum culling
+// to drop objects hidden behind large occluders such as walls and terrain.
+//
+// Each frame, a handful of simplified occluder meshes are rasterized on the CPU into a
+// 256x128 depth buffer, split into tiles of rows that the worker pool claims one at a time. A
+// hierarchical-Z chain is then built in which every texel holds the farthest depth of the
+// four below it, so any screen rectangle can be bounded by at most four reads. Candidate
+// bounding boxes are projected four at a time in SSE registers and culled when their nearest
+// point lies behind the farthest occluder depth under their screen rectangle:
+//
+//     occlusion.beginFrame(view * projection);
+//     occlusion.rasterizeOccluders(occluders, occluderCount, threadCount);
+//     occlusion.testBoundsParallel(bounds, boundsCount, visible, threadCount);
+//
+// Projections must map the near plane to depth 0 and the far plane to depth 1, as
+// Matrix4x4f::Perspective and Orthographic do.
+
+#include "Common.h"
+#include "KhaosMath.h"
+
+namespace KhaosEngine
+{
+    using KhaosMath::Vector3f;
+    using KhaosMath::Matrix4x4f;
+
+    // Size of the occlusion depth buffer. Both must be powers of two.
+    const K_UINT OCCLUSION_BUFFER_WIDTH = 256;
+    const K_UINT OCCLUSION_BUFFER_HEIGHT = 128;
+
+    // Levels in the hierarchical-Z chain, down to a single texel.
+    const K_UINT OCCLUSION_LEVEL_COUNT = 9;
+
+    // Most batches occluder setup and box testing will split work into.
+    const K_UINT MAX_OCCLUSION_BATCHES = 32;
+
+    // Low polygon mesh drawn into the depth buffer. Occluders are drawn two sided and must
+    // lie inside the objects they stand in for, or they will hide things that are visible.
+    struct OccluderMesh
+    {
+        Matrix4x4f worldTransform;
+        const Vector3f* vertices;
+        const KUI_16* indices; // Three per triangle.
+        K_UINT triangleCount;
+    };
+
+    // World space axis aligned bounding box.
+    struct OcclusionBounds
+    {
+        Vector3f minimum;
+        Vector3f maximum;
+    };
+
+    // Screen space triangle produced by occluder setup, in pixels with depth in [0, 1].
+    struct OccluderTriangle
+    {
+        float x[3];
+        float y[3];
+        float z[3];
+    };
+
+    class OcclusionBuffer
+    {
+    public:
+        // Reserves room for aMaxTriangles occluder triangles per frame. Near plane clipping
+        // can split a triangle in two, so size this at twice the source triangle count.
+        explicit OcclusionBuffer(K_UINT aMaxTriangles);
+        ~OcclusionBuffer();
+
+        // Clears the depth buffer to the far plane and sets the camera for this frame.
+        void beginFrame(const Matrix4x4f& aViewProjection);
+
+        // Draws the occluders and rebuilds the hierarchical-Z chain. Triangles past the budget
+        // are dropped, which only makes culling less effective.
+        void rasterizeOccluders(const OccluderMesh* someOccluders, K_UINT anOccluderCount, K_UINT aThreadCount);
+
+        // Sets someVisible[i] for aCount boxes starting at aFirst. Boxes that cross the near
+        // plane are always visible; boxes entirely off screen or behind the camera are not.
+        void testBounds(const OcclusionBounds* someBounds, K_UINT aFirst, K_UINT aCount, bool* someVisible) const;
+
+        // Tests every box, splitting them into aThreadCount batches run on the shared worker
+        // pool and the calling thread.
+        void testBoundsParallel(const OcclusionBounds* someBounds, K_UINT aCount, bool* someVisible,
+                                K_UINT aThreadCount) const;
+
+        // Returns the farthest depth stored at a texel of a hierarchical-Z level.
+        float getDepth(K_UINT aLevel, K_UINT aX, K_UINT aY) const;
+
+        static constexpr K_UINT GetLevelWidth(K_UINT aLevel) {
+            return (OCCLUSION_BUFFER_WIDTH >> aLevel) > 0 ? OCCLUSION_BUFFER_WIDTH >> aLevel : 1;
+        }
+
+        static constexpr K_UINT GetLevelHeight(K_UINT aLevel) {
+            return (OCCLUSION_BUFFER_HEIGHT >> aLevel) > 0 ? OCCLUSION_BUFFER_HEIGHT >> aLevel : 1;
+        }
+
+    private:
+        OcclusionBuffer(const OcclusionBuffer&) = delete;
+        OcclusionBuffer& operator=(const OcclusionBuffer&) = delete;
+
+        // Transforms, clips and projects the triangles of a run of occluders.
+        void setupOccluders(const OccluderMesh* someOccluders, K_UINT aFirst, K_UINT aCount, K_UINT aBatch);
+
+        // Draws every setup triangle overlapping rows [aFirstRow, anEndRow).
+        void rasterizeTile(K_UINT aFirstRow, K_UINT anEndRow);
+
+        void buildHierarchy();
+
+        // Tests up to four boxes at once, one per SSE lane.
+        void testFourBounds(const OcclusionBounds* someBounds, K_UINT aCount, bool* someVisible) const;
+
+        Matrix4x4f mViewProjection;
+        float* mDepth; // Every level, finest first.
+        K_UINT mLevelOffsets[OCCLUSION_LEVEL_COUNT];
+
+        OccluderTriangle* mTriangles;
+        K_UINT mMaxTriangles;
+
+        // Each setup batch writes to its own run of mTriangles.
+        K_UINT mBatchFirst[MAX_OCCLUSION_BATCHES];
+        K_UINT mBatchCount[MAX_OCCLUSION_BATCHES];
+        K_UINT mBatches;
+    };
+}
\ No newline at end of file
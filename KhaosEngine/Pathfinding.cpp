@@ -0,0 +1,372 @@
+// Pathfinding.cpp
+// Grid line of sight, A* and jump point search with reusable state, and the parallel queue.
+
+#include "Pathfinding.h"
+#include "Profiler.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    using namespace KhaosEngine;
+
+    const float DIAGONAL_COST = 1.41421356f;
+
+    // The eight neighbour directions, straight ones first.
+    const K_INT DIRECTION_X[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+    const K_INT DIRECTION_Y[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+
+    // Shortest 8-connected distance between cells, in cells.
+    float octileDistance(K_INT aDX, K_INT aDY) {
+        const K_INT dx = aDX < 0 ? -aDX : aDX;
+        const K_INT dy = aDY < 0 ? -aDY : aDY;
+        return static_cast<float>(std::max(dx, dy)) + (DIAGONAL_COST - 1.0f) * static_cast<float>(std::min(dx, dy));
+    }
+
+    K_INT sign(K_INT aValue) {
+        return (aValue > 0) - (aValue < 0);
+    }
+}
+
+namespace KhaosEngine
+{
+    //
+    // NavigationGrid function definitions.
+    //
+
+    NavigationGrid::NavigationGrid(K_UINT aWidth, K_UINT aHeight, float aCellSize, const Vector2f& anOrigin)
+        : mWidth(aWidth), mHeight(aHeight), mWordsPerRow((aWidth + 63) / 64), mCellSize(aCellSize), mOrigin(anOrigin),
+          mBits(mWordsPerRow * aHeight, 0) {
+        ASSERT(aCellSize > 0.0f);
+    }
+
+    void NavigationGrid::worldToCell(const Vector2f& aPosition, K_INT& aX, K_INT& aY) const {
+        aX = static_cast<K_INT>(floorf((aPosition.x - mOrigin.x) / mCellSize));
+        aY = static_cast<K_INT>(floorf((aPosition.y - mOrigin.y) / mCellSize));
+    }
+
+    bool NavigationGrid::hasLineOfSight(const Vector2f& aStart, const Vector2f& anEnd) const {
+        // Walks the cells under the segment in order, in grid units.
+        const float startX = (aStart.x - mOrigin.x) / mCellSize;
+        const float startY = (aStart.y - mOrigin.y) / mCellSize;
+        const float deltaX = (anEnd.x - aStart.x) / mCellSize;
+        const float deltaY = (anEnd.y - aStart.y) / mCellSize;
+        K_INT x, y, endX, endY;
+        worldToCell(aStart, x, y);
+        worldToCell(anEnd, endX, endY);
+        if (isBlocked(x, y))
+            return false;
+
+        const K_INT stepX = deltaX > 0.0f ? 1 : -1;
+        const K_INT stepY = deltaY > 0.0f ? 1 : -1;
+        // Segment parameter at the next vertical and horizontal cell boundary, and between them.
+        float nextX = deltaX != 0.0f ? (static_cast<float>(x + (stepX > 0)) - startX) / deltaX : INFINITY;
+        float nextY = deltaY != 0.0f ? (static_cast<float>(y + (stepY > 0)) - startY) / deltaY : INFINITY;
+        const float spanX = deltaX != 0.0f ? static_cast<float>(stepX) / deltaX : INFINITY;
+        const float spanY = deltaY != 0.0f ? static_cast<float>(stepY) / deltaY : INFINITY;
+        const float cornerTolerance = 1.0e-5f;
+
+        K_INT stepsLeft = std::abs(endX - x) + std::abs(endY - y);
+        while (stepsLeft > 0) {
+            if (fabsf(nextX - nextY) <= cornerTolerance) {
+                // Through a corner: both cells beside it must be open, then step diagonally.
+                if (isBlocked(x + stepX, y) || isBlocked(x, y + stepY))
+                    return false;
+                x += stepX;
+                y += stepY;
+                nextX += spanX;
+                nextY += spanY;
+                stepsLeft -= 2;
+            }
+            else if (nextX < nextY) {
+                x += stepX;
+                nextX += spanX;
+                --stepsLeft;
+            }
+            else {
+                y += stepY;
+                nextY += spanY;
+                --stepsLeft;
+            }
+            if (isBlocked(x, y))
+                return false;
+        }
+        return true;
+    }
+
+    //
+    // PathSearch function definitions.
+    //
+
+    void PathSearch::begin(K_UINT aCellCount) {
+        if (mCells.size() < aCellCount) {
+            CellState unused = { 0.0f, 0, 0, false };
+            mCells.resize(aCellCount, unused);
+        }
+        // Generation zero marks cells no search has touched, so skip it on wrap around.
+        if (++mGeneration == 0) {
+            for (CellState& cell : mCells)
+                cell.generation = 0;
+            mGeneration = 1;
+        }
+        mOpen.clear();
+    }
+
+    void PathSearch::relax(KUI_32 aCell, KUI_32 aParent, float aCost, float aHeuristic) {
+        CellState& state = mCells[aCell];
+        if (state.generation == mGeneration && (state.closed || state.cost <= aCost))
+            return;
+        state.cost = aCost;
+        state.parent = aParent;
+        state.generation = mGeneration;
+        state.closed = false;
+        // Stale entries for the old cost stay in the heap and are skipped once the cell closes.
+        OpenEntry entry = { aCost + aHeuristic, aCell };
+        mOpen.push_back(entry);
+        std::push_heap(mOpen.begin(), mOpen.end());
+    }
+
+    bool PathSearch::expandAStar(const NavigationGrid& aGrid, KUI_32 aGoal, K_UINT& anExpandedCount) {
+        const K_INT width = static_cast<K_INT>(aGrid.getWidth());
+        const K_INT goalX = static_cast<K_INT>(aGoal) % width;
+        const K_INT goalY = static_cast<K_INT>(aGoal) / width;
+        while (!mOpen.empty()) {
+            std::pop_heap(mOpen.begin(), mOpen.end());
+            const KUI_32 cell = mOpen.back().cell;
+            mOpen.pop_back();
+            CellState& state = mCells[cell];
+            if (state.closed)
+                continue;
+            state.closed = true;
+            ++anExpandedCount;
+            if (cell == aGoal)
+                return true;
+
+            const K_INT x = static_cast<K_INT>(cell) % width;
+            const K_INT y = static_cast<K_INT>(cell) / width;
+            for (K_UINT direction = 0; direction < 8; ++direction) {
+                const K_INT dx = DIRECTION_X[direction];
+                const K_INT dy = DIRECTION_Y[direction];
+                if (aGrid.isBlocked(x + dx, y + dy))
+                    continue;
+                const bool diagonal = dx != 0 && dy != 0;
+                if (diagonal && (aGrid.isBlocked(x + dx, y) || aGrid.isBlocked(x, y + dy)))
+                    continue;
+                const KUI_32 neighbour = static_cast<KUI_32>((y + dy) * width + x + dx);
+                relax(neighbour, cell, state.cost + (diagonal ? DIAGONAL_COST : 1.0f),
+                      octileDistance(goalX - x - dx, goalY - y - dy));
+            }
+        }
+        return false;
+    }
+
+    K_INT PathSearch::jump(const NavigationGrid& aGrid, K_INT aX, K_INT aY, K_INT aDX, K_INT aDY,
+                           K_INT aGoalX, K_INT aGoalY) const {
+        const K_INT width = static_cast<K_INT>(aGrid.getWidth());
+        K_INT x = aX;
+        K_INT y = aY;
+        for (;;) {
+            if (aGrid.isBlocked(x, y))
+                return -1;
+            if (x == aGoalX && y == aGoalY)
+                return y * width + x;
+
+            if (aDX != 0 && aDY != 0) {
+                // A diagonal stops wherever a straight line off it would find a jump point.
+                if (jump(aGrid, x + aDX, y, aDX, 0, aGoalX, aGoalY) >= 0 || jump(aGrid, x, y + aDY, 0, aDY, aGoalX, aGoalY) >= 0)
+                    return y * width + x;
+            }
+            else if (aDX != 0) {
+                // A straight line stops beside the end of a wall, where a turn becomes possible.
+                if ((aGrid.isWalkable(x, y - 1) && aGrid.isBlocked(x - aDX, y - 1)) ||
+                    (aGrid.isWalkable(x, y + 1) && aGrid.isBlocked(x - aDX, y + 1)))
+                    return y * width + x;
+            }
+            else {
+                if ((aGrid.isWalkable(x - 1, y) && aGrid.isBlocked(x - 1, y - aDY)) ||
+                    (aGrid.isWalkable(x + 1, y) && aGrid.isBlocked(x + 1, y - aDY)))
+                    return y * width + x;
+            }
+
+            // Diagonal steps need both sides open; for straight steps this checks the next cell.
+            if (aGrid.isBlocked(x + aDX, y) || aGrid.isBlocked(x, y + aDY))
+                return -1;
+            x += aDX;
+            y += aDY;
+        }
+    }
+
+    bool PathSearch::expandJumpPoint(const NavigationGrid& aGrid, KUI_32 aGoal, K_UINT& anExpandedCount) {
+        const K_INT width = static_cast<K_INT>(aGrid.getWidth());
+        const K_INT goalX = static_cast<K_INT>(aGoal) % width;
+        const K_INT goalY = static_cast<K_INT>(aGoal) / width;
+        K_INT directionX[8];
+        K_INT directionY[8];
+        while (!mOpen.empty()) {
+            std::pop_heap(mOpen.begin(), mOpen.end());
+            const KUI_32 cell = mOpen.back().cell;
+            mOpen.pop_back();
+            CellState& state = mCells[cell];
+            if (state.closed)
+                continue;
+            state.closed = true;
+            ++anExpandedCount;
+            if (cell == aGoal)
+                return true;
+
+            const K_INT x = static_cast<K_INT>(cell) % width;
+            const K_INT y = static_cast<K_INT>(cell) / width;
+            K_UINT directionCount = 0;
+            if (state.parent == cell) {
+                // The start cell searches every direction.
+                for (K_UINT direction = 0; direction < 8; ++direction) {
+                    directionX[directionCount] = DIRECTION_X[direction];
+                    directionY[directionCount++] = DIRECTION_Y[direction];
+                }
+            }
+            else {
+                // Prune to the directions an optimal path arriving from the parent could take.
+                const K_INT dx = sign(x - static_cast<K_INT>(state.parent) % width);
+                const K_INT dy = sign(y - static_cast<K_INT>(state.parent) / width);
+                if (dx != 0 && dy != 0) {
+                    const bool openX = aGrid.isWalkable(x + dx, y);
+                    const bool openY = aGrid.isWalkable(x, y + dy);
+                    if (openY) {
+                        directionX[directionCount] = 0;
+                        directionY[directionCount++] = dy;
+                    }
+                    if (openX) {
+                        directionX[directionCount] = dx;
+                        directionY[directionCount++] = 0;
+                    }
+                    if (openX && openY) {
+                        directionX[directionCount] = dx;
+                        directionY[directionCount++] = dy;
+                    }
+                }
+                else {
+                    // Straight arrival: ahead, the two sides, and the diagonals between them.
+                    const K_INT sideX = dy;
+                    const K_INT sideY = dx;
+                    const bool openAhead = aGrid.isWalkable(x + dx, y + dy);
+                    for (K_INT side = -1; side <= 1; side += 2) {
+                        if (!aGrid.isWalkable(x + sideX * side, y + sideY * side))
+                            continue;
+                        directionX[directionCount] = sideX * side;
+                        directionY[directionCount++] = sideY * side;
+                        if (openAhead) {
+                            directionX[directionCount] = dx + sideX * side;
+                            directionY[directionCount++] = dy + sideY * side;
+                        }
+                    }
+                    if (openAhead) {
+                        directionX[directionCount] = dx;
+                        directionY[directionCount++] = dy;
+                    }
+                }
+            }
+
+            for (K_UINT i = 0; i < directionCount; ++i) {
+                const K_INT dx = directionX[i];
+                const K_INT dy = directionY[i];
+                if (dx != 0 && dy != 0 && (aGrid.isBlocked(x + dx, y) || aGrid.isBlocked(x, y + dy)))
+                    continue;
+                const K_INT jumpPoint = jump(aGrid, x + dx, y + dy, dx, dy, goalX, goalY);
+                if (jumpPoint < 0)
+                    continue;
+                const K_INT jumpX = jumpPoint % width;
+                const K_INT jumpY = jumpPoint / width;
+                relax(static_cast<KUI_32>(jumpPoint), cell, state.cost + octileDistance(jumpX - x, jumpY - y),
+                      octileDistance(goalX - jumpX, goalY - jumpY));
+            }
+        }
+        return false;
+    }
+
+    void PathSearch::findPath(const NavigationGrid& aGrid, const PathRequest& aRequest, PathResult& aResult) {
+        aResult.waypoints.clear();
+        aResult.cost = 0.0f;
+        aResult.expandedCount = 0;
+
+        K_INT startX, startY, goalX, goalY;
+        aGrid.worldToCell(aRequest.start, startX, startY);
+        aGrid.worldToCell(aRequest.goal, goalX, goalY);
+        if (aGrid.isBlocked(startX, startY) || aGrid.isBlocked(goalX, goalY)) {
+            aResult.status = PathStatus::BlockedEndpoint;
+            return;
+        }
+
+        const K_INT width = static_cast<K_INT>(aGrid.getWidth());
+        const KUI_32 start = static_cast<KUI_32>(startY * width + startX);
+        const KUI_32 goal = static_cast<KUI_32>(goalY * width + goalX);
+        begin(aGrid.getWidth() * aGrid.getHeight());
+        relax(start, start, 0.0f, octileDistance(goalX - startX, goalY - startY));
+        const bool found = aRequest.algorithm == PathAlgorithm::JumpPoint ? expandJumpPoint(aGrid, goal, aResult.expandedCount)
+                                                                         : expandAStar(aGrid, goal, aResult.expandedCount);
+        if (!found) {
+            aResult.status = PathStatus::NoPath;
+            return;
+        }
+        aResult.status = PathStatus::Found;
+        aResult.cost = mCells[goal].cost * aGrid.getCellSize();
+
+        // The exact endpoints replace the centres of their cells.
+        mCellPath.clear();
+        for (KUI_32 cell = goal; cell != start; cell = mCells[cell].parent)
+            mCellPath.push_back(cell);
+        std::vector<Vector2f>& waypoints = aResult.waypoints;
+        waypoints.push_back(aRequest.start);
+        for (size_t i = mCellPath.size(); i-- > 1;)
+            waypoints.push_back(aGrid.cellToWorld(static_cast<K_INT>(mCellPath[i]) % width, static_cast<K_INT>(mCellPath[i]) / width));
+        waypoints.push_back(aRequest.goal);
+
+        if (aRequest.smooth && waypoints.size() > 2) {
+            // String pulling: keep a waypoint only where the line from the last kept one to
+            // the waypoint after it is blocked.
+            size_t kept = 1;
+            Vector2f anchor = waypoints[0];
+            for (size_t i = 1; i + 1 < waypoints.size(); ++i) {
+                if (!aGrid.hasLineOfSight(anchor, waypoints[i + 1])) {
+                    anchor = waypoints[i];
+                    waypoints[kept++] = anchor;
+                }
+            }
+            waypoints[kept++] = waypoints.back();
+            waypoints.resize(kept);
+        }
+    }
+
+    //
+    // PathfindingQueue function definitions.
+    //
+
+    PathfindingQueue::PathfindingQueue(const NavigationGrid& aGrid, K_UINT aThreadCount)
+        : mGrid(aGrid), mThreadCount(std::max(1u, std::min(aThreadCount, MAX_PATHFINDING_THREADS))), mNextRequest(0) { }
+
+    K_UINT PathfindingQueue::submit(const PathRequest& aRequest) {
+        mRequests.push_back(aRequest);
+        if (mResults.size() < mRequests.size())
+            mResults.resize(mRequests.size());
+        return static_cast<K_UINT>(mRequests.size() - 1);
+    }
+
+    void PathfindingQueue::processRequests(K_UINT aSearch) {
+        const K_UINT requestCount = getRequestCount();
+        for (K_UINT request = mNextRequest.fetch_add(1); request < requestCount; request = mNextRequest.fetch_add(1))
+            mSearches[aSearch].findPath(mGrid, mRequests[request], mResults[request]);
+    }
+
+    void PathfindingQueue::processAll() {
+        PROFILE_SCOPE_CATEGORY("PathfindingQueue::processAll", PROFILE_CATEGORY_DEFAULT);
+        // Requests are handed out one at a time, since their costs vary by orders of magnitude.
+        const K_UINT threadCount = std::max(1u, std::min(mThreadCount, getRequestCount()));
+        mNextRequest = 0;
+
+        // Each task owns one PathSearch and claims requests until none are left.
+        WorkerPool::Shared().forEach(threadCount, [this](K_UINT aSearch) {
+            processRequests(aSearch);
+        });
+    }
+}
\ No newline at end of file
@@ -0,0 +1,208 @@
+#pragma once
+
+// Pathfinding.h
+// Grid pathfinding for AI agents: A* and jump point search over a bit packed occupancy grid,
+// string pulled into straight segments, with a queue that runs a frame's requests in parallel.
+//
+// Agents move on 8-connected cells and may not cut the corner of a blocked cell. All scratch
+// memory of a search lives in a PathSearch that is reused from one query to the next; per cell
+// state is tagged with a search generation, so starting a search clears nothing and steady
+// state queries never touch the heap. Jump point search expands the same optimal paths as A*
+// while only pushing cells where the path can turn, which is far fewer on open maps.
+//
+// The grid lies in the XY plane of Vector2f positions. Agents moving in 3D use the XZ ground
+// plane through ToGridPlane.
+
+#include "Common.h"
+#include "KhaosMath.h"
+
+#include <atomic>
+#include <vector>
+
+namespace KhaosEngine
+{
+    using KhaosMath::Vector2f;
+    using KhaosMath::Vector3f;
+
+    // Most searches a PathfindingQueue will run at once.
+    const K_UINT MAX_PATHFINDING_THREADS = 32;
+
+    // Returns the ground plane position of a 3D agent.
+    inline Vector2f ToGridPlane(const Vector3f& aPosition) {
+        return Vector2f(aPosition.x, aPosition.z);
+    }
+
+    // Rectangular grid of walkable and blocked cells, one bit each. Cell (x, y) covers the
+    // square from anOrigin + (x, y) * aCellSize to one cell size further on both axes.
+    class NavigationGrid
+    {
+    public:
+        // Creates a grid with every cell walkable.
+        NavigationGrid(K_UINT aWidth, K_UINT aHeight, float aCellSize, const Vector2f& anOrigin);
+
+        K_UINT getWidth() const { return mWidth; }
+        K_UINT getHeight() const { return mHeight; }
+        float getCellSize() const { return mCellSize; }
+
+        void setBlocked(K_UINT aX, K_UINT aY, bool aBlocked) {
+            ASSERT(aX < mWidth && aY < mHeight);
+            KUI_64& word = mBits[aY * mWordsPerRow + (aX >> 6)];
+            const KUI_64 bit = static_cast<KUI_64>(1) << (aX & 63);
+            word = aBlocked ? (word | bit) : (word & ~bit);
+        }
+
+        // Cells outside the grid count as blocked.
+        bool isBlocked(K_INT aX, K_INT aY) const {
+            if (static_cast<K_UINT>(aX) >= mWidth || static_cast<K_UINT>(aY) >= mHeight)
+                return true;
+            return ((mBits[aY * mWordsPerRow + (aX >> 6)] >> (aX & 63)) & 1) != 0;
+        }
+
+        bool isWalkable(K_INT aX, K_INT aY) const {
+            return !isBlocked(aX, aY);
+        }
+
+        // Returns the cell containing aPosition, which may lie outside the grid.
+        void worldToCell(const Vector2f& aPosition, K_INT& aX, K_INT& aY) const;
+
+        // Returns the centre of a cell.
+        Vector2f cellToWorld(K_INT aX, K_INT aY) const {
+            return Vector2f(mOrigin.x + (aX + 0.5f) * mCellSize, mOrigin.y + (aY + 0.5f) * mCellSize);
+        }
+
+        // Returns true if the segment from aStart to anEnd crosses only walkable cells. Passing
+        // exactly through a corner needs both cells beside the corner to be walkable, matching
+        // the rule that diagonal steps cannot cut corners.
+        bool hasLineOfSight(const Vector2f& aStart, const Vector2f& anEnd) const;
+
+    private:
+        K_UINT mWidth;
+        K_UINT mHeight;
+        K_UINT mWordsPerRow;
+        float mCellSize;
+        Vector2f mOrigin;
+        std::vector<KUI_64> mBits; // Set bits are blocked cells, rows padded to whole words.
+    };
+
+    enum class PathAlgorithm
+    {
+        AStar,
+        JumpPoint
+    };
+
+    enum class PathStatus
+    {
+        Found,
+        NoPath,
+        BlockedEndpoint // The start or goal is outside the grid or in a blocked cell.
+    };
+
+    struct PathRequest
+    {
+        Vector2f start;
+        Vector2f goal;
+        PathAlgorithm algorithm;
+        bool smooth; // String pull the path into the fewest straight segments.
+    };
+
+    struct PathResult
+    {
+        PathStatus status;
+        std::vector<Vector2f> waypoints; // From start to goal, both included.
+        float cost; // Length of the cell path the search found, before smoothing, in world units.
+        K_UINT expandedCount; // Cells taken off the open list.
+    };
+
+    // Scratch memory for one search at a time. Keep one per thread and reuse it.
+    class PathSearch
+    {
+    public:
+        PathSearch()
+            : mGeneration(0) { }
+
+        // Finds a shortest path on aGrid and fills aResult, reusing its waypoint storage.
+        void findPath(const NavigationGrid& aGrid, const PathRequest& aRequest, PathResult& aResult);
+
+    private:
+        struct CellState
+        {
+            float cost; // Cost from the start along the best known path.
+            KUI_32 parent;
+            KUI_32 generation; // The state is stale unless this matches the search.
+            bool closed;
+        };
+
+        struct OpenEntry
+        {
+            float estimate; // Cost so far plus the heuristic.
+            KUI_32 cell;
+
+            // Orders the heap so the lowest estimate is on top.
+            bool operator<(const OpenEntry& other) const {
+                return estimate > other.estimate;
+            }
+        };
+
+        // Starts a search over aCellCount cells.
+        void begin(K_UINT aCellCount);
+
+        // Records aCost as the cost of reaching aCell through aParent if it improves on the
+        // known cost, and pushes aCell onto the open list.
+        void relax(KUI_32 aCell, KUI_32 aParent, float aCost, float aHeuristic);
+
+        bool expandAStar(const NavigationGrid& aGrid, KUI_32 aGoal, K_UINT& anExpandedCount);
+        bool expandJumpPoint(const NavigationGrid& aGrid, KUI_32 aGoal, K_UINT& anExpandedCount);
+
+        // Follows a straight or diagonal line from (aX, aY) and returns the first jump point,
+        // or -1 if the line runs into a wall.
+        K_INT jump(const NavigationGrid& aGrid, K_INT aX, K_INT aY, K_INT aDX, K_INT aDY, K_INT aGoalX, K_INT aGoalY) const;
+
+        std::vector<CellState> mCells;
+        std::vector<OpenEntry> mOpen;
+        std::vector<KUI_32> mCellPath;
+        KUI_32 mGeneration;
+    };
+
+    // Collects a frame's path requests and answers them all at once on the shared worker pool.
+    // Each of the aThreadCount tasks keeps its own PathSearch and results keep their storage,
+    // so after the first few frames nothing is allocated. The grid must not change while
+    // processAll runs.
+    class PathfindingQueue
+    {
+    public:
+        PathfindingQueue(const NavigationGrid& aGrid, K_UINT aThreadCount);
+
+        // Adds a request and returns the ticket its result is read with.
+        K_UINT submit(const PathRequest& aRequest);
+
+        // Answers every request submitted since the last clear. Blocks until all are done.
+        void processAll();
+
+        const PathResult& getResult(K_UINT aTicket) const {
+            ASSERT(aTicket < mRequests.size());
+            return mResults[aTicket];
+        }
+
+        K_UINT getRequestCount() const {
+            return static_cast<K_UINT>(mRequests.size());
+        }
+
+        // Forgets all requests and results, keeping their memory for the next frame.
+        void clear() {
+            mRequests.clear();
+        }
+
+    private:
+        PathfindingQueue(const PathfindingQueue&) = delete;
+        PathfindingQueue& operator=(const PathfindingQueue&) = delete;
+
+        void processRequests(K_UINT aSearch);
+
+        const NavigationGrid& mGrid;
+        K_UINT mThreadCount;
+        std::vector<PathRequest> mRequests;
+        std::vector<PathResult> mResults; // Never shrinks, so waypoint storage is reused.
+        PathSearch mSearches[MAX_PATHFINDING_THREADS];
+        std::atomic<K_UINT> mNextRequest;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+// PoolAllocator.cpp
+// Implementation of the fixed-size block pool.
+
+#include "PoolAllocator.h"
+
+namespace KhaosEngine
+{
+    PoolAllocator::PoolAllocator(size_t aBlockSize, size_t aBlockCount, size_t aAlignment)
+        : mBuffer(nullptr), mFreeList(nullptr), mBlockCount(aBlockCount),
+          mAlignment(aAlignment < sizeof(void*) ? sizeof(void*) : aAlignment), mFreeCount(0) {
+        // Every block must be able to hold a free list link and keep its successor aligned.
+        mBlockSize = AlignUp(aBlockSize < sizeof(FreeBlock) ? sizeof(FreeBlock) : aBlockSize, mAlignment);
+        mBuffer = static_cast<KUI_8*>(AlignedAlloc(mBlockSize * mBlockCount, mAlignment));
+        ASSERT(mBuffer != nullptr);
+        reset();
+    }
+
+    PoolAllocator::~PoolAllocator() {
+        AlignedFree(mBuffer);
+    }
+
+    void PoolAllocator::reset() {
+        mFreeList = nullptr;
+        // Thread the list back to front so blocks are handed out in address order.
+        for (size_t i = mBlockCount; i > 0; --i) {
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(mBuffer + (i - 1) * mBlockSize);
+            block->next = mFreeList;
+            mFreeList = block;
+        }
+        mFreeCount = mBlockCount;
+    }
+}
\ No newline at end of file
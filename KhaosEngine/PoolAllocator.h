@@ -0,0 +1,110 @@
+#pragma once
+
+// PoolAllocator.h
+// Fixed-size block allocators for long-lived engine objects of a single size,
+// such as particles, transform nodes and render batch headers.
+
+#include "Common.h"
+#include "Memory.h"
+
+#include <utility>
+
+namespace KhaosEngine
+{
+    // Hands out equally sized, equally aligned blocks from one preallocated buffer.
+    // Free blocks are threaded into an intrusive singly linked list, so allocate and
+    // deallocate are both O(1) and never touch the heap. Not thread safe.
+    class PoolAllocator
+    {
+    public:
+        // Reserves aBlockCount blocks of at least aBlockSize bytes, each aligned to aAlignment.
+        PoolAllocator(size_t aBlockSize, size_t aBlockCount, size_t aAlignment = SIMD_ALIGNMENT);
+        ~PoolAllocator();
+
+        // Returns a free block, or nullptr when the pool is exhausted.
+        void* allocate() {
+            if (!mFreeList) {
+                ASSERT(!"PoolAllocator exhausted");
+                return nullptr;
+            }
+            FreeBlock* block = mFreeList;
+            mFreeList = block->next;
+            --mFreeCount;
+            return block;
+        }
+
+        // Returns a block to the pool. aPointer must have come from this pool.
+        void deallocate(void* aPointer) {
+            if (!aPointer)
+                return;
+            ASSERT(owns(aPointer));
+            FreeBlock* block = static_cast<FreeBlock*>(aPointer);
+            block->next = mFreeList;
+            mFreeList = block;
+            ++mFreeCount;
+        }
+
+        // Returns every block to the pool at once.
+        void reset();
+
+        // Determine if a pointer lies inside this pool's buffer.
+        bool owns(const void* aPointer) const {
+            const KUI_8* address = static_cast<const KUI_8*>(aPointer);
+            return address >= mBuffer && address < mBuffer + mBlockSize * mBlockCount;
+        }
+
+        size_t getBlockSize() const { return mBlockSize; }
+        size_t getBlockCount() const { return mBlockCount; }
+        size_t getAlignment() const { return mAlignment; }
+        size_t getFreeCount() const { return mFreeCount; }
+        size_t getUsedCount() const { return mBlockCount - mFreeCount; }
+
+    private:
+        PoolAllocator(const PoolAllocator&) = delete;
+        PoolAllocator& operator=(const PoolAllocator&) = delete;
+
+        struct FreeBlock
+        {
+            FreeBlock* next;
+        };
+
+        KUI_8* mBuffer;
+        FreeBlock* mFreeList;
+        size_t mBlockSize;
+        size_t mBlockCount;
+        size_t mAlignment;
+        size_t mFreeCount;
+    };
+
+    // Typed pool that constructs and destroys objects of type T in place.
+    template <typename T>
+    class ObjectPool
+    {
+    public:
+        explicit ObjectPool(size_t aCapacity)
+            : mPool(sizeof(T), aCapacity,
+                    __alignof(T) > SIMD_ALIGNMENT ? __alignof(T) : SIMD_ALIGNMENT) { }
+
+        // Allocates and constructs an object. Returns nullptr when the pool is exhausted.
+        template <typename... Args>
+        T* create(Args&&... someArgs) {
+            void* memory = mPool.allocate();
+            return memory ? new (memory) T(std::forward<Args>(someArgs)...) : nullptr;
+        }
+
+        // Destroys an object and returns its block to the pool.
+        void destroy(T* anObject) {
+            if (!anObject)
+                return;
+            anObject->~T();
+            mPool.deallocate(anObject);
+        }
+
+        size_t getFreeCount() const { return mPool.getFreeCount(); }
+        size_t getUsedCount() const { return mPool.getUsedCount(); }
+        size_t getCapacity() const { return mPool.getBlockCount(); }
+
+    private:
+        PoolAllocator mPool;
+    };
+}
\ No newline at end of file
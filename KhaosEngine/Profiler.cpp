@@ -0,0 +1,167 @@
+// Profiler.cpp
+// Thread buffer registration, timestamp calibration and Chrome trace export.
+
+#include "Profiler.h"
+#include "Memory.h"
+
+#include <chrono>
+#include <fstream>
+#include <new>
+#include <vector>
+
+using namespace std::chrono;
+
+namespace
+{
+    using KhaosEngine::Profiler;
+    using KhaosEngine::ProfileEvent;
+    using KhaosEngine::ProfileThreadBuffer;
+
+    // Registered buffers. Slots are claimed with sThreadCount and never released, so exported
+    // traces still contain zones from threads that have since exited.
+    std::atomic<ProfileThreadBuffer*> sThreadBuffers[Profiler::MAX_THREADS];
+    std::atomic<K_UINT> sThreadCount;
+
+    // Calibration origin, taken when the program starts.
+    const KUI_64 sTickOrigin = Profiler::ReadTicks();
+    const steady_clock::time_point sClockOrigin = steady_clock::now();
+
+    // Plain pointer so it can live in static TLS without a constructor.
+    __declspec(thread) ProfileThreadBuffer* tThreadBuffer = nullptr;
+    __declspec(thread) bool tRegistrationFailed = false;
+
+    void writeJsonString(std::ostream& aStream, const char* aString) {
+        aStream << '"';
+        for (const char* c = aString ? aString : ""; *c; ++c) {
+            if (*c == '"' || *c == '\\')
+                aStream << '\\' << *c;
+            else if (static_cast<unsigned char>(*c) < 0x20)
+                aStream << ' ';
+            else
+                aStream << *c;
+        }
+        aStream << '"';
+    }
+}
+
+namespace KhaosEngine
+{
+    ProfileThreadBuffer* Profiler::GetThreadBuffer() {
+        if (tThreadBuffer || tRegistrationFailed)
+            return tThreadBuffer;
+
+        const K_UINT slot = sThreadCount.fetch_add(1, std::memory_order_relaxed);
+        if (slot >= MAX_THREADS) {
+            tRegistrationFailed = true;
+            return nullptr;
+        }
+
+        // One allocation per thread, made the first time that thread records a zone.
+        void* memory = AlignedAlloc(sizeof(ProfileThreadBuffer), 64);
+        ProfileThreadBuffer* buffer = new (memory) ProfileThreadBuffer;
+        buffer->head.store(0, std::memory_order_relaxed);
+        buffer->threadIndex = slot;
+        buffer->threadName = nullptr;
+
+        sThreadBuffers[slot].store(buffer, std::memory_order_release);
+        tThreadBuffer = buffer;
+        return buffer;
+    }
+
+    void Profiler::SetThreadName(const char* aName) {
+        ProfileThreadBuffer* buffer = GetThreadBuffer();
+        if (buffer)
+            buffer->threadName = aName;
+    }
+
+    void Profiler::Clear() {
+        // Rewinding each head empties its buffer. The owning thread also writes head while
+        // recording, so only call this while no zones are open.
+        const K_UINT count = sThreadCount.load(std::memory_order_acquire);
+        for (K_UINT i = 0; i < count && i < MAX_THREADS; ++i) {
+            ProfileThreadBuffer* buffer = sThreadBuffers[i].load(std::memory_order_acquire);
+            if (buffer)
+                buffer->head.store(0, std::memory_order_release);
+        }
+    }
+
+    void Profiler::CopyEvents(const ProfileThreadBuffer& aBuffer, std::vector<ProfileEvent>& someEvents) {
+        const KUI_64 capacity = ProfileThreadBuffer::CAPACITY;
+        const KUI_64 head = aBuffer.head.load(std::memory_order_acquire);
+        const KUI_64 first = head > capacity ? head - capacity : 0;
+
+        someEvents.clear();
+        for (KUI_64 i = first; i < head; ++i)
+            someEvents.push_back(aBuffer.events[i & (capacity - 1)]);
+
+        // The owner may be writing index newHead right now, which reuses slot newHead - capacity.
+        const KUI_64 newHead = aBuffer.head.load(std::memory_order_acquire);
+        const KUI_64 firstValid = newHead + 1 > capacity ? newHead + 1 - capacity : 0;
+        if (firstValid > first) {
+            const size_t stale = static_cast<size_t>(firstValid - first);
+            someEvents.erase(someEvents.begin(),
+                             someEvents.begin() + (stale < someEvents.size() ? stale : someEvents.size()));
+        }
+    }
+
+    double Profiler::GetTicksPerMicrosecond() {
+        // Make sure enough wall time has passed for a stable estimate.
+        steady_clock::time_point now = steady_clock::now();
+        while (duration_cast<microseconds>(now - sClockOrigin).count() < 10000)
+            now = steady_clock::now();
+
+        const KUI_64 ticks = ReadTicks() - sTickOrigin;
+        const double elapsed = static_cast<double>(duration_cast<nanoseconds>(now - sClockOrigin).count()) / 1000.0;
+        return static_cast<double>(ticks) / elapsed;
+    }
+
+    bool Profiler::WriteChromeTrace(const char* aFilePath) {
+        std::ofstream stream(aFilePath);
+        if (!stream)
+            return false;
+
+        const double ticksPerMicrosecond = GetTicksPerMicrosecond();
+        std::vector<ProfileEvent> events;
+        events.reserve(ProfileThreadBuffer::CAPACITY);
+        bool firstEntry = true;
+
+        stream.setf(std::ios::fixed);
+        stream.precision(3);
+        stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+        const K_UINT count = sThreadCount.load(std::memory_order_acquire);
+        for (K_UINT i = 0; i < count && i < MAX_THREADS; ++i) {
+            const ProfileThreadBuffer* buffer = sThreadBuffers[i].load(std::memory_order_acquire);
+            if (!buffer)
+                continue;
+
+            if (buffer->threadName) {
+                stream << (firstEntry ? "" : ",\n");
+                stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadIndex
+                       << ",\"args\":{\"name\":";
+                writeJsonString(stream, buffer->threadName);
+                stream << "}}";
+                firstEntry = false;
+            }
+
+            CopyEvents(*buffer, events);
+            for (size_t e = 0; e < events.size(); ++e) {
+                const ProfileEvent& event = events[e];
+                const double start = static_cast<double>(static_cast<KI_64>(event.startTicks - sTickOrigin)) / ticksPerMicrosecond;
+                const double duration = static_cast<double>(event.endTicks - event.startTicks) / ticksPerMicrosecond;
+
+                stream << (firstEntry ? "" : ",\n");
+                stream << "{\"name\":";
+                writeJsonString(stream, event.name);
+                stream << ",\"cat\":";
+                writeJsonString(stream, event.category);
+                stream << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadIndex
+                       << ",\"ts\":" << start << ",\"dur\":" << duration << "}";
+                firstEntry = false;
+            }
+        }
+
+        stream << "\n]}\n";
+        return static_cast<bool>(stream);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,120 @@
+#pragma once
+
+// Profiler.h
+// Low overhead CPU profiler. Zones are timed with rdtsc and written into a lock-free ring
+// buffer owned by the recording thread, then exported as Chrome trace JSON which loads in
+// chrome://tracing and the Perfetto UI.
+//
+//     void cullScene() {
+//         PROFILE_SCOPE_CATEGORY("cullScene", PROFILE_CATEGORY_CULLING);
+//         ...
+//     }
+
+#include "Common.h"
+
+#include <atomic>
+#include <intrin.h>
+#include <vector>
+
+// Categories used to group zones in the trace viewer.
+#define PROFILE_CATEGORY_DEFAULT "default"
+#define PROFILE_CATEGORY_MATH "math"
+#define PROFILE_CATEGORY_CULLING "culling"
+#define PROFILE_CATEGORY_RENDER "render"
+#define PROFILE_CATEGORY_ASSET "asset"
+#define PROFILE_CATEGORY_NETWORK "network"
+#define PROFILE_CATEGORY_FRAME "frame"
+
+namespace KhaosEngine
+{
+    // A single completed zone. Names and categories must be string literals or otherwise
+    // outlive the profiler, only the pointers are stored.
+    struct ProfileEvent
+    {
+        const char* name;
+        const char* category;
+        KUI_64 startTicks;
+        KUI_64 endTicks;
+    };
+
+    // Fixed-capacity ring of events written by exactly one thread. The owning thread is the
+    // only writer; exporters read concurrently and discard anything overwritten mid-copy.
+    struct ProfileThreadBuffer
+    {
+        static const K_UINT CAPACITY = 1 << 16; // Must be a power of two.
+
+        ProfileEvent events[CAPACITY];
+        std::atomic<KUI_64> head;
+        K_UINT threadIndex;
+        const char* threadName;
+    };
+
+    class Profiler
+    {
+    public:
+        // Maximum number of threads that can record zones over the life of the process.
+        static const K_UINT MAX_THREADS = 64;
+
+        // Reads the CPU timestamp counter.
+        static KUI_64 ReadTicks() {
+            return __rdtsc();
+        }
+
+        // Appends a completed zone to the calling thread's ring buffer.
+        static void Record(const char* aName, const char* aCategory, KUI_64 aStart, KUI_64 anEnd) {
+            ProfileThreadBuffer* buffer = GetThreadBuffer();
+            if (!buffer)
+                return;
+            const KUI_64 head = buffer->head.load(std::memory_order_relaxed);
+            ProfileEvent& event = buffer->events[head & (ProfileThreadBuffer::CAPACITY - 1)];
+            event.name = aName;
+            event.category = aCategory;
+            event.startTicks = aStart;
+            event.endTicks = anEnd;
+            buffer->head.store(head + 1, std::memory_order_release);
+        }
+
+        // Labels the calling thread in exported traces.
+        static void SetThreadName(const char* aName);
+
+        // Writes every buffered zone from every thread as Chrome trace event JSON.
+        // Returns false if the file could not be opened.
+        static bool WriteChromeTrace(const char* aFilePath);
+
+        // Discards all buffered zones.
+        static void Clear();
+
+        // Copies the events still held by aBuffer, oldest first. Safe while the owning thread
+        // records; events it overwrote during the copy are left out.
+        static void CopyEvents(const ProfileThreadBuffer& aBuffer, std::vector<ProfileEvent>& someEvents);
+
+        // Estimated timestamp counter frequency, measured against the system clock.
+        static double GetTicksPerMicrosecond();
+
+    private:
+        // Returns the calling thread's buffer, registering one on first use.
+        static ProfileThreadBuffer* GetThreadBuffer();
+    };
+
+    // Times its own lifetime and records it as a zone. Use through the PROFILE_* macros.
+    class ProfileScope
+    {
+    public:
+        ProfileScope(const char* aName, const char* aCategory)
+            : mName(aName), mCategory(aCategory), mStart(Profiler::ReadTicks()) { }
+
+        ~ProfileScope() {
+            Profiler::Record(mName, mCategory, mStart, Profiler::ReadTicks());
+        }
+
+    private:
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+        const char* mName;
+        const char* mCategory;
+        KUI_64 mStart;
+    };
+}
+
+#include "ProfilerMacros.h"
\ No newline at end of file
@@ -0,0 +1,35 @@
+// ProfilerMacros.h
+// The PROFILE_* zone macros, defined from the current value of PROFILER_ENABLED. Included by
+// Profiler.h. Like <assert.h> it has no include guard, so a file can change PROFILER_ENABLED
+// and include it again to switch zones on or off for the code that follows.
+
+#undef PROFILE_SCOPE_CATEGORY
+#undef PROFILE_SCOPE
+#undef PROFILE_FUNCTION
+#undef PROFILE_THREAD_NAME
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if PROFILER_ENABLED
+
+#define PROFILE_SCOPE_CATEGORY(name, category) \
+	KhaosEngine::ProfileScope PROFILE_CONCAT(profileScope, __LINE__)((name), (category))
+
+#define PROFILE_SCOPE(name) \
+	PROFILE_SCOPE_CATEGORY(name, PROFILE_CATEGORY_DEFAULT)
+
+#define PROFILE_FUNCTION() \
+	PROFILE_SCOPE_CATEGORY(__FUNCTION__, PROFILE_CATEGORY_DEFAULT)
+
+#define PROFILE_THREAD_NAME(name) \
+	KhaosEngine::Profiler::SetThreadName(name)
+
+#else
+
+#define PROFILE_SCOPE_CATEGORY(name, category)
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#define PROFILE_THREAD_NAME(name)
+
+#endif
\ No newline at end of file
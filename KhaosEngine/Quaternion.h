@@ -15,42 +15,30 @@ namespace KhaosMath
         float x, y, z, w;
 
         // Default constructor will zero all elements.
-        Quaternion()
+        constexpr Quaternion()
             : x(0.0f), y(0.0f), z(0.0f), w(0.0f) { };
 
         // Constructor to explicitly initialize all elements.
-        Quaternion(float aX, float aY, float aZ, float aW)
+        constexpr Quaternion(float aX, float aY, float aZ, float aW)
             : x(aX), y(aY), z(aZ), w(aW) { };
 
         // Constructor to explicitly initialize all elements.
-        Quaternion(const Vector3f aVector, float aW)
+        constexpr Quaternion(const Vector3f aVector, float aW)
             : x(aVector.x), y(aVector.y), z(aVector.z), w(aW) { };
 
-        // Copy constructor.
-        Quaternion(const Quaternion& other)
-            : x(other.x), y(other.y), z(other.z), w(other.w) { }
-
-        // Move constructor.
-        Quaternion(Quaternion&& other)
-            : x(std::move(other.x)), y(std::move(other.y)), 
-              z(std::move(other.z)), w(std::move(other.w)) { }
-
-        // Assignment operator.
-        Quaternion& operator=(const Quaternion& other) {
-            this->x = other.x;
-            this->y = other.y;
-            this->z = other.z;
-            this->w = other.w;
-            return *this;
-        }
+        // Copies are trivial so the type stays in registers and can be moved with memcpy.
+        constexpr Quaternion(const Quaternion& other) = default;
+        constexpr Quaternion(Quaternion&& other) = default;
+        Quaternion& operator=(const Quaternion& other) = default;
+        Quaternion& operator=(Quaternion&& other) = default;
 
         // Create a vector by adding each component of this quaternion.
-        Quaternion operator+(const Quaternion& other) const {
+        constexpr Quaternion operator+(const Quaternion& other) const {
             return Quaternion(x + other.x, y + other.y, z + other.z, w + other.w);
         }
 
         // Create a quaternion by multiplying each component of this quaternion.
-        Quaternion operator*(const float aScalar) const {
+        constexpr Quaternion operator*(const float aScalar) const {
             return Quaternion(x * aScalar, y * aScalar, z * aScalar, w * aScalar);
         }
 
@@ -61,18 +49,17 @@ namespace KhaosMath
         }
 
         // Returns the Grassman product between this Quaternion and another.
-        Quaternion operator*(const Quaternion& other) const {
-            const Vector3f vectorA = this->getVectorPart();
-            const Vector3f vectorB = other.getVectorPart();
-            Vector3f vectorPart = (vectorB * w) + vectorA * other.w +
-                                   vectorA.crossProduct(vectorB);
-
-            float scalarPart = w * other.w - vectorA.dot(vectorB);
-            return Quaternion(vectorPart, scalarPart);
+        // Written per component so no intermediate vectors are built for the vector part,
+        // which is other.xyz * w + xyz * other.w + cross(xyz, other.xyz).
+        constexpr Quaternion operator*(const Quaternion& other) const {
+            return Quaternion(other.x * w + x * other.w + (y * other.z - z * other.y),
+                              other.y * w + y * other.w + (z * other.x - x * other.z),
+                              other.z * w + z * other.w + (x * other.y - y * other.x),
+                              w * other.w - (x * other.x + y * other.y + z * other.z));
         }
 
         // Modify this quaternion by adding each component.
-        Quaternion operator+=(const Quaternion& other) {
+        constexpr Quaternion& operator+=(const Quaternion& other) {
             x += other.x;
             y += other.y;
             z += other.z;
@@ -81,7 +68,7 @@ namespace KhaosMath
         }
 
         // Modify this quaternion by multiplying each component.
-        Quaternion operator*=(const float aScalar) {
+        constexpr Quaternion& operator*=(const float aScalar) {
             x *= aScalar;
             y *= aScalar;
             z *= aScalar;
@@ -90,7 +77,7 @@ namespace KhaosMath
         }
 
         // Modify this quaternion by dividing each component.
-        Quaternion operator/=(const float aScalar) {
+        Quaternion& operator/=(const float aScalar) {
             this->x /= aScalar;
             this->y /= aScalar;
             this->z /= aScalar;
@@ -99,26 +86,27 @@ namespace KhaosMath
         }
 
         // Determine if this quaternion is component-wise equal to another quaternion.
-        bool operator==(const Quaternion& other) const {
+        constexpr bool operator==(const Quaternion& other) const {
             return x == other.x && y == other.y && z == other.z && w == other.w;
         }
 
         // Determine if this quaternion is component-wise not equal to another quaternion.
-        bool operator!=(const Quaternion& other) const {
+        constexpr bool operator!=(const Quaternion& other) const {
             return !(*this == other);
         }
 
+        // Loads x, y, z, w into lanes 0 to 3, the order _mm_loadu_ps would read them from memory.
         operator __m128() const {
-            return _mm_set_ps(x, y, z, w);
+            return _mm_setr_ps(x, y, z, w);
         }
 
         // Returns the dot product of this quaternion and another quaternion.
-        float dot(const Quaternion& other) const {
+        constexpr float dot(const Quaternion& other) const {
             return x * other.x + y * other.y + z * other.z + w * other.w;
         }
 
         // Returns the dot product between two vectors.
-        static float DotProduct(const Quaternion& aQuat, const Quaternion& bQuat) {
+        static constexpr float DotProduct(const Quaternion& aQuat, const Quaternion& bQuat) {
             return aQuat.x * bQuat.x + aQuat.y * bQuat.y +
                    aQuat.z * bQuat.z + aQuat.w * bQuat.w;
         }
@@ -129,22 +117,22 @@ namespace KhaosMath
         }
 
         // Get the magnitude squared of this vector, which does not use a sqrt operation.
-        float getMagnitudeSquared() const {
+        constexpr float getMagnitudeSquared() const {
             return x * x + y * y + z * z + w * w;
         }
 
         // Returns the vector part of this quaternion.
-        Vector3f getVectorPart() const {
+        constexpr Vector3f getVectorPart() const {
             return Vector3f(x, y, z);
         }
 
         // Returns the conjugate of this quaternion.
-        Quaternion getConjugate() const {
+        constexpr Quaternion getConjugate() const {
             return Quaternion(-x, -y, -z, w);
         }
 
         // Returns the inverse of this unit quaternion.
-        Quaternion getUnitInverse() const {
+        constexpr Quaternion getUnitInverse() const {
             return Quaternion(-x, -y, -z, w);
         }
 
@@ -153,51 +141,71 @@ namespace KhaosMath
             return getConjugate() / getMagnitudeSquared();
         }
 
+        // Returns aQuat * aScalar + bQuat in one pass, without an intermediate quaternion.
+        static constexpr Quaternion MultiplyAdd(const Quaternion& aQuat, float aScalar, const Quaternion& bQuat) {
+            return Quaternion(aQuat.x * aScalar + bQuat.x,
+                              aQuat.y * aScalar + bQuat.y,
+                              aQuat.z * aScalar + bQuat.z,
+                              aQuat.w * aScalar + bQuat.w);
+        }
+
+        // Returns aQuat * aWeight + bQuat * bWeight in one pass, without intermediate quaternions.
+        static constexpr Quaternion WeightedSum(const Quaternion& aQuat, float aWeight,
+                                                const Quaternion& bQuat, float bWeight) {
+            return Quaternion(aQuat.x * aWeight + bQuat.x * bWeight,
+                              aQuat.y * aWeight + bQuat.y * bWeight,
+                              aQuat.z * aWeight + bQuat.z * bWeight,
+                              aQuat.w * aWeight + bQuat.w * bWeight);
+        }
+
+        // Adds other * aScalar onto this quaternion, modifying the original quaternion.
+        constexpr Quaternion& addScaled(const Quaternion& other, float aScalar) {
+            x += other.x * aScalar;
+            y += other.y * aScalar;
+            z += other.z * aScalar;
+            w += other.w * aScalar;
+            return *this;
+        }
+
         // Spherical Linear Interpolation between two quaternions.
         // Beta will be clamped between [0,1] inclusive.
         Quaternion slerpWith(const Quaternion& other, float beta) const {
-            beta = ClampInclusive(beta, 0.0f, 1.0f);
-            float theta = acosf((*this).dot(other));
-            float sinTeta = sinf(theta);
-            float omegaFirst = sinf(1 - beta) * theta / sinTeta;
-            float omegaSecond = sinf(beta * theta) / sinTeta;
-
-            return ((*this) * omegaFirst) + (other * omegaSecond);
+            return SlerpNoClamp(*this, other, ClampInclusive(beta, 0.0f, 1.0f));
         }
 
         // Spherical Linear Interpolation between two quaternions.
         // Beta will be clamped between [0,1] inclusive.
         static Quaternion Slerp(const Quaternion& aQuat, const Quaternion& bQuat, float beta) {
-            beta = ClampInclusive(beta, 0.0f, 1.0f);
-            float theta = acosf(aQuat.dot(bQuat));
-            float sinTeta = sinf(theta);
-            float omegaFirst = sinf(1 - beta) * theta / sinTeta;
-            float omegaSecond = sinf(beta * theta) / sinTeta;
-
-            return (aQuat * omegaFirst) + (bQuat * omegaSecond);
+            return SlerpNoClamp(aQuat, bQuat, ClampInclusive(beta, 0.0f, 1.0f));
         }
 
         // Spherical Linear Interpolation between two quaternions.
         // Beta must be clamped between [0,1], inclusive, before calling to ensure correct result.
         Quaternion slerpNoClampWith(const Quaternion& other, float beta) const {
-            float theta = acosf((*this).dot(other));
-            float sinTeta = sinf(theta);
-            float omegaFirst = sinf(1 - beta) * theta / sinTeta;
-            float omegaSecond = sinf(beta * theta) / sinTeta;
-
-            return ((*this) * omegaFirst) + (other * omegaSecond);
+            return SlerpNoClamp(*this, other, beta);
         }
 
-        // Spherical Linear Interpolation between two quaternions.
+        // Spherical Linear Interpolation between two quaternions along the shorter arc.
         // Beta must be clamped between [0,1], inclusive, before calling to ensure correct result.
+        // Nearly parallel rotations fall back to a normalized lerp, where sin(theta) is too
+        // small to divide by.
         static Quaternion SlerpNoClamp(const Quaternion& aQuat,
                                        const Quaternion& bQuat, float beta) {
-            float theta = acosf(aQuat.dot(bQuat));
-            float sinTeta = sinf(theta);
-            float omegaFirst = sinf(1 - beta) * theta / sinTeta;
-            float omegaSecond = sinf(beta * theta) / sinTeta;
-
-            return (aQuat * omegaFirst) + (bQuat * omegaSecond);
+            // q and -q are the same rotation, so b is flipped onto a's side of the sphere.
+            const float dot = aQuat.dot(bQuat);
+            const float cosTheta = fabsf(dot);
+            const float sign = dot < 0.0f ? -1.0f : 1.0f;
+            if (cosTheta <= 0.9995f) {
+                const float theta = acosf(cosTheta);
+                const float sinTheta = sinf(theta);
+                if (sinTheta > 0.0f) {
+                    const float omegaFirst = sinf((1.0f - beta) * theta) / sinTheta;
+                    const float omegaSecond = sinf(beta * theta) / sinTheta;
+                    return WeightedSum(aQuat, omegaFirst, bQuat, omegaSecond * sign);
+                }
+            }
+            const Quaternion blended = WeightedSum(aQuat, 1.0f - beta, bQuat, beta * sign);
+            return blended * (1.0f / blended.getMagnitude());
         }
     };
 }
\ No newline at end of file
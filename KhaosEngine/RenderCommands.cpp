@@ -0,0 +1,182 @@
+// RenderCommands.cpp
+// Command list storage, key sorting and SDL replay.
+
+#include "RenderCommands.h"
+#include "Memory.h"
+#include "Profiler.h"
+
+#include <SDL.h>
+
+#include <cstring>
+#include <new>
+
+namespace
+{
+    using namespace KhaosEngine;
+
+    // Radix sort digit width. Eight passes of eight bits cover a 64-bit key.
+    const K_UINT RADIX_BITS = 8;
+    const K_UINT RADIX_SIZE = 1 << RADIX_BITS;
+
+    // Returns true when two colors are identical.
+    inline bool sameColor(RenderColor aColor, RenderColor bColor) {
+        return aColor.r == bColor.r && aColor.g == bColor.g && aColor.b == bColor.b && aColor.a == bColor.a;
+    }
+
+    inline SDL_Rect toSdlRect(const RenderRect& aRect) {
+        SDL_Rect rect = { aRect.x, aRect.y, aRect.w, aRect.h };
+        return rect;
+    }
+}
+
+namespace KhaosEngine
+{
+    //
+    // RenderCommandBuffer function definitions.
+    //
+
+    RenderCommandBuffer::RenderCommandBuffer(K_UINT aMaxLists, K_UINT aCommandsPerList)
+        : mMaxLists(aMaxLists), mAcquiredLists(0), mSortedCount(0) {
+        const size_t totalCommands = static_cast<size_t>(aMaxLists) * aCommandsPerList;
+        mLists = static_cast<RenderCommandList*>(AlignedAlloc(sizeof(RenderCommandList) * aMaxLists, __alignof(RenderCommandList)));
+        mCommandStorage = static_cast<RenderCommand*>(AlignedAlloc(sizeof(RenderCommand) * totalCommands, SIMD_ALIGNMENT));
+        mSorted = static_cast<SortEntry*>(AlignedAlloc(sizeof(SortEntry) * totalCommands, SIMD_ALIGNMENT));
+        mSortScratch = static_cast<SortEntry*>(AlignedAlloc(sizeof(SortEntry) * totalCommands, SIMD_ALIGNMENT));
+        ASSERT(mLists && mCommandStorage && mSorted && mSortScratch);
+
+        for (K_UINT i = 0; i < aMaxLists; ++i) {
+            new (&mLists[i]) RenderCommandList();
+            mLists[i].mCommands = mCommandStorage + static_cast<size_t>(i) * aCommandsPerList;
+            mLists[i].mCapacity = aCommandsPerList;
+        }
+    }
+
+    RenderCommandBuffer::~RenderCommandBuffer() {
+        AlignedFree(mSortScratch);
+        AlignedFree(mSorted);
+        AlignedFree(mCommandStorage);
+        AlignedFree(mLists);
+    }
+
+    RenderCommandList* RenderCommandBuffer::acquireList() {
+        const K_UINT index = mAcquiredLists.fetch_add(1, std::memory_order_relaxed);
+        return index < mMaxLists ? &mLists[index] : nullptr;
+    }
+
+    K_UINT RenderCommandBuffer::getDroppedListCount() const {
+        const K_UINT listCount = mAcquiredLists.load(std::memory_order_acquire);
+        return listCount > mMaxLists ? listCount - mMaxLists : 0;
+    }
+
+    K_UINT RenderCommandBuffer::getDroppedCommandCount() const {
+        const K_UINT listCount = mAcquiredLists.load(std::memory_order_acquire);
+        const K_UINT usedLists = listCount < mMaxLists ? listCount : mMaxLists;
+        K_UINT dropped = 0;
+        for (K_UINT i = 0; i < usedLists; ++i)
+            dropped += mLists[i].mDroppedCount;
+        return dropped;
+    }
+
+    void RenderCommandBuffer::sort() {
+        PROFILE_SCOPE_CATEGORY("RenderCommandBuffer::sort", PROFILE_CATEGORY_RENDER);
+
+        // Gather in acquisition order so equal keys keep recording order through the stable sort.
+        const K_UINT listCount = mAcquiredLists.load(std::memory_order_acquire);
+        const K_UINT usedLists = listCount < mMaxLists ? listCount : mMaxLists;
+        K_UINT count = 0;
+        KUI_64 differingBits = 0;
+        for (K_UINT i = 0; i < usedLists; ++i) {
+            const RenderCommandList& list = mLists[i];
+            for (K_UINT j = 0; j < list.mCount; ++j) {
+                mSorted[count].key = list.mCommands[j].key;
+                mSorted[count].command = &list.mCommands[j];
+                differingBits |= mSorted[count].key ^ mSorted[0].key;
+                ++count;
+            }
+        }
+        mSortedCount = count;
+
+        // Least significant digit radix sort. Digits every key shares are skipped, which
+        // leaves only a few passes for typical keys.
+        SortEntry* source = mSorted;
+        SortEntry* destination = mSortScratch;
+        for (K_UINT shift = 0; shift < 64; shift += RADIX_BITS) {
+            if (((differingBits >> shift) & (RADIX_SIZE - 1)) == 0)
+                continue;
+
+            K_UINT offsets[RADIX_SIZE];
+            memset(offsets, 0, sizeof(offsets));
+            for (K_UINT i = 0; i < count; ++i)
+                ++offsets[(source[i].key >> shift) & (RADIX_SIZE - 1)];
+
+            K_UINT total = 0;
+            for (K_UINT digit = 0; digit < RADIX_SIZE; ++digit) {
+                const K_UINT digitCount = offsets[digit];
+                offsets[digit] = total;
+                total += digitCount;
+            }
+
+            for (K_UINT i = 0; i < count; ++i)
+                destination[offsets[(source[i].key >> shift) & (RADIX_SIZE - 1)]++] = source[i];
+
+            SortEntry* swap = source;
+            source = destination;
+            destination = swap;
+        }
+
+        if (source != mSorted)
+            memcpy(mSorted, source, sizeof(SortEntry) * count);
+    }
+
+    void RenderCommandBuffer::reset() {
+        const K_UINT listCount = mAcquiredLists.load(std::memory_order_relaxed);
+        const K_UINT usedLists = listCount < mMaxLists ? listCount : mMaxLists;
+        for (K_UINT i = 0; i < usedLists; ++i) {
+            mLists[i].mCount = 0;
+            mLists[i].mDroppedCount = 0;
+        }
+        mAcquiredLists.store(0, std::memory_order_relaxed);
+        mSortedCount = 0;
+    }
+
+    //
+    // SDL replay.
+    //
+
+    void ReplayOnSdl(const RenderCommandBuffer& aBuffer, SDL_Renderer* aRenderer) {
+        PROFILE_SCOPE_CATEGORY("ReplayOnSdl", PROFILE_CATEGORY_RENDER);
+
+        bool colorSet = false;
+        RenderColor currentColor = { 0, 0, 0, 0 };
+        const auto setColor = [&](RenderColor aColor) {
+            if (colorSet && sameColor(aColor, currentColor))
+                return;
+            SDL_SetRenderDrawColor(aRenderer, aColor.r, aColor.g, aColor.b, aColor.a);
+            currentColor = aColor;
+            colorSet = true;
+        };
+
+        for (K_UINT i = 0; i < aBuffer.getSortedCount(); ++i) {
+            const RenderCommand& command = aBuffer.getSorted(i);
+            switch (command.type) {
+            case RenderCommandType::Clear:
+                setColor(command.color);
+                SDL_RenderClear(aRenderer);
+                break;
+            case RenderCommandType::FillRect: {
+                const SDL_Rect destination = toSdlRect(command.destination);
+                setColor(command.color);
+                SDL_RenderFillRect(aRenderer, &destination);
+                break;
+            }
+            case RenderCommandType::DrawTexture: {
+                const SDL_Rect source = toSdlRect(command.source);
+                const SDL_Rect destination = toSdlRect(command.destination);
+                SDL_RenderCopyEx(aRenderer, command.texture, command.source.w > 0 ? &source : nullptr,
+                                 &destination, command.angle, nullptr, SDL_FLIP_NONE);
+                break;
+            }
+            }
+        }
+    }
+}
\ No newline at end of file
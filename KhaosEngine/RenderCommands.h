@@ -0,0 +1,191 @@
+#pragma once
+
+// RenderCommands.h
+// Sortable render command buffer between the threads that decide what to draw and the
+// thread that owns the SDL renderer.
+//
+// Each recording job acquires its own RenderCommandList and appends commands to it with
+// plain stores; the only shared write is the atomic increment in acquireList, so recording
+// never takes a lock. Once every job has finished, the render thread sorts all lists by
+// their 64-bit keys and replays them against SDL:
+//
+//     RenderCommandList* list = commands.acquireList();   // any thread
+//     list->drawTexture(MakeRenderKey(1, depth, textureId), texture, nullptr, rect);
+//     ...
+//     commands.sort();                                    // render thread
+//     ReplayOnSdl(commands, renderer);
+//     SDL_RenderPresent(renderer);
+//     commands.reset();
+//
+// To record frame N + 1 while frame N replays, keep two buffers and alternate.
+
+#include "Common.h"
+
+#include <atomic>
+
+struct SDL_Renderer;
+struct SDL_Texture;
+
+namespace KhaosEngine
+{
+    // Builds a sort key. Commands sort by layer first, then by depth, then by material, so
+    // within a layer larger depths draw later. The bit layout is
+    // [63..56] layer, [55..32] depth, [31..0] material.
+    inline KUI_64 MakeRenderKey(KUI_8 aLayer, KUI_32 aDepth, KUI_32 aMaterial) {
+        ASSERT(aDepth < (1u << 24));
+        return (static_cast<KUI_64>(aLayer) << 56) | (static_cast<KUI_64>(aDepth) << 32) | aMaterial;
+    }
+
+    // Integer rectangle laid out like SDL_Rect.
+    struct RenderRect
+    {
+        K_INT x, y, w, h;
+    };
+
+    struct RenderColor
+    {
+        KUI_8 r, g, b, a;
+    };
+
+    enum class RenderCommandType : KUI_8
+    {
+        Clear,       // Fills the whole target with color.
+        FillRect,    // Fills destination with color.
+        DrawTexture  // Copies source of texture into destination, rotated by angle degrees.
+    };
+
+    // A single recorded command. Fields a command type does not use are left unset.
+    struct RenderCommand
+    {
+        KUI_64 key;
+        SDL_Texture* texture;
+        RenderRect source; // Zero width means the whole texture.
+        RenderRect destination;
+        float angle;
+        RenderColor color;
+        RenderCommandType type;
+    };
+
+    // Fixed capacity run of commands written by a single thread. Each list sits on its own
+    // cache line so recording threads never contend for one.
+    __declspec(align(64)) class RenderCommandList
+    {
+    public:
+        RenderCommandList()
+            : mCommands(nullptr), mCapacity(0), mCount(0), mDroppedCount(0) { }
+
+        // Records a clear of the whole target.
+        void clear(KUI_64 aKey, RenderColor aColor) {
+            if (RenderCommand* command = push(aKey, RenderCommandType::Clear))
+                command->color = aColor;
+        }
+
+        // Records a solid rectangle.
+        void fillRect(KUI_64 aKey, const RenderRect& aDestination, RenderColor aColor) {
+            if (RenderCommand* command = push(aKey, RenderCommandType::FillRect)) {
+                command->destination = aDestination;
+                command->color = aColor;
+            }
+        }
+
+        // Records a textured quad. Pass a null aSource to draw the whole texture.
+        void drawTexture(KUI_64 aKey, SDL_Texture* aTexture, const RenderRect* aSource,
+                         const RenderRect& aDestination, float anAngle = 0.0f) {
+            if (RenderCommand* command = push(aKey, RenderCommandType::DrawTexture)) {
+                command->texture = aTexture;
+                command->source = aSource ? *aSource : RenderRect{ 0, 0, 0, 0 };
+                command->destination = aDestination;
+                command->angle = anAngle;
+            }
+        }
+
+        K_UINT getCount() const { return mCount; }
+        const RenderCommand* getCommands() const { return mCommands; }
+
+        // Commands dropped because the list was full.
+        K_UINT getDroppedCount() const { return mDroppedCount; }
+
+    private:
+        friend class RenderCommandBuffer;
+
+        RenderCommandList(const RenderCommandList&) = delete;
+        RenderCommandList& operator=(const RenderCommandList&) = delete;
+
+        // Returns the next free command, or counts the command as dropped and returns nullptr
+        // when the list is full.
+        RenderCommand* push(KUI_64 aKey, RenderCommandType aType) {
+            if (mCount == mCapacity) {
+                ++mDroppedCount;
+                return nullptr;
+            }
+            RenderCommand* command = mCommands + mCount++;
+            command->key = aKey;
+            command->type = aType;
+            return command;
+        }
+
+        RenderCommand* mCommands;
+        K_UINT mCapacity;
+        K_UINT mCount;
+        K_UINT mDroppedCount;
+    };
+
+    // A frame's worth of command lists plus the storage to sort them.
+    // All memory is reserved by the constructor.
+    class RenderCommandBuffer
+    {
+    public:
+        // Reserves aMaxLists lists of aCommandsPerList commands each.
+        RenderCommandBuffer(K_UINT aMaxLists, K_UINT aCommandsPerList);
+        ~RenderCommandBuffer();
+
+        // Hands out an empty list for the calling job to record into. Safe to call from any
+        // thread without locking. Returns nullptr once every list has been handed out, which
+        // callers may check for to skip recording when a frame outgrows the buffer.
+        RenderCommandList* acquireList();
+
+        // Overflow this frame, for sizing the buffer: acquisitions refused because every list
+        // was handed out, and commands dropped because their list was full. Read them once
+        // recording has finished.
+        K_UINT getDroppedListCount() const;
+        K_UINT getDroppedCommandCount() const;
+
+        // Orders every recorded command by key. Commands with equal keys keep their recording
+        // order, and lists keep the order they were acquired in. Call once all recording
+        // for the frame has finished.
+        void sort();
+
+        // Sorted commands, valid between sort and reset.
+        K_UINT getSortedCount() const { return mSortedCount; }
+        const RenderCommand& getSorted(K_UINT anIndex) const {
+            ASSERT(anIndex < mSortedCount);
+            return *mSorted[anIndex].command;
+        }
+
+        // Empties every list for the next frame. No recording may be in progress.
+        void reset();
+
+    private:
+        RenderCommandBuffer(const RenderCommandBuffer&) = delete;
+        RenderCommandBuffer& operator=(const RenderCommandBuffer&) = delete;
+
+        struct SortEntry
+        {
+            KUI_64 key;
+            const RenderCommand* command;
+        };
+
+        RenderCommandList* mLists;
+        K_UINT mMaxLists;
+        std::atomic<K_UINT> mAcquiredLists;
+
+        RenderCommand* mCommandStorage;
+        SortEntry* mSorted;
+        SortEntry* mSortScratch;
+        K_UINT mSortedCount;
+    };
+
+    // Issues the sorted commands to aRenderer on the calling thread, skipping redundant draw
+    // color changes. Presenting is left to the caller.
+    void ReplayOnSdl(const RenderCommandBuffer& aBuffer, SDL_Renderer* aRenderer);
+}
\ No newline at end of file
@@ -0,0 +1,273 @@
+// Skinning.cpp
+// Palette construction and SSE linear blend and dual quaternion skinning.
+
+#include "Skinning.h"
+#include "Memory.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <emmintrin.h>
+
+namespace
+{
+    using namespace KhaosEngine;
+
+    // Most chunks a parallel skin will split work into.
+    const K_UINT MAX_SKINNING_CHUNKS = 32;
+
+    // Chunks start on a multiple of this many vertices so threads never share an output cache line.
+    const K_UINT VERTICES_PER_CACHE_LINE = 16;
+
+    // Returns a * b + c.
+    inline __m128 multiplyAdd(__m128 a, __m128 b, __m128 c) {
+        return _mm_add_ps(_mm_mul_ps(a, b), c);
+    }
+
+    // Loads aCount floats, zero filling the remaining lanes.
+    inline __m128 loadLanes(const float* someValues, K_UINT aCount) {
+        if (aCount == 4)
+            return _mm_loadu_ps(someValues);
+        __declspec(align(16)) float lanes[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        for (K_UINT i = 0; i < aCount; ++i)
+            lanes[i] = someValues[i];
+        return _mm_load_ps(lanes);
+    }
+
+    // Stores the first aCount lanes.
+    inline void storeLanes(float* someValues, __m128 aValue, K_UINT aCount) {
+        if (aCount == 4) {
+            _mm_storeu_ps(someValues, aValue);
+            return;
+        }
+        __declspec(align(16)) float lanes[4];
+        _mm_store_ps(lanes, aValue);
+        for (K_UINT i = 0; i < aCount; ++i)
+            someValues[i] = lanes[i];
+    }
+
+    // Computes the rows of aFirst * aSecond.
+    inline void multiplyRows(const Matrix4x4f& aFirst, const Matrix4x4f& aSecond, __m128* someRows) {
+        const __m128 second[4] = { _mm_loadu_ps(aSecond.elem[0]), _mm_loadu_ps(aSecond.elem[1]),
+                                   _mm_loadu_ps(aSecond.elem[2]), _mm_loadu_ps(aSecond.elem[3]) };
+        for (K_INT row = 0; row < 4; ++row) {
+            __m128 sum = _mm_mul_ps(_mm_set1_ps(aFirst(row, 0)), second[0]);
+            sum = multiplyAdd(_mm_set1_ps(aFirst(row, 1)), second[1], sum);
+            sum = multiplyAdd(_mm_set1_ps(aFirst(row, 2)), second[2], sum);
+            someRows[row] = multiplyAdd(_mm_set1_ps(aFirst(row, 3)), second[3], sum);
+        }
+    }
+
+    // Writes the cross product of two structure-of-arrays vectors.
+    inline void cross(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz,
+                      __m128& x, __m128& y, __m128& z) {
+        x = _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by));
+        y = _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz));
+        z = _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx));
+    }
+
+    // Splits all vertices into aThreadCount cache line aligned chunks and skins them on the worker pool.
+    template <typename T>
+    void skinParallel(void (*aSkin)(const T*, const SkinningInput&, const SkinningOutput&, K_UINT, K_UINT),
+                      const T* aPalette, const SkinningInput& anInput, const SkinningOutput& anOutput,
+                      K_UINT aThreadCount) {
+        const K_UINT vertexCount = anInput.vertexCount;
+        const K_UINT threadCount = std::max(1u, std::min(aThreadCount, MAX_SKINNING_CHUNKS));
+        const K_UINT chunkSize = static_cast<K_UINT>(
+            AlignUp((vertexCount + threadCount - 1) / threadCount, VERTICES_PER_CACHE_LINE));
+        if (chunkSize == 0)
+            return;
+
+        const K_UINT chunkCount = (vertexCount + chunkSize - 1) / chunkSize;
+        WorkerPool::Shared().forEach(chunkCount, [&](K_UINT aChunk) {
+            const K_UINT first = aChunk * chunkSize;
+            aSkin(aPalette, anInput, anOutput, first, std::min(chunkSize, vertexCount - first));
+        });
+    }
+}
+
+namespace KhaosEngine
+{
+    //
+    // Palette function definitions.
+    //
+
+    void ComputeWorldTransforms(const LocalPose& aPose, const K_INT* someParents, Matrix4x4f* someWorldTransforms) {
+        for (K_UINT bone = 0; bone < aPose.boneCount; ++bone) {
+            const Matrix4x4f local = Matrix4x4f::TRS(aPose.translations[bone], aPose.rotations[bone], aPose.scales[bone]);
+            const K_INT parent = someParents[bone];
+            ASSERT(parent < static_cast<K_INT>(bone));
+            someWorldTransforms[bone] = parent < 0 ? local : local * someWorldTransforms[parent];
+        }
+    }
+
+    void BuildSkinningPalette(const Matrix4x4f* someWorldTransforms, const Matrix4x4f* someInverseBindTransforms,
+                              K_UINT aBoneCount, AffineMatrix3x4f* aPalette) {
+        for (K_UINT bone = 0; bone < aBoneCount; ++bone) {
+            __m128 rows[4];
+            multiplyRows(someInverseBindTransforms[bone], someWorldTransforms[bone], rows);
+            _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+            _mm_storeu_ps(aPalette[bone].elem[0], rows[0]);
+            _mm_storeu_ps(aPalette[bone].elem[1], rows[1]);
+            _mm_storeu_ps(aPalette[bone].elem[2], rows[2]);
+        }
+    }
+
+    void BuildDualQuaternionPalette(const Matrix4x4f* someWorldTransforms, const Matrix4x4f* someInverseBindTransforms,
+                                    K_UINT aBoneCount, DualQuaternion* aPalette) {
+        for (K_UINT bone = 0; bone < aBoneCount; ++bone) {
+            Matrix4x4f skinning;
+            __m128 rows[4];
+            multiplyRows(someInverseBindTransforms[bone], someWorldTransforms[bone], rows);
+            for (K_INT row = 0; row < 4; ++row)
+                _mm_store_ps(skinning.elem[row], rows[row]);
+            aPalette[bone] = DualQuaternion::FromMatrix(skinning);
+        }
+    }
+
+    //
+    // Skinning function definitions.
+    //
+
+    void SkinLinear(const AffineMatrix3x4f* aPalette, const SkinningInput& anInput, const SkinningOutput& anOutput,
+                    K_UINT aFirstVertex, K_UINT aVertexCount) {
+        ASSERT(aFirstVertex + aVertexCount <= anInput.vertexCount);
+        const bool hasNormals = anInput.normals[0] != nullptr;
+        const K_UINT end = aFirstVertex + aVertexCount;
+
+        for (K_UINT vertex = aFirstVertex; vertex < end; vertex += 4) {
+            const K_UINT laneCount = std::min(end - vertex, 4u);
+
+            // Blend the palette columns of each vertex, then transpose so each register
+            // holds one matrix element for all four vertices.
+            __m128 blended[3][4];
+            for (K_UINT lane = 0; lane < 4; ++lane) {
+                __m128 columns[3] = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+                if (lane < laneCount) {
+                    for (K_INT influence = 0; influence < 4; ++influence) {
+                        const __m128 weight = _mm_set1_ps(anInput.boneWeights[influence][vertex + lane]);
+                        const AffineMatrix3x4f& bone = aPalette[anInput.boneIndices[influence][vertex + lane]];
+                        for (K_INT c = 0; c < 3; ++c)
+                            columns[c] = multiplyAdd(weight, _mm_loadu_ps(bone.elem[c]), columns[c]);
+                    }
+                }
+                for (K_INT c = 0; c < 3; ++c)
+                    blended[c][lane] = columns[c];
+            }
+            for (K_INT c = 0; c < 3; ++c)
+                _MM_TRANSPOSE4_PS(blended[c][0], blended[c][1], blended[c][2], blended[c][3]);
+
+            const __m128 px = loadLanes(anInput.positions[0] + vertex, laneCount);
+            const __m128 py = loadLanes(anInput.positions[1] + vertex, laneCount);
+            const __m128 pz = loadLanes(anInput.positions[2] + vertex, laneCount);
+            for (K_INT c = 0; c < 3; ++c) {
+                __m128 result = multiplyAdd(blended[c][0], px, blended[c][3]);
+                result = multiplyAdd(blended[c][1], py, result);
+                result = multiplyAdd(blended[c][2], pz, result);
+                storeLanes(anOutput.positions[c] + vertex, result, laneCount);
+            }
+
+            if (hasNormals) {
+                const __m128 nx = loadLanes(anInput.normals[0] + vertex, laneCount);
+                const __m128 ny = loadLanes(anInput.normals[1] + vertex, laneCount);
+                const __m128 nz = loadLanes(anInput.normals[2] + vertex, laneCount);
+                __m128 normal[3];
+                for (K_INT c = 0; c < 3; ++c)
+                    normal[c] = multiplyAdd(blended[c][2], nz, multiplyAdd(blended[c][1], ny, _mm_mul_ps(blended[c][0], nx)));
+
+                const __m128 lengthSquared = multiplyAdd(normal[2], normal[2],
+                                                         multiplyAdd(normal[1], normal[1], _mm_mul_ps(normal[0], normal[0])));
+                const __m128 inverseLength = _mm_div_ps(_mm_set1_ps(1.0f),
+                                                        _mm_sqrt_ps(_mm_max_ps(lengthSquared, _mm_set1_ps(1e-30f))));
+                for (K_INT c = 0; c < 3; ++c)
+                    storeLanes(anOutput.normals[c] + vertex, _mm_mul_ps(normal[c], inverseLength), laneCount);
+            }
+        }
+    }
+
+    void SkinDualQuaternion(const DualQuaternion* aPalette, const SkinningInput& anInput, const SkinningOutput& anOutput,
+                            K_UINT aFirstVertex, K_UINT aVertexCount) {
+        ASSERT(aFirstVertex + aVertexCount <= anInput.vertexCount);
+        const bool hasNormals = anInput.normals[0] != nullptr;
+        const K_UINT end = aFirstVertex + aVertexCount;
+
+        for (K_UINT vertex = aFirstVertex; vertex < end; vertex += 4) {
+            const K_UINT laneCount = std::min(end - vertex, 4u);
+
+            // Blend each vertex's dual quaternions along the shortest path to the first influence.
+            __m128 real[4];
+            __m128 dual[4];
+            for (K_UINT lane = 0; lane < 4; ++lane) {
+                real[lane] = _mm_setzero_ps();
+                dual[lane] = _mm_setzero_ps();
+                if (lane >= laneCount)
+                    continue;
+                const Quaternion& pivot = aPalette[anInput.boneIndices[0][vertex + lane]].real;
+                for (K_INT influence = 0; influence < 4; ++influence) {
+                    const DualQuaternion& bone = aPalette[anInput.boneIndices[influence][vertex + lane]];
+                    float weight = anInput.boneWeights[influence][vertex + lane];
+                    if (pivot.dot(bone.real) < 0.0f)
+                        weight = -weight;
+                    real[lane] = multiplyAdd(_mm_set1_ps(weight), _mm_loadu_ps(&bone.real.x), real[lane]);
+                    dual[lane] = multiplyAdd(_mm_set1_ps(weight), _mm_loadu_ps(&bone.dual.x), dual[lane]);
+                }
+            }
+            _MM_TRANSPOSE4_PS(real[0], real[1], real[2], real[3]);
+            _MM_TRANSPOSE4_PS(dual[0], dual[1], dual[2], dual[3]);
+
+            const __m128 lengthSquared = multiplyAdd(real[3], real[3], multiplyAdd(real[2], real[2],
+                                         multiplyAdd(real[1], real[1], _mm_mul_ps(real[0], real[0]))));
+            const __m128 inverseLength = _mm_div_ps(_mm_set1_ps(1.0f),
+                                                    _mm_sqrt_ps(_mm_max_ps(lengthSquared, _mm_set1_ps(1e-30f))));
+            for (K_INT i = 0; i < 4; ++i) {
+                real[i] = _mm_mul_ps(real[i], inverseLength);
+                dual[i] = _mm_mul_ps(dual[i], inverseLength);
+            }
+
+            // Translation is 2 * dual * conjugate(real).
+            __m128 tx, ty, tz;
+            cross(real[0], real[1], real[2], dual[0], dual[1], dual[2], tx, ty, tz);
+            const __m128 two = _mm_set1_ps(2.0f);
+            tx = _mm_mul_ps(two, _mm_add_ps(tx, _mm_sub_ps(_mm_mul_ps(real[3], dual[0]), _mm_mul_ps(dual[3], real[0]))));
+            ty = _mm_mul_ps(two, _mm_add_ps(ty, _mm_sub_ps(_mm_mul_ps(real[3], dual[1]), _mm_mul_ps(dual[3], real[1]))));
+            tz = _mm_mul_ps(two, _mm_add_ps(tz, _mm_sub_ps(_mm_mul_ps(real[3], dual[2]), _mm_mul_ps(dual[3], real[2]))));
+
+            // Rotation is v + 2 * r x (r x v + w * v).
+            const K_INT streamCount = hasNormals ? 2 : 1;
+            const float* const* sources[2] = { anInput.positions, anInput.normals };
+            float* const* destinations[2] = { anOutput.positions, anOutput.normals };
+            for (K_INT stream = 0; stream < streamCount; ++stream) {
+                const __m128 vx = loadLanes(sources[stream][0] + vertex, laneCount);
+                const __m128 vy = loadLanes(sources[stream][1] + vertex, laneCount);
+                const __m128 vz = loadLanes(sources[stream][2] + vertex, laneCount);
+                __m128 cx, cy, cz;
+                cross(real[0], real[1], real[2], vx, vy, vz, cx, cy, cz);
+                cx = multiplyAdd(real[3], vx, cx);
+                cy = multiplyAdd(real[3], vy, cy);
+                cz = multiplyAdd(real[3], vz, cz);
+                __m128 rx, ry, rz;
+                cross(real[0], real[1], real[2], cx, cy, cz, rx, ry, rz);
+                rx = multiplyAdd(two, rx, vx);
+                ry = multiplyAdd(two, ry, vy);
+                rz = multiplyAdd(two, rz, vz);
+                if (stream == 0) {
+                    rx = _mm_add_ps(rx, tx);
+                    ry = _mm_add_ps(ry, ty);
+                    rz = _mm_add_ps(rz, tz);
+                }
+                storeLanes(destinations[stream][0] + vertex, rx, laneCount);
+                storeLanes(destinations[stream][1] + vertex, ry, laneCount);
+                storeLanes(destinations[stream][2] + vertex, rz, laneCount);
+            }
+        }
+    }
+
+    void SkinLinearParallel(const AffineMatrix3x4f* aPalette, const SkinningInput& anInput,
+                            const SkinningOutput& anOutput, K_UINT aThreadCount) {
+        skinParallel(SkinLinear, aPalette, anInput, anOutput, aThreadCount);
+    }
+
+    void SkinDualQuaternionParallel(const DualQuaternion* aPalette, const SkinningInput& anInput,
+                                    const SkinningOutput& anOutput, K_UINT aThreadCount) {
+        skinParallel(SkinDualQuaternion, aPalette, anInput, anOutput, aThreadCount);
+    }
+}
\ No newline at end of file
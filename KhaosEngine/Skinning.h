@@ -0,0 +1,68 @@
+#pragma once
+
+// Skinning.h
+// CPU skinning of structure-of-arrays vertex streams with four influences per vertex.
+//
+// Each frame, build a palette once per skeleton: either 3x4 matrices for linear blend
+// skinning, or dual quaternions, which keep volume at twisting joints but support only
+// rigid bone transforms. Then skin the vertices, either over a range or split across the
+// shared worker pool. Vertices are processed four at a time in SSE registers. Palettes and
+// transform arrays need no particular alignment.
+
+#include "Common.h"
+#include "KhaosMath.h"
+#include "CompressedTransform.h"
+#include "Animation.h"
+
+namespace KhaosEngine
+{
+    using KhaosMath::Matrix4x4f;
+    using KhaosMath::AffineMatrix3x4f;
+    using KhaosMath::DualQuaternion;
+
+    // Source vertex streams. Unused influences must have zero weight, and the weights of each
+    // vertex should sum to one. Set the normal streams to null to skin positions only.
+    struct SkinningInput
+    {
+        const float* positions[3];
+        const float* normals[3];
+        const KUI_16* boneIndices[4];
+        const float* boneWeights[4];
+        K_UINT vertexCount;
+    };
+
+    // Destination vertex streams, indexed like the input. Must not overlap the input.
+    struct SkinningOutput
+    {
+        float* positions[3];
+        float* normals[3];
+    };
+
+    // Computes model space transforms from a local pose. someParents[i] is the parent of bone i,
+    // or -1 for a root, and every parent must come before its children.
+    void ComputeWorldTransforms(const LocalPose& aPose, const K_INT* someParents, Matrix4x4f* someWorldTransforms);
+
+    // Builds the linear blend palette: inverse bind followed by the bone's world transform.
+    void BuildSkinningPalette(const Matrix4x4f* someWorldTransforms, const Matrix4x4f* someInverseBindTransforms,
+                              K_UINT aBoneCount, AffineMatrix3x4f* aPalette);
+
+    // Builds the dual quaternion palette. Scale in the bone transforms is discarded.
+    void BuildDualQuaternionPalette(const Matrix4x4f* someWorldTransforms, const Matrix4x4f* someInverseBindTransforms,
+                                    K_UINT aBoneCount, DualQuaternion* aPalette);
+
+    // Skins aVertexCount vertices starting at aFirstVertex. Normals are transformed by the
+    // blended matrix and renormalized.
+    void SkinLinear(const AffineMatrix3x4f* aPalette, const SkinningInput& anInput, const SkinningOutput& anOutput,
+                    K_UINT aFirstVertex, K_UINT aVertexCount);
+
+    // Skins aVertexCount vertices starting at aFirstVertex by blending dual quaternions.
+    void SkinDualQuaternion(const DualQuaternion* aPalette, const SkinningInput& anInput, const SkinningOutput& anOutput,
+                            K_UINT aFirstVertex, K_UINT aVertexCount);
+
+    // Skins every vertex, splitting them into aThreadCount chunks run on the shared worker
+    // pool and the calling thread. Chunk boundaries fall on cache lines of the output streams.
+    void SkinLinearParallel(const AffineMatrix3x4f* aPalette, const SkinningInput& anInput,
+                            const SkinningOutput& anOutput, K_UINT aThreadCount);
+    void SkinDualQuaternionParallel(const DualQuaternion* aPalette, const SkinningInput& anInput,
+                                    const SkinningOutput& anOutput, K_UINT aThreadCount);
+}
\ No newline at end of file
@@ -0,0 +1,234 @@
+// Snapshot.cpp
+// SSE2 position quantization and delta encoding of transform snapshots.
+
+#include "Snapshot.h"
+#include "Profiler.h"
+
+#include <emmintrin.h>
+
+namespace
+{
+    using namespace KhaosEngine;
+
+    static_assert(sizeof(Vector3f) == 3 * sizeof(float), "Vector3f must be tightly packed.");
+
+    // Zigzag encoded position deltas below 2^SMALL_DELTA_BITS are sent in short form.
+    const K_UINT SMALL_DELTA_BITS = 8;
+
+    // Bits in the changed component mask: x, y, z and rotation.
+    const K_UINT CHANGE_MASK_BITS = 4;
+
+    // Grid steps per unit on each axis, and the largest grid coordinate.
+    struct GridScale
+    {
+        float scale[3];
+        float inverseScale[3];
+        float maximumCoordinate;
+    };
+
+    GridScale computeGridScale(const SnapshotQuantization& aQuantization) {
+        ASSERT(aQuantization.positionBits >= 1 && aQuantization.positionBits <= 24);
+        GridScale grid;
+        grid.maximumCoordinate = static_cast<float>((1u << aQuantization.positionBits) - 1u);
+        const float minimum[3] = { aQuantization.minimum.x, aQuantization.minimum.y, aQuantization.minimum.z };
+        const float maximum[3] = { aQuantization.maximum.x, aQuantization.maximum.y, aQuantization.maximum.z };
+        for (K_UINT axis = 0; axis < 3; ++axis) {
+            ASSERT(maximum[axis] > minimum[axis]);
+            grid.scale[axis] = grid.maximumCoordinate / (maximum[axis] - minimum[axis]);
+            grid.inverseScale[axis] = (maximum[axis] - minimum[axis]) / grid.maximumCoordinate;
+        }
+        return grid;
+    }
+
+    // Rounds like the SIMD path, to nearest even under the default rounding mode.
+    inline KUI_32 roundToCoordinate(float aValue, float aMaximum) {
+        const float clamped = aValue < 0.0f ? 0.0f : (aValue > aMaximum ? aMaximum : aValue);
+        return static_cast<KUI_32>(_mm_cvtss_si32(_mm_set_ss(clamped)));
+    }
+
+    inline KUI_32 zigzag(KI_32 aValue) {
+        return (static_cast<KUI_32>(aValue) << 1) ^ static_cast<KUI_32>(aValue >> 31);
+    }
+
+    inline KI_32 unzigzag(KUI_32 aValue) {
+        return static_cast<KI_32>(aValue >> 1) ^ -static_cast<KI_32>(aValue & 1u);
+    }
+}
+
+namespace KhaosEngine
+{
+    //
+    // Quantization.
+    //
+
+    void QuantizePositions(const SnapshotQuantization& aQuantization, const Vector3f* somePositions,
+                           KUI_32* someCoordinates, size_t aCount) {
+        const GridScale grid = computeGridScale(aQuantization);
+        const float minimum[3] = { aQuantization.minimum.x, aQuantization.minimum.y, aQuantization.minimum.z };
+        const float* values = &somePositions[0].x;
+        const size_t valueCount = aCount * 3;
+
+        // Four positions are twelve floats, so the per-axis constants repeat every three registers.
+        const __m128 minimumA = _mm_setr_ps(minimum[0], minimum[1], minimum[2], minimum[0]);
+        const __m128 minimumB = _mm_setr_ps(minimum[1], minimum[2], minimum[0], minimum[1]);
+        const __m128 minimumC = _mm_setr_ps(minimum[2], minimum[0], minimum[1], minimum[2]);
+        const __m128 scaleA = _mm_setr_ps(grid.scale[0], grid.scale[1], grid.scale[2], grid.scale[0]);
+        const __m128 scaleB = _mm_setr_ps(grid.scale[1], grid.scale[2], grid.scale[0], grid.scale[1]);
+        const __m128 scaleC = _mm_setr_ps(grid.scale[2], grid.scale[0], grid.scale[1], grid.scale[2]);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 maximum = _mm_set1_ps(grid.maximumCoordinate);
+
+        size_t i = 0;
+        for (; i + 12 <= valueCount; i += 12) {
+            const __m128 a = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(values + i + 0), minimumA), scaleA);
+            const __m128 b = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(values + i + 4), minimumB), scaleB);
+            const __m128 c = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(values + i + 8), minimumC), scaleC);
+            __m128i* destination = reinterpret_cast<__m128i*>(someCoordinates + i);
+            _mm_storeu_si128(destination + 0, _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(a, zero), maximum)));
+            _mm_storeu_si128(destination + 1, _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(b, zero), maximum)));
+            _mm_storeu_si128(destination + 2, _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(c, zero), maximum)));
+        }
+
+        for (; i < valueCount; ++i) {
+            const K_UINT axis = i % 3;
+            someCoordinates[i] = roundToCoordinate((values[i] - minimum[axis]) * grid.scale[axis], grid.maximumCoordinate);
+        }
+    }
+
+    void DequantizePositions(const SnapshotQuantization& aQuantization, const KUI_32* someCoordinates,
+                             Vector3f* somePositions, size_t aCount) {
+        const GridScale grid = computeGridScale(aQuantization);
+        const float minimum[3] = { aQuantization.minimum.x, aQuantization.minimum.y, aQuantization.minimum.z };
+        float* values = &somePositions[0].x;
+        const size_t valueCount = aCount * 3;
+
+        const __m128 minimumA = _mm_setr_ps(minimum[0], minimum[1], minimum[2], minimum[0]);
+        const __m128 minimumB = _mm_setr_ps(minimum[1], minimum[2], minimum[0], minimum[1]);
+        const __m128 minimumC = _mm_setr_ps(minimum[2], minimum[0], minimum[1], minimum[2]);
+        const __m128 stepA = _mm_setr_ps(grid.inverseScale[0], grid.inverseScale[1], grid.inverseScale[2], grid.inverseScale[0]);
+        const __m128 stepB = _mm_setr_ps(grid.inverseScale[1], grid.inverseScale[2], grid.inverseScale[0], grid.inverseScale[1]);
+        const __m128 stepC = _mm_setr_ps(grid.inverseScale[2], grid.inverseScale[0], grid.inverseScale[1], grid.inverseScale[2]);
+
+        size_t i = 0;
+        for (; i + 12 <= valueCount; i += 12) {
+            const __m128i* source = reinterpret_cast<const __m128i*>(someCoordinates + i);
+            const __m128 a = _mm_cvtepi32_ps(_mm_loadu_si128(source + 0));
+            const __m128 b = _mm_cvtepi32_ps(_mm_loadu_si128(source + 1));
+            const __m128 c = _mm_cvtepi32_ps(_mm_loadu_si128(source + 2));
+            _mm_storeu_ps(values + i + 0, _mm_add_ps(_mm_mul_ps(a, stepA), minimumA));
+            _mm_storeu_ps(values + i + 4, _mm_add_ps(_mm_mul_ps(b, stepB), minimumB));
+            _mm_storeu_ps(values + i + 8, _mm_add_ps(_mm_mul_ps(c, stepC), minimumC));
+        }
+
+        for (; i < valueCount; ++i) {
+            const K_UINT axis = i % 3;
+            values[i] = static_cast<float>(someCoordinates[i]) * grid.inverseScale[axis] + minimum[axis];
+        }
+    }
+
+    void CaptureSnapshot(const SnapshotQuantization& aQuantization, const Vector3f* somePositions,
+                         const Quaternion* someRotations, K_UINT aCount, TransformSnapshot& aSnapshot) {
+        PROFILE_SCOPE_CATEGORY("CaptureSnapshot", PROFILE_CATEGORY_NETWORK);
+        aSnapshot.positions.resize(static_cast<size_t>(aCount) * 3);
+        aSnapshot.rotations.resize(aCount);
+        if (aCount == 0)
+            return;
+        QuantizePositions(aQuantization, somePositions, aSnapshot.positions.data(), aCount);
+        KhaosMath::EncodeQuaternions(someRotations, aSnapshot.rotations.data(), aCount);
+    }
+
+    void RestoreSnapshot(const SnapshotQuantization& aQuantization, const TransformSnapshot& aSnapshot,
+                         Vector3f* somePositions, Quaternion* someRotations) {
+        const K_UINT count = aSnapshot.getCount();
+        if (count == 0)
+            return;
+        DequantizePositions(aQuantization, aSnapshot.positions.data(), somePositions, count);
+        KhaosMath::DecodeQuaternions(aSnapshot.rotations.data(), someRotations, count);
+    }
+
+    //
+    // Delta encoding.
+    //
+
+    void WriteSnapshot(BitWriter& aWriter, const SnapshotQuantization& aQuantization,
+                       const TransformSnapshot& aSnapshot, const TransformSnapshot* aBaseline) {
+        PROFILE_SCOPE_CATEGORY("WriteSnapshot", PROFILE_CATEGORY_NETWORK);
+        const K_UINT count = aSnapshot.getCount();
+        const K_UINT baselineCount = aBaseline ? aBaseline->getCount() : 0;
+        const KUI_32 origin[3] = { 0, 0, 0 };
+        const PackedQuaternion32 identity;
+
+        aWriter.writeBits(count, 32);
+        for (K_UINT i = 0; i < count; ++i) {
+            const KUI_32* position = &aSnapshot.positions[i * 3];
+            const KUI_32* basePosition = i < baselineCount ? &aBaseline->positions[i * 3] : origin;
+            const KUI_32 rotation = aSnapshot.rotations[i].bits;
+            const KUI_32 baseRotation = i < baselineCount ? aBaseline->rotations[i].bits : identity.bits;
+
+            const KUI_32 changed = (position[0] != basePosition[0] ? 1u : 0u) |
+                                   (position[1] != basePosition[1] ? 2u : 0u) |
+                                   (position[2] != basePosition[2] ? 4u : 0u) |
+                                   (rotation != baseRotation ? 8u : 0u);
+            if (changed == 0) {
+                aWriter.writeBits(0, 1);
+                continue;
+            }
+
+            aWriter.writeBits(1u | (changed << 1), 1 + CHANGE_MASK_BITS);
+            for (K_UINT axis = 0; axis < 3; ++axis) {
+                if ((changed & (1u << axis)) == 0)
+                    continue;
+                const KUI_32 delta = zigzag(static_cast<KI_32>(position[axis] - basePosition[axis]));
+                if (delta < (1u << SMALL_DELTA_BITS))
+                    aWriter.writeBits(delta << 1, 1 + SMALL_DELTA_BITS);
+                else
+                    aWriter.writeBits(1u | (position[axis] << 1), 1 + aQuantization.positionBits);
+            }
+            if (changed & 8u)
+                aWriter.writeBits(rotation, 32);
+        }
+    }
+
+    bool ReadSnapshot(BitReader& aReader, const SnapshotQuantization& aQuantization,
+                      const TransformSnapshot* aBaseline, TransformSnapshot& aSnapshot) {
+        PROFILE_SCOPE_CATEGORY("ReadSnapshot", PROFILE_CATEGORY_NETWORK);
+        const KUI_32 count = aReader.readBits(32);
+
+        // Every entity takes at least one bit, which bounds the count a valid stream can claim.
+        if (aReader.hasOverflowed() || count > aReader.getRemainingBits())
+            return false;
+
+        const K_UINT baselineCount = aBaseline ? aBaseline->getCount() : 0;
+        const KUI_32 origin[3] = { 0, 0, 0 };
+        const PackedQuaternion32 identity;
+        const KUI_32 coordinateMask = (1u << aQuantization.positionBits) - 1u;
+
+        aSnapshot.positions.resize(static_cast<size_t>(count) * 3);
+        aSnapshot.rotations.resize(count);
+        for (K_UINT i = 0; i < count; ++i) {
+            KUI_32* position = &aSnapshot.positions[i * 3];
+            const KUI_32* basePosition = i < baselineCount ? &aBaseline->positions[i * 3] : origin;
+            const KUI_32 baseRotation = i < baselineCount ? aBaseline->rotations[i].bits : identity.bits;
+
+            position[0] = basePosition[0];
+            position[1] = basePosition[1];
+            position[2] = basePosition[2];
+            aSnapshot.rotations[i].bits = baseRotation;
+            if (aReader.readBits(1) == 0)
+                continue;
+
+            const KUI_32 changed = aReader.readBits(CHANGE_MASK_BITS);
+            for (K_UINT axis = 0; axis < 3; ++axis) {
+                if ((changed & (1u << axis)) == 0)
+                    continue;
+                if (aReader.readBits(1) == 0)
+                    position[axis] = (basePosition[axis] + unzigzag(aReader.readBits(SMALL_DELTA_BITS))) & coordinateMask;
+                else
+                    position[axis] = aReader.readBits(aQuantization.positionBits);
+            }
+            if (changed & 8u)
+                aSnapshot.rotations[i].bits = aReader.readBits(32);
+        }
+        return !aReader.hasOverflowed();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+// Snapshot.h
+// Quantized transform snapshots for replays and network sync, delta encoded against a
+// baseline the reader already has.
+//
+// CaptureSnapshot quantizes positions to a grid spanning the world bounds and packs
+// rotations with the smallest-three encoding, both in SIMD batches. WriteSnapshot then
+// spends one bit on every entity that has not changed since the baseline; changed entities
+// get a mask of the components that moved followed by only those components, where small
+// position deltas take 9 bits instead of the full grid width.
+
+#include "Common.h"
+#include "KhaosMath.h"
+#include "CompressedTransform.h"
+#include "BitStream.h"
+
+#include <vector>
+
+namespace KhaosEngine
+{
+    using KhaosMath::PackedQuaternion32;
+
+    // Grid that positions are quantized to. Positions outside the bounds are clamped.
+    struct SnapshotQuantization
+    {
+        Vector3f minimum;
+        Vector3f maximum;
+        K_UINT positionBits; // Bits per axis, 1 to 24.
+    };
+
+    // Quantized state of a set of entities, indexed the same way as the arrays it was captured from.
+    struct TransformSnapshot
+    {
+        std::vector<KUI_32> positions; // Three grid coordinates per entity.
+        std::vector<PackedQuaternion32> rotations;
+
+        K_UINT getCount() const {
+            return static_cast<K_UINT>(rotations.size());
+        }
+    };
+
+    // Batch quantizes aCount positions to grid coordinates, three per position.
+    void QuantizePositions(const SnapshotQuantization& aQuantization, const Vector3f* somePositions,
+                           KUI_32* someCoordinates, size_t aCount);
+
+    // Batch converts grid coordinates back to positions at the centre of their grid cell.
+    void DequantizePositions(const SnapshotQuantization& aQuantization, const KUI_32* someCoordinates,
+                             Vector3f* somePositions, size_t aCount);
+
+    // Quantizes aCount entity transforms into aSnapshot.
+    void CaptureSnapshot(const SnapshotQuantization& aQuantization, const Vector3f* somePositions,
+                         const Quaternion* someRotations, K_UINT aCount, TransformSnapshot& aSnapshot);
+
+    // Writes the transforms held in aSnapshot to the output arrays, which must hold getCount entries.
+    void RestoreSnapshot(const SnapshotQuantization& aQuantization, const TransformSnapshot& aSnapshot,
+                         Vector3f* somePositions, Quaternion* someRotations);
+
+    // Encodes aSnapshot relative to aBaseline. Entities past the end of the baseline, or every
+    // entity when aBaseline is null, are encoded against the origin and identity rotation.
+    void WriteSnapshot(BitWriter& aWriter, const SnapshotQuantization& aQuantization,
+                       const TransformSnapshot& aSnapshot, const TransformSnapshot* aBaseline);
+
+    // Decodes a snapshot written against the same baseline and quantization. Returns false if
+    // the stream is truncated or malformed, in which case aSnapshot is unspecified.
+    bool ReadSnapshot(BitReader& aReader, const SnapshotQuantization& aQuantization,
+                      const TransformSnapshot* aBaseline, TransformSnapshot& aSnapshot);
+}
\ No newline at end of file
@@ -0,0 +1,282 @@
+// Spline.cpp
+// Polynomial cubic segments, SSE batch evaluation, arc length tables and squad.
+
+#include "Spline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <xmmintrin.h>
+#include <emmintrin.h>
+
+namespace
+{
+    using namespace KhaosMath;
+
+    // Parameters converted per pass when evaluating at distances, so no heap is needed.
+    const K_UINT DISTANCE_BATCH = 64;
+
+    // Returns the log of a unit quaternion, a pure quaternion holding half the rotation vector.
+    Quaternion logUnit(const Quaternion& aQuat) {
+        const float sinTheta = sqrtf(aQuat.x * aQuat.x + aQuat.y * aQuat.y + aQuat.z * aQuat.z);
+        if (sinTheta < 1.0e-6f)
+            return Quaternion(aQuat.x, aQuat.y, aQuat.z, 0.0f);
+        const float scale = atan2f(sinTheta, aQuat.w) / sinTheta;
+        return Quaternion(aQuat.x * scale, aQuat.y * scale, aQuat.z * scale, 0.0f);
+    }
+
+    // Returns the exponential of a pure quaternion, a unit quaternion.
+    Quaternion expPure(const Quaternion& aQuat) {
+        const float theta = sqrtf(aQuat.x * aQuat.x + aQuat.y * aQuat.y + aQuat.z * aQuat.z);
+        if (theta < 1.0e-6f)
+            return Quaternion(aQuat.x, aQuat.y, aQuat.z, 1.0f);
+        const float scale = sinf(theta) / theta;
+        return Quaternion(aQuat.x * scale, aQuat.y * scale, aQuat.z * scale, cosf(theta));
+    }
+
+    // Slerp along the arc the two quaternions span, even when it is the longer one. Squad's
+    // blends must not be flipped onto the shorter arc, or its angular speed jumps at keys.
+    // Nearly parallel and exactly opposite inputs are left to Quaternion::SlerpNoClamp.
+    Quaternion slerpSpanned(const Quaternion& aQuat, const Quaternion& bQuat, float beta) {
+        const float cosTheta = ClampInclusive(aQuat.dot(bQuat), -1.0f, 1.0f);
+        const float theta = acosf(cosTheta);
+        const float sinTheta = sinf(theta);
+        if (cosTheta > 0.9995f || sinTheta <= 0.0f)
+            return Quaternion::SlerpNoClamp(aQuat, bQuat, beta);
+        return Quaternion::WeightedSum(aQuat, sinf((1.0f - beta) * theta) / sinTheta, bQuat, sinf(beta * theta) / sinTheta);
+    }
+}
+
+namespace KhaosMath
+{
+    //
+    // CubicSpline function definitions.
+    //
+
+    template <typename VectorType>
+    void CubicSpline<VectorType>::addHermiteSegment(const VectorType& p0, const VectorType& m0,
+                                                    const VectorType& p1, const VectorType& m1) {
+        const float* start = &p0.x;
+        const float* startTangent = &m0.x;
+        const float* end = &p1.x;
+        const float* endTangent = &m1.x;
+        Segment segment;
+        for (K_UINT i = 0; i < DIMENSION; ++i) {
+            segment.coefficients[i][0] = 2.0f * (start[i] - end[i]) + startTangent[i] + endTangent[i];
+            segment.coefficients[i][1] = 3.0f * (end[i] - start[i]) - 2.0f * startTangent[i] - endTangent[i];
+            segment.coefficients[i][2] = startTangent[i];
+            segment.coefficients[i][3] = start[i];
+        }
+        mSegments.push_back(segment);
+    }
+
+    template <typename VectorType>
+    void CubicSpline<VectorType>::setCatmullRom(const VectorType* somePoints, K_UINT aCount) {
+        ASSERT(aCount >= 2);
+        mSegments.clear();
+        mDistances.clear();
+        for (K_UINT i = 0; i + 1 < aCount; ++i) {
+            const VectorType& previous = somePoints[i > 0 ? i - 1 : 0];
+            const VectorType& next = somePoints[std::min(i + 2, aCount - 1)];
+            // At the ends, the tangent of a mirrored phantom point is the neighbouring chord.
+            const VectorType startTangent = i > 0 ? (somePoints[i + 1] - previous) * 0.5f : somePoints[1] - somePoints[0];
+            const VectorType endTangent = i + 2 < aCount ? (next - somePoints[i]) * 0.5f
+                                                         : somePoints[aCount - 1] - somePoints[aCount - 2];
+            addHermiteSegment(somePoints[i], startTangent, somePoints[i + 1], endTangent);
+        }
+    }
+
+    template <typename VectorType>
+    void CubicSpline<VectorType>::setBezier(const VectorType* someControlPoints, K_UINT aSegmentCount) {
+        mSegments.clear();
+        mDistances.clear();
+        for (K_UINT i = 0; i < aSegmentCount; ++i) {
+            const VectorType* points = someControlPoints + i * 3;
+            addHermiteSegment(points[0], (points[1] - points[0]) * 3.0f, points[3], (points[3] - points[2]) * 3.0f);
+        }
+    }
+
+    template <typename VectorType>
+    void CubicSpline<VectorType>::setHermite(const VectorType* somePoints, const VectorType* someTangents, K_UINT aCount) {
+        ASSERT(aCount >= 2);
+        mSegments.clear();
+        mDistances.clear();
+        for (K_UINT i = 0; i + 1 < aCount; ++i)
+            addHermiteSegment(somePoints[i], someTangents[i], somePoints[i + 1], someTangents[i + 1]);
+    }
+
+    template <typename VectorType>
+    K_UINT CubicSpline<VectorType>::locate(float aParameter, float& aLocalParameter) const {
+        const K_UINT segmentCount = getSegmentCount();
+        ASSERT(segmentCount > 0);
+        const float clamped = ClampInclusive(aParameter, 0.0f, static_cast<float>(segmentCount));
+        const K_UINT segment = std::min(static_cast<K_UINT>(clamped), segmentCount - 1);
+        aLocalParameter = clamped - static_cast<float>(segment);
+        return segment;
+    }
+
+    template <typename VectorType>
+    VectorType CubicSpline<VectorType>::evaluate(float aParameter) const {
+        float t;
+        const Segment& segment = mSegments[locate(aParameter, t)];
+        VectorType result;
+        float* components = &result.x;
+        for (K_UINT i = 0; i < DIMENSION; ++i) {
+            const float* c = segment.coefficients[i];
+            components[i] = ((c[0] * t + c[1]) * t + c[2]) * t + c[3];
+        }
+        return result;
+    }
+
+    template <typename VectorType>
+    VectorType CubicSpline<VectorType>::evaluateTangent(float aParameter) const {
+        float t;
+        const Segment& segment = mSegments[locate(aParameter, t)];
+        VectorType result;
+        float* components = &result.x;
+        for (K_UINT i = 0; i < DIMENSION; ++i) {
+            const float* c = segment.coefficients[i];
+            components[i] = (3.0f * c[0] * t + 2.0f * c[1]) * t + c[2];
+        }
+        return result;
+    }
+
+    template <typename VectorType>
+    void CubicSpline<VectorType>::evaluate(const float* someParameters, VectorType* somePositions,
+                                           VectorType* someTangents, K_UINT aCount) const {
+        const K_UINT segmentCount = getSegmentCount();
+        ASSERT(segmentCount > 0);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 end = _mm_set1_ps(static_cast<float>(segmentCount));
+        const __m128 lastSegment = _mm_set1_ps(static_cast<float>(segmentCount - 1));
+        const __m128 two = _mm_set1_ps(2.0f);
+        const __m128 three = _mm_set1_ps(3.0f);
+
+        for (K_UINT first = 0; first < aCount; first += 4) {
+            const K_UINT lanes = std::min(4u, aCount - first);
+            __declspec(align(16)) float parameters[4];
+            for (K_UINT lane = 0; lane < 4; ++lane)
+                parameters[lane] = someParameters[first + std::min(lane, lanes - 1)];
+
+            // Split into segment index and local parameter. Parameters are clamped to be
+            // non-negative, so truncation is floor.
+            const __m128 clamped = _mm_min_ps(_mm_max_ps(_mm_load_ps(parameters), zero), end);
+            const __m128 segmentIndex = _mm_min_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(clamped)), lastSegment);
+            const __m128 t = _mm_sub_ps(clamped, segmentIndex);
+            __declspec(align(16)) K_INT segments[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(segments), _mm_cvttps_epi32(segmentIndex));
+
+            __declspec(align(16)) float positions[DIMENSION][4];
+            __declspec(align(16)) float tangents[DIMENSION][4];
+            for (K_UINT component = 0; component < DIMENSION; ++component) {
+                // Rows of a, b, c, d per lane become a, b, c and d across lanes. std::vector
+                // storage is only 8-byte aligned on Win32, so the rows are loaded unaligned.
+                __m128 a = _mm_loadu_ps(mSegments[segments[0]].coefficients[component]);
+                __m128 b = _mm_loadu_ps(mSegments[segments[1]].coefficients[component]);
+                __m128 c = _mm_loadu_ps(mSegments[segments[2]].coefficients[component]);
+                __m128 d = _mm_loadu_ps(mSegments[segments[3]].coefficients[component]);
+                _MM_TRANSPOSE4_PS(a, b, c, d);
+
+                const __m128 position = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(a, t), b), t), c), t), d);
+                _mm_store_ps(positions[component], position);
+                if (someTangents) {
+                    const __m128 slope = _mm_add_ps(_mm_mul_ps(three, _mm_mul_ps(a, t)), _mm_mul_ps(two, b));
+                    _mm_store_ps(tangents[component], _mm_add_ps(_mm_mul_ps(slope, t), c));
+                }
+            }
+
+            for (K_UINT lane = 0; lane < lanes; ++lane) {
+                float* position = &somePositions[first + lane].x;
+                for (K_UINT component = 0; component < DIMENSION; ++component)
+                    position[component] = positions[component][lane];
+                if (someTangents) {
+                    float* tangent = &someTangents[first + lane].x;
+                    for (K_UINT component = 0; component < DIMENSION; ++component)
+                        tangent[component] = tangents[component][lane];
+                }
+            }
+        }
+    }
+
+    template <typename VectorType>
+    void CubicSpline<VectorType>::buildArcLengthTable(K_UINT aSamplesPerSegment) {
+        ASSERT(aSamplesPerSegment > 0 && getSegmentCount() > 0);
+        mSamplesPerSegment = aSamplesPerSegment;
+        const K_UINT sampleCount = getSegmentCount() * aSamplesPerSegment + 1;
+        std::vector<float> parameters(sampleCount);
+        for (K_UINT i = 0; i < sampleCount; ++i)
+            parameters[i] = static_cast<float>(i) / static_cast<float>(aSamplesPerSegment);
+        std::vector<VectorType> points(sampleCount);
+        evaluate(parameters.data(), points.data(), nullptr, sampleCount);
+
+        mDistances.resize(sampleCount);
+        mDistances[0] = 0.0f;
+        for (K_UINT i = 1; i < sampleCount; ++i)
+            mDistances[i] = mDistances[i - 1] + (points[i] - points[i - 1]).getMagnitude();
+    }
+
+    template <typename VectorType>
+    float CubicSpline<VectorType>::getParameterAtDistance(float aDistance) const {
+        ASSERT(!mDistances.empty());
+        const float distance = ClampInclusive(aDistance, 0.0f, getLength());
+        const K_UINT upper = static_cast<K_UINT>(std::upper_bound(mDistances.begin() + 1, mDistances.end() - 1, distance) -
+                                                 mDistances.begin());
+        const float span = mDistances[upper] - mDistances[upper - 1];
+        const float fraction = span > 0.0f ? (distance - mDistances[upper - 1]) / span : 0.0f;
+        return (static_cast<float>(upper - 1) + fraction) / static_cast<float>(mSamplesPerSegment);
+    }
+
+    template <typename VectorType>
+    void CubicSpline<VectorType>::evaluateAtDistances(const float* someDistances, VectorType* somePositions,
+                                                      VectorType* someTangents, K_UINT aCount) const {
+        float parameters[DISTANCE_BATCH];
+        for (K_UINT first = 0; first < aCount; first += DISTANCE_BATCH) {
+            const K_UINT count = std::min(DISTANCE_BATCH, aCount - first);
+            for (K_UINT i = 0; i < count; ++i)
+                parameters[i] = getParameterAtDistance(someDistances[first + i]);
+            evaluate(parameters, somePositions + first, someTangents ? someTangents + first : nullptr, count);
+        }
+    }
+
+    template class CubicSpline<Vector2f>;
+    template class CubicSpline<Vector3f>;
+
+    //
+    // SquadSpline function definitions.
+    //
+
+    void SquadSpline::setKeys(const Quaternion* someKeys, K_UINT aCount) {
+        ASSERT(aCount >= 2);
+        mKeys.assign(someKeys, someKeys + aCount);
+        for (K_UINT i = 1; i < aCount; ++i)
+            if (mKeys[i].dot(mKeys[i - 1]) < 0.0f)
+                mKeys[i] = mKeys[i] * -1.0f;
+
+        // s_i = q_i * exp(-(log(q_i^-1 * q_i+1) + log(q_i^-1 * q_i-1)) / 4), with the
+        // end keys standing in for their missing neighbours.
+        mControls.resize(aCount);
+        for (K_UINT i = 0; i < aCount; ++i) {
+            const Quaternion& key = mKeys[i];
+            const Quaternion inverse = key.getUnitInverse();
+            const Quaternion toNext = logUnit(inverse * mKeys[std::min(i + 1, aCount - 1)]);
+            const Quaternion toPrevious = logUnit(inverse * mKeys[i > 0 ? i - 1 : 0]);
+            mControls[i] = key * expPure((toNext + toPrevious) * -0.25f);
+        }
+    }
+
+    Quaternion SquadSpline::evaluate(float aParameter) const {
+        const K_UINT segmentCount = getSegmentCount();
+        ASSERT(segmentCount > 0);
+        const float clamped = ClampInclusive(aParameter, 0.0f, static_cast<float>(segmentCount));
+        const K_UINT segment = std::min(static_cast<K_UINT>(clamped), segmentCount - 1);
+        const float t = clamped - static_cast<float>(segment);
+
+        const Quaternion outer = slerpSpanned(mKeys[segment], mKeys[segment + 1], t);
+        const Quaternion inner = slerpSpanned(mControls[segment], mControls[segment + 1], t);
+        return slerpSpanned(outer, inner, 2.0f * t * (1.0f - t));
+    }
+
+    void SquadSpline::evaluate(const float* someParameters, Quaternion* someRotations, K_UINT aCount) const {
+        for (K_UINT i = 0; i < aCount; ++i)
+            someRotations[i] = evaluate(someParameters[i]);
+    }
+}
\ No newline at end of file
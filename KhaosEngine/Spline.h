@@ -0,0 +1,123 @@
+#pragma once
+
+// Spline.h
+// Cubic curves through Vector2f / Vector3f control points, and squad interpolation of
+// rotation keys.
+//
+// Catmull-Rom, Bezier and Hermite input are all converted once into the polynomial form
+// p(t) = ((a * t + b) * t + c) * t + d per segment, so each point costs three multiply-adds
+// per component instead of the six lerps of de Casteljau. Batches evaluate four parameters
+// per SSE register, taking each lane's coefficients from its own segment.
+//
+// Spline parameters run from 0 to getSegmentCount(), with segment i covering [i, i + 1].
+// Parameter speed along the curve is uneven; buildArcLengthTable caches a table that maps
+// distance along the curve back to a parameter for constant speed motion.
+
+#include "Common.h"
+#include "CommonMath.h"
+
+#include "Vector2f.h"
+#include "Vector3f.h"
+#include "Quaternion.h"
+
+#include <vector>
+
+namespace KhaosMath
+{
+    // Cubic spline over Vector2f or Vector3f points.
+    template <typename VectorType>
+    class CubicSpline
+    {
+    public:
+        static const K_UINT DIMENSION = sizeof(VectorType) / sizeof(float);
+
+        CubicSpline()
+            : mSamplesPerSegment(0) { }
+
+        // Uniform Catmull-Rom spline passing through all aCount points, at least two.
+        // The end tangents mirror the neighbouring point.
+        void setCatmullRom(const VectorType* somePoints, K_UINT aCount);
+
+        // Piecewise cubic Bezier curve from 3 * aSegmentCount + 1 control points, where each
+        // segment shares its last point with the next one.
+        void setBezier(const VectorType* someControlPoints, K_UINT aSegmentCount);
+
+        // Hermite spline through aCount points, at least two, with the given tangents. Tangents
+        // are derivatives with respect to the parameter, so a segment's length scales them.
+        void setHermite(const VectorType* somePoints, const VectorType* someTangents, K_UINT aCount);
+
+        K_UINT getSegmentCount() const {
+            return static_cast<K_UINT>(mSegments.size());
+        }
+
+        // Returns the position at aParameter, clamped to the spline.
+        VectorType evaluate(float aParameter) const;
+
+        // Returns the derivative with respect to the parameter at aParameter.
+        VectorType evaluateTangent(float aParameter) const;
+
+        // Evaluates aCount parameters four at a time. someTangents may be null.
+        void evaluate(const float* someParameters, VectorType* somePositions, VectorType* someTangents,
+                      K_UINT aCount) const;
+
+        // Caches distances at aSamplesPerSegment evenly spaced parameters of every segment.
+        // Must be rebuilt after the curve changes.
+        void buildArcLengthTable(K_UINT aSamplesPerSegment);
+
+        // Length of the curve as measured by the arc length table.
+        float getLength() const {
+            return mDistances.empty() ? 0.0f : mDistances.back();
+        }
+
+        // Returns the parameter aDistance along the curve, clamped to its ends.
+        float getParameterAtDistance(float aDistance) const;
+
+        // Evaluates aCount points at the given distances along the curve. someTangents may be null.
+        void evaluateAtDistances(const float* someDistances, VectorType* somePositions, VectorType* someTangents,
+                                 K_UINT aCount) const;
+
+    private:
+        // Coefficients a, b, c, d of each component, one 16 byte row per component.
+        struct Segment
+        {
+            __declspec(align(16)) float coefficients[DIMENSION][4];
+        };
+
+        // Appends the segment between p0 and p1 with tangents m0 and m1.
+        void addHermiteSegment(const VectorType& p0, const VectorType& m0, const VectorType& p1, const VectorType& m1);
+
+        // Splits a parameter into a segment index and the local parameter within it.
+        K_UINT locate(float aParameter, float& aLocalParameter) const;
+
+        std::vector<Segment> mSegments;
+        std::vector<float> mDistances; // Arc length at each table sample.
+        K_UINT mSamplesPerSegment;
+    };
+
+    typedef CubicSpline<Vector2f> CubicSpline2f;
+    typedef CubicSpline<Vector3f> CubicSpline3f;
+
+    // Smooth rotation path through keys using spherical quadrangle interpolation, which unlike
+    // chained slerps keeps angular velocity continuous across keys.
+    class SquadSpline
+    {
+    public:
+        // Sets the keys, at least two. Keys are flipped where needed so each is in the same
+        // hemisphere as the one before, giving the shortest arc between neighbours.
+        void setKeys(const Quaternion* someKeys, K_UINT aCount);
+
+        K_UINT getSegmentCount() const {
+            return mKeys.empty() ? 0 : static_cast<K_UINT>(mKeys.size()) - 1;
+        }
+
+        // Returns the rotation at aParameter, clamped to [0, getSegmentCount()].
+        Quaternion evaluate(float aParameter) const;
+
+        // Evaluates aCount parameters.
+        void evaluate(const float* someParameters, Quaternion* someRotations, K_UINT aCount) const;
+
+    private:
+        std::vector<Quaternion> mKeys;
+        std::vector<Quaternion> mControls; // Inner control rotation of each key.
+    };
+}
\ No newline at end of file
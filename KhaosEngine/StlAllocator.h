@@ -0,0 +1,171 @@
+#pragma once
+
+// StlAllocator.h
+// Adapters that let standard containers draw their storage from KhaosEngine allocators.
+//
+//     std::vector<Vector4f, LinearStlAllocator<Vector4f>> batch(LinearStlAllocator<Vector4f>(frame.getCurrent()));
+
+#include "Common.h"
+#include "Memory.h"
+#include "LinearAllocator.h"
+#include "PoolAllocator.h"
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace KhaosEngine
+{
+    // STL allocator backed by a LinearAllocator. Deallocation is a no-op; memory comes back
+    // when the arena is reset, so containers using it must not outlive the arena's frame.
+    template <typename T>
+    class LinearStlAllocator
+    {
+    public:
+        typedef T value_type;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        template <typename U>
+        struct rebind
+        {
+            typedef LinearStlAllocator<U> other;
+        };
+
+        explicit LinearStlAllocator(LinearAllocator& anArena)
+            : mArena(&anArena) { }
+
+        template <typename U>
+        LinearStlAllocator(const LinearStlAllocator<U>& other)
+            : mArena(other.getArena()) { }
+
+        pointer allocate(size_type aCount, const void* = nullptr) {
+            pointer memory = mArena->allocateArray<T>(aCount);
+            if (!memory)
+                throw std::bad_alloc();
+            return memory;
+        }
+
+        void deallocate(pointer, size_type) { }
+
+        template <typename U, typename... Args>
+        void construct(U* aPointer, Args&&... someArgs) {
+            new (static_cast<void*>(aPointer)) U(std::forward<Args>(someArgs)...);
+        }
+
+        template <typename U>
+        void destroy(U* aPointer) {
+            aPointer->~U();
+        }
+
+        size_type max_size() const {
+            return mArena->getCapacity() / sizeof(T);
+        }
+
+        LinearAllocator* getArena() const {
+            return mArena;
+        }
+
+    private:
+        LinearAllocator* mArena;
+    };
+
+    template <typename T, typename U>
+    bool operator==(const LinearStlAllocator<T>& aLeft, const LinearStlAllocator<U>& aRight) {
+        return aLeft.getArena() == aRight.getArena();
+    }
+
+    template <typename T, typename U>
+    bool operator!=(const LinearStlAllocator<T>& aLeft, const LinearStlAllocator<U>& aRight) {
+        return !(aLeft == aRight);
+    }
+
+    // STL allocator backed by a PoolAllocator, intended for node based containers such as
+    // std::list, std::map and std::set that allocate one element at a time.
+    // Requests that do not fit a single pool block (array allocations, or bookkeeping
+    // objects some standard libraries rebind to) fall back to the tracked aligned heap.
+    template <typename T>
+    class PoolStlAllocator
+    {
+    public:
+        typedef T value_type;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        template <typename U>
+        struct rebind
+        {
+            typedef PoolStlAllocator<U> other;
+        };
+
+        explicit PoolStlAllocator(PoolAllocator& aPool)
+            : mPool(&aPool) { }
+
+        template <typename U>
+        PoolStlAllocator(const PoolStlAllocator<U>& other)
+            : mPool(other.getPool()) { }
+
+        pointer allocate(size_type aCount, const void* = nullptr) {
+            void* memory = fitsPool(aCount) ? mPool->allocate()
+                                            : AlignedAlloc(sizeof(T) * aCount, alignment());
+            if (!memory)
+                throw std::bad_alloc();
+            return static_cast<pointer>(memory);
+        }
+
+        void deallocate(pointer aPointer, size_type aCount) {
+            if (fitsPool(aCount))
+                mPool->deallocate(aPointer);
+            else
+                AlignedFree(aPointer);
+        }
+
+        template <typename U, typename... Args>
+        void construct(U* aPointer, Args&&... someArgs) {
+            new (static_cast<void*>(aPointer)) U(std::forward<Args>(someArgs)...);
+        }
+
+        template <typename U>
+        void destroy(U* aPointer) {
+            aPointer->~U();
+        }
+
+        size_type max_size() const {
+            return static_cast<size_type>(-1) / sizeof(T);
+        }
+
+        PoolAllocator* getPool() const {
+            return mPool;
+        }
+
+    private:
+        static size_t alignment() {
+            return __alignof(T) > sizeof(void*) ? __alignof(T) : sizeof(void*);
+        }
+
+        bool fitsPool(size_type aCount) const {
+            return aCount == 1 && sizeof(T) <= mPool->getBlockSize() &&
+                   alignment() <= mPool->getAlignment();
+        }
+
+        PoolAllocator* mPool;
+    };
+
+    template <typename T, typename U>
+    bool operator==(const PoolStlAllocator<T>& aLeft, const PoolStlAllocator<U>& aRight) {
+        return aLeft.getPool() == aRight.getPool();
+    }
+
+    template <typename T, typename U>
+    bool operator!=(const PoolStlAllocator<T>& aLeft, const PoolStlAllocator<U>& aRight) {
+        return !(aLeft == aRight);
+    }
+}
\ No newline at end of file
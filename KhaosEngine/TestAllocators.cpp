@@ -0,0 +1,211 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <list>
+#include <vector>
+
+#include "KhaosMath.h"
+#include "LinearAllocator.h"
+#include "PoolAllocator.h"
+#include "StlAllocator.h"
+#include "Memory.h"
+#include "TestUtilities.h"
+
+using namespace std;
+using namespace std::chrono;
+using namespace KhaosMath;
+using namespace KhaosEngine;
+using namespace KhaosTesting;
+
+namespace
+{
+    const size_t ARENA_CAPACITY = 1 << 20;
+    const K_UINT STEADY_FRAMES = 1000;
+
+    // Stand-in for a pooled engine object such as a transform node.
+    struct Node
+    {
+        Matrix4x4f world;
+        Vector4f bounds;
+        K_UINT parent;
+
+        Node(K_UINT aParent)
+            : world(Matrix4x4f::Identity()), bounds(0.0f, 0.0f, 0.0f, 1.0f), parent(aParent) { }
+    };
+
+    // Makes one frame's worth of allocations of every kind the engine uses, touching the
+    // memory so a bad pointer shows up under the sanitizers. Returns a value to keep the
+    // work from being optimized away.
+    float runFrame(FrameAllocator& aFrame, ObjectPool<Node>& aNodes, vector<Node*>& someLiveNodes,
+                   list<Vector4f, PoolStlAllocator<Vector4f>>& aQueue, K_UINT aFrameIndex) {
+        Vector4f* positions = aFrame.allocateArray<Vector4f>(256);
+        Matrix4x4f* matrices = aFrame.allocateArray<Matrix4x4f>(64);
+        float sum = 0.0f;
+        for (K_UINT i = 0; i < 256; ++i)
+            positions[i] = Vector4f(static_cast<float>(i), static_cast<float>(aFrameIndex), 0.0f, 1.0f);
+        for (K_UINT i = 0; i < 64; ++i) {
+            matrices[i] = Matrix4x4f::Identity();
+            sum += (positions[i] * matrices[i]).x;
+        }
+
+        vector<Vector4f, LinearStlAllocator<Vector4f>> batch{ LinearStlAllocator<Vector4f>(aFrame.getCurrent()) };
+        batch.reserve(128);
+        for (K_UINT i = 0; i < 128; ++i)
+            batch.push_back(positions[i]);
+        sum += batch.back().x;
+
+        // Replace a few nodes and queue entries each frame, so blocks keep being reused.
+        for (K_UINT i = 0; i < 4; ++i) {
+            const size_t slot = (aFrameIndex * 4 + i) % someLiveNodes.size();
+            aNodes.destroy(someLiveNodes[slot]);
+            someLiveNodes[slot] = aNodes.create(aFrameIndex);
+            sum += someLiveNodes[slot]->world.elem[0][0];
+            aQueue.pop_front();
+            aQueue.push_back(positions[i]);
+        }
+        return sum;
+    }
+}
+
+int TestAllocators() {
+    K_INT failures = 0;
+
+    // Vector4f and Matrix4x4f need 16 byte alignment, and AVX data needs 32, wherever the
+    // previous allocation left the top of the arena.
+    {
+        LinearAllocator arena(ARENA_CAPACITY);
+        KUI_64 misaligned = 0;
+        for (K_UINT i = 0; i < 1000; ++i) {
+            arena.allocate(1 + i % 13, 1);
+            misaligned += !IsAligned(arena.allocateArray<Vector4f>(1 + i % 3), SIMD_ALIGNMENT);
+            arena.allocate(1 + i % 7, 1);
+            misaligned += !IsAligned(arena.create<Matrix4x4f>(), SIMD_ALIGNMENT);
+            arena.allocate(1 + i % 5, 1);
+            misaligned += !IsAligned(arena.allocate(sizeof(Vector4f) * 2, AVX_ALIGNMENT), AVX_ALIGNMENT);
+        }
+        failures += ReportCount("LinearAllocator alignment", misaligned);
+
+        misaligned = 0;
+        PoolAllocator vectors(sizeof(Vector4f), 64);
+        PoolAllocator matrices(sizeof(Matrix4x4f) + 4, 64);
+        PoolAllocator wide(sizeof(Vector4f) * 2, 64, AVX_ALIGNMENT);
+        for (K_UINT i = 0; i < 64; ++i) {
+            misaligned += !IsAligned(vectors.allocate(), SIMD_ALIGNMENT);
+            misaligned += !IsAligned(matrices.allocate(), SIMD_ALIGNMENT);
+            misaligned += !IsAligned(wide.allocate(), AVX_ALIGNMENT);
+        }
+        failures += ReportCount("PoolAllocator alignment", misaligned);
+    }
+
+    // Reset and markers hand the same memory out again, and a frame's data survives the next
+    // beginFrame but not the one after.
+    {
+        LinearAllocator arena(ARENA_CAPACITY);
+        void* first = arena.allocate(100);
+        const LinearAllocator::Marker marker = arena.getMarker();
+        void* second = arena.allocate(100);
+        const size_t peak = arena.getUsed();
+        arena.freeToMarker(marker);
+        const bool rolledBack = arena.allocate(100) == second;
+        arena.reset();
+        failures += ReportCheck("LinearAllocator marker and reset",
+                                rolledBack && arena.getUsed() == 0 && arena.allocate(100) == first && arena.getPeakUsed() == peak);
+
+        FrameAllocator frames(ARENA_CAPACITY);
+        Vector4f* frameOne = frames.create<Vector4f>(1.0f, 2.0f, 3.0f, 4.0f);
+        frames.beginFrame();
+        Vector4f* frameTwo = frames.create<Vector4f>(5.0f, 6.0f, 7.0f, 8.0f);
+        const bool previousKept = frames.getPrevious().owns(frameOne) && frameOne->w == 4.0f && frameTwo != frameOne;
+        frames.beginFrame();
+        failures += ReportCheck("FrameAllocator keeps the previous frame",
+                                previousKept && frames.getCurrent().owns(frameOne) && frames.getCurrent().getUsed() == 0 &&
+                                frames.getFrameIndex() == 2);
+    }
+
+    // Every block of a drained pool is distinct and inside the pool, and freed blocks are
+    // handed out again, most recently freed first, until reset rebuilds the free list.
+    {
+        PoolAllocator pool(sizeof(Matrix4x4f), 32);
+        vector<void*> blocks;
+        for (size_t i = 0; i < pool.getBlockCount(); ++i)
+            blocks.push_back(pool.allocate());
+        vector<void*> sorted = blocks;
+        sort(sorted.begin(), sorted.end());
+        KUI_64 bad = unique(sorted.begin(), sorted.end()) != sorted.end();
+        for (size_t i = 0; i < blocks.size(); ++i)
+            bad += blocks[i] == nullptr || !pool.owns(blocks[i]);
+        failures += ReportCheck("PoolAllocator drains to distinct blocks", bad == 0 && pool.getFreeCount() == 0);
+
+        pool.deallocate(blocks[5]);
+        pool.deallocate(blocks[17]);
+        const bool reused = pool.allocate() == blocks[17] && pool.allocate() == blocks[5] && pool.getFreeCount() == 0;
+        pool.reset();
+        failures += ReportCheck("PoolAllocator reuses freed blocks",
+                                reused && pool.getFreeCount() == pool.getBlockCount() && pool.allocate() == blocks[0]);
+
+        ObjectPool<Node> nodes(8);
+        Node* node = nodes.create(7u);
+        const bool constructed = node->parent == 7 && node->world.elem[3][3] == 1.0f && IsAligned(node, SIMD_ALIGNMENT);
+        nodes.destroy(node);
+        failures += ReportCheck("ObjectPool creates and recycles", constructed && nodes.create(8u) == node && nodes.getUsedCount() == 1);
+    }
+
+    // Standard containers draw their storage from the arena and pool through the adapters.
+    {
+        LinearAllocator arena(ARENA_CAPACITY);
+        vector<Vector4f, LinearStlAllocator<Vector4f>> points{ LinearStlAllocator<Vector4f>(arena) };
+        for (K_UINT i = 0; i < 1000; ++i)
+            points.push_back(Vector4f(static_cast<float>(i), 0.0f, 0.0f, 1.0f));
+        KUI_64 wrong = 0;
+        for (K_UINT i = 0; i < points.size(); ++i)
+            wrong += points[i].x != static_cast<float>(i);
+        failures += ReportCheck("std::vector on a LinearAllocator",
+                                wrong == 0 && arena.owns(points.data()) && IsAligned(points.data(), SIMD_ALIGNMENT));
+
+        PoolAllocator pool(64, 256);
+        {
+            list<Vector4f, PoolStlAllocator<Vector4f>> queue{ PoolStlAllocator<Vector4f>(pool) };
+            for (K_UINT i = 0; i < 100; ++i)
+                queue.push_back(Vector4f(static_cast<float>(i), 0.0f, 0.0f, 1.0f));
+            bool pooled = true;
+            for (list<Vector4f, PoolStlAllocator<Vector4f>>::iterator it = queue.begin(); it != queue.end(); ++it)
+                pooled = pooled && pool.owns(&*it) && IsAligned(&*it, SIMD_ALIGNMENT);
+            failures += ReportCheck("std::list on a PoolAllocator", pooled && pool.getUsedCount() >= 100);
+        }
+        failures += ReportCheck("std::list returns its nodes", pool.getUsedCount() == 0);
+    }
+
+    // Once everything is built, frames that allocate from the arenas, pools and adapters never
+    // reach the global heap. Only meaningful when MEMORY_TRACKING_ENABLED counts allocations.
+    {
+        FrameAllocator frames(ARENA_CAPACITY);
+        ObjectPool<Node> nodes(256);
+        vector<Node*> liveNodes;
+        for (K_UINT i = 0; i < 200; ++i)
+            liveNodes.push_back(nodes.create(i));
+        PoolAllocator queuePool(64, 256);
+        list<Vector4f, PoolStlAllocator<Vector4f>> queue{ PoolStlAllocator<Vector4f>(queuePool) };
+        for (K_UINT i = 0; i < 32; ++i)
+            queue.push_back(Vector4f(0.0f, 0.0f, 0.0f, 1.0f));
+
+        float checksum = 0.0f;
+        KUI_64 framesWithAllocations = 0;
+        const KUI_64 allocationsBefore = GetHeapAllocationCount();
+        const high_resolution_clock::time_point start = high_resolution_clock::now();
+        for (K_UINT frame = 0; frame < STEADY_FRAMES; ++frame) {
+            frames.beginFrame();
+            framesWithAllocations += frame > 0 && frames.getHeapAllocationsLastFrame() != 0;
+            checksum += runFrame(frames, nodes, liveNodes, queue, frame);
+        }
+        const double seconds = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+        failures += ReportCount("No heap allocation in steady-state frames", GetHeapAllocationCount() - allocationsBefore);
+        failures += ReportCount("FrameAllocator sees no heap allocation", framesWithAllocations);
+
+        for (size_t i = 0; i < liveNodes.size(); ++i)
+            nodes.destroy(liveNodes[i]);
+        cout << "Allocator frame: " << seconds * 1.0e6 / STEADY_FRAMES << " us per frame (checksum " << checksum << ")"
+             << endl;
+    }
+
+    return failures;
+}
\ No newline at end of file
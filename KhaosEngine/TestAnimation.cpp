@@ -0,0 +1,291 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "KhaosMath.h"
+#include "Animation.h"
+#include "LinearAllocator.h"
+#include "TestUtilities.h"
+
+using namespace std;
+using namespace std::chrono;
+using namespace KhaosMath;
+using namespace KhaosEngine;
+using namespace KhaosTesting;
+
+namespace
+{
+    const K_UINT BONE_COUNT = 37; // Not a multiple of four, so the last group is partial.
+    const float CLIP_DURATION = 2.0f;
+
+    // Authored keys of one track, sorted by time. Vector tracks leave w at zero.
+    struct ReferenceKey
+    {
+        float time;
+        Quaternion value;
+    };
+
+    typedef vector<ReferenceKey> ReferenceTrack;
+
+    // Builds a clip with uneven key spacing, a few single key tracks and a few empty ones,
+    // and keeps a copy of every track for the reference sampler. Rotation keys are a random
+    // walk of up to aMaxAngle radians per key.
+    void buildClip(mt19937& aGenerator, float aMaxAngle, AnimationClip& aClip, vector<ReferenceTrack>& someTracks) {
+        uniform_real_distribution<float> unit(0.0f, 1.0f);
+        someTracks.assign(CHANNEL_COUNT * BONE_COUNT, ReferenceTrack());
+        for (K_UINT bone = 0; bone < BONE_COUNT; ++bone) {
+            for (K_UINT channel = 0; channel < CHANNEL_COUNT; ++channel) {
+                const K_UINT shape = aGenerator() % 8;
+                if (shape == 0)
+                    continue;
+                vector<float> times;
+                if (shape == 1) {
+                    times.push_back(unit(aGenerator) * CLIP_DURATION);
+                }
+                else {
+                    const K_UINT keyCount = 2 + aGenerator() % 30;
+                    for (K_UINT i = 0; i < keyCount; ++i)
+                        times.push_back(unit(aGenerator) * CLIP_DURATION);
+                    times.push_back(0.0f);
+                    times.push_back(CLIP_DURATION);
+                    sort(times.begin(), times.end());
+                    times.erase(unique(times.begin(), times.end()), times.end());
+                }
+
+                ReferenceTrack& track = someTracks[channel * BONE_COUNT + bone];
+                Quaternion rotation = RandomRotation(aGenerator);
+                for (size_t i = 0; i < times.size(); ++i) {
+                    ReferenceKey key;
+                    key.time = times[i];
+                    if (channel == CHANNEL_ROTATION) {
+                        const Quaternion axis = RandomRotation(aGenerator);
+                        const float halfAngle = unit(aGenerator) * 0.5f * aMaxAngle;
+                        const float axisLength = sqrtf(axis.x * axis.x + axis.y * axis.y + axis.z * axis.z);
+                        const float scale = sinf(halfAngle) / axisLength;
+                        rotation = rotation * Quaternion(axis.x * scale, axis.y * scale, axis.z * scale, cosf(halfAngle));
+                        rotation = rotation / rotation.getMagnitude();
+                        // Alternate signs so cursors have to pick the shorter arc themselves.
+                        key.value = aGenerator() % 2 ? rotation : rotation * -1.0f;
+                        aClip.addRotationKey(bone, key.time, key.value);
+                    }
+                    else {
+                        key.value = Quaternion(unit(aGenerator) * 4.0f - 2.0f, unit(aGenerator) * 4.0f - 2.0f,
+                                               unit(aGenerator) * 4.0f - 2.0f, 0.0f);
+                        const Vector3f vector(key.value.x, key.value.y, key.value.z);
+                        if (channel == CHANNEL_TRANSLATION)
+                            aClip.addTranslationKey(bone, key.time, vector);
+                        else
+                            aClip.addScaleKey(bone, key.time, vector);
+                    }
+                    track.push_back(key);
+                }
+            }
+        }
+        aClip.finalize();
+    }
+
+    bool keyBefore(float aTime, const ReferenceKey& aKey) {
+        return aTime < aKey.time;
+    }
+
+    // Samples one track the straightforward way: binary search for the bracketing keys, then
+    // lerp, or slerp along the shorter arc. Holds the end keys outside the keyed range.
+    Quaternion sampleTrack(const ReferenceTrack& aTrack, K_UINT aChannel, float aTime) {
+        if (aTrack.empty())
+            return aChannel == CHANNEL_ROTATION ? Quaternion(0.0f, 0.0f, 0.0f, 1.0f)
+                                                : aChannel == CHANNEL_SCALE ? Quaternion(1.0f, 1.0f, 1.0f, 0.0f)
+                                                                            : Quaternion(0.0f, 0.0f, 0.0f, 0.0f);
+        const ReferenceTrack::const_iterator next = upper_bound(aTrack.begin(), aTrack.end(), aTime, keyBefore);
+        if (next == aTrack.begin())
+            return aTrack.front().value;
+        if (next == aTrack.end())
+            return aTrack.back().value;
+        const ReferenceKey& from = *(next - 1);
+        const float alpha = (aTime - from.time) / (next->time - from.time);
+        if (aChannel != CHANNEL_ROTATION)
+            return from.value * (1.0f - alpha) + next->value * alpha;
+        const Quaternion to = from.value.dot(next->value) < 0.0f ? next->value * -1.0f : next->value;
+        return Quaternion::Slerp(from.value, to, alpha);
+    }
+
+    // Largest translation and scale error, and largest rotation error in degrees, of a pose
+    // against the reference at aTime.
+    void poseError(const LocalPose& aPose, const vector<ReferenceTrack>& someTracks, float aTime, double& aVectorError,
+                   double& anAngleError) {
+        for (K_UINT bone = 0; bone < BONE_COUNT; ++bone) {
+            const Vector3f* vectors[2] = { &aPose.translations[bone], &aPose.scales[bone] };
+            const K_UINT vectorChannels[2] = { CHANNEL_TRANSLATION, CHANNEL_SCALE };
+            for (K_INT c = 0; c < 2; ++c) {
+                const Quaternion expected = sampleTrack(someTracks[vectorChannels[c] * BONE_COUNT + bone], vectorChannels[c], aTime);
+                aVectorError = max(aVectorError, static_cast<double>(fabsf(vectors[c]->x - expected.x)));
+                aVectorError = max(aVectorError, static_cast<double>(fabsf(vectors[c]->y - expected.y)));
+                aVectorError = max(aVectorError, static_cast<double>(fabsf(vectors[c]->z - expected.z)));
+            }
+            // Rotations an angle apart are 2 sin(angle / 4) apart as unit quaternions, which
+            // stays well conditioned for small angles where acos of the dot product does not.
+            const Quaternion expected = sampleTrack(someTracks[CHANNEL_ROTATION * BONE_COUNT + bone], CHANNEL_ROTATION, aTime);
+            const Quaternion& actual = aPose.rotations[bone];
+            const Quaternion difference = expected + actual * (expected.dot(actual) < 0.0f ? 1.0f : -1.0f);
+            const double chord = min(2.0, static_cast<double>(difference.getMagnitude()));
+            anAngleError = max(anAngleError, 4.0 * asin(chord * 0.5) * 180.0 / PI);
+        }
+    }
+}
+
+int TestAnimation() {
+    K_INT failures = 0;
+    mt19937 generator(31);
+    uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    AnimationClip clip(BONE_COUNT, CLIP_DURATION);
+    vector<ReferenceTrack> tracks;
+    // Keys up to 30 degrees apart, about what a sampled animation holds.
+    buildClip(generator, PI / 6.0f, clip, tracks);
+
+    LinearAllocator arena(1 << 16);
+    LocalPose pose = LocalPose::Allocate(arena, BONE_COUNT);
+    const float frameTime = 1.0f / 60.0f;
+
+    // Forward playback past the end of the clip, where every track holds its last key.
+    // Translation and scale keys lie within 2 of the origin. Nlerp is within a few hundredths
+    // of a degree of slerp for keys 30 degrees apart.
+    {
+        AnimationCursor cursor(clip);
+        double vectorError = 0.0;
+        double angleError = 0.0;
+        for (float time = 0.0f; time < CLIP_DURATION + 0.5f; time += frameTime) {
+            cursor.sample(time, pose);
+            poseError(pose, tracks, time, vectorError, angleError);
+        }
+        failures += ReportBound("Cursor advance translation and scale", vectorError, 1.0e-5);
+        failures += ReportBound("Cursor advance rotation degrees", angleError, 0.05);
+    }
+
+    // Looping playback wraps time back to the start, which rewinds the cursor.
+    {
+        AnimationCursor cursor(clip);
+        double vectorError = 0.0;
+        double angleError = 0.0;
+        for (K_UINT frame = 0; frame < 600; ++frame) {
+            const float time = fmodf(frame * frameTime * 1.3f, CLIP_DURATION);
+            cursor.sample(time, pose);
+            poseError(pose, tracks, time, vectorError, angleError);
+        }
+        failures += ReportBound("Looping translation and scale", vectorError, 1.0e-5);
+        failures += ReportBound("Looping rotation degrees", angleError, 0.05);
+    }
+
+    // Seeking to random times, forwards and backwards, and onto exact key times.
+    {
+        AnimationCursor cursor(clip);
+        double vectorError = 0.0;
+        double angleError = 0.0;
+        for (K_UINT i = 0; i < 2000; ++i) {
+            float time = unit(generator) * CLIP_DURATION;
+            if (i % 4 == 0) {
+                const ReferenceTrack& track = tracks[generator() % tracks.size()];
+                if (!track.empty())
+                    time = track[generator() % track.size()].time;
+            }
+            cursor.sample(time, pose);
+            poseError(pose, tracks, time, vectorError, angleError);
+        }
+        cursor.rewind();
+        cursor.sample(0.0f, pose);
+        poseError(pose, tracks, 0.0f, vectorError, angleError);
+        failures += ReportBound("Seeking translation and scale", vectorError, 1.0e-5);
+        failures += ReportBound("Seeking rotation degrees", angleError, 0.05);
+    }
+
+    // Blending three poses against a scalar weighted sum with sign aligned rotations, then
+    // again in place into the first pose.
+    {
+        const K_UINT poseCount = 3;
+        const float weights[poseCount] = { 0.5f, 0.3f, 0.2f };
+        LocalPose poses[poseCount];
+        AnimationCursor cursor(clip);
+        for (K_UINT p = 0; p < poseCount; ++p) {
+            poses[p] = LocalPose::Allocate(arena, BONE_COUNT);
+            cursor.sample(unit(generator) * CLIP_DURATION, poses[p]);
+        }
+        LocalPose blended = LocalPose::Allocate(arena, BONE_COUNT);
+        BlendPoses(poses, weights, poseCount, blended);
+
+        double blendError = 0.0;
+        for (K_UINT bone = 0; bone < BONE_COUNT; ++bone) {
+            Vector3f translation(0.0f, 0.0f, 0.0f);
+            Vector3f scale(0.0f, 0.0f, 0.0f);
+            Quaternion rotation(0.0f, 0.0f, 0.0f, 0.0f);
+            for (K_UINT p = 0; p < poseCount; ++p) {
+                translation += poses[p].translations[bone] * weights[p];
+                scale += poses[p].scales[bone] * weights[p];
+                const float sign = poses[0].rotations[bone].dot(poses[p].rotations[bone]) < 0.0f ? -1.0f : 1.0f;
+                rotation = rotation + poses[p].rotations[bone] * (weights[p] * sign);
+            }
+            rotation = rotation / rotation.getMagnitude();
+            const Vector3f translationError = translation - blended.translations[bone];
+            const Vector3f scaleError = scale - blended.scales[bone];
+            blendError = max(blendError, static_cast<double>(translationError.getMagnitude()));
+            blendError = max(blendError, static_cast<double>(scaleError.getMagnitude()));
+            blendError = max(blendError, static_cast<double>((rotation + blended.rotations[bone] * -1.0f).getMagnitude()));
+        }
+        failures += ReportBound("BlendPoses against scalar blend", blendError, 1.0e-5);
+
+        BlendPoses(poses, weights, poseCount, poses[0]);
+        KUI_64 wrong = 0;
+        for (K_UINT bone = 0; bone < BONE_COUNT; ++bone) {
+            wrong += !(poses[0].translations[bone] == blended.translations[bone]) ||
+                     !(poses[0].rotations[bone] == blended.rotations[bone]) || !(poses[0].scales[bone] == blended.scales[bone]);
+        }
+        failures += ReportCount("BlendPoses in place", wrong);
+    }
+
+    // Keys up to 170 degrees apart, as in a hand keyed clip, where nlerp would be off by
+    // several degrees mid span. The cursor slerps those spans instead.
+    {
+        mt19937 wideGenerator(131);
+        AnimationClip wideClip(BONE_COUNT, CLIP_DURATION);
+        vector<ReferenceTrack> wideTracks;
+        buildClip(wideGenerator, 170.0f * PI / 180.0f, wideClip, wideTracks);
+
+        AnimationCursor cursor(wideClip);
+        double vectorError = 0.0;
+        double angleError = 0.0;
+        for (float time = 0.0f; time < CLIP_DURATION; time += 0.25f * frameTime) {
+            cursor.sample(time, pose);
+            poseError(pose, wideTracks, time, vectorError, angleError);
+        }
+        failures += ReportBound("Wide key spans rotation degrees", angleError, 0.05);
+    }
+
+    // Sampling speed for a crowd of instances, each a cursor playing at its own offset.
+    {
+        const K_UINT instanceCount = 256;
+        const K_UINT frameCount = 240;
+        vector<AnimationCursor*> cursors;
+        vector<float> offsets;
+        for (K_UINT i = 0; i < instanceCount; ++i) {
+            cursors.push_back(new AnimationCursor(clip));
+            offsets.push_back(unit(generator) * CLIP_DURATION);
+        }
+
+        float checksum = 0.0f;
+        high_resolution_clock::time_point start = high_resolution_clock::now();
+        for (K_UINT frame = 0; frame < frameCount; ++frame) {
+            for (K_UINT i = 0; i < instanceCount; ++i) {
+                cursors[i]->sample(fmodf(offsets[i] + frame * frameTime, CLIP_DURATION), pose);
+                checksum += pose.translations[0].x;
+            }
+        }
+        const double seconds = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+        for (K_UINT i = 0; i < instanceCount; ++i)
+            delete cursors[i];
+        const double bones = static_cast<double>(instanceCount) * frameCount * BONE_COUNT;
+        cout << "Cursor sample: " << bones / seconds / 1.0e6 << "M bones/s (checksum " << checksum << ")" << endl;
+    }
+
+    return failures;
+}
\ No newline at end of file
@@ -0,0 +1,306 @@
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "KhaosMath.h"
+#include "AudioMixer.h"
+#include "Memory.h"
+#include "TestUtilities.h"
+
+using namespace std;
+using namespace KhaosMath;
+using namespace KhaosEngine;
+using namespace KhaosTesting;
+
+namespace
+{
+    const K_UINT SAMPLE_RATE = 48000;
+    const K_UINT BLOCK_FRAMES = 512;
+
+    AudioClip makeConstant(K_UINT aLength, float aValue) {
+        AudioClip clip;
+        clip.samples.assign(aLength, aValue);
+        clip.sampleRate = SAMPLE_RATE;
+        return clip;
+    }
+
+    AudioClip makeSine(K_UINT aLength, K_UINT aSampleRate, float aFrequency) {
+        AudioClip clip;
+        clip.sampleRate = aSampleRate;
+        for (K_UINT i = 0; i < aLength; ++i)
+            clip.samples.push_back(sinf(2.0f * PI * aFrequency * i / aSampleRate));
+        return clip;
+    }
+
+    // Largest absolute sample of one channel between two frames.
+    float channelPeak(const vector<float>& someSamples, K_UINT aChannel, K_UINT aFirst, K_UINT anEnd) {
+        float peak = 0.0f;
+        for (K_UINT frame = aFirst; frame < anEnd; ++frame)
+            peak = max(peak, fabsf(someSamples[2 * frame + aChannel]));
+        return peak;
+    }
+
+    // Gains the mixer should settle on, worked out one voice at a time in double precision.
+    void referenceGains(const AudioMixerSettings& someSettings, const Vector3f& aListener, const Vector3f& aRightAxis,
+                        const Vector3f& anEmitter, float aVolume, double& aLeftGain, double& aRightGain) {
+        const double dx = anEmitter.x - aListener.x, dy = anEmitter.y - aListener.y, dz = anEmitter.z - aListener.z;
+        const double distance = sqrt(dx * dx + dy * dy + dz * dz);
+        double attenuation = someSettings.referenceDistance /
+                             (someSettings.referenceDistance +
+                              someSettings.rolloffFactor * max(distance - someSettings.referenceDistance, 0.0));
+        if (distance > someSettings.maxDistance)
+            attenuation = 0.0;
+        const double pan = min(max((dx * aRightAxis.x + dy * aRightAxis.y + dz * aRightAxis.z) / distance, -1.0), 1.0);
+        aLeftGain = aVolume * attenuation * sqrt(0.5 * (1.0 - pan));
+        aRightGain = aVolume * attenuation * sqrt(0.5 * (1.0 + pan));
+    }
+
+    // The straightforward mixer: every voice works out its own gains and steps a double
+    // position one frame at a time.
+    struct ReferenceVoice
+    {
+        const AudioClip* clip;
+        Vector3f position;
+        float volume;
+        double pitch;
+        double cursor;
+    };
+
+    void referenceMix(const AudioMixerSettings& someSettings, vector<ReferenceVoice>& someVoices, float* someSamples,
+                      K_UINT aFrameCount) {
+        fill(someSamples, someSamples + 2 * aFrameCount, 0.0f);
+        const Vector3f listener(0.0f, 0.0f, 0.0f);
+        const Vector3f right(1.0f, 0.0f, 0.0f);
+        for (ReferenceVoice& voice : someVoices) {
+            double gainLeft, gainRight;
+            referenceGains(someSettings, listener, right, voice.position, voice.volume, gainLeft, gainRight);
+            const vector<float>& samples = voice.clip->samples;
+            const double length = static_cast<double>(samples.size());
+            const double step = voice.pitch * voice.clip->sampleRate / someSettings.sampleRate;
+            for (K_UINT frame = 0; frame < aFrameCount; ++frame) {
+                const size_t index = static_cast<size_t>(voice.cursor);
+                const double weight = voice.cursor - index;
+                const double next = samples[(index + 1) % samples.size()];
+                const double sample = samples[index] + (next - samples[index]) * weight;
+                someSamples[2 * frame] += static_cast<float>(sample * gainLeft);
+                someSamples[2 * frame + 1] += static_cast<float>(sample * gainRight);
+                voice.cursor = fmod(voice.cursor + step, length);
+            }
+        }
+    }
+}
+
+int TestAudioMixer() {
+    K_INT failures = 0;
+    AudioMixerSettings settings;
+    settings.sampleRate = SAMPLE_RATE;
+    settings.referenceDistance = 1.0f;
+    settings.rolloffFactor = 1.0f;
+    settings.maxDistance = 50.0f;
+
+    // A voice off to the right is attenuated by distance and heard in the right ear only,
+    // and turning the listener around moves it to the left.
+    {
+        AudioMixer mixer(settings);
+        MemoryAudioOutput output(mixer, BLOCK_FRAMES);
+        const AudioClip clip = makeConstant(1000, 1.0f);
+        AudioVoiceSettings voiceSettings;
+        voiceSettings.looping = true;
+        mixer.play(clip, Vector3f(3.0f, 0.0f, 0.0f), voiceSettings);
+        output.render(BLOCK_FRAMES);
+        double error = fabs(channelPeak(output.getSamples(), 0, 0, BLOCK_FRAMES));
+        error = max(error, fabs(channelPeak(output.getSamples(), 1, 0, BLOCK_FRAMES) - 1.0 / 3.0));
+
+        // Half a turn about the up axis.
+        mixer.setListener(Vector3f(0.0f, 0.0f, 0.0f), Quaternion(0.0f, 1.0f, 0.0f, 0.0f));
+        output.clear();
+        output.render(2 * BLOCK_FRAMES);
+        error = max(error, fabs(channelPeak(output.getSamples(), 0, BLOCK_FRAMES, 2 * BLOCK_FRAMES) - 1.0 / 3.0));
+        error = max(error, static_cast<double>(channelPeak(output.getSamples(), 1, BLOCK_FRAMES, 2 * BLOCK_FRAMES)));
+        failures += ReportBound("Attenuation and panning", error, 1.0e-5);
+
+        // The gain changes across the first block without a jump.
+        float largestStep = 0.0f;
+        for (K_UINT frame = 1; frame < BLOCK_FRAMES; ++frame)
+            largestStep = max(largestStep, fabsf(output.getSamples()[2 * frame + 1] - output.getSamples()[2 * frame - 1]));
+        failures += ReportBound("Gain ramp has no jumps", largestStep, 1.0 / 3.0 / BLOCK_FRAMES * 1.01);
+    }
+
+    // Half pitch from a 22.05 kHz clip: a 1 kHz sine resampled to 48 kHz plays at 500 Hz.
+    {
+        AudioMixer mixer(settings);
+        MemoryAudioOutput output(mixer, BLOCK_FRAMES);
+        const AudioClip clip = makeSine(22050, 22050, 1000.0f);
+        AudioVoiceSettings voiceSettings;
+        voiceSettings.pitch = 0.5f;
+        voiceSettings.spatial = false;
+        mixer.play(clip, Vector3f(0.0f, 0.0f, 0.0f), voiceSettings);
+        output.render(SAMPLE_RATE / 4);
+        double error = 0.0;
+        for (K_UINT frame = 0; frame < SAMPLE_RATE / 4; ++frame) {
+            const double expected = sqrt(0.5) * sin(2.0 * PI * 500.0 * frame / SAMPLE_RATE);
+            error = max(error, fabs(output.getSamples()[2 * frame] - expected));
+            error = max(error, fabs(output.getSamples()[2 * frame + 1] - expected));
+        }
+        // Linear interpolation of a sine 22 samples per cycle is good to about 1%.
+        failures += ReportBound("Resampling", error, 0.01);
+    }
+
+    // One shot voices end on their last sample, and stopped voices fade out over one block,
+    // freeing their slots.
+    {
+        AudioMixer mixer(settings);
+        MemoryAudioOutput output(mixer, BLOCK_FRAMES);
+        const AudioClip shortClip = makeConstant(100, 1.0f);
+        const AudioClip longClip = makeConstant(100000, 1.0f);
+        AudioVoiceSettings voiceSettings;
+        voiceSettings.spatial = false;
+        const VoiceHandle oneShot = mixer.play(shortClip, Vector3f(0.0f, 0.0f, 0.0f), voiceSettings);
+        output.render(BLOCK_FRAMES);
+        double error = mixer.isPlaying(oneShot) ? 1.0 : 0.0;
+        error += fabs(output.getSamples()[2 * 98] - sqrt(0.5));
+        error += channelPeak(output.getSamples(), 0, 100, BLOCK_FRAMES);
+
+        const VoiceHandle held = mixer.play(longClip, Vector3f(0.0f, 0.0f, 0.0f), voiceSettings);
+        output.clear();
+        output.render(BLOCK_FRAMES);
+        error += mixer.isPlaying(held) ? 0.0 : 1.0;
+        mixer.stop(held);
+        output.clear();
+        output.render(BLOCK_FRAMES);
+        error += mixer.isPlaying(held) ? 1.0 : 0.0;
+        error += fabs(output.getSamples()[2 * (BLOCK_FRAMES - 1)]);
+        error += fabs(output.getSamples()[0] - sqrt(0.5) * (1.0 - 1.0 / BLOCK_FRAMES));
+        failures += ReportBound("Voices end and stop", error, 1.0e-5);
+
+        // Every slot can be used, and once they are all busy play fails.
+        VoiceHandle last = INVALID_VOICE;
+        K_UINT started = 0;
+        for (K_UINT i = 0; i <= MAX_AUDIO_VOICES; ++i) {
+            last = mixer.play(longClip, Vector3f(0.0f, 0.0f, 0.0f), voiceSettings);
+            started += last != INVALID_VOICE;
+        }
+        output.render(BLOCK_FRAMES);
+        failures += ReportCheck("Voice limit", started == MAX_AUDIO_VOICES && last == INVALID_VOICE &&
+                                               mixer.getActiveVoiceCount() == MAX_AUDIO_VOICES);
+    }
+
+    // Beyond the maximum distance voices keep their place in the sound but are not mixed.
+    {
+        AudioMixer mixer(settings);
+        MemoryAudioOutput output(mixer, BLOCK_FRAMES);
+        const AudioClip clip = makeConstant(1000, 1.0f);
+        AudioVoiceSettings voiceSettings;
+        voiceSettings.looping = true;
+        const VoiceHandle voice = mixer.play(clip, Vector3f(0.0f, 0.0f, 80.0f), voiceSettings);
+        output.render(BLOCK_FRAMES);
+        double error = channelPeak(output.getSamples(), 0, 0, BLOCK_FRAMES) + mixer.getMixedVoiceCount();
+        error += mixer.getActiveVoiceCount() == 1 ? 0.0 : 1.0;
+        mixer.setVoicePosition(voice, Vector3f(0.0f, 0.0f, 1.0f));
+        output.clear();
+        output.render(BLOCK_FRAMES);
+        error += fabs(output.getSamples()[2 * (BLOCK_FRAMES - 1)] - sqrt(0.5)) + (mixer.getMixedVoiceCount() != 1);
+        failures += ReportBound("Out of range voices skipped", error, 1.0e-5);
+    }
+
+    // Many voices at mixed pitches match the one voice at a time reference, and a steady
+    // state block allocates nothing.
+    {
+        const K_UINT voiceCount = 256;
+        const K_UINT blockCount = 400;
+        vector<AudioClip> clips;
+        for (K_UINT i = 0; i < 8; ++i)
+            clips.push_back(makeSine(4000 + 977 * i, i % 2 ? 22050 : 44100, 200.0f + 150.0f * i));
+
+        AudioMixer mixer(settings);
+        vector<ReferenceVoice> referenceVoices;
+        for (K_UINT i = 0; i < voiceCount; ++i) {
+            AudioVoiceSettings voiceSettings;
+            voiceSettings.looping = true;
+            voiceSettings.volume = 0.02f; // Quiet enough that the sum never clips.
+            voiceSettings.pitch = 0.5f + 0.01f * (i % 100);
+            const float angle = 2.0f * PI * i / voiceCount;
+            const Vector3f position(cosf(angle) * (2.0f + i % 7), 0.5f * (i % 3), sinf(angle) * (2.0f + i % 7));
+            mixer.play(clips[i % clips.size()], position, voiceSettings);
+            const ReferenceVoice voice = { &clips[i % clips.size()], position, voiceSettings.volume, voiceSettings.pitch, 0.0 };
+            referenceVoices.push_back(voice);
+        }
+
+        vector<float> mixed(2 * BLOCK_FRAMES);
+        vector<float> expected(2 * BLOCK_FRAMES);
+        double error = 0.0;
+        double peak = 0.0;
+        for (K_UINT block = 0; block < 4; ++block) {
+            mixer.mix(mixed.data(), BLOCK_FRAMES);
+            referenceMix(settings, referenceVoices, expected.data(), BLOCK_FRAMES);
+            for (K_UINT i = 0; i < 2 * BLOCK_FRAMES; ++i) {
+                error = max(error, static_cast<double>(fabsf(mixed[i] - expected[i])));
+                peak = max(peak, static_cast<double>(fabsf(expected[i])));
+            }
+        }
+        failures += ReportBound("Matches reference mixer", error / peak, 1.0e-4);
+
+        const KUI_64 allocationsBefore = GetHeapAllocationCount();
+        auto start = chrono::high_resolution_clock::now();
+        for (K_UINT block = 0; block < blockCount; ++block)
+            mixer.mix(mixed.data(), BLOCK_FRAMES);
+        const double simdTime = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        failures += ReportCount("No allocation while mixing", GetHeapAllocationCount() - allocationsBefore);
+
+        start = chrono::high_resolution_clock::now();
+        for (K_UINT block = 0; block < blockCount; ++block)
+            referenceMix(settings, referenceVoices, expected.data(), BLOCK_FRAMES);
+        const double referenceTime = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+
+        const double blockSeconds = static_cast<double>(BLOCK_FRAMES) / SAMPLE_RATE;
+        cout << voiceCount << " voices, " << BLOCK_FRAMES << " frame blocks: reference " << referenceTime / blockCount * 1.0e6
+             << " us, mixer " << simdTime / blockCount * 1.0e6 << " us per block (" << referenceTime / simdTime
+             << "x), " << simdTime / blockCount / blockSeconds * 100.0 << "% of real time" << endl;
+    }
+
+    // The game thread moving voices while another thread mixes, as with a device callback.
+    {
+        AudioMixer mixer(settings);
+        MemoryAudioOutput output(mixer, BLOCK_FRAMES);
+        const AudioClip clip = makeSine(4800, SAMPLE_RATE, 440.0f);
+        AudioVoiceSettings voiceSettings;
+        voiceSettings.looping = true;
+        vector<VoiceHandle> voices;
+        for (K_UINT i = 0; i < 64; ++i)
+            voices.push_back(mixer.play(clip, Vector3f(static_cast<float>(i % 8), 0.0f, 1.0f), voiceSettings));
+
+        atomic<bool> done(false);
+        thread device([&output, &done] {
+            while (!done.load())
+                output.render(BLOCK_FRAMES);
+        });
+        K_UINT lost = 0;
+        for (K_UINT frame = 0; frame < 200; ++frame) {
+            mixer.setListener(Vector3f(0.1f * frame, 0.0f, 0.0f), Quaternion(0.0f, 0.0f, 0.0f, 1.0f));
+            for (K_UINT i = 0; i < voices.size(); ++i)
+                mixer.setVoicePosition(voices[i], Vector3f(static_cast<float>(i % 8), 0.0f, 1.0f + 0.05f * frame));
+            const VoiceHandle blip = mixer.play(clip, Vector3f(0.0f, 0.0f, 2.0f), AudioVoiceSettings());
+            lost += blip == INVALID_VOICE;
+            mixer.stop(blip);
+            this_thread::sleep_for(chrono::microseconds(200));
+        }
+        done.store(true);
+        device.join();
+
+        float peak = 0.0f;
+        bool finite = true;
+        for (float sample : output.getSamples()) {
+            peak = max(peak, fabsf(sample));
+            finite = finite && sample == sample;
+        }
+        failures += ReportCheck("Mixing alongside the game thread", finite && peak <= 1.0f);
+        cout << output.getSamples().size() / 2 / BLOCK_FRAMES << " blocks mixed, " << lost << " plays and "
+             << mixer.getDroppedCommandCount() << " commands dropped" << endl;
+    }
+
+    return failures;
+}
\ No newline at end of file
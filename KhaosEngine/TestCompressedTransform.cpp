@@ -0,0 +1,112 @@
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "KhaosMath.h"
+#include "CompressedTransform.h"
+#include "TestUtilities.h"
+
+using namespace std;
+using namespace KhaosMath;
+using namespace KhaosTesting;
+
+namespace
+{
+    // Returns the largest component error between two rotations, treating q and -q as equal.
+    float rotationError(const Quaternion& aQuat, const Quaternion& bQuat) {
+        const float sign = aQuat.dot(bQuat) < 0.0f ? -1.0f : 1.0f;
+        const Quaternion difference = aQuat + bQuat * -sign;
+        return max(max(fabsf(difference.x), fabsf(difference.y)), max(fabsf(difference.z), fabsf(difference.w)));
+    }
+}
+
+// Round trips random data through every compressed format, scalar and batched,
+// and checks the reconstruction error against each format's documented bound.
+// Returns the number of failed checks.
+int TestCompressedTransforms() {
+    const size_t count = 4099; // Not a multiple of four so the scalar tails run too.
+    mt19937 generator(1234);
+    uniform_real_distribution<float> position(-1000.0f, 1000.0f);
+
+    K_INT failures = 0;
+
+    // Half precision vectors. Relative error of round to nearest is at most 2^-11.
+    vector<Vector3f> positions(count);
+    for (size_t i = 0; i < count; ++i)
+        positions[i] = Vector3f(position(generator), position(generator), position(generator));
+
+    vector<HalfVector3> halfs(count);
+    vector<Vector3f> decodedPositions(count);
+    EncodeHalfVectors(positions.data(), halfs.data(), count);
+    DecodeHalfVectors(halfs.data(), decodedPositions.data(), count);
+
+    float halfError = 0.0f;
+    K_INT batchMismatches = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const Vector3f difference = decodedPositions[i] - positions[i];
+        halfError = max(halfError, fabsf(difference.x) / max(fabsf(positions[i].x), 1e-4f));
+        halfError = max(halfError, fabsf(difference.y) / max(fabsf(positions[i].y), 1e-4f));
+        halfError = max(halfError, fabsf(difference.z) / max(fabsf(positions[i].z), 1e-4f));
+        const HalfVector3 scalar(positions[i]);
+        if (scalar.x != halfs[i].x || scalar.y != halfs[i].y || scalar.z != halfs[i].z)
+            ++batchMismatches;
+    }
+    failures += ReportBound("HalfVector3 relative", halfError, 1.0f / 2048.0f);
+    failures += ReportCount("HalfVector3 batch vs scalar", batchMismatches);
+
+    // Special values must survive the trip unchanged.
+    const float specials[] = { 0.0f, -0.0f, 1.0f, -2.5f, 65504.0f, 6.10351562e-05f, 5.96046448e-08f };
+    K_INT specialMismatches = 0;
+    for (size_t i = 0; i < sizeof(specials) / sizeof(specials[0]); ++i) {
+        if (HalfToFloat(FloatToHalf(specials[i])) != specials[i])
+            ++specialMismatches;
+    }
+    if (FloatToHalf(1.0e6f) != 0x7c00 || FloatToHalf(-1.0e6f) != 0xfc00)
+        ++specialMismatches;
+    failures += ReportCount("Half special values", specialMismatches);
+
+    // Smallest-three quaternions.
+    vector<Quaternion> rotations(count);
+    for (size_t i = 0; i < count; ++i)
+        rotations[i] = RandomRotation(generator);
+
+    vector<PackedQuaternion32> packed32(count);
+    vector<PackedQuaternion48> packed48(count);
+    vector<Quaternion> decoded32(count);
+    vector<Quaternion> decoded48(count);
+    EncodeQuaternions(rotations.data(), packed32.data(), count);
+    DecodeQuaternions(packed32.data(), decoded32.data(), count);
+    EncodeQuaternions(rotations.data(), packed48.data(), count);
+    DecodeQuaternions(packed48.data(), decoded48.data(), count);
+
+    float error32 = 0.0f;
+    float error48 = 0.0f;
+    float scalarError = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        error32 = max(error32, rotationError(rotations[i], decoded32[i]));
+        error48 = max(error48, rotationError(rotations[i], decoded48[i]));
+        scalarError = max(scalarError, rotationError(PackedQuaternion32(rotations[i]).toQuaternion(), decoded32[i]));
+        scalarError = max(scalarError, rotationError(PackedQuaternion48(rotations[i]).toQuaternion(), decoded48[i]));
+    }
+    failures += ReportBound("PackedQuaternion32", error32, 0.002f);
+    failures += ReportBound("PackedQuaternion48", error48, 0.0001f);
+    failures += ReportBound("PackedQuaternion batch vs scalar", scalarError, 1e-6f);
+
+    // Affine matrices are stored losslessly.
+    vector<Matrix4x4f> matrices(count);
+    vector<AffineMatrix3x4f> affine(count);
+    vector<Matrix4x4f> decodedMatrices(count);
+    for (size_t i = 0; i < count; ++i)
+        matrices[i] = Matrix4x4f::TRS(positions[i], rotations[i], Vector3f(1.0f, 2.0f, 3.0f));
+    EncodeAffine(matrices.data(), affine.data(), count);
+    DecodeAffine(affine.data(), decodedMatrices.data(), count);
+
+    K_INT affineMismatches = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (decodedMatrices[i] != matrices[i] || AffineMatrix3x4f(matrices[i]).toMatrix4x4f() != matrices[i])
+            ++affineMismatches;
+    }
+    failures += ReportCount("AffineMatrix3x4f round trip", affineMismatches);
+
+    return failures;
+}
\ No newline at end of file
@@ -0,0 +1,199 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "KhaosMath.h"
+#include "ConvexCollision.h"
+#include "TestUtilities.h"
+
+using namespace std;
+using namespace std::chrono;
+using namespace KhaosMath;
+using namespace KhaosEngine;
+using namespace KhaosTesting;
+
+namespace
+{
+    // Returns aCount points scattered over an ellipsoid with the given radii.
+    vector<Vector3f> randomHullVertices(mt19937& aGenerator, K_UINT aCount, const Vector3f& someRadii) {
+        normal_distribution<float> gaussian(0.0f, 1.0f);
+        vector<Vector3f> vertices(aCount);
+        for (Vector3f& vertex : vertices) {
+            const Vector3f direction = Vector3f(gaussian(aGenerator), gaussian(aGenerator), gaussian(aGenerator)).getNormalized();
+            vertex = Vector3f(direction.x * someRadii.x, direction.y * someRadii.y, direction.z * someRadii.z);
+        }
+        return vertices;
+    }
+
+    struct Pose
+    {
+        Quaternion rotation;
+        Vector3f position;
+    };
+
+    // Returns how far a result's points disagree with its normal and distance.
+    float witnessError(const CollisionResult& aResult) {
+        return (aResult.pointB - aResult.pointA - aResult.normal * aResult.distance).getMagnitude();
+    }
+}
+
+// Checks GJK and EPA against analytic results for the primitive shapes, cross checks hulls
+// against the equivalent boxes, and times queries with and without warm starting.
+// Returns the number of failed checks.
+int TestConvexCollision() {
+    K_INT failures = 0;
+    mt19937 generator(41);
+    const Quaternion identity(0.0f, 0.0f, 0.0f, 1.0f);
+
+    // SIMD support points against a linear scan.
+    {
+        const vector<Vector3f> vertices = randomHullVertices(generator, 37, Vector3f(1.0f, 2.0f, 0.5f));
+        const ConvexHull hull(vertices.data(), static_cast<K_UINT>(vertices.size()));
+        normal_distribution<float> gaussian(0.0f, 1.0f);
+        K_INT mismatches = 0;
+        for (K_INT i = 0; i < 1000; ++i) {
+            const Vector3f direction(gaussian(generator), gaussian(generator), gaussian(generator));
+            float best = -INFINITY;
+            for (const Vector3f& vertex : vertices)
+                best = max(best, vertex.dot(direction));
+            mismatches += hull.getVertex(hull.getSupportIndex(direction)).dot(direction) == best ? 0 : 1;
+        }
+        failures += ReportCount("Hull support points", mismatches);
+    }
+
+    // Analytic cases.
+    {
+        const ConvexShape sphere = ConvexShape::Sphere(1.0f);
+        const ConvexShape smallSphere = ConvexShape::Sphere(0.5f);
+        const ConvexShape box = ConvexShape::Box(Vector3f(1.0f, 1.0f, 1.0f));
+        const ConvexShape smallBox = ConvexShape::Box(Vector3f(0.5f, 0.5f, 0.5f));
+        const ConvexShape capsule = ConvexShape::Capsule(0.5f, 1.0f);
+        const Quaternion turned(0.0f, 0.0f, sinf(PI / 8.0f), cosf(PI / 8.0f));
+
+        struct Case
+        {
+            const char* name;
+            const ConvexShape* a;
+            Quaternion rotation;
+            const ConvexShape* b;
+            Vector3f position;
+            float distance;
+            float bound;
+        };
+        const Case cases[] = {
+            { "Sphere sphere separated", &sphere, identity, &smallSphere, Vector3f(3.0f, 0.0f, 0.0f), 1.5f, 1.0e-5f },
+            { "Sphere sphere shallow", &sphere, identity, &smallSphere, Vector3f(0.0f, 1.2f, 0.0f), -0.3f, 1.0e-5f },
+            { "Sphere sphere concentric", &sphere, identity, &smallSphere, Vector3f(), -1.5f, 1.0e-5f },
+            { "Box box separated", &box, identity, &smallBox, Vector3f(3.0f, 0.2f, 0.0f), 1.5f, 1.0e-5f },
+            { "Box box penetrating", &box, identity, &smallBox, Vector3f(1.3f, 0.2f, 0.1f), -0.2f, 1.0e-4f },
+            { "Turned box sphere", &box, turned, &smallSphere, Vector3f(2.0f, 0.0f, 0.0f), 1.5f - sqrtf(2.0f), 1.0e-5f },
+            { "Turned box sphere penetrating", &box, turned, &smallSphere, Vector3f(1.2f, 0.0f, 0.0f), 1.2f / sqrtf(2.0f) - 1.5f, 1.0e-4f },
+            { "Capsule box", &capsule, identity, &box, Vector3f(2.0f, 0.5f, 0.0f), 0.5f, 1.0e-5f },
+            { "Capsule box shallow", &capsule, identity, &box, Vector3f(0.5f, 2.2f, 0.0f), -0.3f, 1.0e-5f },
+            { "Capsule box penetrating", &capsule, identity, &box, Vector3f(0.0f, 0.5f, 0.0f), -1.5f, 1.0e-4f },
+        };
+        for (const Case& test : cases) {
+            const CollisionResult result = ComputeContact(*test.a, test.rotation, Vector3f(), *test.b, identity, test.position);
+            failures += ReportBound(test.name, max(fabsf(result.distance - test.distance), witnessError(result)), test.bound);
+        }
+    }
+
+    // A hull of a box's corners must agree with the box, and separating penetrating pairs along
+    // the reported normal by the reported depth must leave them just touching.
+    {
+        const Vector3f halfExtents(0.8f, 0.4f, 1.2f);
+        vector<Vector3f> corners;
+        for (K_UINT corner = 0; corner < 8; ++corner)
+            corners.push_back(Vector3f(corner & 1 ? halfExtents.x : -halfExtents.x, corner & 2 ? halfExtents.y : -halfExtents.y,
+                                       corner & 4 ? halfExtents.z : -halfExtents.z));
+        const ConvexHull cornerHull(corners.data(), 8);
+        const ConvexShape boxShape = ConvexShape::Box(halfExtents);
+        const ConvexShape cornerShape = ConvexShape::Hull(cornerHull);
+        const vector<Vector3f> blobVertices = randomHullVertices(generator, 48, Vector3f(1.0f, 0.7f, 0.5f));
+        const ConvexHull blobHull(blobVertices.data(), 48);
+        const ConvexShape others[3] = { ConvexShape::Hull(blobHull), ConvexShape::Capsule(0.3f, 0.6f), ConvexShape::Sphere(0.7f) };
+
+        uniform_real_distribution<float> offset(-2.5f, 2.5f);
+        float hullError = 0.0f;
+        float witness = 0.0f;
+        float separation = 0.0f;
+        for (K_INT i = 0; i < 3000; ++i) {
+            const ConvexShape& other = others[i % 3];
+            const Quaternion rotationA = RandomRotation(generator);
+            const Quaternion rotationB = RandomRotation(generator);
+            const Vector3f positionB(offset(generator), offset(generator), offset(generator));
+            const CollisionResult boxResult = ComputeContact(boxShape, rotationA, Vector3f(), other, rotationB, positionB);
+            const CollisionResult hullResult = ComputeContact(cornerShape, rotationA, Vector3f(), other, rotationB, positionB);
+            hullError = max(hullError, fabsf(boxResult.distance - hullResult.distance));
+            witness = max(witness, witnessError(boxResult));
+
+            if (boxResult.intersecting) {
+                const Vector3f separated = positionB - boxResult.normal * boxResult.distance;
+                const CollisionResult moved = ComputeContact(boxShape, rotationA, Vector3f(), other, rotationB, separated);
+                separation = max(separation, fabsf(moved.distance));
+            }
+        }
+        failures += ReportBound("Hull matches box", hullError, 2.0e-3);
+        failures += ReportBound("Witness points", witness, 2.0e-3);
+        failures += ReportBound("Separated along contact normal", separation, 2.0e-3);
+    }
+
+    // Benchmark coherent motion: pairs drift a little each frame.
+    {
+        const K_UINT pairCount = 2000;
+        const K_UINT frameCount = 20;
+        const vector<Vector3f> hullVertices = randomHullVertices(generator, 32, Vector3f(1.0f, 1.0f, 1.0f));
+        const ConvexHull hull(hullVertices.data(), 32);
+        const ConvexShape hullShape = ConvexShape::Hull(hull);
+        const ConvexShape box = ConvexShape::Box(Vector3f(0.5f, 0.5f, 0.5f));
+        const ConvexShape sphere = ConvexShape::Sphere(0.6f);
+        const ConvexShape capsule = ConvexShape::Capsule(0.4f, 0.8f);
+
+        struct Pairing
+        {
+            const char* name;
+            const ConvexShape* a;
+            const ConvexShape* b;
+        };
+        const Pairing pairings[] = { { "Hull hull", &hullShape, &hullShape }, { "Box box", &box, &box },
+                                     { "Sphere capsule", &sphere, &capsule }, { "Hull capsule", &hullShape, &capsule } };
+
+        uniform_real_distribution<float> offset(-2.0f, 2.0f);
+        vector<Pose> posesA(pairCount), posesB(pairCount);
+        vector<Vector3f> velocities(pairCount);
+        for (K_UINT i = 0; i < pairCount; ++i) {
+            posesA[i].rotation = RandomRotation(generator);
+            posesB[i].rotation = RandomRotation(generator);
+            posesA[i].position = Vector3f();
+            posesB[i].position = Vector3f(offset(generator), offset(generator), offset(generator));
+            velocities[i] = Vector3f(offset(generator), offset(generator), offset(generator)) * 0.005f;
+        }
+
+        for (const Pairing& pairing : pairings) {
+            for (K_INT warm = 0; warm < 2; ++warm) {
+                vector<GjkCache> caches(pairCount);
+                K_UINT iterations = 0;
+                K_UINT intersecting = 0;
+                const high_resolution_clock::time_point start = high_resolution_clock::now();
+                for (K_UINT frame = 0; frame < frameCount; ++frame) {
+                    for (K_UINT i = 0; i < pairCount; ++i) {
+                        const CollisionResult result = ComputeContact(*pairing.a, posesA[i].rotation, posesA[i].position,
+                                                                      *pairing.b, posesB[i].rotation,
+                                                                      posesB[i].position + velocities[i] * static_cast<float>(frame),
+                                                                      warm ? &caches[i] : nullptr);
+                        iterations += result.iterations;
+                        intersecting += result.intersecting ? 1 : 0;
+                    }
+                }
+                const double seconds = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+                const double queries = static_cast<double>(pairCount) * frameCount;
+                cout << pairing.name << (warm ? ", warm started: " : ", cold: ") << queries / seconds / 1.0e6 << "M pairs/s, "
+                     << iterations / queries << " iterations per pair, " << 100.0 * intersecting / queries << "% intersecting" << endl;
+            }
+        }
+    }
+
+    return failures;
+}
\ No newline at end of file
@@ -0,0 +1,223 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "KhaosMath.h"
+#include "EntityStore.h"
+#include "TestUtilities.h"
+
+using namespace std;
+using namespace std::chrono;
+using namespace KhaosMath;
+using namespace KhaosEngine;
+using namespace KhaosTesting;
+
+namespace
+{
+    struct Velocity
+    {
+        Vector3f linear;
+    };
+
+    // Records which entity a row belongs to, so moved rows can be traced back.
+    struct Identity
+    {
+        KUI_32 id;
+    };
+
+    // An odd sized component, to check the columns after it still start aligned.
+    struct Flags
+    {
+        KUI_8 bits[3];
+    };
+
+    // Counts visits to each entity from a parallel query.
+    struct VisitCount
+    {
+        K_UINT count;
+    };
+
+    bool isAligned(const void* aPointer) {
+        return reinterpret_cast<size_t>(aPointer) % SIMD_ALIGNMENT == 0;
+    }
+}
+
+int TestEntityStore() {
+    K_INT failures = 0;
+    mt19937 generator(5);
+
+    // Destroyed indices are reused with a new generation, and stale handles stay dead.
+    {
+        EntityStore store;
+        const Entity first = store.create(Identity{ 1 });
+        store.destroy(first);
+        const Entity second = store.create(Identity{ 2 });
+        failures += ReportCheck("Entity index reused with new generation",
+                                second.index == first.index && second.generation == first.generation + 1 &&
+                                !store.isAlive(first) && store.isAlive(second) && store.getEntityCount() == 1);
+    }
+
+    // Adding and removing components moves entities between archetypes and keeps the
+    // components both archetypes share.
+    {
+        EntityStore store;
+        const K_UINT entityCount = 3000;
+        vector<Entity> entities(entityCount);
+        for (K_UINT i = 0; i < entityCount; ++i)
+            entities[i] = store.create(Identity{ i }, Vector3f(static_cast<float>(i), 0.0f, 0.0f));
+        for (K_UINT i = 0; i < entityCount; i += 2)
+            store.add(entities[i], Velocity{ Vector3f(0.0f, static_cast<float>(i), 0.0f) });
+        for (K_UINT i = 0; i < entityCount; i += 3)
+            store.remove<Vector3f>(entities[i]);
+
+        KUI_64 wrong = 0;
+        for (K_UINT i = 0; i < entityCount; ++i) {
+            const Identity* identity = store.get<Identity>(entities[i]);
+            const Vector3f* position = store.get<Vector3f>(entities[i]);
+            const Velocity* velocity = store.get<Velocity>(entities[i]);
+            if (identity == nullptr || identity->id != i)
+                ++wrong;
+            else if ((position != nullptr) != (i % 3 != 0) || (position && position->x != static_cast<float>(i)))
+                ++wrong;
+            else if ((velocity != nullptr) != (i % 2 == 0) || (velocity && velocity->linear.y != static_cast<float>(i)))
+                ++wrong;
+        }
+        failures += ReportCount("Archetype change keeps components", wrong);
+    }
+
+    // Destroying rows from the middle of many chunks fills each hole with the archetype's
+    // last entity, and the moved entity's record follows it.
+    {
+        EntityStore store;
+        const K_UINT entityCount = 20000;
+        vector<Entity> entities(entityCount);
+        for (K_UINT i = 0; i < entityCount; ++i)
+            entities[i] = store.create(Identity{ i }, Vector3f(static_cast<float>(i), 0.0f, 0.0f));
+
+        vector<bool> destroyed(entityCount, false);
+        K_UINT aliveCount = entityCount;
+        for (K_UINT i = 0; i < entityCount / 2; ++i) {
+            const K_UINT victim = generator() % entityCount;
+            if (destroyed[victim])
+                continue;
+            store.destroy(entities[victim]);
+            destroyed[victim] = true;
+            --aliveCount;
+        }
+
+        KUI_64 wrong = 0;
+        for (K_UINT i = 0; i < entityCount; ++i) {
+            if (store.isAlive(entities[i]) == destroyed[i])
+                ++wrong;
+            else if (!destroyed[i] && (store.get<Identity>(entities[i])->id != i ||
+                                       store.get<Vector3f>(entities[i])->x != static_cast<float>(i)))
+                ++wrong;
+        }
+
+        // Every chunk but an archetype's last is full, and the chunk rows name their entities.
+        vector<EntityChunk*> chunks;
+        store.getChunks(0, 0, chunks);
+        K_UINT visited = 0;
+        for (size_t c = 0; c < chunks.size(); ++c) {
+            const EntityChunk& chunk = *chunks[c];
+            if (c + 1 < chunks.size() && chunk.getCount() != chunk.getCapacity())
+                ++wrong;
+            const Identity* identities = chunk.getColumn<Identity>();
+            for (K_UINT row = 0; row < chunk.getCount(); ++row) {
+                if (chunk.getEntities()[row] != entities[identities[row].id])
+                    ++wrong;
+            }
+            visited += chunk.getCount();
+        }
+        failures += ReportCount("Removed rows swap back the last entity", wrong);
+        failures += ReportCheck("Entity count after removal", visited == aliveCount && store.getEntityCount() == aliveCount);
+    }
+
+    // Every column starts on a SIMD boundary, whatever components come before it.
+    {
+        EntityStore store;
+        for (K_UINT i = 0; i < 1000; ++i) {
+            store.create(Flags{ { 1, 2, 3 } }, Vector3f(0.0f, 0.0f, 0.0f), Identity{ i });
+            store.create(Flags{ { 1, 2, 3 } }, Quaternion(0.0f, 0.0f, 0.0f, 1.0f), Matrix4x4f::Identity());
+            store.create(Identity{ i }, Vector4f(0.0f, 0.0f, 0.0f, 1.0f));
+        }
+
+        vector<EntityChunk*> chunks;
+        store.getChunks(0, 0, chunks);
+        KUI_64 misaligned = 0;
+        for (size_t c = 0; c < chunks.size(); ++c) {
+            const EntityChunk& chunk = *chunks[c];
+            const void* columns[] = { chunk.getEntities(), chunk.getColumn<Flags>(), chunk.getColumn<Vector3f>(),
+                                      chunk.getColumn<Identity>(), chunk.getColumn<Quaternion>(),
+                                      chunk.getColumn<Matrix4x4f>(), chunk.getColumn<Vector4f>() };
+            for (size_t i = 0; i < sizeof(columns) / sizeof(columns[0]); ++i) {
+                if (columns[i] != nullptr && !isAligned(columns[i]))
+                    ++misaligned;
+            }
+        }
+        failures += ReportCount("Columns are 16-byte aligned", misaligned);
+    }
+
+    // A parallel query visits every matching entity exactly once.
+    {
+        EntityStore store;
+        const K_UINT entityCount = 50000;
+        for (K_UINT i = 0; i < entityCount; ++i) {
+            if (i % 4 == 0)
+                store.create(VisitCount{ 0 }, Identity{ i });
+            else
+                store.create(VisitCount{ 0 }, Vector3f(0.0f, 0.0f, 0.0f), Velocity{ Vector3f(1.0f, 0.0f, 0.0f) });
+        }
+
+        vector<EntityChunk*> chunks;
+        store.getChunks(ComponentMaskOf<VisitCount>(), 0, chunks);
+        ForEachChunkParallel(chunks, [](EntityChunk& aChunk) {
+            VisitCount* visits = aChunk.getColumn<VisitCount>();
+            for (K_UINT row = 0; row < aChunk.getCount(); ++row)
+                ++visits[row].count;
+        });
+
+        KUI_64 wrong = 0;
+        K_UINT visited = 0;
+        store.forEach<VisitCount>([&](VisitCount& aVisits) {
+            wrong += aVisits.count != 1;
+            ++visited;
+        });
+        failures += ReportCount("Parallel query visits each entity once", wrong + (visited != entityCount));
+
+        // Integration speed, serial and parallel.
+        const K_UINT passes = 200;
+        vector<EntityChunk*> moving;
+        store.getChunks(ComponentMaskOf<Vector3f, Velocity>(), 0, moving);
+        const float timeStep = 1.0f / 60.0f;
+
+        high_resolution_clock::time_point start = high_resolution_clock::now();
+        for (K_UINT pass = 0; pass < passes; ++pass) {
+            store.forEach<Vector3f, Velocity>([=](Vector3f& aPosition, Velocity& aVelocity) {
+                aPosition += aVelocity.linear * timeStep;
+            });
+        }
+        const double serialSeconds = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+
+        start = high_resolution_clock::now();
+        for (K_UINT pass = 0; pass < passes; ++pass) {
+            ForEachChunkParallel(moving, [=](EntityChunk& aChunk) {
+                Vector3f* positions = aChunk.getColumn<Vector3f>();
+                const Velocity* velocities = aChunk.getColumn<Velocity>();
+                for (K_UINT row = 0; row < aChunk.getCount(); ++row)
+                    positions[row] += velocities[row].linear * timeStep;
+            });
+        }
+        const double parallelSeconds = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+
+        const double updates = static_cast<double>(entityCount) * 3 / 4 * passes / 1.0e6;
+        float checksum = 0.0f;
+        store.forEach<Vector3f>([&](Vector3f& aPosition) { checksum += aPosition.x; });
+        cout << "Integrate serial: " << updates / serialSeconds << "M entities/s, parallel: " << updates / parallelSeconds
+             << "M entities/s (checksum " << checksum << ")" << endl;
+    }
+
+    return failures;
+}
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "KhaosMath.h"
+#include "TestUtilities.h"
+
+using namespace std;
+using namespace std::chrono;
+using namespace KhaosMath;
+using namespace KhaosTesting;
+
+// Compile-time checks. Because the fixed-point paths are constexpr, these also pin the
+// exact bits every platform must produce.
+namespace FixedPointTests
+{
+    static_assert(Fixed16(3) * Fixed16(4) == Fixed16(12), "Integer products must be exact.");
+    static_assert(Fixed32(-3) * Fixed32(4) == Fixed32(-12), "Signed Q32.32 products must be exact.");
+    static_assert(Fixed16(1) / Fixed16(4) == Fixed16::FromRaw(0x4000), "One quarter must be exact.");
+    static_assert(Fixed32(-1) / Fixed32(3) == Fixed32::FromRaw(-0x55555555ll), "Division must round to nearest.");
+    static_assert(Sqrt(Fixed16(16)) == Fixed16(4) && Sqrt(Fixed32(144)) == Fixed32(12), "Square roots must be exact.");
+    static_assert(Sin(Fixed16()) == Fixed16() && Cos(Fixed32()) == Fixed32::One(), "Trig must be exact at zero.");
+    static_assert(FixedVector3<Fixed16>(Fixed16(1), Fixed16(), Fixed16()).crossProduct(
+                      FixedVector3<Fixed16>(Fixed16(), Fixed16(1), Fixed16())) ==
+                  FixedVector3<Fixed16>(Fixed16(), Fixed16(), Fixed16(1)), "X cross Y must be Z.");
+    static_assert(FixedMatrix4x4<Fixed32>::Identity() * FixedMatrix4x4<Fixed32>::Identity() ==
+                  FixedMatrix4x4<Fixed32>::Identity(), "Identity must be neutral.");
+}
+
+namespace
+{
+    // Returns the largest error of the fixed-point scalar functions against double precision.
+    template <typename Fixed>
+    K_INT checkScalarAccuracy(const char* aName, double aBound) {
+        double sqrtError = 0.0;
+        double trigError = 0.0;
+        double inverseError = 0.0;
+        for (K_INT i = -2000; i <= 2000; ++i) {
+            const Fixed angle = Fixed::FromDouble(i * 0.005);
+            const double exact = angle.toDouble();
+            trigError = max(trigError, fabs(Sin(angle).toDouble() - sin(exact)));
+            trigError = max(trigError, fabs(Cos(angle).toDouble() - cos(exact)));
+
+            const Fixed value = Fixed::FromDouble(i * 0.0005);
+            inverseError = max(inverseError, fabs(Acos(value).toDouble() - acos(value.toDouble())));
+            inverseError = max(inverseError, fabs(Atan2(value, Fixed::FromDouble(0.3)).toDouble() - atan2(value.toDouble(), 0.3)));
+
+            const Fixed radicand = Fixed::FromDouble(fabs(i * 0.25));
+            sqrtError = max(sqrtError, fabs(Sqrt(radicand).toDouble() - sqrt(radicand.toDouble())));
+        }
+
+        cout << aName << endl;
+        K_INT failures = ReportBound("  Sqrt", sqrtError, aBound);
+        failures += ReportBound("  Sin/Cos", trigError, aBound * 4.0);
+        failures += ReportBound("  Acos/Atan2", inverseError, aBound * 16.0);
+        return failures;
+    }
+
+    // Restores unit length after an incremental rotation, the cheapest way each type allows.
+    Quaternion renormalized(const Quaternion& aQuat) {
+        return aQuat * (1.0f / aQuat.getMagnitude());
+    }
+
+    template <typename T>
+    FixedQuaternion<T> renormalized(const FixedQuaternion<T>& aQuat) {
+        return aQuat.getRenormalized();
+    }
+
+    // Returns how far from unit length a rotation drifts over aSteps renormalized spins.
+    template <typename T>
+    double renormalizedDrift(const FixedQuaternion<T>& aSpin, K_INT aSteps) {
+        FixedQuaternion<T> orientation = FixedQuaternion<T>::Identity();
+        double drift = 0.0;
+        for (K_INT step = 0; step < aSteps; ++step) {
+            orientation = (orientation * aSpin).getRenormalized();
+            drift = max(drift, fabs(orientation.getMagnitude().toDouble() - 1.0));
+        }
+        return drift;
+    }
+
+    // One simulation tick over every body: integrate, spin and face the direction of travel.
+    template <typename Vector, typename Quat, typename Scalar>
+    void tick(vector<Vector>& somePositions, vector<Vector>& someVelocities, vector<Quat>& someOrientations,
+              vector<Vector>& someHeadings, const Vector& aGravity, const Quat& aSpin, Scalar aTimeStep) {
+        for (size_t i = 0; i < somePositions.size(); ++i) {
+            someVelocities[i] += aGravity * aTimeStep;
+            somePositions[i] += someVelocities[i] * aTimeStep;
+            const Quat spun = someOrientations[i] * aSpin;
+            someOrientations[i] = renormalized(spun);
+            someHeadings[i] = someVelocities[i].getNormalized();
+        }
+    }
+
+    // Largest component difference between two fixed-point quaternions.
+    template <typename T>
+    double quaternionDistance(const FixedQuaternion<T>& aQuat, const FixedQuaternion<T>& bQuat) {
+        return max(max(fabs((aQuat.x - bQuat.x).toDouble()), fabs((aQuat.y - bQuat.y).toDouble())),
+                   max(fabs((aQuat.z - bQuat.z).toDouble()), fabs((aQuat.w - bQuat.w).toDouble())));
+    }
+
+    // Runs aTicks simulation ticks over aBodies bodies and returns nanoseconds per body per tick.
+    template <typename Vector, typename Quat, typename Scalar>
+    double benchmarkTick(const vector<Vector>& someVelocities, const Quat& aSpin, const Vector& aGravity,
+                         Scalar aTimeStep, K_INT aTicks, const Quat& anIdentity) {
+        vector<Vector> positions(someVelocities.size());
+        vector<Vector> velocities(someVelocities);
+        vector<Quat> orientations(someVelocities.size(), anIdentity);
+        vector<Vector> headings(someVelocities.size());
+
+        const high_resolution_clock::time_point start = high_resolution_clock::now();
+        for (K_INT t = 0; t < aTicks; ++t)
+            tick(positions, velocities, orientations, headings, aGravity, aSpin, aTimeStep);
+        const double nanoseconds = static_cast<double>(
+            duration_cast<std::chrono::nanoseconds>(high_resolution_clock::now() - start).count());
+
+        // Keep the results observable so the loop is not optimized away.
+        volatile KUI_8 sink = 0;
+        for (size_t i = 0; i < headings.size(); ++i)
+            sink = sink ^ reinterpret_cast<const KUI_8*>(&headings[i])[0] ^ reinterpret_cast<const KUI_8*>(&orientations[i])[0];
+        return nanoseconds / (static_cast<double>(aTicks) * someVelocities.size());
+    }
+}
+
+// Checks the fixed-point scalar functions against double precision and benchmarks a
+// simulation tick in float, Q16.16 and Q32.32. Returns the number of failed checks.
+int TestFixedPoint() {
+    K_INT failures = 0;
+    failures += checkScalarAccuracy<Fixed16>("Fixed16", 1.0 / 65536.0);
+    failures += checkScalarAccuracy<Fixed32>("Fixed32", 1e-8);
+
+    // Slerp must stay unit length and hit both ends.
+    const FixedQuaternion<Fixed32> from = FixedQuaternion<Fixed32>::Identity();
+    const FixedQuaternion<Fixed32> to = FixedQuaternion<Fixed32>::AxisAngle(
+        FixedVector3<Fixed32>(Fixed32(), Fixed32(1), Fixed32()), Fixed32::FromDouble(2.0));
+    double slerpError = 0.0;
+    for (K_INT i = 0; i <= 16; ++i) {
+        const FixedQuaternion<Fixed32> q = FixedQuaternion<Fixed32>::Slerp(from, to, Fixed32(i) / Fixed32(16));
+        slerpError = max(slerpError, fabs(q.getMagnitude().toDouble() - 1.0));
+        slerpError = max(slerpError, fabs(q.y.toDouble() - sin(i / 16.0)));
+    }
+    failures += ReportBound("FixedQuaternion Slerp", slerpError, 1e-6);
+
+    // q to q and q to -q are both the same rotation throughout, and sin(theta) is zero for
+    // the opposite pair. A negated end still takes the shorter arc.
+    const FixedQuaternion<Fixed16> start = FixedQuaternion<Fixed16>::AxisAngle(
+        FixedVector3<Fixed16>(Fixed16(), Fixed16(), Fixed16(1)), Fixed16::FromDouble(0.5));
+    const FixedQuaternion<Fixed16> opposite = start * -Fixed16::One();
+    double sameError = 0.0;
+    double arcError = 0.0;
+    for (K_INT i = 0; i <= 16; ++i) {
+        const Fixed16 beta = Fixed16(i) / Fixed16(16);
+        sameError = max(sameError, quaternionDistance(FixedQuaternion<Fixed16>::Slerp(start, start, beta), start));
+        sameError = max(sameError, quaternionDistance(FixedQuaternion<Fixed16>::Slerp(start, opposite, beta), start));
+        arcError = max(arcError, quaternionDistance(FixedQuaternion<Fixed32>::Slerp(from, to * -Fixed32::One(), Fixed32(i) / Fixed32(16)),
+                                                    FixedQuaternion<Fixed32>::Slerp(from, to, Fixed32(i) / Fixed32(16))));
+    }
+    failures += ReportBound("FixedQuaternion Slerp q to q and q to -q", sameError, 1e-4);
+    failures += ReportBound("FixedQuaternion Slerp shorter arc", arcError, 1e-6);
+
+    // Renormalizing after every spin keeps rotations at unit length without Sqrt.
+    const Quaternion step(0.0f, 0.0998334f, 0.0f, 0.9950042f);
+    failures += ReportBound("Fixed16 renormalized spin", renormalizedDrift(FixedQuaternion<Fixed16>::FromQuaternion(step), 10000),
+                            8.0 / 65536.0);
+    failures += ReportBound("Fixed32 renormalized spin", renormalizedDrift(FixedQuaternion<Fixed32>::FromQuaternion(step), 10000),
+                            1e-8);
+
+    // Benchmark. Velocities stay small so Fixed16 squared magnitudes do not overflow.
+    const size_t bodyCount = 4096;
+    const K_INT ticks = 200;
+    mt19937 generator(42);
+    uniform_real_distribution<float> speed(-4.0f, 4.0f);
+    vector<Vector3f> floatVelocities(bodyCount);
+    vector<FixedVector3<Fixed16>> velocities16(bodyCount);
+    vector<FixedVector3<Fixed32>> velocities32(bodyCount);
+    for (size_t i = 0; i < bodyCount; ++i) {
+        floatVelocities[i] = Vector3f(speed(generator), speed(generator) + 10.0f, speed(generator));
+        velocities16[i] = FixedVector3<Fixed16>::FromVector3f(floatVelocities[i]);
+        velocities32[i] = FixedVector3<Fixed32>::FromVector3f(floatVelocities[i]);
+    }
+
+    const Quaternion spin(0.0f, 0.0998334f, 0.0f, 0.9950042f);
+    const Vector3f gravity(0.0f, -9.81f, 0.0f);
+    const float timeStep = 1.0f / 60.0f;
+
+    const double floatTime = benchmarkTick(floatVelocities, spin, gravity, timeStep, ticks, Quaternion(0.0f, 0.0f, 0.0f, 1.0f));
+    const double fixed16Time = benchmarkTick(velocities16, FixedQuaternion<Fixed16>::FromQuaternion(spin),
+                                             FixedVector3<Fixed16>::FromVector3f(gravity), Fixed16::FromFloat(timeStep),
+                                             ticks, FixedQuaternion<Fixed16>::Identity());
+    const double fixed32Time = benchmarkTick(velocities32, FixedQuaternion<Fixed32>::FromQuaternion(spin),
+                                             FixedVector3<Fixed32>::FromVector3f(gravity), Fixed32::FromFloat(timeStep),
+                                             ticks, FixedQuaternion<Fixed32>::Identity());
+
+    cout << "Simulation tick, ns per body: float " << floatTime
+         << ", Fixed16 " << fixed16Time << " (" << fixed16Time / floatTime << "x)"
+         << ", Fixed32 " << fixed32Time << " (" << fixed32Time / floatTime << "x)" << endl;
+
+    return failures;
+}
\ No newline at end of file
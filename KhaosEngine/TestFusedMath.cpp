@@ -0,0 +1,148 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "KhaosMath.h"
+#include "TestUtilities.h"
+
+using namespace std;
+using namespace std::chrono;
+using namespace KhaosMath;
+using namespace KhaosTesting;
+
+// Compile-time checks for the fused operations and the operator signatures they rely on.
+namespace FusedMathTests
+{
+    static_assert(is_trivially_copyable<Vector2f>::value && is_trivially_copyable<Vector3f>::value &&
+                  is_trivially_copyable<Vector4f>::value && is_trivially_copyable<Quaternion>::value,
+                  "Math types must be trivially copyable so they pass in registers.");
+    static_assert(is_same<decltype(declval<Vector3f&>() += declval<Vector3f>()), Vector3f&>::value &&
+                  is_same<decltype(declval<Vector4f&>() *= 2.0f), Vector4f&>::value &&
+                  is_same<decltype(declval<Quaternion&>() += declval<Quaternion>()), Quaternion&>::value &&
+                  is_same<decltype(declval<Matrix4x4f&>() -= declval<Matrix4x4f>()), Matrix4x4f&>::value,
+                  "Compound operators must return a reference, not a copy.");
+
+    static_assert(Vector3f::MultiplyAdd(Vector3f(1.0f, 2.0f, 3.0f), 2.0f, Vector3f(1.0f, 1.0f, 1.0f)) == Vector3f(3.0f, 5.0f, 7.0f),
+                  "MultiplyAdd must scale then add.");
+    static_assert(Vector2f::WeightedSum(Vector2f(4.0f, 8.0f), 0.25f, Vector2f(8.0f, 4.0f), 0.5f) == Vector2f(5.0f, 4.0f),
+                  "WeightedSum must weight both operands.");
+    static_assert(Vector3f(1.0f, 2.0f, 3.0f).addScaled(Vector3f(1.0f, 0.0f, -1.0f), 2.0f) == Vector3f(3.0f, 2.0f, 1.0f),
+                  "addScaled must be constexpr.");
+    static_assert(Quaternion(0.0f, 0.0f, 1.0f, 0.0f) * Quaternion(0.0f, 0.0f, 1.0f, 0.0f) == Quaternion(0.0f, 0.0f, 0.0f, -1.0f),
+                  "Two half turns must give the negated identity.");
+}
+
+namespace
+{
+    // The Grassman product as Quaternion::operator* used to compute it, through Vector3f temporaries.
+    Quaternion productThroughVectors(const Quaternion& aQuat, const Quaternion& bQuat) {
+        const Vector3f vectorA = aQuat.getVectorPart();
+        const Vector3f vectorB = bQuat.getVectorPart();
+        const Vector3f vectorPart = (vectorB * aQuat.w) + vectorA * bQuat.w + vectorA.crossProduct(vectorB);
+        return Quaternion(vectorPart, aQuat.w * bQuat.w - vectorA.dot(vectorB));
+    }
+
+    // Returns nanoseconds per element of aKernel applied aPasses times.
+    template <typename Kernel>
+    double timeKernel(size_t aCount, K_INT aPasses, Kernel aKernel) {
+        const high_resolution_clock::time_point start = high_resolution_clock::now();
+        for (K_INT pass = 0; pass < aPasses; ++pass)
+            aKernel(pass);
+        const double nanoseconds = static_cast<double>(
+            duration_cast<std::chrono::nanoseconds>(high_resolution_clock::now() - start).count());
+        return nanoseconds / (static_cast<double>(aPasses) * aCount);
+    }
+
+    void reportSpeed(const char* aName, double anOperatorTime, double aFusedTime) {
+        cout << aName << ", ns per element: operators " << anOperatorTime << ", fused " << aFusedTime
+             << " (" << anOperatorTime / aFusedTime << "x)" << endl;
+    }
+}
+
+// Checks the fused operations against the operator chains they replace and benchmarks both.
+// Build with /FAs (or -S) to compare the generated loops directly; in optimized builds the
+// fused forms compile to one load, multiply-add and store per component with no spills.
+// Returns the number of failed checks.
+int TestFusedMath() {
+    K_INT failures = 0;
+
+    const size_t count = 4096;
+    const K_INT passes = 500;
+    mt19937 generator(7);
+    uniform_real_distribution<float> value(-10.0f, 10.0f);
+    vector<Vector3f> from(count);
+    vector<Vector3f> to(count);
+    vector<Quaternion> rotations(count);
+    for (size_t i = 0; i < count; ++i) {
+        from[i] = Vector3f(value(generator), value(generator), value(generator));
+        to[i] = Vector3f(value(generator), value(generator), value(generator));
+        rotations[i] = Quaternion(value(generator), value(generator), value(generator), value(generator));
+        rotations[i] *= 1.0f / rotations[i].getMagnitude();
+    }
+
+    // Results must match the operator chains.
+    double lerpError = 0.0;
+    double productError = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        const float beta = static_cast<float>(i) / count;
+        const Vector3f chained = (from[i] * (1.0f - beta)) + (to[i] * beta);
+        lerpError = max(lerpError, static_cast<double>((Vector3f::LerpNoClamp(from[i], to[i], beta) - chained).getMagnitude()));
+
+        const Quaternion& next = rotations[(i + 1) % count];
+        const Quaternion difference = rotations[i] * next + productThroughVectors(rotations[i], next) * -1.0f;
+        productError = max(productError, static_cast<double>(difference.getMagnitude()));
+    }
+    failures += ReportBound("Vector3f Lerp", lerpError, 1e-5);
+    failures += ReportBound("Quaternion product", productError, 1e-6);
+
+    // Lerp: operator chain against WeightedSum.
+    vector<Vector3f> blended(count);
+    const double lerpOperators = timeKernel(count, passes, [&](K_INT aPass) {
+        const float beta = (aPass & 63) / 64.0f;
+        for (size_t i = 0; i < count; ++i)
+            blended[i] = (from[i] * (1.0f - beta)) + (to[i] * beta);
+    });
+    const double lerpFused = timeKernel(count, passes, [&](K_INT aPass) {
+        const float beta = (aPass & 63) / 64.0f;
+        for (size_t i = 0; i < count; ++i)
+            blended[i] = Vector3f::WeightedSum(from[i], 1.0f - beta, to[i], beta);
+    });
+    reportSpeed("Vector3f lerp", lerpOperators, lerpFused);
+
+    // Integration: p = p + v * dt against addScaled.
+    vector<Vector3f> positions(from);
+    const double integrateOperators = timeKernel(count, passes, [&](K_INT) {
+        for (size_t i = 0; i < count; ++i)
+            positions[i] = positions[i] + to[i] * (1.0f / 60.0f);
+    });
+    const double integrateFused = timeKernel(count, passes, [&](K_INT) {
+        for (size_t i = 0; i < count; ++i)
+            positions[i].addScaled(to[i], 1.0f / 60.0f);
+    });
+    reportSpeed("Vector3f integrate", integrateOperators, integrateFused);
+
+    // Quaternion product: vector temporaries against the per component operator.
+    vector<Quaternion> products(count);
+    const double productOperators = timeKernel(count, passes, [&](K_INT aPass) {
+        const Quaternion& spin = rotations[aPass % count];
+        for (size_t i = 0; i < count; ++i)
+            products[i] = productThroughVectors(rotations[i], spin);
+    });
+    const double productFused = timeKernel(count, passes, [&](K_INT aPass) {
+        const Quaternion& spin = rotations[aPass % count];
+        for (size_t i = 0; i < count; ++i)
+            products[i] = rotations[i] * spin;
+    });
+    reportSpeed("Quaternion product", productOperators, productFused);
+
+    // Keep the results observable so the loops are not optimized away.
+    volatile float sink = 0.0f;
+    for (size_t i = 0; i < count; ++i)
+        sink = sink + blended[i].x + positions[i].y + products[i].w;
+
+    return failures;
+}
\ No newline at end of file
@@ -0,0 +1,165 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "KhaosMath.h"
+#include "GameLoop.h"
+#include "TestUtilities.h"
+
+using namespace std;
+using namespace std::chrono;
+using namespace KhaosMath;
+using namespace KhaosEngine;
+using namespace KhaosTesting;
+
+namespace
+{
+    const float SPEED = 10.0f; // Units per second along x.
+    const float SPIN = 2.0f;   // Radians per second about z.
+
+    // Rotation by anAngle radians about z.
+    Quaternion turnAboutZ(float anAngle) {
+        return Quaternion(0.0f, 0.0f, sinf(0.5f * anAngle), cosf(0.5f * anAngle));
+    }
+
+    // Angle between two rotations in radians, whatever the signs of the quaternions.
+    double rotationAngle(const Quaternion& aQuat, const Quaternion& bQuat) {
+        const Quaternion difference = aQuat + bQuat * (aQuat.dot(bQuat) < 0.0f ? 1.0f : -1.0f);
+        return 4.0 * asin(min(1.0, 0.5 * difference.getMagnitude()));
+    }
+
+    // One object that moves and spins at a constant rate, so every rendered state can be
+    // checked against the step it came from. Rendering is slow on some frames, so the loop has
+    // to catch up with several steps, and the client stops the loop after a set frame count.
+    class FakeClient : public GameLoopClient
+    {
+    public:
+        FakeClient(GameLoop& aLoop, float aTimeStep, K_UINT aFrameCount)
+            : mLoop(aLoop), mTimeStep(aTimeStep), mFrameCount(aFrameCount),
+              mRenderThread(this_thread::get_id()), mSteps(0), mWrongTimeSteps(0), mSimulatedOnRenderThread(0),
+              mRenderedFrames(0), mLastStep(0), mWrongStates(0), mMaxStepsBetweenFrames(0) { }
+
+        // Simulation thread.
+        void simulate(float aTimeStep) override {
+            mWrongTimeSteps += aTimeStep != mTimeStep;
+            mSimulatedOnRenderThread += this_thread::get_id() == mRenderThread;
+            ++mSteps;
+        }
+
+        // Simulation thread.
+        void capture(FrameState& aState) override {
+            const float time = mSteps * mTimeStep;
+            aState.positions.assign(1, Vector3f(SPEED * time, 0.0f, 0.0f));
+            // Flip the sign every step, so interpolation has to take the shorter arc.
+            aState.rotations.assign(1, turnAboutZ(SPIN * time) * (mSteps % 2 ? -1.0f : 1.0f));
+        }
+
+        // Rendering thread. The state is a blend of two consecutive steps, so its position
+        // gives a fractional step that the rotation must agree with.
+        void render(const FrameState& aState) override {
+            if (mRenderedFrames >= mFrameCount)
+                return; // Published before stop took effect.
+            const double step = aState.positions[0].x / (SPEED * mTimeStep);
+            const bool between = aState.step == 0 ? step == 0.0 : step >= aState.step - 1 - 1e-3 && step <= aState.step + 1e-3;
+            const double angleError = rotationAngle(aState.rotations[0], turnAboutZ(static_cast<float>(SPIN * mTimeStep * step)));
+            mWrongStates += !between || angleError > 1e-3 || aState.step < mLastStep;
+            mMaxStepsBetweenFrames = max(mMaxStepsBetweenFrames, aState.step - mLastStep);
+            mLastStep = aState.step;
+
+            this_thread::sleep_for(milliseconds(mRenderedFrames % 10 == 0 ? 20 : 2));
+            if (++mRenderedFrames == mFrameCount)
+                mLoop.stop();
+        }
+
+        // Results, read after GameLoop::run returns.
+        K_UINT getRenderedFrames() const { return mRenderedFrames; }
+        K_UINT getWrongStates() const { return mWrongStates; }
+        K_UINT getWrongTimeSteps() const { return mWrongTimeSteps; }
+        K_UINT getSimulatedOnRenderThread() const { return mSimulatedOnRenderThread; }
+        KUI_64 getSteps() const { return mSteps; }
+        KUI_64 getMaxStepsBetweenFrames() const { return mMaxStepsBetweenFrames; }
+
+    private:
+        GameLoop& mLoop;
+        float mTimeStep;
+        K_UINT mFrameCount;
+        thread::id mRenderThread;
+
+        // Simulation thread state.
+        KUI_64 mSteps;
+        K_UINT mWrongTimeSteps;
+        K_UINT mSimulatedOnRenderThread;
+
+        // Rendering thread state.
+        K_UINT mRenderedFrames;
+        KUI_64 mLastStep;
+        K_UINT mWrongStates;
+        KUI_64 mMaxStepsBetweenFrames;
+    };
+}
+
+int TestGameLoop() {
+    K_INT failures = 0;
+
+    // Interpolation lerps positions and takes the shorter arc between rotations, whatever
+    // the sign of the current quaternion.
+    {
+        FrameState previous;
+        FrameState current;
+        previous.positions.push_back(Vector3f(0.0f, 2.0f, -4.0f));
+        current.positions.push_back(Vector3f(8.0f, 2.0f, 4.0f));
+        previous.rotations.push_back(turnAboutZ(0.0f));
+        current.rotations.push_back(turnAboutZ(PI / 2.0f) * -1.0f);
+        previous.rotations.push_back(turnAboutZ(-PI / 4.0f));
+        current.rotations.push_back(turnAboutZ(PI / 4.0f));
+        previous.step = 6;
+        current.step = 7;
+
+        const float alphas[3] = { 0.0f, 0.5f, 1.0f };
+        double positionError = 0.0;
+        double angleError = 0.0;
+        FrameState blended;
+        for (K_INT i = 0; i < 3; ++i) {
+            InterpolateFrameStates(previous, current, alphas[i], blended);
+            const Vector3f expected = previous.positions[0] * (1.0f - alphas[i]) + current.positions[0] * alphas[i];
+            positionError = max(positionError, static_cast<double>((blended.positions[0] - expected).getMagnitude()));
+            angleError = max(angleError, rotationAngle(blended.rotations[0], turnAboutZ(alphas[i] * PI / 2.0f)));
+            angleError = max(angleError, rotationAngle(blended.rotations[1], turnAboutZ((alphas[i] - 0.5f) * PI / 2.0f)));
+        }
+        failures += ReportBound("Interpolated positions at 0, 0.5, 1", positionError, 1e-6);
+        failures += ReportBound("Interpolated rotations take the shorter arc", angleError, 1e-5);
+        failures += ReportCheck("Interpolated state keeps the current step",
+                                blended.step == current.step && blended.positions.size() == 1 && blended.rotations.size() == 2);
+    }
+
+    // A headless loop runs until the client stops it.
+    {
+        const float timeStep = 1.0f / 240.0f;
+        const K_UINT maxStepsPerFrame = 3;
+        const K_UINT frameCount = 100;
+        GameLoopSettings settings;
+        settings.timeStep = timeStep;
+        settings.maxStepsPerFrame = maxStepsPerFrame;
+        GameLoop loop(settings);
+        FakeClient client(loop, timeStep, frameCount);
+
+        const high_resolution_clock::time_point start = high_resolution_clock::now();
+        loop.run(client);
+        const double seconds = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+
+        failures += ReportCheck("Loop stops after the client's frame count",
+                                client.getRenderedFrames() == frameCount && !loop.isRunning());
+        failures += ReportCount("Rendered states blend consecutive steps", client.getWrongStates());
+        failures += ReportCount("Steps use the fixed time step", client.getWrongTimeSteps());
+        failures += ReportCount("Simulation runs off the rendering thread", client.getSimulatedOnRenderThread());
+        // Slow frames last longer than the cap's worth of steps, so the cap is reached but not passed.
+        failures += ReportCheck("Catching up is capped per frame", client.getMaxStepsBetweenFrames() == maxStepsPerFrame);
+        cout << "GameLoop: " << frameCount << " frames, " << client.getSteps() << " steps in " << seconds * 1000.0
+             << " ms, at most " << client.getMaxStepsBetweenFrames() << " steps between frames" << endl;
+    }
+
+    return failures;
+}
\ No newline at end of file
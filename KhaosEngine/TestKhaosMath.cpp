@@ -7,6 +7,55 @@ using namespace std;
 using namespace std::chrono;
 using namespace KhaosMath;
 
+// Compile-time checks that the scalar KhaosMath paths are constexpr evaluable.
+namespace ConstexprMathTests
+{
+    constexpr Matrix4x4f kIdentity = Matrix4x4f::Identity();
+
+    constexpr Matrix4x4f kA(1.0f, 2.0f, 3.0f, 4.0f,
+                            5.0f, 6.0f, 7.0f, 8.0f,
+                            9.0f, 10.0f, 11.0f, 12.0f,
+                            13.0f, 14.0f, 15.0f, 16.0f);
+
+    constexpr Matrix4x4f kB(17.0f, 18.0f, 19.0f, 20.0f,
+                            21.0f, 22.0f, 23.0f, 24.0f,
+                            25.0f, 26.0f, 27.0f, 28.0f,
+                            29.0f, 30.0f, 31.0f, 32.0f);
+
+    constexpr Matrix4x4f kAB = kA * kB;
+
+    static_assert(Matrix4x4f() == kIdentity - kIdentity, "Default matrix must be zero.");
+    static_assert(kIdentity * kA == kA && kA * kIdentity == kA, "Identity must be neutral.");
+    static_assert(kA.getTranspose().getTranspose() == kA, "Transpose must be an involution.");
+    static_assert(kA.getTranspose()(0, 3) == 13.0f, "Transpose must swap rows and columns.");
+    static_assert(kAB(0, 0) == 250.0f && kAB(3, 3) == 1528.0f, "Matrix product must be row by column.");
+
+    static_assert(Vector3f(1.0f, 0.0f, 0.0f).crossProduct(Vector3f(0.0f, 1.0f, 0.0f)) == Vector3f(0.0f, 0.0f, 1.0f),
+                  "X cross Y must be Z.");
+    static_assert(Vector3f::Lerp(Vector3f(), Vector3f(2.0f, 4.0f, 8.0f), 0.5f) == Vector3f(1.0f, 2.0f, 4.0f),
+                  "Lerp must be constexpr.");
+    static_assert(Vector2f(3.0f, 4.0f).getMagnitudeSquared() == 25.0f, "Vector2f must be constexpr.");
+    static_assert((Vector4f(1.0f, 2.0f, 3.0f, 4.0f) * kIdentity) == Vector4f(1.0f, 2.0f, 3.0f, 4.0f),
+                  "Vector-matrix product must be constexpr.");
+    static_assert(Quaternion(0.0f, 0.0f, 0.0f, 1.0f) * Quaternion(1.0f, 2.0f, 3.0f, 4.0f) == Quaternion(1.0f, 2.0f, 3.0f, 4.0f),
+                  "Identity quaternion must be neutral.");
+
+    constexpr Vector3f kTranslation(1.0f, 2.0f, 3.0f);
+    constexpr Vector3f kScale(2.0f, 4.0f, 8.0f);
+    constexpr Quaternion kHalfTurnZ(0.0f, 0.0f, 1.0f, 0.0f);
+    static_assert(Matrix4x4f::TRS(kTranslation, kHalfTurnZ, kScale) ==
+                  Matrix4x4f::Scale(kScale) * Matrix4x4f::Rotation(kHalfTurnZ) * Matrix4x4f::Translation(kTranslation),
+                  "TRS must match the product of its factors.");
+    static_assert(Matrix4x4f::Rotation(Quaternion(0.0f, 0.0f, 0.0f, 1.0f)) == kIdentity,
+                  "Identity quaternion must give the identity matrix.");
+    static_assert((Vector4f(1.0f, 0.0f, 0.0f, 1.0f) * Matrix4x4f::Rotation(kHalfTurnZ)) == Vector4f(-1.0f, 0.0f, 0.0f, 1.0f),
+                  "Half turn about z must negate x.");
+
+    constexpr TrigTable<256> kTrig;
+    static_assert(kTrig.sine[0] == 0.0f && kTrig.cosine[0] == 1.0f, "Trig table must start at zero radians.");
+    static_assert(kTrig.sine[64] > 0.99999f && kTrig.cosine[128] < -0.99999f, "Trig table must cover a full turn.");
+}
+
 void printVector(const Vector3f& aVector) {
     cout << "{ " << aVector.x << ", " << aVector.y << ", " << aVector.z << " }" << endl;
 }
@@ -0,0 +1,1083 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "KhaosMath.h"
+#include "CompressedTransform.h"
+#include "CpuFeatures.h"
+#include "LargeWorld.h"
+#include "Spline.h"
+#include "TestUtilities.h"
+
+using namespace std;
+using namespace std::chrono;
+using namespace KhaosMath;
+using namespace KhaosTesting;
+
+namespace
+{
+    const size_t COUNT = 4096;
+    const K_INT PASSES = 100;
+    const double PI_DOUBLE = 3.14159265358979323846;
+
+    struct IsaLevel
+    {
+        const char* name;
+        CpuFeatures mask;
+    };
+
+    // Kernels that dispatch on CpuFeatures run once per level the CPU supports. The avx level
+    // keeps every detected feature, so it also covers F16C and AVX2 where present.
+    const IsaLevel ISA_LEVELS[] = {
+        { "avx", { true, true, true, true, true, true } },
+        { "sse2", { true, false, false, false, false, false } }
+    };
+
+    bool isSupported(const IsaLevel& aLevel) {
+        const CpuFeatures& detected = CpuFeatures::Detected();
+        return (detected.sse2 || !aLevel.mask.sse2) && (detected.avx || !aLevel.mask.avx);
+    }
+
+    // Spacing of floats at aScale. Below the normal range this is the denormal spacing.
+    double floatUlp(double aScale) {
+        if (aScale < FLT_MIN)
+            return ldexp(1.0, -149);
+        int exponent;
+        frexp(aScale, &exponent);
+        return ldexp(1.0, exponent - 24);
+    }
+
+    // Spacing of doubles at aScale.
+    double doubleUlp(double aScale) {
+        if (aScale < DBL_MIN)
+            return ldexp(1.0, -1074);
+        int exponent;
+        frexp(aScale, &exponent);
+        return ldexp(1.0, exponent - 53);
+    }
+
+    // Largest error of a kernel against its double precision reference.
+    //
+    // Each output is measured against a scale: the result itself for conversions, and the sum
+    // of the absolute terms for products and sums, so that cancellation in the exact result
+    // is not blamed on the kernel. Ulps are output spacings at that scale.
+    struct ErrorStats
+    {
+        double maxUlps;
+        double maxRelative;
+
+        ErrorStats()
+            : maxUlps(0.0), maxRelative(0.0) { }
+
+        void add(double aValue, double aReference, double aScale, double anUlp) {
+            double error = 0.0;
+            if (std::isnan(aValue) || std::isnan(aReference))
+                error = std::isnan(aValue) && std::isnan(aReference) ? 0.0 : HUGE_VAL;
+            else if (aValue != aReference)
+                error = fabs(aValue - aReference);
+            maxUlps = max(maxUlps, error / anUlp);
+            maxRelative = max(maxRelative, error / max(aScale, static_cast<double>(FLT_MIN)));
+        }
+
+        void addFloat(float aValue, double aReference, double aScale) {
+            add(aValue, aReference, aScale, floatUlp(aScale));
+        }
+
+        void addDouble(double aValue, double aReference, double aScale) {
+            add(aValue, aReference, aScale, doubleUlp(aScale));
+        }
+    };
+
+    // Random inputs. With edge cases on, half of the values are the ones that break kernels:
+    // signed zeros, denormals, values just above the normal range and values near the largest
+    // magnitude a kernel can take without overflowing. The rest, and every value with edge
+    // cases off, are spread over forty binary orders of magnitude below that largest one.
+    class EdgeCaseGenerator
+    {
+    public:
+        EdgeCaseGenerator(KUI_32 aSeed, bool anEdgeCases)
+            : mGenerator(aSeed), mEdgeCases(anEdgeCases) { }
+
+        float value(float aLargest) {
+            const float sign = (mGenerator() & 1) ? -1.0f : 1.0f;
+            switch (mEdgeCases ? mGenerator() % 8 : 7) {
+            case 0:
+                return sign * 0.0f;
+            case 1: {
+                const KUI_32 bits = 1 + mGenerator() % 0x7fffff;
+                float denormal;
+                memcpy(&denormal, &bits, sizeof(denormal));
+                return sign * denormal;
+            }
+            case 2:
+                return sign * ldexpf(mantissa(), -126 + static_cast<K_INT>(mGenerator() % 64));
+            case 3:
+                return sign * aLargest * (0.5f + 0.5f * uniform());
+            default:
+                return sign * aLargest * ldexpf(mantissa(), -41 + static_cast<K_INT>(mGenerator() % 40));
+            }
+        }
+
+        bool hasEdgeCases() const {
+            return mEdgeCases;
+        }
+
+        // Returns a value in [0, 1).
+        float uniform() {
+            return static_cast<float>(mGenerator() >> 8) * (1.0f / 16777216.0f);
+        }
+
+        // Returns a unit rotation, uniformly distributed.
+        Quaternion rotation() {
+            normal_distribution<double> normal;
+            return normalized(normal(mGenerator), normal(mGenerator), normal(mGenerator), normal(mGenerator));
+        }
+
+        // Returns aRotation turned further by anAngle about a random axis.
+        Quaternion turned(const Quaternion& aRotation, double anAngle) {
+            const Quaternion axis = rotation();
+            const double axisLength = sqrt(static_cast<double>(axis.x) * axis.x + axis.y * axis.y + axis.z * axis.z);
+            const double s = sin(0.5 * anAngle) / axisLength;
+            const Quaternion turn(static_cast<float>(axis.x * s), static_cast<float>(axis.y * s),
+                                  static_cast<float>(axis.z * s), static_cast<float>(cos(0.5 * anAngle)));
+            const Quaternion result = aRotation * turn;
+            return normalized(result.x, result.y, result.z, result.w);
+        }
+
+        KUI_32 next() {
+            return mGenerator();
+        }
+
+    private:
+        float mantissa() {
+            return 1.0f + uniform();
+        }
+
+        static Quaternion normalized(double aX, double aY, double aZ, double aW) {
+            const double inverse = 1.0 / sqrt(aX * aX + aY * aY + aZ * aZ + aW * aW);
+            return Quaternion(static_cast<float>(aX * inverse), static_cast<float>(aY * inverse),
+                              static_cast<float>(aZ * inverse), static_cast<float>(aW * inverse));
+        }
+
+        mt19937 mGenerator;
+        bool mEdgeCases;
+    };
+
+    // Returns nanoseconds per element of aKernel applied PASSES times.
+    template <typename Kernel>
+    double timeKernel(size_t aCount, Kernel aKernel) {
+        const high_resolution_clock::time_point start = high_resolution_clock::now();
+        for (K_INT pass = 0; pass < PASSES; ++pass)
+            aKernel();
+        const double nanoseconds = static_cast<double>(
+            duration_cast<std::chrono::nanoseconds>(high_resolution_clock::now() - start).count());
+        return nanoseconds / (static_cast<double>(PASSES) * aCount);
+    }
+
+    struct KernelTimes
+    {
+        double kernel;
+        double reference;
+    };
+
+    // Times aKernel and aReference on typical inputs from aFill, since denormals would stall
+    // the float kernel and not the double reference. Then refills the same inputs with edge
+    // cases and runs both once more, leaving the outputs to be compared.
+    template <typename Fill, typename Kernel, typename Reference>
+    KernelTimes runKernel(KUI_32 aSeed, size_t aCount, Fill aFill, Kernel aKernel, Reference aReference) {
+        KernelTimes times;
+        EdgeCaseGenerator typical(aSeed, false);
+        aFill(typical);
+        times.kernel = timeKernel(aCount, aKernel);
+        times.reference = timeKernel(aCount, aReference);
+
+        EdgeCaseGenerator edgeCases(aSeed, true);
+        aFill(edgeCases);
+        aKernel();
+        aReference();
+        return times;
+    }
+
+    K_INT reportKernel(const char* aKernel, const char* anIsa, const ErrorStats& someErrors, double aBound,
+                       const KernelTimes& someTimes) {
+        const bool passed = someErrors.maxUlps <= aBound;
+        cout << (passed ? "PASS " : "FAIL ") << aKernel << " [" << anIsa << "]: max " << someErrors.maxUlps
+             << " ulps, relative " << someErrors.maxRelative << " (bound " << aBound << " ulps); "
+             << someTimes.kernel << " ns against " << someTimes.reference << " ns for the reference ("
+             << someTimes.reference / someTimes.kernel << "x)" << endl;
+        return passed ? 0 : 1;
+    }
+
+    //
+    // Regressions.
+    //
+
+    // Directed checks for the bugs that slipped through the scalar paths before: the w * (3, 3)
+    // term of the vector-matrix product, the lane order of the __m128 conversions and swapped
+    // slerp weights.
+    K_INT testKnownBugs() {
+        K_INT failures = 0;
+
+        Matrix4x4f matrix;
+        for (K_INT row = 0; row < 4; ++row)
+            for (K_INT col = 0; col < 4; ++col)
+                matrix(row, col) = static_cast<float>(row * 4 + col + 1);
+        const Vector4f product = Vector4f(0.0f, 0.0f, 0.0f, 1.0f) * matrix;
+        failures += ReportCheck("Vector4f * Matrix4x4f w term", product.w == matrix(3, 3));
+
+        __declspec(align(16)) float vectorLanes[4];
+        __declspec(align(16)) float quaternionLanes[4];
+        _mm_store_ps(vectorLanes, Vector4f(1.0f, 2.0f, 3.0f, 4.0f));
+        _mm_store_ps(quaternionLanes, Quaternion(1.0f, 2.0f, 3.0f, 4.0f));
+        K_INT laneMismatches = 0;
+        for (K_INT lane = 0; lane < 4; ++lane) {
+            laneMismatches += vectorLanes[lane] != static_cast<float>(lane + 1);
+            laneMismatches += quaternionLanes[lane] != static_cast<float>(lane + 1);
+        }
+        failures += ReportCount("__m128 lane order", laneMismatches);
+
+        // A quarter of the way from identity to a quarter turn is an eighth of a half turn.
+        const float halfQuarter = static_cast<float>(0.25 * PI_DOUBLE);
+        const Quaternion quarterTurn(0.0f, 0.0f, sinf(halfQuarter), cosf(halfQuarter));
+        const Quaternion slerped = Quaternion::Slerp(Quaternion(0.0f, 0.0f, 0.0f, 1.0f), quarterTurn, 0.25f);
+        const double slerpError = max(fabs(slerped.z - sin(0.0625 * PI_DOUBLE)), fabs(slerped.w - cos(0.0625 * PI_DOUBLE)));
+        failures += ReportBound("Slerp weights", slerpError, 1e-6);
+        return failures;
+    }
+
+    //
+    // Scalar operators. Inputs reach 1e18 so that sums of four products stay finite.
+    //
+
+    K_INT testVectorMatrix() {
+        vector<Vector4f> vectors(COUNT);
+        vector<Matrix4x4f> matrices(COUNT);
+        vector<Vector4f> results(COUNT);
+        vector<double> reference(COUNT * 4);
+        vector<double> scales(COUNT * 4);
+
+        const KernelTimes times = runKernel(1, COUNT, [&](EdgeCaseGenerator& aGenerator) {
+            for (size_t i = 0; i < COUNT; ++i) {
+                for (K_INT component = 0; component < 4; ++component)
+                    (&vectors[i].x)[component] = aGenerator.value(1e18f);
+                for (K_INT element = 0; element < 16; ++element)
+                    matrices[i](element / 4, element % 4) = aGenerator.value(1e18f);
+            }
+        }, [&]() {
+            for (size_t i = 0; i < COUNT; ++i)
+                results[i] = vectors[i] * matrices[i];
+        }, [&]() {
+            for (size_t i = 0; i < COUNT; ++i) {
+                const float* vector = &vectors[i].x;
+                for (K_INT col = 0; col < 4; ++col) {
+                    double sum = 0.0;
+                    double scale = 0.0;
+                    for (K_INT row = 0; row < 4; ++row) {
+                        const double term = static_cast<double>(vector[row]) * matrices[i](row, col);
+                        sum += term;
+                        scale += fabs(term);
+                    }
+                    reference[i * 4 + col] = sum;
+                    scales[i * 4 + col] = scale;
+                }
+            }
+        });
+
+        ErrorStats errors;
+        for (size_t i = 0; i < COUNT; ++i)
+            for (K_INT col = 0; col < 4; ++col)
+                errors.addFloat((&results[i].x)[col], reference[i * 4 + col], scales[i * 4 + col]);
+        return reportKernel("Vector4f * Matrix4x4f", "scalar", errors, 4.0, times);
+    }
+
+    K_INT testMatrixProduct() {
+        vector<Matrix4x4f> first(COUNT);
+        vector<Matrix4x4f> second(COUNT);
+        vector<Matrix4x4f> results(COUNT);
+        vector<double> reference(COUNT * 16);
+        vector<double> scales(COUNT * 16);
+
+        const KernelTimes times = runKernel(2, COUNT, [&](EdgeCaseGenerator& aGenerator) {
+            for (size_t i = 0; i < COUNT; ++i) {
+                for (K_INT element = 0; element < 16; ++element) {
+                    first[i](element / 4, element % 4) = aGenerator.value(1e18f);
+                    second[i](element / 4, element % 4) = aGenerator.value(1e18f);
+                }
+            }
+        }, [&]() {
+            for (size_t i = 0; i < COUNT; ++i)
+                results[i] = first[i] * second[i];
+        }, [&]() {
+            for (size_t i = 0; i < COUNT; ++i) {
+                for (K_INT element = 0; element < 16; ++element) {
+                    double sum = 0.0;
+                    double scale = 0.0;
+                    for (K_INT k = 0; k < 4; ++k) {
+                        const double term = static_cast<double>(first[i](element / 4, k)) * second[i](k, element % 4);
+                        sum += term;
+                        scale += fabs(term);
+                    }
+                    reference[i * 16 + element] = sum;
+                    scales[i * 16 + element] = scale;
+                }
+            }
+        });
+
+        ErrorStats errors;
+        for (size_t i = 0; i < COUNT; ++i)
+            for (K_INT element = 0; element < 16; ++element)
+                errors.addFloat(results[i](element / 4, element % 4), reference[i * 16 + element], scales[i * 16 + element]);
+        return reportKernel("Matrix4x4f * Matrix4x4f", "scalar", errors, 4.0, times);
+    }
+
+    K_INT testQuaternionProduct() {
+        // Sign of each product of a component of the first operand (row) and one of the second
+        // (column) in each output component, in the order x, y, z, w.
+        static const K_INT SIGNS[4][4][4] = {
+            { { 0, 0, 0, 1 }, { 0, 0, 1, 0 }, { 0, -1, 0, 0 }, { 1, 0, 0, 0 } },
+            { { 0, 0, -1, 0 }, { 0, 0, 0, 1 }, { 1, 0, 0, 0 }, { 0, 1, 0, 0 } },
+            { { 0, 1, 0, 0 }, { -1, 0, 0, 0 }, { 0, 0, 0, 1 }, { 0, 0, 1, 0 } },
+            { { -1, 0, 0, 0 }, { 0, -1, 0, 0 }, { 0, 0, -1, 0 }, { 0, 0, 0, 1 } }
+        };
+
+        vector<Quaternion> first(COUNT);
+        vector<Quaternion> second(COUNT);
+        vector<Quaternion> results(COUNT);
+        vector<double> reference(COUNT * 4);
+        vector<double> scales(COUNT * 4);
+
+        const KernelTimes times = runKernel(3, COUNT, [&](EdgeCaseGenerator& aGenerator) {
+            for (size_t i = 0; i < COUNT; ++i) {
+                for (K_INT component = 0; component < 4; ++component) {
+                    (&first[i].x)[component] = aGenerator.value(1e18f);
+                    (&second[i].x)[component] = aGenerator.value(1e18f);
+                }
+            }
+        }, [&]() {
+            for (size_t i = 0; i < COUNT; ++i)
+                results[i] = first[i] * second[i];
+        }, [&]() {
+            for (size_t i = 0; i < COUNT; ++i) {
+                const float* a = &first[i].x;
+                const float* b = &second[i].x;
+                for (K_INT component = 0; component < 4; ++component) {
+                    double sum = 0.0;
+                    double scale = 0.0;
+                    for (K_INT row = 0; row < 4; ++row) {
+                        for (K_INT col = 0; col < 4; ++col) {
+                            const double term = SIGNS[component][row][col] * static_cast<double>(a[row]) * b[col];
+                            sum += term;
+                            scale += fabs(term);
+                        }
+                    }
+                    reference[i * 4 + component] = sum;
+                    scales[i * 4 + component] = scale;
+                }
+            }
+        });
+
+        ErrorStats errors;
+        for (size_t i = 0; i < COUNT; ++i)
+            for (K_INT component = 0; component < 4; ++component)
+                errors.addFloat((&results[i].x)[component], reference[i * 4 + component], scales[i * 4 + component]);
+        return reportKernel("Quaternion * Quaternion", "scalar", errors, 4.0, times);
+    }
+
+    // MultiplyAdd rounds twice and WeightedSum three times, so each stays within an ulp or
+    // one and a half of the sum of its absolute terms.
+    template <typename Type>
+    K_INT testFusedSums(KUI_32 aSeed, const char* aTypeName, K_INT aComponentCount) {
+        vector<Type> first(COUNT);
+        vector<Type> second(COUNT);
+        vector<float> firstWeights(COUNT);
+        vector<float> secondWeights(COUNT);
+        vector<Type> results(COUNT);
+        vector<double> reference(COUNT * 4);
+        vector<double> scales(COUNT * 4);
+
+        const auto fill = [&](EdgeCaseGenerator& aGenerator) {
+            for (size_t i = 0; i < COUNT; ++i) {
+                for (K_INT component = 0; component < aComponentCount; ++component) {
+                    (&first[i].x)[component] = aGenerator.value(1e18f);
+                    (&second[i].x)[component] = aGenerator.value(1e18f);
+                }
+                firstWeights[i] = aGenerator.value(1e18f);
+                secondWeights[i] = aGenerator.value(1e18f);
+            }
+        };
+        const auto report = [&](const char* aKernel, double aBound, const KernelTimes& someTimes) {
+            ErrorStats errors;
+            for (size_t i = 0; i < COUNT; ++i)
+                for (K_INT component = 0; component < aComponentCount; ++component)
+                    errors.addFloat((&results[i].x)[component], reference[i * 4 + component], scales[i * 4 + component]);
+            const string name = string(aTypeName) + "::" + aKernel;
+            return reportKernel(name.c_str(), "scalar", errors, aBound, someTimes);
+        };
+
+        K_INT failures = 0;
+        const KernelTimes multiplyAddTimes = runKernel(aSeed, COUNT, fill, [&]() {
+            for (size_t i = 0; i < COUNT; ++i)
+                results[i] = Type::MultiplyAdd(first[i], firstWeights[i], second[i]);
+        }, [&]() {
+            for (size_t i = 0; i < COUNT; ++i) {
+                for (K_INT component = 0; component < aComponentCount; ++component) {
+                    const double product = static_cast<double>((&first[i].x)[component]) * firstWeights[i];
+                    const double addend = (&second[i].x)[component];
+                    reference[i * 4 + component] = product + addend;
+                    scales[i * 4 + component] = fabs(product) + fabs(addend);
+                }
+            }
+        });
+        failures += report("MultiplyAdd", 1.0, multiplyAddTimes);
+
+        const KernelTimes weightedSumTimes = runKernel(aSeed + 1, COUNT, fill, [&]() {
+            for (size_t i = 0; i < COUNT; ++i)
+                results[i] = Type::WeightedSum(first[i], firstWeights[i], second[i], secondWeights[i]);
+        }, [&]() {
+            for (size_t i = 0; i < COUNT; ++i) {
+                for (K_INT component = 0; component < aComponentCount; ++component) {
+                    const double firstTerm = static_cast<double>((&first[i].x)[component]) * firstWeights[i];
+                    const double secondTerm = static_cast<double>((&second[i].x)[component]) * secondWeights[i];
+                    reference[i * 4 + component] = firstTerm + secondTerm;
+                    scales[i * 4 + component] = fabs(firstTerm) + fabs(secondTerm);
+                }
+            }
+        });
+        failures += report("WeightedSum", 1.5, weightedSumTimes);
+        return failures;
+    }
+
+    // Compares SlerpNoClamp on pairs of unit rotations aMinAngle to aMaxAngle apart, or that
+    // far from opposite if anOpposite is set, against slerp along the shorter arc evaluated in
+    // double. Opposite pairs also include exact negations, where sin(theta) is zero.
+    K_INT testSlerp(KUI_32 aSeed, const char* aName, double aMinAngle, double aMaxAngle, bool anOpposite, double aBound) {
+        vector<Quaternion> first(COUNT);
+        vector<Quaternion> second(COUNT);
+        vector<float> betas(COUNT);
+        vector<Quaternion> results(COUNT);
+        vector<double> reference(COUNT * 4);
+
+        const KernelTimes times = runKernel(aSeed, COUNT, [&](EdgeCaseGenerator& aGenerator) {
+            for (size_t i = 0; i < COUNT; ++i) {
+                // Angles are log-uniform so the smallest ones are as well covered as the largest.
+                const double angle = aMinAngle * pow(aMaxAngle / aMinAngle, aGenerator.uniform());
+                first[i] = aGenerator.rotation();
+                second[i] = (anOpposite && i % 8 == 1) ? first[i] : aGenerator.turned(first[i], angle);
+                if (anOpposite)
+                    second[i] *= -1.0f;
+                betas[i] = (i % 16 == 0) ? static_cast<float>(i / 16 % 2) : aGenerator.uniform();
+            }
+        }, [&]() {
+            for (size_t i = 0; i < COUNT; ++i)
+                results[i] = Quaternion::SlerpNoClamp(first[i], second[i], betas[i]);
+        }, [&]() {
+            for (size_t i = 0; i < COUNT; ++i) {
+                const float* a = &first[i].x;
+                const float* b = &second[i].x;
+                double dot = 0.0;
+                for (K_INT component = 0; component < 4; ++component)
+                    dot += static_cast<double>(a[component]) * b[component];
+                const double sign = dot < 0.0 ? -1.0 : 1.0;
+                const double theta = acos(min(fabs(dot), 1.0));
+                const double sinTheta = sin(theta);
+                const double beta = betas[i];
+                const double firstWeight = sinTheta > 1e-12 ? sin((1.0 - beta) * theta) / sinTheta : 1.0 - beta;
+                const double secondWeight = sinTheta > 1e-12 ? sin(beta * theta) / sinTheta : beta;
+                for (K_INT component = 0; component < 4; ++component)
+                    reference[i * 4 + component] = a[component] * firstWeight + b[component] * sign * secondWeight;
+            }
+        });
+
+        // Components of a unit rotation are measured against its length of one.
+        ErrorStats errors;
+        for (size_t i = 0; i < COUNT; ++i)
+            for (K_INT component = 0; component < 4; ++component)
+                errors.addFloat((&results[i].x)[component], reference[i * 4 + component], 1.0);
+        return reportKernel(aName, "scalar", errors, aBound, times);
+    }
+
+    // TrigTable trades accuracy for a load: nearest samples are off by up to one step and
+    // interpolated ones by a step squared over eight, plus the rounding of the angle to a
+    // table position, which grows with the angle.
+    K_INT testTrigTable() {
+        const K_UINT resolution = 1024;
+        const TrigTable<resolution> table;
+        const float largestAngle = 64.0f;
+
+        vector<float> angles(COUNT);
+        vector<float> nearest(COUNT);
+        vector<float> interpolated(COUNT);
+        vector<double> reference(COUNT);
+        const auto fill = [&](EdgeCaseGenerator& aGenerator) {
+            for (size_t i = 0; i < COUNT; ++i) {
+                if (i % 8 == 0)
+                    angles[i] = aGenerator.value(largestAngle);
+                else
+                    angles[i] = static_cast<float>(2.0 * PI_DOUBLE) * (2.0f * aGenerator.uniform() - 1.0f);
+            }
+        };
+        const auto sine = [&]() {
+            for (size_t i = 0; i < COUNT; ++i)
+                reference[i] = sin(static_cast<double>(angles[i]));
+        };
+
+        const KernelTimes nearestTimes = runKernel(4, COUNT, fill, [&]() {
+            for (size_t i = 0; i < COUNT; ++i)
+                nearest[i] = table.sin(angles[i]);
+        }, sine);
+        ErrorStats nearestErrors;
+        for (size_t i = 0; i < COUNT; ++i)
+            nearestErrors.addFloat(nearest[i], reference[i], 1.0);
+
+        const KernelTimes interpolatedTimes = runKernel(4, COUNT, fill, [&]() {
+            for (size_t i = 0; i < COUNT; ++i)
+                interpolated[i] = table.sinLerp(angles[i]);
+        }, sine);
+        ErrorStats interpolatedErrors;
+        for (size_t i = 0; i < COUNT; ++i)
+            interpolatedErrors.addFloat(interpolated[i], reference[i], 1.0);
+
+        const double step = 2.0 * PI_DOUBLE / resolution;
+        const double positionError = 2.0 * floatUlp(largestAngle / step) * step;
+        const double ulp = floatUlp(1.0);
+        K_INT failures = 0;
+        failures += reportKernel("TrigTable<1024>::sin", "scalar", nearestErrors, (step + positionError) / ulp, nearestTimes);
+        failures += reportKernel("TrigTable<1024>::sinLerp", "scalar", interpolatedErrors,
+                                 (step * step / 8.0 + positionError) / ulp, interpolatedTimes);
+        return failures;
+    }
+
+    //
+    // Batch kernels.
+    //
+
+    // Value of the IEEE half aHalf.
+    double halfValue(KUI_16 aHalf) {
+        const K_INT exponent = (aHalf >> 10) & 0x1f;
+        const K_INT mantissa = aHalf & 0x3ff;
+        double magnitude;
+        if (exponent == 0x1f)
+            magnitude = mantissa ? NAN : HUGE_VAL;
+        else if (exponent == 0)
+            magnitude = ldexp(mantissa, -24);
+        else
+            magnitude = ldexp(mantissa + 1024, exponent - 25);
+        return (aHalf & 0x8000) ? -magnitude : magnitude;
+    }
+
+    // Spacing of halves at aMagnitude.
+    double halfUlp(double aMagnitude) {
+        int exponent;
+        frexp(aMagnitude, &exponent);
+        return ldexp(1.0, max(exponent - 1, -14) - 10);
+    }
+
+    // Rounds aValue to the nearest half, ties to even, and returns its value.
+    double roundToHalf(float aValue) {
+        if (std::isnan(aValue))
+            return aValue;
+        const double magnitude = fabs(static_cast<double>(aValue));
+        if (magnitude >= 65520.0)
+            return copysign(HUGE_VAL, aValue);
+        const double spacing = halfUlp(magnitude);
+        return copysign(nearbyint(magnitude / spacing) * spacing, aValue);
+    }
+
+    // Conversions must round exactly as IEEE 754 does, at every level.
+    K_INT testHalfs() {
+        // Floats across and just beyond the half range. With edge cases, also exact ties
+        // between two halves and the boundaries of the denormal and infinite ranges.
+        const float specials[] = { 0.0f, -0.0f, 1e-45f, 2.98023224e-8f, 8.94069672e-8f, 6.09755516e-5f,
+                                   6.10351562e-5f, 65504.0f, 65519.996f, 65520.0f, -65536.0f,
+                                   HUGE_VALF, -HUGE_VALF, NAN };
+        const size_t specialCount = sizeof(specials) / sizeof(specials[0]);
+        vector<float> values(COUNT);
+        vector<KUI_16> encoded(COUNT);
+        vector<double> encodeReference(COUNT);
+        const auto fill = [&](EdgeCaseGenerator& aGenerator) {
+            for (size_t i = 0; i < COUNT; ++i) {
+                if (aGenerator.hasEdgeCases() && i < specialCount) {
+                    values[i] = specials[i];
+                } else if (aGenerator.hasEdgeCases() && i % 4 == 0) {
+                    const KUI_16 half = static_cast<KUI_16>(aGenerator.next() % 0x7bff);
+                    const double tie = halfValue(half) + 0.5 * halfUlp(halfValue(half));
+                    values[i] = static_cast<float>((aGenerator.next() & 1) ? -tie : tie);
+                } else {
+                    const K_UINT exponentRange = aGenerator.hasEdgeCases() ? 48 : 30;
+                    const KUI_32 exponent = 127 - 24 + aGenerator.next() % exponentRange;
+                    const KUI_32 bits = (aGenerator.next() & 0x807fffffu) | (exponent << 23);
+                    memcpy(&values[i], &bits, sizeof(values[i]));
+                }
+            }
+        };
+
+        // Decoding is checked on every half there is.
+        vector<KUI_16> allHalfs(0x10000);
+        for (K_UINT i = 0; i < 0x10000; ++i)
+            allHalfs[i] = static_cast<KUI_16>(i);
+        vector<float> decoded(0x10000);
+        vector<double> decodeReference(0x10000);
+
+        K_INT failures = 0;
+        for (const IsaLevel& level : ISA_LEVELS) {
+            if (!isSupported(level)) {
+                cout << "SKIP Half conversions [" << level.name << "]: not supported by this CPU" << endl;
+                continue;
+            }
+            CpuFeatures::Restrict(level.mask);
+
+            const KernelTimes encodeTimes = runKernel(5, COUNT, fill, [&]() {
+                EncodeHalfs(values.data(), encoded.data(), COUNT);
+            }, [&]() {
+                for (size_t i = 0; i < COUNT; ++i)
+                    encodeReference[i] = roundToHalf(values[i]);
+            });
+            ErrorStats encodeErrors;
+            for (size_t i = 0; i < COUNT; ++i) {
+                const double magnitude = fabs(encodeReference[i]);
+                encodeErrors.add(halfValue(encoded[i]), encodeReference[i], magnitude, halfUlp(magnitude));
+            }
+            failures += reportKernel("EncodeHalfs", level.name, encodeErrors, 0.0, encodeTimes);
+
+            const KernelTimes decodeTimes = runKernel(6, 0x10000, [](EdgeCaseGenerator&) { }, [&]() {
+                DecodeHalfs(allHalfs.data(), decoded.data(), 0x10000);
+            }, [&]() {
+                for (K_UINT i = 0; i < 0x10000; ++i)
+                    decodeReference[i] = halfValue(allHalfs[i]);
+            });
+            ErrorStats decodeErrors;
+            for (K_UINT i = 0; i < 0x10000; ++i)
+                decodeErrors.addFloat(decoded[i], decodeReference[i], fabs(decodeReference[i]));
+            failures += reportKernel("DecodeHalfs", level.name, decodeErrors, 0.0, decodeTimes);
+        }
+        CpuFeatures::Unrestrict();
+        return failures;
+    }
+
+    // The vector conversions are runs of EncodeHalfs and DecodeHalfs, so they must round
+    // exactly as IEEE 754 does too. Decoding is checked on random halves, NaNs and infinities
+    // included.
+    template <typename Vector, typename HalfVector>
+    K_INT testHalfVectors(KUI_32 aSeed, const char* aVectorName, K_INT aComponentCount) {
+        vector<Vector> values(COUNT);
+        vector<HalfVector> encoded(COUNT);
+        vector<double> encodeReference(COUNT * 4);
+        vector<HalfVector> halfs(COUNT);
+        vector<Vector> decoded(COUNT);
+        vector<double> decodeReference(COUNT * 4);
+
+        // Values run past the half range, so some round to infinity.
+        const auto fill = [&](EdgeCaseGenerator& aGenerator) {
+            for (size_t i = 0; i < COUNT; ++i) {
+                for (K_INT component = 0; component < aComponentCount; ++component) {
+                    (&values[i].x)[component] = aGenerator.value(1e5f);
+                    (&halfs[i].x)[component] = static_cast<KUI_16>(aGenerator.next());
+                }
+            }
+        };
+
+        K_INT failures = 0;
+        for (const IsaLevel& level : ISA_LEVELS) {
+            if (!isSupported(level)) {
+                cout << "SKIP " << aVectorName << " half conversions [" << level.name << "]: not supported by this CPU" << endl;
+                continue;
+            }
+            CpuFeatures::Restrict(level.mask);
+
+            const KernelTimes encodeTimes = runKernel(aSeed, COUNT, fill, [&]() {
+                EncodeHalfVectors(values.data(), encoded.data(), COUNT);
+            }, [&]() {
+                for (size_t i = 0; i < COUNT; ++i)
+                    for (K_INT component = 0; component < aComponentCount; ++component)
+                        encodeReference[i * 4 + component] = roundToHalf((&values[i].x)[component]);
+            });
+            ErrorStats encodeErrors;
+            for (size_t i = 0; i < COUNT; ++i) {
+                for (K_INT component = 0; component < aComponentCount; ++component) {
+                    const double magnitude = fabs(encodeReference[i * 4 + component]);
+                    encodeErrors.add(halfValue((&encoded[i].x)[component]), encodeReference[i * 4 + component], magnitude,
+                                     halfUlp(magnitude));
+                }
+            }
+            const string encodeName = string("EncodeHalfVectors ") + aVectorName;
+            failures += reportKernel(encodeName.c_str(), level.name, encodeErrors, 0.0, encodeTimes);
+
+            const KernelTimes decodeTimes = runKernel(aSeed + 1, COUNT, fill, [&]() {
+                DecodeHalfVectors(halfs.data(), decoded.data(), COUNT);
+            }, [&]() {
+                for (size_t i = 0; i < COUNT; ++i)
+                    for (K_INT component = 0; component < aComponentCount; ++component)
+                        decodeReference[i * 4 + component] = halfValue((&halfs[i].x)[component]);
+            });
+            ErrorStats decodeErrors;
+            for (size_t i = 0; i < COUNT; ++i)
+                for (K_INT component = 0; component < aComponentCount; ++component)
+                    decodeErrors.addFloat((&decoded[i].x)[component], decodeReference[i * 4 + component],
+                                          fabs(decodeReference[i * 4 + component]));
+            const string decodeName = string("DecodeHalfVectors ") + aVectorName;
+            failures += reportKernel(decodeName.c_str(), level.name, decodeErrors, 0.0, decodeTimes);
+        }
+        CpuFeatures::Unrestrict();
+        return failures;
+    }
+
+    // Smallest-three packing keeps the three smaller components to half a quantization step.
+    // The largest is rebuilt from them, so its error is theirs weighted by their ratio to it,
+    // and those ratios sum to at most 3, when all four components are 0.5. Errors are in
+    // quantization steps against the input with the sign that makes its largest component
+    // positive. The batch must also pack exactly as the scalar constructor does.
+    template <typename Packed>
+    K_INT testPackedQuaternions(KUI_32 aSeed, const char* aName) {
+        const double step = 2.0 * SmallestThree::RANGE / ((1u << Packed::COMPONENT_BITS) - 1u);
+        // Rotations with tied components and components on the edge of the packed range.
+        const double h = 0.70710678118654752;
+        static const double SPECIALS[4][4] = {
+            { 0.0, 0.0, 0.0, 1.0 }, { h, 0.0, 0.0, h }, { h, h, 0.0, 0.0 }, { 0.5, 0.5, 0.5, 0.5 }
+        };
+
+        // One short of a multiple of four so the scalar tail is covered too.
+        const size_t count = COUNT - 1;
+        vector<Quaternion> quats(count);
+        vector<Packed> packed(count);
+        vector<Quaternion> decoded(count);
+        vector<double> reference(count * 4);
+
+        const KernelTimes times = runKernel(aSeed, count, [&](EdgeCaseGenerator& aGenerator) {
+            for (size_t i = 0; i < count; ++i) {
+                if (aGenerator.hasEdgeCases() && i % 4 == 0) {
+                    const double* special = SPECIALS[aGenerator.next() % 4];
+                    const K_UINT shift = aGenerator.next() % 4;
+                    for (K_UINT component = 0; component < 4; ++component)
+                        (&quats[i].x)[component] = static_cast<float>((aGenerator.next() & 1) ? -special[(component + shift) % 4]
+                                                                                               : special[(component + shift) % 4]);
+                } else {
+                    quats[i] = aGenerator.rotation();
+                }
+            }
+        }, [&]() {
+            EncodeQuaternions(quats.data(), packed.data(), count);
+            DecodeQuaternions(packed.data(), decoded.data(), count);
+        }, [&]() {
+            for (size_t i = 0; i < count; ++i) {
+                const float* components = &quats[i].x;
+                K_INT largest = 0;
+                double norm = 0.0;
+                for (K_INT component = 0; component < 4; ++component) {
+                    if (fabsf(components[component]) > fabsf(components[largest]))
+                        largest = component;
+                    norm += static_cast<double>(components[component]) * components[component];
+                }
+                const double scale = (components[largest] < 0.0f ? -1.0 : 1.0) / sqrt(norm);
+                for (K_INT component = 0; component < 4; ++component)
+                    reference[i * 4 + component] = components[component] * scale;
+            }
+        });
+
+        ErrorStats errors;
+        KUI_64 mismatched = 0;
+        for (size_t i = 0; i < count; ++i) {
+            for (K_INT component = 0; component < 4; ++component)
+                errors.add((&decoded[i].x)[component], reference[i * 4 + component], 1.0, step);
+            const Packed scalar(quats[i]);
+            mismatched += memcmp(&scalar, &packed[i], sizeof(Packed)) != 0;
+        }
+        const string name = string("EncodeQuaternions/DecodeQuaternions ") + aName;
+        K_INT failures = reportKernel(name.c_str(), "sse2", errors, 1.5, times);
+        const string matchName = string("EncodeQuaternions ") + aName + " packs as the scalar constructor";
+        failures += ReportCount(matchName.c_str(), mismatched);
+        return failures;
+    }
+
+    // Dropping and restoring the constant column only moves floats, so both directions must be
+    // exact. The encoded rows are the matrix columns, as AffineMatrix3x4f lays them out.
+    K_INT testAffine() {
+        vector<Matrix4x4f> matrices(COUNT);
+        vector<AffineMatrix3x4f> encoded(COUNT);
+        vector<double> encodeReference(COUNT * 12);
+        vector<AffineMatrix3x4f> affine(COUNT);
+        vector<Matrix4x4f> decoded(COUNT);
+        vector<double> decodeReference(COUNT * 16);
+
+        const auto fill = [&](EdgeCaseGenerator& aGenerator) {
+            for (size_t i = 0; i < COUNT; ++i) {
+                for (K_INT element = 0; element < 16; ++element)
+                    matrices[i].elem[element / 4][element % 4] = aGenerator.value(1e38f);
+                for (K_INT element = 0; element < 12; ++element)
+                    affine[i].elem[element / 4][element % 4] = aGenerator.value(1e38f);
+            }
+        };
+
+        const KernelTimes encodeTimes = runKernel(21, COUNT, fill, [&]() {
+            EncodeAffine(matrices.data(), encoded.data(), COUNT);
+        }, [&]() {
+            for (size_t i = 0; i < COUNT; ++i)
+                for (K_INT element = 0; element < 12; ++element)
+                    encodeReference[i * 12 + element] = matrices[i](element % 4, element / 4);
+        });
+        ErrorStats encodeErrors;
+        for (size_t i = 0; i < COUNT; ++i)
+            for (K_INT element = 0; element < 12; ++element)
+                encodeErrors.addFloat(encoded[i].elem[element / 4][element % 4], encodeReference[i * 12 + element],
+                                      fabs(encodeReference[i * 12 + element]));
+        K_INT failures = reportKernel("EncodeAffine", "sse2", encodeErrors, 0.0, encodeTimes);
+
+        const KernelTimes decodeTimes = runKernel(22, COUNT, fill, [&]() {
+            DecodeAffine(affine.data(), decoded.data(), COUNT);
+        }, [&]() {
+            for (size_t i = 0; i < COUNT; ++i) {
+                for (K_INT element = 0; element < 16; ++element) {
+                    const K_INT row = element / 4;
+                    const K_INT col = element % 4;
+                    decodeReference[i * 16 + element] = col < 3 ? affine[i].elem[col][row] : (row == 3 ? 1.0 : 0.0);
+                }
+            }
+        });
+        ErrorStats decodeErrors;
+        for (size_t i = 0; i < COUNT; ++i)
+            for (K_INT element = 0; element < 16; ++element)
+                decodeErrors.addFloat(decoded[i](element / 4, element % 4), decodeReference[i * 16 + element],
+                                      fabs(decodeReference[i * 16 + element]));
+        failures += reportKernel("DecodeAffine", "sse2", decodeErrors, 0.0, decodeTimes);
+        return failures;
+    }
+
+    // Rebasing subtracts in double and rounds once to float, so every level must be within
+    // half an ulp of the double difference.
+    K_INT testRebasing() {
+        const size_t transformCount = COUNT / 4;
+        Vector3d origin;
+        vector<Vector3d> positions(COUNT);
+        vector<Matrix4x4d> transforms(transformCount);
+        vector<Vector3f> rebasedPositions(COUNT);
+        vector<Matrix4x4f> rebasedTransforms(transformCount);
+        vector<double> positionReference(COUNT * 3);
+        vector<double> transformReference(transformCount * 16);
+
+        const auto fill = [&](EdgeCaseGenerator& aGenerator) {
+            origin = Vector3d(aGenerator.value(1e9f), aGenerator.value(1e9f), aGenerator.value(1e9f));
+            for (size_t i = 0; i < COUNT; ++i) {
+                // Every other position sits close to the origin, where the difference is tiny.
+                const float largest = (i % 2) ? 1.0f : 1e9f;
+                const Vector3d base = (i % 2) ? origin : Vector3d();
+                positions[i] = Vector3d(base.x + aGenerator.value(largest), base.y + aGenerator.value(largest),
+                                        base.z + aGenerator.value(largest));
+            }
+            for (size_t i = 0; i < transformCount; ++i)
+                for (K_INT element = 0; element < 16; ++element)
+                    transforms[i].elem[element / 4][element % 4] = aGenerator.value(1e9f);
+        };
+
+        K_INT failures = 0;
+        for (const IsaLevel& level : ISA_LEVELS) {
+            if (!isSupported(level)) {
+                cout << "SKIP Rebasing [" << level.name << "]: not supported by this CPU" << endl;
+                continue;
+            }
+            CpuFeatures::Restrict(level.mask);
+
+            const KernelTimes positionTimes = runKernel(7, COUNT, fill, [&]() {
+                RebasePositions(positions.data(), origin, rebasedPositions.data(), COUNT);
+            }, [&]() {
+                for (size_t i = 0; i < COUNT; ++i) {
+                    positionReference[i * 3 + 0] = positions[i].x - origin.x;
+                    positionReference[i * 3 + 1] = positions[i].y - origin.y;
+                    positionReference[i * 3 + 2] = positions[i].z - origin.z;
+                }
+            });
+            ErrorStats positionErrors;
+            for (size_t i = 0; i < COUNT * 3; ++i)
+                positionErrors.addFloat((&rebasedPositions[0].x)[i], positionReference[i], fabs(positionReference[i]));
+            failures += reportKernel("RebasePositions", level.name, positionErrors, 0.5, positionTimes);
+
+            const KernelTimes transformTimes = runKernel(8, transformCount, fill, [&]() {
+                RebaseTransforms(transforms.data(), origin, rebasedTransforms.data(), transformCount);
+            }, [&]() {
+                const double offsets[4] = { origin.x, origin.y, origin.z, 0.0 };
+                for (size_t i = 0; i < transformCount; ++i)
+                    for (K_INT element = 0; element < 16; ++element)
+                        transformReference[i * 16 + element] = transforms[i].elem[element / 4][element % 4] -
+                            transforms[i].elem[element / 4][3] * offsets[element % 4];
+            });
+            ErrorStats transformErrors;
+            for (size_t i = 0; i < transformCount; ++i)
+                for (K_INT element = 0; element < 16; ++element)
+                    transformErrors.addFloat(rebasedTransforms[i](element / 4, element % 4), transformReference[i * 16 + element],
+                                             fabs(transformReference[i * 16 + element]));
+            failures += reportKernel("RebaseTransforms", level.name, transformErrors, 0.5, transformTimes);
+        }
+        CpuFeatures::Unrestrict();
+        return failures;
+    }
+
+    // The double precision products must match the scalar Matrix4x4d operators at every level,
+    // up to the order the four terms are summed in. Errors are in double ulps of the sum of the
+    // absolute terms.
+    K_INT testLargeWorldProducts() {
+        vector<Matrix4x4d> first(COUNT);
+        vector<Matrix4x4d> second(COUNT);
+        vector<Matrix4x4d> products(COUNT);
+        vector<Matrix4x4d> productReference(COUNT);
+        Matrix4x4d transform;
+        vector<Vector3d> points(COUNT);
+        vector<Vector3d> transformed(COUNT);
+        vector<Vector3d> transformedReference(COUNT);
+
+        const auto fill = [&](EdgeCaseGenerator& aGenerator) {
+            for (size_t i = 0; i < COUNT; ++i) {
+                for (K_INT element = 0; element < 16; ++element) {
+                    first[i].elem[element / 4][element % 4] = aGenerator.value(1e18f);
+                    second[i].elem[element / 4][element % 4] = aGenerator.value(1e18f);
+                }
+                points[i] = Vector3d(aGenerator.value(1e18f), aGenerator.value(1e18f), aGenerator.value(1e18f));
+            }
+            for (K_INT element = 0; element < 16; ++element)
+                transform.elem[element / 4][element % 4] = aGenerator.value(1e18f);
+        };
+
+        K_INT failures = 0;
+        for (const IsaLevel& level : ISA_LEVELS) {
+            if (!isSupported(level)) {
+                cout << "SKIP Matrix4x4d products [" << level.name << "]: not supported by this CPU" << endl;
+                continue;
+            }
+            CpuFeatures::Restrict(level.mask);
+
+            const KernelTimes productTimes = runKernel(13, COUNT, fill, [&]() {
+                MultiplyMatrices(first.data(), second.data(), products.data(), COUNT);
+            }, [&]() {
+                for (size_t i = 0; i < COUNT; ++i)
+                    productReference[i] = first[i] * second[i];
+            });
+            ErrorStats productErrors;
+            for (size_t i = 0; i < COUNT; ++i) {
+                for (K_INT element = 0; element < 16; ++element) {
+                    const K_INT row = element / 4;
+                    const K_INT col = element % 4;
+                    double scale = 0.0;
+                    for (K_INT k = 0; k < 4; ++k)
+                        scale += fabs(first[i].elem[row][k] * second[i].elem[k][col]);
+                    productErrors.addDouble(products[i].elem[row][col], productReference[i].elem[row][col], scale);
+                }
+            }
+            failures += reportKernel("MultiplyMatrices", level.name, productErrors, 4.0, productTimes);
+
+            const KernelTimes pointTimes = runKernel(14, COUNT, fill, [&]() {
+                TransformPoints(transform, points.data(), transformed.data(), COUNT);
+            }, [&]() {
+                for (size_t i = 0; i < COUNT; ++i)
+                    transformedReference[i] = transform.transformPoint(points[i]);
+            });
+            ErrorStats pointErrors;
+            for (size_t i = 0; i < COUNT; ++i) {
+                for (K_INT col = 0; col < 3; ++col) {
+                    const double scale = fabs(points[i].x * transform.elem[0][col]) + fabs(points[i].y * transform.elem[1][col]) +
+                                         fabs(points[i].z * transform.elem[2][col]) + fabs(transform.elem[3][col]);
+                    pointErrors.addDouble((&transformed[i].x)[col], (&transformedReference[i].x)[col], scale);
+                }
+            }
+            failures += reportKernel("TransformPoints", level.name, pointErrors, 4.0, pointTimes);
+        }
+        CpuFeatures::Unrestrict();
+        return failures;
+    }
+
+    // The batch evaluates the power basis form, which only meets the control points up to
+    // rounding of its coefficients, so errors are measured against the segment's control
+    // point magnitudes rather than the Bernstein terms.
+    K_INT testSplineBatch() {
+        const K_UINT segmentCount = 64;
+        vector<Vector3f> controlPoints(segmentCount * 3 + 1);
+        CubicSpline<Vector3f> spline;
+
+        // One short of a multiple of four so the partial last batch is covered too.
+        const K_UINT count = static_cast<K_UINT>(COUNT) - 1;
+        vector<float> parameters(count);
+        vector<Vector3f> positions(count);
+        vector<double> reference(count * 3);
+        vector<double> scales(count * 3);
+
+        const KernelTimes times = runKernel(9, count, [&](EdgeCaseGenerator& aGenerator) {
+            for (size_t i = 0; i < controlPoints.size(); ++i)
+                controlPoints[i] = Vector3f(aGenerator.value(1e15f), aGenerator.value(1e15f), aGenerator.value(1e15f));
+            spline.setBezier(controlPoints.data(), segmentCount);
+
+            // Segment boundaries and parameters past both ends, which clamp, besides random ones.
+            for (K_UINT i = 0; i < count; ++i) {
+                if (i % 8 == 0)
+                    parameters[i] = static_cast<float>(i / 8 % (segmentCount + 1));
+                else
+                    parameters[i] = (segmentCount + 1.0f) * aGenerator.uniform() - 0.5f;
+            }
+        }, [&]() {
+            spline.evaluate(parameters.data(), positions.data(), nullptr, count);
+        }, [&]() {
+            for (K_UINT i = 0; i < count; ++i) {
+                const double clamped = min(max(static_cast<double>(parameters[i]), 0.0), static_cast<double>(segmentCount));
+                const K_UINT segment = min(static_cast<K_UINT>(clamped), segmentCount - 1);
+                const double t = clamped - segment;
+                const double s = 1.0 - t;
+                const double weights[4] = { s * s * s, 3.0 * s * s * t, 3.0 * s * t * t, t * t * t };
+                for (K_INT component = 0; component < 3; ++component) {
+                    double sum = 0.0;
+                    double scale = 0.0;
+                    for (K_INT k = 0; k < 4; ++k) {
+                        const double point = (&controlPoints[segment * 3 + k].x)[component];
+                        sum += weights[k] * point;
+                        scale += fabs(point);
+                    }
+                    reference[i * 3 + component] = sum;
+                    scales[i * 3 + component] = scale;
+                }
+            }
+        });
+
+        ErrorStats errors;
+        for (K_UINT i = 0; i < count; ++i)
+            for (K_INT component = 0; component < 3; ++component)
+                errors.addFloat((&positions[i].x)[component], reference[i * 3 + component], scales[i * 3 + component]);
+        return reportKernel("CubicSpline<Vector3f>::evaluate batch", "sse2", errors, 16.0, times);
+    }
+}
+
+// Differential test of the fast KhaosMath paths against double precision references on
+// random inputs heavy in edge cases. Prints the largest error of each kernel, in ulps and
+// relative, next to its speed against the reference, once per instruction set level for the
+// kernels that dispatch on CpuFeatures. Returns the number of failed checks.
+int TestMathAccuracy() {
+    K_INT failures = 0;
+
+    failures += testKnownBugs();
+    failures += testVectorMatrix();
+    failures += testMatrixProduct();
+    failures += testQuaternionProduct();
+    failures += testFusedSums<Vector3f>(23, "Vector3f", 3);
+    failures += testFusedSums<Vector4f>(25, "Vector4f", 4);
+    failures += testFusedSums<Quaternion>(27, "Quaternion", 4);
+
+    // Near parallel rotations take the normalized lerp fallback. Near and exactly opposite
+    // ones are flipped onto the shorter arc, which leaves them as well conditioned as near
+    // parallel ones.
+    failures += testSlerp(10, "Slerp random", 1e-2, PI_DOUBLE, false, 16.0);
+    failures += testSlerp(11, "Slerp near parallel", 1e-7, 1e-2, false, 16.0);
+    failures += testSlerp(12, "Slerp near and exactly opposite", 1e-7, 1e-1, true, 16.0);
+
+    failures += testTrigTable();
+    failures += testHalfs();
+    failures += testHalfVectors<Vector3f, HalfVector3>(15, "Vector3f", 3);
+    failures += testHalfVectors<Vector4f, HalfVector4>(17, "Vector4f", 4);
+    failures += testPackedQuaternions<PackedQuaternion32>(19, "32-bit");
+    failures += testPackedQuaternions<PackedQuaternion48>(20, "48-bit");
+    failures += testAffine();
+    failures += testRebasing();
+    failures += testLargeWorldProducts();
+    failures += testSplineBatch();
+
+    cout << failures << " math accuracy checks failed." << endl;
+    return failures;
+}
\ No newline at end of file
@@ -0,0 +1,272 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "KhaosMath.h"
+#include "MeshOptimizer.h"
+#include "TestUtilities.h"
+
+using namespace std;
+using namespace std::chrono;
+using namespace KhaosMath;
+using namespace KhaosEngine;
+using namespace KhaosTesting;
+
+namespace
+{
+    struct TestMesh
+    {
+        vector<Vector3f> positions;
+        vector<KUI_32> indices;
+    };
+
+    // Height field of aSize x aSize quads with some rolling hills.
+    TestMesh makeTerrain(K_UINT aSize, float aHeight) {
+        TestMesh mesh;
+        for (K_UINT y = 0; y <= aSize; ++y)
+            for (K_UINT x = 0; x <= aSize; ++x)
+                mesh.positions.push_back(Vector3f(static_cast<float>(x), static_cast<float>(y),
+                                                  aHeight * sinf(x * 0.15f) * cosf(y * 0.1f)));
+        for (K_UINT y = 0; y < aSize; ++y) {
+            for (K_UINT x = 0; x < aSize; ++x) {
+                const KUI_32 corner = y * (aSize + 1) + x;
+                const KUI_32 quad[6] = { corner, corner + 1, corner + aSize + 2, corner, corner + aSize + 2, corner + aSize + 1 };
+                mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+            }
+        }
+        return mesh;
+    }
+
+    // Unit sphere from an icosahedron subdivided aLevels times.
+    TestMesh makeSphere(K_UINT aLevels) {
+        const float t = (1.0f + sqrtf(5.0f)) * 0.5f;
+        TestMesh mesh;
+        const Vector3f corners[12] = {
+            Vector3f(-1, t, 0), Vector3f(1, t, 0), Vector3f(-1, -t, 0), Vector3f(1, -t, 0),
+            Vector3f(0, -1, t), Vector3f(0, 1, t), Vector3f(0, -1, -t), Vector3f(0, 1, -t),
+            Vector3f(t, 0, -1), Vector3f(t, 0, 1), Vector3f(-t, 0, -1), Vector3f(-t, 0, 1) };
+        for (const Vector3f& corner : corners)
+            mesh.positions.push_back(corner.getNormalized());
+        const KUI_32 faces[60] = { 0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11, 1, 5, 9, 5, 11, 4, 11, 10, 2,
+                                   10, 7, 6, 7, 1, 8, 3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9, 4, 9, 5,
+                                   2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1 };
+        mesh.indices.assign(faces, faces + 60);
+
+        for (K_UINT level = 0; level < aLevels; ++level) {
+            map<pair<KUI_32, KUI_32>, KUI_32> midpoints;
+            auto midpoint = [&](KUI_32 a, KUI_32 b) {
+                const pair<KUI_32, KUI_32> key(min(a, b), max(a, b));
+                auto found = midpoints.find(key);
+                if (found != midpoints.end())
+                    return found->second;
+                mesh.positions.push_back((mesh.positions[a] + mesh.positions[b]).getNormalized());
+                const KUI_32 index = static_cast<KUI_32>(mesh.positions.size() - 1);
+                midpoints[key] = index;
+                return index;
+            };
+            vector<KUI_32> subdivided;
+            for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+                const KUI_32 a = mesh.indices[i], b = mesh.indices[i + 1], c = mesh.indices[i + 2];
+                const KUI_32 ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+                const KUI_32 split[12] = { a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca };
+                subdivided.insert(subdivided.end(), split, split + 12);
+            }
+            mesh.indices.swap(subdivided);
+        }
+        return mesh;
+    }
+
+    // Shuffles triangles, as meshes exported in arbitrary order arrive.
+    void shuffleTriangles(vector<KUI_32>& someIndices, mt19937& aGenerator) {
+        const K_UINT triangleCount = static_cast<K_UINT>(someIndices.size() / 3);
+        for (K_UINT i = triangleCount - 1; i > 0; --i) {
+            const K_UINT other = uniform_int_distribution<K_UINT>(0, i)(aGenerator);
+            for (K_UINT corner = 0; corner < 3; ++corner)
+                swap(someIndices[i * 3 + corner], someIndices[other * 3 + corner]);
+        }
+    }
+
+    // Triangles as sorted, rotation independent keys, for comparing index buffers.
+    vector<KUI_64> triangleKeys(const KUI_32* someIndices, size_t anIndexCount) {
+        vector<KUI_64> keys;
+        for (size_t i = 0; i < anIndexCount; i += 3) {
+            const KUI_32* triangle = someIndices + i;
+            const K_UINT first = triangle[0] < triangle[1] ? (triangle[0] < triangle[2] ? 0 : 2) : (triangle[1] < triangle[2] ? 1 : 2);
+            keys.push_back((static_cast<KUI_64>(triangle[first]) << 42) | (static_cast<KUI_64>(triangle[(first + 1) % 3]) << 21) |
+                           triangle[(first + 2) % 3]);
+        }
+        sort(keys.begin(), keys.end());
+        return keys;
+    }
+
+    double surfaceArea(const vector<Vector3f>& somePositions, const KUI_32* someIndices, size_t anIndexCount) {
+        double area = 0.0;
+        for (size_t i = 0; i < anIndexCount; i += 3)
+            area += 0.5 * (somePositions[someIndices[i + 1]] - somePositions[someIndices[i]]).crossProduct(
+                somePositions[someIndices[i + 2]] - somePositions[someIndices[i]]).getMagnitude();
+        return area;
+    }
+
+    double enclosedVolume(const vector<Vector3f>& somePositions, const KUI_32* someIndices, size_t anIndexCount) {
+        double volume = 0.0;
+        for (size_t i = 0; i < anIndexCount; i += 3)
+            volume += somePositions[someIndices[i]].dot(somePositions[someIndices[i + 1]].crossProduct(somePositions[someIndices[i + 2]])) / 6.0;
+        return volume;
+    }
+}
+
+int TestMeshOptimizer() {
+    K_INT failures = 0;
+    mt19937 generator(7);
+
+    // Reordering keeps every triangle and its winding, and cuts transforms per triangle.
+    {
+        TestMesh terrain = makeTerrain(64, 4.0f);
+        shuffleTriangles(terrain.indices, generator);
+        const K_UINT indexCount = static_cast<K_UINT>(terrain.indices.size());
+        const K_UINT vertexCount = static_cast<K_UINT>(terrain.positions.size());
+        vector<KUI_32> optimized(indexCount);
+        OptimizeVertexCache(terrain.indices.data(), indexCount, vertexCount, DEFAULT_VERTEX_CACHE_SIZE, optimized.data());
+        failures += ReportCheck("Reordering keeps triangles",
+                                triangleKeys(optimized.data(), indexCount) == triangleKeys(terrain.indices.data(), indexCount));
+
+        const VertexCacheMetrics before = AnalyzeVertexCache(terrain.indices.data(), indexCount, vertexCount, DEFAULT_VERTEX_CACHE_SIZE);
+        const VertexCacheMetrics after = AnalyzeVertexCache(optimized.data(), indexCount, vertexCount, DEFAULT_VERTEX_CACHE_SIZE);
+        failures += ReportBound("Reordered ACMR", after.acmr, 0.8);
+        cout << "Shuffled grid ACMR " << before.acmr << " -> " << after.acmr << ", ATVR " << before.atvr << " -> " << after.atvr << endl;
+
+        // Fetch remapping visits vertices in increasing order and moves positions with them.
+        vector<KUI_32> remap(vertexCount);
+        vector<KUI_32> remapped = optimized;
+        const K_UINT usedCount = BuildVertexFetchRemap(remapped.data(), indexCount, vertexCount, remap.data());
+        vector<Vector3f> positions(usedCount);
+        RemapVertices(terrain.positions.data(), vertexCount, remap.data(), positions.data());
+        KUI_32 highest = 0;
+        K_UINT outOfOrder = 0;
+        double moved = 0.0;
+        for (K_UINT i = 0; i < indexCount; ++i) {
+            outOfOrder += remapped[i] > highest + 1 ? 1 : 0;
+            highest = max(highest, remapped[i]);
+            moved = max(moved, static_cast<double>((positions[remapped[i]] - terrain.positions[optimized[i]]).getMagnitude()));
+        }
+        failures += ReportCount("Fetch order is first use", outOfOrder + (usedCount != vertexCount));
+        failures += ReportCheck("Fetch remap moves positions", moved == 0.0);
+    }
+
+    // Flat regions collapse to almost nothing while the border stays put.
+    {
+        TestMesh plane = makeTerrain(32, 0.0f);
+        const K_UINT indexCount = static_cast<K_UINT>(plane.indices.size());
+        vector<KUI_32> simplified(indexCount);
+        float error = 0.0f;
+        const K_UINT count = SimplifyMesh(plane.indices.data(), indexCount, plane.positions.data(),
+                                          static_cast<K_UINT>(plane.positions.size()), 0, 1.0e-3f, simplified.data(), &error);
+        const double area = surfaceArea(plane.positions, simplified.data(), count);
+        failures += ReportBound("Plane keeps its area", fabs(area - 32.0 * 32.0) / (32.0 * 32.0), 1.0e-4);
+        failures += ReportBound("Plane reduction", static_cast<double>(count) / indexCount, 0.1);
+        cout << "Plane: " << indexCount / 3 << " -> " << count / 3 << " triangles, error " << error << endl;
+    }
+
+    // A closed sphere keeps its volume and every triangle keeps facing outwards.
+    {
+        TestMesh sphere = makeSphere(4);
+        const K_UINT indexCount = static_cast<K_UINT>(sphere.indices.size());
+        const K_UINT target = indexCount / 8 / 3 * 3;
+        vector<KUI_32> simplified(indexCount);
+        float error = 0.0f;
+        const K_UINT count = SimplifyMesh(sphere.indices.data(), indexCount, sphere.positions.data(),
+                                          static_cast<K_UINT>(sphere.positions.size()), target, 1.0f, simplified.data(), &error);
+        const double volume = enclosedVolume(sphere.positions, sphere.indices.data(), indexCount);
+        const double simplifiedVolume = enclosedVolume(sphere.positions, simplified.data(), count);
+        K_UINT inwards = 0;
+        for (K_UINT i = 0; i < count; i += 3) {
+            const Vector3f& a = sphere.positions[simplified[i]];
+            const Vector3f normal = (sphere.positions[simplified[i + 1]] - a).crossProduct(sphere.positions[simplified[i + 2]] - a);
+            inwards += normal.dot(a + sphere.positions[simplified[i + 1]] + sphere.positions[simplified[i + 2]]) <= 0.0f ? 1 : 0;
+        }
+        failures += ReportCheck("Sphere reaches target", count <= target);
+        failures += ReportBound("Sphere volume", fabs(simplifiedVolume - volume) / volume, 0.05);
+        failures += ReportCount("Sphere triangles face outwards", inwards);
+
+        // An error limit stops simplification early instead of overshooting it.
+        const float limit = 0.01f;
+        const K_UINT limited = SimplifyMesh(sphere.indices.data(), indexCount, sphere.positions.data(),
+                                            static_cast<K_UINT>(sphere.positions.size()), 0, limit, simplified.data(), &error);
+        failures += ReportBound("Error limit respected", error, limit);
+        cout << "Sphere: " << indexCount / 3 << " -> " << count / 3 << " triangles, " << limited / 3
+             << " within error " << limit << " (reached " << error << ")" << endl;
+    }
+
+    // The whole pipeline, serially and across threads, with a report per level.
+    {
+        const K_UINT meshCount = 24;
+        vector<TestMesh> meshes;
+        for (K_UINT i = 0; i < meshCount; ++i) {
+            meshes.push_back(i % 2 ? makeTerrain(24 + i * 4, 3.0f) : makeSphere(3 + i % 3));
+            shuffleTriangles(meshes.back().indices, generator);
+        }
+        MeshProcessingSettings settings;
+        vector<ProcessedMesh> serial(meshCount);
+        vector<ProcessedMesh> parallel(meshCount);
+        vector<MeshProcessingJob> jobs(meshCount);
+        for (K_UINT i = 0; i < meshCount; ++i) {
+            jobs[i].positions = meshes[i].positions.data();
+            jobs[i].vertexCount = static_cast<K_UINT>(meshes[i].positions.size());
+            jobs[i].indices = meshes[i].indices.data();
+            jobs[i].indexCount = static_cast<K_UINT>(meshes[i].indices.size());
+            jobs[i].result = &serial[i];
+        }
+
+        high_resolution_clock::time_point start = high_resolution_clock::now();
+        ProcessMeshesParallel(jobs.data(), meshCount, settings, 1);
+        const double serialSeconds = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+        for (K_UINT i = 0; i < meshCount; ++i)
+            jobs[i].result = &parallel[i];
+        const K_UINT threadCount = max(2u, thread::hardware_concurrency());
+        start = high_resolution_clock::now();
+        ProcessMeshesParallel(jobs.data(), meshCount, settings, threadCount);
+        const double parallelSeconds = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+
+        K_UINT mismatches = 0;
+        double errorOverLimit = 0.0;
+        for (K_UINT i = 0; i < meshCount; ++i) {
+            mismatches += serial[i].positions.size() != parallel[i].positions.size() || serial[i].levels.size() != parallel[i].levels.size();
+            for (size_t level = 0; level < min(serial[i].levels.size(), parallel[i].levels.size()); ++level)
+                mismatches += serial[i].levels[level].indices != parallel[i].levels[level].indices;
+            // Twice the largest distance from the origin bounds the extent of either shape.
+            float radius = 0.0f;
+            for (const Vector3f& position : meshes[i].positions)
+                radius = max(radius, position.getMagnitude());
+            for (const MeshLevel& level : serial[i].levels)
+                errorOverLimit = max(errorOverLimit, static_cast<double>(level.error - settings.maxError * 2.0f * radius));
+        }
+        failures += ReportCount("Parallel matches serial", mismatches);
+        failures += ReportCheck("Level errors within limit", errorOverLimit <= 0.0);
+
+        K_UINT levelsBuilt = 0;
+        for (const ProcessedMesh& mesh : serial)
+            levelsBuilt += static_cast<K_UINT>(mesh.levels.size());
+        failures += ReportBound("Level chains built", static_cast<double>(meshCount * settings.levelCount - levelsBuilt) / meshCount, 1.0);
+
+        for (K_UINT i = 0; i < 2; ++i) {
+            const ProcessedMesh& mesh = serial[i];
+            cout << (i % 2 ? "Terrain" : "Sphere") << " " << mesh.sourceMetrics.triangleCount << " triangles, source ACMR "
+                 << mesh.sourceMetrics.acmr << endl;
+            for (size_t level = 0; level < mesh.levels.size(); ++level) {
+                const MeshLevel& lod = mesh.levels[level];
+                cout << "    level " << level << ": " << lod.metrics.triangleCount << " triangles ("
+                     << 100.0 * lod.metrics.triangleCount / mesh.sourceMetrics.triangleCount << "%), ACMR " << lod.metrics.acmr
+                     << ", ATVR " << lod.metrics.atvr << ", error " << lod.error << endl;
+            }
+        }
+        cout << meshCount << " meshes processed in " << serialSeconds * 1000.0 << " ms on one thread, "
+             << parallelSeconds * 1000.0 << " ms on " << threadCount << endl;
+    }
+
+    return failures;
+}
\ No newline at end of file
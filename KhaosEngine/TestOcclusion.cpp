@@ -0,0 +1,178 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "KhaosMath.h"
+#include "OcclusionCulling.h"
+#include "TestUtilities.h"
+
+using namespace std;
+using namespace std::chrono;
+using namespace KhaosMath;
+using namespace KhaosEngine;
+using namespace KhaosTesting;
+
+namespace
+{
+    // Returns a box of the given half size around aCentre.
+    OcclusionBounds boxAround(const Vector3f& aCentre, float aHalfSize) {
+        OcclusionBounds bounds;
+        bounds.minimum = aCentre - Vector3f(aHalfSize, aHalfSize, aHalfSize);
+        bounds.maximum = aCentre + Vector3f(aHalfSize, aHalfSize, aHalfSize);
+        return bounds;
+    }
+
+    // Brute force reference: true if the box is behind the camera, off screen, or every full
+    // resolution pixel under its screen rectangle is nearer than it. Boxes crossing the near
+    // plane are kept.
+    bool isOccludedReference(const OcclusionBuffer& aBuffer, const Matrix4x4f& aViewProjection,
+                             const OcclusionBounds& aBounds) {
+        float left = INFINITY, right = -INFINITY, top = INFINITY, bottom = -INFINITY, nearest = INFINITY;
+        K_UINT behind = 0;
+        for (K_UINT corner = 0; corner < 8; ++corner) {
+            const Vector4f point(corner & 1 ? aBounds.maximum.x : aBounds.minimum.x,
+                                 corner & 2 ? aBounds.maximum.y : aBounds.minimum.y,
+                                 corner & 4 ? aBounds.maximum.z : aBounds.minimum.z, 1.0f);
+            const Vector4f clip = point * aViewProjection;
+            if (clip.z < 0.0f) {
+                ++behind;
+                continue;
+            }
+            const float x = clip.x / clip.w * OCCLUSION_BUFFER_WIDTH * 0.5f + OCCLUSION_BUFFER_WIDTH * 0.5f;
+            const float y = OCCLUSION_BUFFER_HEIGHT * 0.5f - clip.y / clip.w * OCCLUSION_BUFFER_HEIGHT * 0.5f;
+            left = min(left, x);
+            right = max(right, x);
+            top = min(top, y);
+            bottom = max(bottom, y);
+            nearest = min(nearest, clip.z / clip.w);
+        }
+        if (behind > 0)
+            return behind == 8;
+        if (right < 0.0f || left >= OCCLUSION_BUFFER_WIDTH || bottom < 0.0f || top >= OCCLUSION_BUFFER_HEIGHT)
+            return true;
+        const K_INT x0 = max(0, static_cast<K_INT>(floorf(left)));
+        const K_INT x1 = min(static_cast<K_INT>(OCCLUSION_BUFFER_WIDTH) - 1, static_cast<K_INT>(floorf(right)));
+        const K_INT y0 = max(0, static_cast<K_INT>(floorf(top)));
+        const K_INT y1 = min(static_cast<K_INT>(OCCLUSION_BUFFER_HEIGHT) - 1, static_cast<K_INT>(floorf(bottom)));
+        for (K_INT y = y0; y <= y1; ++y)
+            for (K_INT x = x0; x <= x1; ++x)
+                if (aBuffer.getDepth(0, x, y) >= nearest)
+                    return false;
+        return true;
+    }
+
+    // Returns the seconds taken by one call of aKernel, averaged over aPasses.
+    template <typename Kernel>
+    double timeSeconds(K_INT aPasses, Kernel aKernel) {
+        const high_resolution_clock::time_point start = high_resolution_clock::now();
+        for (K_INT pass = 0; pass < aPasses; ++pass)
+            aKernel();
+        return duration_cast<duration<double>>(high_resolution_clock::now() - start).count() / aPasses;
+    }
+}
+
+// Culls boxes behind a wall and a field of rotated pillars, checks the hierarchical-Z
+// results against a brute force scan of the full resolution buffer, and times
+// rasterization and testing on one thread and on every hardware thread.
+// Returns the number of failed checks.
+int TestOcclusion() {
+    K_INT failures = 0;
+    const K_UINT threadCount = max(1u, thread::hardware_concurrency());
+    const float nearPlane = 0.5f;
+    const float farPlane = 200.0f;
+    const Matrix4x4f viewProjection = Matrix4x4f::LookAt(Vector3f(0.0f, 0.0f, -10.0f), Vector3f(), Vector3f(0.0f, 1.0f, 0.0f)) *
+                                      Matrix4x4f::Perspective(PI / 3.0f, 2.0f, nearPlane, farPlane);
+
+    // A 10x10 wall in the z = 0 plane, a floor running under the camera so it must be clipped
+    // against the near plane, then pillars scattered behind the wall.
+    const Vector3f quadVertices[4] = { Vector3f(-5.0f, -5.0f, 0.0f), Vector3f(5.0f, -5.0f, 0.0f),
+                                       Vector3f(5.0f, 5.0f, 0.0f), Vector3f(-5.0f, 5.0f, 0.0f) };
+    const KUI_16 quadIndices[6] = { 0, 1, 2, 0, 2, 3 };
+    mt19937 generator(40);
+    uniform_real_distribution<float> spread(-60.0f, 60.0f);
+    uniform_real_distribution<float> angle(0.0f, 2.0f * PI);
+
+    vector<OccluderMesh> occluders(66);
+    occluders[0].worldTransform = Matrix4x4f::Identity();
+    occluders[1].worldTransform = Matrix4x4f::TRS(Vector3f(0.0f, -3.0f, 0.0f), Quaternion(sinf(PI * 0.25f), 0.0f, 0.0f, cosf(PI * 0.25f)),
+                                                  Vector3f(20.0f, 20.0f, 1.0f));
+    for (K_UINT i = 2; i < occluders.size(); ++i) {
+        const float yaw = angle(generator);
+        occluders[i].worldTransform = Matrix4x4f::TRS(Vector3f(spread(generator), 0.0f, 30.0f + spread(generator) * 0.5f),
+                                                      Quaternion(0.0f, sinf(yaw * 0.5f), 0.0f, cosf(yaw * 0.5f)),
+                                                      Vector3f(0.4f, 2.0f, 1.0f));
+    }
+    for (OccluderMesh& occluder : occluders) {
+        occluder.vertices = quadVertices;
+        occluder.indices = quadIndices;
+        occluder.triangleCount = 2;
+    }
+
+    OcclusionBuffer occlusion(static_cast<K_UINT>(occluders.size()) * 4);
+    occlusion.beginFrame(viewProjection);
+    occlusion.rasterizeOccluders(occluders.data(), static_cast<K_UINT>(occluders.size()), threadCount);
+
+    // The wall at view distance 10 covers the centre of the screen.
+    const float wallDepth = (10.0f - nearPlane) * farPlane / (farPlane - nearPlane) / 10.0f;
+    failures += ReportBound("Occluder depth", fabsf(occlusion.getDepth(0, OCCLUSION_BUFFER_WIDTH / 2, OCCLUSION_BUFFER_HEIGHT / 2) - wallDepth), 1.0e-5);
+
+    const OcclusionBounds known[5] = {
+        boxAround(Vector3f(0.0f, 0.0f, 5.0f), 1.0f),   // Behind the wall.
+        boxAround(Vector3f(0.0f, 0.0f, -3.0f), 1.0f),  // In front of the wall.
+        boxAround(Vector3f(12.0f, 0.0f, 5.0f), 1.0f),  // Beside the wall.
+        boxAround(Vector3f(0.0f, 0.0f, -10.0f), 1.0f), // Around the camera.
+        boxAround(Vector3f(0.0f, 0.0f, -30.0f), 1.0f)  // Behind the camera.
+    };
+    const bool expected[5] = { false, true, true, true, false };
+    bool knownVisible[5];
+    occlusion.testBounds(known, 0, 5, knownVisible);
+    K_INT knownMismatches = 0;
+    for (K_UINT i = 0; i < 5; ++i)
+        knownMismatches += knownVisible[i] != expected[i] ? 1 : 0;
+    failures += ReportCount("Known boxes", knownMismatches);
+
+    // Random boxes across the scene. The hierarchy may keep boxes the full resolution buffer
+    // would cull, but must never cull one that any pixel shows.
+    const K_UINT boxCount = 100003;
+    uniform_real_distribution<float> depthSpread(-5.0f, 80.0f);
+    uniform_real_distribution<float> size(0.1f, 2.0f);
+    vector<OcclusionBounds> boxes(boxCount);
+    for (OcclusionBounds& box : boxes)
+        box = boxAround(Vector3f(spread(generator) * 0.5f, spread(generator) * 0.1f, depthSpread(generator)), size(generator));
+
+    vector<char> serial(boxCount), parallel(boxCount);
+    occlusion.testBounds(boxes.data(), 0, boxCount, reinterpret_cast<bool*>(serial.data()));
+    occlusion.testBoundsParallel(boxes.data(), boxCount, reinterpret_cast<bool*>(parallel.data()), threadCount);
+    K_INT wronglyCulled = 0;
+    K_UINT culled = 0;
+    K_UINT referenceCulled = 0;
+    for (K_UINT i = 0; i < boxCount; ++i) {
+        const bool reference = isOccludedReference(occlusion, viewProjection, boxes[i]);
+        referenceCulled += reference ? 1 : 0;
+        culled += serial[i] ? 0 : 1;
+        wronglyCulled += !serial[i] && !reference ? 1 : 0;
+    }
+    failures += ReportCount("Culled boxes also culled by reference", wronglyCulled);
+    failures += ReportCheck("Parallel matches serial", serial == parallel);
+    cout << "Culled " << culled << " of " << boxCount << " boxes, full resolution reference culls " << referenceCulled << endl;
+
+    // Benchmark.
+    const K_INT passes = 20;
+    for (K_UINT threads : { 1u, threadCount }) {
+        const double rasterTime = timeSeconds(passes, [&] {
+            occlusion.beginFrame(viewProjection);
+            occlusion.rasterizeOccluders(occluders.data(), static_cast<K_UINT>(occluders.size()), threads);
+        });
+        const double testTime = timeSeconds(passes, [&] {
+            occlusion.testBoundsParallel(boxes.data(), boxCount, reinterpret_cast<bool*>(parallel.data()), threads);
+        });
+        cout << threads << " threads: rasterize " << rasterTime * 1.0e6 << " us, test " << testTime * 1.0e6 << " us, "
+             << boxCount / testTime / 1.0e6 << "M boxes/s" << endl;
+    }
+
+    return failures;
+}
\ No newline at end of file
@@ -0,0 +1,254 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <queue>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "KhaosMath.h"
+#include "Pathfinding.h"
+#include "TestUtilities.h"
+
+using namespace std;
+using namespace std::chrono;
+using namespace KhaosMath;
+using namespace KhaosEngine;
+using namespace KhaosTesting;
+
+namespace
+{
+    // Blocks random rectangles until roughly aCoverage of the grid is blocked.
+    void scatterObstacles(NavigationGrid& aGrid, float aCoverage, mt19937& aGenerator) {
+        uniform_int_distribution<K_UINT> column(0, aGrid.getWidth() - 1);
+        uniform_int_distribution<K_UINT> row(0, aGrid.getHeight() - 1);
+        uniform_int_distribution<K_UINT> size(1, 12);
+        const K_UINT target = static_cast<K_UINT>(aCoverage * aGrid.getWidth() * aGrid.getHeight());
+        K_UINT blocked = 0;
+        while (blocked < target) {
+            const K_UINT x0 = column(aGenerator), y0 = row(aGenerator);
+            const K_UINT x1 = min(x0 + size(aGenerator), aGrid.getWidth()), y1 = min(y0 + size(aGenerator), aGrid.getHeight());
+            for (K_UINT y = y0; y < y1; ++y)
+                for (K_UINT x = x0; x < x1; ++x)
+                    if (aGrid.isWalkable(x, y)) {
+                        aGrid.setBlocked(x, y, true);
+                        ++blocked;
+                    }
+        }
+    }
+
+    // Returns a random point inside a walkable cell.
+    Vector2f randomOpenPoint(const NavigationGrid& aGrid, mt19937& aGenerator) {
+        uniform_real_distribution<float> unit(0.0f, 1.0f);
+        for (;;) {
+            const Vector2f point(unit(aGenerator) * aGrid.getWidth() * aGrid.getCellSize(),
+                                 unit(aGenerator) * aGrid.getHeight() * aGrid.getCellSize());
+            K_INT x, y;
+            aGrid.worldToCell(point, x, y);
+            if (aGrid.isWalkable(x, y))
+                return point;
+        }
+    }
+
+    float polylineLength(const vector<Vector2f>& somePoints) {
+        float length = 0.0f;
+        for (size_t i = 1; i < somePoints.size(); ++i)
+            length += (somePoints[i] - somePoints[i - 1]).getMagnitude();
+        return length;
+    }
+
+    // A* the way agents ran it before the queue: fresh hash maps and heap per query.
+    float naiveAStar(const NavigationGrid& aGrid, const Vector2f& aStart, const Vector2f& aGoal) {
+        K_INT startX, startY, goalX, goalY;
+        aGrid.worldToCell(aStart, startX, startY);
+        aGrid.worldToCell(aGoal, goalX, goalY);
+        const K_INT width = static_cast<K_INT>(aGrid.getWidth());
+        typedef pair<float, K_INT> Entry;
+        priority_queue<Entry, vector<Entry>, greater<Entry>> open;
+        unordered_map<K_INT, float> costs;
+        unordered_map<K_INT, K_INT> parents;
+        unordered_map<K_INT, bool> closed;
+        const K_INT goal = goalY * width + goalX;
+        costs[startY * width + startX] = 0.0f;
+        open.push(Entry(0.0f, startY * width + startX));
+        while (!open.empty()) {
+            const K_INT cell = open.top().second;
+            open.pop();
+            if (closed[cell])
+                continue;
+            closed[cell] = true;
+            if (cell == goal)
+                return costs[cell] * aGrid.getCellSize();
+            const K_INT x = cell % width, y = cell / width;
+            for (K_INT dy = -1; dy <= 1; ++dy) {
+                for (K_INT dx = -1; dx <= 1; ++dx) {
+                    if ((dx == 0 && dy == 0) || aGrid.isBlocked(x + dx, y + dy) ||
+                        (dx != 0 && dy != 0 && (aGrid.isBlocked(x + dx, y) || aGrid.isBlocked(x, y + dy))))
+                        continue;
+                    const K_INT neighbour = (y + dy) * width + x + dx;
+                    const float cost = costs[cell] + (dx != 0 && dy != 0 ? 1.41421356f : 1.0f);
+                    auto known = costs.find(neighbour);
+                    if (known != costs.end() && known->second <= cost)
+                        continue;
+                    costs[neighbour] = cost;
+                    parents[neighbour] = cell;
+                    const float ddx = fabsf(static_cast<float>(goalX - x - dx)), ddy = fabsf(static_cast<float>(goalY - y - dy));
+                    open.push(Entry(cost + max(ddx, ddy) + 0.41421356f * min(ddx, ddy), neighbour));
+                }
+            }
+        }
+        return -1.0f;
+    }
+}
+
+int TestPathfinding() {
+    K_INT failures = 0;
+    mt19937 generator(11);
+    NavigationGrid grid(256, 256, 0.5f, Vector2f(0.0f, 0.0f));
+    scatterObstacles(grid, 0.25f, generator);
+
+    const K_UINT requestCount = 400;
+    vector<PathRequest> requests(requestCount);
+    for (PathRequest& request : requests) {
+        request.start = randomOpenPoint(grid, generator);
+        request.goal = randomOpenPoint(grid, generator);
+        request.smooth = false;
+    }
+
+    // Jump point search finds paths exactly as short as A*, and every segment is walkable.
+    {
+        PathSearch search;
+        PathResult aStar, jumpPoint, smoothed;
+        double costError = 0.0;
+        K_UINT statusMismatches = 0;
+        K_UINT blockedSegments = 0;
+        double lengthGain = 0.0;
+        K_UINT found = 0;
+        for (PathRequest request : requests) {
+            request.algorithm = PathAlgorithm::AStar;
+            search.findPath(grid, request, aStar);
+            request.algorithm = PathAlgorithm::JumpPoint;
+            search.findPath(grid, request, jumpPoint);
+            request.smooth = true;
+            search.findPath(grid, request, smoothed);
+            statusMismatches += aStar.status != jumpPoint.status;
+            if (aStar.status != PathStatus::Found || jumpPoint.status != PathStatus::Found)
+                continue;
+            ++found;
+            costError = max(costError, static_cast<double>(fabsf(aStar.cost - jumpPoint.cost) / aStar.cost));
+            // The first segment leaves the start off centre, so check from the first cell on.
+            for (size_t i = 2; i < aStar.waypoints.size(); ++i)
+                blockedSegments += !grid.hasLineOfSight(aStar.waypoints[i - 1], aStar.waypoints[i]);
+            for (size_t i = 2; i < jumpPoint.waypoints.size(); ++i)
+                blockedSegments += !grid.hasLineOfSight(jumpPoint.waypoints[i - 1], jumpPoint.waypoints[i]);
+            for (size_t i = 2; i < smoothed.waypoints.size(); ++i)
+                blockedSegments += !grid.hasLineOfSight(smoothed.waypoints[i - 1], smoothed.waypoints[i]);
+            lengthGain = max(lengthGain, static_cast<double>(polylineLength(smoothed.waypoints) - polylineLength(aStar.waypoints)));
+        }
+        failures += ReportCount("A* and jump point agree on reachability", statusMismatches);
+        failures += ReportBound("Jump point cost matches A*", costError, 1.0e-5);
+        failures += ReportCount("Path segments walkable", blockedSegments);
+        failures += ReportBound("Smoothing never lengthens", max(0.0, lengthGain), 1.0e-3);
+        cout << found << " of " << requestCount << " requests reachable" << endl;
+    }
+
+    // Enclosed goals and blocked endpoints fail cleanly.
+    {
+        NavigationGrid room(32, 32, 1.0f, Vector2f(-16.0f, -16.0f));
+        for (K_UINT i = 10; i <= 20; ++i) {
+            room.setBlocked(i, 10, true);
+            room.setBlocked(i, 20, true);
+            room.setBlocked(10, i, true);
+            room.setBlocked(20, i, true);
+        }
+        PathSearch search;
+        PathResult result;
+        PathRequest request = { Vector2f(-14.0f, -14.0f), Vector2f(0.0f, 0.0f), PathAlgorithm::JumpPoint, true };
+        search.findPath(room, request, result);
+        K_UINT wrong = result.status != PathStatus::NoPath;
+        request.algorithm = PathAlgorithm::AStar;
+        search.findPath(room, request, result);
+        wrong += result.status != PathStatus::NoPath;
+        request.goal = Vector2f(-6.0f, -1.0f);
+        search.findPath(room, request, result);
+        wrong += result.status != PathStatus::BlockedEndpoint;
+        request.goal = Vector2f(40.0f, 0.0f);
+        search.findPath(room, request, result);
+        wrong += result.status != PathStatus::BlockedEndpoint;
+
+        // Around the room the smoothed path hugs its corners.
+        request.goal = Vector2f(14.5f, 14.5f);
+        search.findPath(room, request, result);
+        wrong += result.status != PathStatus::Found || result.waypoints.size() != 3;
+        failures += ReportCount("Unreachable and blocked requests", wrong);
+    }
+
+    // The queue gives the same answers on any number of threads.
+    {
+        for (K_UINT i = 0; i < requestCount; ++i) {
+            requests[i].algorithm = i % 2 ? PathAlgorithm::JumpPoint : PathAlgorithm::AStar;
+            requests[i].smooth = i % 3 != 0;
+        }
+        const K_UINT threadCount = max(2u, thread::hardware_concurrency());
+        PathfindingQueue serial(grid, 1);
+        PathfindingQueue parallel(grid, threadCount);
+        K_UINT mismatches = 0;
+        for (K_UINT frame = 0; frame < 2; ++frame) {
+            serial.clear();
+            parallel.clear();
+            for (const PathRequest& request : requests) {
+                serial.submit(request);
+                parallel.submit(request);
+            }
+            serial.processAll();
+            parallel.processAll();
+            for (K_UINT i = 0; i < requestCount; ++i) {
+                const PathResult& a = serial.getResult(i);
+                const PathResult& b = parallel.getResult(i);
+                mismatches += a.status != b.status || a.cost != b.cost || a.waypoints.size() != b.waypoints.size();
+            }
+        }
+        failures += ReportCount("Parallel queue matches serial", mismatches);
+
+        // Benchmark: per query allocating A*, pooled A*, jump point search, and the queue.
+        high_resolution_clock::time_point start = high_resolution_clock::now();
+        float checksum = 0.0f;
+        for (const PathRequest& request : requests)
+            checksum += naiveAStar(grid, request.start, request.goal);
+        const double naiveSeconds = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+
+        PathSearch search;
+        PathResult result;
+        double pooledSeconds[2];
+        K_UINT expanded[2] = { 0, 0 };
+        for (K_UINT algorithm = 0; algorithm < 2; ++algorithm) {
+            start = high_resolution_clock::now();
+            for (PathRequest request : requests) {
+                request.algorithm = algorithm ? PathAlgorithm::JumpPoint : PathAlgorithm::AStar;
+                request.smooth = true;
+                search.findPath(grid, request, result);
+                expanded[algorithm] += result.expandedCount;
+                checksum += result.cost;
+            }
+            pooledSeconds[algorithm] = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+        }
+
+        parallel.clear();
+        for (PathRequest request : requests) {
+            request.algorithm = PathAlgorithm::JumpPoint;
+            request.smooth = true;
+            parallel.submit(request);
+        }
+        start = high_resolution_clock::now();
+        parallel.processAll();
+        const double queueSeconds = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+
+        cout << requestCount << " queries on 256x256: allocating A* " << naiveSeconds * 1000.0 << " ms, pooled A* "
+             << pooledSeconds[0] * 1000.0 << " ms (" << expanded[0] / requestCount << " expanded), jump point "
+             << pooledSeconds[1] * 1000.0 << " ms (" << expanded[1] / requestCount << " expanded), jump point queue on "
+             << threadCount << " threads " << queueSeconds * 1000.0 << " ms (checksum " << checksum << ")" << endl;
+    }
+
+    return failures;
+}
\ No newline at end of file
@@ -0,0 +1,307 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Profiler.h"
+#include "TestUtilities.h"
+
+using namespace std;
+using namespace std::chrono;
+using namespace KhaosEngine;
+using namespace KhaosTesting;
+
+// Zones in this block are compiled with the profiler switched off. Every argument counts its
+// own evaluation, so anything left of a macro shows up in the returned count.
+#undef PROFILER_ENABLED
+#define PROFILER_ENABLED 0
+#include "ProfilerMacros.h"
+
+namespace
+{
+    K_UINT recordDisabledZones() {
+        K_UINT evaluated = 0;
+        PROFILE_THREAD_NAME((++evaluated, "Disabled"));
+        PROFILE_FUNCTION();
+        PROFILE_SCOPE((++evaluated, "Disabled scope"));
+        PROFILE_SCOPE_CATEGORY((++evaluated, "Disabled category scope"), (++evaluated, PROFILE_CATEGORY_MATH));
+        return evaluated;
+    }
+}
+
+#undef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#include "ProfilerMacros.h"
+
+namespace
+{
+    const char* const TRACE_PATH = "TestProfiler.json";
+    const K_UINT NESTED_FRAMES = 200;
+    const K_UINT INNER_PER_FRAME = 3;
+
+    // One complete zone parsed back out of an exported trace.
+    struct TraceZone
+    {
+        string name;
+        K_UINT thread;
+        double start;
+        double end;
+    };
+
+    // Frames of Outer zones that each hold INNER_PER_FRAME Inner zones around one Leaf zone.
+    void recordNestedFrames() {
+        for (K_UINT frame = 0; frame < NESTED_FRAMES; ++frame) {
+            PROFILE_SCOPE("Outer");
+            for (K_UINT i = 0; i < INNER_PER_FRAME; ++i) {
+                PROFILE_SCOPE_CATEGORY("Inner", PROFILE_CATEGORY_MATH);
+                PROFILE_SCOPE("Leaf");
+            }
+        }
+    }
+
+    // Returns the text between aKey and the next comma or closing brace of aLine.
+    string field(const string& aLine, const char* aKey) {
+        const size_t start = aLine.find(aKey);
+        if (start == string::npos)
+            return string();
+        const size_t first = start + strlen(aKey);
+        return aLine.substr(first, aLine.find_first_of(",}", first) - first);
+    }
+
+    // Reads the trace written by Profiler::WriteChromeTrace, one event per line. Fills
+    // someThreadNames with the tid of every named thread and counts malformed lines.
+    K_UINT readTrace(const char* aPath, vector<TraceZone>& someZones, vector<pair<string, K_UINT>>& someThreadNames) {
+        ifstream stream(aPath);
+        string line;
+        K_UINT malformed = !getline(stream, line) || line != "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool closed = false;
+        while (getline(stream, line)) {
+            if (line == "]}") {
+                closed = true;
+                continue;
+            }
+            if (!line.empty() && line.back() == ',')
+                line.pop_back();
+            const string name = field(line, "{\"name\":\"");
+            const string phase = field(line, "\"ph\":\"");
+            const K_UINT thread = static_cast<K_UINT>(atoi(field(line, "\"tid\":").c_str()));
+            if (phase == "M\"") {
+                const string threadName = field(line, "\"args\":{\"name\":\"");
+                someThreadNames.push_back(make_pair(threadName.substr(0, threadName.size() - 1), thread));
+            }
+            else if (phase == "X\"") {
+                const double start = atof(field(line, "\"ts\":").c_str());
+                const double duration = atof(field(line, "\"dur\":").c_str());
+                malformed += duration < 0.0;
+                someZones.push_back(TraceZone{ name.substr(0, name.size() - 1), thread, start, start + duration });
+            }
+            else {
+                ++malformed;
+            }
+        }
+        return malformed + !closed;
+    }
+
+    K_UINT findThread(const vector<pair<string, K_UINT>>& someThreadNames, const char* aName) {
+        for (size_t i = 0; i < someThreadNames.size(); ++i) {
+            if (someThreadNames[i].first == aName)
+                return someThreadNames[i].second;
+        }
+        return Profiler::MAX_THREADS;
+    }
+
+    // Counts aThread's zones named aChild that do not lie inside exactly one of its zones named
+    // aParent, and aParent zones that do not hold exactly aChildCount of them. Times are
+    // rounded to nanoseconds in the trace, so the bounds allow for that.
+    KUI_64 countBadNesting(const vector<TraceZone>& someZones, K_UINT aThread, const char* aParent, const char* aChild,
+                           K_UINT aChildCount) {
+        const double rounding = 0.002;
+        vector<const TraceZone*> parents;
+        vector<const TraceZone*> children;
+        for (size_t i = 0; i < someZones.size(); ++i) {
+            if (someZones[i].thread == aThread && someZones[i].name == aParent)
+                parents.push_back(&someZones[i]);
+            if (someZones[i].thread == aThread && someZones[i].name == aChild)
+                children.push_back(&someZones[i]);
+        }
+        vector<K_UINT> held(parents.size(), 0);
+        KUI_64 bad = 0;
+        for (size_t c = 0; c < children.size(); ++c) {
+            K_UINT enclosing = 0;
+            for (size_t p = 0; p < parents.size(); ++p) {
+                if (children[c]->start >= parents[p]->start - rounding && children[c]->end <= parents[p]->end + rounding) {
+                    ++enclosing;
+                    ++held[p];
+                }
+            }
+            bad += enclosing != 1;
+        }
+        for (size_t p = 0; p < parents.size(); ++p)
+            bad += held[p] != aChildCount;
+        return bad;
+    }
+
+    K_UINT countZones(const vector<TraceZone>& someZones, K_UINT aThread) {
+        K_UINT count = 0;
+        for (size_t i = 0; i < someZones.size(); ++i)
+            count += someZones[i].thread == aThread;
+        return count;
+    }
+
+    // Ring buffer filled with aCount events, numbered in both tick fields.
+    void fillBuffer(ProfileThreadBuffer& aBuffer, KUI_64 aCount) {
+        for (KUI_64 i = 0; i < aCount; ++i) {
+            ProfileEvent& event = aBuffer.events[i & (ProfileThreadBuffer::CAPACITY - 1)];
+            event.name = "Numbered";
+            event.category = PROFILE_CATEGORY_DEFAULT;
+            event.startTicks = i;
+            event.endTicks = i;
+        }
+        aBuffer.head.store(aCount, std::memory_order_release);
+    }
+
+    // True when someEvents are whole events numbered consecutively from aFirstEvent.
+    bool isConsecutive(const vector<ProfileEvent>& someEvents, KUI_64 aFirstEvent) {
+        for (size_t i = 0; i < someEvents.size(); ++i) {
+            if (someEvents[i].startTicks != aFirstEvent + i || someEvents[i].endTicks != aFirstEvent + i)
+                return false;
+        }
+        return true;
+    }
+}
+
+int TestProfiler() {
+    K_INT failures = 0;
+    const K_UINT capacity = ProfileThreadBuffer::CAPACITY;
+
+    // Disabled macros leave no code behind, not even their arguments, and never register a
+    // buffer for the thread that used them.
+    {
+        K_UINT evaluated = 0;
+        thread worker([&]() { evaluated = recordDisabledZones(); });
+        worker.join();
+        failures += ReportCheck("Disabled macros compile out", evaluated == 0);
+    }
+
+    // CopyEvents returns the whole ring before it wraps and the newest capacity - 1 events
+    // after, since the slot after the head may be under rewrite.
+    {
+        unique_ptr<ProfileThreadBuffer> buffer(new ProfileThreadBuffer);
+        vector<ProfileEvent> events;
+        fillBuffer(*buffer, 0);
+        Profiler::CopyEvents(*buffer, events);
+        failures += ReportCheck("CopyEvents of an empty ring", events.empty());
+
+        fillBuffer(*buffer, 100);
+        Profiler::CopyEvents(*buffer, events);
+        failures += ReportCheck("CopyEvents before the ring wraps", events.size() == 100 && isConsecutive(events, 0));
+
+        const KUI_64 wrapped = 3 * capacity + 500;
+        fillBuffer(*buffer, wrapped);
+        Profiler::CopyEvents(*buffer, events);
+        failures += ReportCheck("CopyEvents after the ring wraps",
+                                events.size() == capacity - 1 && isConsecutive(events, wrapped - capacity + 1));
+
+        // A writer laps the ring several times while the copies run. Every copy must still be
+        // a run of whole, consecutive events.
+        fillBuffer(*buffer, 0);
+        atomic<bool> writing(true);
+        thread writer([&]() {
+            for (KUI_64 i = 0; i < 16 * capacity; ++i) {
+                ProfileEvent& event = buffer->events[i & (capacity - 1)];
+                event.startTicks = i;
+                event.endTicks = i;
+                buffer->head.store(i + 1, std::memory_order_release);
+            }
+            writing.store(false, std::memory_order_release);
+        });
+        KUI_64 torn = 0;
+        K_UINT copies = 0;
+        while (writing.load(std::memory_order_acquire) || copies == 0) {
+            Profiler::CopyEvents(*buffer, events);
+            torn += !events.empty() && !isConsecutive(events, events[0].startTicks);
+            ++copies;
+        }
+        writer.join();
+        failures += ReportCount("CopyEvents while the owner records", torn);
+    }
+
+    // Two threads record nested zones into their own buffers. The second first overflows its
+    // ring, so only its newest events survive, and the main thread's zones stay out of both.
+    {
+        Profiler::Clear();
+        thread nested([]() {
+            PROFILE_THREAD_NAME("Profiler test nested");
+            recordNestedFrames();
+        });
+        thread overflowing([=]() {
+            PROFILE_THREAD_NAME("Profiler test overflow");
+            for (K_UINT i = 0; i < 2 * capacity; ++i) {
+                PROFILE_SCOPE("Overwritten");
+            }
+            recordNestedFrames();
+        });
+        {
+            PROFILE_SCOPE("Main thread");
+        }
+        nested.join();
+        overflowing.join();
+
+        const bool written = Profiler::WriteChromeTrace(TRACE_PATH);
+        vector<TraceZone> zones;
+        vector<pair<string, K_UINT>> threadNames;
+        const K_UINT malformed = written ? readTrace(TRACE_PATH, zones, threadNames) : 1;
+        remove(TRACE_PATH);
+        failures += ReportCheck("Trace written and well formed", malformed == 0);
+
+        const K_UINT nestedThread = findThread(threadNames, "Profiler test nested");
+        const K_UINT overflowThread = findThread(threadNames, "Profiler test overflow");
+        failures += ReportCheck("Each thread records into its own buffer",
+                                nestedThread < Profiler::MAX_THREADS && overflowThread < Profiler::MAX_THREADS &&
+                                nestedThread != overflowThread);
+
+        const K_UINT zonesPerThread = NESTED_FRAMES * (1 + 2 * INNER_PER_FRAME);
+        failures += ReportCheck("Every nested zone is exported", countZones(zones, nestedThread) == zonesPerThread);
+        failures += ReportCheck("Overflowed ring keeps its newest events", countZones(zones, overflowThread) == capacity - 1);
+
+        KUI_64 badNesting = 0;
+        const K_UINT threads[] = { nestedThread, overflowThread };
+        for (K_UINT t = 0; t < 2; ++t) {
+            badNesting += countBadNesting(zones, threads[t], "Outer", "Inner", INNER_PER_FRAME);
+            badNesting += countBadNesting(zones, threads[t], "Inner", "Leaf", 1);
+        }
+        failures += ReportCount("Nested zones begin and end inside their parents", badNesting);
+
+        KUI_64 misplaced = 0;
+        KUI_64 disabled = findThread(threadNames, "Disabled") != Profiler::MAX_THREADS;
+        for (size_t i = 0; i < zones.size(); ++i) {
+            misplaced += zones[i].name == "Main thread" && (zones[i].thread == nestedThread || zones[i].thread == overflowThread);
+            disabled += zones[i].name.compare(0, 8, "Disabled") == 0 || zones[i].name == "recordDisabledZones";
+        }
+        failures += ReportCount("Zones stay on the thread that recorded them", misplaced);
+        failures += ReportCount("Disabled macros record nothing", disabled);
+    }
+
+    // Cost of one zone on a thread that already has its buffer.
+    {
+        const K_UINT zoneCount = 4 * capacity;
+        Profiler::Clear();
+        const high_resolution_clock::time_point start = high_resolution_clock::now();
+        for (K_UINT i = 0; i < zoneCount; ++i) {
+            PROFILE_SCOPE("Benchmark");
+        }
+        const double seconds = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+        Profiler::Clear();
+        cout << "ProfileScope: " << seconds * 1.0e9 / zoneCount << " ns per zone ("
+             << Profiler::GetTicksPerMicrosecond() << " ticks per microsecond)" << endl;
+    }
+
+    return failures;
+}
\ No newline at end of file
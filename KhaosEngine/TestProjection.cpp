@@ -0,0 +1,177 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "KhaosMath.h"
+#include "TestUtilities.h"
+
+using namespace std;
+using namespace std::chrono;
+using namespace KhaosMath;
+using namespace KhaosTesting;
+
+namespace
+{
+    // Camera parameters for one case, with far up to ten thousand times near.
+    struct Frustum
+    {
+        float fovY;
+        float aspect;
+        float nearPlane;
+        float farPlane;
+    };
+
+    Frustum randomFrustum(mt19937& aGenerator) {
+        uniform_real_distribution<float> unit(0.0f, 1.0f);
+        Frustum frustum;
+        frustum.fovY = 0.3f + 2.2f * unit(aGenerator);
+        frustum.aspect = 0.5f + 2.0f * unit(aGenerator);
+        frustum.nearPlane = powf(10.0f, -2.0f + 3.0f * unit(aGenerator));
+        frustum.farPlane = frustum.nearPlane * powf(10.0f, 1.0f + 3.0f * unit(aGenerator));
+        return frustum;
+    }
+
+    // Returns the normalized device coordinates of a view space point.
+    Vector3f project(const Vector3f& aPoint, const Matrix4x4f& aProjection) {
+        const Vector4f clip = Vector4f(aPoint.x, aPoint.y, aPoint.z, 1.0f) * aProjection;
+        return Vector3f(clip.x / clip.w, clip.y / clip.w, clip.z / clip.w);
+    }
+
+    // Largest distance of a projected point from where it should land.
+    double ndcError(const Vector3f& aPoint, const Matrix4x4f& aProjection, const Vector3f& anExpected) {
+        const Vector3f ndc = project(aPoint, aProjection);
+        return max(fabs(static_cast<double>(ndc.x) - anExpected.x),
+                   max(fabs(static_cast<double>(ndc.y) - anExpected.y), fabs(static_cast<double>(ndc.z) - anExpected.z)));
+    }
+
+    // Error of the near and far corners of the top right frustum edge, which should land on
+    // x = y = 1 at the depths given.
+    double frustumError(const Frustum& aFrustum, const Matrix4x4f& aProjection, float aNearDepth, float aFarDepth) {
+        const float slope = tanf(aFrustum.fovY * 0.5f);
+        const Vector3f nearCorner(aFrustum.nearPlane * slope * aFrustum.aspect, aFrustum.nearPlane * slope, aFrustum.nearPlane);
+        const Vector3f farCorner(aFrustum.farPlane * slope * aFrustum.aspect, aFrustum.farPlane * slope, aFrustum.farPlane);
+        return max(ndcError(nearCorner, aProjection, Vector3f(1.0f, 1.0f, aNearDepth)),
+                   ndcError(farCorner, aProjection, Vector3f(1.0f, 1.0f, aFarDepth)));
+    }
+}
+
+int TestProjection() {
+    K_INT failures = 0;
+    mt19937 generator(29);
+    uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+    const K_UINT caseCount = 10000;
+
+    // The eye lands on the view space origin, and the target straight ahead on +z.
+    {
+        double eyeError = 0.0;
+        double targetError = 0.0;
+        for (K_UINT i = 0; i < caseCount; ++i) {
+            const Vector3f eye(coordinate(generator), coordinate(generator), coordinate(generator));
+            const Vector3f target(coordinate(generator), coordinate(generator), coordinate(generator));
+            const Matrix4x4f view = Matrix4x4f::LookAt(eye, target, Vector3f(0.0f, 1.0f, 0.0f));
+            const double scale = max(1.0, static_cast<double>(eye.getMagnitude()) + target.getMagnitude());
+
+            const Vector4f origin = Vector4f(eye.x, eye.y, eye.z, 1.0f) * view;
+            eyeError = max(eyeError, max(fabs(origin.x), max(fabs(origin.y), fabs(origin.z))) / scale);
+
+            const Vector4f ahead = Vector4f(target.x, target.y, target.z, 1.0f) * view;
+            const float distance = (target - eye).getMagnitude();
+            targetError = max(targetError, max(fabs(ahead.x), max(fabs(ahead.y), fabs(ahead.z - distance))) / scale);
+        }
+        failures += ReportBound("LookAt eye to origin", eyeError, 1.0e-6);
+        failures += ReportBound("LookAt target on +z", targetError, 1.0e-6);
+    }
+
+    // Near and far planes land on their depths, and the frustum edges on the clip bounds.
+    {
+        double standardError = 0.0;
+        double reversedError = 0.0;
+        double infiniteError = 0.0;
+        double infiniteReversedError = 0.0;
+        for (K_UINT i = 0; i < caseCount; ++i) {
+            const Frustum frustum = randomFrustum(generator);
+            standardError = max(standardError, frustumError(frustum, Matrix4x4f::Perspective(frustum.fovY, frustum.aspect,
+                                                                                              frustum.nearPlane, frustum.farPlane), 0.0f, 1.0f));
+            reversedError = max(reversedError, frustumError(frustum, Matrix4x4f::PerspectiveReversedZ(frustum.fovY, frustum.aspect,
+                                                                                                       frustum.nearPlane, frustum.farPlane), 1.0f, 0.0f));
+
+            // With the far plane at infinity, depth at a finite far is near / far from its limit.
+            const float farDepth = frustum.nearPlane / frustum.farPlane;
+            infiniteError = max(infiniteError, frustumError(frustum, Matrix4x4f::PerspectiveInfinite(frustum.fovY, frustum.aspect,
+                                                                                                      frustum.nearPlane), 0.0f, 1.0f - farDepth));
+            infiniteReversedError = max(infiniteReversedError,
+                                        frustumError(frustum, Matrix4x4f::PerspectiveInfiniteReversedZ(frustum.fovY, frustum.aspect,
+                                                                                                        frustum.nearPlane), 1.0f, farDepth));
+        }
+        failures += ReportBound("Perspective near 0, far 1", standardError, 1.0e-5);
+        failures += ReportBound("PerspectiveReversedZ near 1, far 0", reversedError, 1.0e-5);
+        failures += ReportBound("PerspectiveInfinite near 0, far toward 1", infiniteError, 1.0e-5);
+        failures += ReportBound("PerspectiveInfiniteReversedZ near 1, far toward 0", infiniteReversedError, 1.0e-5);
+    }
+
+    // Opposite corners of the view volume land on opposite corners of clip space. A small
+    // volume far from the origin loses bits to cancellation, so errors are measured relative
+    // to how far off centre each volume is.
+    {
+        double orthographicError = 0.0;
+        for (K_UINT i = 0; i < caseCount; ++i) {
+            const float left = coordinate(generator);
+            const float right = left + 1.0f + fabsf(coordinate(generator));
+            const float bottom = coordinate(generator);
+            const float top = bottom + 1.0f + fabsf(coordinate(generator));
+            const float nearPlane = coordinate(generator);
+            const float farPlane = nearPlane + 1.0f + fabsf(coordinate(generator));
+            const Matrix4x4f projection = Matrix4x4f::Orthographic(left, right, bottom, top, nearPlane, farPlane);
+            const double offCentre = max(max((fabs(left) + fabs(right)) / (right - left), (fabs(bottom) + fabs(top)) / (top - bottom)),
+                                         (fabs(nearPlane) + fabs(farPlane)) / (farPlane - nearPlane));
+            const double error = max(ndcError(Vector3f(left, bottom, nearPlane), projection, Vector3f(-1.0f, -1.0f, 0.0f)),
+                                     ndcError(Vector3f(right, top, farPlane), projection, Vector3f(1.0f, 1.0f, 1.0f)));
+            orthographicError = max(orthographicError, error / max(1.0, offCentre));
+        }
+        failures += ReportBound("Orthographic corners", orthographicError, 1.0e-6);
+    }
+
+    // Depth precision: how many distinct depth values the far half of a 0.1 to 10000 range
+    // gets, standard against reversed-Z.
+    {
+        const float nearPlane = 0.1f;
+        const float farPlane = 10000.0f;
+        const Matrix4x4f standard = Matrix4x4f::Perspective(1.0f, 1.0f, nearPlane, farPlane);
+        const Matrix4x4f reversed = Matrix4x4f::PerspectiveReversedZ(1.0f, 1.0f, nearPlane, farPlane);
+        vector<float> standardDepths;
+        vector<float> reversedDepths;
+        for (float z = farPlane * 0.5f; z < farPlane; z += 1.0f) {
+            standardDepths.push_back(project(Vector3f(0.0f, 0.0f, z), standard).z);
+            reversedDepths.push_back(project(Vector3f(0.0f, 0.0f, z), reversed).z);
+        }
+        const size_t sampleCount = standardDepths.size();
+        sort(standardDepths.begin(), standardDepths.end());
+        sort(reversedDepths.begin(), reversedDepths.end());
+        const size_t standardDistinct = unique(standardDepths.begin(), standardDepths.end()) - standardDepths.begin();
+        const size_t reversedDistinct = unique(reversedDepths.begin(), reversedDepths.end()) - reversedDepths.begin();
+        failures += ReportCheck("Reversed-Z separates the far half", reversedDistinct > standardDistinct);
+        cout << "Far half depths, 1 unit apart: " << standardDistinct << " of " << sampleCount << " distinct, reversed-Z "
+             << reversedDistinct << endl;
+    }
+
+    // Camera setup speed.
+    {
+        const K_UINT cameraCount = 1000000;
+        high_resolution_clock::time_point start = high_resolution_clock::now();
+        float checksum = 0.0f;
+        for (K_UINT i = 0; i < cameraCount; ++i) {
+            const float offset = static_cast<float>(i & 1023);
+            const Matrix4x4f viewProjection = Matrix4x4f::LookAt(Vector3f(offset, 10.0f, -20.0f), Vector3f(offset, 0.0f, 0.0f),
+                                                                 Vector3f(0.0f, 1.0f, 0.0f)) *
+                                              Matrix4x4f::PerspectiveInfiniteReversedZ(1.0f, 1.5f, 0.1f);
+            checksum += viewProjection(3, 2);
+        }
+        const double seconds = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+        cout << "LookAt * Perspective: " << cameraCount / seconds / 1.0e6 << "M cameras/s (checksum " << checksum << ")" << endl;
+    }
+
+    return failures;
+}
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "RenderCommands.h"
+#include "TestUtilities.h"
+
+using namespace std;
+using namespace std::chrono;
+using namespace KhaosEngine;
+using namespace KhaosTesting;
+
+namespace
+{
+    const K_UINT MAX_LISTS = 8;
+    const K_UINT COMMANDS_PER_LIST = 20000;
+
+    struct Expected
+    {
+        KUI_64 key;
+        const RenderCommand* command;
+    };
+
+    // Records one list per entry of someKeys, sorts, and counts the sorted commands that differ
+    // from a stable sort of the same commands in acquisition then recording order.
+    KUI_64 countMisordered(RenderCommandBuffer& aBuffer, const vector<vector<KUI_64>>& someKeys) {
+        const RenderColor white = { 255, 255, 255, 255 };
+        vector<Expected> expected;
+        for (size_t l = 0; l < someKeys.size(); ++l) {
+            RenderCommandList* list = aBuffer.acquireList();
+            for (size_t i = 0; i < someKeys[l].size(); ++i) {
+                const RenderRect destination = { static_cast<K_INT>(i), static_cast<K_INT>(l), 1, 1 };
+                list->fillRect(someKeys[l][i], destination, white);
+            }
+            for (K_UINT i = 0; i < list->getCount(); ++i)
+                expected.push_back(Expected{ list->getCommands()[i].key, list->getCommands() + i });
+        }
+        stable_sort(expected.begin(), expected.end(), [](const Expected& a, const Expected& b) { return a.key < b.key; });
+
+        aBuffer.sort();
+        KUI_64 wrong = aBuffer.getSortedCount() != expected.size();
+        for (K_UINT i = 0; i < aBuffer.getSortedCount() && i < expected.size(); ++i)
+            wrong += &aBuffer.getSorted(i) != expected[i].command;
+        aBuffer.reset();
+        return wrong;
+    }
+
+    // Fills aListCount lists of aCount keys each from aMakeKey.
+    template <typename MakeKey>
+    vector<vector<KUI_64>> makeKeys(K_UINT aListCount, K_UINT aCount, MakeKey aMakeKey) {
+        vector<vector<KUI_64>> keys(aListCount);
+        for (K_UINT l = 0; l < aListCount; ++l) {
+            for (K_UINT i = 0; i < aCount; ++i)
+                keys[l].push_back(aMakeKey());
+        }
+        return keys;
+    }
+}
+
+int TestRenderCommands() {
+    K_INT failures = 0;
+    mt19937 generator(38);
+    RenderCommandBuffer buffer(MAX_LISTS, COMMANDS_PER_LIST);
+
+    // Random keys in every field need all eight radix passes.
+    {
+        const vector<vector<KUI_64>> keys = makeKeys(MAX_LISTS, 5000, [&]() {
+            return MakeRenderKey(static_cast<KUI_8>(generator()), generator() & 0xffffff, generator());
+        });
+        failures += ReportCount("Random keys sort like a stable sort", countMisordered(buffer, keys));
+    }
+
+    // Few distinct keys, so most commands tie with others in their own list and in other
+    // lists. Layer and depth are shared, so only the material's low digit gets a pass.
+    {
+        const vector<vector<KUI_64>> keys = makeKeys(MAX_LISTS, 5000, [&]() {
+            return MakeRenderKey(2, 1000, generator() % 5);
+        });
+        failures += ReportCount("Equal keys keep list and recording order", countMisordered(buffer, keys));
+    }
+
+    // Keys that differ only in the layer skip every pass but the last.
+    {
+        const vector<vector<KUI_64>> keys = makeKeys(MAX_LISTS, 5000, [&]() {
+            return MakeRenderKey(static_cast<KUI_8>(generator() % 3), 77, 12345);
+        });
+        failures += ReportCount("Layer-only keys sort in one pass", countMisordered(buffer, keys));
+    }
+
+    // Identical keys skip every pass and stay in recording order.
+    {
+        const vector<vector<KUI_64>> keys = makeKeys(3, 1000, []() { return MakeRenderKey(1, 5, 9); });
+        failures += ReportCount("Identical keys stay in order", countMisordered(buffer, keys));
+    }
+
+    // Lists past the limit come back null, commands past a list's capacity are dropped, both are
+    // counted and left out of the sort, and reset hands the lists out again.
+    {
+        const RenderColor black = { 0, 0, 0, 255 };
+        RenderCommandBuffer small(3, 4);
+        K_UINT acquired = 0;
+        K_UINT refused = 0;
+        for (K_UINT l = 0; l < 5; ++l) {
+            RenderCommandList* list = small.acquireList();
+            if (list == nullptr) {
+                ++refused;
+                continue;
+            }
+            ++acquired;
+            const K_UINT count = l == 0 ? 6 : 2;
+            for (K_UINT i = 0; i < count; ++i)
+                list->clear(MakeRenderKey(0, 0, l), black);
+        }
+        small.sort();
+        failures += ReportCheck("Lists past the limit are refused", acquired == 3 && refused == 2);
+        failures += ReportCheck("Refused lists are counted", small.getDroppedListCount() == 2);
+        failures += ReportCheck("Commands past a full list are counted", small.getDroppedCommandCount() == 2);
+        failures += ReportCheck("Sort skips refused lists and dropped commands", small.getSortedCount() == 8);
+
+        small.reset();
+        RenderCommandList* list = small.acquireList();
+        failures += ReportCheck("Reset empties and returns the lists", list != nullptr && list->getCount() == 0);
+        failures += ReportCheck("Reset clears the drop counts",
+                                list != nullptr && list->getDroppedCount() == 0 && small.getDroppedListCount() == 0);
+        small.sort();
+        failures += ReportCheck("Sort after reset sees only new commands", small.getSortedCount() == 0);
+    }
+
+    // Sort speed for a full buffer of typical keys: a few layers, varied depth, few materials.
+    {
+        const K_UINT frameCount = 50;
+        const RenderColor white = { 255, 255, 255, 255 };
+        KUI_64 checksum = 0;
+        double seconds = 0.0;
+        for (K_UINT frame = 0; frame < frameCount; ++frame) {
+            for (K_UINT l = 0; l < MAX_LISTS; ++l) {
+                RenderCommandList* list = buffer.acquireList();
+                for (K_UINT i = 0; i < COMMANDS_PER_LIST; ++i) {
+                    const RenderRect destination = { static_cast<K_INT>(i), 0, 1, 1 };
+                    list->fillRect(MakeRenderKey(static_cast<KUI_8>(1 + (generator() & 3)), generator() % 100000, generator() & 15),
+                                   destination, white);
+                }
+            }
+            const high_resolution_clock::time_point start = high_resolution_clock::now();
+            buffer.sort();
+            seconds += duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+            checksum += buffer.getSorted(buffer.getSortedCount() / 2).key;
+            buffer.reset();
+        }
+        const double commands = static_cast<double>(MAX_LISTS) * COMMANDS_PER_LIST * frameCount / 1.0e6;
+        cout << "RenderCommandBuffer::sort: " << commands / seconds << "M commands/s (checksum " << checksum << ")" << endl;
+    }
+
+    return failures;
+}
\ No newline at end of file
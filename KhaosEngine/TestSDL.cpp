@@ -1,5 +1,128 @@
 #include <SDL.h>
+#include <cmath>
 #include <iostream>
+#include <vector>
+
+#include "AudioMixer.h"
+#include "GameLoop.h"
+#include "RenderCommands.h"
+#include "TextureStreaming.h"
+
+using namespace KhaosEngine;
+using KhaosMath::PI;
+
+namespace
+{
+    const K_INT WINDOW_WIDTH = 700;
+    const K_INT WINDOW_HEIGHT = 500;
+    const K_INT SPRITE_SIZE = 96;
+
+    // Short decaying tone played when a sprite hits an edge.
+    AudioClip makeBounceClip(K_UINT aSampleRate) {
+        AudioClip clip;
+        clip.sampleRate = aSampleRate;
+        const K_UINT length = aSampleRate / 10;
+        for (K_UINT i = 0; i < length; ++i) {
+            const float time = static_cast<float>(i) / aSampleRate;
+            clip.samples.push_back(0.5f * sinf(2.0f * PI * 660.0f * time) * expf(-40.0f * time));
+        }
+        return clip;
+    }
+
+    // Sprites that bounce off the window edges while spinning about the view axis, with a
+    // sound from where they hit.
+    class BouncingSprites : public GameLoopClient
+    {
+    public:
+        BouncingSprites(GameLoop& aLoop, SDL_Renderer* aRenderer, TextureStreamer& aStreamer, TextureHandle aTexture,
+                        AudioMixer& aMixer, const AudioClip& aBounce, K_UINT aCount)
+            : mLoop(aLoop), mRenderer(aRenderer), mStreamer(aStreamer), mTexture(aTexture), mMixer(aMixer),
+              mBounce(aBounce), mCommands(1, aCount + 1) {
+            for (K_UINT i = 0; i < aCount; ++i) {
+                mPositions.push_back(Vector3f(40.0f + 70.0f * i, 30.0f + 45.0f * i, 0.0f));
+                mVelocities.push_back(Vector3f(120.0f + 25.0f * i, 90.0f - 20.0f * i, 0.0f));
+                mRotations.push_back(Quaternion(0.0f, 0.0f, 0.0f, 1.0f));
+                mSpins.push_back(0.5f + 0.4f * i);
+            }
+        }
+
+        void simulate(float aTimeStep) override {
+            const float maxX = static_cast<float>(WINDOW_WIDTH - SPRITE_SIZE);
+            const float maxY = static_cast<float>(WINDOW_HEIGHT - SPRITE_SIZE);
+            for (size_t i = 0; i < mPositions.size(); ++i) {
+                Vector3f& position = mPositions[i];
+                Vector3f& velocity = mVelocities[i];
+                position.addScaled(velocity, aTimeStep);
+                bool bounced = false;
+                if (position.x < 0.0f || position.x > maxX) {
+                    position.x = KhaosMath::ClampInclusive(position.x, 0.0f, maxX);
+                    velocity.x = -velocity.x;
+                    bounced = true;
+                }
+                if (position.y < 0.0f || position.y > maxY) {
+                    position.y = KhaosMath::ClampInclusive(position.y, 0.0f, maxY);
+                    velocity.y = -velocity.y;
+                    bounced = true;
+                }
+                if (bounced) {
+                    AudioVoiceSettings voiceSettings;
+                    voiceSettings.pitch = 0.75f + 0.125f * i;
+                    const float centre = 0.5f * SPRITE_SIZE;
+                    mMixer.play(mBounce, Vector3f(position.x + centre, position.y + centre, 0.0f), voiceSettings);
+                }
+
+                const float halfAngle = 0.5f * mSpins[i] * aTimeStep;
+                const Quaternion spun = mRotations[i] * Quaternion(0.0f, 0.0f, sinf(halfAngle), cosf(halfAngle));
+                mRotations[i] = spun * (1.0f / spun.getMagnitude());
+            }
+        }
+
+        void capture(FrameState& aState) override {
+            aState.positions = mPositions;
+            aState.rotations = mRotations;
+        }
+
+        void render(const FrameState& aState) override {
+            SDL_Event event;
+            while (SDL_PollEvent(&event)) {
+                if (event.type == SDL_QUIT)
+                    mLoop.stop();
+            }
+
+            RenderCommandList* list = mCommands.acquireList();
+            const RenderColor black = { 0, 0, 0, 255 };
+            list->clear(MakeRenderKey(0, 0, 0), black);
+            // Nothing to draw until the first load finishes.
+            SDL_Texture* texture = mStreamer.use(mTexture, static_cast<float>(SPRITE_SIZE));
+            for (size_t i = 0; texture && i < aState.positions.size(); ++i) {
+                const Quaternion& rotation = aState.rotations[i];
+                const float degrees = 2.0f * atan2f(rotation.z, rotation.w) * 180.0f / PI;
+                const RenderRect destination = { static_cast<K_INT>(aState.positions[i].x), static_cast<K_INT>(aState.positions[i].y),
+                                                 SPRITE_SIZE, SPRITE_SIZE };
+                list->drawTexture(MakeRenderKey(1, static_cast<KUI_32>(i), 0), texture, nullptr, destination, degrees);
+            }
+
+            mCommands.sort();
+            ReplayOnSdl(mCommands, mRenderer);
+            SDL_RenderPresent(mRenderer);
+            mCommands.reset();
+            mStreamer.update();
+        }
+
+    private:
+        GameLoop& mLoop;
+        SDL_Renderer* mRenderer;
+        TextureStreamer& mStreamer;
+        TextureHandle mTexture;
+        AudioMixer& mMixer; // Played from the simulation thread only.
+        const AudioClip& mBounce;
+        RenderCommandBuffer mCommands;
+        std::vector<Vector3f> mPositions;
+        std::vector<Vector3f> mVelocities;
+        std::vector<Quaternion> mRotations;
+        std::vector<float> mSpins;
+    };
+}
 
 void printSDLError() {
     std::cout << "SDL_Init error: " << SDL_GetError() << std::endl;
@@ -8,11 +131,11 @@ void printSDLError() {
 
 int main(int argc, char ** argv)
 {
-    if (SDL_Init(SDL_INIT_VIDEO) != 0)
+    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) != 0)
         printSDLError();
 
     // Create a window to draw into.
-    SDL_Window* aWindow = SDL_CreateWindow("Hello World!", 500, 50, 700, 500, SDL_WINDOW_SHOWN);
+    SDL_Window* aWindow = SDL_CreateWindow("Hello World!", 500, 50, WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_SHOWN);
     if (!aWindow) {
         printSDLError();
 
@@ -30,36 +153,35 @@ int main(int argc, char ** argv)
         return 1;
     }
 
-    // Load a file as a surface.
-    std::string filePath = std::string(SDL_GetBasePath()) + "hello.bmp";
-    SDL_Surface* aSurface = SDL_LoadBMP(filePath.c_str());
-    if (!aSurface) {
-        printSDLError();
-        SDL_DestroyRenderer(aRenderer);
-        SDL_DestroyWindow(aWindow);
-        SDL_Quit();
-        return 1;
-    }
+    // Stream the sprite texture in the background instead of loading it before the first frame.
+    // The streamer goes out of scope, destroying its textures, before the renderer does.
+    {
+        SdlTextureBackend aBackend(aRenderer);
+        TextureStreamer aStreamer(aBackend, TextureStreamingSettings());
+        const TextureHandle aTexture = aStreamer.addTexture(std::string(SDL_GetBasePath()) + "hello.bmp");
 
-    // Turn that surface into a texture.
-    SDL_Texture* aTexture = SDL_CreateTextureFromSurface(aRenderer, aSurface);
-    SDL_FreeSurface(aSurface);
+        // Mix bounce sounds in window pixels, heard from in front of the middle of the window.
+        // Without an audio device the demo carries on silently.
+        AudioMixerSettings audioSettings;
+        audioSettings.referenceDistance = 400.0f;
+        audioSettings.maxDistance = 2000.0f;
+        AudioMixer aMixer(audioSettings);
+        aMixer.setListener(Vector3f(0.5f * WINDOW_WIDTH, 0.5f * WINDOW_HEIGHT, -400.0f), Quaternion(0.0f, 0.0f, 0.0f, 1.0f));
+        const AudioClip aBounce = makeBounceClip(audioSettings.sampleRate);
+        SdlAudioOutput anAudioOutput(aMixer);
+        if (!anAudioOutput.open(512))
+            std::cout << "SDL audio error: " << SDL_GetError() << std::endl;
 
-    if (!aTexture) {
-        SDL_DestroyRenderer(aRenderer);
-        SDL_DestroyWindow(aWindow);
-        printSDLError();
-        SDL_Quit();
-        return 1;
-    }
-
-    SDL_RenderClear(aRenderer);
-    SDL_RenderCopy(aRenderer, aTexture, nullptr, nullptr);
-    SDL_RenderPresent(aRenderer);
+        // Simulate at 60 Hz on a second thread and render here until the window is closed.
+        const GameLoopSettings settings = { 1.0f / 60.0f, 8 };
+        GameLoop loop(settings);
+        BouncingSprites sprites(loop, aRenderer, aStreamer, aTexture, aMixer, aBounce, 5);
+        loop.run(sprites);
 
-    SDL_Delay(2000);
+        if (aStreamer.getStats().failedCount)
+            printSDLError();
+    }
 
-    SDL_DestroyTexture(aTexture);
     SDL_DestroyRenderer(aRenderer);
     SDL_DestroyWindow(aWindow);
 
@@ -0,0 +1,250 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "KhaosMath.h"
+#include "LinearAllocator.h"
+#include "Skinning.h"
+#include "TestUtilities.h"
+
+using namespace std;
+using namespace std::chrono;
+using namespace KhaosMath;
+using namespace KhaosEngine;
+using namespace KhaosTesting;
+
+namespace
+{
+    const K_UINT BONE_COUNT = 24;
+    const K_UINT VERTEX_COUNT = 4099; // Not a multiple of four, so the last group is partial.
+
+    // Owns the streams behind a SkinningInput or SkinningOutput.
+    struct VertexStreams
+    {
+        vector<float> positions[3];
+        vector<float> normals[3];
+
+        explicit VertexStreams(K_UINT aVertexCount) {
+            for (K_INT c = 0; c < 3; ++c) {
+                positions[c].assign(aVertexCount, 0.0f);
+                normals[c].assign(aVertexCount, 0.0f);
+            }
+        }
+
+        SkinningOutput getOutput() {
+            SkinningOutput output = { { positions[0].data(), positions[1].data(), positions[2].data() },
+                                      { normals[0].data(), normals[1].data(), normals[2].data() } };
+            return output;
+        }
+
+        Vector3f getPosition(K_UINT aVertex) const {
+            return Vector3f(positions[0][aVertex], positions[1][aVertex], positions[2][aVertex]);
+        }
+
+        Vector3f getNormal(K_UINT aVertex) const {
+            return Vector3f(normals[0][aVertex], normals[1][aVertex], normals[2][aVertex]);
+        }
+    };
+
+    float maxDifference(const Vector3f& aVector, const Vector3f& bVector) {
+        return max(fabsf(aVector.x - bVector.x), max(fabsf(aVector.y - bVector.y), fabsf(aVector.z - bVector.z)));
+    }
+
+    // Counts vertices whose positions or normals differ at all between two skinned outputs.
+    KUI_64 countMismatches(const VertexStreams& aFirst, const VertexStreams& aSecond) {
+        KUI_64 mismatches = 0;
+        for (K_UINT vertex = 0; vertex < VERTEX_COUNT; ++vertex) {
+            if (maxDifference(aFirst.getPosition(vertex), aSecond.getPosition(vertex)) != 0.0f ||
+                maxDifference(aFirst.getNormal(vertex), aSecond.getNormal(vertex)) != 0.0f)
+                ++mismatches;
+        }
+        return mismatches;
+    }
+
+    // Transforms aVector by aMatrix as a row vector with the given w.
+    Vector3f transform(const Matrix4x4f& aMatrix, const Vector3f& aVector, float aW) {
+        const Vector4f result = Vector4f(aVector.x, aVector.y, aVector.z, aW) * aMatrix;
+        return Vector3f(result.x, result.y, result.z);
+    }
+}
+
+int TestSkinning() {
+    K_INT failures = 0;
+    mt19937 generator(11);
+    uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+
+    // A branching skeleton: each bone hangs off a random earlier one.
+    LinearAllocator arena(1 << 16);
+    LocalPose pose = LocalPose::Allocate(arena, BONE_COUNT);
+    K_INT parents[BONE_COUNT];
+    vector<Matrix4x4f> inverseBind(BONE_COUNT);
+    for (K_UINT bone = 0; bone < BONE_COUNT; ++bone) {
+        parents[bone] = bone == 0 ? -1 : static_cast<K_INT>(generator() % bone);
+        pose.translations[bone] = Vector3f(coordinate(generator), coordinate(generator), coordinate(generator));
+        pose.rotations[bone] = RandomRotation(generator);
+        pose.scales[bone] = Vector3f(1.0f, 1.0f, 1.0f);
+        inverseBind[bone] = Matrix4x4f::TRS(Vector3f(coordinate(generator), coordinate(generator), coordinate(generator)),
+                                            RandomRotation(generator), Vector3f(1.0f, 1.0f, 1.0f));
+    }
+
+    vector<Matrix4x4f> world(BONE_COUNT);
+    ComputeWorldTransforms(pose, parents, world.data());
+    vector<Matrix4x4f> skinning(BONE_COUNT);
+    for (K_UINT bone = 0; bone < BONE_COUNT; ++bone)
+        skinning[bone] = inverseBind[bone] * world[bone];
+
+    vector<AffineMatrix3x4f> palette(BONE_COUNT);
+    vector<DualQuaternion> dualPalette(BONE_COUNT);
+    BuildSkinningPalette(world.data(), inverseBind.data(), BONE_COUNT, palette.data());
+    BuildDualQuaternionPalette(world.data(), inverseBind.data(), BONE_COUNT, dualPalette.data());
+
+    // Palettes match the scalar product of inverse bind and world transforms.
+    {
+        float paletteError = 0.0f;
+        float dualError = 0.0f;
+        for (K_UINT bone = 0; bone < BONE_COUNT; ++bone) {
+            const AffineMatrix3x4f expected(skinning[bone]);
+            for (K_INT row = 0; row < 3; ++row) {
+                for (K_INT col = 0; col < 4; ++col)
+                    paletteError = max(paletteError, fabsf(palette[bone].elem[row][col] - expected.elem[row][col]));
+            }
+            const Vector3f point(coordinate(generator), coordinate(generator), coordinate(generator));
+            dualError = max(dualError, maxDifference(dualPalette[bone].transformPoint(point), transform(skinning[bone], point, 1.0f)));
+        }
+        failures += ReportBound("Linear blend palette", paletteError, 1e-5);
+        failures += ReportBound("Dual quaternion palette", dualError, 1e-4);
+    }
+
+    // Vertices with up to four influences; every fourth one is bound rigidly to a single bone.
+    VertexStreams source(VERTEX_COUNT);
+    vector<KUI_16> indices[4];
+    vector<float> weights[4];
+    for (K_INT influence = 0; influence < 4; ++influence) {
+        indices[influence].resize(VERTEX_COUNT);
+        weights[influence].resize(VERTEX_COUNT);
+    }
+    for (K_UINT vertex = 0; vertex < VERTEX_COUNT; ++vertex) {
+        Vector3f normal(coordinate(generator), coordinate(generator), coordinate(generator));
+        normal = normal / max(normal.getMagnitude(), 1e-3f);
+        for (K_INT c = 0; c < 3; ++c)
+            source.positions[c][vertex] = 2.0f * coordinate(generator);
+        source.normals[0][vertex] = normal.x;
+        source.normals[1][vertex] = normal.y;
+        source.normals[2][vertex] = normal.z;
+
+        const bool rigid = vertex % 4 == 0;
+        float total = 0.0f;
+        for (K_INT influence = 0; influence < 4; ++influence) {
+            indices[influence][vertex] = static_cast<KUI_16>(generator() % BONE_COUNT);
+            weights[influence][vertex] = rigid ? (influence == 0 ? 1.0f : 0.0f) : fabsf(coordinate(generator)) + 0.01f;
+            total += weights[influence][vertex];
+        }
+        for (K_INT influence = 0; influence < 4; ++influence)
+            weights[influence][vertex] /= total;
+    }
+    SkinningInput input = { { source.positions[0].data(), source.positions[1].data(), source.positions[2].data() },
+                            { source.normals[0].data(), source.normals[1].data(), source.normals[2].data() },
+                            { indices[0].data(), indices[1].data(), indices[2].data(), indices[3].data() },
+                            { weights[0].data(), weights[1].data(), weights[2].data(), weights[3].data() },
+                            VERTEX_COUNT };
+
+    const K_UINT threadCount = max(2u, thread::hardware_concurrency());
+
+    // Linear blend skinning matches blending the full matrices in scalar code.
+    {
+        VertexStreams serial(VERTEX_COUNT);
+        VertexStreams parallel(VERTEX_COUNT);
+        SkinLinear(palette.data(), input, serial.getOutput(), 0, VERTEX_COUNT);
+        SkinLinearParallel(palette.data(), input, parallel.getOutput(), threadCount);
+
+        float positionError = 0.0f;
+        float normalError = 0.0f;
+        for (K_UINT vertex = 0; vertex < VERTEX_COUNT; ++vertex) {
+            Matrix4x4f blended = skinning[0] * 0.0f;
+            for (K_INT influence = 0; influence < 4; ++influence)
+                blended += skinning[indices[influence][vertex]] * weights[influence][vertex];
+            const Vector3f position = transform(blended, source.getPosition(vertex), 1.0f);
+            Vector3f normal = transform(blended, source.getNormal(vertex), 0.0f);
+            normal = normal / normal.getMagnitude();
+            positionError = max(positionError, maxDifference(serial.getPosition(vertex), position));
+            normalError = max(normalError, maxDifference(serial.getNormal(vertex), normal));
+        }
+        failures += ReportBound("Linear blend positions", positionError, 1e-4);
+        failures += ReportBound("Linear blend normals", normalError, 1e-4);
+        failures += ReportCount("Linear blend parallel matches serial", countMismatches(serial, parallel));
+    }
+
+    // Dual quaternion skinning matches a scalar dual quaternion blend, and rigidly bound
+    // vertices match their bone's matrix.
+    {
+        VertexStreams serial(VERTEX_COUNT);
+        VertexStreams parallel(VERTEX_COUNT);
+        SkinDualQuaternion(dualPalette.data(), input, serial.getOutput(), 0, VERTEX_COUNT);
+        SkinDualQuaternionParallel(dualPalette.data(), input, parallel.getOutput(), threadCount);
+
+        float blendError = 0.0f;
+        float rigidError = 0.0f;
+        for (K_UINT vertex = 0; vertex < VERTEX_COUNT; ++vertex) {
+            const Quaternion& pivot = dualPalette[indices[0][vertex]].real;
+            DualQuaternion blended = dualPalette[0] * 0.0f;
+            for (K_INT influence = 0; influence < 4; ++influence) {
+                const DualQuaternion& bone = dualPalette[indices[influence][vertex]];
+                const float weight = weights[influence][vertex];
+                blended = blended + bone * (pivot.dot(bone.real) < 0.0f ? -weight : weight);
+            }
+            blended = blended.getNormalized();
+            const Vector3f position = source.getPosition(vertex);
+            const Vector3f normal = source.getNormal(vertex);
+            blendError = max(blendError, maxDifference(serial.getPosition(vertex), blended.transformPoint(position)));
+            blendError = max(blendError, maxDifference(serial.getNormal(vertex), blended.transformVector(normal)));
+
+            if (vertex % 4 == 0) {
+                const Matrix4x4f& bone = skinning[indices[0][vertex]];
+                rigidError = max(rigidError, maxDifference(serial.getPosition(vertex), transform(bone, position, 1.0f)));
+                rigidError = max(rigidError, maxDifference(serial.getNormal(vertex), transform(bone, normal, 0.0f)));
+            }
+        }
+        failures += ReportBound("Dual quaternion blend", blendError, 1e-4);
+        failures += ReportBound("Dual quaternion rigid vertices", rigidError, 1e-4);
+        failures += ReportCount("Dual quaternion parallel matches serial", countMismatches(serial, parallel));
+    }
+
+    // Skinning speed, serial and spread over the worker pool.
+    {
+        const K_UINT passes = 200;
+        VertexStreams output(VERTEX_COUNT);
+        const SkinningOutput streams = output.getOutput();
+        float checksum = 0.0f;
+
+        high_resolution_clock::time_point start = high_resolution_clock::now();
+        for (K_UINT pass = 0; pass < passes; ++pass) {
+            SkinLinear(palette.data(), input, streams, 0, VERTEX_COUNT);
+            checksum += output.positions[0][pass % VERTEX_COUNT];
+        }
+        const double linearSeconds = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+
+        start = high_resolution_clock::now();
+        for (K_UINT pass = 0; pass < passes; ++pass) {
+            SkinDualQuaternion(dualPalette.data(), input, streams, 0, VERTEX_COUNT);
+            checksum += output.positions[0][pass % VERTEX_COUNT];
+        }
+        const double dualSeconds = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+
+        start = high_resolution_clock::now();
+        for (K_UINT pass = 0; pass < passes; ++pass) {
+            SkinLinearParallel(palette.data(), input, streams, threadCount);
+            checksum += output.positions[0][pass % VERTEX_COUNT];
+        }
+        const double parallelSeconds = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+
+        const double vertices = static_cast<double>(VERTEX_COUNT) * passes / 1.0e6;
+        cout << "Linear blend: " << vertices / linearSeconds << "M vertices/s, dual quaternion: " << vertices / dualSeconds
+             << "M vertices/s, linear blend on " << threadCount << " chunks: " << vertices / parallelSeconds
+             << "M vertices/s (checksum " << checksum << ")" << endl;
+    }
+
+    return failures;
+}
\ No newline at end of file
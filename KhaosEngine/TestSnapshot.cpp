@@ -0,0 +1,168 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include "KhaosMath.h"
+#include "Snapshot.h"
+#include "TestUtilities.h"
+
+using namespace std;
+using namespace std::chrono;
+using namespace KhaosMath;
+using namespace KhaosEngine;
+using namespace KhaosTesting;
+
+namespace
+{
+    // Returns the seconds taken by aPasses calls of aKernel.
+    template <typename Kernel>
+    double timeSeconds(K_INT aPasses, Kernel aKernel) {
+        const high_resolution_clock::time_point start = high_resolution_clock::now();
+        for (K_INT pass = 0; pass < aPasses; ++pass)
+            aKernel();
+        return duration_cast<duration<double>>(high_resolution_clock::now() - start).count() / aPasses;
+    }
+
+    void reportThroughput(const char* aName, size_t aBytes, size_t anEntities, double aSeconds) {
+        cout << aName << ": " << aBytes << " bytes, " << static_cast<double>(aBytes) / anEntities << " bytes per entity, "
+             << aBytes / aSeconds / 1.0e6 << " MB/s, " << anEntities / aSeconds / 1.0e6 << "M entities/s" << endl;
+    }
+}
+
+// Round trips transforms through quantized and delta encoded snapshots, then compares the
+// throughput of full and delta snapshots against writing every field through an iostream.
+// Returns the number of failed checks.
+int TestSnapshot() {
+    K_INT failures = 0;
+    const K_UINT count = 10001; // Not a multiple of four so the scalar tails run too.
+    mt19937 generator(99);
+    uniform_real_distribution<float> coordinate(-1000.0f, 1000.0f);
+
+    SnapshotQuantization quantization;
+    quantization.minimum = Vector3f(-1024.0f, -1024.0f, -1024.0f);
+    quantization.maximum = Vector3f(1024.0f, 1024.0f, 1024.0f);
+    quantization.positionBits = 20;
+    const double gridStep = 2048.0 / ((1 << 20) - 1);
+
+    vector<Vector3f> positions(count);
+    vector<Quaternion> rotations(count);
+    for (K_UINT i = 0; i < count; ++i) {
+        positions[i] = Vector3f(coordinate(generator), coordinate(generator), coordinate(generator));
+        rotations[i] = RandomRotation(generator);
+    }
+
+    // Lossless primitives, and aligned bytes read in place.
+    {
+        KUI_8 buffer[256];
+        BitWriter writer(buffer, sizeof(buffer));
+        writer.writeBits(5, 3);
+        writer.writeVector3f(positions[0]);
+        writer.writeQuaternion(rotations[0]);
+        writer.writeMatrix4x4f(Matrix4x4f::Identity());
+        writer.writeAlignedBytes("khaos", 5);
+        writer.writeBool(true);
+        writer.flush();
+
+        BitReader reader(buffer, writer.getByteCount());
+        const bool header = reader.readBits(3) == 5;
+        const bool vector = reader.readVector3f() == positions[0];
+        const bool quat = reader.readQuaternion() == rotations[0];
+        const bool matrix = reader.readMatrix4x4f() == Matrix4x4f::Identity();
+        const KUI_8* bytes = reader.readAlignedBytes(5);
+        const bool inPlace = bytes == buffer + (3 + 32 * (3 + 4 + 16) + 7) / 8 && memcmp(bytes, "khaos", 5) == 0;
+        const bool tail = reader.readBool() && !reader.hasOverflowed();
+        reader.readBits(32);
+        failures += ReportCheck("BitStream round trip", header && vector && quat && matrix && inPlace && tail);
+        failures += ReportCheck("BitStream overflow", reader.hasOverflowed());
+    }
+
+    // Quantized round trip.
+    TransformSnapshot baseline;
+    CaptureSnapshot(quantization, positions.data(), rotations.data(), count, baseline);
+    vector<Vector3f> restoredPositions(count);
+    vector<Quaternion> restoredRotations(count);
+    RestoreSnapshot(quantization, baseline, restoredPositions.data(), restoredRotations.data());
+    double positionError = 0.0;
+    for (K_UINT i = 0; i < count; ++i)
+        positionError = max(positionError, static_cast<double>((restoredPositions[i] - positions[i]).getMagnitude()));
+    failures += ReportBound("Snapshot positions", positionError, gridStep);
+
+    // Move a tenth of the entities a little and a few a long way.
+    vector<Vector3f> moved(positions);
+    vector<Quaternion> turned(rotations);
+    uniform_real_distribution<float> nudge(-0.05f, 0.05f);
+    for (K_UINT i = 0; i < count; i += 10) {
+        moved[i] += Vector3f(nudge(generator), nudge(generator), nudge(generator));
+        if (i % 100 == 0) {
+            moved[i] = Vector3f(coordinate(generator), coordinate(generator), coordinate(generator));
+            turned[i] = RandomRotation(generator);
+        }
+    }
+    TransformSnapshot current;
+    CaptureSnapshot(quantization, moved.data(), turned.data(), count, current);
+
+    vector<KUI_8> buffer(count * 64);
+    BitWriter deltaWriter(buffer.data(), buffer.size());
+    WriteSnapshot(deltaWriter, quantization, current, &baseline);
+    deltaWriter.flush();
+    const size_t deltaBytes = deltaWriter.getByteCount();
+
+    TransformSnapshot decoded;
+    BitReader deltaReader(buffer.data(), deltaBytes);
+    const bool deltaRead = ReadSnapshot(deltaReader, quantization, &baseline, decoded);
+    const bool deltaExact = deltaRead && decoded.positions == current.positions && decoded.getCount() == count &&
+                            memcmp(decoded.rotations.data(), current.rotations.data(), count * sizeof(PackedQuaternion32)) == 0;
+    failures += ReportCheck("Snapshot delta round trip", deltaExact);
+
+    BitReader truncatedReader(buffer.data(), deltaBytes / 2);
+    failures += ReportCheck("Snapshot truncated stream rejected",
+                            !ReadSnapshot(truncatedReader, quantization, &baseline, decoded));
+
+    // Benchmark.
+    const K_INT passes = 50;
+    size_t streamBytes = 0;
+    const double streamTime = timeSeconds(passes, [&] {
+        ostringstream stream(ios::binary);
+        for (K_UINT i = 0; i < count; ++i) {
+            stream.write(reinterpret_cast<const char*>(&moved[i].x), sizeof(float));
+            stream.write(reinterpret_cast<const char*>(&moved[i].y), sizeof(float));
+            stream.write(reinterpret_cast<const char*>(&moved[i].z), sizeof(float));
+            stream.write(reinterpret_cast<const char*>(&turned[i].x), sizeof(float));
+            stream.write(reinterpret_cast<const char*>(&turned[i].y), sizeof(float));
+            stream.write(reinterpret_cast<const char*>(&turned[i].z), sizeof(float));
+            stream.write(reinterpret_cast<const char*>(&turned[i].w), sizeof(float));
+        }
+        streamBytes = stream.str().size();
+    });
+    reportThroughput("iostream fields", streamBytes, count, streamTime);
+
+    size_t fullBytes = 0;
+    const double fullTime = timeSeconds(passes, [&] {
+        CaptureSnapshot(quantization, moved.data(), turned.data(), count, current);
+        BitWriter writer(buffer.data(), buffer.size());
+        WriteSnapshot(writer, quantization, current, nullptr);
+        writer.flush();
+        fullBytes = writer.getByteCount();
+    });
+    reportThroughput("Full snapshot, capture and write", fullBytes, count, fullTime);
+
+    const double deltaTime = timeSeconds(passes, [&] {
+        CaptureSnapshot(quantization, moved.data(), turned.data(), count, current);
+        BitWriter writer(buffer.data(), buffer.size());
+        WriteSnapshot(writer, quantization, current, &baseline);
+        writer.flush();
+    });
+    reportThroughput("Delta snapshot, capture and write", deltaBytes, count, deltaTime);
+
+    const double readTime = timeSeconds(passes, [&] {
+        BitReader reader(buffer.data(), deltaBytes);
+        ReadSnapshot(reader, quantization, &baseline, decoded);
+        RestoreSnapshot(quantization, decoded, restoredPositions.data(), restoredRotations.data());
+    });
+    reportThroughput("Delta snapshot, read and restore", deltaBytes, count, readTime);
+
+    return failures;
+}
\ No newline at end of file
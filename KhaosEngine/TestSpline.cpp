@@ -0,0 +1,249 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "KhaosMath.h"
+#include "Spline.h"
+#include "TestUtilities.h"
+
+using namespace std;
+using namespace std::chrono;
+using namespace KhaosMath;
+using namespace KhaosTesting;
+
+namespace
+{
+    // Reference Bezier point by repeated lerps, the way curves were evaluated before Spline.h.
+    Vector3f deCasteljau(const Vector3f* somePoints, float t) {
+        const Vector3f ab = Vector3f::Lerp(somePoints[0], somePoints[1], t);
+        const Vector3f bc = Vector3f::Lerp(somePoints[1], somePoints[2], t);
+        const Vector3f cd = Vector3f::Lerp(somePoints[2], somePoints[3], t);
+        const Vector3f abc = Vector3f::Lerp(ab, bc, t);
+        const Vector3f bcd = Vector3f::Lerp(bc, cd, t);
+        return Vector3f::Lerp(abc, bcd, t);
+    }
+
+    // Angle in radians between two unit rotations.
+    float rotationAngle(const Quaternion& aQuat, const Quaternion& bQuat) {
+        return 2.0f * acosf(min(fabsf(aQuat.dot(bQuat)), 1.0f));
+    }
+}
+
+int TestSpline() {
+    K_INT failures = 0;
+    mt19937 generator(42);
+    uniform_real_distribution<float> coordinate(-10.0f, 10.0f);
+
+    const K_UINT pointCount = 9;
+    vector<Vector3f> points(pointCount);
+    for (Vector3f& point : points)
+        point = Vector3f(coordinate(generator), coordinate(generator), coordinate(generator));
+
+    // Catmull-Rom passes through every point, and neighbouring segments share tangents.
+    {
+        CubicSpline3f spline;
+        spline.setCatmullRom(points.data(), pointCount);
+        double interpolation = 0.0;
+        double continuity = 0.0;
+        for (K_UINT i = 0; i < pointCount; ++i)
+            interpolation = max(interpolation, static_cast<double>((spline.evaluate(static_cast<float>(i)) - points[i]).getMagnitude()));
+        for (K_UINT i = 1; i + 1 < pointCount; ++i) {
+            const float key = static_cast<float>(i);
+            continuity = max(continuity, static_cast<double>((spline.evaluateTangent(key - 1.0e-5f) -
+                                                              spline.evaluateTangent(key + 1.0e-5f)).getMagnitude()));
+        }
+        failures += ReportBound("Catmull-Rom through points", interpolation, 1.0e-5);
+        failures += ReportBound("Catmull-Rom tangent continuity", continuity, 1.0e-2);
+    }
+
+    // Bezier matches de Casteljau, and Hermite ends match their tangents.
+    {
+        CubicSpline3f spline;
+        spline.setBezier(points.data(), (pointCount - 1) / 3);
+        double error = 0.0;
+        uniform_real_distribution<float> parameter(0.0f, static_cast<float>(spline.getSegmentCount()));
+        for (K_UINT i = 0; i < 1000; ++i) {
+            const float u = parameter(generator);
+            const K_UINT segment = min(static_cast<K_UINT>(u), spline.getSegmentCount() - 1);
+            const Vector3f expected = deCasteljau(&points[segment * 3], u - static_cast<float>(segment));
+            error = max(error, static_cast<double>((spline.evaluate(u) - expected).getMagnitude()));
+        }
+        failures += ReportBound("Bezier matches de Casteljau", error, 1.0e-4);
+
+        vector<Vector3f> tangents(pointCount);
+        for (Vector3f& tangent : tangents)
+            tangent = Vector3f(coordinate(generator), coordinate(generator), coordinate(generator));
+        spline.setHermite(points.data(), tangents.data(), pointCount);
+        double hermite = 0.0;
+        for (K_UINT i = 0; i < pointCount; ++i) {
+            const float key = static_cast<float>(i);
+            hermite = max(hermite, static_cast<double>((spline.evaluate(key) - points[i]).getMagnitude()));
+            hermite = max(hermite, static_cast<double>((spline.evaluateTangent(key) - tangents[i]).getMagnitude()));
+        }
+        failures += ReportBound("Hermite points and tangents", hermite, 1.0e-4);
+    }
+
+    // Batches match single evaluation, including clamped parameters and a partial last group,
+    // and tangents match finite differences.
+    {
+        CubicSpline3f spline;
+        spline.setCatmullRom(points.data(), pointCount);
+        const K_UINT count = 1003;
+        uniform_real_distribution<float> parameter(-0.5f, static_cast<float>(spline.getSegmentCount()) + 0.5f);
+        vector<float> parameters(count);
+        for (float& u : parameters)
+            u = parameter(generator);
+        vector<Vector3f> positions(count);
+        vector<Vector3f> tangents(count);
+        spline.evaluate(parameters.data(), positions.data(), tangents.data(), count);
+
+        double batch = 0.0;
+        double difference = 0.0;
+        const float step = 1.0e-3f;
+        for (K_UINT i = 0; i < count; ++i) {
+            batch = max(batch, static_cast<double>((positions[i] - spline.evaluate(parameters[i])).getMagnitude()));
+            batch = max(batch, static_cast<double>((tangents[i] - spline.evaluateTangent(parameters[i])).getMagnitude()));
+            // Stay inside one segment so the central difference is smooth.
+            const float local = parameters[i] - floorf(parameters[i]);
+            if (parameters[i] > 0.0f && parameters[i] < spline.getSegmentCount() && local > step && local < 1.0f - step) {
+                const Vector3f estimate = (spline.evaluate(parameters[i] + step) - spline.evaluate(parameters[i] - step)) / (2.0f * step);
+                difference = max(difference, static_cast<double>((estimate - tangents[i]).getMagnitude() /
+                                                                  max(1.0f, tangents[i].getMagnitude())));
+            }
+        }
+        failures += ReportBound("Batch matches single", batch, 1.0e-4);
+        failures += ReportBound("Tangent matches finite difference", difference, 5.0e-2);
+
+        CubicSpline2f flat;
+        vector<Vector2f> flatPoints(pointCount);
+        for (K_UINT i = 0; i < pointCount; ++i)
+            flatPoints[i] = Vector2f(points[i].x, points[i].y);
+        flat.setCatmullRom(flatPoints.data(), pointCount);
+        vector<Vector2f> flatPositions(count);
+        flat.evaluate(parameters.data(), flatPositions.data(), nullptr, count);
+        double flatError = 0.0;
+        for (K_UINT i = 0; i < count; ++i) {
+            const Vector3f expected = spline.evaluate(parameters[i]);
+            flatError = max(flatError, static_cast<double>((flatPositions[i] - Vector2f(expected.x, expected.y)).getMagnitude()));
+        }
+        failures += ReportBound("Vector2f batch matches Vector3f", flatError, 1.0e-4);
+    }
+
+    // A circle of four quarter arcs has a known length, and even distances give even spacing.
+    {
+        const float radius = 5.0f;
+        const float handle = radius * 0.5522847f;
+        const Vector3f circle[13] = {
+            Vector3f(radius, 0, 0), Vector3f(radius, handle, 0), Vector3f(handle, radius, 0), Vector3f(0, radius, 0),
+            Vector3f(-handle, radius, 0), Vector3f(-radius, handle, 0), Vector3f(-radius, 0, 0),
+            Vector3f(-radius, -handle, 0), Vector3f(-handle, -radius, 0), Vector3f(0, -radius, 0),
+            Vector3f(handle, -radius, 0), Vector3f(radius, -handle, 0), Vector3f(radius, 0, 0) };
+        CubicSpline3f spline;
+        spline.setBezier(circle, 4);
+        spline.buildArcLengthTable(64);
+        const double circumference = 2.0 * 3.14159265358979 * radius;
+        failures += ReportBound("Arc length of circle", fabs(spline.getLength() - circumference) / circumference, 1.0e-3);
+
+        const K_UINT count = 200;
+        vector<float> distances(count);
+        for (K_UINT i = 0; i < count; ++i)
+            distances[i] = spline.getLength() * static_cast<float>(i) / static_cast<float>(count - 1);
+        vector<Vector3f> positions(count);
+        spline.evaluateAtDistances(distances.data(), positions.data(), nullptr, count);
+        const float expected = spline.getLength() / static_cast<float>(count - 1);
+        double spacing = 0.0;
+        for (K_UINT i = 1; i < count; ++i)
+            spacing = max(spacing, static_cast<double>(fabsf((positions[i] - positions[i - 1]).getMagnitude() - expected) / expected));
+        failures += ReportBound("Constant speed spacing", spacing, 1.0e-2);
+    }
+
+    // Squad hits its keys, stays unit length, and keeps angular speed continuous across keys
+    // where chained slerps jump.
+    {
+        const K_UINT keyCount = 6;
+        Quaternion keys[keyCount];
+        for (K_UINT i = 0; i < keyCount; ++i) {
+            const float angle = 0.7f * static_cast<float>(i) + 0.2f * static_cast<float>(i * i);
+            const Vector3f axis = Vector3f(1.0f, static_cast<float>(i) * 0.3f, 0.5f).getNormalized();
+            keys[i] = Quaternion(axis.x * sinf(angle * 0.5f), axis.y * sinf(angle * 0.5f), axis.z * sinf(angle * 0.5f), cosf(angle * 0.5f));
+        }
+        SquadSpline squad;
+        squad.setKeys(keys, keyCount);
+
+        double keyError = 0.0;
+        for (K_UINT i = 0; i < keyCount; ++i)
+            keyError = max(keyError, static_cast<double>(rotationAngle(squad.evaluate(static_cast<float>(i)), keys[i])));
+        const K_UINT count = 997;
+        vector<float> parameters(count);
+        for (K_UINT i = 0; i < count; ++i)
+            parameters[i] = static_cast<float>(keyCount - 1) * static_cast<float>(i) / static_cast<float>(count - 1);
+        vector<Quaternion> rotations(count);
+        squad.evaluate(parameters.data(), rotations.data(), count);
+        double unit = 0.0;
+        for (const Quaternion& rotation : rotations)
+            unit = max(unit, static_cast<double>(fabsf(rotation.getMagnitude() - 1.0f)));
+
+        const float step = 1.0e-2f;
+        double squadJump = 0.0;
+        double slerpJump = 0.0;
+        for (K_UINT i = 1; i + 1 < keyCount; ++i) {
+            const float key = static_cast<float>(i);
+            const float before = rotationAngle(squad.evaluate(key - step), squad.evaluate(key)) / step;
+            const float after = rotationAngle(squad.evaluate(key), squad.evaluate(key + step)) / step;
+            squadJump = max(squadJump, static_cast<double>(fabsf(before - after)));
+            const float slerpBefore = rotationAngle(Quaternion::Slerp(keys[i - 1], keys[i], 1.0f - step), keys[i]) / step;
+            const float slerpAfter = rotationAngle(keys[i], Quaternion::Slerp(keys[i], keys[i + 1], step)) / step;
+            slerpJump = max(slerpJump, static_cast<double>(fabsf(slerpBefore - slerpAfter)));
+        }
+        failures += ReportBound("Squad through keys", keyError, 2.0e-3);
+        failures += ReportBound("Squad unit length", unit, 1.0e-4);
+        failures += ReportBound("Squad angular speed continuity", squadJump, 0.1);
+        cout << "Angular speed jump at keys: squad " << squadJump << ", chained slerp " << slerpJump << " rad per unit" << endl;
+    }
+
+    // Benchmark: batched polynomial evaluation against per point de Casteljau lerps.
+    {
+        CubicSpline3f spline;
+        spline.setBezier(points.data(), (pointCount - 1) / 3);
+        const K_UINT count = 4096;
+        const K_UINT passes = 256;
+        vector<float> parameters(count);
+        for (K_UINT i = 0; i < count; ++i)
+            parameters[i] = static_cast<float>(spline.getSegmentCount()) * static_cast<float>(i) / static_cast<float>(count);
+        vector<Vector3f> positions(count);
+        vector<Vector3f> tangents(count);
+
+        float checksum = 0.0f;
+        high_resolution_clock::time_point start = high_resolution_clock::now();
+        for (K_UINT pass = 0; pass < passes; ++pass) {
+            for (K_UINT i = 0; i < count; ++i) {
+                const K_UINT segment = min(static_cast<K_UINT>(parameters[i]), spline.getSegmentCount() - 1);
+                positions[i] = deCasteljau(&points[segment * 3], parameters[i] - static_cast<float>(segment));
+            }
+            checksum += positions[pass % count].x;
+        }
+        const double lerpSeconds = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+
+        start = high_resolution_clock::now();
+        for (K_UINT pass = 0; pass < passes; ++pass) {
+            spline.evaluate(parameters.data(), positions.data(), nullptr, count);
+            checksum += positions[pass % count].x;
+        }
+        const double batchSeconds = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+
+        start = high_resolution_clock::now();
+        for (K_UINT pass = 0; pass < passes; ++pass) {
+            spline.evaluate(parameters.data(), positions.data(), tangents.data(), count);
+            checksum += tangents[pass % count].x;
+        }
+        const double tangentSeconds = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+
+        const double evaluations = static_cast<double>(count) * passes / 1.0e6;
+        cout << "de Casteljau: " << evaluations / lerpSeconds << "M points/s, batch: " << evaluations / batchSeconds
+             << "M points/s, batch with tangents: " << evaluations / tangentSeconds << "M points/s (checksum " << checksum << ")" << endl;
+    }
+
+    return failures;
+}
\ No newline at end of file
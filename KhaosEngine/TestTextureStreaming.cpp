@@ -0,0 +1,216 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "KhaosMath.h"
+#include "TextureStreaming.h"
+#include "TestUtilities.h"
+
+using namespace std;
+using namespace KhaosMath;
+using namespace KhaosEngine;
+using namespace KhaosTesting;
+
+namespace
+{
+    // Stand in for SDL. Paths are "width height", and decoding sleeps to mimic disk reads.
+    // Textures are heap blocks the test can check for leaks.
+    class FakeTextureBackend : public TextureStreamingBackend
+    {
+    public:
+        struct FakeTexture
+        {
+            K_UINT width, height;
+        };
+
+        FakeTextureBackend()
+            : liveCount(0), liveBytes(0), decodeMilliseconds(1) { }
+
+        bool decode(const string& aPath, K_UINT& aWidth, K_UINT& aHeight, vector<KUI_32>& somePixels) override {
+            this_thread::sleep_for(chrono::milliseconds(decodeMilliseconds));
+            {
+                lock_guard<mutex> lock(decodeMutex);
+                decodeOrder.push_back(aPath);
+            }
+            istringstream size(aPath);
+            if (!(size >> aWidth >> aHeight))
+                return false;
+            somePixels.assign(aWidth * aHeight, 0xFF8040C0u);
+            return true;
+        }
+
+        SDL_Texture* createTexture(const KUI_32* /*somePixels*/, K_UINT aWidth, K_UINT aHeight) override {
+            FakeTexture* texture = new FakeTexture;
+            texture->width = aWidth;
+            texture->height = aHeight;
+            ++liveCount;
+            liveBytes += aWidth * aHeight * 4;
+            return reinterpret_cast<SDL_Texture*>(texture);
+        }
+
+        void destroyTexture(SDL_Texture* aTexture) override {
+            FakeTexture* texture = reinterpret_cast<FakeTexture*>(aTexture);
+            --liveCount;
+            liveBytes -= texture->width * texture->height * 4;
+            delete texture;
+        }
+
+        static const FakeTexture* get(SDL_Texture* aTexture) {
+            return reinterpret_cast<const FakeTexture*>(aTexture);
+        }
+
+        K_UINT liveCount;
+        size_t liveBytes;
+        K_UINT decodeMilliseconds;
+        mutex decodeMutex;
+        vector<string> decodeOrder;
+    };
+
+    string texturePath(K_UINT aWidth, K_UINT aHeight) {
+        return to_string(aWidth) + " " + to_string(aHeight);
+    }
+
+    // Runs frames that use someHandles until they are all resident or a second has passed.
+    bool streamIn(TextureStreamer& aStreamer, const vector<TextureHandle>& someHandles) {
+        for (K_UINT frame = 0; frame < 1000; ++frame) {
+            bool allResident = true;
+            for (TextureHandle handle : someHandles) {
+                aStreamer.use(handle, 64.0f);
+                allResident = allResident && aStreamer.isResident(handle);
+            }
+            aStreamer.update();
+            if (allResident)
+                return true;
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+        return false;
+    }
+}
+
+int TestTextureStreaming() {
+    K_INT failures = 0;
+
+    // A texture streams in, gets a small fallback, and a bad path fails without retrying.
+    {
+        FakeTextureBackend backend;
+        TextureStreamingSettings settings;
+        {
+            TextureStreamer streamer(backend, settings);
+            const TextureHandle handle = streamer.addTexture(texturePath(128, 64));
+            const TextureHandle missing = streamer.addTexture("missing.bmp");
+            K_UINT wrong = streamer.use(handle, 64.0f) != nullptr;
+            streamer.update();
+            wrong += !streamIn(streamer, vector<TextureHandle>(1, handle));
+            SDL_Texture* full = streamer.use(handle, 64.0f);
+            wrong += full == nullptr || FakeTextureBackend::get(full)->width != 128;
+            for (K_UINT frame = 0; frame < 200 && streamer.getStats().failedCount == 0; ++frame) {
+                streamer.use(missing, 64.0f);
+                streamer.update();
+                this_thread::sleep_for(chrono::milliseconds(1));
+            }
+            wrong += streamer.getStats().failedCount != 1 || streamer.use(missing, 64.0f) != nullptr;
+            wrong += backend.liveBytes != streamer.getStats().residentBytes;
+            failures += ReportCount("Stream in and failed load", wrong);
+        }
+        failures += ReportCount("Textures destroyed with the streamer", backend.liveCount);
+    }
+
+    // The least recently used texture is evicted, and its fallback is served until it returns.
+    {
+        FakeTextureBackend backend;
+        TextureStreamingSettings settings;
+        settings.budgetBytes = 2 * 64 * 64 * 4 + 3 * 16 * 16 * 4;
+        TextureStreamer streamer(backend, settings);
+        const TextureHandle a = streamer.addTexture(texturePath(64, 64));
+        const TextureHandle b = streamer.addTexture(texturePath(64, 64));
+        const TextureHandle c = streamer.addTexture(texturePath(64, 64));
+        K_UINT wrong = !streamIn(streamer, vector<TextureHandle>{ a, b });
+        streamer.use(b, 64.0f);
+        streamer.update();
+        wrong += !streamIn(streamer, vector<TextureHandle>(1, c));
+        wrong += streamer.isResident(a) || !streamer.isResident(b) || streamer.getStats().evictionCount != 1;
+        SDL_Texture* fallback = streamer.use(a, 64.0f);
+        wrong += fallback == nullptr || FakeTextureBackend::get(fallback)->width != 16;
+        wrong += streamer.getStats().residentBytes > settings.budgetBytes;
+        failures += ReportCount("LRU eviction keeps recent textures", wrong);
+    }
+
+    // Loads queued together decode largest on screen first.
+    {
+        FakeTextureBackend backend;
+        backend.decodeMilliseconds = 5;
+        TextureStreamingSettings settings;
+        settings.loaderThreadCount = 1;
+        TextureStreamer streamer(backend, settings);
+        const K_UINT count = 8;
+        vector<TextureHandle> handles;
+        for (K_UINT i = 0; i < count; ++i)
+            handles.push_back(streamer.addTexture(texturePath(8 + i, 8)));
+        // Camera at the origin; texture i sits further away the lower i is.
+        streamer.beginFrame(Vector3f(0.0f, 0.0f, 0.0f), 500.0f);
+        for (K_UINT frame = 0; frame < 1000 && streamer.getStats().residentCount < count; ++frame) {
+            for (K_UINT i = 0; i < count; ++i)
+                streamer.use(handles[i], Vector3f(0.0f, 0.0f, 10.0f + 10.0f * (count - i)), 1.0f);
+            streamer.update();
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+        K_UINT outOfOrder = backend.decodeOrder.size() != count;
+        for (K_UINT i = 0; i < backend.decodeOrder.size(); ++i)
+            outOfOrder += backend.decodeOrder[i] != texturePath(8 + count - 1 - i, 8);
+        failures += ReportCount("Decode order follows screen size", outOfOrder);
+    }
+
+    // A camera sweeping along a street of textures that cannot all fit at once.
+    {
+        FakeTextureBackend backend;
+        TextureStreamingSettings settings;
+        settings.budgetBytes = 1024 * 1024;
+        const K_UINT textureCount = 64;
+        const K_UINT visibleCount = 8;
+        TextureStreamer streamer(backend, settings);
+        vector<TextureHandle> handles;
+        size_t totalBytes = 0;
+        for (K_UINT i = 0; i < textureCount; ++i) {
+            const K_UINT size = 64u << (i % 3);
+            handles.push_back(streamer.addTexture(texturePath(size, size)));
+            totalBytes += size * size * 4;
+        }
+
+        size_t overBudget = 0;
+        size_t mismatch = 0;
+        K_UINT nothingToDraw = 0;
+        const K_UINT frameCount = 600;
+        for (K_UINT frame = 0; frame < frameCount; ++frame) {
+            // There and back, pausing at the far end, so the second pass revisits evicted textures.
+            const float sweep = min(static_cast<float>(frame % 300) / 250.0f, 1.0f) * (textureCount - visibleCount);
+            const float position = (frame / 300) % 2 ? (textureCount - visibleCount) - sweep : sweep;
+            streamer.beginFrame(Vector3f(position * 4.0f, 0.0f, 0.0f), 400.0f);
+            const K_UINT first = static_cast<K_UINT>(position);
+            for (K_UINT i = first; i < min(first + visibleCount, textureCount); ++i) {
+                SDL_Texture* texture = streamer.use(handles[i], Vector3f(i * 4.0f, 0.0f, 6.0f), 2.0f);
+                nothingToDraw += texture == nullptr && frame >= 300 ? 1 : 0;
+            }
+            streamer.update();
+            overBudget = max(overBudget, streamer.getStats().residentBytes > settings.budgetBytes ?
+                                         streamer.getStats().residentBytes - settings.budgetBytes : 0);
+            mismatch += backend.liveBytes != streamer.getStats().residentBytes;
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+        const TextureStreamingStats& stats = streamer.getStats();
+        failures += ReportCheck("Resident bytes within budget", overBudget == 0);
+        failures += ReportCount("Resident bytes match backend", mismatch);
+        failures += ReportCount("Second pass always has a texture", nothingToDraw);
+        cout << "Sweep: hit rate " << stats.getHitRate() * 100.0f << "%, " << stats.fallbackCount << " fallback uses, "
+             << stats.loadCount << " loads, " << stats.evictionCount << " evictions, " << stats.residentBytes / 1024
+             << " KB resident of " << settings.budgetBytes / 1024 << " KB budget (" << totalBytes / 1024
+             << " KB to load everything), latency average " << stats.averageLatency * 1000.0 << " ms, max "
+             << stats.maxLatency * 1000.0 << " ms" << endl;
+    }
+
+    return failures;
+}
\ No newline at end of file
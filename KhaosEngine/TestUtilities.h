@@ -0,0 +1,46 @@
+#pragma once
+
+// TestUtilities.h
+// Reporting and random input helpers shared by the Test*.cpp files. Every report prints one
+// PASS or FAIL line and returns 1 on failure, so a test sums them into its failure count.
+
+#include "Common.h"
+#include "Quaternion.h"
+
+#include <iostream>
+#include <random>
+
+namespace KhaosTesting
+{
+    using KhaosMath::Quaternion;
+
+    // Passes when anError is at most aBound.
+    inline K_INT ReportBound(const char* aName, double anError, double aBound) {
+        const bool passed = anError <= aBound;
+        std::cout << (passed ? "PASS " : "FAIL ") << aName << ": max error " << anError << " (bound " << aBound << ")" << std::endl;
+        return passed ? 0 : 1;
+    }
+
+    // Passes when aCondition holds.
+    inline K_INT ReportCheck(const char* aName, bool aCondition) {
+        std::cout << (aCondition ? "PASS " : "FAIL ") << aName << std::endl;
+        return aCondition ? 0 : 1;
+    }
+
+    // Passes when none of the cases checked by a test went wrong.
+    inline K_INT ReportCount(const char* aName, KUI_64 aFailedCases) {
+        if (aFailedCases == 0) {
+            std::cout << "PASS " << aName << std::endl;
+            return 0;
+        }
+        std::cout << "FAIL " << aName << ": " << aFailedCases << " cases wrong" << std::endl;
+        return 1;
+    }
+
+    // Returns a uniformly distributed unit quaternion.
+    inline Quaternion RandomRotation(std::mt19937& aGenerator) {
+        std::normal_distribution<float> gaussian(0.0f, 1.0f);
+        Quaternion quat(gaussian(aGenerator), gaussian(aGenerator), gaussian(aGenerator), gaussian(aGenerator));
+        return quat / quat.getMagnitude();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,359 @@
+// TextureStreaming.cpp
+// Loader threads, budgeted LRU residency and the SDL backend.
+
+#include "TextureStreaming.h"
+#include "Profiler.h"
+
+#include <SDL.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    using namespace KhaosEngine;
+
+    const TextureHandle NO_TEXTURE = 0xFFFFFFFF;
+    const size_t BYTES_PER_PIXEL = 4;
+
+    // Box filters RGBA8888 pixels down by a whole factor so neither side exceeds aMaxSize.
+    void downsample(const std::vector<KUI_32>& somePixels, K_UINT aWidth, K_UINT aHeight, K_UINT aMaxSize,
+                    K_UINT& aResultWidth, K_UINT& aResultHeight, std::vector<KUI_32>& aResult) {
+        const K_UINT factor = std::max(1u, (std::max(aWidth, aHeight) + aMaxSize - 1) / aMaxSize);
+        aResultWidth = (aWidth + factor - 1) / factor;
+        aResultHeight = (aHeight + factor - 1) / factor;
+        aResult.resize(aResultWidth * aResultHeight);
+        for (K_UINT y = 0; y < aResultHeight; ++y) {
+            for (K_UINT x = 0; x < aResultWidth; ++x) {
+                // Blocks on the right and bottom edges may be partial.
+                const K_UINT endX = std::min((x + 1) * factor, aWidth);
+                const K_UINT endY = std::min((y + 1) * factor, aHeight);
+                KUI_32 sums[4] = { 0, 0, 0, 0 };
+                for (K_UINT sourceY = y * factor; sourceY < endY; ++sourceY) {
+                    for (K_UINT sourceX = x * factor; sourceX < endX; ++sourceX) {
+                        const KUI_32 pixel = somePixels[sourceY * aWidth + sourceX];
+                        for (K_UINT channel = 0; channel < 4; ++channel)
+                            sums[channel] += (pixel >> (channel * 8)) & 0xFF;
+                    }
+                }
+                const KUI_32 count = (endX - x * factor) * (endY - y * factor);
+                KUI_32 average = 0;
+                for (K_UINT channel = 0; channel < 4; ++channel)
+                    average |= ((sums[channel] + count / 2) / count) << (channel * 8);
+                aResult[y * aResultWidth + x] = average;
+            }
+        }
+    }
+}
+
+namespace KhaosEngine
+{
+    //
+    // SdlTextureBackend function definitions.
+    //
+
+    bool SdlTextureBackend::decode(const std::string& aPath, K_UINT& aWidth, K_UINT& aHeight, std::vector<KUI_32>& somePixels) {
+        SDL_Surface* loaded = SDL_LoadBMP(aPath.c_str());
+        if (!loaded)
+            return false;
+        SDL_Surface* converted = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA8888, 0);
+        SDL_FreeSurface(loaded);
+        if (!converted)
+            return false;
+
+        aWidth = static_cast<K_UINT>(converted->w);
+        aHeight = static_cast<K_UINT>(converted->h);
+        somePixels.resize(aWidth * aHeight);
+        SDL_LockSurface(converted);
+        for (K_UINT row = 0; row < aHeight; ++row)
+            memcpy(&somePixels[row * aWidth], static_cast<const KUI_8*>(converted->pixels) + row * converted->pitch,
+                   aWidth * BYTES_PER_PIXEL);
+        SDL_UnlockSurface(converted);
+        SDL_FreeSurface(converted);
+        return true;
+    }
+
+    SDL_Texture* SdlTextureBackend::createTexture(const KUI_32* somePixels, K_UINT aWidth, K_UINT aHeight) {
+        SDL_Texture* texture = SDL_CreateTexture(mRenderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STATIC,
+                                                 static_cast<int>(aWidth), static_cast<int>(aHeight));
+        if (!texture)
+            return nullptr;
+        SDL_UpdateTexture(texture, nullptr, somePixels, static_cast<int>(aWidth * BYTES_PER_PIXEL));
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        return texture;
+    }
+
+    void SdlTextureBackend::destroyTexture(SDL_Texture* aTexture) {
+        SDL_DestroyTexture(aTexture);
+    }
+
+    //
+    // TextureStreamer function definitions.
+    //
+
+    TextureStreamer::TextureStreamer(TextureStreamingBackend& aBackend, const TextureStreamingSettings& someSettings)
+        : mBackend(aBackend), mSettings(someSettings), mStats(), mMostRecent(NO_TEXTURE), mLeastRecent(NO_TEXTURE),
+          mFrame(1), mPixelsPerUnit(1.0f), mTotalLatency(0.0), mStopping(false),
+          mLoaderCount(std::max(1u, std::min(someSettings.loaderThreadCount, MAX_TEXTURE_LOADER_THREADS))) {
+        ASSERT(someSettings.fallbackSize > 0);
+        for (K_UINT i = 0; i < mLoaderCount; ++i)
+            mLoaders[i] = std::thread(&TextureStreamer::loaderThread, this);
+    }
+
+    TextureStreamer::~TextureStreamer() {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStopping = true;
+        }
+        mWake.notify_all();
+        for (K_UINT i = 0; i < mLoaderCount; ++i)
+            mLoaders[i].join();
+
+        for (TextureRecord& record : mTextures) {
+            if (record.texture)
+                mBackend.destroyTexture(record.texture);
+            if (record.fallback)
+                mBackend.destroyTexture(record.fallback);
+        }
+    }
+
+    TextureHandle TextureStreamer::addTexture(const std::string& aPath) {
+        TextureRecord record;
+        record.path = aPath;
+        record.texture = nullptr;
+        record.fallback = nullptr;
+        record.bytes = 0;
+        record.lastUsedFrame = 0;
+        record.priority = 0.0f;
+        record.state = TextureState::Unloaded;
+        record.previous = NO_TEXTURE;
+        record.next = NO_TEXTURE;
+        mTextures.push_back(record);
+        return static_cast<TextureHandle>(mTextures.size() - 1);
+    }
+
+    void TextureStreamer::beginFrame(const Vector3f& aCameraPosition, float aPixelsPerUnit) {
+        mCameraPosition = aCameraPosition;
+        mPixelsPerUnit = aPixelsPerUnit;
+    }
+
+    SDL_Texture* TextureStreamer::use(TextureHandle aHandle, const Vector3f& aPosition, float aSize) {
+        // Closer than a hundredth of a unit counts as a hundredth, so the size stays finite.
+        const float distance = std::max((aPosition - mCameraPosition).getMagnitude(), 0.01f);
+        return touch(aHandle, aSize * mPixelsPerUnit / distance);
+    }
+
+    SDL_Texture* TextureStreamer::use(TextureHandle aHandle, float aScreenSize) {
+        return touch(aHandle, aScreenSize);
+    }
+
+    bool TextureStreamer::isResident(TextureHandle aHandle) const {
+        ASSERT(aHandle < mTextures.size());
+        return mTextures[aHandle].state == TextureState::Resident;
+    }
+
+    SDL_Texture* TextureStreamer::touch(TextureHandle aHandle, float aPriority) {
+        ASSERT(aHandle < mTextures.size());
+        TextureRecord& record = mTextures[aHandle];
+        ++mStats.useCount;
+        if (record.lastUsedFrame != mFrame) {
+            record.lastUsedFrame = mFrame;
+            record.priority = aPriority;
+            mUsedThisFrame.push_back(aHandle);
+        }
+        else {
+            record.priority = std::max(record.priority, aPriority);
+        }
+
+        if (record.state == TextureState::Resident) {
+            if (mMostRecent != aHandle) {
+                unlink(aHandle);
+                linkFront(aHandle);
+            }
+            ++mStats.hitCount;
+            return record.texture;
+        }
+        if (record.fallback)
+            ++mStats.fallbackCount;
+        return record.fallback;
+    }
+
+    void TextureStreamer::update() {
+        PROFILE_SCOPE_CATEGORY("TextureStreamer::update", PROFILE_CATEGORY_ASSET);
+        bool queuedAny = false;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            for (DecodedImage& image : mDecoded)
+                mUploadBacklog.push_back(std::move(image));
+            mDecoded.clear();
+
+            // Refresh the priority of waiting loads and drop those nobody has drawn lately.
+            size_t kept = 0;
+            for (LoadJob& job : mJobs) {
+                TextureRecord& record = mTextures[job.handle];
+                if (record.lastUsedFrame + mSettings.staleFrames < mFrame) {
+                    record.state = TextureState::Unloaded;
+                    --mStats.queuedCount;
+                    continue;
+                }
+                if (record.lastUsedFrame == mFrame)
+                    job.priority = record.priority;
+                if (&mJobs[kept] != &job)
+                    mJobs[kept] = std::move(job);
+                ++kept;
+            }
+            mJobs.resize(kept);
+
+            for (TextureHandle handle : mUsedThisFrame) {
+                TextureRecord& record = mTextures[handle];
+                if (record.state != TextureState::Unloaded)
+                    continue;
+                record.state = TextureState::Queued;
+                record.queuedTime = Clock::now();
+                LoadJob job = { handle, record.priority, record.fallback == nullptr, record.path };
+                mJobs.push_back(job);
+                ++mStats.queuedCount;
+                queuedAny = true;
+            }
+        }
+        if (queuedAny)
+            mWake.notify_all();
+
+        K_UINT uploads = 0;
+        size_t processed = 0;
+        for (; processed < mUploadBacklog.size() && uploads < mSettings.maxUploadsPerFrame; ++processed)
+            uploads += upload(mUploadBacklog[processed]) ? 1 : 0;
+        mUploadBacklog.erase(mUploadBacklog.begin(), mUploadBacklog.begin() + processed);
+
+        mUsedThisFrame.clear();
+        ++mFrame;
+    }
+
+    bool TextureStreamer::upload(DecodedImage& anImage) {
+        TextureRecord& record = mTextures[anImage.handle];
+        ASSERT(record.state == TextureState::Queued);
+        --mStats.queuedCount;
+        if (!anImage.succeeded) {
+            record.state = TextureState::Failed;
+            ++mStats.failedCount;
+            return false;
+        }
+
+        // Fallbacks are tiny and never evicted, so they are added regardless of the budget.
+        bool created = false;
+        if (!record.fallback && !anImage.fallbackPixels.empty()) {
+            record.fallback = mBackend.createTexture(anImage.fallbackPixels.data(), anImage.fallbackWidth, anImage.fallbackHeight);
+            if (record.fallback) {
+                mStats.residentBytes += anImage.fallbackPixels.size() * BYTES_PER_PIXEL;
+                created = true;
+            }
+        }
+
+        // The texture may have gone out of view while it decoded.
+        record.state = TextureState::Unloaded;
+        if (record.lastUsedFrame + mSettings.staleFrames < mFrame)
+            return created;
+        const size_t bytes = anImage.pixels.size() * BYTES_PER_PIXEL;
+        if (!makeRoom(bytes)) {
+            ++mStats.failedCount;
+            return created;
+        }
+        record.texture = mBackend.createTexture(anImage.pixels.data(), anImage.width, anImage.height);
+        if (!record.texture) {
+            record.state = TextureState::Failed;
+            ++mStats.failedCount;
+            return created;
+        }
+
+        record.state = TextureState::Resident;
+        record.bytes = bytes;
+        linkFront(anImage.handle);
+        mStats.residentBytes += bytes;
+        ++mStats.residentCount;
+        ++mStats.loadCount;
+        const double latency = std::chrono::duration<double>(Clock::now() - record.queuedTime).count();
+        mTotalLatency += latency;
+        mStats.averageLatency = mTotalLatency / static_cast<double>(mStats.loadCount);
+        mStats.maxLatency = std::max(mStats.maxLatency, latency);
+        return true;
+    }
+
+    bool TextureStreamer::makeRoom(size_t aBytes) {
+        while (mStats.residentBytes + aBytes > mSettings.budgetBytes) {
+            // The resident list is in use order, so once its tail was drawn this frame all was.
+            const TextureHandle victim = mLeastRecent;
+            if (victim == NO_TEXTURE || mTextures[victim].lastUsedFrame == mFrame)
+                return false;
+            TextureRecord& record = mTextures[victim];
+            unlink(victim);
+            mBackend.destroyTexture(record.texture);
+            record.texture = nullptr;
+            record.state = TextureState::Unloaded;
+            mStats.residentBytes -= record.bytes;
+            --mStats.residentCount;
+            ++mStats.evictionCount;
+        }
+        return true;
+    }
+
+    void TextureStreamer::linkFront(TextureHandle aHandle) {
+        TextureRecord& record = mTextures[aHandle];
+        record.previous = NO_TEXTURE;
+        record.next = mMostRecent;
+        if (mMostRecent != NO_TEXTURE)
+            mTextures[mMostRecent].previous = aHandle;
+        mMostRecent = aHandle;
+        if (mLeastRecent == NO_TEXTURE)
+            mLeastRecent = aHandle;
+    }
+
+    void TextureStreamer::unlink(TextureHandle aHandle) {
+        TextureRecord& record = mTextures[aHandle];
+        if (record.previous != NO_TEXTURE)
+            mTextures[record.previous].next = record.next;
+        else
+            mMostRecent = record.next;
+        if (record.next != NO_TEXTURE)
+            mTextures[record.next].previous = record.previous;
+        else
+            mLeastRecent = record.previous;
+        record.previous = NO_TEXTURE;
+        record.next = NO_TEXTURE;
+    }
+
+    void TextureStreamer::loaderThread() {
+        PROFILE_THREAD_NAME("TextureLoader");
+        for (;;) {
+            LoadJob job;
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mWake.wait(lock, [this] { return mStopping || !mJobs.empty(); });
+                if (mStopping)
+                    return;
+                // Largest on screen first.
+                size_t best = 0;
+                for (size_t i = 1; i < mJobs.size(); ++i)
+                    if (mJobs[i].priority > mJobs[best].priority)
+                        best = i;
+                job = std::move(mJobs[best]);
+                mJobs[best] = std::move(mJobs.back());
+                mJobs.pop_back();
+            }
+
+            DecodedImage image;
+            image.handle = job.handle;
+            image.width = 0;
+            image.height = 0;
+            image.fallbackWidth = 0;
+            image.fallbackHeight = 0;
+            image.succeeded = mBackend.decode(job.path, image.width, image.height, image.pixels) &&
+                              image.width > 0 && image.height > 0 && image.pixels.size() == image.width * image.height;
+            if (image.succeeded && job.needsFallback)
+                downsample(image.pixels, image.width, image.height, mSettings.fallbackSize, image.fallbackWidth,
+                           image.fallbackHeight, image.fallbackPixels);
+
+            std::lock_guard<std::mutex> lock(mMutex);
+            mDecoded.push_back(std::move(image));
+        }
+    }
+}
\ No newline at end of file
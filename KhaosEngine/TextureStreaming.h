@@ -0,0 +1,226 @@
+#pragma once
+
+// TextureStreaming.h
+// Keeps the textures the camera needs resident within a fixed memory budget, loading them on
+// background threads instead of all up front.
+//
+// Every frame the renderer reports each texture it draws along with how large it appears,
+// and gets back the best version currently resident:
+//
+//     streamer.beginFrame(cameraPosition, pixelsPerUnit);
+//     SDL_Texture* texture = streamer.use(handle, objectPosition, objectSize);
+//     ...
+//     streamer.update();   // once, after the last use of the frame
+//
+// Textures that are wanted but not resident are queued, and loader threads decode the largest
+// on screen first. Decoding happens off the render thread; update turns finished images into
+// SDL textures on the render thread, which SDL requires. When the budget is full, the least
+// recently used textures not drawn this frame are evicted. The first load of a texture also
+// keeps a tiny downsampled copy that is never evicted, so after the first load a texture
+// always has something to draw while its full version streams back in.
+//
+// Apart from the backend's decode, which runs on the loader threads, everything happens on
+// the render thread.
+
+#include "Common.h"
+#include "KhaosMath.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct SDL_Renderer;
+struct SDL_Texture;
+
+namespace KhaosEngine
+{
+    using KhaosMath::Vector3f;
+
+    typedef K_UINT TextureHandle;
+
+    // Most loader threads a TextureStreamer will run.
+    const K_UINT MAX_TEXTURE_LOADER_THREADS = 8;
+
+    // Decodes images and creates textures for the streamer. Pixels are 32-bit RGBA8888, rows
+    // packed with no padding.
+    class TextureStreamingBackend
+    {
+    public:
+        virtual ~TextureStreamingBackend() { }
+
+        // Reads the image at aPath. Called on loader threads, possibly several at once.
+        virtual bool decode(const std::string& aPath, K_UINT& aWidth, K_UINT& aHeight, std::vector<KUI_32>& somePixels) = 0;
+
+        // Creates a texture from decoded pixels. Called on the render thread.
+        virtual SDL_Texture* createTexture(const KUI_32* somePixels, K_UINT aWidth, K_UINT aHeight) = 0;
+
+        // Called on the render thread.
+        virtual void destroyTexture(SDL_Texture* aTexture) = 0;
+    };
+
+    // Backend that loads BMP files with SDL and creates static textures on aRenderer.
+    class SdlTextureBackend : public TextureStreamingBackend
+    {
+    public:
+        explicit SdlTextureBackend(SDL_Renderer* aRenderer)
+            : mRenderer(aRenderer) { }
+
+        bool decode(const std::string& aPath, K_UINT& aWidth, K_UINT& aHeight, std::vector<KUI_32>& somePixels) override;
+        SDL_Texture* createTexture(const KUI_32* somePixels, K_UINT aWidth, K_UINT aHeight) override;
+        void destroyTexture(SDL_Texture* aTexture) override;
+
+    private:
+        SDL_Renderer* mRenderer;
+    };
+
+    struct TextureStreamingSettings
+    {
+        size_t budgetBytes; // Full resolution textures and fallbacks together.
+        K_UINT loaderThreadCount;
+        K_UINT maxUploadsPerFrame; // Caps texture creation per update to avoid hitches.
+        K_UINT fallbackSize; // Largest side of the low resolution fallback, in pixels.
+        K_UINT staleFrames; // Queued loads not used for this many frames are dropped.
+
+        TextureStreamingSettings()
+            : budgetBytes(64 * 1024 * 1024), loaderThreadCount(2), maxUploadsPerFrame(4), fallbackSize(16), staleFrames(30) { }
+    };
+
+    struct TextureStreamingStats
+    {
+        KUI_64 useCount; // Calls to use.
+        KUI_64 hitCount; // Uses that found the full texture resident.
+        KUI_64 fallbackCount; // Uses served by the fallback.
+        KUI_64 loadCount; // Full textures made resident.
+        KUI_64 evictionCount;
+        KUI_64 failedCount; // Decodes that failed, or loads that could not fit in the budget.
+        size_t residentBytes;
+        K_UINT residentCount; // Full textures resident.
+        K_UINT queuedCount; // Waiting for or being decoded.
+        double averageLatency; // Seconds from a texture being queued to it becoming resident.
+        double maxLatency;
+
+        float getHitRate() const {
+            return useCount ? static_cast<float>(hitCount) / static_cast<float>(useCount) : 0.0f;
+        }
+    };
+
+    class TextureStreamer
+    {
+    public:
+        // Starts the loader threads. aBackend must outlive the streamer.
+        TextureStreamer(TextureStreamingBackend& aBackend, const TextureStreamingSettings& someSettings);
+
+        // Stops the loader threads and destroys every texture.
+        ~TextureStreamer();
+
+        // Registers a texture without loading it.
+        TextureHandle addTexture(const std::string& aPath);
+
+        // Sets the camera used by the positional use. aPixelsPerUnit is the on screen size in
+        // pixels of an object one unit across at one unit of distance.
+        void beginFrame(const Vector3f& aCameraPosition, float aPixelsPerUnit);
+
+        // Marks the texture as drawn this frame by an object of aSize world units at aPosition
+        // and returns the full texture if resident, else its fallback, else nullptr.
+        SDL_Texture* use(TextureHandle aHandle, const Vector3f& aPosition, float aSize);
+
+        // As above, for sprites whose on screen size in pixels is already known.
+        SDL_Texture* use(TextureHandle aHandle, float aScreenSize);
+
+        // Queues wanted textures by size on screen, and creates textures for finished loads,
+        // evicting to stay within budget. Call once per frame after the last use.
+        void update();
+
+        // Returns true once the full version of the texture is resident.
+        bool isResident(TextureHandle aHandle) const;
+
+        const TextureStreamingStats& getStats() const { return mStats; }
+
+    private:
+        TextureStreamer(const TextureStreamer&) = delete;
+        TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+        typedef std::chrono::steady_clock Clock;
+
+        enum class TextureState : KUI_8
+        {
+            Unloaded,
+            Queued, // Waiting for or being decoded.
+            Resident,
+            Failed
+        };
+
+        // Render thread view of a texture. Resident textures form a list from most to least
+        // recently used through previous and next.
+        struct TextureRecord
+        {
+            std::string path;
+            SDL_Texture* texture;
+            SDL_Texture* fallback;
+            size_t bytes;
+            KUI_64 lastUsedFrame;
+            float priority; // Largest on screen size this frame, in pixels.
+            TextureState state;
+            TextureHandle previous;
+            TextureHandle next;
+            Clock::time_point queuedTime;
+        };
+
+        // Shared with the loader threads under mMutex.
+        struct LoadJob
+        {
+            TextureHandle handle;
+            float priority;
+            bool needsFallback;
+            std::string path;
+        };
+
+        struct DecodedImage
+        {
+            TextureHandle handle;
+            bool succeeded;
+            K_UINT width, height;
+            std::vector<KUI_32> pixels;
+            K_UINT fallbackWidth, fallbackHeight;
+            std::vector<KUI_32> fallbackPixels; // Empty unless the job asked for a fallback.
+        };
+
+        void loaderThread();
+
+        // Records a use and returns the texture to draw.
+        SDL_Texture* touch(TextureHandle aHandle, float aPriority);
+
+        // Creates the textures for a finished decode. Returns false if nothing was created.
+        bool upload(DecodedImage& anImage);
+
+        // Evicts least recently used textures not drawn this frame until aBytes more fit.
+        bool makeRoom(size_t aBytes);
+
+        void linkFront(TextureHandle aHandle);
+        void unlink(TextureHandle aHandle);
+
+        TextureStreamingBackend& mBackend;
+        TextureStreamingSettings mSettings;
+        TextureStreamingStats mStats;
+        std::vector<TextureRecord> mTextures;
+        std::vector<TextureHandle> mUsedThisFrame;
+        TextureHandle mMostRecent; // Ends of the resident list.
+        TextureHandle mLeastRecent;
+        KUI_64 mFrame;
+        Vector3f mCameraPosition;
+        float mPixelsPerUnit;
+        double mTotalLatency;
+        std::vector<DecodedImage> mUploadBacklog; // Decoded but over this frame's upload cap.
+
+        std::mutex mMutex;
+        std::condition_variable mWake;
+        std::vector<LoadJob> mJobs;
+        std::vector<DecodedImage> mDecoded;
+        bool mStopping;
+        std::thread mLoaders[MAX_TEXTURE_LOADER_THREADS];
+        K_UINT mLoaderCount;
+    };
+}
\ No newline at end of file
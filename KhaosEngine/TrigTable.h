@@ -0,0 +1,71 @@
+#pragma once
+
+// TrigTable.h
+// Sine and cosine lookup tables that are filled in entirely at compile time.
+//
+//     constexpr TrigTable<1024> gTrig;
+//     float s = gTrig.sin(angle);
+
+#include "Common.h"
+#include "CommonMath.h"
+
+namespace KhaosMath
+{
+    // Lookup table of aResolution evenly spaced samples over one full turn.
+    // aResolution must be a power of two so angles wrap with a mask.
+    template <K_UINT aResolution>
+    class TrigTable
+    {
+        static_assert((aResolution & (aResolution - 1)) == 0, "TrigTable resolution must be a power of two.");
+
+    public:
+        float sine[aResolution];
+        float cosine[aResolution];
+
+        // Fills both tables. Declared constexpr so constant tables are baked into the binary.
+        constexpr TrigTable()
+            : sine{}, cosine{} {
+            for (K_UINT i = 0; i < aResolution; ++i) {
+                const double angle = 6.28318530717958647692 * static_cast<double>(i) / static_cast<double>(aResolution);
+                sine[i] = static_cast<float>(CompileTimeSin(angle));
+                cosine[i] = static_cast<float>(CompileTimeCos(angle));
+            }
+        }
+
+        // Returns the sample nearest below aRadians. Any angle, positive or negative, is accepted.
+        constexpr float sin(float aRadians) const {
+            return sine[indexOf(aRadians)];
+        }
+
+        // Returns the sample nearest below aRadians. Any angle, positive or negative, is accepted.
+        constexpr float cos(float aRadians) const {
+            return cosine[indexOf(aRadians)];
+        }
+
+        // Returns sine linearly interpolated between the two neighbouring samples.
+        constexpr float sinLerp(float aRadians) const {
+            const float position = aRadians * (aResolution / TWO_PI);
+            const K_INT index = floorToInt(position);
+            const float beta = position - static_cast<float>(index);
+            return sine[index & (aResolution - 1)] * (1.0f - beta) + sine[(index + 1) & (aResolution - 1)] * beta;
+        }
+
+        // Returns cosine linearly interpolated between the two neighbouring samples.
+        constexpr float cosLerp(float aRadians) const {
+            const float position = aRadians * (aResolution / TWO_PI);
+            const K_INT index = floorToInt(position);
+            const float beta = position - static_cast<float>(index);
+            return cosine[index & (aResolution - 1)] * (1.0f - beta) + cosine[(index + 1) & (aResolution - 1)] * beta;
+        }
+
+    private:
+        static constexpr K_INT floorToInt(float aValue) {
+            const K_INT truncated = static_cast<K_INT>(aValue);
+            return static_cast<float>(truncated) > aValue ? truncated - 1 : truncated;
+        }
+
+        static constexpr K_UINT indexOf(float aRadians) {
+            return static_cast<K_UINT>(floorToInt(aRadians * (aResolution / TWO_PI))) & (aResolution - 1);
+        }
+    };
+}
\ No newline at end of file
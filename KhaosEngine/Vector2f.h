@@ -15,40 +15,31 @@ namespace KhaosMath
         float x, y;
 
         // Default constructor will zero all elements.
-        Vector2f()
+        constexpr Vector2f()
             : x(0.0f), y(0.0f) { };
 
         // Constructor to explicitly initialize all elements.
-        Vector2f(float aX, float aY)
+        constexpr Vector2f(float aX, float aY)
             : x(aX), y(aY) { };
 
-        // Copy constructor.
-        Vector2f(const Vector2f& other)
-            : x(other.x), y(other.y) { }
-
-        // Move constructor.
-        Vector2f(Vector2f&& other)
-            : x(std::move(other.x)), y(std::move(other.y)) { }
-
-        // Assignment operator.
-        Vector2f& operator=(const Vector2f& other) {
-            this->x = other.x;
-            this->y = other.y;
-            return *this;
-        }
+        // Copies are trivial so the type stays in registers and can be moved with memcpy.
+        constexpr Vector2f(const Vector2f& other) = default;
+        constexpr Vector2f(Vector2f&& other) = default;
+        Vector2f& operator=(const Vector2f& other) = default;
+        Vector2f& operator=(Vector2f&& other) = default;
 
         // Add two vectors together to create a new vector.
-        Vector2f operator+(const Vector2f& other) const {
+        constexpr Vector2f operator+(const Vector2f& other) const {
             return Vector2f(x + other.x, y + other.y);
         }
 
         // Subtract another vector from this vector to create a new vector;
-        Vector2f operator-(const Vector2f& other) const {
+        constexpr Vector2f operator-(const Vector2f& other) const {
             return Vector2f(x - other.x, y - other.y);
         }
 
         // Create a vector by multiplying each component of this vector.
-        Vector2f operator*(const float aScalar) const {
+        constexpr Vector2f operator*(const float aScalar) const {
             return Vector2f(x * aScalar, y * aScalar);
         }
 
@@ -59,40 +50,40 @@ namespace KhaosMath
         }
 
         // Add a vector onto this vector, modifying the original vector.
-        Vector2f operator+=(const Vector2f& other) {
+        constexpr Vector2f& operator+=(const Vector2f& other) {
             x += other.x;
             y += other.y;
             return *this;
         }
 
         // Subtract a vector from this vector, modifying the original vector.
-        Vector2f operator-=(const Vector2f& other) {
+        constexpr Vector2f& operator-=(const Vector2f& other) {
             x -= other.x;
             y -= other.y;
             return *this;
         }
 
         // Modify this vector by multiplying each component.
-        Vector2f operator*=(const float aScalar) {
+        constexpr Vector2f& operator*=(const float aScalar) {
             x *= aScalar;
             y *= aScalar;
             return *this;
         }
 
         // Modify this vector by dividing each component.
-        Vector2f operator/=(const float aScalar) {
+        Vector2f& operator/=(const float aScalar) {
             x /= aScalar;
             y /= aScalar;
             return *this;
         }
 
         // Determine if this vector is component-wise equal to another vector.
-        bool operator==(const Vector2f& other) const {
+        constexpr bool operator==(const Vector2f& other) const {
             return x == other.x && y == other.y;
         }
 
         // Determine if this vector is component-wise not equal to another vector.
-        bool operator!=(const Vector2f& other) const {
+        constexpr bool operator!=(const Vector2f& other) const {
             return !(*this == other);
         }
 
@@ -102,58 +93,78 @@ namespace KhaosMath
         }
 
         // Get the magnitude squared of this vector, which does not use a sqrt operation.
-        float getMagnitudeSquared() const {
+        constexpr float getMagnitudeSquared() const {
             return x * x + y * y;
         }
 
         // Returns the dot product of this vector and another vector.
-        float dot(const Vector2f& other) const {
+        constexpr float dot(const Vector2f& other) const {
             return x * other.x + y * other.y;
         }
 
-        float operator|(const Vector2f& other) const {
+        constexpr float operator|(const Vector2f& other) const {
             return x * other.x + y * other.y;
         }
 
         // Returns the dot product between two vectors.
-        static float DotProduct(const Vector2f& aVector, const Vector2f& bVector) {
+        static constexpr float DotProduct(const Vector2f& aVector, const Vector2f& bVector) {
             return aVector.x * bVector.x + aVector.y * bVector.y;
         }
 
         // Returns the cross product between this and another vector.
-        Vector3f crossProduct(const Vector2f& other) const {
+        constexpr Vector3f crossProduct(const Vector2f& other) const {
             return Vector3f(0.0f, 0.0f, x * other.y - y * other.x);
         }
 
         // Returns the cross product between two vectors.
-        static Vector3f crossProduct(const Vector2f& aVector, const Vector2f& bVector)  {
+        static constexpr Vector3f crossProduct(const Vector2f& aVector, const Vector2f& bVector)  {
             return Vector3f(0.0f, 0.0f, aVector.x * bVector.y - aVector.y * bVector.x);
         }
 
+        // Returns aVector * aScalar + bVector in one pass, without an intermediate vector.
+        static constexpr Vector2f MultiplyAdd(const Vector2f& aVector, float aScalar, const Vector2f& bVector) {
+            return Vector2f(aVector.x * aScalar + bVector.x,
+                            aVector.y * aScalar + bVector.y);
+        }
+
+        // Returns aVector * aWeight + bVector * bWeight in one pass, without intermediate vectors.
+        static constexpr Vector2f WeightedSum(const Vector2f& aVector, float aWeight,
+                                              const Vector2f& bVector, float bWeight) {
+            return Vector2f(aVector.x * aWeight + bVector.x * bWeight,
+                            aVector.y * aWeight + bVector.y * bWeight);
+        }
+
+        // Adds other * aScalar onto this vector, modifying the original vector.
+        constexpr Vector2f& addScaled(const Vector2f& other, float aScalar) {
+            x += other.x * aScalar;
+            y += other.y * aScalar;
+            return *this;
+        }
+
         // Linear Interpolation between this vector and another. 
         // Beta will be clamped between [0,1] inclusive.
-        Vector2f lerpWith(const Vector2f& other, float beta) const {
+        constexpr Vector2f lerpWith(const Vector2f& other, float beta) const {
             beta = ClampInclusive(beta, 0.0f, 1.0f);
-            return ((*this) * (1.0f - beta)) + (other * beta);
+            return WeightedSum(*this, 1.0f - beta, other, beta);
         }
 
         // Linear Interpolation between this vector and another. 
         // Beta must be clamped between [0,1], inclusive, before calling to ensure correct result.
-        Vector2f lerpNoClampWith(const Vector2f& other, float beta) const {
-            return ((*this) * (1.0f - beta)) + (other * beta);
+        constexpr Vector2f lerpNoClampWith(const Vector2f& other, float beta) const {
+            return WeightedSum(*this, 1.0f - beta, other, beta);
         }
 
         // Linear Interpolation between two vectors.
         // Beta will be clamped between [0,1] inclusive.
-        static Vector2f Lerp(const Vector2f& aVector, const Vector2f& bVector, float beta) {
+        static constexpr Vector2f Lerp(const Vector2f& aVector, const Vector2f& bVector, float beta) {
             beta = ClampInclusive(beta, 0.0f, 1.0f);
-            return (aVector * (1.0f - beta)) + (bVector * beta);
+            return WeightedSum(aVector, 1.0f - beta, bVector, beta);
         }
 
         // Linear Interpolation between two vectors.
         // Beta must be clamped between [0,1], inclusive, before calling to ensure correct result.
-        static Vector2f LerpNoClamp(const Vector2f& aVector, const Vector2f& bVector, float beta) {
-            return (aVector * (1.0f - beta)) + (bVector * beta);
+        static constexpr Vector2f LerpNoClamp(const Vector2f& aVector, const Vector2f& bVector, float beta) {
+            return WeightedSum(aVector, 1.0f - beta, bVector, beta);
         }
 
         // Changes this vector into the normalized version of itself.
@@ -173,7 +184,7 @@ namespace KhaosMath
 
         // Returns a vector representing the projection of this vector onto target vector. 
         // Target vector must be a unit vector (magnitude == 1.0f) to produce correct result.
-        Vector2f projectedOntoUnitVector(const Vector2f& target) const {
+        constexpr Vector2f projectedOntoUnitVector(const Vector2f& target) const {
             return target * (*this).dot(target);
         }
 
@@ -186,7 +197,7 @@ namespace KhaosMath
 
         // Returns a vector representing the projection of a source vector onto a target vector. 
         // Target vector must be a unit vector (magnitude == 1.0f) to produce correct result.
-        static Vector2f ProjectOntoUnitVector(const Vector2f& source, const Vector2f& target) {
+        static constexpr Vector2f ProjectOntoUnitVector(const Vector2f& source, const Vector2f& target) {
             return target * source.dot(target);
         }
 
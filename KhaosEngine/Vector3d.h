@@ -0,0 +1,152 @@
+#pragma once
+
+// Vector3d.h
+// Double precision vector for world positions far from the origin. Rendering and culling
+// stay in float by converting to camera relative Vector3f; see LargeWorld.h.
+
+#include "Common.h"
+#include "CommonMath.h"
+
+#include "Vector3f.h"
+
+#include <cmath>
+
+namespace KhaosMath
+{
+    // Class representing a 3-dimensional vector defined as 3 double precision numbers.
+    class Vector3d
+    {
+    public:
+        double x, y, z;
+
+        // Default constructor will zero all elements.
+        constexpr Vector3d()
+            : x(0.0), y(0.0), z(0.0) { }
+
+        // Constructor to explicitly initialize all elements.
+        constexpr Vector3d(double aX, double aY, double aZ)
+            : x(aX), y(aY), z(aZ) { }
+
+        // Widening constructor from a float vector.
+        explicit constexpr Vector3d(const Vector3f& aVector)
+            : x(aVector.x), y(aVector.y), z(aVector.z) { }
+
+        // Returns the vector rounded to float precision.
+        constexpr Vector3f toVector3f() const {
+            return Vector3f(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z));
+        }
+
+        constexpr Vector3d operator-() const {
+            return Vector3d(-x, -y, -z);
+        }
+
+        // Add two vectors together to create a new vector.
+        constexpr Vector3d operator+(const Vector3d& other) const {
+            return Vector3d(x + other.x, y + other.y, z + other.z);
+        }
+
+        // Subtract a vector from another to create a new vector.
+        constexpr Vector3d operator-(const Vector3d& other) const {
+            return Vector3d(x - other.x, y - other.y, z - other.z);
+        }
+
+        // Multiply each element by a scalar.
+        constexpr Vector3d operator*(const double aScalar) const {
+            return Vector3d(x * aScalar, y * aScalar, z * aScalar);
+        }
+
+        // Divide each element by a scalar.
+        constexpr Vector3d operator/(const double aScalar) const {
+            return Vector3d(x / aScalar, y / aScalar, z / aScalar);
+        }
+
+        // Modify this vector by adding each element.
+        constexpr Vector3d& operator+=(const Vector3d& other) {
+            x += other.x;
+            y += other.y;
+            z += other.z;
+            return *this;
+        }
+
+        // Modify this vector by subtracting each element.
+        constexpr Vector3d& operator-=(const Vector3d& other) {
+            x -= other.x;
+            y -= other.y;
+            z -= other.z;
+            return *this;
+        }
+
+        // Modify this vector by multiplying each element by a scalar.
+        constexpr Vector3d& operator*=(const double aScalar) {
+            x *= aScalar;
+            y *= aScalar;
+            z *= aScalar;
+            return *this;
+        }
+
+        // Modify this vector by dividing each element by a scalar.
+        constexpr Vector3d& operator/=(const double aScalar) {
+            x /= aScalar;
+            y /= aScalar;
+            z /= aScalar;
+            return *this;
+        }
+
+        constexpr bool operator==(const Vector3d& other) const {
+            return x == other.x && y == other.y && z == other.z;
+        }
+
+        constexpr bool operator!=(const Vector3d& other) const {
+            return !(*this == other);
+        }
+
+        // Get the magnitude of this vector.
+        double getMagnitude() const {
+            return sqrt(x * x + y * y + z * z);
+        }
+
+        // Get the magnitude squared of this vector, which does not use a sqrt operation.
+        constexpr double getMagnitudeSquared() const {
+            return x * x + y * y + z * z;
+        }
+
+        // Returns the dot product of this vector and another vector.
+        constexpr double dot(const Vector3d& other) const {
+            return x * other.x + y * other.y + z * other.z;
+        }
+
+        // Returns the dot product between two vectors.
+        static constexpr double DotProduct(const Vector3d& aVector, const Vector3d& bVector) {
+            return aVector.dot(bVector);
+        }
+
+        // Returns the cross product between this and another vector.
+        constexpr Vector3d crossProduct(const Vector3d& other) const {
+            return Vector3d(y * other.z - z * other.y,
+                            z * other.x - x * other.z,
+                            x * other.y - y * other.x);
+        }
+
+        // Returns the cross product between two vectors.
+        static constexpr Vector3d CrossProduct(const Vector3d& aVector, const Vector3d& bVector) {
+            return aVector.crossProduct(bVector);
+        }
+
+        // Linear Interpolation between two vectors.
+        // Beta will be clamped between [0,1] inclusive.
+        static constexpr Vector3d Lerp(const Vector3d& aVector, const Vector3d& bVector, double beta) {
+            beta = beta < 0.0 ? 0.0 : (beta > 1.0 ? 1.0 : beta);
+            return aVector + (bVector - aVector) * beta;
+        }
+
+        // Changes this vector into the normalized version of itself.
+        void setToNormalized() {
+            (*this) /= getMagnitude();
+        }
+
+        // Returns a normalized version of this vector. Does not change the original vector.
+        Vector3d getNormalized() const {
+            return (*this) / getMagnitude();
+        }
+    };
+}
\ No newline at end of file
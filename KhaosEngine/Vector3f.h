@@ -13,41 +13,31 @@ namespace KhaosMath
         float x, y, z;
 
         // Default constructor will zero all elements.
-        Vector3f()
+        constexpr Vector3f()
             : x(0.0f), y(0.0f), z(0.0f) { };
 
         // Constructor to explicitly initialize all elements.
-        Vector3f(float aX, float aY, float aZ)
+        constexpr Vector3f(float aX, float aY, float aZ)
             : x(aX), y(aY), z(aZ) { };
 
-        // Copy constructor.
-        Vector3f(const Vector3f& other)
-            : x(other.x), y(other.y), z(other.z) { }
-
-        // Move constructor.
-        Vector3f(Vector3f&& other)
-            : x(std::move(other.x)), y(std::move(other.y)), z(std::move(other.z)) { }
-
-        // Assignment operator.
-        Vector3f& operator=(const Vector3f& other) {
-            this->x = other.x;
-            this->y = other.y;
-            this->z = other.z;
-            return *this;
-        }
+        // Copies are trivial so the type stays in registers and can be moved with memcpy.
+        constexpr Vector3f(const Vector3f& other) = default;
+        constexpr Vector3f(Vector3f&& other) = default;
+        Vector3f& operator=(const Vector3f& other) = default;
+        Vector3f& operator=(Vector3f&& other) = default;
 
         // Add two vectors together to create a new vector.
-        Vector3f operator+(const Vector3f& other) const {
+        constexpr Vector3f operator+(const Vector3f& other) const {
             return Vector3f(x + other.x, y + other.y, z + other.z);
         }
 
         // Subtract another vector from this vector to create a new vector;
-        Vector3f operator-(const Vector3f& other) const {
+        constexpr Vector3f operator-(const Vector3f& other) const {
             return Vector3f(x - other.x, y - other.y, z - other.z);
         }
 
         // Create a vector by multiplying each component of this vector.
-        Vector3f operator*(const float aScalar) const {
+        constexpr Vector3f operator*(const float aScalar) const {
             return Vector3f(x * aScalar, y * aScalar, z * aScalar);
         }
 
@@ -58,7 +48,7 @@ namespace KhaosMath
         }
 
         // Add a vector onto this vector, modifying the original vector.
-        Vector3f operator+=(const Vector3f& other) {
+        constexpr Vector3f& operator+=(const Vector3f& other) {
             this->x += other.x;
             this->y += other.y;
             this->z += other.z;
@@ -66,7 +56,7 @@ namespace KhaosMath
         }
 
         // Subtract a vector from this vector, modifying the original vector.
-        Vector3f operator-=(const Vector3f& other) {
+        constexpr Vector3f& operator-=(const Vector3f& other) {
             this->x -= other.x;
             this->y -= other.y;
             this->z -= other.z;
@@ -74,7 +64,7 @@ namespace KhaosMath
         }
 
         // Modify this vector by multiplying each component.
-        Vector3f operator*=(const float aScalar) {
+        constexpr Vector3f& operator*=(const float aScalar) {
             this->x *= aScalar;
             this->y *= aScalar;
             this->z *= aScalar;
@@ -82,7 +72,7 @@ namespace KhaosMath
         }
 
         // Modify this vector by dividing each component.
-        Vector3f operator/=(const float aScalar) {
+        Vector3f& operator/=(const float aScalar) {
             this->x /= aScalar;
             this->y /= aScalar;
             this->z /= aScalar;
@@ -90,12 +80,12 @@ namespace KhaosMath
         }
 
         // Determine if this vector is component-wise equal to another vector.
-        bool operator==(const Vector3f& other) const {
+        constexpr bool operator==(const Vector3f& other) const {
             return x == other.x && y == other.y && z == other.z;
         }
 
         // Determine if this vector is component-wise not equal to another vector.
-        bool operator!=(const Vector3f& other) const {
+        constexpr bool operator!=(const Vector3f& other) const {
            return !(*this == other);
         }
 
@@ -105,62 +95,85 @@ namespace KhaosMath
         }
 
         // Get the magnitude squared of this vector, which does not use a sqrt operation.
-        float getMagnitudeSquared() const {
+        constexpr float getMagnitudeSquared() const {
             return x * x + y * y + z * z;
         }
 
         // Returns the dot product of this vector and another vector.
-        float dot(const Vector3f& other) const {
+        constexpr float dot(const Vector3f& other) const {
            return x * other.x + y * other.y + z * other.z;
         }
 
-        float operator|(const Vector3f& other) const {
+        constexpr float operator|(const Vector3f& other) const {
            return x * other.x + y * other.y + z * other.z;
         }
 
         // Returns the dot product between two vectors.
-        static float DotProduct(const Vector3f& aVector, const Vector3f& bVector) {
+        static constexpr float DotProduct(const Vector3f& aVector, const Vector3f& bVector) {
             return aVector.x * bVector.x + aVector.y * bVector.y + aVector.z * bVector.z;
         }
 
         // Returns the cross product between this and another vector.
-        Vector3f crossProduct(const Vector3f& other) const {
+        constexpr Vector3f crossProduct(const Vector3f& other) const {
             return Vector3f(y * other.z - z * other.y,
                             z * other.x - x * other.z,
                             x * other.y - y * other.x);
         }
 
         // Returns the cross product between two vectors.
-        static Vector3f CrossProduct(const Vector3f& aVector, const Vector3f& bVector)  {
+        static constexpr Vector3f CrossProduct(const Vector3f& aVector, const Vector3f& bVector)  {
             return Vector3f(aVector.y * bVector.z - aVector.z * bVector.y,
                             aVector.z * bVector.x - aVector.x * bVector.z,
                             aVector.x * bVector.y - aVector.y * bVector.x);
         }
 
+        // Returns aVector * aScalar + bVector in one pass, without an intermediate vector.
+        static constexpr Vector3f MultiplyAdd(const Vector3f& aVector, float aScalar, const Vector3f& bVector) {
+            return Vector3f(aVector.x * aScalar + bVector.x,
+                            aVector.y * aScalar + bVector.y,
+                            aVector.z * aScalar + bVector.z);
+        }
+
+        // Returns aVector * aWeight + bVector * bWeight in one pass, without intermediate vectors.
+        static constexpr Vector3f WeightedSum(const Vector3f& aVector, float aWeight,
+                                              const Vector3f& bVector, float bWeight) {
+            return Vector3f(aVector.x * aWeight + bVector.x * bWeight,
+                            aVector.y * aWeight + bVector.y * bWeight,
+                            aVector.z * aWeight + bVector.z * bWeight);
+        }
+
+        // Adds other * aScalar onto this vector, modifying the original vector.
+        constexpr Vector3f& addScaled(const Vector3f& other, float aScalar) {
+            x += other.x * aScalar;
+            y += other.y * aScalar;
+            z += other.z * aScalar;
+            return *this;
+        }
+
         // Linear Interpolation between this vector and another. 
         // Beta will be clamped between [0,1] inclusive.
-        Vector3f lerpWith(const Vector3f& other, float beta) const {
+        constexpr Vector3f lerpWith(const Vector3f& other, float beta) const {
             beta = ClampInclusive(beta, 0.0f, 1.0f);
-            return ((*this) * (1.0f - beta)) + (other * beta);
+            return WeightedSum(*this, 1.0f - beta, other, beta);
         }
 
         // Linear Interpolation between this vector and another. 
         // Beta must be clamped between [0,1], inclusive, before calling to ensure correct result.
-        Vector3f lerpNoClampWith(const Vector3f& other, float beta) const {
-            return ((*this) * (1.0f - beta)) + (other * beta);
+        constexpr Vector3f lerpNoClampWith(const Vector3f& other, float beta) const {
+            return WeightedSum(*this, 1.0f - beta, other, beta);
         }
 
         // Linear Interpolation between two vectors.
         // Beta will be clamped between [0,1] inclusive.
-        static Vector3f Lerp(const Vector3f& aVector, const Vector3f bVector, float beta) {
+        static constexpr Vector3f Lerp(const Vector3f& aVector, const Vector3f& bVector, float beta) {
             beta = ClampInclusive(beta, 0.0f, 1.0f);
-            return (aVector * (1.0f - beta)) + (bVector * beta);
+            return WeightedSum(aVector, 1.0f - beta, bVector, beta);
         }
 
         // Linear Interpolation between two vectors.
         // Beta must be clamped between [0,1], inclusive, before calling to ensure correct result.
-        static Vector3f LerpNoClamp(const Vector3f& aVector, const Vector3f bVector, float beta) {
-            return (aVector * (1.0f - beta)) + (bVector * beta);
+        static constexpr Vector3f LerpNoClamp(const Vector3f& aVector, const Vector3f& bVector, float beta) {
+            return WeightedSum(aVector, 1.0f - beta, bVector, beta);
         }
 
         // Changes this vector into the normalized version of itself.
@@ -180,7 +193,7 @@ namespace KhaosMath
 
         // Returns a vector representing the projection of this vector onto target vector. 
         // Target vector must be a unit vector (magnitude == 1.0f) to produce correct result.
-        Vector3f projectedOntoUnitVector(const Vector3f& target) const {
+        constexpr Vector3f projectedOntoUnitVector(const Vector3f& target) const {
             return target * (*this).dot(target);
         }
 
@@ -193,7 +206,7 @@ namespace KhaosMath
 
         // Returns a vector representing the projection of a source vector onto a target vector. 
         // Target vector must be a unit vector (magnitude == 1.0f) to produce correct result.
-        static Vector3f ProjectOntoUnitVector(const Vector3f& source, const Vector3f& target) {
+        static constexpr Vector3f ProjectOntoUnitVector(const Vector3f& source, const Vector3f& target) {
             return target * source.dot(target);
         }
 
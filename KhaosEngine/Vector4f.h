@@ -16,45 +16,33 @@ namespace KhaosMath
         float x, y, z, w;
 
         // Default constructor will zero all elements.
-        Vector4f()
+        constexpr Vector4f()
             : x(0.0f), y(0.0f), z(0.0f), w(0.0f) { };
 
         // Constructor to explicitly initialize all elements.
-        Vector4f(float aX, float aY, float aZ, float aW)
+        constexpr Vector4f(float aX, float aY, float aZ, float aW)
             : x(aX), y(aY), z(aZ), w(aW) { };
 
-        // Copy constructor.
-        Vector4f(const Vector4f& other)
-            : x(other.x), y(other.y), z(other.z), w(other.w) { }
-
-        // Move constructor.
-        Vector4f(Vector4f&& other)
-            : x(std::move(other.x)), y(std::move(other.y)),
-            z(std::move(other.z)), w(std::move(other.w)) { }
-
-        // Assignment operator.
-        Vector4f& operator=(const Vector4f& other) {
-            this->x = other.x;
-            this->y = other.y;
-            this->z = other.z;
-            this->w = other.w;
-            return *this;
-        }
+        // Copies are trivial so the type stays in registers and can be moved with memcpy.
+        constexpr Vector4f(const Vector4f& other) = default;
+        constexpr Vector4f(Vector4f&& other) = default;
+        Vector4f& operator=(const Vector4f& other) = default;
+        Vector4f& operator=(Vector4f&& other) = default;
 
         // Add two vectors together to create a new vector.
-        Vector4f operator+(const Vector4f& other) const {
+        constexpr Vector4f operator+(const Vector4f& other) const {
             return Vector4f(x + other.x, y + other.y, z + other.z, w + other.w);
         }
 
         // Subtract another vector from this vector to create a new vector;
-        Vector4f operator-(const Vector4f& other) const {
+        constexpr Vector4f operator-(const Vector4f& other) const {
             return Vector4f(x - other.x, y - other.y, z - other.z, w - other.w);
         }
 
-        Vector4f operator*(const Matrix4x4f& other) const;
+        constexpr Vector4f operator*(const Matrix4x4f& other) const;
 
         // Create a vector by multiplying each component of this vector.
-        Vector4f operator*(const float aScalar) const {
+        constexpr Vector4f operator*(const float aScalar) const {
             return Vector4f(x * aScalar, y * aScalar, z * aScalar, w * aScalar);
         }
 
@@ -65,7 +53,7 @@ namespace KhaosMath
         }
 
         // Add a vector onto this vector, modifying the original vector.
-        Vector4f operator+=(const Vector4f& other) {
+        constexpr Vector4f& operator+=(const Vector4f& other) {
             this->x += other.x;
             this->y += other.y;
             this->z += other.z;
@@ -74,7 +62,7 @@ namespace KhaosMath
         }
 
         // Subtract a vector from this vector, modifying the original vector.
-        Vector4f operator-=(const Vector4f& other) {
+        constexpr Vector4f& operator-=(const Vector4f& other) {
             this->x -= other.x;
             this->y -= other.y;
             this->z -= other.z;
@@ -83,7 +71,7 @@ namespace KhaosMath
         }
 
         // Modify this vector by multiplying each component.
-        Vector4f operator*=(const float aScalar) {
+        constexpr Vector4f& operator*=(const float aScalar) {
             this->x *= aScalar;
             this->y *= aScalar;
             this->z *= aScalar;
@@ -92,7 +80,7 @@ namespace KhaosMath
         }
 
         // Modify this vector by dividing each component.
-        Vector4f operator/=(const float aScalar) {
+        Vector4f& operator/=(const float aScalar) {
             this->x /= aScalar;
             this->y /= aScalar;
             this->z /= aScalar;
@@ -101,17 +89,18 @@ namespace KhaosMath
         }
 
         // Determine if this vector is component-wise equal to another vector.
-        bool operator==(const Vector4f& other) const {
+        constexpr bool operator==(const Vector4f& other) const {
             return x == other.x && y == other.y && z == other.z && w == other.w;
         }
 
         // Determine if this vector is component-wise not equal to another vector.
-        bool operator!=(const Vector4f& other) const {
+        constexpr bool operator!=(const Vector4f& other) const {
             return !(*this == other);
         }
 
+        // Loads x, y, z, w into lanes 0 to 3, the order _mm_loadu_ps would read them from memory.
         operator __m128() const {
-            return _mm_set_ps(x, y, z, w);
+            return _mm_setr_ps(x, y, z, w);
         }
 
         // Get the magnitude of this vector.
@@ -120,25 +109,51 @@ namespace KhaosMath
         }
 
         // Get the magnitude squared of this vector, which does not use a sqrt operation.
-        float getMagnitudeSquared() const {
+        constexpr float getMagnitudeSquared() const {
             return x * x + y * y + z * z + w * w;
         }
 
         // Returns the dot product of this vector and another vector.
-        float dot(const Vector4f& other) const {
+        constexpr float dot(const Vector4f& other) const {
             return x * other.x + y * other.y + z * other.z + w * other.w;
         }
 
 
         // Returns the dot product between two vectors.
-        static float DotProduct(const Vector4f& aVector, const Vector4f& bVector) {
+        static constexpr float DotProduct(const Vector4f& aVector, const Vector4f& bVector) {
             return aVector.x * bVector.x + aVector.y * bVector.y +
                 aVector.z * bVector.z + aVector.w * bVector.w;
         }
-        float operator|(const Vector4f& other) const {
+        constexpr float operator|(const Vector4f& other) const {
             return x * other.x + y * other.y + z * other.z + w * other.w;
         }
 
+        // Returns aVector * aScalar + bVector in one pass, without an intermediate vector.
+        static constexpr Vector4f MultiplyAdd(const Vector4f& aVector, float aScalar, const Vector4f& bVector) {
+            return Vector4f(aVector.x * aScalar + bVector.x,
+                            aVector.y * aScalar + bVector.y,
+                            aVector.z * aScalar + bVector.z,
+                            aVector.w * aScalar + bVector.w);
+        }
+
+        // Returns aVector * aWeight + bVector * bWeight in one pass, without intermediate vectors.
+        static constexpr Vector4f WeightedSum(const Vector4f& aVector, float aWeight,
+                                              const Vector4f& bVector, float bWeight) {
+            return Vector4f(aVector.x * aWeight + bVector.x * bWeight,
+                            aVector.y * aWeight + bVector.y * bWeight,
+                            aVector.z * aWeight + bVector.z * bWeight,
+                            aVector.w * aWeight + bVector.w * bWeight);
+        }
+
+        // Adds other * aScalar onto this vector, modifying the original vector.
+        constexpr Vector4f& addScaled(const Vector4f& other, float aScalar) {
+            x += other.x * aScalar;
+            y += other.y * aScalar;
+            z += other.z * aScalar;
+            w += other.w * aScalar;
+            return *this;
+        }
+
         // Changes this vector into the normalized version of itself.
         void setToNormalized() {
             (*this) /= (*this).getMagnitude();
@@ -0,0 +1,111 @@
+// WorkerPool.cpp
+// Job publication, task claiming and worker threads.
+
+#include "WorkerPool.h"
+#include "Profiler.h"
+
+#include <algorithm>
+
+namespace
+{
+    // True while this thread is inside a task, where a nested run must not wait on the pool.
+    thread_local bool insideTask = false;
+}
+
+namespace KhaosEngine
+{
+    //
+    // WorkerPool function definitions.
+    //
+
+    WorkerPool& WorkerPool::Shared() {
+        static WorkerPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+        return pool;
+    }
+
+    WorkerPool::WorkerPool(K_UINT aWorkerCount)
+        : mWorkerCount(std::min(aWorkerCount, MAX_WORKER_THREADS)), mTask(nullptr), mContext(nullptr),
+          mTaskCount(0), mFinishedTasks(0), mActiveWorkers(0), mGeneration(0), mShutdown(false), mNextTask(0) {
+        for (K_UINT i = 0; i < mWorkerCount; ++i)
+            mWorkers[i] = std::thread(&WorkerPool::workerThread, this);
+    }
+
+    WorkerPool::~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mShutdown = true;
+        }
+        mWake.notify_all();
+        for (K_UINT i = 0; i < mWorkerCount; ++i)
+            mWorkers[i].join();
+    }
+
+    void WorkerPool::run(TaskFunction aTask, void* aContext, K_UINT aTaskCount) {
+        if (aTaskCount == 0)
+            return;
+        if (aTaskCount == 1 || mWorkerCount == 0 || insideTask) {
+            for (K_UINT i = 0; i < aTaskCount; ++i)
+                aTask(aContext, i);
+            return;
+        }
+
+        std::lock_guard<std::mutex> runLock(mRunMutex);
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mIdle.wait(lock, [this] { return mActiveWorkers == 0; });
+            mTask = aTask;
+            mContext = aContext;
+            mTaskCount = aTaskCount;
+            mFinishedTasks = 0;
+            mNextTask.store(0, std::memory_order_relaxed);
+            ++mGeneration;
+        }
+        mWake.notify_all();
+
+        const K_UINT finished = runTasks(aTask, aContext, aTaskCount);
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mFinishedTasks += finished;
+        mIdle.wait(lock, [this] { return mFinishedTasks == mTaskCount && mActiveWorkers == 0; });
+    }
+
+    K_UINT WorkerPool::runTasks(TaskFunction aTask, void* aContext, K_UINT aTaskCount) {
+        insideTask = true;
+        K_UINT finished = 0;
+        for (K_UINT task = mNextTask.fetch_add(1, std::memory_order_relaxed); task < aTaskCount;
+             task = mNextTask.fetch_add(1, std::memory_order_relaxed)) {
+            aTask(aContext, task);
+            ++finished;
+        }
+        insideTask = false;
+        return finished;
+    }
+
+    void WorkerPool::workerThread() {
+        PROFILE_THREAD_NAME("Worker");
+
+        KUI_64 seenGeneration = 0;
+        std::unique_lock<std::mutex> lock(mMutex);
+        for (;;) {
+            mWake.wait(lock, [&] { return mShutdown || mGeneration != seenGeneration; });
+            if (mShutdown)
+                return;
+            seenGeneration = mGeneration;
+            if (mFinishedTasks == mTaskCount)
+                continue;
+
+            const TaskFunction task = mTask;
+            void* const context = mContext;
+            const K_UINT taskCount = mTaskCount;
+            ++mActiveWorkers;
+            lock.unlock();
+
+            const K_UINT finished = runTasks(task, context, taskCount);
+
+            lock.lock();
+            mFinishedTasks += finished;
+            if (--mActiveWorkers == 0)
+                mIdle.notify_all();
+        }
+    }
+}
\ No newline at end of file
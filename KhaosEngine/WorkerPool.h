@@ -0,0 +1,94 @@
+#pragma once
+
+// WorkerPool.h
+// Persistent worker threads for data parallel loops.
+//
+// Systems that split a batch into chunks hand them to the shared pool instead of starting
+// threads of their own, so a frame pays for thread creation once at startup rather than on
+// every parallel call. The calling thread works through chunks alongside the workers and
+// returns once all of them are done. A run started from inside a task executes inline on
+// that thread, so parallel systems can call each other without deadlocking.
+//
+//     WorkerPool::Shared().forEach(chunkCount, [&](K_UINT aChunk) {
+//         ...
+//     });
+
+#include "Common.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace KhaosEngine
+{
+    // Most worker threads a pool will run.
+    const K_UINT MAX_WORKER_THREADS = 31;
+
+    class WorkerPool
+    {
+    public:
+        typedef void (*TaskFunction)(void* aContext, K_UINT aTask);
+
+        // Returns the pool shared by the engine, started on first use with one worker per
+        // hardware thread besides the caller's.
+        static WorkerPool& Shared();
+
+        // Starts aWorkerCount workers, clamped to MAX_WORKER_THREADS. Zero runs every task
+        // on the calling thread.
+        explicit WorkerPool(K_UINT aWorkerCount);
+
+        // Stops and joins the workers. No run may be in progress.
+        ~WorkerPool();
+
+        // Calls aTask(aContext, i) for every i below aTaskCount and returns when all calls
+        // have finished. Tasks run concurrently in no particular order. Runs from several
+        // threads at once are serialized.
+        void run(TaskFunction aTask, void* aContext, K_UINT aTaskCount);
+
+        // Calls aFunction(i) for every i below aTaskCount, as run does.
+        template <typename Function>
+        void forEach(K_UINT aTaskCount, const Function& aFunction) {
+            run(&invoke<Function>, const_cast<Function*>(&aFunction), aTaskCount);
+        }
+
+        K_UINT getWorkerCount() const {
+            return mWorkerCount;
+        }
+
+    private:
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        template <typename Function>
+        static void invoke(void* aContext, K_UINT aTask) {
+            (*static_cast<const Function*>(aContext))(aTask);
+        }
+
+        // Claims and runs tasks of the current job until none are left. Returns how many it ran.
+        K_UINT runTasks(TaskFunction aTask, void* aContext, K_UINT aTaskCount);
+
+        void workerThread();
+
+        std::thread mWorkers[MAX_WORKER_THREADS];
+        K_UINT mWorkerCount;
+
+        // Held for the whole of a run so only one job is published at a time.
+        std::mutex mRunMutex;
+
+        // The current job, guarded by mMutex apart from mNextTask. Workers join a job by
+        // incrementing mActiveWorkers, and a new job is only published once every worker
+        // has left the previous one, so no worker claims a task index from a stale job.
+        std::mutex mMutex;
+        std::condition_variable mWake;
+        std::condition_variable mIdle;
+        TaskFunction mTask;
+        void* mContext;
+        K_UINT mTaskCount;
+        K_UINT mFinishedTasks;
+        K_UINT mActiveWorkers;
+        KUI_64 mGeneration;
+        bool mShutdown;
+        std::atomic<K_UINT> mNextTask;
+    };
+}
\ No newline at end of file